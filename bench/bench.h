@@ -0,0 +1,356 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "cds.h"
+#include <math.h>
+#include <time.h>
+
+
+/*===========================================================================*
+ *          The shared harness for the container microbenchmarks            *
+ *===========================================================================*/
+/*
+ * Each bench program replays the same operation sequence of every workload
+ * against its container and prints one JSON object per line for each
+ * operation, which keeps the output appendable and easy to diff over time:
+ *
+ *   {"container":"hash_map","op":"get","workload":"zipf","count":1000000,
+ *    "ops_per_sec":..,"p50_ns":..,"p90_ns":..,"p99_ns":..,"p999_ns":..,
+ *    "allocs":..}
+ *
+ * The sequence is generated from fixed seeds, so two runs of the same build
+ * perform exactly the same operations. The throughput is measured over the
+ * whole loop, while the latency comes from timing every BENCH_SAMPLE_STRIDE-th
+ * operation alone, with the timer overhead subtracted. The allocation count
+ * is only reported for the programs defining BENCH_TRACK_ALLOC, whose
+ * containers acquire the nodes through the global allocator, and is null for
+ * the others.
+ */
+
+/* The default operation count which can be overridden by the first argument. */
+static const unsigned BENCH_DEFAULT_COUNT = 1000000;
+
+/* Time one of the operations in this stride for the latency percentiles. */
+static const unsigned BENCH_SAMPLE_STRIDE = 16;
+
+/* The skew of the Zipfian workload, the same as YCSB. */
+static const double BENCH_ZIPF_THETA = 0.99;
+
+/* The seed of the key sequence generator. */
+static const uint64_t BENCH_SEED = 0x5eed5eed5eed5eedULL;
+
+/* The format and the buffer size of the string keys. */
+#define BENCH_STRING_FORMAT     "user%012u"
+#define BENCH_SIZE_STRING       (17)
+
+/* The supported workloads. */
+enum {
+    BENCH_SEQUENTIAL,
+    BENCH_UNIFORM,
+    BENCH_ZIPF,
+    BENCH_STRING,
+    BENCH_NUM_WORKLOAD
+};
+
+static const char* BENCH_NAME_WORKLOAD[BENCH_NUM_WORKLOAD] = {
+    "sequential", "uniform", "zipf", "string"
+};
+
+/** The operation sequence of a workload. */
+typedef struct _BenchKeys {
+    /** The operation count. */
+    unsigned count;
+
+    /** The workload type. */
+    int workload;
+
+    /** The key of each operation, either the integer key starting from 1 or
+        the pointer to the string key. */
+    void** keys;
+
+    /** The buffer holding the string keys. */
+    char* texts_;
+} BenchKeys;
+
+/** The benchmarked operation which receives the key of the current step. */
+typedef void (*BenchOp) (void* ctx, void* key);
+
+
+/*===========================================================================*
+ *                       The allocation accounting                          *
+ *===========================================================================*/
+static unsigned long long bench_num_alloc_;
+
+static inline void* BenchAlloc(void* ctx, size_t size)
+{
+    ++bench_num_alloc_;
+    return malloc(size);
+}
+
+static inline void BenchFree(void* ctx, void* ptr)
+{
+    free(ptr);
+}
+
+/**
+ * @brief Install the counting allocator if the program tracks allocations.
+ *
+ * It should be called before constructing any container.
+ */
+static inline void BenchInit()
+{
+#ifdef BENCH_TRACK_ALLOC
+    static const Allocator alloc = {BenchAlloc, BenchFree, NULL};
+    CdsSetAllocator(&alloc);
+#endif
+}
+
+
+/*===========================================================================*
+ *                      The key sequence generation                         *
+ *===========================================================================*/
+static inline uint64_t BenchRandom(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline double BenchRandomUnit(uint64_t* state)
+{
+    return (BenchRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Generate the operation sequence for the designated workload.
+ *
+ * The keys are drawn from the universe of the operation count. The sequential
+ * workload visits each key in ascending order, the uniform and the string ones
+ * pick the keys evenly, and the Zipfian one follows the YCSB generator with
+ * the ranks scrambled so that the hot keys are scattered over the universe.
+ *
+ * @param workload      The workload type
+ * @param count         The operation count
+ *
+ * @retval seq          The generated sequence
+ * @retval NULL         Insufficient memory
+ */
+static inline BenchKeys* BenchKeysInit(int workload, unsigned count)
+{
+    BenchKeys* seq = (BenchKeys*)malloc(sizeof(BenchKeys));
+    if (!seq)
+        return NULL;
+    seq->count = count;
+    seq->workload = workload;
+    seq->texts_ = NULL;
+    seq->keys = (void**)malloc(sizeof(void*) * count);
+    if (!seq->keys) {
+        free(seq);
+        return NULL;
+    }
+    if (workload == BENCH_STRING) {
+        seq->texts_ = (char*)malloc(BENCH_SIZE_STRING * (size_t)count);
+        if (!seq->texts_) {
+            free(seq->keys);
+            free(seq);
+            return NULL;
+        }
+    }
+
+    uint64_t state = BENCH_SEED + workload;
+
+    double zeta_n = 0, alpha = 0, eta = 0;
+    if (workload == BENCH_ZIPF) {
+        unsigned i;
+        for (i = 1 ; i <= count ; ++i)
+            zeta_n += 1 / pow(i, BENCH_ZIPF_THETA);
+        double zeta_2 = 1 + 1 / pow(2, BENCH_ZIPF_THETA);
+        alpha = 1 / (1 - BENCH_ZIPF_THETA);
+        eta = (1 - pow(2.0 / count, 1 - BENCH_ZIPF_THETA)) /
+              (1 - zeta_2 / zeta_n);
+    }
+
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        unsigned id;
+        if (workload == BENCH_SEQUENTIAL)
+            id = i;
+        else if (workload == BENCH_ZIPF) {
+            double u = BenchRandomUnit(&state);
+            double uz = u * zeta_n;
+            unsigned rank;
+            if (uz < 1)
+                rank = 0;
+            else if (uz < 1 + pow(0.5, BENCH_ZIPF_THETA))
+                rank = 1;
+            else
+                rank = (unsigned)(count * pow(eta * u - eta + 1, alpha));
+            if (rank >= count)
+                rank = count - 1;
+            uint64_t scramble = rank;
+            id = BenchRandom(&scramble) % count;
+        } else
+            id = BenchRandom(&state) % count;
+
+        if (workload == BENCH_STRING) {
+            char* text = seq->texts_ + BENCH_SIZE_STRING * (size_t)i;
+            snprintf(text, BENCH_SIZE_STRING, BENCH_STRING_FORMAT, id);
+            seq->keys[i] = text;
+        } else
+            seq->keys[i] = (void*)(uintptr_t)(id + 1);
+    }
+
+    return seq;
+}
+
+/**
+ * @brief Release the operation sequence.
+ *
+ * @param seq           The pointer to the sequence
+ */
+static inline void BenchKeysDeinit(BenchKeys* seq)
+{
+    if (!seq)
+        return;
+    free(seq->texts_);
+    free(seq->keys);
+    free(seq);
+}
+
+/** The FNV-1a hash for the string keys. */
+static inline unsigned BenchHashString(void* key)
+{
+    const unsigned char* text = (const unsigned char*)key;
+    unsigned hash = 2166136261u;
+    while (*text) {
+        hash ^= *text++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline uint64_t BenchHashString64(void* key)
+{
+    const unsigned char* text = (const unsigned char*)key;
+    uint64_t hash = 14695981039346656037ULL;
+    while (*text) {
+        hash ^= *text++;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static inline int BenchCompareString(void* lhs, void* rhs)
+{
+    return strcmp((const char*)lhs, (const char*)rhs);
+}
+
+
+/*===========================================================================*
+ *                        The measurement and report                        *
+ *===========================================================================*/
+static inline uint64_t BenchNow()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return (uint64_t)spec.tv_sec * 1000000000ULL + spec.tv_nsec;
+}
+
+static inline int BenchCompareSample(const void* lhs, const void* rhs)
+{
+    uint64_t a = *(const uint64_t*)lhs;
+    uint64_t b = *(const uint64_t*)rhs;
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Parse the operation count from the command line.
+ *
+ * @param argc          The argument count
+ * @param argv          The argument vector
+ *
+ * @retval count        The operation count
+ */
+static inline unsigned BenchCount(int argc, char** argv)
+{
+    if (argc > 1) {
+        long count = strtol(argv[1], NULL, 10);
+        if (count > 0 && count <= INT_MAX)
+            return (unsigned)count;
+    }
+    return BENCH_DEFAULT_COUNT;
+}
+
+/**
+ * @brief Replay the sequence with the operation and print the result line.
+ *
+ * @param container     The container name
+ * @param op            The operation name
+ * @param seq           The operation sequence
+ * @param func          The benchmarked operation
+ * @param ctx           The context passed to the operation
+ */
+static inline void BenchRun(const char* container, const char* op,
+                            BenchKeys* seq, BenchOp func, void* ctx)
+{
+    unsigned count = seq->count;
+    unsigned num_sample = count / BENCH_SAMPLE_STRIDE + 1;
+    uint64_t* samples = (uint64_t*)malloc(sizeof(uint64_t) * num_sample);
+    if (!samples)
+        return;
+
+    /* Calibrate the cost of the timer itself. */
+    uint64_t overhead = UINT64_MAX;
+    unsigned i;
+    for (i = 0 ; i < 1000 ; ++i) {
+        uint64_t begin = BenchNow();
+        uint64_t delta = BenchNow() - begin;
+        if (delta < overhead)
+            overhead = delta;
+    }
+
+    unsigned long long num_alloc = bench_num_alloc_;
+    unsigned idx = 0;
+    uint64_t begin = BenchNow();
+    for (i = 0 ; i < count ; ++i) {
+        if (i % BENCH_SAMPLE_STRIDE == 0) {
+            uint64_t start = BenchNow();
+            func(ctx, seq->keys[i]);
+            uint64_t delta = BenchNow() - start;
+            samples[idx++] = (delta > overhead)? (delta - overhead) : 0;
+        } else
+            func(ctx, seq->keys[i]);
+    }
+    uint64_t elapse = BenchNow() - begin;
+    num_alloc = bench_num_alloc_ - num_alloc;
+
+    qsort(samples, idx, sizeof(uint64_t), BenchCompareSample);
+    #define BENCH_PERCENTILE(p) \
+        samples[(unsigned)((idx - 1) * (p))]
+
+    printf("{\"container\":\"%s\",\"op\":\"%s\",\"workload\":\"%s\","
+           "\"count\":%u,\"ops_per_sec\":%.0f,"
+           "\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,",
+           container, op, BENCH_NAME_WORKLOAD[seq->workload], count,
+           (elapse > 0)? count * 1e9 / elapse : 0.0,
+           (unsigned long long)BENCH_PERCENTILE(0.5),
+           (unsigned long long)BENCH_PERCENTILE(0.9),
+           (unsigned long long)BENCH_PERCENTILE(0.99),
+           (unsigned long long)BENCH_PERCENTILE(0.999));
+    #undef BENCH_PERCENTILE
+
+#ifdef BENCH_TRACK_ALLOC
+    printf("\"allocs\":%llu}\n", num_alloc);
+#else
+    (void)num_alloc;
+    printf("\"allocs\":null}\n");
+#endif
+    fflush(stdout);
+
+    free(samples);
+}
+
+#endif
@@ -0,0 +1,40 @@
+#include "bench.h"
+
+
+static void Add(void* ctx, void* key)
+{
+    BloomFilterAdd((BloomFilter*)ctx, key);
+}
+
+static void Contain(void* ctx, void* key)
+{
+    BloomFilterContain((BloomFilter*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        BloomFilter* filter = BloomFilterInit(count, 0.01);
+        if (!filter)
+            return 1;
+        if (workload == BENCH_STRING)
+            BloomFilterSetHash(filter, BenchHashString64);
+
+        BenchRun("bloom_filter", "add", seq, Add, filter);
+        BenchRun("bloom_filter", "contain", seq, Contain, filter);
+
+        BloomFilterDeinit(filter);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#define BENCH_TRACK_ALLOC
+#include "bench.h"
+
+
+static void Put(void* ctx, void* key)
+{
+    BTreeMapPut((BTreeMap*)ctx, key, key);
+}
+
+static void Get(void* ctx, void* key)
+{
+    BTreeMapGet((BTreeMap*)ctx, key);
+}
+
+static void Remove(void* ctx, void* key)
+{
+    BTreeMapRemove((BTreeMap*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        BTreeMap* map = BTreeMapInit();
+        if (!map)
+            return 1;
+        if (workload == BENCH_STRING) {
+            BTreeMapSetCompare(map, BenchCompareString);
+        }
+
+        BenchRun("btree_map", "put", seq, Put, map);
+        BenchRun("btree_map", "get", seq, Get, map);
+        BenchRun("btree_map", "remove", seq, Remove, map);
+
+        BTreeMapDeinit(map);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+#define BENCH_TRACK_ALLOC
+#include "bench.h"
+
+
+static void Put(void* ctx, void* key)
+{
+    ConcurrentHashMapPut((ConcurrentHashMap*)ctx, key, key);
+}
+
+static void Get(void* ctx, void* key)
+{
+    ConcurrentHashMapGet((ConcurrentHashMap*)ctx, key);
+}
+
+static void Remove(void* ctx, void* key)
+{
+    ConcurrentHashMapRemove((ConcurrentHashMap*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        ConcurrentHashMap* map = ConcurrentHashMapInit(16);
+        if (!map)
+            return 1;
+        if (workload == BENCH_STRING) {
+            ConcurrentHashMapSetHash(map, BenchHashString);
+            ConcurrentHashMapSetCompare(map, BenchCompareString);
+        }
+
+        BenchRun("concurrent_hash_map", "put", seq, Put, map);
+        BenchRun("concurrent_hash_map", "get", seq, Get, map);
+        BenchRun("concurrent_hash_map", "remove", seq, Remove, map);
+
+        ConcurrentHashMapDeinit(map);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "bench.h"
+
+
+static void Add(void* ctx, void* key)
+{
+    CountMinSketchAdd((CountMinSketch*)ctx, key, 1);
+}
+
+static void Estimate(void* ctx, void* key)
+{
+    CountMinSketchEstimate((CountMinSketch*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        CountMinSketch* sketch = CountMinSketchInit(0.001, 0.01, 64);
+        if (!sketch)
+            return 1;
+        if (workload == BENCH_STRING)
+            CountMinSketchSetHash(sketch, BenchHashString64);
+
+        BenchRun("count_min_sketch", "add", seq, Add, sketch);
+        BenchRun("count_min_sketch", "estimate", seq, Estimate, sketch);
+
+        CountMinSketchDeinit(sketch);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "bench.h"
+
+
+static void Put(void* ctx, void* key)
+{
+    FlatHashMapPut((FlatHashMap*)ctx, key, key);
+}
+
+static void Get(void* ctx, void* key)
+{
+    FlatHashMapGet((FlatHashMap*)ctx, key);
+}
+
+static void Remove(void* ctx, void* key)
+{
+    FlatHashMapRemove((FlatHashMap*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        FlatHashMap* map = FlatHashMapInit();
+        if (!map)
+            return 1;
+        if (workload == BENCH_STRING) {
+            FlatHashMapSetHash(map, BenchHashString);
+            FlatHashMapSetCompare(map, BenchCompareString);
+        }
+
+        BenchRun("flat_hash_map", "put", seq, Put, map);
+        BenchRun("flat_hash_map", "get", seq, Get, map);
+        BenchRun("flat_hash_map", "remove", seq, Remove, map);
+
+        FlatHashMapDeinit(map);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "bench.h"
+
+
+static const unsigned DEFAULT_CAPACITY = 32;
+
+
+static void PushBack(void* ctx, void* key)
+{
+    FlatVectorPushBack((FlatVector*)ctx, &key);
+}
+
+static void Get(void* ctx, void* key)
+{
+    FlatVector* vector = (FlatVector*)ctx;
+    void* element;
+    FlatVectorGet(vector, ((uintptr_t)key - 1) % FlatVectorSize(vector),
+                  &element);
+}
+
+static void PopBack(void* ctx, void* key)
+{
+    FlatVectorPopBack((FlatVector*)ctx);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The integer key doubles as the index to access, so the string workload
+       is skipped. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        FlatVector* vector = FlatVectorInit(sizeof(void*), DEFAULT_CAPACITY);
+        if (!vector)
+            return 1;
+
+        BenchRun("flat_vector", "push_back", seq, PushBack, vector);
+        BenchRun("flat_vector", "get", seq, Get, vector);
+        BenchRun("flat_vector", "pop_back", seq, PopBack, vector);
+
+        FlatVectorDeinit(vector);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+#define BENCH_TRACK_ALLOC
+#include "bench.h"
+
+
+static void Put(void* ctx, void* key)
+{
+    HashMapPut((HashMap*)ctx, key, key);
+}
+
+static void Get(void* ctx, void* key)
+{
+    HashMapGet((HashMap*)ctx, key);
+}
+
+static void Remove(void* ctx, void* key)
+{
+    HashMapRemove((HashMap*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        HashMap* map = HashMapInit();
+        if (!map)
+            return 1;
+        if (workload == BENCH_STRING) {
+            HashMapSetHash(map, BenchHashString);
+            HashMapSetCompare(map, BenchCompareString);
+        }
+
+        BenchRun("hash_map", "put", seq, Put, map);
+        BenchRun("hash_map", "get", seq, Get, map);
+        BenchRun("hash_map", "remove", seq, Remove, map);
+
+        HashMapDeinit(map);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
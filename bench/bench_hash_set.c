@@ -0,0 +1,49 @@
+#define BENCH_TRACK_ALLOC
+#include "bench.h"
+
+
+static void Add(void* ctx, void* key)
+{
+    HashSetAdd((HashSet*)ctx, key);
+}
+
+static void Find(void* ctx, void* key)
+{
+    HashSetFind((HashSet*)ctx, key);
+}
+
+static void Remove(void* ctx, void* key)
+{
+    HashSetRemove((HashSet*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        HashSet* set = HashSetInit();
+        if (!set)
+            return 1;
+        if (workload == BENCH_STRING) {
+            HashSetSetHash(set, BenchHashString);
+            HashSetSetCompare(set, BenchCompareString);
+        }
+
+        BenchRun("hash_set", "add", seq, Add, set);
+        BenchRun("hash_set", "find", seq, Find, set);
+        BenchRun("hash_set", "remove", seq, Remove, set);
+
+        HashSetDeinit(set);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
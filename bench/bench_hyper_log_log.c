@@ -0,0 +1,34 @@
+#include "bench.h"
+
+
+static void Add(void* ctx, void* key)
+{
+    HyperLogLogAdd((HyperLogLog*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        HyperLogLog* hll = HyperLogLogInit(14);
+        if (!hll)
+            return 1;
+        if (workload == BENCH_STRING)
+            HyperLogLogSetHash(hll, BenchHashString64);
+
+        BenchRun("hyper_log_log", "add", seq, Add, hll);
+
+        HyperLogLogDeinit(hll);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#define BENCH_TRACK_ALLOC
+#include "bench.h"
+
+
+typedef struct _Context {
+    List* list;
+    ListIter iter;
+} Context;
+
+
+static void PushBack(void* ctx, void* key)
+{
+    ListPushBack(((Context*)ctx)->list, key);
+}
+
+static void Iterate(void* ctx, void* key)
+{
+    void* element;
+    ListIterNext(&((Context*)ctx)->iter, &element);
+}
+
+static void PopFront(void* ctx, void* key)
+{
+    ListPopFront(((Context*)ctx)->list);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The list stores opaque pointers and its positional access is linear,
+       so the workloads only differ in the stored values, and the string one
+       is skipped. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        Context ctx;
+        ctx.list = ListInit();
+        if (!ctx.list)
+            return 1;
+
+        BenchRun("list", "push_back", seq, PushBack, &ctx);
+        ListIterInit(ctx.list, &ctx.iter, false);
+        BenchRun("list", "iterate", seq, Iterate, &ctx);
+        BenchRun("list", "pop_front", seq, PopFront, &ctx);
+
+        ListDeinit(ctx.list);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
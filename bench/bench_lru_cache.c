@@ -0,0 +1,48 @@
+#include "bench.h"
+
+
+static void Put(void* ctx, void* key)
+{
+    LruCachePut((LruCache*)ctx, key, key);
+}
+
+static void Get(void* ctx, void* key)
+{
+    LruCacheGet((LruCache*)ctx, key);
+}
+
+static void Remove(void* ctx, void* key)
+{
+    LruCacheRemove((LruCache*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        LruCache* cache = LruCacheInit(0, 0);
+        if (!cache)
+            return 1;
+        if (workload == BENCH_STRING) {
+            LruCacheSetHash(cache, BenchHashString);
+            LruCacheSetCompare(cache, BenchCompareString);
+        }
+
+        BenchRun("lru_cache", "put", seq, Put, cache);
+        BenchRun("lru_cache", "get", seq, Get, cache);
+        BenchRun("lru_cache", "remove", seq, Remove, cache);
+
+        LruCacheDeinit(cache);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "bench.h"
+
+
+static void Push(void* ctx, void* key)
+{
+    PriorityQueuePush((PriorityQueue*)ctx, key);
+}
+
+static void Top(void* ctx, void* key)
+{
+    void* element;
+    PriorityQueueTop((PriorityQueue*)ctx, &element);
+}
+
+static void Pop(void* ctx, void* key)
+{
+    PriorityQueuePop((PriorityQueue*)ctx);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The integer keys serve as the priorities, so the string workload is
+       skipped. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        PriorityQueue* queue = PriorityQueueInit();
+        if (!queue)
+            return 1;
+
+        BenchRun("priority_queue", "push", seq, Push, queue);
+        BenchRun("priority_queue", "top", seq, Top, queue);
+        BenchRun("priority_queue", "pop", seq, Pop, queue);
+
+        PriorityQueueDeinit(queue);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
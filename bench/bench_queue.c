@@ -0,0 +1,46 @@
+#include "bench.h"
+
+
+static void Push(void* ctx, void* key)
+{
+    QueuePush((Queue*)ctx, key);
+}
+
+static void Front(void* ctx, void* key)
+{
+    void* element;
+    QueueFront((Queue*)ctx, &element);
+}
+
+static void Pop(void* ctx, void* key)
+{
+    QueuePop((Queue*)ctx);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The queue stores opaque pointers, so the string workload is skipped. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        Queue* queue = QueueInit();
+        if (!queue)
+            return 1;
+
+        BenchRun("queue", "push", seq, Push, queue);
+        BenchRun("queue", "front", seq, Front, queue);
+        BenchRun("queue", "pop", seq, Pop, queue);
+
+        QueueDeinit(queue);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
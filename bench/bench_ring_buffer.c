@@ -0,0 +1,46 @@
+#include "bench.h"
+
+
+static void Push(void* ctx, void* key)
+{
+    RingBufferPush((RingBuffer*)ctx, key);
+}
+
+static void Pop(void* ctx, void* key)
+{
+    void* element;
+    RingBufferPop((RingBuffer*)ctx, &element);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The buffer stores opaque pointers, so the string workload is skipped.
+       Both the single and the multiple producer modes are measured from one
+       thread to expose the cost of the slot sequence numbers. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        RingBuffer* spsc = RingBufferInit(count, false);
+        RingBuffer* mpmc = RingBufferInit(count, true);
+        if (!spsc || !mpmc)
+            return 1;
+
+        BenchRun("ring_buffer", "push_spsc", seq, Push, spsc);
+        BenchRun("ring_buffer", "pop_spsc", seq, Pop, spsc);
+        BenchRun("ring_buffer", "push_mpmc", seq, Push, mpmc);
+        BenchRun("ring_buffer", "pop_mpmc", seq, Pop, mpmc);
+
+        RingBufferDeinit(spsc);
+        RingBufferDeinit(mpmc);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
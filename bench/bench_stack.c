@@ -0,0 +1,46 @@
+#include "bench.h"
+
+
+static void Push(void* ctx, void* key)
+{
+    StackPush((Stack*)ctx, key);
+}
+
+static void Top(void* ctx, void* key)
+{
+    void* element;
+    StackTop((Stack*)ctx, &element);
+}
+
+static void Pop(void* ctx, void* key)
+{
+    StackPop((Stack*)ctx);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The stack stores opaque pointers, so the string workload is skipped. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        Stack* stack = StackInit();
+        if (!stack)
+            return 1;
+
+        BenchRun("stack", "push", seq, Push, stack);
+        BenchRun("stack", "top", seq, Top, stack);
+        BenchRun("stack", "pop", seq, Pop, stack);
+
+        StackDeinit(stack);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
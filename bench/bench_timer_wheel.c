@@ -0,0 +1,55 @@
+#include "bench.h"
+
+
+/* The wheel ticks forward by one for each advance operation. */
+typedef struct _Clock {
+    TimerWheel* wheel;
+    uint64_t now;
+} Clock;
+
+static void Expire(void** elements, unsigned count, void* arg)
+{
+}
+
+static void Schedule(void* ctx, void* key)
+{
+    Clock* clock = (Clock*)ctx;
+    TimerWheelSchedule(clock->wheel, clock->now + (uintptr_t)key + 1, key);
+}
+
+static void Advance(void* ctx, void* key)
+{
+    Clock* clock = (Clock*)ctx;
+    TimerWheelAdvance(clock->wheel, ++(clock->now), Expire, NULL);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The integer keys serve as the timeouts, so the string workload is
+       skipped. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        Clock clock;
+        clock.now = 0;
+        clock.wheel = TimerWheelInit(clock.now);
+        if (!clock.wheel)
+            return 1;
+        TimerWheelUsePool(clock.wheel);
+
+        BenchRun("timer_wheel", "schedule", seq, Schedule, &clock);
+        BenchRun("timer_wheel", "advance", seq, Advance, &clock);
+
+        TimerWheelDeinit(clock.wheel);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
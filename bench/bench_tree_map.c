@@ -0,0 +1,48 @@
+#define BENCH_TRACK_ALLOC
+#include "bench.h"
+
+
+static void Put(void* ctx, void* key)
+{
+    TreeMapPut((TreeMap*)ctx, key, key);
+}
+
+static void Get(void* ctx, void* key)
+{
+    TreeMapGet((TreeMap*)ctx, key);
+}
+
+static void Remove(void* ctx, void* key)
+{
+    TreeMapRemove((TreeMap*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        TreeMap* map = TreeMapInit();
+        if (!map)
+            return 1;
+        if (workload == BENCH_STRING) {
+            TreeMapSetCompare(map, BenchCompareString);
+        }
+
+        BenchRun("tree_map", "put", seq, Put, map);
+        BenchRun("tree_map", "get", seq, Get, map);
+        BenchRun("tree_map", "remove", seq, Remove, map);
+
+        TreeMapDeinit(map);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
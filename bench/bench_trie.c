@@ -0,0 +1,43 @@
+#define BENCH_TRACK_ALLOC
+#include "bench.h"
+
+
+static void Insert(void* ctx, void* key)
+{
+    TrieInsert((Trie*)ctx, (const char*)key);
+}
+
+static void HasExact(void* ctx, void* key)
+{
+    TrieHasExact((Trie*)ctx, (const char*)key);
+}
+
+static void Remove(void* ctx, void* key)
+{
+    TrieRemove((Trie*)ctx, (const char*)key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The trie only stores strings, so only the string workload applies. */
+    BenchKeys* seq = BenchKeysInit(BENCH_STRING, count);
+    if (!seq)
+        return 1;
+
+    Trie* trie = TrieInit();
+    if (!trie)
+        return 1;
+
+    BenchRun("trie", "insert", seq, Insert, trie);
+    BenchRun("trie", "has_exact", seq, HasExact, trie);
+    BenchRun("trie", "remove", seq, Remove, trie);
+
+    TrieDeinit(trie);
+    BenchKeysDeinit(seq);
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+#define BENCH_TRACK_ALLOC
+#include "bench.h"
+
+
+static void Put(void* ctx, void* key)
+{
+    TrieMapPut((TrieMap*)ctx, (const char*)key, key);
+}
+
+static void Get(void* ctx, void* key)
+{
+    TrieMapGet((TrieMap*)ctx, (const char*)key);
+}
+
+static void Remove(void* ctx, void* key)
+{
+    TrieMapRemove((TrieMap*)ctx, (const char*)key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The trie map only accepts string keys, so only the string workload
+       applies. */
+    BenchKeys* seq = BenchKeysInit(BENCH_STRING, count);
+    if (!seq)
+        return 1;
+
+    TrieMap* map = TrieMapInit();
+    if (!map)
+        return 1;
+
+    BenchRun("trie_map", "put", seq, Put, map);
+    BenchRun("trie_map", "get", seq, Get, map);
+    BenchRun("trie_map", "remove", seq, Remove, map);
+
+    TrieMapDeinit(map);
+    BenchKeysDeinit(seq);
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "bench.h"
+
+
+/* The keys are the integers or the string pointers from the sequence, so the
+   map is specialized for the pointer keys with the workload specific hash. */
+static inline unsigned HashNum(void* key)
+{
+    return (unsigned)(uintptr_t)key;
+}
+
+static inline int CompareNum(void* lhs, void* rhs)
+{
+    return (lhs == rhs)? 0 : 1;
+}
+
+TYPED_HASH_MAP_DEFINE(NumMap, void*, void*, HashNum, CompareNum)
+TYPED_HASH_MAP_DEFINE(TxtMap, void*, void*, BenchHashString, BenchCompareString)
+
+
+static void PutNum(void* ctx, void* key)
+{
+    NumMapPut((NumMap*)ctx, key, key);
+}
+
+static void GetNum(void* ctx, void* key)
+{
+    NumMapGet((NumMap*)ctx, key);
+}
+
+static void RemoveNum(void* ctx, void* key)
+{
+    NumMapRemove((NumMap*)ctx, key);
+}
+
+static void PutTxt(void* ctx, void* key)
+{
+    TxtMapPut((TxtMap*)ctx, key, key);
+}
+
+static void GetTxt(void* ctx, void* key)
+{
+    TxtMapGet((TxtMap*)ctx, key);
+}
+
+static void RemoveTxt(void* ctx, void* key)
+{
+    TxtMapRemove((TxtMap*)ctx, key);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    int workload;
+    for (workload = 0 ; workload < BENCH_NUM_WORKLOAD ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        if (workload == BENCH_STRING) {
+            TxtMap* map = TxtMapInit();
+            if (!map)
+                return 1;
+            BenchRun("typed_hash_map", "put", seq, PutTxt, map);
+            BenchRun("typed_hash_map", "get", seq, GetTxt, map);
+            BenchRun("typed_hash_map", "remove", seq, RemoveTxt, map);
+            TxtMapDeinit(map);
+        } else {
+            NumMap* map = NumMapInit();
+            if (!map)
+                return 1;
+            BenchRun("typed_hash_map", "put", seq, PutNum, map);
+            BenchRun("typed_hash_map", "get", seq, GetNum, map);
+            BenchRun("typed_hash_map", "remove", seq, RemoveNum, map);
+            NumMapDeinit(map);
+        }
+
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#define BENCH_TRACK_ALLOC
+#include "bench.h"
+
+
+typedef struct _Context {
+    UnrolledList* list;
+    UnrolledListIter iter;
+} Context;
+
+
+static void PushBack(void* ctx, void* key)
+{
+    UnrolledListPushBack(((Context*)ctx)->list, key);
+}
+
+static void Iterate(void* ctx, void* key)
+{
+    void* element;
+    UnrolledListIterNext(&((Context*)ctx)->iter, &element);
+}
+
+static void PopFront(void* ctx, void* key)
+{
+    UnrolledListPopFront(((Context*)ctx)->list);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The unrolled list stores opaque pointers and its positional access is
+       linear, so the workloads only differ in the stored values, and the
+       string one is skipped. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        Context ctx;
+        ctx.list = UnrolledListInit(0);
+        if (!ctx.list)
+            return 1;
+
+        BenchRun("unrolled_list", "push_back", seq, PushBack, &ctx);
+        UnrolledListIterInit(ctx.list, &ctx.iter, false);
+        BenchRun("unrolled_list", "iterate", seq, Iterate, &ctx);
+        BenchRun("unrolled_list", "pop_front", seq, PopFront, &ctx);
+
+        UnrolledListDeinit(ctx.list);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "bench.h"
+
+
+static const unsigned DEFAULT_CAPACITY = 32;
+
+
+static void PushBack(void* ctx, void* key)
+{
+    VectorPushBack((Vector*)ctx, key);
+}
+
+static void Get(void* ctx, void* key)
+{
+    Vector* vector = (Vector*)ctx;
+    void* element;
+    VectorGet(vector, ((uintptr_t)key - 1) % VectorSize(vector), &element);
+}
+
+static void PopBack(void* ctx, void* key)
+{
+    VectorPopBack((Vector*)ctx);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The vector stores opaque pointers and the integer key doubles as the
+       index to access, so the string workload is skipped. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        Vector* vector = VectorInit(DEFAULT_CAPACITY);
+        if (!vector)
+            return 1;
+
+        BenchRun("vector", "push_back", seq, PushBack, vector);
+        BenchRun("vector", "get", seq, Get, vector);
+        BenchRun("vector", "pop_back", seq, PopBack, vector);
+
+        VectorDeinit(vector);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "bench.h"
+
+
+static void Push(void* ctx, void* key)
+{
+    WorkStealingDequePush((WorkStealingDeque*)ctx, key);
+}
+
+static void Pop(void* ctx, void* key)
+{
+    void* element;
+    WorkStealingDequePop((WorkStealingDeque*)ctx, &element);
+}
+
+static void Steal(void* ctx, void* key)
+{
+    void* element;
+    WorkStealingDequeSteal((WorkStealingDeque*)ctx, &element);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned count = BenchCount(argc, argv);
+    BenchInit();
+
+    /* The deque stores opaque pointers, so the string workload is skipped.
+       The owner pops one half and the thief steals the other half. */
+    int workload;
+    for (workload = 0 ; workload < BENCH_STRING ; ++workload) {
+        BenchKeys* seq = BenchKeysInit(workload, count);
+        if (!seq)
+            return 1;
+
+        WorkStealingDeque* deque = WorkStealingDequeInit(0);
+        if (!deque)
+            return 1;
+
+        BenchRun("work_stealing_deque", "push", seq, Push, deque);
+        seq->count = count / 2;
+        BenchRun("work_stealing_deque", "pop", seq, Pop, deque);
+        BenchRun("work_stealing_deque", "steal", seq, Steal, deque);
+        seq->count = count;
+
+        WorkStealingDequeDeinit(deque);
+        BenchKeysDeinit(seq);
+    }
+
+    return 0;
+}
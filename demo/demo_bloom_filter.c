@@ -0,0 +1,47 @@
+#include "cds.h"
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    BloomFilter* filter = BloomFilterInit(1024, 0.01);
+
+    /* Insert numerics into the filter. */
+    BloomFilterAdd(filter, (void*)(intptr_t)1);
+    BloomFilterAdd(filter, (void*)(intptr_t)2);
+    BloomFilterAdd(filter, (void*)(intptr_t)3);
+
+    /* The inserted keys are always reported, while the absent ones are
+       rejected with a high probability. */
+    assert(BloomFilterContain(filter, (void*)(intptr_t)1) == true);
+    assert(BloomFilterContain(filter, (void*)(intptr_t)2) == true);
+    assert(BloomFilterContain(filter, (void*)(intptr_t)3) == true);
+    assert(BloomFilterSize(filter) == 3);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    BloomFilterDeinit(filter);
+}
+
+void ManipulateStrings()
+{
+    char* names[3] = {"Alice", "Bob", "Carol"};
+
+    /* The string keys are hashed by their content. */
+    BloomFilter* filter = BloomFilterInit(1024, 0.01);
+    BloomFilterSetHash(filter, HashString64);
+    BloomFilterAdd(filter, names[0]);
+    BloomFilterAdd(filter, names[1]);
+    BloomFilterAdd(filter, names[2]);
+
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%s", "Bob");
+    assert(BloomFilterContain(filter, buf) == true);
+    BloomFilterDeinit(filter);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateStrings();
+    return 0;
+}
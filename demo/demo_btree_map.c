@@ -0,0 +1,336 @@
+#include "cds.h"
+
+
+typedef struct Employ_ {
+    int year;
+    int level;
+    int id;
+} Employ;
+
+
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanKey(void* key)
+{
+    free(key);
+}
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    BTreeMap* map = BTreeMapInit();
+
+    /* Insert numerics into the map. */
+    BTreeMapPut(map, (void*)(intptr_t)1, (void*)(intptr_t)9999);
+    BTreeMapPut(map, (void*)(intptr_t)2, (void*)(intptr_t)999);
+    BTreeMapPut(map, (void*)(intptr_t)3, (void*)(intptr_t)99);
+    BTreeMapPut(map, (void*)(intptr_t)4, (void*)(intptr_t)9);
+
+    /* Retrieve the value with the designated key. */
+    int val = (int)(intptr_t)BTreeMapGet(map, (void*)(intptr_t)1);
+    assert(val == 9999);
+
+    /* Iterate through the map. */
+    Pair* ptr_pair;
+    BTreeMapFirst(map);
+    int first = 1, second = 9999;
+    while ((ptr_pair = BTreeMapNext(map)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        int val = (int)(intptr_t)ptr_pair->value;
+        assert(key == first);
+        assert(val == second);
+        ++first;
+        second /= 10;
+    }
+
+    first = 4;
+    second = 9;
+    while ((ptr_pair = BTreeMapReverseNext(map)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        int val = (int)(intptr_t)ptr_pair->value;
+        assert(key == first);
+        assert(val == second);
+        --first;
+        second *= 10;
+        second += 9;
+    }
+
+    /* Remove the key value pair with the designated key. */
+    BTreeMapRemove(map, (void*)(intptr_t)2);
+
+    /* Check the map keys. */
+    assert(BTreeMapFind(map, (void*)(intptr_t)1) == true);
+    assert(BTreeMapFind(map, (void*)(intptr_t)2) == false);
+    assert(BTreeMapFind(map, (void*)(intptr_t)3) == true);
+    assert(BTreeMapFind(map, (void*)(intptr_t)4) == true);
+
+    /* Check the pair count in the map. */
+    unsigned size = BTreeMapSize(map);
+    assert(size == 3);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    BTreeMapDeinit(map);
+}
+
+void ManipulateTexts()
+{
+    char* names[4] = {"Alice\0", "Bob\0", "Chris\0", "David\0"};
+
+    /* We should initialize the container before any operations. */
+    BTreeMap* map = BTreeMapInit();
+
+    /* Set the custom key comparison functions. */
+    BTreeMapSetCompare(map, CompareKey);
+
+    /* If we plan to delegate the resource clean task to the container, set the
+       custom clean functions. */
+    BTreeMapSetCleanKey(map, CleanKey);
+    BTreeMapSetCleanValue(map, CleanValue);
+
+    /* Insert complex data payload into the map. */
+    char* key = strdup(names[0]);
+    Employ* employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 1;
+    employ->year = 25;
+    employ->level = 100;
+    BTreeMapPut(map, (void*)key, (void*)employ);
+
+    key = strdup(names[1]);
+    employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 2;
+    employ->year = 25;
+    employ->level = 90;
+    BTreeMapPut(map, (void*)key, (void*)employ);
+
+    key = strdup(names[2]);
+    employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 3;
+    employ->year = 25;
+    employ->level = 80;
+    BTreeMapPut(map, (void*)key, (void*)employ);
+
+    key = strdup(names[3]);
+    employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 4;
+    employ->year = 25;
+    employ->level = 70;
+    BTreeMapPut(map, (void*)key, (void*)employ);
+
+
+    /* Retrieve the value with the designated key. */
+    employ = (Employ*)BTreeMapGet(map, (void*)names[0]);
+    assert(employ != NULL);
+    assert(employ->id == 1);
+    assert(employ->year == 25);
+    assert(employ->level == 100);
+
+    /* Iterate through the map. */
+    Pair* ptr_pair;
+    BTreeMapFirst(map);
+    int first = 0, second = 1;
+    while ((ptr_pair = BTreeMapNext(map)) != NULL) {
+        char* name = (char*)ptr_pair->key;
+        employ = (Employ*)ptr_pair->value;
+        assert(strcmp(name, names[first]) == 0);
+        assert(employ->id == second);
+        ++first;
+        ++second;
+    }
+
+    BTreeMapFirst(map);
+    first = 3;
+    second = 4;
+    while ((ptr_pair = BTreeMapReverseNext(map)) != NULL) {
+        char* name = (char*)ptr_pair->key;
+        employ = (Employ*)ptr_pair->value;
+        assert(strcmp(name, names[first]) == 0);
+        assert(employ->id == second);
+        --first;
+        --second;
+    }
+
+    /* Remove the key value pair with the designated key. */
+    BTreeMapRemove(map, (void*)names[1]);
+
+    /* Check the map keys. */
+    assert(BTreeMapFind(map, (void*)names[0]) == true);
+    assert(BTreeMapFind(map, (void*)names[1]) == false);
+    assert(BTreeMapFind(map, (void*)names[2]) == true);
+    assert(BTreeMapFind(map, (void*)names[3]) == true);
+
+    /* Check the pair count in the map. */
+    unsigned size = BTreeMapSize(map);
+    assert(size == 3);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    BTreeMapDeinit(map);
+}
+
+void ManipulateNumericsCppStyle()
+{
+    /* We should initialize the container before any operations. */
+    BTreeMap* map = BTreeMapInit();
+
+    /* Insert numerics into the map. */
+    map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)9999);
+    map->put(map, (void*)(intptr_t)2, (void*)(intptr_t)999);
+    map->put(map, (void*)(intptr_t)3, (void*)(intptr_t)99);
+    map->put(map, (void*)(intptr_t)4, (void*)(intptr_t)9);
+
+    /* Retrieve the value with the designated key. */
+    int val = (int)(intptr_t)map->get(map, (void*)(intptr_t)1);
+    assert(val == 9999);
+
+    /* Iterate through the map. */
+    Pair* ptr_pair;
+    map->first(map);
+    int first = 1, second = 9999;
+    while ((ptr_pair = map->next(map)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        int val = (int)(intptr_t)ptr_pair->value;
+        assert(key == first);
+        assert(val == second);
+        ++first;
+        second /= 10;
+    }
+
+    first = 4;
+    second = 9;
+    while ((ptr_pair = map->reverse_next(map)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        int val = (int)(intptr_t)ptr_pair->value;
+        assert(key == first);
+        assert(val == second);
+        --first;
+        second *= 10;
+        second += 9;
+    }
+
+    /* Remove the key value pair with the designated key. */
+    map->remove(map, (void*)(intptr_t)2);
+
+    /* Check the map keys. */
+    assert(map->find(map, (void*)(intptr_t)1) == true);
+    assert(map->find(map, (void*)(intptr_t)2) == false);
+    assert(map->find(map, (void*)(intptr_t)3) == true);
+    assert(map->find(map, (void*)(intptr_t)4) == true);
+
+    /* Check the pair count in the map. */
+    unsigned size = map->size(map);
+    assert(size == 3);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    BTreeMapDeinit(map);
+}
+
+void ManipulateTextsCppStyle()
+{
+    char* names[4] = {"Alice\0", "Bob\0", "Chris\0", "David\0"};
+
+    /* We should initialize the container before any operations. */
+    BTreeMap* map = BTreeMapInit();
+
+    /* Set the custom key comparison functions. */
+    BTreeMapSetCompare(map, CompareKey);
+
+    /* If we plan to delegate the resource clean task to the container, set the
+       custom clean functions. */
+    BTreeMapSetCleanKey(map, CleanKey);
+    BTreeMapSetCleanValue(map, CleanValue);
+
+    /* Insert complex data payload into the map. */
+    char* key = strdup(names[0]);
+    Employ* employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 1;
+    employ->year = 25;
+    employ->level = 100;
+    map->put(map, (void*)key, (void*)employ);
+
+    key = strdup(names[1]);
+    employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 2;
+    employ->year = 25;
+    employ->level = 90;
+    map->put(map, (void*)key, (void*)employ);
+
+    key = strdup(names[2]);
+    employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 3;
+    employ->year = 25;
+    employ->level = 80;
+    map->put(map, (void*)key, (void*)employ);
+
+    key = strdup(names[3]);
+    employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 4;
+    employ->year = 25;
+    employ->level = 70;
+    map->put(map, (void*)key, (void*)employ);
+
+
+    /* Retrieve the value with the designated key. */
+    employ = (Employ*)map->get(map, (void*)names[0]);
+    assert(employ != NULL);
+    assert(employ->id == 1);
+    assert(employ->year == 25);
+    assert(employ->level == 100);
+
+    /* Iterate through the map. */
+    Pair* ptr_pair;
+    map->first(map);
+    int first = 0, second = 1;
+    while ((ptr_pair = map->next(map)) != NULL) {
+        char* name = (char*)ptr_pair->key;
+        employ = (Employ*)ptr_pair->value;
+        assert(strcmp(name, names[first]) == 0);
+        assert(employ->id == second);
+        ++first;
+        ++second;
+    }
+
+    map->first(map);
+    first = 3;
+    second = 4;
+    while ((ptr_pair = map->reverse_next(map)) != NULL) {
+        char* name = (char*)ptr_pair->key;
+        employ = (Employ*)ptr_pair->value;
+        assert(strcmp(name, names[first]) == 0);
+        assert(employ->id == second);
+        --first;
+        --second;
+    }
+
+    /* Remove the key value pair with the designated key. */
+    map->remove(map, (void*)names[1]);
+
+    /* Check the map keys. */
+    assert(map->find(map, (void*)names[0]) == true);
+    assert(map->find(map, (void*)names[1]) == false);
+    assert(map->find(map, (void*)names[2]) == true);
+    assert(map->find(map, (void*)names[3]) == true);
+
+    /* Check the pair count in the map. */
+    unsigned size = map->size(map);
+    assert(size == 3);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    BTreeMapDeinit(map);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateTexts();
+    ManipulateNumericsCppStyle();
+    ManipulateTextsCppStyle();
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <pthread.h>
+#include "cds.h"
+
+
+#define NUM_THREAD 4
+#define NUM_KEY 1000
+
+typedef struct Task_ {
+    ConcurrentHashMap* map;
+    int bgn;
+} Task;
+
+
+void* Populate(void* arg)
+{
+    Task* task = (Task*)arg;
+    ConcurrentHashMap* map = task->map;
+
+    /* Each thread inserts its own keys into the shared map. */
+    int i;
+    for (i = task->bgn ; i < task->bgn + NUM_KEY ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)(i * 2));
+    return NULL;
+}
+
+void SumValue(Pair* ptr_pair, void* arg)
+{
+    long* sum = (long*)arg;
+    *sum += (long)(intptr_t)ptr_pair->value;
+}
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    ConcurrentHashMap* map = ConcurrentHashMapInit(0);
+
+    /* Insert numerics into the map. */
+    ConcurrentHashMapPut(map, (void*)(intptr_t)1, (void*)(intptr_t)999);
+    ConcurrentHashMapPut(map, (void*)(intptr_t)2, (void*)(intptr_t)99);
+    ConcurrentHashMapPut(map, (void*)(intptr_t)3, (void*)(intptr_t)9);
+
+    /* Retrieve the value with the designated key. */
+    int val = (int)(intptr_t)ConcurrentHashMapGet(map, (void*)(intptr_t)1);
+    assert(val == 999);
+
+    /* Remove the key value pair with the designated key. */
+    ConcurrentHashMapRemove(map, (void*)(intptr_t)2);
+
+    /* Check the map keys. */
+    assert(ConcurrentHashMapContain(map, (void*)(intptr_t)1) == true);
+    assert(ConcurrentHashMapContain(map, (void*)(intptr_t)2) == false);
+    assert(ConcurrentHashMapContain(map, (void*)(intptr_t)3) == true);
+
+    /* Check the pair count in the map. */
+    unsigned size = ConcurrentHashMapSize(map);
+    assert(size == 2);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    ConcurrentHashMapDeinit(map);
+}
+
+void ManipulateMultiThread()
+{
+    /* We should initialize the container before any operations. */
+    ConcurrentHashMap* map = ConcurrentHashMapInit(0);
+
+    /* Share the map among several threads. */
+    pthread_t threads[NUM_THREAD];
+    Task tasks[NUM_THREAD];
+    int i;
+    for (i = 0 ; i < NUM_THREAD ; ++i) {
+        tasks[i].map = map;
+        tasks[i].bgn = i * NUM_KEY;
+        pthread_create(&threads[i], NULL, Populate, &tasks[i]);
+    }
+    for (i = 0 ; i < NUM_THREAD ; ++i)
+        pthread_join(threads[i], NULL);
+
+    /* Check the pair count in the map. */
+    assert(map->size(map) == NUM_THREAD * NUM_KEY);
+
+    /* Visit all the pairs in the map. */
+    long sum = 0;
+    map->for_each(map, SumValue, &sum);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    ConcurrentHashMapDeinit(map);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateMultiThread();
+    return 0;
+}
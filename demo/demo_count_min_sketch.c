@@ -0,0 +1,68 @@
+#include "cds.h"
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. The sketch
+       tracks the top 2 heavy hitters. */
+    CountMinSketch* sketch = CountMinSketchInit(0.001, 0.01, 2);
+
+    /* Count the occurrences of numerics. */
+    CountMinSketchAdd(sketch, (void*)(intptr_t)1, 100);
+    CountMinSketchAdd(sketch, (void*)(intptr_t)2, 10);
+    CountMinSketchAdd(sketch, (void*)(intptr_t)3, 50);
+    CountMinSketchAdd(sketch, (void*)(intptr_t)3, 1);
+
+    /* The estimate never goes below the true count. */
+    assert(CountMinSketchEstimate(sketch, (void*)(intptr_t)3) >= 51);
+    assert(CountMinSketchTotal(sketch) == 161);
+
+    /* Retrieve the heavy hitters in descending order. */
+    void* keys[2];
+    uint64_t counts[2];
+    unsigned num = CountMinSketchTopK(sketch, keys, counts);
+    assert(num == 2);
+    assert((int)(intptr_t)keys[0] == 1);
+    assert((int)(intptr_t)keys[1] == 3);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    CountMinSketchDeinit(sketch);
+}
+
+void ManipulateStringsCppStyle()
+{
+    char* pages[3] = {"/index", "/login", "/about"};
+
+    /* Each worker counts its own share of the stream with the string keys
+       hashed by their content. */
+    CountMinSketch* workers[2];
+    int i;
+    for (i = 0 ; i < 2 ; ++i) {
+        workers[i] = CountMinSketchInit(0.001, 0.01, 2);
+        workers[i]->set_hash(workers[i], HashString64);
+    }
+    workers[0]->add(workers[0], pages[0], 30);
+    workers[0]->add(workers[0], pages[1], 20);
+    workers[1]->add(workers[1], pages[0], 5);
+    workers[1]->add(workers[1], pages[2], 40);
+
+    /* The sketches are cheaply merged at the end. */
+    workers[0]->merge(workers[0], workers[1]);
+    assert(workers[0]->estimate(workers[0], pages[0]) >= 35);
+
+    void* keys[2];
+    unsigned num = workers[0]->top_k(workers[0], keys, NULL);
+    assert(num == 2);
+    assert(strcmp((char*)keys[0], "/about") == 0);
+    assert(strcmp((char*)keys[1], "/index") == 0);
+
+    for (i = 0 ; i < 2 ; ++i)
+        CountMinSketchDeinit(workers[i]);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateStringsCppStyle();
+    return 0;
+}
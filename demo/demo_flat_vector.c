@@ -0,0 +1,89 @@
+#include "cds.h"
+
+
+typedef struct Point_ {
+    int x;
+    int y;
+} Point;
+
+int ComparePoint(const void* lhs, const void* rhs)
+{
+    int x_lhs = ((const Point*)lhs)->x;
+    int x_rhs = ((const Point*)rhs)->x;
+    if (x_lhs == x_rhs)
+        return 0;
+    return (x_lhs > x_rhs)? 1 : -1;
+}
+
+
+void FlatVectorDemo()
+{
+    /* We should initialize the container with the element size. */
+    FlatVector* vector = FlatVectorInit(sizeof(Point), 4);
+
+    /* Copy the elements into the vector. */
+    Point point = {3, 30};
+    FlatVectorPushBack(vector, &point);
+    point.x = 1;
+    point.y = 10;
+    FlatVectorPushBack(vector, &point);
+
+    /* Construct the element in place. */
+    Point* slot = (Point*)FlatVectorEmplaceBack(vector);
+    slot->x = 2;
+    slot->y = 20;
+
+    /*---------------------------------------------------------------*
+     * Now the vector should be: [3, 30] | [1, 10] | [2, 20]         *
+     *---------------------------------------------------------------*/
+
+    FlatVectorSort(vector, ComparePoint);
+
+    /* Scan the contiguous elements directly. */
+    Point* points = FLAT_VECTOR_ARRAY(vector, Point);
+    unsigned size = FlatVectorSize(vector);
+    int sum = 0;
+    unsigned i;
+    for (i = 0 ; i < size ; ++i)
+        sum += points[i].y;
+    assert(sum == 60);
+    assert(points[0].x == 1 && points[2].x == 3);
+
+    /* Copy out and remove the elements. */
+    FlatVectorGet(vector, 1, &point);
+    assert(point.y == 20);
+    FlatVectorRemove(vector, 0);
+    assert(FLAT_VECTOR_AT(vector, Point, 0).x == 2);
+
+    FlatVectorDeinit(vector);
+}
+
+void FlatVectorDemoCppStyle()
+{
+    FlatVector* vector = FlatVectorInit(sizeof(double), 0);
+
+    int i;
+    for (i = 0 ; i < 8 ; ++i) {
+        double* slot = (double*)vector->emplace_back(vector);
+        *slot = i * 0.5;
+    }
+
+    double value = -1.0;
+    vector->insert(vector, 0, &value);
+    assert(*(double*)vector->at(vector, 0) == -1.0);
+    assert(vector->size(vector) == 9);
+
+    vector->pop_back(vector);
+    vector->resize(vector, vector->size(vector));
+    assert(vector->capacity(vector) == 8);
+
+    FlatVectorDeinit(vector);
+}
+
+
+int main()
+{
+    FlatVectorDemo();
+    FlatVectorDemoCppStyle();
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "cds.h"
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    HyperLogLog* hll = HyperLogLogInit(14);
+
+    /* Insert numerics with duplicates into the estimator. */
+    int i;
+    for (i = 0 ; i < 10000 ; ++i)
+        HyperLogLogAdd(hll, (void*)(intptr_t)(i % 1000));
+
+    /* The estimate stays around the number of distinct keys. */
+    uint64_t count = HyperLogLogCount(hll);
+    assert(count > 950 && count < 1050);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    HyperLogLogDeinit(hll);
+}
+
+void ManipulateStringsCppStyle()
+{
+    /* Each worker estimates the distinct users of its own share. */
+    HyperLogLog* lhs = HyperLogLogInit(14);
+    HyperLogLog* rhs = HyperLogLogInit(14);
+    lhs->set_hash(lhs, HashString64);
+    rhs->set_hash(rhs, HashString64);
+
+    char buf[32];
+    int i;
+    for (i = 0 ; i < 20000 ; ++i) {
+        snprintf(buf, sizeof(buf), "user%d", i % 15000);
+        HyperLogLog* worker = (i % 2 == 0)? lhs : rhs;
+        worker->add(worker, buf);
+    }
+
+    /* The estimators are cheaply merged at the end. */
+    lhs->merge(lhs, rhs);
+    uint64_t count = lhs->count(lhs);
+    assert(count > 14000 && count < 16000);
+
+    HyperLogLogDeinit(rhs);
+    HyperLogLogDeinit(lhs);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateStringsCppStyle();
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <pthread.h>
+#include "cds.h"
+
+
+#define NUM_THREAD      (4)
+
+
+unsigned HashKey(void* key)
+{
+    char* str = (char*)key;
+    unsigned hash = 5381;
+    int c;
+    while ((c = *str++))
+        hash = ((hash << 5) + hash) + c;
+    return hash;
+}
+
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanObject(void* obj)
+{
+    free(obj);
+}
+
+size_t ChargeValue(void* key, void* value)
+{
+    return strlen((char*)key) + strlen((char*)value);
+}
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    LruCache* cache = LruCacheInit(2, 0);
+
+    /* Insert pairs until the least recently used one is evicted. */
+    LruCachePut(cache, (void*)(intptr_t)1, (void*)(intptr_t)10);
+    LruCachePut(cache, (void*)(intptr_t)2, (void*)(intptr_t)20);
+    assert(LruCacheGet(cache, (void*)(intptr_t)1) == (void*)(intptr_t)10);
+    LruCachePut(cache, (void*)(intptr_t)3, (void*)(intptr_t)30);
+    assert(LruCacheContain(cache, (void*)(intptr_t)2) == false);
+    assert(LruCacheSize(cache) == 2);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    LruCacheDeinit(cache);
+}
+
+void ManipulateTexts()
+{
+    char buf[32];
+    LruCache* cache = LruCacheInit(0, 0);
+    LruCacheSetHash(cache, HashKey);
+    LruCacheSetCompare(cache, CompareKey);
+
+    /* The evicted pairs are released by the cleanup functions. */
+    LruCacheSetCleanKey(cache, CleanObject);
+    LruCacheSetCleanValue(cache, CleanObject);
+
+    /* Bound the cache by the number of bytes rather than the entries. */
+    LruCacheSetCharge(cache, ChargeValue, 256);
+    int i;
+    for (i = 0 ; i < 64 ; ++i) {
+        snprintf(buf, sizeof(buf), "key -> %d", i);
+        char* key = strdup(buf);
+        snprintf(buf, sizeof(buf), "value -> %d", i);
+        LruCachePut(cache, key, strdup(buf));
+    }
+    assert(LruCacheTotalCharge(cache) <= 256);
+
+    LruCacheDeinit(cache);
+}
+
+void* Access(void* arg)
+{
+    LruCache* cache = (LruCache*)arg;
+    int i;
+    for (i = 0 ; i < 1024 ; ++i) {
+        void* key = (void*)(intptr_t)(i % 384);
+        if (!LruCacheGet(cache, key))
+            LruCachePut(cache, key, key);
+    }
+    return NULL;
+}
+
+void ShareAmongThreads()
+{
+    /* The sharded cache can be shared by the threads. */
+    LruCache* cache = LruCacheInit(256, 16);
+    LruCacheSetClock(cache, true);
+
+    pthread_t threads[NUM_THREAD];
+    int i;
+    for (i = 0 ; i < NUM_THREAD ; ++i)
+        pthread_create(&threads[i], NULL, Access, cache);
+    for (i = 0 ; i < NUM_THREAD ; ++i)
+        pthread_join(threads[i], NULL);
+    assert(LruCacheSize(cache) <= 256);
+
+    LruCacheDeinit(cache);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateTexts();
+    ShareAmongThreads();
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <pthread.h>
+#include <sched.h>
+#include "cds.h"
+
+
+#define NUM_ELEMENT     (1024)
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    RingBuffer* buf = RingBufferInit(8, false);
+
+    /* Push the elements until the buffer is full. */
+    int i;
+    for (i = 1 ; i <= 8 ; ++i)
+        RingBufferPush(buf, (void*)(intptr_t)i);
+    assert(RingBufferPush(buf, (void*)(intptr_t)9) == false);
+
+    /* Pop the elements in the FIFO order. */
+    void* element;
+    RingBufferPop(buf, &element);
+    assert((int)(intptr_t)element == 1);
+
+    /* Pop the batch of elements. */
+    void* batch[8];
+    unsigned count = RingBufferPopN(buf, batch, 8);
+    assert(count == 7);
+    assert((int)(intptr_t)batch[0] == 2);
+    assert((int)(intptr_t)batch[6] == 8);
+    assert(RingBufferSize(buf) == 0);
+
+    RingBufferDeinit(buf);
+}
+
+void* Produce(void* arg)
+{
+    RingBuffer* buf = (RingBuffer*)arg;
+
+    /* Spin politely while the consumer drains the buffer. */
+    int i;
+    for (i = 1 ; i <= NUM_ELEMENT ; ++i) {
+        while (!buf->push(buf, (void*)(intptr_t)i))
+            sched_yield();
+    }
+    return NULL;
+}
+
+void ManipulateNumericsCppStyle()
+{
+    /* The multiple producer multiple consumer buffer allows any threads to
+       access it concurrently. */
+    RingBuffer* buf = RingBufferInit(64, true);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, Produce, buf);
+
+    /* Consume the elements passed from the producer thread. */
+    void* batch[16];
+    int expect = 1;
+    while (expect <= NUM_ELEMENT) {
+        unsigned count = buf->pop_n(buf, batch, 16);
+        unsigned i;
+        for (i = 0 ; i < count ; ++i) {
+            assert((int)(intptr_t)batch[i] == expect);
+            ++expect;
+        }
+        if (count == 0)
+            sched_yield();
+    }
+
+    pthread_join(thread, NULL);
+    RingBufferDeinit(buf);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateNumericsCppStyle();
+    return 0;
+}
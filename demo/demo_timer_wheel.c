@@ -0,0 +1,102 @@
+#include "cds.h"
+
+
+typedef struct Session_ {
+    int id;
+    TimerWheelHandle idle;
+} Session;
+
+
+void CleanObject(void* element)
+{
+    free(element);
+}
+
+/* Close the idle sessions passed in a batch. */
+void ExpireSession(void** elements, unsigned count, void* arg)
+{
+    int* p_closed = (int*)arg;
+    unsigned i;
+    for (i = 0 ; i < count ; ++i)
+        free(elements[i]);
+    *p_closed += count;
+}
+
+void ExpireNumeric(void** elements, unsigned count, void* arg)
+{
+    int* p_sum = (int*)arg;
+    unsigned i;
+    for (i = 0 ; i < count ; ++i)
+        *p_sum += (int)(intptr_t)elements[i];
+}
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. The ticks
+       here are counted in milliseconds. */
+    TimerWheel* wheel = TimerWheelInit(0);
+
+    /* Schedule the timers with various deadlines. */
+    TimerWheelSchedule(wheel, 10, (void*)(intptr_t)1);
+    TimerWheelSchedule(wheel, 500, (void*)(intptr_t)2);
+    TimerWheelHandle handle = TimerWheelSchedule(wheel, 3000, (void*)(intptr_t)4);
+    TimerWheelSchedule(wheel, 60000, (void*)(intptr_t)8);
+
+    /* The next deadline bounds the poll timeout. */
+    uint64_t tick;
+    TimerWheelNextExpire(wheel, &tick);
+    assert(tick == 10);
+
+    /* Cancel a timer and expire the others up to the given tick. */
+    TimerWheelCancel(wheel, handle);
+
+    int sum = 0;
+    unsigned count = TimerWheelAdvance(wheel, 5000, ExpireNumeric, &sum);
+    assert(count == 2);
+    assert(sum == 3);
+
+    /* Check the number of pending timers. */
+    unsigned size = TimerWheelSize(wheel);
+    assert(size == 1);
+
+    TimerWheelDeinit(wheel);
+}
+
+void ManipulateObjectsCppStyle()
+{
+    /* We should initialize the container before any operations. */
+    TimerWheel* wheel = TimerWheelInit(0);
+    wheel->set_clean(wheel, CleanObject);
+
+    /* Each session is closed after 30 seconds of inactivity. */
+    Session* sessions[4];
+    int i;
+    for (i = 0 ; i < 4 ; ++i) {
+        Session* session = (Session*)malloc(sizeof(Session));
+        session->id = i;
+        session->idle = wheel->schedule(wheel, 30000, session);
+        sessions[i] = session;
+    }
+
+    /* The active session pushes back its idle timer. */
+    wheel->reschedule(wheel, sessions[0]->idle, 10000 + 30000);
+    wheel->reschedule(wheel, sessions[1]->idle, 20000 + 30000);
+
+    int closed = 0;
+    wheel->advance(wheel, 35000, ExpireSession, &closed);
+    assert(closed == 2);
+
+    /* The remaining sessions are cleaned by the destructor. */
+    unsigned size = wheel->size(wheel);
+    assert(size == 2);
+
+    TimerWheelDeinit(wheel);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateObjectsCppStyle();
+    return 0;
+}
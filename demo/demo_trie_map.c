@@ -0,0 +1,93 @@
+#include "cds.h"
+
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+bool PrintRoute(const char* key, void* value, void* arg)
+{
+    printf("%s -> %s\n", key, (char*)value);
+    return true;
+}
+
+
+void TrieMapDemo()
+{
+    /* We should initialize the container before any operations. */
+    TrieMap* map = TrieMapInit();
+
+    /* Register the routing rules. The keys are copied into the map. */
+    TrieMapPut(map, "/", "index");
+    TrieMapPut(map, "/api", "api");
+    TrieMapPut(map, "/api/v1", "api-v1");
+    TrieMapPut(map, "/api/v1/users", "users");
+    TrieMapPut(map, "/static", "assets");
+
+    /* Retrieve the value with the designated key. */
+    assert(strcmp((char*)TrieMapGet(map, "/api"), "api") == 0);
+    assert(TrieMapGet(map, "/ap") == NULL);
+    assert(TrieMapFind(map, "/static") == true);
+
+    /* Resolve the requests to their most specific rules. */
+    void* value;
+    unsigned length = TrieMapLongestPrefixMatch(map, "/api/v1/users/7", &value);
+    assert(length == strlen("/api/v1/users"));
+    assert(strcmp((char*)value, "users") == 0);
+
+    length = TrieMapLongestPrefixMatch(map, "/api/v2/items", &value);
+    assert(length == strlen("/api"));
+    assert(strcmp((char*)value, "api") == 0);
+
+    /* Enumerate the rules under a prefix in lexicographic order. */
+    TrieMapVisitPrefix(map, "/api", 0, PrintRoute, NULL);
+
+    /* Remove the rule and fall back to the shorter one. */
+    TrieMapRemove(map, "/api/v1");
+    length = TrieMapLongestPrefixMatch(map, "/api/v1/items", &value);
+    assert(length == strlen("/api"));
+
+    TrieMapDeinit(map);
+}
+
+void TrieMapDemoCppStyle()
+{
+    /* We should initialize the container before any operations. */
+    TrieMap* map = TrieMapInit();
+
+    /* Let the map release the values. */
+    map->set_clean_value(map, CleanValue);
+
+    char* value = strdup("tcp");
+    map->put(map, "10.0.", value);
+    value = strdup("udp");
+    map->put(map, "10.0.1.", value);
+
+    /* The replaced value is released by the cleanup function. */
+    value = strdup("quic");
+    map->put(map, "10.0.1.", value);
+    assert(map->size(map) == 2);
+
+    void* route;
+    unsigned length = map->longest_prefix_match(map, "10.0.1.25", &route);
+    assert(length == strlen("10.0.1."));
+    assert(strcmp((char*)route, "quic") == 0);
+
+    length = map->longest_prefix_match(map, "10.0.2.25", &route);
+    assert(length == strlen("10.0."));
+    assert(strcmp((char*)route, "tcp") == 0);
+
+    map->remove(map, "10.0.");
+    assert(map->longest_prefix_match(map, "10.0.2.25", &route) == 0);
+
+    TrieMapDeinit(map);
+}
+
+
+int main()
+{
+    TrieMapDemo();
+    TrieMapDemoCppStyle();
+    return 0;
+}
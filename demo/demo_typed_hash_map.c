@@ -0,0 +1,104 @@
+#include "cds.h"
+
+
+typedef struct Employ_ {
+    int year;
+    int level;
+    int id;
+} Employ;
+
+
+/* The hash and comparison functions are bound at compile time, so they are
+   inlined into each map operation. */
+static inline unsigned HashId(int key)
+{
+    return (unsigned)key;
+}
+
+static inline int CompareId(int lhs, int rhs)
+{
+    return (lhs == rhs)? 0 : 1;
+}
+
+static inline unsigned HashName(const char* key)
+{
+    unsigned hash = 5381;
+    int c;
+    while ((c = *key++))
+        hash = ((hash << 5) + hash) + c;
+    return hash;
+}
+
+/* Generate the maps specialized for the designated key and value types. */
+TYPED_HASH_MAP_DEFINE(IdMap, int, int, HashId, CompareId)
+TYPED_HASH_MAP_DEFINE(EmployMap, const char*, Employ, HashName, strcmp)
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    IdMap* map = IdMapInit();
+
+    /* Insert numerics into the map. */
+    IdMapPut(map, 1, 999);
+    IdMapPut(map, 2, 99);
+    IdMapPut(map, 3, 9);
+
+    /* Retrieve the value with the designated key. */
+    int* val = IdMapGet(map, 1);
+    assert(*val == 999);
+
+    /* Iterate through the map. */
+    IdMapIter iter;
+    IdMapPair* ptr_pair;
+    IdMapIterInit(map, &iter);
+    while ((ptr_pair = IdMapIterNext(&iter)) != NULL) {
+        int key = ptr_pair->key;
+        int val = ptr_pair->value;
+    }
+
+    /* Remove the key value pair with the designated key. */
+    IdMapRemove(map, 2);
+
+    /* Check the map keys. */
+    assert(IdMapContain(map, 1) == true);
+    assert(IdMapContain(map, 2) == false);
+    assert(IdMapContain(map, 3) == true);
+
+    /* Check the pair count in the map. */
+    unsigned size = IdMapSize(map);
+    assert(size == 2);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    IdMapDeinit(map);
+}
+
+void ManipulateObjects()
+{
+    char* names[3] = {"Alice\0", "Bob\0", "Chris\0"};
+
+    /* Reserve the room for the pairs in advance. */
+    EmployMap* map = EmployMapInitCapacity(3);
+
+    /* The structures are copied into the map. */
+    int i;
+    for (i = 0 ; i < 3 ; ++i) {
+        Employ employ = {2016 - i, i, i};
+        EmployMapPut(map, names[i], employ);
+    }
+
+    /* The stored structure can be updated in place. */
+    Employ* employ = EmployMapGet(map, "Bob");
+    assert(employ->year == 2015);
+    employ->level = 10;
+    assert(EmployMapGet(map, "Bob")->level == 10);
+
+    EmployMapDeinit(map);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateObjects();
+    return 0;
+}
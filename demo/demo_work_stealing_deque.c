@@ -0,0 +1,90 @@
+#include <pthread.h>
+#include <sched.h>
+#include "cds.h"
+
+
+#define NUM_TASK        (1024)
+
+
+typedef struct Job_ {
+    WorkStealingDeque* deque;
+    int done;
+    int sum;
+} Job;
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    WorkStealingDeque* deque = WorkStealingDequeInit(0);
+
+    /* Push the elements by the owner thread. */
+    WorkStealingDequePush(deque, (void*)(intptr_t)1);
+    WorkStealingDequePush(deque, (void*)(intptr_t)2);
+    WorkStealingDequePush(deque, (void*)(intptr_t)3);
+
+    /* The owner pops the most recently pushed element. */
+    void* element;
+    WorkStealingDequePop(deque, &element);
+    assert((int)(intptr_t)element == 3);
+
+    /* The thief steals the least recently pushed element. */
+    WorkStealingDequeSteal(deque, &element);
+    assert((int)(intptr_t)element == 1);
+
+    assert(WorkStealingDequeSize(deque) == 1);
+    WorkStealingDequeDeinit(deque);
+}
+
+void* Steal(void* arg)
+{
+    Job* job = (Job*)arg;
+    WorkStealingDeque* deque = job->deque;
+
+    /* Keep stealing until the owner announces the end of the work. */
+    while (true) {
+        void* element;
+        if (deque->steal(deque, &element))
+            job->sum += (int)(intptr_t)element;
+        else if (__atomic_load_n(&(job->done), __ATOMIC_ACQUIRE))
+            break;
+        else
+            sched_yield();
+    }
+    return NULL;
+}
+
+void ManipulateNumericsCppStyle()
+{
+    WorkStealingDeque* deque = WorkStealingDequeInit(0);
+    Job job = {deque, 0, 0};
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, Steal, &job);
+
+    /* The owner shares the work with the thief. */
+    int sum = 0;
+    int i;
+    for (i = 1 ; i <= NUM_TASK ; ++i) {
+        deque->push(deque, (void*)(intptr_t)i);
+        void* element;
+        if ((i & 1) && deque->pop(deque, &element))
+            sum += (int)(intptr_t)element;
+    }
+
+    void* element;
+    while (deque->pop(deque, &element))
+        sum += (int)(intptr_t)element;
+    __atomic_store_n(&(job.done), 1, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+
+    assert(sum + job.sum == NUM_TASK * (NUM_TASK + 1) / 2);
+    WorkStealingDequeDeinit(deque);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateNumericsCppStyle();
+    return 0;
+}
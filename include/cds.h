@@ -1,11 +1,27 @@
 #include "util.h"
 #include "container/vector.h"
+#include "container/flat_vector.h"
 #include "container/list.h"
+#include "container/unrolled_list.h"
 #include "container/tree_map.h"
+#include "container/btree_map.h"
+#include "container/persistent_tree_map.h"
 #include "container/hash_map.h"
+#include "container/flat_hash_map.h"
+#include "container/typed_hash_map.h"
+#include "container/concurrent_hash_map.h"
 #include "container/hash_set.h"
+#include "container/bloom_filter.h"
+#include "container/count_min_sketch.h"
+#include "container/hyper_log_log.h"
+#include "container/lru_cache.h"
 #include "container/stack.h"
+#include "container/work_stealing_deque.h"
 #include "container/queue.h"
+#include "container/ring_buffer.h"
 #include "container/priority_queue.h"
+#include "container/timer_wheel.h"
 #include "container/trie.h"
-#include "math/hash.h"
\ No newline at end of file
+#include "container/trie_map.h"
+#include "math/hash.h"
+#include "memory/pool.h"
\ No newline at end of file
@@ -0,0 +1,201 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file bloom_filter.h The blocked Bloom filter for probabilistic membership.
+ */
+
+#ifndef _BLOOM_FILTER_H_
+#define _BLOOM_FILTER_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** BloomFilterData is the data type for the container private information. */
+typedef struct _BloomFilterData BloomFilterData;
+
+/** Calculate the 64 bit hash value of the key. */
+typedef uint64_t (*BloomFilterHash) (void*);
+
+
+/** The implementation for blocked Bloom filter. */
+typedef struct _BloomFilter {
+    /** The container private information */
+    BloomFilterData *data;
+
+    /** Insert a key into the filter.
+        @see BloomFilterAdd */
+    void (*add) (struct _BloomFilter*, void*);
+
+    /** Check if the filter may contain the specified key.
+        @see BloomFilterContain */
+    bool (*contain) (struct _BloomFilter*, void*);
+
+    /** Insert a precomputed hash value into the filter.
+        @see BloomFilterAddHash */
+    void (*add_hash) (struct _BloomFilter*, uint64_t);
+
+    /** Check if the filter may contain the precomputed hash value.
+        @see BloomFilterContainHash */
+    bool (*contain_hash) (struct _BloomFilter*, uint64_t);
+
+    /** Return the number of inserted keys.
+        @see BloomFilterSize */
+    unsigned (*size) (struct _BloomFilter*);
+
+    /** Return the number of keys the filter is sized for.
+        @see BloomFilterCapacity */
+    unsigned (*capacity) (struct _BloomFilter*);
+
+    /** Remove all the inserted keys.
+        @see BloomFilterClear */
+    void (*clear) (struct _BloomFilter*);
+
+    /** Set the custom hash function.
+        @see BloomFilterSetHash */
+    void (*set_hash) (struct _BloomFilter*, BloomFilterHash);
+} BloomFilter;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for BloomFilter.
+ *
+ * The bit array is split into cache line sized blocks, and all the bits of a
+ * key are set within a single block. Thus each query touches only one cache
+ * line at the cost of a slightly higher false positive rate than the classic
+ * layout. The number of bits per key and the number of probes are derived from
+ * the designated false positive rate.
+ *
+ * @param capacity      The expected number of keys, 0 for default
+ * @param fp_rate       The expected false positive rate in (0, 1), otherwise
+ *                      the default 1% is applied
+ *
+ * @retval obj          The successfully constructed filter
+ * @retval NULL         Insufficient memory for filter construction
+ */
+BloomFilter* BloomFilterInit(unsigned capacity, double fp_rate);
+
+/**
+ * @brief The destructor for BloomFilter.
+ *
+ * @param obj           The pointer to the to be destructed filter
+ */
+void BloomFilterDeinit(BloomFilter* obj);
+
+/**
+ * @brief Insert a key into the filter.
+ *
+ * The key is hashed by the designated hash function. By default, the key
+ * itself is treated as the hashed value.
+ *
+ * @param self          The pointer to BloomFilter structure
+ * @param key           The specified key
+ */
+void BloomFilterAdd(BloomFilter* self, void* key);
+
+/**
+ * @brief Check if the filter may contain the specified key.
+ *
+ * @param self          The pointer to BloomFilter structure
+ * @param key           The specified key
+ *
+ * @retval true         The key may have been inserted
+ * @retval false        The key has never been inserted
+ */
+bool BloomFilterContain(BloomFilter* self, void* key);
+
+/**
+ * @brief Insert a precomputed hash value into the filter.
+ *
+ * The value is further scrambled, so the hash values of a weak function, like
+ * the ones cached by HashSet or HashMap, can be directly passed.
+ *
+ * @param self          The pointer to BloomFilter structure
+ * @param hash          The hash value of the key
+ */
+void BloomFilterAddHash(BloomFilter* self, uint64_t hash);
+
+/**
+ * @brief Check if the filter may contain the precomputed hash value.
+ *
+ * @param self          The pointer to BloomFilter structure
+ * @param hash          The hash value of the key
+ *
+ * @retval true         The hash value may have been inserted
+ * @retval false        The hash value has never been inserted
+ */
+bool BloomFilterContainHash(BloomFilter* self, uint64_t hash);
+
+/**
+ * @brief Return the number of inserted keys.
+ *
+ * The duplicated insertions are also counted.
+ *
+ * @param self          The pointer to BloomFilter structure
+ *
+ * @retval size         The number of inserted keys
+ */
+unsigned BloomFilterSize(BloomFilter* self);
+
+/**
+ * @brief Return the number of keys the filter is sized for.
+ *
+ * Inserting more keys is allowed but the false positive rate grows.
+ *
+ * @param self          The pointer to BloomFilter structure
+ *
+ * @retval capacity     The expected number of keys
+ */
+unsigned BloomFilterCapacity(BloomFilter* self);
+
+/**
+ * @brief Remove all the inserted keys.
+ *
+ * @param self          The pointer to BloomFilter structure
+ */
+void BloomFilterClear(BloomFilter* self);
+
+/**
+ * @brief Set the custom hash function.
+ *
+ * For the string keys, HashString64 in math/hash.h can be passed directly. The
+ * other functions there, like HashFast64, take the key size and should be
+ * wrapped to this signature.
+ *
+ * @param self          The pointer to BloomFilter structure
+ * @param func          The custom function, NULL to restore the default one
+ */
+void BloomFilterSetHash(BloomFilter* self, BloomFilterHash func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,387 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file btree_map.h The ordered map to store key value pairs in wide B-tree
+ * nodes.
+ */
+
+#ifndef _BTREE_MAP_H_
+#define _BTREE_MAP_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** BTreeMapData is the data type for the container private information. */
+typedef struct _BTreeMapData BTreeMapData;
+
+/** Compare the equality of two keys. */
+typedef int (*BTreeMapCompare) (void*, void*);
+
+/** Key cleanup function called whenever a live entry is removed. */
+typedef void (*BTreeMapCleanKey) (void*);
+
+/** Value cleanup function called whenever a live entry is removed. */
+typedef void (*BTreeMapCleanValue) (void*);
+
+
+/**
+ * The implementation for ordered map backed by B-tree.
+ *
+ * Each tree node stores dozens of key value pairs in a contiguous array, so
+ * the tree is much shallower than a binary one, and a lookup touches only a
+ * few nodes. The semantics are the same as TreeMap.
+ */
+typedef struct _BTreeMap {
+    /** The container private information */
+    BTreeMapData *data;
+
+    /** Insert a key value pair into the map.
+        @see BTreeMapPut */
+    bool (*put) (struct _BTreeMap*, void*, void*);
+
+    /** Retrieve the value corresponding to the designated key.
+        @see BTreeMapGet */
+    void* (*get) (struct _BTreeMap*, void*);
+
+    /** Check if the map contains the designated key.
+        @see BTreeMapFind */
+    bool (*find) (struct _BTreeMap*, void*);
+
+    /** Delete the key value pair corresponding to the designated key.
+        @see BTreeMapRemove */
+    bool (*remove) (struct _BTreeMap*, void*);
+
+    /** Return the number of stored key value pairs.
+        @see BTreeMapSize */
+    unsigned (*size) (struct _BTreeMap*);
+
+    /** Retrieve the key value pair with the minimum order from the map.
+        @see BTreeMapMinimum */
+    Pair* (*minimum) (struct _BTreeMap*);
+
+    /** Retrieve the key value pair with the maximum order from the map.
+        @see BTreeMapMaximum */
+    Pair* (*maximum) (struct _BTreeMap*);
+
+    /** Retrieve the key value pair which is the predecessor of the given key.
+        @see BTreeMapPredecessor */
+    Pair* (*predecessor) (struct _BTreeMap*, void*);
+
+    /** Retrieve the key value pair which is the successor of the given key.
+        @see BTreeMapSuccessor */
+    Pair* (*successor) (struct _BTreeMap*, void*);
+
+    /** Initialize the map iterator.
+        @see BTreeMapFirst */
+    void (*first) (struct _BTreeMap*);
+
+    /** Get the key value pair pointed by the iterator and advance the iterator.
+        @see BTreeMapNext */
+    Pair* (*next) (struct _BTreeMap*);
+
+    /** Get the key value pair pointed by the iterator and advance the iterator
+        in the reverse order.
+        @see BTreeMapNext */
+    Pair* (*reverse_next) (struct _BTreeMap*);
+
+    /** Set the custom key comparison function.
+        @see BTreeMapSetCompare */
+    void (*set_compare) (struct _BTreeMap*, BTreeMapCompare);
+
+    /** Set the custom key cleanup function.
+        @see BTreeMapSetCleanKey */
+    void (*set_clean_key) (struct _BTreeMap*, BTreeMapCleanKey);
+
+    /** Set the custom value cleanup function.
+        @see BTreeMapSetCleanValue */
+    void (*set_clean_value) (struct _BTreeMap*, BTreeMapCleanValue);
+
+    /** Set the allocator for the tree nodes.
+        @see BTreeMapSetAllocator */
+    bool (*set_allocator) (struct _BTreeMap*, const Allocator*);
+
+    /** Manage the tree nodes with an internal object pool.
+        @see BTreeMapUsePool */
+    bool (*use_pool) (struct _BTreeMap*);
+} BTreeMap;
+
+/** The external iterator for BTreeMap which is allocated by the caller. */
+typedef struct _BTreeMapIter {
+    void* node_;
+    unsigned index_;
+    bool is_reverse_;
+} BTreeMapIter;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for BTreeMap.
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+BTreeMap* BTreeMapInit();
+
+/**
+ * @brief The destructor for BTreeMap.
+ *
+ * @param obj           The pointer to the to be destructed map
+ */
+void BTreeMapDeinit(BTreeMap* obj);
+
+/**
+ * @brief Insert a key value pair into the map.
+ *
+ * This function inserts a key value pair into the map. If the designated key is
+ * equal to a certain one stored in the map, the existing pair will be replaced.
+ * Also, the cleanup functions are invoked for that replaced pair.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ * @param value         The designated value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        The pair cannot be inserted due to insufficient memory
+ *
+ * @note The pairs are shifted among the node arrays by insertion and removal,
+ *  so the pair pointers returned by other functions are invalidated by any map
+ *  modification.
+ */
+bool BTreeMapPut(BTreeMap* self, void* key, void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the designated key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ */
+void* BTreeMapGet(BTreeMap* self, void* key);
+
+/**
+ * @brief Check if the map contains the designated key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool BTreeMapFind(BTreeMap* self, void* key);
+
+/**
+ * @brief Remove the key value pair corresponding to the designated key.
+ *
+ * This function removes the key value pair corresponding to the designated key.
+ * Also, the cleanup functions are invoked for that removed pair.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The pair is successfully removed
+ * @retval false        The key cannot be found
+ */
+bool BTreeMapRemove(BTreeMap* self, void* key);
+
+/**
+ * @brief Return the number of stored key value pairs.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval size         The number of stored pairs
+ */
+unsigned BTreeMapSize(BTreeMap* self);
+
+/**
+ * @brief Retrieve the key value pair with the minimum order from the map.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty
+ */
+Pair* BTreeMapMinimum(BTreeMap* self);
+
+/**
+ * @brief Retrieve the key value pair with the maximum order from the map.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty
+ */
+Pair* BTreeMapMaximum(BTreeMap* self);
+
+/**
+ * @brief Retrieve the key value pair which is the predecessor of the given key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty or the key has he minimum order
+ */
+Pair* BTreeMapPredecessor(BTreeMap* self, void* key);
+
+/**
+ * @brief Retrieve the key value pair which is the successor of the given key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty or the key has the maximum order
+ */
+Pair* BTreeMapSuccessor(BTreeMap* self, void* key);
+
+/**
+ * @brief Initialize the map iterator.
+ *
+ * @param self          The pointer to BTreeMap structure
+ */
+void BTreeMapFirst(BTreeMap* self);
+
+/**
+ * @brief Get the key value pair pointed by the iterator and advance the iterator.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The map end is reached
+ */
+Pair* BTreeMapNext(BTreeMap* self);
+
+/**
+ * @brief Get the key value pair pointed by the iterator and advance the iterator
+ * in the reverse order.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The map end is reached
+ */
+Pair* BTreeMapReverseNext(BTreeMap* self);
+
+/**
+ * @brief Initialize the external iterator.
+ *
+ * Unlike the internal iterator maintained by BTreeMapFirst and BTreeMapNext, the
+ * external iterator keeps its cursor in the caller provided structure. So any
+ * number of iterators can traverse the map simultaneously, and the traversal
+ * does not modify the map.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param iter          The pointer to the to be initialized iterator
+ * @param is_reverse    Whether to apply the reversed traversal
+ *
+ * @note The iterator is invalidated by the map modification.
+ */
+void BTreeMapIterInit(BTreeMap* self, BTreeMapIter* iter, bool is_reverse);
+
+/**
+ * @brief Get the key value pair pointed by the external iterator and advance it.
+ *
+ * @param iter          The pointer to the external iterator
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The map end is reached
+ */
+Pair* BTreeMapIterNext(BTreeMapIter* iter);
+
+/**
+ * @brief Set the custom key comparison function.
+ *
+ * By default, key is treated as integer.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param func          The custom function
+ */
+void BTreeMapSetCompare(BTreeMap* self, BTreeMapCompare func);
+
+/**
+ * @brief Set the custom key cleanup function.
+ *
+ * By default, no cleanup operation for key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param func          The custom function
+ */
+void BTreeMapSetCleanKey(BTreeMap* self, BTreeMapCleanKey func);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param func          The custom function
+ */
+void BTreeMapSetCleanValue(BTreeMap* self, BTreeMapCleanValue func);
+
+/**
+ * @brief Set the allocator for the tree nodes.
+ *
+ * The leaf and the internal nodes have different sizes, and the allocator is
+ * requested with the corresponding size. By default, the global allocator
+ * returned by CdsGetAllocator at construction is applied. The allocator can
+ * only be replaced while the map is empty.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param alloc         The pointer to the allocator or NULL to restore the
+ *                      global one
+ *
+ * @retval true         The allocator is applied
+ * @retval false        The map is not empty
+ */
+bool BTreeMapSetAllocator(BTreeMap* self, const Allocator* alloc);
+
+/**
+ * @brief Manage the tree nodes with an internal object pool.
+ *
+ * The leaf and the internal nodes are carved from the large slabs of two
+ * separated pools without per node header. When the map is destructed, all
+ * the nodes are released at once, and the tree is traversed only if the
+ * cleanup functions are set. The pool can only be applied while the map is
+ * empty.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval true         The pool is applied
+ * @retval false        The map is not empty or memory allocation fails
+ */
+bool BTreeMapUsePool(BTreeMap* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,263 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file concurrent_hash_map.h The thread safe unordered map sharded by key hash.
+ */
+
+#ifndef _CONCURRENT_HASH_MAP_H_
+#define _CONCURRENT_HASH_MAP_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** ConcurrentHashMapData is the data type for the container private information. */
+typedef struct _ConcurrentHashMapData ConcurrentHashMapData;
+
+/** Calculate the hash of the given key. */
+typedef unsigned (*ConcurrentHashMapHash) (void*);
+
+/** Compare the equality of two keys. */
+typedef int (*ConcurrentHashMapCompare) (void*, void*);
+
+/** Key cleanup function called whenever a live entry is removed. */
+typedef void (*ConcurrentHashMapCleanKey) (void*);
+
+/** Value cleanup function called whenever a live entry is removed. */
+typedef void (*ConcurrentHashMapCleanValue) (void*);
+
+/** Visit function called for each stored key value pair. */
+typedef void (*ConcurrentHashMapVisit) (Pair*, void*);
+
+
+/** The implementation for concurrent hash map. */
+typedef struct _ConcurrentHashMap {
+    /** The container private information */
+    ConcurrentHashMapData *data;
+
+    /** Insert a key value pair into the map.
+        @see ConcurrentHashMapPut */
+    bool (*put) (struct _ConcurrentHashMap*, void*, void*);
+
+    /** Retrieve the value corresponding to the specified key.
+        @see ConcurrentHashMapGet */
+    void* (*get) (struct _ConcurrentHashMap*, void*);
+
+    /** Check if the map contains the specified key.
+        @see ConcurrentHashMapContain */
+    bool (*contain) (struct _ConcurrentHashMap*, void*);
+
+    /** Remove the key value pair corresponding to the specified key.
+        @see ConcurrentHashMapRemove */
+    bool (*remove) (struct _ConcurrentHashMap*, void*);
+
+    /** Return the number of stored key value pairs.
+        @see ConcurrentHashMapSize */
+    unsigned (*size) (struct _ConcurrentHashMap*);
+
+    /** Visit all the stored key value pairs.
+        @see ConcurrentHashMapForEach */
+    void (*for_each) (struct _ConcurrentHashMap*, ConcurrentHashMapVisit, void*);
+
+    /** Set the custom hash function.
+        @see ConcurrentHashMapSetHash */
+    void (*set_hash) (struct _ConcurrentHashMap*, ConcurrentHashMapHash);
+
+    /** Set the custom key comparison function.
+        @see ConcurrentHashMapSetCompare */
+    void (*set_compare) (struct _ConcurrentHashMap*, ConcurrentHashMapCompare);
+
+    /** Set the custom key cleanup function.
+        @see ConcurrentHashMapSetCleanKey */
+    void (*set_clean_key) (struct _ConcurrentHashMap*, ConcurrentHashMapCleanKey);
+
+    /** Set the custom value cleanup function.
+        @see ConcurrentHashMapSetCleanValue */
+    void (*set_clean_value) (struct _ConcurrentHashMap*, ConcurrentHashMapCleanValue);
+} ConcurrentHashMap;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for ConcurrentHashMap.
+ *
+ * The map is split into the designated number of shards. Each shard is a
+ * HashMap guarded by its own reader writer lock, and a key is dispatched to
+ * its shard by the scrambled key hash. Lookups in the same shard run in
+ * parallel, while updates only block the shard they touch.
+ *
+ * @param num_shard     The number of shards, which is rounded up to the power
+ *                      of two, or 0 to apply the default 16 shards
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+ConcurrentHashMap* ConcurrentHashMapInit(unsigned num_shard);
+
+/**
+ * @brief The destructor for ConcurrentHashMap.
+ *
+ * @param obj           The pointer to the to be destructed map
+ *
+ * @note The caller should guarantee that no other thread is accessing the map.
+ */
+void ConcurrentHashMapDeinit(ConcurrentHashMap* obj);
+
+/**
+ * @brief Insert a key value pair into the map.
+ *
+ * This function inserts a key value pair into the map. If the specified key is
+ * equal to a certain one stored in the map, the existing pair will be replaced.
+ * Also, the cleanup functions are invoked for that replaced pair.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ * @param key           The specified key
+ * @param value         The specified value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        The pair cannot be inserted due to insufficient memory
+ */
+bool ConcurrentHashMapPut(ConcurrentHashMap* self, void* key, void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the specified key.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ * @param key           The specified key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ *
+ * @note If the value cleanup function is set, the returned value may be
+ *  released by a concurrent put or remove of the same key.
+ */
+void* ConcurrentHashMapGet(ConcurrentHashMap* self, void* key);
+
+/**
+ * @brief Check if the map contains the specified key.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ * @param key           The specified key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool ConcurrentHashMapContain(ConcurrentHashMap* self, void* key);
+
+/**
+ * @brief Remove the key value pair corresponding to the specified key.
+ *
+ * This function removes the key value pair corresponding to the specified key.
+ * Also, the cleanup functions are invoked for that removed pair.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ * @param key           The specified key
+ *
+ * @retval true         The pair is successfully removed
+ * @retval false        The key cannot be found
+ */
+bool ConcurrentHashMapRemove(ConcurrentHashMap* self, void* key);
+
+/**
+ * @brief Return the number of stored key value pairs.
+ *
+ * The shards are counted one by one, so the result is only a snapshot when
+ * the map is concurrently updated.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ *
+ * @retval size         The number of stored pairs
+ */
+unsigned ConcurrentHashMapSize(ConcurrentHashMap* self);
+
+/**
+ * @brief Visit all the stored key value pairs.
+ *
+ * The shards are visited one by one, and each shard is locked in shared mode
+ * while its pairs are visited. So the traversals from multiple threads and
+ * the lookups proceed concurrently. The visit function should not modify the
+ * map, and should not modify the keys.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ * @param func          The visit function
+ * @param arg           The argument passed to the visit function
+ */
+void ConcurrentHashMapForEach(ConcurrentHashMap* self,
+                              ConcurrentHashMapVisit func, void* arg);
+
+/**
+ * @brief Set the custom hash function.
+ *
+ * By default, the integer value of the key is taken as its hash.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ * @param func          The custom function
+ *
+ * @note All the custom functions should be set before the map is shared.
+ */
+void ConcurrentHashMapSetHash(ConcurrentHashMap* self, ConcurrentHashMapHash func);
+
+/**
+ * @brief Set the custom key comparison function.
+ *
+ * By default, key is treated as integer.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ * @param func          The custom function
+ */
+void ConcurrentHashMapSetCompare(ConcurrentHashMap* self,
+                                 ConcurrentHashMapCompare func);
+
+/**
+ * @brief Set the custom key cleanup function.
+ *
+ * By default, no cleanup operation for key.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ * @param func          The custom function
+ */
+void ConcurrentHashMapSetCleanKey(ConcurrentHashMap* self,
+                                  ConcurrentHashMapCleanKey func);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value.
+ *
+ * @param self          The pointer to ConcurrentHashMap structure
+ * @param func          The custom function
+ */
+void ConcurrentHashMapSetCleanValue(ConcurrentHashMap* self,
+                                    ConcurrentHashMapCleanValue func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
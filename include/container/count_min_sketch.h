@@ -0,0 +1,272 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file count_min_sketch.h The fixed memory count-min sketch to estimate item
+ * frequencies and track the heavy hitters.
+ */
+
+#ifndef _COUNT_MIN_SKETCH_H_
+#define _COUNT_MIN_SKETCH_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** CountMinSketchData is the data type for the container private information. */
+typedef struct _CountMinSketchData CountMinSketchData;
+
+/** Calculate the 64 bit hash value of the key. */
+typedef uint64_t (*CountMinSketchHash) (void*);
+
+/** Key clean function called when the tracked key is discarded. */
+typedef void (*CountMinSketchClean) (void*);
+
+
+/** The implementation for count-min sketch. */
+typedef struct _CountMinSketch {
+    /** The container private information */
+    CountMinSketchData *data;
+
+    /** Count the occurrences of a key.
+        @see CountMinSketchAdd */
+    uint64_t (*add) (struct _CountMinSketch*, void*, uint64_t);
+
+    /** Estimate the number of occurrences of a key.
+        @see CountMinSketchEstimate */
+    uint64_t (*estimate) (struct _CountMinSketch*, void*);
+
+    /** Retrieve the heavy hitters in descending order of frequency.
+        @see CountMinSketchTopK */
+    unsigned (*top_k) (struct _CountMinSketch*, void**, uint64_t*);
+
+    /** Return the total number of counted occurrences.
+        @see CountMinSketchTotal */
+    uint64_t (*total) (struct _CountMinSketch*);
+
+    /** Merge another sketch into this one.
+        @see CountMinSketchMerge */
+    bool (*merge) (struct _CountMinSketch*, struct _CountMinSketch*);
+
+    /** Remove all the counted occurrences.
+        @see CountMinSketchClear */
+    void (*clear) (struct _CountMinSketch*);
+
+    /** Set the custom hash function.
+        @see CountMinSketchSetHash */
+    void (*set_hash) (struct _CountMinSketch*, CountMinSketchHash);
+
+    /** Set the custom key cleanup function.
+        @see CountMinSketchSetClean */
+    void (*set_clean) (struct _CountMinSketch*, CountMinSketchClean);
+} CountMinSketch;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for CountMinSketch.
+ *
+ * The sketch keeps a matrix of counters, and each key increments one counter
+ * per row. The frequency of a key is estimated by the minimum of its counters,
+ * which never goes below the true one and goes above it by at most epsilon
+ * times the total count with probability 1 - delta. The width of the matrix is
+ * e / epsilon rounded up to the power of two, and the depth is ln(1 / delta).
+ *
+ * The heavy hitters are tracked by a min-heap of the designated size built on
+ * PriorityQueue. A key replaces the least frequent tracked one once its
+ * estimate exceeds that of the latter.
+ *
+ * @param epsilon       The expected error rate in (0, 1) relative to the
+ *                      total count, otherwise the default 0.1% is applied
+ * @param delta         The expected failure probability in (0, 1), otherwise
+ *                      the default 1% is applied
+ * @param top_k         The number of tracked heavy hitters, 0 to disable
+ *
+ * @retval obj          The successfully constructed sketch
+ * @retval NULL         Insufficient memory for sketch construction
+ */
+CountMinSketch* CountMinSketchInit(double epsilon, double delta, unsigned top_k);
+
+/**
+ * @brief The destructor for CountMinSketch.
+ *
+ * The cleanup function is invoked for the tracked keys.
+ *
+ * @param obj           The pointer to the to be destructed sketch
+ */
+void CountMinSketchDeinit(CountMinSketch* obj);
+
+/**
+ * @brief Count the occurrences of a key.
+ *
+ * The key is hashed by the designated hash function. By default, the key
+ * itself is treated as the hashed value. The keys with the same hash value are
+ * treated as the same key.
+ *
+ * Without the cleanup function, the tracked keys are retained as given, so
+ * they should outlive the sketch, like the integer keys or the interned
+ * strings. With the cleanup function, the sketch takes the ownership of every
+ * passed key, and the one which is not tracked is cleaned at once.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param key           The specified key
+ * @param count         The number of occurrences
+ *
+ * @retval estimate     The estimated number of occurrences after counting
+ *
+ * @note The counters saturate at UINT32_MAX.
+ */
+uint64_t CountMinSketchAdd(CountMinSketch* self, void* key, uint64_t count);
+
+/**
+ * @brief Estimate the number of occurrences of a key.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param key           The specified key
+ *
+ * @retval estimate     The estimate which is not below the true count
+ */
+uint64_t CountMinSketchEstimate(CountMinSketch* self, void* key);
+
+/**
+ * @brief Retrieve the heavy hitters in descending order of frequency.
+ *
+ * The estimates are refreshed from the counters before sorting.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param keys          The array to store the tracked keys, which should hold
+ *                      the top_k keys designated at construction
+ * @param counts        The array to store the estimates or NULL
+ *
+ * @retval num          The number of the retrieved keys
+ */
+unsigned CountMinSketchTopK(CountMinSketch* self, void** keys,
+                            uint64_t* counts);
+
+/**
+ * @brief Return the total number of counted occurrences.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ *
+ * @retval total        The total count
+ */
+uint64_t CountMinSketchTotal(CountMinSketch* self);
+
+/**
+ * @brief Merge another sketch into this one.
+ *
+ * The counters are summed, so the merged sketch is the same as the one which
+ * counts both streams, and the sketches filled by different threads can be
+ * combined at the end. The heavy hitters of the source sketch are offered to
+ * the designated one with their merged estimates. The source sketch is intact.
+ *
+ * @param self          The pointer to the designated CountMinSketch structure
+ * @param other         The pointer to the source CountMinSketch structure
+ *
+ * @retval true         The sketches are successfully merged
+ * @retval false        The sketches have different dimensions
+ *
+ * @note Both sketches should apply the same hash function. The tracked keys
+ * of the source sketch are shared rather than copied. With the cleanup
+ * function, merge through CountMinSketchSnapshot and CountMinSketchRestore
+ * instead, which decode the private copies of the keys.
+ */
+bool CountMinSketchMerge(CountMinSketch* self, CountMinSketch* other);
+
+/**
+ * @brief Remove all the counted occurrences and the tracked keys.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ */
+void CountMinSketchClear(CountMinSketch* self);
+
+/**
+ * @brief Set the custom hash function.
+ *
+ * For the string keys, HashString64 in math/hash.h can be passed directly. The
+ * other functions there, like HashFast64, take the key size and should be
+ * wrapped to this signature. The hash value is further scrambled, so the weak
+ * one is acceptable.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param func          The custom function, NULL to restore the default one
+ */
+void CountMinSketchSetHash(CountMinSketch* self, CountMinSketchHash func);
+
+/**
+ * @brief Set the custom key cleanup function.
+ *
+ * By default, no cleanup operation for key.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param func          The custom function
+ */
+void CountMinSketchSetClean(CountMinSketch* self, CountMinSketchClean func);
+
+/**
+ * @brief Write the counters and the tracked keys to the snapshot stream.
+ *
+ * This ships the sketch to another node for merge. Without the codec, the key
+ * is treated as integer.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param writer        The pointer to the writer
+ * @param codec         The pointer to the key codec or NULL
+ *
+ * @retval true         The snapshot is completely written
+ * @retval false        Insufficient memory, or the writer or the codec fails
+ */
+bool CountMinSketchSnapshot(CountMinSketch* self, const SnapshotWriter* writer,
+                            const SnapshotCodec* codec);
+
+/**
+ * @brief Merge the sketch from the snapshot stream written by
+ * CountMinSketchSnapshot.
+ *
+ * The restore works like CountMinSketchMerge, so restoring into an empty
+ * sketch copies the source one. With the cleanup function, the decoded keys
+ * are owned by the sketch like the ones passed to CountMinSketchAdd.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param reader        The pointer to the reader
+ * @param codec         The pointer to the key codec or NULL
+ *
+ * @retval true         The snapshot is completely restored
+ * @retval false        Insufficient memory, the reader or the codec fails, or
+ *                      the snapshot is malformed or has different dimensions
+ *
+ * @note On failure, the counters may be partially merged.
+ */
+bool CountMinSketchRestore(CountMinSketch* self, const SnapshotReader* reader,
+                           const SnapshotCodec* codec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
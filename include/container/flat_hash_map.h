@@ -0,0 +1,286 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file flat_hash_map.h The open addressing unordered map to store key value
+ * pairs.
+ */
+
+#ifndef _FLAT_HASH_MAP_H_
+#define _FLAT_HASH_MAP_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** FlatHashMapData is the data type for the container private information. */
+typedef struct _FlatHashMapData FlatHashMapData;
+
+/** Calculate the hash of the given key. */
+typedef unsigned (*FlatHashMapHash) (void*);
+
+/** Compare the equality of two keys. */
+typedef int (*FlatHashMapCompare) (void*, void*);
+
+/** Key cleanup function called whenever a live entry is removed. */
+typedef void (*FlatHashMapCleanKey) (void*);
+
+/** Value cleanup function called whenever a live entry is removed. */
+typedef void (*FlatHashMapCleanValue) (void*);
+
+
+/** The implementation for open addressing hash map. */
+typedef struct _FlatHashMap {
+    /** The container private information */
+    FlatHashMapData *data;
+
+    /** Insert a key value pair into the map.
+        @see FlatHashMapPut */
+    bool (*put) (struct _FlatHashMap*, void*, void*);
+
+    /** Retrieve the value corresponding to the specified key.
+        @see FlatHashMapGet */
+    void* (*get) (struct _FlatHashMap*, void*);
+
+    /** Check if the map contains the specified key.
+        @see FlatHashMapContain */
+    bool (*contain) (struct _FlatHashMap*, void*);
+
+    /** Remove the key value pair corresponding to the specified key.
+        @see FlatHashMapRemove */
+    bool (*remove) (struct _FlatHashMap*, void*);
+
+    /** Return the number of stored key value pairs.
+        @see FlatHashMapSize */
+    unsigned (*size) (struct _FlatHashMap*);
+
+    /** Initialize the map iterator.
+        @see FlatHashMapFirst */
+    void (*first) (struct _FlatHashMap*);
+
+    /** Get the key value pair pointed by the iterator and advance the iterator
+        @see FlatHashMapNext */
+    Pair* (*next) (struct _FlatHashMap*);
+
+    /** Set the custom hash function.
+        @see FlatHashMapSetHash */
+    void (*set_hash) (struct _FlatHashMap*, FlatHashMapHash);
+
+    /** Set the custom key comparison function.
+        @see FlatHashMapSetCompare */
+    void (*set_compare) (struct _FlatHashMap*, FlatHashMapCompare);
+
+    /** Set the custom key cleanup function.
+        @see FlatHashMapSetCleanKey */
+    void (*set_clean_key) (struct _FlatHashMap*, FlatHashMapCleanKey);
+
+    /** Set the custom value cleanup function.
+        @see FlatHashMapSetCleanValue */
+    void (*set_clean_value) (struct _FlatHashMap*, FlatHashMapCleanValue);
+} FlatHashMap;
+
+/** The external iterator for FlatHashMap which is allocated by the caller. */
+typedef struct _FlatHashMapIter {
+    FlatHashMapData* data_;
+    unsigned slot_;
+} FlatHashMapIter;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for FlatHashMap.
+ *
+ * The pairs are stored inline in one contiguous slot array, and the probing is
+ * driven by a parallel array of one byte control tags. Each tag keeps 7 bits of
+ * the key hash so that most of the mismatched slots are filtered without
+ * touching the pairs or calling the key comparison function.
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+FlatHashMap* FlatHashMapInit();
+
+/**
+ * @brief The destructor for FlatHashMap.
+ *
+ * @param obj           The pointer to the to be destructed map
+ */
+void FlatHashMapDeinit(FlatHashMap* obj);
+
+/**
+ * @brief Insert a key value pair into the map.
+ *
+ * This function inserts a key value pair into the map. If the specified key is
+ * equal to a certain one stored in the map, the existing pair will be replaced.
+ * Also, the cleanup functions are invoked for that replaced pair.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ * @param key           The specified key
+ * @param value         The specified value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        The pair cannot be inserted due to insufficient memory
+ *
+ * @note Since the pairs are stored inline, any insertion may relocate them.
+ *  The pair pointers returned by the iterator are invalidated afterward.
+ */
+bool FlatHashMapPut(FlatHashMap* self, void* key, void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the specified key.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ * @param key           The specified key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ */
+void* FlatHashMapGet(FlatHashMap* self, void* key);
+
+/**
+ * @brief Check if the map contains the specified key.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ * @param key           The specified key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool FlatHashMapContain(FlatHashMap* self, void* key);
+
+/**
+ * @brief Remove the key value pair corresponding to the specified key.
+ *
+ * This function removes the key value pair corresponding to the specified key.
+ * Also, the cleanup functions are invoked for that removed pair.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ * @param key           The specified key
+ *
+ * @retval true         The pair is successfully removed
+ * @retval false        The key cannot be found
+ */
+bool FlatHashMapRemove(FlatHashMap* self, void* key);
+
+/**
+ * @brief Return the number of stored key value pairs.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ *
+ * @retval size         The number of stored pairs
+ */
+unsigned FlatHashMapSize(FlatHashMap* self);
+
+/**
+ * @brief Initialize the map iterator.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ */
+void FlatHashMapFirst(FlatHashMap* self);
+
+/**
+ * @brief Get the key value pair pointed by the iterator and advance the iterator.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The map end is reached
+ */
+Pair* FlatHashMapNext(FlatHashMap* self);
+
+/**
+ * @brief Initialize the external iterator.
+ *
+ * Unlike the internal iterator maintained by FlatHashMapFirst and
+ * FlatHashMapNext, the external iterator keeps its cursor in the caller
+ * provided structure. So any number of iterators can traverse the map
+ * simultaneously, and the traversal does not modify the map.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ * @param iter          The pointer to the to be initialized iterator
+ *
+ * @note The iterator is invalidated by the map modification.
+ */
+void FlatHashMapIterInit(FlatHashMap* self, FlatHashMapIter* iter);
+
+/**
+ * @brief Get the key value pair pointed by the external iterator and advance it.
+ *
+ * @param iter          The pointer to the external iterator
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The map end is reached
+ */
+Pair* FlatHashMapIterNext(FlatHashMapIter* iter);
+
+/**
+ * @brief Set the custom hash function.
+ *
+ * By default, key is treated as integer. Since the slot index is derived from
+ * both the high and low bits, the hash value is further scrambled internally.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ * @param func          The custom function
+ */
+void FlatHashMapSetHash(FlatHashMap* self, FlatHashMapHash func);
+
+/**
+ * @brief Set the custom key comparison function.
+ *
+ * By default, key is treated as integer.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ * @param func          The custom function
+ */
+void FlatHashMapSetCompare(FlatHashMap* self, FlatHashMapCompare func);
+
+/**
+ * @brief Set the custom key cleanup function.
+ *
+ * By default, no cleanup operation for key.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ * @param func          The custom function
+ */
+void FlatHashMapSetCleanKey(FlatHashMap* self, FlatHashMapCleanKey func);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value.
+ *
+ * @param self          The pointer to FlatHashMap structure
+ * @param func          The custom function
+ */
+void FlatHashMapSetCleanValue(FlatHashMap* self, FlatHashMapCleanValue func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,340 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+/**
+ * @file flat_vector.h The dynamically growable array storing elements by value.
+ */
+
+#ifndef _FLAT_VECTOR_H_
+#define _FLAT_VECTOR_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** FlatVectorData is the data type for the container private information. */
+typedef struct _FlatVectorData FlatVectorData;
+
+/** Element comparison function called with the addresses of two elements. */
+typedef int (*FlatVectorCompare) (const void*, const void*);
+
+/** Element clean function called with the address of the removed element. */
+typedef void (*FlatVectorClean) (void*);
+
+
+/** The implementation for dynamically growable array storing elements by value. */
+typedef struct _FlatVector {
+    /** The container private information */
+    FlatVectorData *data;
+
+    /** Copy an element to the tail of the vector.
+        @see FlatVectorPushBack */
+    bool (*push_back) (struct _FlatVector*, const void*);
+
+    /** Reserve an element slot at the tail of the vector.
+        @see FlatVectorEmplaceBack */
+    void* (*emplace_back) (struct _FlatVector*);
+
+    /** Copy an element to the specified index of the vector.
+        @see FlatVectorInsert */
+    bool (*insert) (struct _FlatVector*, unsigned, const void*);
+
+    /** Reserve an element slot at the specified index of the vector.
+        @see FlatVectorEmplace */
+    void* (*emplace) (struct _FlatVector*, unsigned);
+
+    /** Pop an element from the tail of the vector.
+        @see FlatVectorPopBack */
+    bool (*pop_back) (struct _FlatVector*);
+
+    /** Remove an element from the specified index of the vector.
+        @see FlatVectorRemove */
+    bool (*remove) (struct _FlatVector*, unsigned);
+
+    /** Replace the element at the specified index of the vector.
+        @see FlatVectorSet */
+    bool (*set) (struct _FlatVector*, unsigned, const void*);
+
+    /** Copy out the element at the specified index of the vector.
+        @see FlatVectorGet */
+    bool (*get) (struct _FlatVector*, unsigned, void*);
+
+    /** Return the address of the element at the specified index.
+        @see FlatVectorAt */
+    void* (*at) (struct _FlatVector*, unsigned);
+
+    /** Return the address of the contiguous element array.
+        @see FlatVectorArray */
+    void* (*array) (struct _FlatVector*);
+
+    /** Resize the vector so that it can contain the specified number of elements.
+        @see FlatVectorResize */
+    bool (*resize) (struct _FlatVector*, unsigned);
+
+    /** Return the number of stored elements.
+        @see FlatVectorSize */
+    unsigned (*size) (struct _FlatVector*);
+
+    /** Return the vector capacity.
+        @see FlatVectorCapacity */
+    unsigned (*capacity) (struct _FlatVector*);
+
+    /** Return the element size in bytes.
+        @see FlatVectorElementSize */
+    size_t (*element_size) (struct _FlatVector*);
+
+    /** Sort the elements via the specified element comparison function.
+        @see FlatVectorSort */
+    void (*sort) (struct _FlatVector*, FlatVectorCompare);
+
+    /** Set the custom element cleanup function.
+        @see FlatVectorSetClean */
+    void (*set_clean) (struct _FlatVector*, FlatVectorClean);
+} FlatVector;
+
+/** Access the element array as the designated element type. */
+#define FLAT_VECTOR_ARRAY(self, type)   ((type*)FlatVectorArray(self))
+
+/** Access the element at the designated index as the designated element type.
+    The index is not checked. */
+#define FLAT_VECTOR_AT(self, type, idx) (FLAT_VECTOR_ARRAY(self, type)[idx])
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for FlatVector.
+ *
+ * @param size_element  The element size in bytes
+ * @param cap           The initial capacity
+ *
+ * @retval obj          The successfully constructed vector
+ * @retval NULL         Zero element size or insufficient memory for vector
+ *                      construction
+ */
+FlatVector* FlatVectorInit(size_t size_element, unsigned cap);
+
+/**
+ * @brief The destructor for FlatVector.
+ *
+ * @param obj           The pointer to the to be destructed vector
+ */
+void FlatVectorDeinit(FlatVector* obj);
+
+/**
+ * @brief Copy an element to the tail of the vector.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param element       The address of the element to be copied
+ *
+ * @retval true         The element is successfully copied
+ * @retval false        The element cannot be copied due to insufficient memory
+ */
+bool FlatVectorPushBack(FlatVector* self, const void* element);
+
+/**
+ * @brief Reserve an element slot at the tail of the vector.
+ *
+ * The caller constructs the element in place through the returned address, so
+ * no intermediate copy is required.
+ *
+ * @param self          The pointer to FlatVector structure
+ *
+ * @retval slot         The address of the uninitialized slot
+ * @retval NULL         The slot cannot be reserved due to insufficient memory
+ *
+ * @note The address is invalidated by the next vector modification.
+ */
+void* FlatVectorEmplaceBack(FlatVector* self);
+
+/**
+ * @brief Copy an element to the specified index of the vector.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param idx           The specified index
+ * @param element       The address of the element to be copied
+ *
+ * @retval true         The element is successfully copied
+ * @retval false        The element cannot be copied due to invalid index (>
+ *                      vector size) or insufficient memory
+ */
+bool FlatVectorInsert(FlatVector* self, unsigned idx, const void* element);
+
+/**
+ * @brief Reserve an element slot at the specified index of the vector.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param idx           The specified index
+ *
+ * @retval slot         The address of the uninitialized slot
+ * @retval NULL         The slot cannot be reserved due to invalid index (>
+ *                      vector size) or insufficient memory
+ *
+ * @note The address is invalidated by the next vector modification.
+ */
+void* FlatVectorEmplace(FlatVector* self, unsigned idx);
+
+/**
+ * @brief Pop an element from the tail of the vector.
+ *
+ * This function removes an element from the tail of the vector. Also, the
+ * cleanup function is triggered for the removed element.
+ *
+ * @param self          The pointer to FlatVector structure
+ *
+ * @retval true         The tail element is successfully removed
+ * @retval false        The vector is empty
+ */
+bool FlatVectorPopBack(FlatVector* self);
+
+/**
+ * @brief Remove an element from the specified index of the vector.
+ *
+ * This function removes an element from the specified index of the vector.
+ * Also, the cleanup function is triggered for the removed element.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param idx           The specified index
+ *
+ * @retval true         The element is successfully removed
+ * @retval false        Invalid index (>= vector size)
+ */
+bool FlatVectorRemove(FlatVector* self, unsigned idx);
+
+/**
+ * @brief Replace the element at the specified index of the vector.
+ *
+ * This function copies the given element over the old one. Also, the cleanup
+ * function is triggered for the replaced element.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param idx           The specified index
+ * @param element       The address of the element to be copied
+ *
+ * @retval true         The element is successfully replaced
+ * @retval false        Invalid index (>= vector size)
+ */
+bool FlatVectorSet(FlatVector* self, unsigned idx, const void* element);
+
+/**
+ * @brief Copy out the element at the specified index of the vector.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param idx           The specified index
+ * @param p_element     The address to store the copied element
+ *
+ * @retval true         The element is successfully copied
+ * @retval false        Invalid index (>= vector size)
+ */
+bool FlatVectorGet(FlatVector* self, unsigned idx, void* p_element);
+
+/**
+ * @brief Return the address of the element at the specified index.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param idx           The specified index
+ *
+ * @retval slot         The address of the element
+ * @retval NULL         Invalid index (>= vector size)
+ *
+ * @note The address is invalidated by the next vector modification.
+ */
+void* FlatVectorAt(FlatVector* self, unsigned idx);
+
+/**
+ * @brief Return the address of the contiguous element array.
+ *
+ * @param self          The pointer to FlatVector structure
+ *
+ * @retval array        The address of the first element
+ *
+ * @note The address is invalidated by the next vector modification.
+ */
+void* FlatVectorArray(FlatVector* self);
+
+/**
+ * @brief Resize the vector so that it can contain the specified number of elements.
+ *
+ * This function resizes the vector so that it can contain the specified number of
+ * elements. If the given element count is smaller than the old vector size. The
+ * trailing elements are removed. Also, the cleanup function is triggered.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param capacity      The specified element count
+ *
+ * @retval true         The vector is successfully resized
+ * @retval false        The vector cannot be resized due to insufficient memory
+ */
+bool FlatVectorResize(FlatVector* self, unsigned capacity);
+
+/**
+ * @brief Return the number of stored elements.
+ *
+ * @param self          The pointer to FlatVector structure
+ *
+ * @retval size         The number of stored elements
+ */
+unsigned FlatVectorSize(FlatVector* self);
+
+/**
+ * @brief Return the container capacity.
+ *
+ * @param self          The pointer to FlatVector structure
+ *
+ * @retval cap          The vector capacity
+ */
+unsigned FlatVectorCapacity(FlatVector* self);
+
+/**
+ * @brief Return the element size in bytes.
+ *
+ * @param self          The pointer to FlatVector structure
+ *
+ * @retval size         The element size
+ */
+size_t FlatVectorElementSize(FlatVector* self);
+
+/**
+ * @brief Sort the elements via the specified element comparison function.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param func          The custom function
+ */
+void FlatVectorSort(FlatVector* self, FlatVectorCompare func);
+
+/**
+ * @brief Set the custom element cleanup function.
+ *
+ * @param self          The pointer to FlatVector structure
+ * @param func          The custom function
+ */
+void FlatVectorSetClean(FlatVector* self, FlatVectorClean func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -41,6 +41,12 @@ typedef struct _HashMapData HashMapData;
 /** Calculate the hash of the given key. */
 typedef unsigned (*HashMapHash) (void*);
 
+/** Calculate the 64 bit hash of the given key. */
+typedef uint64_t (*HashMapHash64) (void*);
+
+/** Scramble the hash value before it is mapped to the slot index. */
+typedef unsigned (*HashMapMix) (unsigned);
+
 /** Compare the equality of two keys. */
 typedef int (*HashMapCompare) (void*, void*);
 
@@ -50,6 +56,48 @@ typedef void (*HashMapCleanKey) (void*);
 /** Value cleanup function called whenever a live entry is removed. */
 typedef void (*HashMapCleanValue) (void*);
 
+/** Visit function called for each key value pair by the parallel traversal. */
+typedef void (*HashMapVisit) (Pair*, void*);
+
+/** The runtime statistics of HashMap. */
+typedef struct _HashMapStats {
+    /** Whether the library is built with CDS_ENABLE_STATS. Otherwise, all the
+        counters below are reported as zero. */
+    bool instrumented;
+
+    /** The number of stored pairs. */
+    unsigned size;
+
+    /** The number of slots, including the ones pending migration. */
+    unsigned num_slot;
+
+    /** The number of stored pairs per slot. */
+    double load_factor;
+
+    /** The length of the longest slot list. */
+    unsigned max_chain;
+
+    /** The number of slot lists of each length. The last entry also counts the
+        longer lists. */
+    unsigned chains[CDS_STATS_NUM_CHAIN];
+
+    /** The number of key lookups, including the ones of insertion and
+        removal. */
+    unsigned long long num_lookup;
+
+    /** The number of slot nodes visited by the lookups. */
+    unsigned long long num_probe;
+
+    /** The number of slot array extensions. */
+    unsigned long long num_rehash;
+
+    /** The nanoseconds spent in the slot array extensions. */
+    unsigned long long ns_rehash;
+
+    /** The bytes of the slot nodes and arrays allocated since construction. */
+    unsigned long long bytes_alloc;
+} HashMapStats;
+
 
 /** The implementation for hash map. */
 typedef struct _HashMap {
@@ -84,10 +132,22 @@ typedef struct _HashMap {
         @see HashMapNext */
     Pair* (*next) (struct _HashMap*);
 
+    /** Insert an array of key value pairs into the map.
+        @see HashMapPutBatch */
+    bool (*put_batch) (struct _HashMap*, void**, void**, unsigned);
+
+    /** Retrieve the values corresponding to an array of keys.
+        @see HashMapGetBatch */
+    unsigned (*get_batch) (struct _HashMap*, void**, void**, unsigned);
+
     /** Set the custom hash function.
         @see HashMapSetHash */
     void (*set_hash) (struct _HashMap*, HashMapHash);
 
+    /** Set the custom 64 bit hash function.
+        @see HashMapSetHash64 */
+    void (*set_hash64) (struct _HashMap*, HashMapHash64);
+
     /** Set the custom key comparison function.
         @see HashMapSetCompare */
     void (*set_compare) (struct _HashMap*, HashMapCompare);
@@ -99,8 +159,55 @@ typedef struct _HashMap {
     /** Set the custom value cleanup function.
         @see HashMapSetCleanValue */
     void (*set_clean_value) (struct _HashMap*, HashMapCleanValue);
+
+    /** Enable or disable the incremental rehashing.
+        @see HashMapSetIncrementalReHash */
+    void (*set_incremental_rehash) (struct _HashMap*, bool);
+
+    /** Enable or disable the power-of-two slot array.
+        @see HashMapSetPowerOfTwo */
+    bool (*set_power_of_two) (struct _HashMap*, bool);
+
+    /** Set the custom finalizer mix for power-of-two mode.
+        @see HashMapSetMix */
+    void (*set_mix) (struct _HashMap*, HashMapMix);
+
+    /** Set the loading factor which triggers the slot array extension.
+        @see HashMapSetLoadFactor */
+    bool (*set_load_factor) (struct _HashMap*, double);
+
+    /** Set the allocator for the slot nodes.
+        @see HashMapSetAllocator */
+    bool (*set_allocator) (struct _HashMap*, const Allocator*);
+
+    /** Manage the slot nodes with an internal object pool.
+        @see HashMapUsePool */
+    bool (*use_pool) (struct _HashMap*);
+
+    /** Extend the slot array to hold the designated number of pairs.
+        @see HashMapReserve */
+    bool (*reserve) (struct _HashMap*, unsigned);
+
+    /** Store the keys and values inline in the slot nodes.
+        @see HashMapSetInline */
+    bool (*set_inline) (struct _HashMap*, size_t, size_t);
+
+    /** Enable or disable the Bloom filter in front of the slot array.
+        @see HashMapUseFilter */
+    bool (*use_filter) (struct _HashMap*, bool);
+
+    /** Collect the runtime statistics of the map.
+        @see HashMapGetStats */
+    void (*get_stats) (struct _HashMap*, HashMapStats*);
 } HashMap;
 
+/** The external iterator for HashMap which is allocated by the caller. */
+typedef struct _HashMapIter {
+    HashMapData* data_;
+    unsigned slot_;
+    void* node_;
+} HashMapIter;
+
 
 /*===========================================================================*
  *             Definition for the exported member operations                 *
@@ -113,6 +220,19 @@ typedef struct _HashMap {
  */
 HashMap* HashMapInit();
 
+/**
+ * @brief The constructor for HashMap with the designated capacity.
+ *
+ * The slot array is presized so that the designated number of pairs can be
+ * stored without any rehashing under the default loading factor.
+ *
+ * @param capacity      The expected number of pairs
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+HashMap* HashMapInitWithCapacity(unsigned capacity);
+
 /**
  * @brief The destructor for HashMap.
  *
@@ -198,6 +318,107 @@ void HashMapFirst(HashMap* self);
  */
 Pair* HashMapNext(HashMap* self);
 
+/**
+ * @brief Initialize the external iterator.
+ *
+ * Unlike the internal iterator maintained by HashMapFirst and HashMapNext,
+ * the external iterator keeps its cursor in the caller provided structure. So
+ * any number of iterators can traverse the map simultaneously, and the
+ * traversal does not modify the map.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param iter          The pointer to the to be initialized iterator
+ *
+ * @note The iterator is invalidated by the map modification. In incremental
+ *  rehashing mode, the lookup operations modify the map as well.
+ */
+void HashMapIterInit(HashMap* self, HashMapIter* iter);
+
+/**
+ * @brief Get the key value pair pointed by the external iterator and advance it.
+ *
+ * @param iter          The pointer to the external iterator
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The map end is reached
+ */
+Pair* HashMapIterNext(HashMapIter* iter);
+
+/**
+ * @brief Insert an array of key value pairs into the map.
+ *
+ * The keys are processed in small groups. For each group, all the hash values
+ * are calculated first, and the target slots are prefetched before the slot
+ * lists are probed. This overlaps the memory latency of the slot accesses. The
+ * pairs are inserted in array order, so for duplicate keys, the last pair wins.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param keys          Array of the keys
+ * @param values        Array of the values paired with the keys
+ * @param size          The array size
+ *
+ * @retval true         The pairs are successfully inserted
+ * @retval false        The pairs cannot be inserted due to insufficient memory
+ *
+ * @note When insufficient memory occurs, the pairs prior to the failed one
+ *  are kept in the map.
+ */
+bool HashMapPutBatch(HashMap* self, void** keys, void** values, unsigned size);
+
+/**
+ * @brief Retrieve the values corresponding to an array of keys.
+ *
+ * Like HashMapPutBatch, the keys are hashed in groups and the target slots are
+ * prefetched before probing.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param keys          Array of the keys
+ * @param values        Array to store the corresponding values, and NULL is
+ *                      stored for the keys that cannot be found
+ * @param size          The array size
+ *
+ * @retval count        The number of keys that can be found
+ */
+unsigned HashMapGetBatch(HashMap* self, void** keys, void** values, unsigned size);
+
+/**
+ * @brief Visit all the key value pairs with the worker threads.
+ *
+ * The slot array is partitioned into ranges, and the ranges are claimed by
+ * the worker threads of CdsParallelRun. During an incremental rehashing, the
+ * old slot array is partitioned as well. The pairs are visited in no
+ * particular order.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param func          The function to visit each pair
+ * @param arg           The custom argument passed to the visit function
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @note The visit function should be thread safe, and the map should not be
+ *  modified during the traversal.
+ */
+void HashMapForEachParallel(HashMap* self, HashMapVisit func, void* arg,
+                            unsigned num_thread);
+
+/**
+ * @brief Reduce all the key value pairs with the worker threads.
+ *
+ * Each slot range accumulates the pairs into its own partial result, and the
+ * partial results are combined in the slot order as CdsParallelRun describes.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param reducer       The pointer to the reducer whose accumulate function
+ *                      receives the Pair pointers
+ * @param acc           The identity result on entry and the reduced one on
+ *                      return
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @note The reducer functions should be thread safe, and the map should not
+ *  be modified during the traversal.
+ */
+void HashMapReduceParallel(HashMap* self, const Reducer* reducer, void* acc,
+                           unsigned num_thread);
+
 /**
  * @brief Set the custom hash function.
  *
@@ -205,9 +426,27 @@ Pair* HashMapNext(HashMap* self);
  *
  * @param self          The pointer to HashMap structure
  * @param func          The custom function
+ *
+ * @note The hash value of each pair is cached when the pair is inserted, so
+ *  the hash function should be set before the map is populated.
  */
 void HashMapSetHash(HashMap* self, HashMapHash func);
 
+/**
+ * @brief Set the custom 64 bit hash function.
+ *
+ * The two halves of the 64 bit hash value are folded into the cached hash, so
+ * the strong hash functions like HashFast64 can be applied directly. It
+ * replaces the function set by HashMapSetHash, and passing NULL restores the
+ * default one.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param func          The custom function
+ *
+ * @note The hash function should be set before the map is populated.
+ */
+void HashMapSetHash64(HashMap* self, HashMapHash64 func);
+
 /**
  * @brief Set the custom key comparison function.
  *
@@ -238,6 +477,230 @@ void HashMapSetCleanKey(HashMap* self, HashMapCleanKey func);
  */
 void HashMapSetCleanValue(HashMap* self, HashMapCleanValue func);
 
+/**
+ * @brief Enable or disable the incremental rehashing.
+ *
+ * By default, the map re-distributes all the stored pairs in a single step
+ * when its loading factor is exceeded. In incremental mode, the old and new
+ * slot arrays are kept side by side, and each put, get, contain, and remove
+ * operation migrates only a few slot lists. This bounds the worst case latency
+ * of a single operation. Disabling the mode finishes any pending migration.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param enable        Whether to apply the incremental rehashing
+ *
+ * @note Since lookups also advance the migration in this mode, the iterator
+ *  is invalidated by any map operation, including get and contain.
+ */
+void HashMapSetIncrementalReHash(HashMap* self, bool enable);
+
+/**
+ * @brief Enable or disable the power-of-two slot array.
+ *
+ * By default, the slot array size is picked from a prime table and the slot
+ * index is derived by modulo. In power-of-two mode, the slot array starts
+ * from 1024 slots and doubles on each extension, and the slot index is
+ * derived by bit masking. To keep the low bits well distributed, the hash
+ * value is scrambled by the finalizer mix first.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param enable        Whether to apply the power-of-two slot array
+ *
+ * @retval true         The mode is switched successfully
+ * @retval false        The map is not empty or memory allocation fails
+ */
+bool HashMapSetPowerOfTwo(HashMap* self, bool enable);
+
+/**
+ * @brief Set the custom finalizer mix for power-of-two mode.
+ *
+ * By default, the finalizer of HashMurMur32 is applied. Passing NULL uses the
+ * hash value directly, which is only suitable for well distributed hashes.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param func          The custom function
+ *
+ * @note The mixed hash value is cached when the pair is inserted, so the mix
+ *  function should be set before the map is populated.
+ */
+void HashMapSetMix(HashMap* self, HashMapMix func);
+
+/**
+ * @brief Set the loading factor which triggers the slot array extension.
+ *
+ * The slot array is extended when the number of stored pairs reaches the
+ * number of slots multiplied by the factor. The default factor is 0.75.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param factor        The designated loading factor
+ *
+ * @retval true         The factor is applied
+ * @retval false        The factor is not positive
+ */
+bool HashMapSetLoadFactor(HashMap* self, double factor);
+
+/**
+ * @brief Set the allocator for the slot nodes.
+ *
+ * By default, the global allocator returned by CdsGetAllocator at construction
+ * is applied. The allocator can only be replaced while the map is empty.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param alloc         The pointer to the allocator or NULL to restore the
+ *                      global one
+ *
+ * @retval true         The allocator is applied
+ * @retval false        The map is not empty
+ */
+bool HashMapSetAllocator(HashMap* self, const Allocator* alloc);
+
+/**
+ * @brief Manage the slot nodes with an internal object pool.
+ *
+ * The slot nodes are carved from large slabs without per node header. When
+ * the map is destructed, all the nodes are released at once, and the slot
+ * lists are traversed only if the cleanup functions are set. The pool can only
+ * be applied while the map is empty.
+ *
+ * @param self          The pointer to HashMap structure
+ *
+ * @retval true         The pool is applied
+ * @retval false        The map is not empty or memory allocation fails
+ */
+bool HashMapUsePool(HashMap* self);
+
+/**
+ * @brief Extend the slot array to hold the designated number of pairs.
+ *
+ * The slot array is extended, if necessary, so that the designated number of
+ * pairs can be stored without any rehashing under the current loading factor
+ * and slot layout. The stored pairs are re-distributed in a single step even in
+ * incremental mode. The slot array is never shrunk.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param capacity      The expected number of pairs
+ *
+ * @retval true         The slot array is large enough
+ * @retval false        Insufficient memory for the slot array extension
+ *
+ * @note Switching the slot layout via HashMapSetPowerOfTwo resets the slot
+ *  array, so the capacity should be reserved afterward.
+ */
+bool HashMapReserve(HashMap* self, unsigned capacity);
+
+/**
+ * @brief Store the keys and values inline in the slot nodes.
+ *
+ * By default, the map stores the key and value pointers only, and the pointed
+ * objects are allocated by the caller. In inline mode, the fixed size key and
+ * value bytes are copied into the storage trailing each slot node. So a lookup
+ * for a small key touches the node only, and no object allocation is needed
+ * by the caller.
+ *
+ * In this mode, the keys and values passed to all the operations are pointers
+ * to the bytes, and the values returned by HashMapGet and the pairs returned
+ * by the iterators point to the bytes stored in the node. They remain valid
+ * until the pair is removed. The cleanup functions are also invoked with the
+ * pointers to the stored bytes. Unless the custom functions are set, the key
+ * bytes are hashed by HashFast64 and compared by memcmp.
+ *
+ * A zero size keeps the pointer semantics for the keys or the values, and
+ * passing zero for both restores the default mode. The mode can only be
+ * switched while the map is empty.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param size_key      The size of the inline key in bytes
+ * @param size_value    The size of the inline value in bytes
+ *
+ * @retval true         The mode is switched successfully
+ * @retval false        The map is not empty or memory allocation fails
+ */
+bool HashMapSetInline(HashMap* self, size_t size_key, size_t size_value);
+
+/**
+ * @brief Enable or disable the Bloom filter in front of the slot array.
+ *
+ * Each stored hash value is also inserted into a blocked Bloom filter, so that
+ * most lookups of absent keys are rejected with a single cache line access
+ * instead of walking the slot list. The filter is sized with the slot array and
+ * rebuilt from the cached hash values whenever the slot array is extended,
+ * which also purges the bits left by the removed pairs.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param enable        Whether to keep the filter
+ *
+ * @retval true         The filter is successfully enabled or disabled
+ * @retval false        Insufficient memory for the filter
+ *
+ * @note The filter pays off when most lookups miss, since each hit touches one
+ *  more cache line. The filter rebuild walks all the stored pairs at once even
+ *  in incremental mode.
+ */
+bool HashMapUseFilter(HashMap* self, bool enable);
+
+/**
+ * @brief Collect the runtime statistics of the map.
+ *
+ * The size, the load factor and the chain length distribution are computed by
+ * walking the slot array on each call. The lookup, rehash and allocation
+ * counters accumulate since construction, and they are maintained only if the
+ * library is built with CDS_ENABLE_STATS, which keeps the hot path untouched
+ * by default.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param p_stats       The pointer to the returned statistics
+ *
+ * @note In incremental mode, the slot lists are migrated in small steps after
+ *  the extension, and these steps are not counted in the rehash duration.
+ */
+void HashMapGetStats(HashMap* self, HashMapStats* p_stats);
+
+/**
+ * @brief Write all the pairs to the snapshot stream.
+ *
+ * The pairs are packed into large chunks, each handed to the writer at once.
+ * The inline keys and values are stored as raw bytes, and the pointers are
+ * encoded by the codecs. Without the codec, the key or value is treated as
+ * integer.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param writer        The pointer to the writer
+ * @param codec_key     The pointer to the key codec or NULL
+ * @param codec_value   The pointer to the value codec or NULL
+ *
+ * @retval true         The snapshot is completely written
+ * @retval false        Insufficient memory, or the writer or the codec fails
+ *
+ * @note The map should not be modified during the snapshot.
+ */
+bool HashMapSnapshot(HashMap* self, const SnapshotWriter* writer,
+                     const SnapshotCodec* codec_key,
+                     const SnapshotCodec* codec_value);
+
+/**
+ * @brief Load the pairs from the snapshot stream written by HashMapSnapshot.
+ *
+ * The slot array is presized by the pair count recorded in the snapshot
+ * header, so the pairs are inserted without any rehash. The map should be
+ * configured with the same inline mode and the custom functions as the one
+ * taking the snapshot. The restored pairs are put into the map, replacing the
+ * stored ones with the same keys.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param reader        The pointer to the reader
+ * @param codec_key     The pointer to the key codec or NULL
+ * @param codec_value   The pointer to the value codec or NULL
+ *
+ * @retval true         The snapshot is completely restored
+ * @retval false        Insufficient memory, the reader or the codec fails, or
+ *                      the snapshot is malformed
+ *
+ * @note On failure, the pairs restored so far remain in the map.
+ */
+bool HashMapRestore(HashMap* self, const SnapshotReader* reader,
+                    const SnapshotCodec* codec_key,
+                    const SnapshotCodec* codec_value);
+
 #ifdef __cplusplus
 }
 #endif
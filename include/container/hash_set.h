@@ -41,12 +41,57 @@ typedef struct _HashSetData HashSetData;
 /** Calculate the hash of the given key. */
 typedef unsigned (*HashSetHash) (void*);
 
+/** Calculate the 64 bit hash of the given key. */
+typedef uint64_t (*HashSetHash64) (void*);
+
+/** Scramble the hash value before it is mapped to the slot index. */
+typedef unsigned (*HashSetMix) (unsigned);
+
 /** Compare the equality of two keys. */
 typedef int (*HashSetCompare) (void*, void*);
 
 /** void* cleanup function called whenever a live entry is removed. */
 typedef void (*HashSetCleanKey) (void*);
 
+/** The runtime statistics of HashSet. */
+typedef struct _HashSetStats {
+    /** Whether the library is built with CDS_ENABLE_STATS. Otherwise, all the
+        counters below are reported as zero. */
+    bool instrumented;
+
+    /** The number of stored keys. */
+    unsigned size;
+
+    /** The number of slots, including the ones pending migration. */
+    unsigned num_slot;
+
+    /** The number of stored keys per slot. */
+    double load_factor;
+
+    /** The length of the longest slot list. */
+    unsigned max_chain;
+
+    /** The number of slot lists of each length. The last entry also counts the
+        longer lists. */
+    unsigned chains[CDS_STATS_NUM_CHAIN];
+
+    /** The number of key lookups, including the ones of insertion and
+        removal. */
+    unsigned long long num_lookup;
+
+    /** The number of slot nodes visited by the lookups. */
+    unsigned long long num_probe;
+
+    /** The number of slot array extensions. */
+    unsigned long long num_rehash;
+
+    /** The nanoseconds spent in the slot array extensions. */
+    unsigned long long ns_rehash;
+
+    /** The bytes of the slot nodes and arrays allocated since construction. */
+    unsigned long long bytes_alloc;
+} HashSetStats;
+
 
 /** The implementation for hash set. */
 typedef struct _HashSet {
@@ -81,6 +126,10 @@ typedef struct _HashSet {
         @see HashSetSetHash */
     void (*set_hash) (struct _HashSet*, HashSetHash);
 
+    /** Set the custom 64 bit hash function.
+        @see HashSetSetHash64 */
+    void (*set_hash64) (struct _HashSet*, HashSetHash64);
+
     /** Set the custom key comparison function.
         @see HashSetSetCompare */
     void (*set_compare) (struct _HashSet*, HashSetCompare);
@@ -88,8 +137,51 @@ typedef struct _HashSet {
     /** Set the custom key cleanup function.
         @see HashSetSetCleanKey */
     void (*set_clean_key) (struct _HashSet*, HashSetCleanKey);
+
+    /** Enable or disable the incremental rehashing.
+        @see HashSetSetIncrementalReHash */
+    void (*set_incremental_rehash) (struct _HashSet*, bool);
+
+    /** Enable or disable the power-of-two slot array.
+        @see HashSetSetPowerOfTwo */
+    bool (*set_power_of_two) (struct _HashSet*, bool);
+
+    /** Set the custom finalizer mix for power-of-two mode.
+        @see HashSetSetMix */
+    void (*set_mix) (struct _HashSet*, HashSetMix);
+
+    /** Set the loading factor which triggers the slot array extension.
+        @see HashSetSetLoadFactor */
+    bool (*set_load_factor) (struct _HashSet*, double);
+
+    /** Set the allocator for the slot nodes.
+        @see HashSetSetAllocator */
+    bool (*set_allocator) (struct _HashSet*, const Allocator*);
+
+    /** Manage the slot nodes with an internal object pool.
+        @see HashSetUsePool */
+    bool (*use_pool) (struct _HashSet*);
+
+    /** Extend the slot array to hold the designated number of keys.
+        @see HashSetReserve */
+    bool (*reserve) (struct _HashSet*, unsigned);
+
+    /** Enable or disable the Bloom filter in front of the slot array.
+        @see HashSetUseFilter */
+    bool (*use_filter) (struct _HashSet*, bool);
+
+    /** Collect the runtime statistics of the set.
+        @see HashSetGetStats */
+    void (*get_stats) (struct _HashSet*, HashSetStats*);
 } HashSet;
 
+/** The external iterator for HashSet which is allocated by the caller. */
+typedef struct _HashSetIter {
+    HashSetData* data_;
+    unsigned slot_;
+    void* node_;
+} HashSetIter;
+
 
 /*===========================================================================*
  *             Definition for the exported member operations                 *
@@ -102,6 +194,19 @@ typedef struct _HashSet {
  */
 HashSet* HashSetInit();
 
+/**
+ * @brief The constructor for HashSet with the designated capacity.
+ *
+ * The slot array is presized so that the designated number of keys can be
+ * stored without any rehashing under the default loading factor.
+ *
+ * @param capacity      The expected number of keys
+ *
+ * @retval obj          The successfully constructed set
+ * @retval NULL         Insufficient memory for set construction
+ */
+HashSet* HashSetInitWithCapacity(unsigned capacity);
+
 /**
  * @brief The destructor for HashSet.
  *
@@ -168,14 +273,58 @@ void HashSetFirst(HashSet* self);
  */
 void* HashSetNext(HashSet* self);
 
+/**
+ * @brief Initialize the external iterator.
+ *
+ * Unlike the internal iterator maintained by HashSetFirst and HashSetNext,
+ * the external iterator keeps its cursor in the caller provided structure. So
+ * any number of iterators can traverse the set simultaneously, and the
+ * traversal does not modify the set.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param iter          The pointer to the to be initialized iterator
+ *
+ * @note The iterator is invalidated by the set modification. In incremental
+ *  rehashing mode, the lookup operations modify the set as well.
+ */
+void HashSetIterInit(HashSet* self, HashSetIter* iter);
+
+/**
+ * @brief Get the key pointed by the external iterator and advance it.
+ *
+ * @param iter          The pointer to the external iterator
+ *
+ * @retval key          The current key
+ * @retval NULL         The set end is reached
+ */
+void* HashSetIterNext(HashSetIter* iter);
+
 /**
  * @brief Set the custom hash function.
  *
  * @param self          The pointer to HashSet structure
  * @param func          The custom function
+ *
+ * @note The hash value of each key is cached when the key is inserted, so the
+ *  hash function should be set before the set is populated.
  */
 void HashSetSetHash(HashSet* self, HashSetHash func);
 
+/**
+ * @brief Set the custom 64 bit hash function.
+ *
+ * The two halves of the 64 bit hash value are folded into the cached hash, so
+ * the strong hash functions like HashFast64 can be applied directly. It
+ * replaces the function set by HashSetSetHash, and passing NULL restores the
+ * default one.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param func          The custom function
+ *
+ * @note The hash function should be set before the set is populated.
+ */
+void HashSetSetHash64(HashSet* self, HashSetHash64 func);
+
 /**
  * @brief Set the custom key comparison function.
  *
@@ -196,6 +345,155 @@ void HashSetSetCompare(HashSet* self, HashSetCompare func);
  */
 void HashSetSetCleanKey(HashSet* self, HashSetCleanKey func);
 
+/**
+ * @brief Enable or disable the incremental rehashing.
+ *
+ * By default, the set re-distributes all the stored keys in a single step when
+ * its loading factor is exceeded. In incremental mode, the old and new slot
+ * arrays are kept side by side, and each add, find, and remove operation
+ * migrates only a few slot lists. This bounds the worst case latency of a
+ * single operation. Disabling the mode finishes any pending migration.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param enable        Whether to apply the incremental rehashing
+ *
+ * @note Since lookups also advance the migration in this mode, the iterator
+ *  is invalidated by any set operation, including find.
+ */
+void HashSetSetIncrementalReHash(HashSet* self, bool enable);
+
+/**
+ * @brief Enable or disable the power-of-two slot array.
+ *
+ * By default, the slot array size is picked from a prime table and the slot
+ * index is derived by modulo. In power-of-two mode, the slot array starts
+ * from 1024 slots and doubles on each extension, and the slot index is
+ * derived by bit masking. To keep the low bits well distributed, the hash
+ * value is scrambled by the finalizer mix first.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param enable        Whether to apply the power-of-two slot array
+ *
+ * @retval true         The mode is switched successfully
+ * @retval false        The set is not empty or memory allocation fails
+ */
+bool HashSetSetPowerOfTwo(HashSet* self, bool enable);
+
+/**
+ * @brief Set the custom finalizer mix for power-of-two mode.
+ *
+ * By default, the finalizer of HashMurMur32 is applied. Passing NULL uses the
+ * hash value directly, which is only suitable for well distributed hashes.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param func          The custom function
+ *
+ * @note The mixed hash value is cached when the key is inserted, so the mix
+ *  function should be set before the set is populated.
+ */
+void HashSetSetMix(HashSet* self, HashSetMix func);
+
+/**
+ * @brief Set the loading factor which triggers the slot array extension.
+ *
+ * The slot array is extended when the number of stored keys reaches the
+ * number of slots multiplied by the factor. The default factor is 0.75.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param factor        The designated loading factor
+ *
+ * @retval true         The factor is applied
+ * @retval false        The factor is not positive
+ */
+bool HashSetSetLoadFactor(HashSet* self, double factor);
+
+/**
+ * @brief Set the allocator for the slot nodes.
+ *
+ * By default, the global allocator returned by CdsGetAllocator at construction
+ * is applied. The allocator can only be replaced while the set is empty.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param alloc         The pointer to the allocator or NULL to restore the
+ *                      global one
+ *
+ * @retval true         The allocator is applied
+ * @retval false        The set is not empty
+ */
+bool HashSetSetAllocator(HashSet* self, const Allocator* alloc);
+
+/**
+ * @brief Manage the slot nodes with an internal object pool.
+ *
+ * The slot nodes are carved from large slabs without per node header. When
+ * the set is destructed, all the nodes are released at once, and the slot
+ * lists are traversed only if the cleanup functions are set. The pool can only
+ * be applied while the set is empty.
+ *
+ * @param self          The pointer to HashSet structure
+ *
+ * @retval true         The pool is applied
+ * @retval false        The set is not empty or memory allocation fails
+ */
+bool HashSetUsePool(HashSet* self);
+
+/**
+ * @brief Extend the slot array to hold the designated number of keys.
+ *
+ * The slot array is extended, if necessary, so that the designated number of
+ * keys can be stored without any rehashing under the current loading factor
+ * and slot layout. The stored keys are re-distributed in a single step even in
+ * incremental mode. The slot array is never shrunk.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param capacity      The expected number of keys
+ *
+ * @retval true         The slot array is large enough
+ * @retval false        Insufficient memory for the slot array extension
+ *
+ * @note Switching the slot layout via HashSetSetPowerOfTwo resets the slot
+ *  array, so the capacity should be reserved afterward.
+ */
+bool HashSetReserve(HashSet* self, unsigned capacity);
+
+/**
+ * @brief Enable or disable the Bloom filter in front of the slot array.
+ *
+ * Each stored hash value is also inserted into a blocked Bloom filter, so that
+ * most lookups of absent keys are rejected with a single cache line access
+ * instead of walking the slot list. The filter is sized with the slot array and
+ * rebuilt from the cached hash values whenever the slot array is extended,
+ * which also purges the bits left by the removed keys.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param enable        Whether to keep the filter
+ *
+ * @retval true         The filter is successfully enabled or disabled
+ * @retval false        Insufficient memory for the filter
+ *
+ * @note The filter pays off when most lookups miss, since each hit touches one
+ *  more cache line. The filter rebuild walks all the stored keys at once even
+ *  in incremental mode.
+ */
+bool HashSetUseFilter(HashSet* self, bool enable);
+
+/**
+ * @brief Collect the runtime statistics of the set.
+ *
+ * The size, the load factor and the chain length distribution are computed by
+ * walking the slot array on each call. The lookup, rehash and allocation
+ * counters accumulate since construction, and they are maintained only if the
+ * library is built with CDS_ENABLE_STATS. The lookups issued internally by the
+ * set algebra are not counted.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param p_stats       The pointer to the returned statistics
+ *
+ * @note In incremental mode, the slot lists are migrated in small steps after
+ *  the extension, and these steps are not counted in the rehash duration.
+ */
+void HashSetGetStats(HashSet* self, HashSetStats* p_stats);
+
 /**
  * @brief Perform union operation for the specified two sets.
  *
@@ -244,6 +542,100 @@ HashSet* HashSetIntersect(HashSet* lhs, HashSet* rhs);
  */
 HashSet* HashSetDifference(HashSet* lhs, HashSet* rhs);
 
+/**
+ * @brief Merge the keys of the source set into the designated one in place.
+ *
+ * Unlike HashSetUnion, no result set is constructed. The hash values cached by
+ * the source set are reused if both sets apply the same hash function, slot
+ * layout, and finalizer mix.
+ *
+ * @param lhs           The designated set to be extended
+ * @param rhs           The source set
+ *
+ * @retval true         The source keys are successfully merged
+ * @retval false        Insufficient memory for the node allocation, and the
+ *                      designated set may be partially merged
+ *
+ * @note For the equal keys, the key stored in the designated set is kept. The
+ *  merged keys are shared by both sets, so at most one of them should clean the
+ *  keys to avoid the "double-free" problem.
+ */
+bool HashSetUnionInto(HashSet* lhs, HashSet* rhs);
+
+/**
+ * @brief The multi-threaded version of HashSetUnionInto.
+ *
+ * The source slot array is partitioned into equal ranges, and the keys absent
+ * from the designated set are collected concurrently. The designated set is
+ * then extended only once to link them. If a thread cannot be created, its
+ * range is scanned by the calling thread.
+ *
+ * @param lhs           The designated set to be extended
+ * @param rhs           The source set
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @retval true         The source keys are successfully merged
+ * @retval false        Insufficient memory for the key collection or the node
+ *                      allocation
+ *
+ * @note The hash and key comparison functions should be thread safe.
+ */
+bool HashSetUnionIntoParallel(HashSet* lhs, HashSet* rhs, unsigned num_thread);
+
+/**
+ * @brief Keep only the keys of the designated set which are also present in
+ * the source set.
+ *
+ * This is the in-place version of HashSetIntersect. The smaller set is scanned
+ * to probe the other one, and the cached hash values are reused if both sets
+ * hash alike. The removed keys are cleaned like HashSetRemove.
+ *
+ * @param lhs           The designated set to be shrunk
+ * @param rhs           The source set
+ */
+void HashSetRetain(HashSet* lhs, HashSet* rhs);
+
+/**
+ * @brief The multi-threaded version of HashSetRetain.
+ *
+ * The designated slot array is partitioned into equal ranges which are scanned
+ * concurrently. The removed keys are cleaned by the calling thread afterward.
+ *
+ * @param lhs           The designated set to be shrunk
+ * @param rhs           The source set
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @note The hash and key comparison functions should be thread safe.
+ */
+void HashSetRetainParallel(HashSet* lhs, HashSet* rhs, unsigned num_thread);
+
+/**
+ * @brief Remove the keys of the designated set which are also present in the
+ * source set.
+ *
+ * This is the in-place version of HashSetDifference. The smaller set is scanned
+ * to probe the other one, and the cached hash values are reused if both sets
+ * hash alike. The removed keys are cleaned like HashSetRemove.
+ *
+ * @param lhs           The designated set to be shrunk
+ * @param rhs           The source set
+ */
+void HashSetSubtract(HashSet* lhs, HashSet* rhs);
+
+/**
+ * @brief The multi-threaded version of HashSetSubtract.
+ *
+ * The designated slot array is partitioned into equal ranges which are scanned
+ * concurrently. The removed keys are cleaned by the calling thread afterward.
+ *
+ * @param lhs           The designated set to be shrunk
+ * @param rhs           The source set
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @note The hash and key comparison functions should be thread safe.
+ */
+void HashSetSubtractParallel(HashSet* lhs, HashSet* rhs, unsigned num_thread);
+
 #ifdef __cplusplus
 }
 #endif
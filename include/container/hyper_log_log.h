@@ -0,0 +1,221 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file hyper_log_log.h The fixed memory HyperLogLog to estimate the number of
+ * distinct items.
+ */
+
+#ifndef _HYPER_LOG_LOG_H_
+#define _HYPER_LOG_LOG_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** HyperLogLogData is the data type for the container private information. */
+typedef struct _HyperLogLogData HyperLogLogData;
+
+/** Calculate the 64 bit hash value of the key. */
+typedef uint64_t (*HyperLogLogHash) (void*);
+
+
+/** The implementation for HyperLogLog. */
+typedef struct _HyperLogLog {
+    /** The container private information */
+    HyperLogLogData *data;
+
+    /** Insert a key into the estimator.
+        @see HyperLogLogAdd */
+    void (*add) (struct _HyperLogLog*, void*);
+
+    /** Insert a precomputed hash value into the estimator.
+        @see HyperLogLogAddHash */
+    void (*add_hash) (struct _HyperLogLog*, uint64_t);
+
+    /** Estimate the number of distinct inserted keys.
+        @see HyperLogLogCount */
+    uint64_t (*count) (struct _HyperLogLog*);
+
+    /** Merge another estimator into this one.
+        @see HyperLogLogMerge */
+    bool (*merge) (struct _HyperLogLog*, struct _HyperLogLog*);
+
+    /** Return the number of index bits.
+        @see HyperLogLogPrecision */
+    unsigned (*precision) (struct _HyperLogLog*);
+
+    /** Remove all the inserted keys.
+        @see HyperLogLogClear */
+    void (*clear) (struct _HyperLogLog*);
+
+    /** Set the custom hash function.
+        @see HyperLogLogSetHash */
+    void (*set_hash) (struct _HyperLogLog*, HyperLogLogHash);
+} HyperLogLog;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for HyperLogLog.
+ *
+ * The estimator keeps 2^precision one byte registers. The high bits of a hash
+ * value select the register, which records the maximal position of the first
+ * set bit among the remaining bits. The standard error of the estimate is
+ * about 1.04 / sqrt(2^precision), for example 0.81% with the 16KB registers of
+ * the default precision 14.
+ *
+ * @param precision     The number of index bits in [4, 18], otherwise the
+ *                      default 14 is applied
+ *
+ * @retval obj          The successfully constructed estimator
+ * @retval NULL         Insufficient memory for estimator construction
+ */
+HyperLogLog* HyperLogLogInit(unsigned precision);
+
+/**
+ * @brief The destructor for HyperLogLog.
+ *
+ * @param obj           The pointer to the to be destructed estimator
+ */
+void HyperLogLogDeinit(HyperLogLog* obj);
+
+/**
+ * @brief Insert a key into the estimator.
+ *
+ * The key is hashed by the designated hash function. By default, the key
+ * itself is treated as the hashed value. The key is not retained.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ * @param key           The specified key
+ */
+void HyperLogLogAdd(HyperLogLog* self, void* key);
+
+/**
+ * @brief Insert a precomputed hash value into the estimator.
+ *
+ * The value is further scrambled, so the hash values of a weak function, like
+ * the ones cached by HashSet or HashMap, can be directly passed.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ * @param hash          The hash value of the key
+ */
+void HyperLogLogAddHash(HyperLogLog* self, uint64_t hash);
+
+/**
+ * @brief Estimate the number of distinct inserted keys.
+ *
+ * The small cardinality is estimated by linear counting over the empty
+ * registers, and the larger one by the harmonic mean of the registers.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ *
+ * @retval count        The estimated cardinality
+ */
+uint64_t HyperLogLogCount(HyperLogLog* self);
+
+/**
+ * @brief Merge another estimator into this one.
+ *
+ * The registers are merged by their maximum, so the merged estimator is the
+ * same as the one which receives both streams, and the estimators filled by
+ * different threads can be combined at the end. The source estimator is
+ * intact.
+ *
+ * @param self          The pointer to the designated HyperLogLog structure
+ * @param other         The pointer to the source HyperLogLog structure
+ *
+ * @retval true         The estimators are successfully merged
+ * @retval false        The estimators have different precisions
+ *
+ * @note Both estimators should apply the same hash function.
+ */
+bool HyperLogLogMerge(HyperLogLog* self, HyperLogLog* other);
+
+/**
+ * @brief Return the number of index bits.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ *
+ * @retval precision    The precision applied at construction
+ */
+unsigned HyperLogLogPrecision(HyperLogLog* self);
+
+/**
+ * @brief Remove all the inserted keys.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ */
+void HyperLogLogClear(HyperLogLog* self);
+
+/**
+ * @brief Set the custom hash function.
+ *
+ * For the string keys, HashString64 in math/hash.h can be passed directly. The
+ * other functions there, like HashFast64, take the key size and should be
+ * wrapped to this signature.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ * @param func          The custom function, NULL to restore the default one
+ */
+void HyperLogLogSetHash(HyperLogLog* self, HyperLogLogHash func);
+
+/**
+ * @brief Write the registers to the snapshot stream.
+ *
+ * This ships the estimator to another node for merge.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ * @param writer        The pointer to the writer
+ *
+ * @retval true         The snapshot is completely written
+ * @retval false        Insufficient memory or the writer fails
+ */
+bool HyperLogLogSnapshot(HyperLogLog* self, const SnapshotWriter* writer);
+
+/**
+ * @brief Merge the estimator from the snapshot stream written by
+ * HyperLogLogSnapshot.
+ *
+ * The restore works like HyperLogLogMerge, so restoring into an empty
+ * estimator copies the source one.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ * @param reader        The pointer to the reader
+ *
+ * @retval true         The snapshot is completely restored
+ * @retval false        Insufficient memory or the reader fails, or the
+ *                      snapshot is malformed or has a different precision
+ */
+bool HyperLogLogRestore(HyperLogLog* self, const SnapshotReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
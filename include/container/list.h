@@ -40,6 +40,13 @@ typedef struct _ListData ListData;
 /** Element clean function called when an element is removed. */
 typedef void (*ListClean) (void*);
 
+/** Element comparison function called with two elements to sort the list. */
+typedef int (*ListCompare) (const void*, const void*);
+
+/** The stable handle to a list node, which stays valid until the element is
+    removed from the list. */
+typedef struct _ListNode* ListHandle;
+
 
 /** The implementation for doubly linked list. */
 typedef struct _List {
@@ -118,8 +125,73 @@ typedef struct _List {
     /** Set the custom element cleanup function.
         @see ListSetClean */
     void (*set_clean) (struct _List*, ListClean);
+
+    /** Set the allocator for the list nodes.
+        @see ListSetAllocator */
+    bool (*set_allocator) (struct _List*, const Allocator*);
+
+    /** Manage the list nodes with an internal object pool.
+        @see ListUsePool */
+    bool (*use_pool) (struct _List*);
+
+    /** Push an element to the head of the list and return its handle.
+        @see ListPushFrontHandle */
+    ListHandle (*push_front_handle) (struct _List*, void*);
+
+    /** Push an element to the tail of the list and return its handle.
+        @see ListPushBackHandle */
+    ListHandle (*push_back_handle) (struct _List*, void*);
+
+    /** Insert an element after the designated node.
+        @see ListInsertAfter */
+    ListHandle (*insert_after) (struct _List*, ListHandle, void*);
+
+    /** Insert an element before the designated node.
+        @see ListInsertBefore */
+    ListHandle (*insert_before) (struct _List*, ListHandle, void*);
+
+    /** Remove the element of the designated node.
+        @see ListErase */
+    void (*erase) (struct _List*, ListHandle);
+
+    /** Return the handle to the head node.
+        @see ListFrontHandle */
+    ListHandle (*front_handle) (struct _List*);
+
+    /** Return the handle to the tail node.
+        @see ListBackHandle */
+    ListHandle (*back_handle) (struct _List*);
+
+    /** Return the handle to the successor node.
+        @see ListNextHandle */
+    ListHandle (*next_handle) (struct _List*, ListHandle);
+
+    /** Return the handle to the predecessor node.
+        @see ListPrevHandle */
+    ListHandle (*prev_handle) (struct _List*, ListHandle);
+
+    /** Move a range of nodes from another list before the designated node.
+        @see ListSplice */
+    bool (*splice) (struct _List*, ListHandle, struct _List*, ListHandle,
+                    ListHandle);
+
+    /** Sort the elements with the stable merge sort.
+        @see ListSort */
+    void (*sort) (struct _List*, ListCompare);
+
+    /** Merge another sorted list into the sorted list.
+        @see ListMerge */
+    bool (*merge) (struct _List*, struct _List*, ListCompare);
 } List;
 
+/** The external iterator for List which is allocated by the caller. */
+typedef struct _ListIter {
+    ListData* data_;
+    void* node_;
+    unsigned round_;
+    bool is_reverse_;
+} ListIter;
+
 
 /*===========================================================================*
  *             Definition for the exported member operations                 *
@@ -346,6 +418,33 @@ bool ListNext(List* self, void** p_element);
  */
 bool ListReverseNext(List* self, void** p_element);
 
+/**
+ * @brief Initialize the external iterator.
+ *
+ * Unlike the internal iterator maintained by ListFirst and ListNext, the
+ * external iterator keeps its cursor in the caller provided structure. So any
+ * number of iterators can traverse the list simultaneously, and the traversal
+ * does not modify the list.
+ *
+ * @param self          The pointer to List structure
+ * @param iter          The pointer to the to be initialized iterator
+ * @param is_reverse    Whether to apply the reversed traversal
+ *
+ * @note The iterator is invalidated by the list modification.
+ */
+void ListIterInit(List* self, ListIter* iter, bool is_reverse);
+
+/**
+ * @brief Get the element pointed by the external iterator and advance it.
+ *
+ * @param iter          The pointer to the external iterator
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The traversal end is not reached
+ * @retval false        The traversal end is reached
+ */
+bool ListIterNext(ListIter* iter, void** p_element);
+
 /**
  * @brief Set the custom element cleanup function
  *
@@ -354,6 +453,206 @@ bool ListReverseNext(List* self, void** p_element);
  */
 void ListSetClean(List* self, ListClean func);
 
+/**
+ * @brief Set the allocator for the list nodes.
+ *
+ * By default, the global allocator returned by CdsGetAllocator at construction
+ * is applied. The allocator can only be replaced while the list is empty.
+ *
+ * @param self          The pointer to List structure
+ * @param alloc         The pointer to the allocator or NULL to restore the
+ *                      global one
+ *
+ * @retval true         The allocator is applied
+ * @retval false        The list is not empty
+ */
+bool ListSetAllocator(List* self, const Allocator* alloc);
+
+/**
+ * @brief Manage the list nodes with an internal object pool.
+ *
+ * The list nodes are carved from large slabs without per node header. When
+ * the list is destructed, all the nodes are released at once, and the list is
+ * traversed only if the cleanup function is set. The pool can only be applied
+ * while the list is empty.
+ *
+ * @param self          The pointer to List structure
+ *
+ * @retval true         The pool is applied
+ * @retval false        The list is not empty or memory allocation fails
+ */
+bool ListUsePool(List* self);
+
+/**
+ * @brief Push an element to the head of the list and return its handle.
+ *
+ * @param self          The pointer to List structure
+ * @param element       The specified element
+ *
+ * @retval handle       The handle to the node holding the element
+ * @retval NULL         Insufficient memory
+ */
+ListHandle ListPushFrontHandle(List* self, void* element);
+
+/**
+ * @brief Push an element to the tail of the list and return its handle.
+ *
+ * @param self          The pointer to List structure
+ * @param element       The specified element
+ *
+ * @retval handle       The handle to the node holding the element
+ * @retval NULL         Insufficient memory
+ */
+ListHandle ListPushBackHandle(List* self, void* element);
+
+/**
+ * @brief Insert an element after the designated node in constant time.
+ *
+ * @param self          The pointer to List structure
+ * @param pos           The handle to the node of this list
+ * @param element       The specified element
+ *
+ * @retval handle       The handle to the node holding the element
+ * @retval NULL         Insufficient memory
+ */
+ListHandle ListInsertAfter(List* self, ListHandle pos, void* element);
+
+/**
+ * @brief Insert an element before the designated node in constant time.
+ *
+ * @param self          The pointer to List structure
+ * @param pos           The handle to the node of this list
+ * @param element       The specified element
+ *
+ * @retval handle       The handle to the node holding the element
+ * @retval NULL         Insufficient memory
+ */
+ListHandle ListInsertBefore(List* self, ListHandle pos, void* element);
+
+/**
+ * @brief Remove the element of the designated node in constant time.
+ *
+ * The cleanup function is invoked for the removed element, and the handle is
+ * invalidated.
+ *
+ * @param self          The pointer to List structure
+ * @param pos           The handle to the node of this list
+ */
+void ListErase(List* self, ListHandle pos);
+
+/**
+ * @brief Return the handle to the head node.
+ *
+ * @param self          The pointer to List structure
+ *
+ * @retval handle       The handle to the head node
+ * @retval NULL         The list is empty
+ */
+ListHandle ListFrontHandle(List* self);
+
+/**
+ * @brief Return the handle to the tail node.
+ *
+ * @param self          The pointer to List structure
+ *
+ * @retval handle       The handle to the tail node
+ * @retval NULL         The list is empty
+ */
+ListHandle ListBackHandle(List* self);
+
+/**
+ * @brief Return the handle to the successor node.
+ *
+ * @param self          The pointer to List structure
+ * @param pos           The handle to the node of this list
+ *
+ * @retval handle       The handle to the successor node
+ * @retval NULL         The designated node is the tail
+ */
+ListHandle ListNextHandle(List* self, ListHandle pos);
+
+/**
+ * @brief Return the handle to the predecessor node.
+ *
+ * @param self          The pointer to List structure
+ * @param pos           The handle to the node of this list
+ *
+ * @retval handle       The handle to the predecessor node
+ * @retval NULL         The designated node is the head
+ */
+ListHandle ListPrevHandle(List* self, ListHandle pos);
+
+/**
+ * @brief Get the element held by the designated node.
+ *
+ * @param pos           The handle to the node
+ *
+ * @retval element      The held element
+ */
+void* ListHandleGet(ListHandle pos);
+
+/**
+ * @brief Replace the element held by the designated node.
+ *
+ * Unlike ListSetAt, the cleanup function is not invoked for the replaced
+ * element, so that the caller can update the element in place.
+ *
+ * @param pos           The handle to the node
+ * @param element       The specified element
+ */
+void ListHandleSet(ListHandle pos, void* element);
+
+/**
+ * @brief Move a range of nodes from another list before the designated node.
+ *
+ * The nodes are relinked rather than copied, so their handles stay valid and
+ * now belong to this list. Moving the nodes within the same list takes
+ * constant time, and moving them across lists additionally counts the range.
+ *
+ * @param self          The pointer to the designated List structure
+ * @param pos           The handle to the node of the designated list before
+ *                      which the range is placed, or NULL for the tail
+ * @param other         The pointer to the source List structure, which can be
+ *                      the designated list itself
+ * @param first         The handle to the first node of the range
+ * @param last          The handle to the last node of the range, which should
+ *                      not precede the first node
+ *
+ * @retval true         The nodes are successfully moved
+ * @retval false        The lists apply different allocators
+ *
+ * @note For the moves within the same list, the designated node should not be
+ * inside the range.
+ */
+bool ListSplice(List* self, ListHandle pos, List* other, ListHandle first,
+                ListHandle last);
+
+/**
+ * @brief Sort the elements with the stable merge sort.
+ *
+ * The nodes are relinked rather than the elements being swapped, so the
+ * handles stay attached to their elements. No memory is allocated.
+ *
+ * @param self          The pointer to List structure
+ * @param func          The element comparison function
+ */
+void ListSort(List* self, ListCompare func);
+
+/**
+ * @brief Merge another sorted list into the sorted list.
+ *
+ * For the elements comparing equal, the ones of this list go first. The source
+ * list is finally empty, and its node handles now belong to this list.
+ *
+ * @param self          The pointer to the designated List structure
+ * @param other         The pointer to the source List structure
+ * @param func          The element comparison function
+ *
+ * @retval true         The lists are successfully merged
+ * @retval false        The same list or different allocators
+ */
+bool ListMerge(List* self, List* other, ListCompare func);
+
 #ifdef __cplusplus
 }
 #endif
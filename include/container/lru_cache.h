@@ -0,0 +1,307 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file lru_cache.h The bounded key value cache with LRU or CLOCK eviction.
+ */
+
+#ifndef _LRU_CACHE_H_
+#define _LRU_CACHE_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** LruCacheData is the data type for the container private information. */
+typedef struct _LruCacheData LruCacheData;
+
+/** Calculate the hash value of the key. */
+typedef unsigned (*LruCacheHash) (void*);
+
+/** Compare the equality of two keys. */
+typedef int (*LruCacheCompare) (void*, void*);
+
+/** Key cleanup function called when the pair is replaced, removed, or evicted. */
+typedef void (*LruCacheCleanKey) (void*);
+
+/** Value cleanup function called when the pair is replaced, removed, or
+    evicted. */
+typedef void (*LruCacheCleanValue) (void*);
+
+/** Calculate the charge, like the number of bytes, of a key value pair. */
+typedef size_t (*LruCacheCharge) (void*, void*);
+
+
+/** The implementation for LRU cache. */
+typedef struct _LruCache {
+    /** The container private information */
+    LruCacheData *data;
+
+    /** Insert a key value pair into the cache.
+        @see LruCachePut */
+    bool (*put) (struct _LruCache*, void*, void*);
+
+    /** Retrieve the value corresponding to the specified key and mark the
+        pair as recently used.
+        @see LruCacheGet */
+    void* (*get) (struct _LruCache*, void*);
+
+    /** Check if the cache contains the specified key.
+        @see LruCacheContain */
+    bool (*contain) (struct _LruCache*, void*);
+
+    /** Remove the key value pair corresponding to the specified key.
+        @see LruCacheRemove */
+    bool (*remove) (struct _LruCache*, void*);
+
+    /** Return the number of cached key value pairs.
+        @see LruCacheSize */
+    unsigned (*size) (struct _LruCache*);
+
+    /** Return the total charge of the cached key value pairs.
+        @see LruCacheTotalCharge */
+    size_t (*total_charge) (struct _LruCache*);
+
+    /** Set the custom hash function.
+        @see LruCacheSetHash */
+    void (*set_hash) (struct _LruCache*, LruCacheHash);
+
+    /** Set the custom key comparison function.
+        @see LruCacheSetCompare */
+    void (*set_compare) (struct _LruCache*, LruCacheCompare);
+
+    /** Set the custom key cleanup function.
+        @see LruCacheSetCleanKey */
+    void (*set_clean_key) (struct _LruCache*, LruCacheCleanKey);
+
+    /** Set the custom value cleanup function.
+        @see LruCacheSetCleanValue */
+    void (*set_clean_value) (struct _LruCache*, LruCacheCleanValue);
+
+    /** Limit the total charge of the cached pairs.
+        @see LruCacheSetCharge */
+    void (*set_charge) (struct _LruCache*, LruCacheCharge, size_t);
+
+    /** Switch between the LRU and the CLOCK eviction.
+        @see LruCacheSetClock */
+    void (*set_clock) (struct _LruCache*, bool);
+} LruCache;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for LruCache.
+ *
+ * Each cached pair lives in a single node which is linked both to its slot
+ * list and to the recency list, so lookup, promotion, and eviction all cost
+ * O(1). When the cache is full, the least recently used pair is evicted.
+ *
+ * In concurrent mode, the cache is split into the designated number of shards.
+ * Each shard owns its own slot array, recency list, and lock, and the capacity
+ * is evenly divided among the shards. Thus the eviction order is only
+ * maintained within each shard.
+ *
+ * @param capacity      The maximum number of cached pairs, 0 for no limit
+ * @param num_shard     The number of shards, which is rounded up to the power
+ *                      of two, or 0 to create the single-threaded cache
+ *                      without any locking
+ *
+ * @retval obj          The successfully constructed cache
+ * @retval NULL         Insufficient memory for cache construction
+ */
+LruCache* LruCacheInit(unsigned capacity, unsigned num_shard);
+
+/**
+ * @brief The destructor for LruCache.
+ *
+ * @param obj           The pointer to the to be destructed cache
+ *
+ * @note The caller should guarantee that no other thread is accessing the
+ *  cache.
+ */
+void LruCacheDeinit(LruCache* obj);
+
+/**
+ * @brief Insert a key value pair into the cache.
+ *
+ * This function inserts a key value pair as the most recently used one. If the
+ * specified key is equal to a certain one stored in the cache, the existing
+ * pair will be replaced, and the cleanup functions are invoked for it. Then the
+ * least recently used pairs are evicted with the same cleanup until both the
+ * capacity and the charge limit are met. The inserted pair itself is never
+ * evicted, even if its charge alone exceeds the limit.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param key           The specified key
+ * @param value         The specified value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        The pair cannot be inserted due to insufficient memory
+ */
+bool LruCachePut(LruCache* self, void* key, void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the specified key and mark the
+ * pair as recently used.
+ *
+ * In CLOCK mode, the pair is only marked as referenced, and it is given a
+ * second chance at the eviction rather than relinked immediately.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param key           The specified key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ *
+ * @note In concurrent mode, if the value cleanup function is set, the returned
+ *  value may be released by a concurrent put, remove, or eviction.
+ */
+void* LruCacheGet(LruCache* self, void* key);
+
+/**
+ * @brief Check if the cache contains the specified key.
+ *
+ * The recency of the pair is not affected.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param key           The specified key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool LruCacheContain(LruCache* self, void* key);
+
+/**
+ * @brief Remove the key value pair corresponding to the specified key.
+ *
+ * The cleanup functions are invoked for the removed pair.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param key           The specified key
+ *
+ * @retval true         The pair is successfully removed
+ * @retval false        The key cannot be found
+ */
+bool LruCacheRemove(LruCache* self, void* key);
+
+/**
+ * @brief Return the number of cached key value pairs.
+ *
+ * In concurrent mode, the shards are counted one by one, so the result is only
+ * a snapshot when the cache is concurrently updated.
+ *
+ * @param self          The pointer to LruCache structure
+ *
+ * @retval size         The number of cached pairs
+ */
+unsigned LruCacheSize(LruCache* self);
+
+/**
+ * @brief Return the total charge of the cached key value pairs.
+ *
+ * Without the charge function, each pair is charged one.
+ *
+ * @param self          The pointer to LruCache structure
+ *
+ * @retval charge       The total charge
+ */
+size_t LruCacheTotalCharge(LruCache* self);
+
+/**
+ * @brief Set the custom hash function.
+ *
+ * By default, the integer value of the key is taken as its hash.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param func          The custom function
+ *
+ * @note All the custom functions should be set before the cache is populated
+ *  and shared.
+ */
+void LruCacheSetHash(LruCache* self, LruCacheHash func);
+
+/**
+ * @brief Set the custom key comparison function.
+ *
+ * By default, key is treated as integer.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param func          The custom function
+ */
+void LruCacheSetCompare(LruCache* self, LruCacheCompare func);
+
+/**
+ * @brief Set the custom key cleanup function.
+ *
+ * By default, no cleanup operation for key.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param func          The custom function
+ */
+void LruCacheSetCleanKey(LruCache* self, LruCacheCleanKey func);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param func          The custom function
+ */
+void LruCacheSetCleanValue(LruCache* self, LruCacheCleanValue func);
+
+/**
+ * @brief Limit the total charge of the cached pairs.
+ *
+ * Each pair is charged once when it is inserted, and the charge limit is
+ * evenly divided among the shards like the capacity. The limit applies from
+ * the next insertion on.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param func          The charge function, or NULL to charge each pair one
+ * @param limit         The maximum total charge, 0 for no limit
+ */
+void LruCacheSetCharge(LruCache* self, LruCacheCharge func, size_t limit);
+
+/**
+ * @brief Switch between the LRU and the CLOCK eviction.
+ *
+ * The CLOCK eviction approximates LRU. A lookup only sets the reference bit of
+ * the pair instead of relinking it, which keeps the read path free of list
+ * updates. The eviction then skips and clears the referenced pairs.
+ *
+ * @param self          The pointer to LruCache structure
+ * @param enable        Whether to apply the CLOCK eviction
+ */
+void LruCacheSetClock(LruCache* self, bool enable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
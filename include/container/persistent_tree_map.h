@@ -0,0 +1,321 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file persistent_tree_map.h The ordered map with constant time snapshots
+ * for the lock free readers.
+ */
+
+#ifndef _PERSISTENT_TREE_MAP_H_
+#define _PERSISTENT_TREE_MAP_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** PersistentTreeMapData is the data type for the container private
+    information. */
+typedef struct _PersistentTreeMapData PersistentTreeMapData;
+
+/** PersistentTreeMapView is the immutable version of the map captured by a
+    snapshot. */
+typedef struct _PersistentTreeMapView PersistentTreeMapView;
+
+/** Compare the equality of two keys. */
+typedef int (*PersistentTreeMapCompare) (void*, void*);
+
+/** Key cleanup function called when the pair is neither stored in the map nor
+    visible to any snapshot. */
+typedef void (*PersistentTreeMapCleanKey) (void*);
+
+/** Value cleanup function called when the pair is neither stored in the map
+    nor visible to any snapshot. */
+typedef void (*PersistentTreeMapCleanValue) (void*);
+
+/** The bound of the tree height, which fits the red black tree with up to
+    UINT_MAX pairs. */
+#define PERSISTENT_TREE_MAP_MAX_HEIGHT  (64)
+
+
+/** The implementation for persistent ordered map. */
+typedef struct _PersistentTreeMap {
+    /** The container private information */
+    PersistentTreeMapData *data;
+
+    /** Insert a key value pair into the map.
+        @see PersistentTreeMapPut */
+    bool (*put) (struct _PersistentTreeMap*, void*, void*);
+
+    /** Retrieve the value corresponding to the specified key.
+        @see PersistentTreeMapGet */
+    void* (*get) (struct _PersistentTreeMap*, void*);
+
+    /** Check if the map contains the specified key.
+        @see PersistentTreeMapFind */
+    bool (*find) (struct _PersistentTreeMap*, void*);
+
+    /** Remove the key value pair corresponding to the specified key.
+        @see PersistentTreeMapRemove */
+    bool (*remove) (struct _PersistentTreeMap*, void*);
+
+    /** Return the number of stored key value pairs.
+        @see PersistentTreeMapSize */
+    unsigned (*size) (struct _PersistentTreeMap*);
+
+    /** Capture the current version of the map.
+        @see PersistentTreeMapSnapshot */
+    PersistentTreeMapView* (*snapshot) (struct _PersistentTreeMap*);
+
+    /** Set the custom key comparison function.
+        @see PersistentTreeMapSetCompare */
+    void (*set_compare) (struct _PersistentTreeMap*, PersistentTreeMapCompare);
+
+    /** Set the custom key cleanup function.
+        @see PersistentTreeMapSetCleanKey */
+    void (*set_clean_key) (struct _PersistentTreeMap*,
+                           PersistentTreeMapCleanKey);
+
+    /** Set the custom value cleanup function.
+        @see PersistentTreeMapSetCleanValue */
+    void (*set_clean_value) (struct _PersistentTreeMap*,
+                             PersistentTreeMapCleanValue);
+} PersistentTreeMap;
+
+/** The external iterator for PersistentTreeMapView which is allocated by the
+    caller. */
+typedef struct _PersistentTreeMapIter {
+    void* stack_[PERSISTENT_TREE_MAP_MAX_HEIGHT];
+    unsigned depth_;
+} PersistentTreeMapIter;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for PersistentTreeMap.
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+PersistentTreeMap* PersistentTreeMapInit();
+
+/**
+ * @brief The destructor for PersistentTreeMap.
+ *
+ * The snapshots taken from the map remain valid until they are released.
+ *
+ * @param obj           The pointer to the to be destructed map
+ */
+void PersistentTreeMapDeinit(PersistentTreeMap* obj);
+
+/**
+ * @brief Insert a key value pair into the map.
+ *
+ * This function inserts a key value pair into the map. If the specified key is
+ * equal to a certain one stored in the map, the existing pair will be replaced.
+ * The nodes shared with the snapshots are copied along the search path, while
+ * the ones exclusively owned by the map are updated in place.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param key           The specified key
+ * @param value         The specified value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        The pair cannot be inserted due to insufficient memory,
+ *                      and the map is left untouched
+ */
+bool PersistentTreeMapPut(PersistentTreeMap* self, void* key, void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the specified key.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param key           The specified key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ */
+void* PersistentTreeMapGet(PersistentTreeMap* self, void* key);
+
+/**
+ * @brief Check if the map contains the specified key.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param key           The specified key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool PersistentTreeMapFind(PersistentTreeMap* self, void* key);
+
+/**
+ * @brief Remove the key value pair corresponding to the specified key.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param key           The specified key
+ *
+ * @retval true         The pair is successfully removed
+ * @retval false        The key cannot be found, or the nodes shared with the
+ *                      snapshots cannot be copied due to insufficient memory
+ */
+bool PersistentTreeMapRemove(PersistentTreeMap* self, void* key);
+
+/**
+ * @brief Return the number of stored key value pairs.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ *
+ * @retval size         The number of stored pairs
+ */
+unsigned PersistentTreeMapSize(PersistentTreeMap* self);
+
+/**
+ * @brief Capture the current version of the map in constant time.
+ *
+ * The snapshot shares all the nodes with the map by holding a reference to the
+ * root. Later updates of the map copy the shared nodes on their search paths
+ * rather than modifying them, so the snapshot keeps its content without any
+ * lock. Each node is reclaimed when the map and the last snapshot referring to
+ * it drop their references, and the pair cleanup functions are invoked then.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ *
+ * @retval view         The captured snapshot
+ * @retval NULL         Insufficient memory
+ *
+ * @note The map should be updated by a single thread at a time, while the
+ *  snapshots can be taken, read, and released by any thread. Taking a snapshot
+ *  waits for at most one ongoing update.
+ */
+PersistentTreeMapView* PersistentTreeMapSnapshot(PersistentTreeMap* self);
+
+/**
+ * @brief Release the snapshot.
+ *
+ * The nodes and the pairs only referred by the snapshot are reclaimed, and it
+ * is safe to release the snapshot after the map is destructed.
+ *
+ * @param view          The pointer to the snapshot
+ */
+void PersistentTreeMapRelease(PersistentTreeMapView* view);
+
+/**
+ * @brief Retrieve the value corresponding to the specified key from the
+ * snapshot.
+ *
+ * @param view          The pointer to the snapshot
+ * @param key           The specified key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ */
+void* PersistentTreeMapViewGet(PersistentTreeMapView* view, void* key);
+
+/**
+ * @brief Check if the snapshot contains the specified key.
+ *
+ * @param view          The pointer to the snapshot
+ * @param key           The specified key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool PersistentTreeMapViewFind(PersistentTreeMapView* view, void* key);
+
+/**
+ * @brief Return the number of key value pairs in the snapshot.
+ *
+ * @param view          The pointer to the snapshot
+ *
+ * @retval size         The number of pairs
+ */
+unsigned PersistentTreeMapViewSize(PersistentTreeMapView* view);
+
+/**
+ * @brief Initialize the iterator to traverse the snapshot in the key order.
+ *
+ * @param view          The pointer to the snapshot
+ * @param iter          The pointer to the to be initialized iterator
+ */
+void PersistentTreeMapViewIterInit(PersistentTreeMapView* view,
+                                   PersistentTreeMapIter* iter);
+
+/**
+ * @brief Get the key value pair pointed by the iterator and advance it.
+ *
+ * @param iter          The pointer to the iterator
+ *
+ * @retval ptr_pair     The pointer to the pair which stays valid until the
+ *                      snapshot is released
+ * @retval NULL         The traversal end is reached
+ */
+Pair* PersistentTreeMapViewIterNext(PersistentTreeMapIter* iter);
+
+/**
+ * @brief Set the custom key comparison function.
+ *
+ * By default, key is treated as integer.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param func          The custom function
+ */
+void PersistentTreeMapSetCompare(PersistentTreeMap* self,
+                                 PersistentTreeMapCompare func);
+
+/**
+ * @brief Set the custom key cleanup function.
+ *
+ * By default, no cleanup operation for key.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param func          The custom function
+ *
+ * @note The function may be invoked by the thread releasing the last snapshot
+ *  which refers to the key.
+ */
+void PersistentTreeMapSetCleanKey(PersistentTreeMap* self,
+                                  PersistentTreeMapCleanKey func);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param func          The custom function
+ *
+ * @note The function may be invoked by the thread releasing the last snapshot
+ *  which refers to the value.
+ */
+void PersistentTreeMapSetCleanValue(PersistentTreeMap* self,
+                                    PersistentTreeMapCleanValue func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -43,6 +43,9 @@ typedef int (*PriorityQueueCompare) (const void*, const void*);
 /** Element clean function called when an element is removed. */
 typedef void (*PriorityQueueClean) (void*);
 
+/** The handle to locate the pushed element in the heap. */
+typedef struct _PriorityQueueNode* PriorityQueueHandle;
+
 
 /** The implementation for priority queue. */
 typedef struct _PriorityQueue {
@@ -65,6 +68,46 @@ typedef struct _PriorityQueue {
         @see PriorityQueueSize */
     unsigned (*size) (struct _PriorityQueue*);
 
+    /** Return the queue capacity.
+        @see PriorityQueueCapacity */
+    unsigned (*capacity) (struct _PriorityQueue*);
+
+    /** Extend the queue capacity to the specified number of elements.
+        @see PriorityQueueReserve */
+    bool (*reserve) (struct _PriorityQueue*, unsigned);
+
+    /** Shrink the queue capacity to the number of stored elements.
+        @see PriorityQueueShrinkToFit */
+    bool (*shrink_to_fit) (struct _PriorityQueue*);
+
+    /** Set the capacity growth policy.
+        @see PriorityQueueSetGrowth */
+    bool (*set_growth) (struct _PriorityQueue*, const GrowthPolicy*);
+
+    /** Push a batch of elements to the queue.
+        @see PriorityQueuePushBatch */
+    bool (*push_batch) (struct _PriorityQueue*, void**, unsigned);
+
+    /** Retrieve and remove a batch of elements from top of the queue.
+        @see PriorityQueuePopN */
+    unsigned (*pop_n) (struct _PriorityQueue*, void**, unsigned);
+
+    /** Push an element to the queue and return its handle.
+        @see PriorityQueuePushHandle */
+    PriorityQueueHandle (*push_handle) (struct _PriorityQueue*, void*);
+
+    /** Replace the element designated by the handle and restore the order.
+        @see PriorityQueueUpdate */
+    void (*update) (struct _PriorityQueue*, PriorityQueueHandle, void*);
+
+    /** Remove the element designated by the handle.
+        @see PriorityQueueRemove */
+    void (*remove) (struct _PriorityQueue*, PriorityQueueHandle);
+
+    /** Set the number of children of each heap node.
+        @see PriorityQueueSetArity */
+    bool (*set_arity) (struct _PriorityQueue*, unsigned);
+
     /** Set the custom element comparison function.
         @see PriorityQueueSetCompare */
     void (*set_compare) (struct _PriorityQueue*, PriorityQueueCompare func);
@@ -86,6 +129,22 @@ typedef struct _PriorityQueue {
  */
 PriorityQueue* PriorityQueueInit();
 
+/**
+ * @brief The constructor for PriorityQueue which is populated with the given
+ * elements.
+ *
+ * The heap is built bottom up in O(n) time.
+ *
+ * @param elements      The array of the elements
+ * @param count         The number of the elements
+ * @param func          The element comparison function, NULL for default
+ *
+ * @retval obj          The successfully constructed queue
+ * @retval NULL         Insufficient memory for queue construction
+ */
+PriorityQueue* PriorityQueueInitFromArray(void** elements, unsigned count,
+                                          PriorityQueueCompare func);
+
 /**
  * @brief The destructor for PriorityQueue.
  *
@@ -108,7 +167,7 @@ bool PriorityQueuePush(PriorityQueue* self, void* element);
  * @brief Delete element from top of the queue.
  *
  * This function removes element from top of the queue. Also, the cleanup
- * function is invoked for the popped element.
+ * function is invoked for the popped element, and its handle is released.
  *
  * @param self          The pointer to PriorityQueue structure
  *
@@ -117,6 +176,38 @@ bool PriorityQueuePush(PriorityQueue* self, void* element);
  */
 bool PriorityQueuePop(PriorityQueue* self);
 
+/**
+ * @brief Push a batch of elements to the queue.
+ *
+ * The elements are appended to the heap bottom first, and then only their
+ * ancestors are sifted down level by level. It costs O(n + k) time in the
+ * worst case rather than O(k log n) for k separate pushes.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ * @param elements      The array of the elements
+ * @param count         The number of the elements
+ *
+ * @retval true         The elements are successfully pushed
+ * @retval false        Insufficient memory, and the queue is intact
+ */
+bool PriorityQueuePushBatch(PriorityQueue* self, void** elements,
+                            unsigned count);
+
+/**
+ * @brief Retrieve and remove a batch of elements from top of the queue.
+ *
+ * The elements are stored in the priority order. The cleanup function is not
+ * invoked since the ownership of the elements is passed to the caller.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ * @param elements      The array to store the returned elements
+ * @param count         The maximum number of the elements to retrieve
+ *
+ * @retval num          The number of the retrieved elements
+ */
+unsigned PriorityQueuePopN(PriorityQueue* self, void** elements,
+                           unsigned count);
+
 /**
  * @brief Get element from top of the queue.
  *
@@ -137,6 +228,107 @@ bool PriorityQueueTop(PriorityQueue* self, void** p_element);
  */
 unsigned PriorityQueueSize(PriorityQueue* self);
 
+/**
+ * @brief Return the queue capacity.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ *
+ * @retval cap          The queue capacity
+ */
+unsigned PriorityQueueCapacity(PriorityQueue* self);
+
+/**
+ * @brief Extend the queue capacity so that it can contain the specified
+ * number of elements without reallocation.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ * @param capacity      The specified element count
+ *
+ * @retval true         The capacity is successfully extended or already enough
+ * @retval false        Insufficient memory
+ */
+bool PriorityQueueReserve(PriorityQueue* self, unsigned capacity);
+
+/**
+ * @brief Shrink the queue capacity to the number of stored elements.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ *
+ * @retval true         The capacity is successfully shrunk
+ * @retval false        The reallocation fails, and the queue is intact
+ */
+bool PriorityQueueShrinkToFit(PriorityQueue* self);
+
+/**
+ * @brief Set the capacity growth policy.
+ *
+ * The full queue is extended by the growth ratio of the policy. If the
+ * shrink ratio is set, the pop which drops the load below it also shrinks the
+ * queue. The default policy doubles the capacity and never shrinks.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ * @param policy        The pointer to the growth policy
+ *
+ * @retval true         The policy is successfully applied
+ * @retval false        Invalid policy @see CdsCheckGrowth
+ */
+bool PriorityQueueSetGrowth(PriorityQueue* self, const GrowthPolicy* policy);
+
+/**
+ * @brief Push an element to the queue and return its handle.
+ *
+ * The handle stays valid until the element is popped or removed, and it is
+ * used to update or remove the element in O(log n) time.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ * @param element       The specified element
+ *
+ * @retval handle       The handle to the pushed element
+ * @retval NULL         The element cannot be pushed due to insufficient memory
+ */
+PriorityQueueHandle PriorityQueuePushHandle(PriorityQueue* self, void* element);
+
+/**
+ * @brief Replace the element designated by the handle and restore the order.
+ *
+ * This function serves the decrease key and the increase key operations. The
+ * element can be the original one with its priority modified in place. If a
+ * different element is given, the cleanup function is invoked for the
+ * original one.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ * @param handle        The handle to the element
+ * @param element       The updated element
+ */
+void PriorityQueueUpdate(PriorityQueue* self, PriorityQueueHandle handle,
+                         void* element);
+
+/**
+ * @brief Remove the element designated by the handle.
+ *
+ * This function removes the element and releases the handle. Also, the
+ * cleanup function is invoked for the removed element.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ * @param handle        The handle to the element
+ */
+void PriorityQueueRemove(PriorityQueue* self, PriorityQueueHandle handle);
+
+/**
+ * @brief Set the number of children of each heap node.
+ *
+ * The wider heap is shallower, so the push compares fewer elements and the
+ * pop touches fewer cache lines. The stored elements are rearranged for the
+ * new arity in linear time. The default arity is 2.
+ *
+ * @param self          The pointer to PriorityQueue structure
+ * @param arity         The number of children between 2 and 64
+ *
+ * @retval true         The arity is successfully applied
+ * @retval false        Invalid arity
+ */
+bool PriorityQueueSetArity(PriorityQueue* self, unsigned arity);
+
 /**
  * @brief Set the custom element comparison function.
  *
@@ -67,6 +67,22 @@ typedef struct _Queue {
         @see QueueSize */
     unsigned (*size) (struct _Queue*);
 
+    /** Return the queue capacity.
+        @see QueueCapacity */
+    unsigned (*capacity) (struct _Queue*);
+
+    /** Extend the queue capacity to the specified number of elements.
+        @see QueueReserve */
+    bool (*reserve) (struct _Queue*, unsigned);
+
+    /** Shrink the queue capacity to the number of stored elements.
+        @see QueueShrinkToFit */
+    bool (*shrink_to_fit) (struct _Queue*);
+
+    /** Set the capacity growth policy.
+        @see QueueSetGrowth */
+    bool (*set_growth) (struct _Queue*, const GrowthPolicy*);
+
     /** Set the custom element cleanup function.
         @see QueueSetDestroy */
     void (*set_clean) (struct _Queue*, QueueClean func);
@@ -146,6 +162,52 @@ bool QueuePop(Queue* self);
  */
 unsigned QueueSize(Queue* self);
 
+/**
+ * @brief Return the queue capacity.
+ *
+ * @param self          The pointer to Queue structure
+ *
+ * @retval cap          The queue capacity
+ */
+unsigned QueueCapacity(Queue* self);
+
+/**
+ * @brief Extend the queue capacity so that it can contain the specified
+ * number of elements without reallocation.
+ *
+ * @param self          The pointer to Queue structure
+ * @param capacity      The specified element count
+ *
+ * @retval true         The capacity is successfully extended or already enough
+ * @retval false        Insufficient memory
+ */
+bool QueueReserve(Queue* self, unsigned capacity);
+
+/**
+ * @brief Shrink the queue capacity to the number of stored elements.
+ *
+ * @param self          The pointer to Queue structure
+ *
+ * @retval true         The capacity is successfully shrunk
+ * @retval false        The reallocation fails, and the queue is intact
+ */
+bool QueueShrinkToFit(Queue* self);
+
+/**
+ * @brief Set the capacity growth policy.
+ *
+ * The full queue is extended by the growth ratio of the policy. If the
+ * shrink ratio is set, the pop which drops the load below it also shrinks the
+ * queue. The default policy doubles the capacity and never shrinks.
+ *
+ * @param self          The pointer to Queue structure
+ * @param policy        The pointer to the growth policy
+ *
+ * @retval true         The policy is successfully applied
+ * @retval false        Invalid policy @see CdsCheckGrowth
+ */
+bool QueueSetGrowth(Queue* self, const GrowthPolicy* policy);
+
 /**
  * @brief Set the custom element cleanup function.
  *
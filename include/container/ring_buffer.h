@@ -0,0 +1,192 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file ring_buffer.h The bounded lock free ring buffer.
+ */
+
+#ifndef _RING_BUFFER_H_
+#define _RING_BUFFER_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** RingBufferData is the data type for the container private information. */
+typedef struct _RingBufferData RingBufferData;
+
+/** Element clean function called when the buffer is destructed. */
+typedef void (*RingBufferClean) (void*);
+
+
+/** The implementation for ring buffer. */
+typedef struct _RingBuffer {
+    /** The container private information */
+    RingBufferData *data;
+
+    /** Push an element to the tail of the buffer.
+        @see RingBufferPush */
+    bool (*push) (struct _RingBuffer*, void*);
+
+    /** Retrieve and remove an element from the head of the buffer.
+        @see RingBufferPop */
+    bool (*pop) (struct _RingBuffer*, void**);
+
+    /** Push a batch of elements to the tail of the buffer.
+        @see RingBufferPushN */
+    unsigned (*push_n) (struct _RingBuffer*, void**, unsigned);
+
+    /** Retrieve and remove a batch of elements from the head of the buffer.
+        @see RingBufferPopN */
+    unsigned (*pop_n) (struct _RingBuffer*, void**, unsigned);
+
+    /** Return the number of stored elements.
+        @see RingBufferSize */
+    unsigned (*size) (struct _RingBuffer*);
+
+    /** Return the buffer capacity.
+        @see RingBufferCapacity */
+    unsigned (*capacity) (struct _RingBuffer*);
+
+    /** Set the custom element cleanup function.
+        @see RingBufferSetClean */
+    void (*set_clean) (struct _RingBuffer*, RingBufferClean);
+} RingBuffer;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for RingBuffer.
+ *
+ * The capacity is fixed at construction and rounded up to the power of two.
+ * The single producer single consumer buffer is wait free, and it allows only
+ * one thread pushing and one thread popping at the same time. The multiple
+ * producer multiple consumer buffer guards each slot with a sequence number,
+ * so that any number of threads can push and pop concurrently.
+ *
+ * @param capacity      The maximum number of stored elements, 0 for default
+ * @param is_mpmc       Whether to allow multiple producers and consumers
+ *
+ * @retval obj          The successfully constructed ring buffer
+ * @retval NULL         Insufficient memory for ring buffer construction
+ */
+RingBuffer* RingBufferInit(unsigned capacity, bool is_mpmc);
+
+/**
+ * @brief The destructor for RingBuffer.
+ *
+ * The remaining elements are cleaned. The destructor must not run
+ * concurrently with the other operations.
+ *
+ * @param obj           The pointer to the to be destructed ring buffer
+ */
+void RingBufferDeinit(RingBuffer* obj);
+
+/**
+ * @brief Push an element to the tail of the buffer.
+ *
+ * @param self          The pointer to RingBuffer structure
+ * @param element       The specified element
+ *
+ * @retval true         The element is successfully pushed
+ * @retval false        The buffer is full
+ */
+bool RingBufferPush(RingBuffer* self, void* element);
+
+/**
+ * @brief Retrieve and remove an element from the head of the buffer.
+ *
+ * The cleanup function is not invoked since the ownership of the element is
+ * passed to the caller.
+ *
+ * @param self          The pointer to RingBuffer structure
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The element is successfully retrieved
+ * @retval false        The buffer is empty
+ */
+bool RingBufferPop(RingBuffer* self, void** p_element);
+
+/**
+ * @brief Push a batch of elements to the tail of the buffer.
+ *
+ * This function pushes as many leading elements as the free space allows,
+ * and it publishes them to the consumers at once.
+ *
+ * @param self          The pointer to RingBuffer structure
+ * @param elements      The array of the elements to push
+ * @param count         The number of the elements
+ *
+ * @retval num          The number of the pushed elements
+ */
+unsigned RingBufferPushN(RingBuffer* self, void** elements, unsigned count);
+
+/**
+ * @brief Retrieve and remove a batch of elements from the head of the buffer.
+ *
+ * @param self          The pointer to RingBuffer structure
+ * @param elements      The array to store the returned elements
+ * @param count         The maximum number of the elements to retrieve
+ *
+ * @retval num          The number of the retrieved elements
+ */
+unsigned RingBufferPopN(RingBuffer* self, void** elements, unsigned count);
+
+/**
+ * @brief Return the number of stored elements.
+ *
+ * The result is only a snapshot when other threads are accessing the buffer.
+ *
+ * @param self          The pointer to RingBuffer structure
+ *
+ * @retval size         The number of stored elements
+ */
+unsigned RingBufferSize(RingBuffer* self);
+
+/**
+ * @brief Return the buffer capacity.
+ *
+ * @param self          The pointer to RingBuffer structure
+ *
+ * @retval cap          The buffer capacity
+ */
+unsigned RingBufferCapacity(RingBuffer* self);
+
+/**
+ * @brief Set the custom element cleanup function.
+ *
+ * @param self          The pointer to RingBuffer structure
+ * @param func          The custom function
+ */
+void RingBufferSetClean(RingBuffer* self, RingBufferClean func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
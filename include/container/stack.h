@@ -63,6 +63,22 @@ typedef struct _Stack {
         @see StackSize */
     unsigned (*size) (struct _Stack*);
 
+    /** Return the stack capacity.
+        @see StackCapacity */
+    unsigned (*capacity) (struct _Stack*);
+
+    /** Extend the stack capacity to the specified number of elements.
+        @see StackReserve */
+    bool (*reserve) (struct _Stack*, unsigned);
+
+    /** Shrink the stack capacity to the number of stored elements.
+        @see StackShrinkToFit */
+    bool (*shrink_to_fit) (struct _Stack*);
+
+    /** Set the capacity growth policy.
+        @see StackSetGrowth */
+    bool (*set_growth) (struct _Stack*, const GrowthPolicy*);
+
     /** Set the custom element cleanup function.
         @see SetClean */
     void (*set_clean) (struct _Stack*, StackClean func);
@@ -131,6 +147,52 @@ bool StackPop(Stack* self);
  */
 unsigned StackSize(Stack* self);
 
+/**
+ * @brief Return the stack capacity.
+ *
+ * @param self          The pointer to Stack structure
+ *
+ * @retval cap          The stack capacity
+ */
+unsigned StackCapacity(Stack* self);
+
+/**
+ * @brief Extend the stack capacity so that it can contain the specified
+ * number of elements without reallocation.
+ *
+ * @param self          The pointer to Stack structure
+ * @param capacity      The specified element count
+ *
+ * @retval true         The capacity is successfully extended or already enough
+ * @retval false        Insufficient memory
+ */
+bool StackReserve(Stack* self, unsigned capacity);
+
+/**
+ * @brief Shrink the stack capacity to the number of stored elements.
+ *
+ * @param self          The pointer to Stack structure
+ *
+ * @retval true         The capacity is successfully shrunk
+ * @retval false        The reallocation fails, and the stack is intact
+ */
+bool StackShrinkToFit(Stack* self);
+
+/**
+ * @brief Set the capacity growth policy.
+ *
+ * The full stack is extended by the growth ratio of the policy. If the
+ * shrink ratio is set, the pop which drops the load below it also shrinks the
+ * stack. The default policy doubles the capacity and never shrinks.
+ *
+ * @param self          The pointer to Stack structure
+ * @param policy        The pointer to the growth policy
+ *
+ * @retval true         The policy is successfully applied
+ * @retval false        Invalid policy @see CdsCheckGrowth
+ */
+bool StackSetGrowth(Stack* self, const GrowthPolicy* policy);
+
 /**
  * @brief Set the custom element cleanup function.
  *
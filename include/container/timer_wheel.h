@@ -0,0 +1,273 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file timer_wheel.h The hierarchical timing wheel to expire large timer
+ * populations.
+ */
+
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** TimerWheelData is the data type for the container private information. */
+typedef struct _TimerWheelData TimerWheelData;
+
+/** Expiry function called with a batch of expired elements, the batch size,
+    and the custom argument. */
+typedef void (*TimerWheelExpire) (void**, unsigned, void*);
+
+/** Element clean function called when a timer is canceled. */
+typedef void (*TimerWheelClean) (void*);
+
+/** The handle to locate the scheduled timer in the wheel. */
+typedef struct _TimerWheelNode* TimerWheelHandle;
+
+
+/** The implementation for hierarchical timing wheel. */
+typedef struct _TimerWheel {
+    /** The container private information */
+    TimerWheelData *data;
+
+    /** Schedule an element to expire at the designated tick.
+        @see TimerWheelSchedule */
+    TimerWheelHandle (*schedule) (struct _TimerWheel*, uint64_t, void*);
+
+    /** Move the timer designated by the handle to another tick.
+        @see TimerWheelReschedule */
+    void (*reschedule) (struct _TimerWheel*, TimerWheelHandle, uint64_t);
+
+    /** Cancel the timer designated by the handle.
+        @see TimerWheelCancel */
+    void (*cancel) (struct _TimerWheel*, TimerWheelHandle);
+
+    /** Advance the wheel and expire the due timers in batches.
+        @see TimerWheelAdvance */
+    unsigned (*advance) (struct _TimerWheel*, uint64_t, TimerWheelExpire, void*);
+
+    /** Return the earliest tick at which a timer may expire.
+        @see TimerWheelNextExpire */
+    bool (*next_expire) (struct _TimerWheel*, uint64_t*);
+
+    /** Return the current tick of the wheel.
+        @see TimerWheelNow */
+    uint64_t (*now) (struct _TimerWheel*);
+
+    /** Return the number of scheduled timers.
+        @see TimerWheelSize */
+    unsigned (*size) (struct _TimerWheel*);
+
+    /** Set the custom element cleanup function.
+        @see TimerWheelSetClean */
+    void (*set_clean) (struct _TimerWheel*, TimerWheelClean);
+
+    /** Set the allocator for the timer nodes.
+        @see TimerWheelSetAllocator */
+    bool (*set_allocator) (struct _TimerWheel*, const Allocator*);
+
+    /** Acquire the timer nodes from a private object pool.
+        @see TimerWheelUsePool */
+    bool (*use_pool) (struct _TimerWheel*);
+} TimerWheel;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for TimerWheel.
+ *
+ * The wheel keeps 11 levels of 64 slots, and the slots of each level span 64
+ * times the ticks of the level below, so any 64 bit tick can be scheduled. A
+ * timer is hashed to the level of the highest tick digit in which its expiry
+ * differs from the current tick, and it is cascaded to the lower levels as
+ * the wheel approaches. Each level keeps a bitmap of its occupied slots, so
+ * the advance jumps directly between the occupied slots regardless of the
+ * elapsed ticks. The tick unit, such as a millisecond, is up to the caller.
+ *
+ * @param now           The initial tick
+ *
+ * @retval obj          The successfully constructed wheel
+ * @retval NULL         Insufficient memory for wheel construction
+ */
+TimerWheel* TimerWheelInit(uint64_t now);
+
+/**
+ * @brief The destructor for TimerWheel.
+ *
+ * The cleanup function is invoked for the elements of the pending timers.
+ *
+ * @param obj           The pointer to the to be destructed wheel
+ */
+void TimerWheelDeinit(TimerWheel* obj);
+
+/**
+ * @brief Schedule an element to expire at the designated tick in O(1) time.
+ *
+ * The timer expiring at or before the current tick is expired by the next
+ * advance.
+ *
+ * @param self          The pointer to TimerWheel structure
+ * @param expire        The tick at which the timer expires
+ * @param element       The specified element
+ *
+ * @retval handle       The handle to the scheduled timer
+ * @retval NULL         The timer cannot be scheduled due to insufficient memory
+ *
+ * @note The handle stays valid until the timer is canceled or expired. The
+ *  expired handle is released before its element is passed to the expiry
+ *  function.
+ */
+TimerWheelHandle TimerWheelSchedule(TimerWheel* self, uint64_t expire,
+                                    void* element);
+
+/**
+ * @brief Move the timer designated by the handle to another tick in O(1) time.
+ *
+ * This serves the idle timeouts which are pushed back on each activity. The
+ * element and the handle are kept.
+ *
+ * @param self          The pointer to TimerWheel structure
+ * @param handle        The handle to the timer
+ * @param expire        The new tick at which the timer expires
+ */
+void TimerWheelReschedule(TimerWheel* self, TimerWheelHandle handle,
+                          uint64_t expire);
+
+/**
+ * @brief Cancel the timer designated by the handle in O(1) time.
+ *
+ * This function removes the timer and releases the handle. Also, the cleanup
+ * function is invoked for its element.
+ *
+ * @param self          The pointer to TimerWheel structure
+ * @param handle        The handle to the timer
+ */
+void TimerWheelCancel(TimerWheel* self, TimerWheelHandle handle);
+
+/**
+ * @brief Advance the wheel to the designated tick and expire the due timers.
+ *
+ * The timers expiring up to the designated tick are detached from the wheel
+ * and their elements are passed to the expiry function in batches. The timers
+ * of the same tick are expired in no particular order, but the earlier ticks
+ * go before the later ones. The cleanup function is not invoked since the
+ * ownership of the elements is passed to the expiry function.
+ *
+ * The expiry function may schedule, reschedule, and cancel the pending timers.
+ * A timer which it schedules at or before the tick being expired is deferred
+ * to the next advance.
+ *
+ * @param self          The pointer to TimerWheel structure
+ * @param now           The designated tick which should not go before the
+ *                      current one
+ * @param func          The expiry function
+ * @param arg           The custom argument passed to the expiry function
+ *
+ * @retval count        The number of expired timers
+ */
+unsigned TimerWheelAdvance(TimerWheel* self, uint64_t now,
+                           TimerWheelExpire func, void* arg);
+
+/**
+ * @brief Return the earliest tick at which a timer may expire.
+ *
+ * The returned tick is exact for the timers within the lowest level. For the
+ * farther timers, it is the tick at which they are cascaded, so it never goes
+ * after the actual expiry and is suitable for the poll timeout.
+ *
+ * @param self          The pointer to TimerWheel structure
+ * @param p_tick        The pointer to the returned tick
+ *
+ * @retval true         The tick is successfully retrieved
+ * @retval false        No timer is scheduled
+ */
+bool TimerWheelNextExpire(TimerWheel* self, uint64_t* p_tick);
+
+/**
+ * @brief Return the current tick of the wheel.
+ *
+ * @param self          The pointer to TimerWheel structure
+ *
+ * @retval now          The tick of the last advance
+ */
+uint64_t TimerWheelNow(TimerWheel* self);
+
+/**
+ * @brief Return the number of scheduled timers.
+ *
+ * @param self          The pointer to TimerWheel structure
+ *
+ * @retval size         The number of scheduled timers
+ */
+unsigned TimerWheelSize(TimerWheel* self);
+
+/**
+ * @brief Set the custom element cleanup function.
+ *
+ * By default, no cleanup operation for element.
+ *
+ * @param self          The pointer to TimerWheel structure
+ * @param func          The custom function
+ */
+void TimerWheelSetClean(TimerWheel* self, TimerWheelClean func);
+
+/**
+ * @brief Set the allocator for the timer nodes.
+ *
+ * The allocator is copied, and it replaces the private pool if any.
+ *
+ * @param self          The pointer to TimerWheel structure
+ * @param alloc         The pointer to the allocator or NULL to apply the
+ *                      global one
+ *
+ * @retval true         The allocator is successfully applied
+ * @retval false        The wheel is not empty
+ */
+bool TimerWheelSetAllocator(TimerWheel* self, const Allocator* alloc);
+
+/**
+ * @brief Acquire the timer nodes from a private object pool.
+ *
+ * The large timer populations churn the fixed size nodes, which the pool
+ * recycles without going through malloc.
+ *
+ * @param self          The pointer to TimerWheel structure
+ *
+ * @retval true         The pool is successfully applied
+ * @retval false        The wheel is not empty or insufficient memory
+ */
+bool TimerWheelUsePool(TimerWheel* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
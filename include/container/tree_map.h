@@ -47,6 +47,38 @@ typedef void (*TreeMapCleanKey) (void*);
 /** Value cleanup function called whenever a live entry is removed. */
 typedef void (*TreeMapCleanValue) (void*);
 
+/** The runtime statistics of TreeMap. */
+typedef struct _TreeMapStats {
+    /** Whether the library is built with CDS_ENABLE_STATS. Otherwise, all the
+        counters below are reported as zero. */
+    bool instrumented;
+
+    /** The number of stored pairs. */
+    unsigned size;
+
+    /** The number of nodes on the longest path from the root to a leaf. */
+    unsigned height;
+
+    /** The number of key lookups, including the ones of insertion, removal and
+        bound search. */
+    unsigned long long num_lookup;
+
+    /** The number of key comparisons performed by the lookups. */
+    unsigned long long num_probe;
+
+    /** The number of rotations performed to rebalance the tree. */
+    unsigned long long num_rotate;
+
+    /** The bytes of the tree nodes allocated since construction. */
+    unsigned long long bytes_alloc;
+} TreeMapStats;
+
+/** Visit function called for each key value pair in the queried range or by
+    the parallel traversal. */
+typedef void (*TreeMapVisit) (Pair*, void*);
+
+
+struct _TreeMapIter;
 
 /** The implementation for ordered map. */
 typedef struct _TreeMap {
@@ -102,6 +134,30 @@ typedef struct _TreeMap {
         @see TreeMapNext */
     Pair* (*reverse_next) (struct _TreeMap*);
 
+    /** Position the cursor at the first pair not going before the given key.
+        @see TreeMapLowerBound */
+    void (*lower_bound) (struct _TreeMap*, void*, struct _TreeMapIter*);
+
+    /** Position the cursor at the first pair going after the given key.
+        @see TreeMapUpperBound */
+    void (*upper_bound) (struct _TreeMap*, void*, struct _TreeMapIter*);
+
+    /** Visit the key value pairs within the given key range.
+        @see TreeMapRange */
+    unsigned (*range) (struct _TreeMap*, void*, void*, TreeMapVisit, void*);
+
+    /** Return the number of keys going before the given key.
+        @see TreeMapRank */
+    unsigned (*rank) (struct _TreeMap*, void*);
+
+    /** Retrieve the key value pair with the given order.
+        @see TreeMapSelect */
+    Pair* (*select) (struct _TreeMap*, unsigned);
+
+    /** Build the map from the key value pairs sorted in ascending order.
+        @see TreeMapBuildSorted */
+    bool (*build_sorted) (struct _TreeMap*, Pair*, unsigned);
+
     /** Set the custom key comparison function.
         @see TreeMapSetCompare */
     void (*set_compare) (struct _TreeMap*, TreeMapCompare);
@@ -113,8 +169,27 @@ typedef struct _TreeMap {
     /** Set the custom value cleanup function.
         @see TreeMapSetCleanValue */
     void (*set_clean_value) (struct _TreeMap*, TreeMapCleanValue);
+
+    /** Set the allocator for the tree nodes.
+        @see TreeMapSetAllocator */
+    bool (*set_allocator) (struct _TreeMap*, const Allocator*);
+
+    /** Manage the tree nodes with an internal object pool.
+        @see TreeMapUsePool */
+    bool (*use_pool) (struct _TreeMap*);
+
+    /** Collect the runtime statistics of the map.
+        @see TreeMapGetStats */
+    void (*get_stats) (struct _TreeMap*, TreeMapStats*);
 } TreeMap;
 
+/** The external iterator for TreeMap which is allocated by the caller. */
+typedef struct _TreeMapIter {
+    TreeMapData* data_;
+    void* node_;
+    bool is_reverse_;
+} TreeMapIter;
+
 
 /*===========================================================================*
  *             Definition for the exported member operations                 *
@@ -265,6 +340,167 @@ Pair* TreeMapNext(TreeMap* self);
  */
 Pair* TreeMapReverseNext(TreeMap* self);
 
+/**
+ * @brief Initialize the external iterator.
+ *
+ * Unlike the internal iterator maintained by TreeMapFirst and TreeMapNext, the
+ * external iterator keeps its cursor in the caller provided structure. So any
+ * number of iterators can traverse the map simultaneously, and the traversal
+ * does not modify the map.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param iter          The pointer to the to be initialized iterator
+ * @param is_reverse    Whether to apply the reversed traversal
+ *
+ * @note The iterator is invalidated by the map modification.
+ */
+void TreeMapIterInit(TreeMap* self, TreeMapIter* iter, bool is_reverse);
+
+/**
+ * @brief Get the key value pair pointed by the external iterator and advance it.
+ *
+ * @param iter          The pointer to the external iterator
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The map end is reached
+ */
+Pair* TreeMapIterNext(TreeMapIter* iter);
+
+/**
+ * @brief Position the external iterator at the first key value pair whose key
+ * does not go before the designated one.
+ *
+ * The search descends the tree once, and the following TreeMapIterNext calls
+ * walk the successor path in ascending order.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param key           The designated key
+ * @param iter          The pointer to the to be positioned iterator
+ *
+ * @note If all the keys go before the designated one, the iterator is placed
+ * at the map end.
+ */
+void TreeMapLowerBound(TreeMap* self, void* key, TreeMapIter* iter);
+
+/**
+ * @brief Position the external iterator at the first key value pair whose key
+ * goes after the designated one.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param key           The designated key
+ * @param iter          The pointer to the to be positioned iterator
+ *
+ * @note If no key goes after the designated one, the iterator is placed at the
+ * map end.
+ */
+void TreeMapUpperBound(TreeMap* self, void* key, TreeMapIter* iter);
+
+/**
+ * @brief Visit the key value pairs with keys in the range [lo, hi) in
+ * ascending order.
+ *
+ * The range scan costs O(log n + k) where k is the number of visited pairs.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param lo            The inclusive lower bound of the keys
+ * @param hi            The exclusive upper bound of the keys
+ * @param func          The function to visit each pair
+ * @param arg           The custom argument passed to the visit function
+ *
+ * @retval count        The number of visited pairs
+ *
+ * @note The map should not be modified by the visit function.
+ */
+unsigned TreeMapRange(TreeMap* self, void* lo, void* hi, TreeMapVisit func,
+                      void* arg);
+
+/**
+ * @brief Return the number of stored keys going before the designated one.
+ *
+ * Each tree node tracks the size of its subtree, so the rank is accumulated
+ * in a single O(log n) descent. For a stored key, the rank is its zero based
+ * position in ascending order.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param key           The designated key which may not be stored
+ *
+ * @retval rank         The number of keys going before the designated one
+ */
+unsigned TreeMapRank(TreeMap* self, void* key);
+
+/**
+ * @brief Retrieve the key value pair with the designated zero based order in
+ * O(log n) time.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param order         The designated order
+ *
+ * @retval ptr_pair     The pointer to the target pair
+ * @retval NULL         The order is not less than the map size
+ */
+Pair* TreeMapSelect(TreeMap* self, unsigned order);
+
+/**
+ * @brief Visit all the key value pairs with the worker threads.
+ *
+ * The pairs are partitioned into the rank ranges of equal size, each spanning
+ * a run of adjacent subtrees. The ranges are claimed by the worker threads of
+ * CdsParallelRun, and each one locates its first pair with the subtree sizes
+ * and follows the successor path from there. The pairs of a range are visited
+ * in the key order, but the ranges run concurrently.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param func          The function to visit each pair
+ * @param arg           The custom argument passed to the visit function
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @note The visit function should be thread safe, and the map should not be
+ *  modified during the traversal.
+ */
+void TreeMapForEachParallel(TreeMap* self, TreeMapVisit func, void* arg,
+                            unsigned num_thread);
+
+/**
+ * @brief Reduce all the key value pairs with the worker threads.
+ *
+ * Each rank range accumulates the pairs into its own partial result, and the
+ * partial results are combined in the key order as CdsParallelRun describes.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param reducer       The pointer to the reducer whose accumulate function
+ *                      receives the Pair pointers
+ * @param acc           The identity result on entry and the reduced one on
+ *                      return
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @note The reducer functions should be thread safe, and the map should not
+ *  be modified during the traversal.
+ */
+void TreeMapReduceParallel(TreeMap* self, const Reducer* reducer, void* acc,
+                           unsigned num_thread);
+
+/**
+ * @brief Build the empty map from the key value pairs sorted in ascending
+ * order of keys.
+ *
+ * The balanced tree is built directly in O(n) time without any rotation. The
+ * nodes above the deepest level are colored black and the ones on the deepest
+ * level are colored red. If the internal pool is applied, all the nodes are
+ * carved from a single slab.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param pairs         The array of key value pairs
+ * @param size          The number of pairs
+ *
+ * @retval true         The map is successfully built
+ * @retval false        The map is not empty, the keys are not strictly in
+ *                      ascending order, or insufficient memory for the nodes
+ *
+ * @note The map takes over the keys and values only if it is successfully
+ * built.
+ */
+bool TreeMapBuildSorted(TreeMap* self, Pair* pairs, unsigned size);
+
 /**
  * @brief Set the custom key comparison function.
  *
@@ -295,6 +531,149 @@ void TreeMapSetCleanKey(TreeMap* self, TreeMapCleanKey func);
  */
 void TreeMapSetCleanValue(TreeMap* self, TreeMapCleanValue func);
 
+/**
+ * @brief Set the allocator for the tree nodes.
+ *
+ * By default, the global allocator returned by CdsGetAllocator at construction
+ * is applied. The allocator can only be replaced while the map is empty.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param alloc         The pointer to the allocator or NULL to restore the
+ *                      global one
+ *
+ * @retval true         The allocator is applied
+ * @retval false        The map is not empty
+ */
+bool TreeMapSetAllocator(TreeMap* self, const Allocator* alloc);
+
+/**
+ * @brief Manage the tree nodes with an internal object pool.
+ *
+ * The tree nodes are carved from large slabs without per node header. When
+ * the map is destructed, all the nodes are released at once, and the tree is
+ * traversed only if the cleanup functions are set. The pool can only be
+ * applied while the map is empty.
+ *
+ * @param self          The pointer to TreeMap structure
+ *
+ * @retval true         The pool is applied
+ * @retval false        The map is not empty or memory allocation fails
+ */
+bool TreeMapUsePool(TreeMap* self);
+
+/**
+ * @brief Move all the key value pairs of the source map into the designated
+ * map.
+ *
+ * The union is computed by recursively splitting the designated tree with the
+ * root key of the source tree and joining the results, which costs
+ * O(m log(n / m + 1)) comparisons for the map sizes m <= n. If both maps share
+ * the same allocator and neither uses the internal pool, the tree nodes are
+ * moved without reallocation. Otherwise, they are reallocated in advance.
+ *
+ * @param self          The pointer to the designated TreeMap structure
+ * @param other         The pointer to the source TreeMap structure
+ *
+ * @retval true         The source pairs are successfully moved
+ * @retval false        Insufficient memory for the node reallocation
+ *
+ * @note Both maps should apply the same key order. For the pairs with equal
+ * keys, the source pair replaces the designated one, which is cleaned like
+ * TreeMapPut. The source map is finally empty and no longer owns the pairs.
+ */
+bool TreeMapUnion(TreeMap* self, TreeMap* other);
+
+/**
+ * @brief The multi-threaded version of TreeMapUnion.
+ *
+ * The two subproblems produced by each split are independent, so the top
+ * recursion levels are forked to the worker threads. If a thread cannot be
+ * created, the subproblem is solved by the calling thread.
+ *
+ * @param self          The pointer to the designated TreeMap structure
+ * @param other         The pointer to the source TreeMap structure
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @retval true         The source pairs are successfully moved
+ * @retval false        Insufficient memory for the node reallocation
+ *
+ * @note The key comparison function should be thread safe.
+ */
+bool TreeMapUnionParallel(TreeMap* self, TreeMap* other, unsigned num_thread);
+
+/**
+ * @brief Move the key value pairs whose keys do not go before the designated
+ * one to the empty target map.
+ *
+ * The split costs O(log n) joins plus the node transfer which is proportional
+ * to the number of moved pairs.
+ *
+ * @param self          The pointer to the designated TreeMap structure
+ * @param key           The designated key
+ * @param other         The pointer to the empty target TreeMap structure
+ *
+ * @retval true         The pairs are successfully moved
+ * @retval false        The target map is not empty or insufficient memory for
+ *                      the node reallocation
+ */
+bool TreeMapSplit(TreeMap* self, void* key, TreeMap* other);
+
+/**
+ * @brief Collect the runtime statistics of the map.
+ *
+ * The size and the height are computed by walking the tree on each call. The
+ * lookup, rotation and allocation counters accumulate since construction, and
+ * they are maintained only if the library is built with CDS_ENABLE_STATS. The
+ * rotations performed by the worker threads of TreeMapUnionParallel are not
+ * counted.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param p_stats       The pointer to the returned statistics
+ */
+void TreeMapGetStats(TreeMap* self, TreeMapStats* p_stats);
+
+/**
+ * @brief Write all the pairs to the snapshot stream in the key order.
+ *
+ * The pairs are packed into large chunks, each handed to the writer at once.
+ * Without the codec, the key or value is treated as integer.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param writer        The pointer to the writer
+ * @param codec_key     The pointer to the key codec or NULL
+ * @param codec_value   The pointer to the value codec or NULL
+ *
+ * @retval true         The snapshot is completely written
+ * @retval false        Insufficient memory, or the writer or the codec fails
+ */
+bool TreeMapSnapshot(TreeMap* self, const SnapshotWriter* writer,
+                     const SnapshotCodec* codec_key,
+                     const SnapshotCodec* codec_value);
+
+/**
+ * @brief Load the pairs from the snapshot stream written by TreeMapSnapshot.
+ *
+ * The sorted pairs are collected first, and the tree is then built bottom up
+ * as TreeMapBuildSorted does, without any per pair search or rotation. The map
+ * should be empty and use the same key order as the one taking the snapshot.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param reader        The pointer to the reader
+ * @param codec_key     The pointer to the key codec or NULL
+ * @param codec_value   The pointer to the value codec or NULL
+ *
+ * @retval true         The snapshot is completely restored
+ * @retval false        The map is not empty, insufficient memory, the reader
+ *                      or the codec fails, or the snapshot is malformed or not
+ *                      sorted by the map order
+ *
+ * @note On failure, the map stays empty and the decoded pairs are released by
+ *  the cleanup functions.
+ */
+bool TreeMapRestore(TreeMap* self, const SnapshotReader* reader,
+                    const SnapshotCodec* codec_key,
+                    const SnapshotCodec* codec_value);
+
 #ifdef __cplusplus
 }
 #endif
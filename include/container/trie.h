@@ -36,6 +36,10 @@ extern "C" {
 /** TrieData is the data type for the container private information. */
 typedef struct TrieData_ TrieData;
 
+/** Visit function called for each matched string, and returning false to stop
+    the enumeration. */
+typedef bool (*TrieVisit) (const char*, void*);
+
 /** The implementation for trie. */
 typedef struct _Trie {
     /** The container private information. */
@@ -61,6 +65,11 @@ typedef struct _Trie {
         @see TrieGetPrefixAs */
     bool (*get_prefix_as) (struct _Trie*, const char*, const char***, unsigned*);
 
+    /** Visit the strings matching the specified prefix without materializing.
+        @see TrieVisitPrefix */
+    unsigned (*visit_prefix) (struct _Trie*, const char*, unsigned, TrieVisit,
+                              void*);
+
     /** Remove a string from the trie.
         @see TrieRemove */
     bool (*remove) (struct _Trie*, const char*);
@@ -68,6 +77,22 @@ typedef struct _Trie {
     /** Return the number of strings stored in the trie.
         @see TrieSize */
     unsigned (*size) (struct _Trie*);
+
+    /** Set the allocator for the trie nodes.
+        @see TrieSetAllocator */
+    bool (*set_allocator) (struct _Trie*, const Allocator*);
+
+    /** Manage the trie nodes with an internal object pool.
+        @see TrieUsePool */
+    bool (*use_pool) (struct _Trie*);
+
+    /** Switch to the compressed radix node representation.
+        @see TrieUseRadix */
+    bool (*use_radix) (struct _Trie*);
+
+    /** Serialize the trie into an immutable image file.
+        @see TrieFreeze */
+    bool (*freeze) (struct _Trie*, const char*);
 } Trie;
 
 
@@ -89,6 +114,28 @@ Trie* TrieInit();
  */
 void TrieDeinit(Trie* obj);
 
+/**
+ * @brief The constructor for Trie loaded from a frozen image file.
+ *
+ * The image produced by TrieFreeze is mapped into memory as is, and all the
+ * queries are answered directly from the mapping without rebuilding nodes.
+ * Loading costs no time proportional to the number of strings, and processes
+ * loading the same file share its pages through the page cache.
+ *
+ * The loaded trie is read-only. The insertion and removal, as well as the
+ * replacement of node allocator and representation, all return false. The
+ * mapping is released by TrieDeinit.
+ *
+ * @param path          The path to the image file
+ *
+ * @retval obj          The successfully loaded trie
+ * @retval NULL         The file cannot be mapped or is not a frozen image
+ *
+ * @note The image uses the byte order of the host which freezes it, and only
+ * its header is verified on loading. Please load trusted images only.
+ */
+Trie* TrieLoad(const char* path);
+
 /**
  * @brief Insert a string into the trie.
  *
@@ -150,6 +197,32 @@ bool TrieHasPrefixAs(Trie* self, const char* prefix);
  */
 bool TrieGetPrefixAs(Trie* self, const char* prefix, const char*** p_strs, unsigned* p_size);
 
+/**
+ * @brief Visit the strings matching the specified prefix in lexicographic
+ * order.
+ *
+ * The order follows strcmp, which compares the bytes as unsigned char, so the
+ * UTF-8 strings are visited in code point order.
+ *
+ * The matched subtree is walked in place, and each string is spelled into a
+ * scratch buffer which is passed to the visit function. Neither the strings
+ * nor an array to hold them are allocated, so the enumeration can stop after
+ * the first few matches at the cost of those matches only.
+ *
+ * @param self          The pointer to Trie structure
+ * @param prefix        The specified prefix
+ * @param limit         The maximum number of visited strings or 0 for no limit
+ * @param func          The function to visit each matched string
+ * @param arg           The custom argument passed to the visit function
+ *
+ * @retval count        The number of visited strings
+ *
+ * @note The visited string is valid only during the visit function call, and
+ * the trie should not be modified by the visit function.
+ */
+unsigned TrieVisitPrefix(Trie* self, const char* prefix, unsigned limit,
+                         TrieVisit func, void* arg);
+
 /**
  * @brief Remove a string from the trie.
  *
@@ -170,6 +243,78 @@ bool TrieRemove(Trie* self, const char* str);
  */
 unsigned TrieSize(Trie* self);
 
+/**
+ * @brief Set the allocator for the trie nodes.
+ *
+ * By default, the global allocator returned by CdsGetAllocator at construction
+ * is applied. The allocator can only be replaced before any string is inserted.
+ *
+ * @param self          The pointer to Trie structure
+ * @param alloc         The pointer to the allocator or NULL to restore the
+ *                      global one
+ *
+ * @retval true         The allocator is applied
+ * @retval false        The trie already holds some nodes
+ */
+bool TrieSetAllocator(Trie* self, const Allocator* alloc);
+
+/**
+ * @brief Manage the trie nodes with an internal object pool.
+ *
+ * The trie nodes are carved from large slabs without per node header. When
+ * the trie is destructed, all the nodes are released at once without tree
+ * traversal. The pool can only be applied before any string is inserted,
+ * and cannot be combined with the radix representation.
+ *
+ * @param self          The pointer to Trie structure
+ *
+ * @retval true         The pool is applied
+ * @retval false        The trie already holds some nodes or memory
+ *                      allocation fails
+ */
+bool TrieUsePool(Trie* self);
+
+/**
+ * @brief Switch to the compressed radix node representation.
+ *
+ * Instead of spending a node on each character, a radix node is labeled by
+ * the byte span shared by all the strings below it, and keeps its children in
+ * a compact array scanned by their first label bytes. A lookup visits one node
+ * per branching point rather than one per character or per sibling. The nodes
+ * are split on insertion and merged on removal, so no node other than the root
+ * has a single child without marking a string end.
+ *
+ * The representation can only be switched before any string is inserted. The
+ * radix nodes have variable sizes, so it cannot be combined with the internal
+ * pool, but any custom allocator is supported.
+ *
+ * @param self          The pointer to Trie structure
+ *
+ * @retval true         The radix representation is applied
+ * @retval false        The trie already holds some nodes or the pool is applied
+ */
+bool TrieUseRadix(Trie* self);
+
+/**
+ * @brief Serialize the trie into an immutable image file.
+ *
+ * The image is a compressed radix trie laid out in one contiguous block, and
+ * linked by byte offsets instead of pointers, so that it can be mapped by
+ * TrieLoad into any address. Tries in either node representation, as well as
+ * the loaded ones, can be frozen. The children are kept in the unsigned byte
+ * order of strcmp, so the loaded trie visits the strings as the original one.
+ *
+ * @param self          The pointer to Trie structure
+ * @param path          The path to the image file
+ *
+ * @retval true         The image is successfully written
+ * @retval false        Insufficient memory to build the image, the image
+ *                      exceeds 4GB, or the file cannot be written
+ *
+ * @note A loaded trie should not be frozen into the file it is mapped from.
+ */
+bool TrieFreeze(Trie* self, const char* path);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,248 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+/**
+ * @file trie_map.h The string keyed map with prefix queries
+ */
+#ifndef _TRIE_MAP_H_
+#define _TRIE_MAP_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** TrieMapData is the data type for the container private information. */
+typedef struct _TrieMapData TrieMapData;
+
+/** Value cleanup function called whenever a live entry is removed. */
+typedef void (*TrieMapCleanValue) (void*);
+
+/** Visit function called for each matched key value pair, and returning false
+    to stop the enumeration. */
+typedef bool (*TrieMapVisit) (const char*, void*, void*);
+
+
+/** The implementation for trie map. */
+typedef struct _TrieMap {
+    /** The container private information */
+    TrieMapData *data;
+
+    /** Insert a key value pair into the map.
+        @see TrieMapPut */
+    bool (*put) (struct _TrieMap*, const char*, void*);
+
+    /** Retrieve the value corresponding to the designated key.
+        @see TrieMapGet */
+    void* (*get) (struct _TrieMap*, const char*);
+
+    /** Check if the map contains the designated key.
+        @see TrieMapFind */
+    bool (*find) (struct _TrieMap*, const char*);
+
+    /** Delete the key value pair corresponding to the designated key.
+        @see TrieMapRemove */
+    bool (*remove) (struct _TrieMap*, const char*);
+
+    /** Return the number of stored key value pairs.
+        @see TrieMapSize */
+    unsigned (*size) (struct _TrieMap*);
+
+    /** Find the longest stored key which is a prefix of the given string.
+        @see TrieMapLongestPrefixMatch */
+    unsigned (*longest_prefix_match) (struct _TrieMap*, const char*, void**);
+
+    /** Visit the key value pairs whose keys match the designated prefix.
+        @see TrieMapVisitPrefix */
+    unsigned (*visit_prefix) (struct _TrieMap*, const char*, unsigned,
+                              TrieMapVisit, void*);
+
+    /** Set the custom value cleanup function.
+        @see TrieMapSetCleanValue */
+    void (*set_clean_value) (struct _TrieMap*, TrieMapCleanValue);
+
+    /** Set the allocator for the trie nodes.
+        @see TrieMapSetAllocator */
+    bool (*set_allocator) (struct _TrieMap*, const Allocator*);
+} TrieMap;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for TrieMap.
+ *
+ * The map is a compressed radix trie whose nodes are labeled by the byte
+ * spans shared by the keys below them, and the nodes ending a key carry the
+ * value. The keys are copied into the node labels, so the caller keeps the
+ * ownership of the passed strings.
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+TrieMap* TrieMapInit();
+
+/**
+ * @brief The destructor for TrieMap.
+ *
+ * @param obj           The pointer to the to be destructed map
+ */
+void TrieMapDeinit(TrieMap* obj);
+
+/**
+ * @brief Insert a key value pair into the map.
+ *
+ * This function inserts a key value pair into the map. If the designated key is
+ * already stored in the map, the existing value will be replaced. Also, the
+ * cleanup function is invoked for that replaced value.
+ *
+ * @param self          The pointer to TrieMap structure
+ * @param key           The designated non-empty key
+ * @param value         The designated value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        The key is empty or the pair cannot be inserted due to
+ *                      insufficient memory
+ */
+bool TrieMapPut(TrieMap* self, const char* key, void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the designated key.
+ *
+ * @param self          The pointer to TrieMap structure
+ * @param key           The designated key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ */
+void* TrieMapGet(TrieMap* self, const char* key);
+
+/**
+ * @brief Check if the map contains the designated key.
+ *
+ * @param self          The pointer to TrieMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool TrieMapFind(TrieMap* self, const char* key);
+
+/**
+ * @brief Remove the key value pair corresponding to the designated key.
+ *
+ * This function removes the key value pair corresponding to the designated key.
+ * Also, the cleanup function is invoked for that removed value.
+ *
+ * @param self          The pointer to TrieMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The pair is successfully removed
+ * @retval false        The key cannot be found
+ */
+bool TrieMapRemove(TrieMap* self, const char* key);
+
+/**
+ * @brief Return the number of stored key value pairs.
+ *
+ * @param self          The pointer to TrieMap structure
+ *
+ * @retval size         The number of stored pairs
+ */
+unsigned TrieMapSize(TrieMap* self);
+
+/**
+ * @brief Find the longest stored key which is a prefix of the given string.
+ *
+ * The string is matched against the node labels in one descent from the root,
+ * and the last passed node ending a key is reported. This serves the routing
+ * table and URL prefix lookups which resolve a string to its most specific
+ * stored rule.
+ *
+ * @param self          The pointer to TrieMap structure
+ * @param str           The designated string
+ * @param p_value       The pointer to the returned value of the matched key,
+ *                      which is untouched if no key matches
+ *
+ * @retval length       The length of the matched key
+ * @retval 0            No stored key is a prefix of the string
+ */
+unsigned TrieMapLongestPrefixMatch(TrieMap* self, const char* str,
+                                   void** p_value);
+
+/**
+ * @brief Visit the key value pairs whose keys match the designated prefix in
+ * lexicographic order of the keys.
+ *
+ * The order follows strcmp, which compares the bytes as unsigned char, so the
+ * UTF-8 keys are visited in code point order.
+ *
+ * Each key is spelled into a scratch buffer which is passed to the visit
+ * function together with its value, so no string is allocated per pair.
+ *
+ * @param self          The pointer to TrieMap structure
+ * @param prefix        The designated prefix
+ * @param limit         The maximum number of visited pairs or 0 for no limit
+ * @param func          The function to visit each matched pair
+ * @param arg           The custom argument passed to the visit function
+ *
+ * @retval count        The number of visited pairs
+ *
+ * @note The visited key is valid only during the visit function call, and the
+ * map should not be modified by the visit function.
+ */
+unsigned TrieMapVisitPrefix(TrieMap* self, const char* prefix, unsigned limit,
+                            TrieMapVisit func, void* arg);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value.
+ *
+ * @param self          The pointer to TrieMap structure
+ * @param func          The custom function
+ */
+void TrieMapSetCleanValue(TrieMap* self, TrieMapCleanValue func);
+
+/**
+ * @brief Set the allocator for the trie nodes.
+ *
+ * By default, the global allocator returned by CdsGetAllocator at construction
+ * is applied. The allocator can only be replaced before any key is inserted.
+ *
+ * @param self          The pointer to TrieMap structure
+ * @param alloc         The pointer to the allocator or NULL to restore the
+ *                      global one
+ *
+ * @retval true         The allocator is applied
+ * @retval false        The map already holds some nodes
+ */
+bool TrieMapSetAllocator(TrieMap* self, const Allocator* alloc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,515 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file typed_hash_map.h The header-only open addressing map specialized for
+ * the key and value types at compile time.
+ *
+ * The other containers dispatch through the function pointers of the object
+ * and the user supplied hash and comparison callbacks, so no call can be
+ * inlined across the library boundary. Instead, TYPED_HASH_MAP_DEFINE expands
+ * the whole map as static inline functions with the key and value types, the
+ * hash function, and the comparison function fixed by the caller. The probing
+ * and the comparisons are then compiled into the call site, and the pairs are
+ * stored by value. For example:
+ *
+ * @code
+ * static inline unsigned HashId(uint64_t key) { return (unsigned)key; }
+ * static inline int CompareId(uint64_t lhs, uint64_t rhs) { return lhs != rhs; }
+ *
+ * TYPED_HASH_MAP_DEFINE(IdMap, uint64_t, double, HashId, CompareId)
+ *
+ * IdMap* map = IdMapInit();
+ * IdMapPut(map, 7, 0.5);
+ * double* value = IdMapGet(map, 7);
+ * IdMapDeinit(map);
+ * @endcode
+ *
+ * The definition yields the following types and operations, where the
+ * placeholder Name is replaced by the designated map name:
+ *  - Name, NamePair, and NameIter
+ *  - NameInit, NameInitCapacity, and NameDeinit
+ *  - NamePut, NameGet, NameContain, NameRemove, and NameSize
+ *  - NameReserve, NameIterInit, and NameIterNext
+ *
+ * The hash function takes a key and returns an unsigned hash value. The
+ * comparison function takes two keys and returns 0 if they are equal. Both
+ * can be function-like macros as well. The slot layout and the probing
+ * follow FlatHashMap, so the map does not depend on the library at all.
+ */
+
+#ifndef _TYPED_HASH_MAP_H_
+#define _TYPED_HASH_MAP_H_
+
+#include "../util.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*===========================================================================*
+ *              The type independent helpers shared by all maps              *
+ *===========================================================================*/
+#define TYPED_HASH_MAP_DEFAULT_CAPACITY     (64)
+#define TYPED_HASH_MAP_GROUP_WIDTH          (16)
+
+/* The control tag of a full slot keeps the low 7 bits of the key hash, which
+   is always non-negative. The other two states are marked by negative tags. */
+#define TYPED_HASH_MAP_CTRL_EMPTY           ((int8_t)-128)
+#define TYPED_HASH_MAP_CTRL_DELETED         ((int8_t)-2)
+
+/**
+ * Scramble the user supplied hash so that both the slot position (high bits)
+ * and the control tag (low 7 bits) are well distributed.
+ */
+static inline unsigned _TypedHashMapMix(unsigned hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/* Return the bit mask of the control tags in the group equal to the given one. */
+static inline unsigned _TypedHashMapMatch(const int8_t* group, int8_t tag)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#else
+    unsigned mask = 0;
+    unsigned i;
+    for (i = 0 ; i < TYPED_HASH_MAP_GROUP_WIDTH ; ++i) {
+        if (group[i] == tag)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+/* Return the bit mask of the empty or deleted slots in the group. */
+static inline unsigned _TypedHashMapMatchFree(const int8_t* group)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl));
+#else
+    unsigned mask = 0;
+    unsigned i;
+    for (i = 0 ; i < TYPED_HASH_MAP_GROUP_WIDTH ; ++i) {
+        if (group[i] < -1)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Update the control tag of the designated slot. The tags of the leading group
+ * are mirrored behind the tail so that a group load never wraps around.
+ */
+static inline void _TypedHashMapSetCtrl(int8_t* arr_ctrl, unsigned num_slot,
+                                        unsigned idx, int8_t tag)
+{
+    arr_ctrl[idx] = tag;
+    if (idx < TYPED_HASH_MAP_GROUP_WIDTH)
+        arr_ctrl[num_slot + idx] = tag;
+}
+
+/* Search the first empty or deleted slot along the probing sequence. */
+static inline unsigned _TypedHashMapSearchFree(const int8_t* arr_ctrl,
+                                               unsigned num_slot, unsigned hash)
+{
+    unsigned mask = num_slot - 1;
+    unsigned pos = (hash >> 7) & mask;
+    unsigned stride = 0;
+    while (true) {
+        unsigned match = _TypedHashMapMatchFree(arr_ctrl + pos);
+        if (match)
+            return (pos + __builtin_ctz(match)) & mask;
+
+        stride += TYPED_HASH_MAP_GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+}
+
+/**
+ * Check if the removed slot can be marked as empty rather than deleted. If no
+ * probing group covering this slot was ever completely occupied, no probing
+ * sequence can pass through it.
+ */
+static inline bool _TypedHashMapCanEmpty(const int8_t* arr_ctrl,
+                                         unsigned num_slot, unsigned idx)
+{
+    unsigned idx_before = (idx - TYPED_HASH_MAP_GROUP_WIDTH) & (num_slot - 1);
+    unsigned empty_after =
+        _TypedHashMapMatch(arr_ctrl + idx, TYPED_HASH_MAP_CTRL_EMPTY);
+    unsigned empty_before =
+        _TypedHashMapMatch(arr_ctrl + idx_before, TYPED_HASH_MAP_CTRL_EMPTY);
+    return empty_after && empty_before &&
+        ((unsigned)__builtin_ctz(empty_after) +
+         (unsigned)(__builtin_clz(empty_before) -
+                    (32 - TYPED_HASH_MAP_GROUP_WIDTH))) <
+        TYPED_HASH_MAP_GROUP_WIDTH;
+}
+
+/* Return the power of two slot count to hold the designated pairs. */
+static inline unsigned _TypedHashMapSlotCount(unsigned capacity)
+{
+    unsigned num_slot = TYPED_HASH_MAP_DEFAULT_CAPACITY;
+    while ((num_slot - (num_slot >> 3)) < capacity) {
+        if (num_slot > (UINT_MAX >> 1))
+            return 0;
+        num_slot <<= 1;
+    }
+    return num_slot;
+}
+
+
+/*===========================================================================*
+ *                    The type specialized map generator                     *
+ *===========================================================================*/
+/**
+ * @brief Define the map specialized for the designated types and functions.
+ *
+ * The macro should be expanded once per translation unit at the file scope.
+ *
+ * @param Name          The name of the generated map type and the prefix of
+ *                      the generated operations
+ * @param Key           The key type
+ * @param Value         The value type
+ * @param func_hash     The hash function of the signature unsigned (Key)
+ * @param func_cmp      The key comparison function of the signature
+ *                      int (Key, Key) which returns 0 for equal keys
+ */
+#define TYPED_HASH_MAP_DEFINE(Name, Key, Value, func_hash, func_cmp)            \
+                                                                                \
+/** The key value pair stored inline in the slot array. */                      \
+typedef struct _##Name##Pair {                                                  \
+    Key key;                                                                    \
+    Value value;                                                                \
+} Name##Pair;                                                                   \
+                                                                                \
+/** The map structure which carries no function pointers. */                    \
+typedef struct _##Name {                                                        \
+    unsigned size_;                                                             \
+    unsigned num_slot_;                                                         \
+    unsigned num_deleted_;                                                      \
+    unsigned curr_limit_;                                                       \
+    int8_t* arr_ctrl_;                                                          \
+    Name##Pair* arr_pair_;                                                      \
+} Name;                                                                         \
+                                                                                \
+/** The external iterator which is allocated by the caller. */                  \
+typedef struct _##Name##Iter {                                                  \
+    Name* map_;                                                                 \
+    unsigned slot_;                                                             \
+} Name##Iter;                                                                   \
+                                                                                \
+static inline bool _##Name##Alloc(Name* self, unsigned num_slot)                \
+{                                                                               \
+    size_t size_ctrl = num_slot + TYPED_HASH_MAP_GROUP_WIDTH;                   \
+    int8_t* arr_ctrl = (int8_t*)malloc(size_ctrl);                              \
+    if (!arr_ctrl)                                                              \
+        return false;                                                           \
+                                                                                \
+    Name##Pair* arr_pair =                                                      \
+        (Name##Pair*)malloc(sizeof(Name##Pair) * num_slot);                     \
+    if (!arr_pair) {                                                            \
+        free(arr_ctrl);                                                         \
+        return false;                                                           \
+    }                                                                           \
+                                                                                \
+    memset(arr_ctrl, TYPED_HASH_MAP_CTRL_EMPTY, size_ctrl);                     \
+    self->arr_ctrl_ = arr_ctrl;                                                 \
+    self->arr_pair_ = arr_pair;                                                 \
+    self->num_slot_ = num_slot;                                                 \
+    self->curr_limit_ = num_slot - (num_slot >> 3);                             \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+/* Search the slot storing the key, or return the slot count if not found. */   \
+static inline unsigned _##Name##Search(const Name* self, Key key,               \
+                                       unsigned hash)                           \
+{                                                                               \
+    const int8_t* arr_ctrl = self->arr_ctrl_;                                   \
+    const Name##Pair* arr_pair = self->arr_pair_;                               \
+    unsigned mask = self->num_slot_ - 1;                                        \
+    int8_t tag = (int8_t)(hash & 0x7f);                                         \
+                                                                                \
+    unsigned pos = (hash >> 7) & mask;                                          \
+    unsigned stride = 0;                                                        \
+    while (true) {                                                              \
+        const int8_t* group = arr_ctrl + pos;                                   \
+        unsigned match = _TypedHashMapMatch(group, tag);                        \
+        while (match) {                                                         \
+            unsigned idx = (pos + __builtin_ctz(match)) & mask;                 \
+            if (func_cmp(key, arr_pair[idx].key) == 0)                          \
+                return idx;                                                     \
+            match &= match - 1;                                                 \
+        }                                                                       \
+                                                                                \
+        /* An empty slot terminates the probing sequence. */                    \
+        if (__builtin_expect(                                                   \
+                !!_TypedHashMapMatch(group, TYPED_HASH_MAP_CTRL_EMPTY), 1))     \
+            break;                                                              \
+                                                                                \
+        stride += TYPED_HASH_MAP_GROUP_WIDTH;                                   \
+        pos = (pos + stride) & mask;                                            \
+    }                                                                           \
+                                                                                \
+    return self->num_slot_;                                                     \
+}                                                                               \
+                                                                                \
+/* Re-distribute the stored pairs into the slot array of the given size. */     \
+static inline bool _##Name##ReHash(Name* self, unsigned num_slot_new)           \
+{                                                                               \
+    int8_t* arr_ctrl = self->arr_ctrl_;                                         \
+    Name##Pair* arr_pair = self->arr_pair_;                                     \
+    unsigned num_slot = self->num_slot_;                                        \
+                                                                                \
+    if (!_##Name##Alloc(self, num_slot_new))                                    \
+        return false;                                                           \
+                                                                                \
+    unsigned i;                                                                 \
+    for (i = 0 ; i < num_slot ; ++i) {                                          \
+        if (arr_ctrl[i] < 0)                                                    \
+            continue;                                                           \
+        unsigned hash = _TypedHashMapMix(func_hash(arr_pair[i].key));           \
+        unsigned idx = _TypedHashMapSearchFree(self->arr_ctrl_,                 \
+                                               num_slot_new, hash);             \
+        _TypedHashMapSetCtrl(self->arr_ctrl_, num_slot_new, idx,                \
+                             (int8_t)(hash & 0x7f));                            \
+        self->arr_pair_[idx] = arr_pair[i];                                     \
+    }                                                                           \
+                                                                                \
+    self->num_deleted_ = 0;                                                     \
+    free(arr_ctrl);                                                             \
+    free(arr_pair);                                                             \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+/**                                                                             \
+ * @brief The constructor which reserves the room for the designated number    \
+ * of pairs.                                                                    \
+ *                                                                              \
+ * @retval obj          The successfully constructed map                       \
+ * @retval NULL         Insufficient memory for map construction               \
+ */                                                                             \
+static inline Name* Name##InitCapacity(unsigned capacity)                       \
+{                                                                               \
+    unsigned num_slot = _TypedHashMapSlotCount(capacity);                       \
+    if (!num_slot)                                                              \
+        return NULL;                                                            \
+                                                                                \
+    Name* obj = (Name*)malloc(sizeof(Name));                                    \
+    if (!obj)                                                                   \
+        return NULL;                                                            \
+                                                                                \
+    if (!_##Name##Alloc(obj, num_slot)) {                                       \
+        free(obj);                                                              \
+        return NULL;                                                            \
+    }                                                                           \
+                                                                                \
+    obj->size_ = 0;                                                             \
+    obj->num_deleted_ = 0;                                                      \
+    return obj;                                                                 \
+}                                                                               \
+                                                                                \
+/** @brief The constructor with the default capacity. */                       \
+static inline Name* Name##Init()                                                \
+{                                                                               \
+    return Name##InitCapacity(0);                                               \
+}                                                                               \
+                                                                                \
+/** @brief The destructor. The stored pairs are released without cleanup. */   \
+static inline void Name##Deinit(Name* obj)                                      \
+{                                                                               \
+    if (!obj)                                                                   \
+        return;                                                                 \
+    free(obj->arr_ctrl_);                                                       \
+    free(obj->arr_pair_);                                                       \
+    free(obj);                                                                  \
+}                                                                               \
+                                                                                \
+/**                                                                             \
+ * @brief Insert a key value pair into the map. The value of an existing       \
+ * equal key is replaced.                                                       \
+ *                                                                              \
+ * @retval true         The pair is successfully inserted                      \
+ * @retval false        The pair cannot be inserted due to insufficient memory \
+ */                                                                             \
+static inline bool Name##Put(Name* self, Key key, Value value)                  \
+{                                                                               \
+    unsigned hash = _TypedHashMapMix(func_hash(key));                           \
+    unsigned idx = _##Name##Search(self, key, hash);                            \
+    if (idx != self->num_slot_) {                                               \
+        self->arr_pair_[idx].value = value;                                     \
+        return true;                                                            \
+    }                                                                           \
+                                                                                \
+    /* Consuming an empty slot may require rehashing to keep the probing       \
+       sequences short. A deleted slot can be reused directly. */               \
+    idx = _TypedHashMapSearchFree(self->arr_ctrl_, self->num_slot_, hash);      \
+    if (self->arr_ctrl_[idx] == TYPED_HASH_MAP_CTRL_EMPTY &&                    \
+        (self->size_ + self->num_deleted_) >= self->curr_limit_) {              \
+        unsigned num_slot = self->num_slot_;                                    \
+        unsigned num_slot_new = num_slot;                                       \
+        if (self->size_ > (self->curr_limit_ >> 1) &&                           \
+            num_slot <= (UINT_MAX >> 1))                                        \
+            num_slot_new = num_slot << 1;                                       \
+        if (_##Name##ReHash(self, num_slot_new))                                \
+            idx = _TypedHashMapSearchFree(self->arr_ctrl_, num_slot_new, hash); \
+        else {                                                                  \
+            /* Keep at least one empty slot to terminate the probing. */        \
+            if ((self->size_ + self->num_deleted_ + 1) >= num_slot)             \
+                return false;                                                   \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    if (self->arr_ctrl_[idx] == TYPED_HASH_MAP_CTRL_DELETED)                    \
+        --(self->num_deleted_);                                                 \
+    _TypedHashMapSetCtrl(self->arr_ctrl_, self->num_slot_, idx,                 \
+                         (int8_t)(hash & 0x7f));                                \
+    self->arr_pair_[idx].key = key;                                             \
+    self->arr_pair_[idx].value = value;                                         \
+    ++(self->size_);                                                            \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+/**                                                                             \
+ * @brief Retrieve the value corresponding to the specified key.               \
+ *                                                                              \
+ * @retval ptr_value    The pointer to the stored value which is invalidated   \
+ *                      by the next insertion                                   \
+ * @retval NULL         The key cannot be found                                \
+ */                                                                             \
+static inline Value* Name##Get(const Name* self, Key key)                       \
+{                                                                               \
+    unsigned hash = _TypedHashMapMix(func_hash(key));                           \
+    unsigned idx = _##Name##Search(self, key, hash);                            \
+    return (idx != self->num_slot_)? &(self->arr_pair_[idx].value) : NULL;      \
+}                                                                               \
+                                                                                \
+/** @brief Check if the map contains the specified key. */                     \
+static inline bool Name##Contain(const Name* self, Key key)                     \
+{                                                                               \
+    unsigned hash = _TypedHashMapMix(func_hash(key));                           \
+    return _##Name##Search(self, key, hash) != self->num_slot_;                 \
+}                                                                               \
+                                                                                \
+/**                                                                             \
+ * @brief Remove the key value pair corresponding to the specified key.        \
+ *                                                                              \
+ * @retval true         The pair is successfully removed                       \
+ * @retval false        The key cannot be found                                \
+ */                                                                             \
+static inline bool Name##Remove(Name* self, Key key)                            \
+{                                                                               \
+    unsigned hash = _TypedHashMapMix(func_hash(key));                           \
+    unsigned idx = _##Name##Search(self, key, hash);                            \
+    unsigned num_slot = self->num_slot_;                                        \
+    if (idx == num_slot)                                                        \
+        return false;                                                           \
+                                                                                \
+    if (_TypedHashMapCanEmpty(self->arr_ctrl_, num_slot, idx))                  \
+        _TypedHashMapSetCtrl(self->arr_ctrl_, num_slot, idx,                    \
+                             TYPED_HASH_MAP_CTRL_EMPTY);                        \
+    else {                                                                      \
+        _TypedHashMapSetCtrl(self->arr_ctrl_, num_slot, idx,                    \
+                             TYPED_HASH_MAP_CTRL_DELETED);                      \
+        ++(self->num_deleted_);                                                 \
+    }                                                                           \
+                                                                                \
+    --(self->size_);                                                            \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+/** @brief Return the number of stored key value pairs. */                     \
+static inline unsigned Name##Size(const Name* self)                             \
+{                                                                               \
+    return self->size_;                                                         \
+}                                                                               \
+                                                                                \
+/**                                                                             \
+ * @brief Reserve the room so that the designated number of pairs can be       \
+ * stored without rehashing.                                                    \
+ *                                                                              \
+ * @retval true         The room is successfully reserved                      \
+ * @retval false        Insufficient memory                                    \
+ */                                                                             \
+static inline bool Name##Reserve(Name* self, unsigned capacity)                 \
+{                                                                               \
+    if (capacity <= self->curr_limit_)                                          \
+        return true;                                                            \
+    unsigned num_slot = _TypedHashMapSlotCount(capacity);                       \
+    if (!num_slot)                                                              \
+        return false;                                                           \
+    return _##Name##ReHash(self, num_slot);                                     \
+}                                                                               \
+                                                                                \
+/** @brief Initialize the external iterator. */                                \
+static inline void Name##IterInit(Name* self, Name##Iter* iter)                 \
+{                                                                               \
+    iter->map_ = self;                                                          \
+    iter->slot_ = 0;                                                            \
+}                                                                               \
+                                                                                \
+/**                                                                             \
+ * @brief Get the pair pointed by the external iterator and advance it.        \
+ *                                                                              \
+ * @retval ptr_pair     The pointer to the current key value pair              \
+ * @retval NULL         The map end is reached                                 \
+ */                                                                             \
+static inline Name##Pair* Name##IterNext(Name##Iter* iter)                      \
+{                                                                               \
+    Name* map = iter->map_;                                                     \
+    const int8_t* arr_ctrl = map->arr_ctrl_;                                    \
+    unsigned num_slot = map->num_slot_;                                         \
+    unsigned slot = iter->slot_;                                                \
+                                                                                \
+    while (slot < num_slot) {                                                   \
+        if (arr_ctrl[slot] >= 0) {                                              \
+            iter->slot_ = slot + 1;                                             \
+            return map->arr_pair_ + slot;                                       \
+        }                                                                       \
+        ++slot;                                                                 \
+    }                                                                           \
+                                                                                \
+    iter->slot_ = num_slot;                                                     \
+    return NULL;                                                                \
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,421 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+/**
+ * @file unrolled_list.h The doubly linked list of element chunks.
+ *
+ * Each node holds a small array of elements, so the per element overhead is a
+ * fraction of a pointer, and the traversal is sequential within each chunk.
+ * The insertion and the removal in the middle only shift the elements of one
+ * chunk. A full chunk is split in halves, and a sparse chunk is merged with its
+ * successor.
+ */
+
+#ifndef _UNROLLED_LIST_H_
+#define _UNROLLED_LIST_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** UnrolledListData is the data type for the container private information. */
+typedef struct _UnrolledListData UnrolledListData;
+
+/** Element clean function called when an element is removed. */
+typedef void (*UnrolledListClean) (void*);
+
+
+/** The implementation for unrolled doubly linked list. */
+typedef struct _UnrolledList {
+    /** The container private information */
+    UnrolledListData *data;
+
+    /** Push an element to the head of the list.
+        @see UnrolledListPushFront */
+    bool (*push_front) (struct _UnrolledList*, void*);
+
+    /** Push an element to the tail of the list.
+        @see UnrolledListPushBack */
+    bool (*push_back) (struct _UnrolledList*, void*);
+
+    /** Insert an element to the specified index of the list.
+        @see UnrolledListInsert */
+    bool (*insert) (struct _UnrolledList*, unsigned, void*);
+
+    /** Pop an element from the head of the list.
+        @see UnrolledListPopFront */
+    bool (*pop_front) (struct _UnrolledList*);
+
+    /** Pop an element from the tail of the list.
+        @see UnrolledListPopBack */
+    bool (*pop_back) (struct _UnrolledList*);
+
+    /** Remove an element from the specified index of the list
+        @see UnrolledListRemove */
+    bool (*remove) (struct _UnrolledList*, unsigned);
+
+    /** Replace an element at the head of the list.
+        @see UnrolledListSetFront */
+    bool (*set_front) (struct _UnrolledList*, void*);
+
+    /** Replace an element at the tail of the list.
+        @see UnrolledListSetBack */
+    bool (*set_back) (struct _UnrolledList*, void*);
+
+    /** Replace an element at the specified index of the list.
+        @see UnrolledListSetAt */
+    bool (*set_at) (struct _UnrolledList*, unsigned, void*);
+
+    /** Get an element from the head of the list.
+        @see UnrolledListGetFront */
+    bool (*get_front) (struct _UnrolledList*, void**);
+
+    /** Get an element from the tail of the list.
+        @see UnrolledListGetBack */
+    bool (*get_back) (struct _UnrolledList*, void**);
+
+    /** Get an element from the specified index of the list.
+        @see UnrolledListGetAt */
+    bool (*get_at) (struct _UnrolledList*, unsigned, void**);
+
+    /** Return the number of stored elements.
+        @see UnrolledListSize */
+    unsigned (*size) (struct _UnrolledList*);
+
+    /** Reverse the list.
+        @see UnrolledListReverse */
+    void (*reverse) (struct _UnrolledList*);
+
+    /** Initialize the list iterator.
+        @see UnrolledListFirst */
+    void (*first) (struct _UnrolledList*, bool);
+
+    /** Get the element pointed by the iterator and advance the iterator.
+        @see UnrolledListNext */
+    bool (*next) (struct _UnrolledList*, void**);
+
+    /** Get the element pointed by the iterator and advance the iterator
+        in the reverse order.
+        @see UnrolledListReverseNext */
+    bool (*reverse_next) (struct _UnrolledList*, void**);
+
+    /** Set the custom element cleanup function.
+        @see UnrolledListSetClean */
+    void (*set_clean) (struct _UnrolledList*, UnrolledListClean);
+
+    /** Set the allocator for the list chunks.
+        @see UnrolledListSetAllocator */
+    bool (*set_allocator) (struct _UnrolledList*, const Allocator*);
+} UnrolledList;
+
+/** The external iterator for UnrolledList which is allocated by the caller. */
+typedef struct _UnrolledListIter {
+    UnrolledListData* data_;
+    void* chunk_;
+    unsigned offset_;
+    bool is_reverse_;
+} UnrolledListIter;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for UnrolledList.
+ *
+ * @param cap_chunk     The number of elements held by each chunk, or 0 to apply
+ *                      the default which fits a chunk in four cache lines
+ *
+ * @retval obj          The successfully constructed list
+ * @retval NULL         Insufficient memory for list construction
+ */
+UnrolledList* UnrolledListInit(unsigned cap_chunk);
+
+/**
+ * @brief The destructor for UnrolledList.
+ *
+ * @param obj           The pointer to the to be destructed list
+ */
+void UnrolledListDeinit(UnrolledList* obj);
+
+
+/**
+ * @brief Push an element to the head of the list.
+ *
+ * @param self          The pointer to the UnrolledList structure
+ * @param element       The specified element
+ *
+ * @retval true         The element is successfully pushed
+ * @retval false        The element cannot be pushed due to insufficient memory
+ */
+bool UnrolledListPushFront(UnrolledList* self, void* element);
+
+/**
+ * @brief Push an element to the tail of the list.
+ *
+ * @param self          The pointer to the UnrolledList structure
+ * @param element       The specified element
+ *
+ * @retval true         The element is successfully pushed
+ * @retval false        The element cannot be pushed due to insufficient memory
+ */
+bool UnrolledListPushBack(UnrolledList* self, void* element);
+
+/**
+ * @brief Insert an element to the specified index of the list.
+ *
+ * This function inserts an element to the specified index of the list and
+ * shifts the trailing elements one position to the tail.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param idx           The specified index
+ * @param element       The specified element
+ *
+ * @retval true         The element is successfully inserted
+ * @retval false        The element cannot be inserted due to invalid index
+ *                      (> list size) or insufficient memory
+ */
+bool UnrolledListInsert(UnrolledList* self, unsigned idx, void* element);
+
+/**
+ * @brief Pop an element from the head of the list.
+ *
+ * This function removes an element from the head of the list. Also, the cleanup
+ * function is invoked for the popped element.
+ *
+ * @param self          The pointer to UnrolledList structure
+ *
+ * @retval true         The head element is successfully popped
+ * @retval false        The list is empty
+ */
+bool UnrolledListPopFront(UnrolledList* self);
+
+/**
+ * @brief Pop an element from the tail of the list.
+ *
+ * This function removes an element from the tail of the list. Also, the cleanup
+ * function is invoked for the popped element.
+ *
+ * @param self          The pointer to UnrolledList structure
+ *
+ * @retval true         The tail element is successfully popped
+ * @retval false        The list is empty
+ */
+bool UnrolledListPopBack(UnrolledList* self);
+
+/**
+ * @brief Remove an element from the specified index of the list.
+ *
+ * This function removes an element from the specified index of the list and
+ * shifts the trailing elements one position to the head. Also, the cleanup
+ * function is invoked for the removed element.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param idx           The specified index
+ *
+ * @retval true         The specified element is successfully removed.
+ * @retval false        Invalid index (>= list size) or empty list
+ */
+bool UnrolledListRemove(UnrolledList* self, unsigned idx);
+
+/**
+ * @brief Replace an element at the head of the list.
+ *
+ * This function replaces the head element of the list. Also, the cleanup
+ * function is invoked for the replaced element.
+ *
+ * @param self          The pointer to the UnrolledList structure
+ * @param element       The specified element
+ *
+ * @retval true         The specified element is successfully set.
+ * @retval false        The list is empty
+ */
+bool UnrolledListSetFront(UnrolledList* self, void* element);
+
+/**
+ * @brief Replace an element at the tail of the list.
+ *
+ * This function replaces the tail element of the list. Also, the cleanup
+ * function is invoked for the replaced element.
+ *
+ * @param self          The pointer to the UnrolledList structure
+ * @param element       The specified element
+ *
+ * @retval true         The specified element is successfully set.
+ * @retval false        The list is empty
+ */
+bool UnrolledListSetBack(UnrolledList* self, void* element);
+
+/**
+ * @brief Replace an element at the specified index of the list.
+ *
+ * This function sets an element at the specified index of the list. Also, the
+ * cleanup function is invoked for the replaced element.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param idx           The specified index
+ * @param element       The specified element
+ *
+ * @retval true         The specified element is successfully set.
+ * @retval false        Invalid index (>= list size)
+ */
+bool UnrolledListSetAt(UnrolledList* self, unsigned idx, void* element);
+
+/**
+ * @brief Get an element from the head of the list.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The specified element is successfully retrieved
+ * @retval false        The list is empty
+ */
+bool UnrolledListGetFront(UnrolledList* self, void** p_element);
+
+/**
+ * @brief Get an element from the tail of the list.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The specified element is successfully retrieved
+ * @retval false        The list is empty
+ */
+bool UnrolledListGetBack(UnrolledList* self, void** p_element);
+
+/**
+ * @brief Get an element from the specified index of the list.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param idx           The specified index
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The specified element is successfully retrieved
+ * @retval false        Invalid index (>= list size)
+ */
+bool UnrolledListGetAt(UnrolledList* self, unsigned idx, void** p_element);
+
+/**
+ * @brief Return the number of stored elements.
+ *
+ * @param self          The pointer to UnrolledList structure
+ *
+ * @retval size         The number of stored elements
+ */
+unsigned UnrolledListSize(UnrolledList* self);
+
+/**
+ * @brief Reverse the list.
+ *
+ * @param self          The pointer to the UnrolledList structure
+ */
+void UnrolledListReverse(UnrolledList* self);
+
+/**
+ * @brief Initialize the list iterator.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param is_reverse    Whether to apply the reversed traversal
+ */
+void UnrolledListFirst(UnrolledList* self, bool is_reverse);
+
+/**
+ * @brief Get the element pointed by the iterator and advance the iterator.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The tail end is not reached
+ * @retval false        The tail end is reached
+ */
+bool UnrolledListNext(UnrolledList* self, void** p_element);
+
+/**
+ * @brief Get the element pointed by the iterator and advance the iterator
+ * in the reverse order.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The head end is not reached
+ * @retval false        The head end is reached
+ */
+bool UnrolledListReverseNext(UnrolledList* self, void** p_element);
+
+/**
+ * @brief Initialize the external iterator.
+ *
+ * Unlike the internal iterator maintained by UnrolledListFirst and UnrolledListNext, the
+ * external iterator keeps its cursor in the caller provided structure. So any
+ * number of iterators can traverse the list simultaneously, and the traversal
+ * does not modify the list.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param iter          The pointer to the to be initialized iterator
+ * @param is_reverse    Whether to apply the reversed traversal
+ *
+ * @note The iterator is invalidated by the list modification.
+ */
+void UnrolledListIterInit(UnrolledList* self, UnrolledListIter* iter, bool is_reverse);
+
+/**
+ * @brief Get the element pointed by the external iterator and advance it.
+ *
+ * @param iter          The pointer to the external iterator
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The traversal end is not reached
+ * @retval false        The traversal end is reached
+ */
+bool UnrolledListIterNext(UnrolledListIter* iter, void** p_element);
+
+/**
+ * @brief Set the custom element cleanup function
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param func          The custom function
+ */
+void UnrolledListSetClean(UnrolledList* self, UnrolledListClean func);
+
+/**
+ * @brief Set the allocator for the list chunks.
+ *
+ * By default, the global allocator returned by CdsGetAllocator at construction
+ * is applied. The allocator can only be replaced while the list is empty.
+ *
+ * @param self          The pointer to UnrolledList structure
+ * @param alloc         The pointer to the allocator or NULL to restore the
+ *                      global one
+ *
+ * @retval true         The allocator is applied
+ * @retval false        The list is not empty
+ */
+bool UnrolledListSetAllocator(UnrolledList* self, const Allocator* alloc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -40,9 +40,15 @@ typedef struct _VectorData VectorData;
 /** Element comparison function called to sort the vector elements. */
 typedef int (*VectorCompare) (const void*, const void*);
 
+/** Key extraction function called to radix sort the vector elements. */
+typedef uint64_t (*VectorKey) (const void*);
+
 /** Element clean function called when an element is removed. */
 typedef void (*VectorClean) (void*);
 
+/** Visit function called for each element by the parallel traversal. */
+typedef void (*VectorVisit) (void*, void*);
+
 
 /** The implementation for dynamically growable array. */
 typedef struct _Vector {
@@ -57,6 +63,18 @@ typedef struct _Vector {
         @see VectorInsert */
     bool (*insert) (struct _Vector*, unsigned, void*);
 
+    /** Insert an element array to the specified index of the vector.
+        @see VectorInsertRange */
+    bool (*insert_range) (struct _Vector*, unsigned, void**, unsigned);
+
+    /** Push an element array to the tail of the vector.
+        @see VectorAppendArray */
+    bool (*append_array) (struct _Vector*, void**, unsigned);
+
+    /** Move all the elements of another vector to the tail of the vector.
+        @see VectorExtend */
+    bool (*extend) (struct _Vector*, struct _Vector*);
+
     /** Pop an element from the tail of the vector.
         @see VectorPopBack */
     bool (*pop_back) (struct _Vector*);
@@ -65,6 +83,10 @@ typedef struct _Vector {
         @see VectorRemove */
     bool (*remove) (struct _Vector*, unsigned);
 
+    /** Remove a range of elements starting from the specified index.
+        @see VectorEraseRange */
+    bool (*erase_range) (struct _Vector*, unsigned, unsigned);
+
     /** Set an element at the specified index of the vector.
         @see VectorSet */
     bool (*set) (struct _Vector*, unsigned, void*);
@@ -85,6 +107,18 @@ typedef struct _Vector {
         @see VectorCapacity */
     unsigned (*capacity) (struct _Vector*);
 
+    /** Extend the vector capacity to the specified number of elements.
+        @see VectorReserve */
+    bool (*reserve) (struct _Vector*, unsigned);
+
+    /** Shrink the vector capacity to the number of stored elements.
+        @see VectorShrinkToFit */
+    bool (*shrink_to_fit) (struct _Vector*);
+
+    /** Set the capacity growth policy.
+        @see VectorSetGrowth */
+    bool (*set_growth) (struct _Vector*, const GrowthPolicy*);
+
     /** Sort the elements via the specified element comparison function.
         @see VectorSort */
     void (*sort) (struct _Vector*, VectorCompare);
@@ -107,6 +141,13 @@ typedef struct _Vector {
     void (*set_clean) (struct _Vector*, VectorClean);
 } Vector;
 
+/** The external iterator for Vector which is allocated by the caller. */
+typedef struct _VectorIter {
+    VectorData* data_;
+    unsigned idx_;
+    bool is_reverse_;
+} VectorIter;
+
 
 /*===========================================================================*
  *             Definition for the exported member operations                 *
@@ -155,6 +196,53 @@ bool VectorPushBack(Vector* self, void* element);
  */
 bool VectorInsert(Vector* self, unsigned idx, void* element);
 
+/**
+ * @brief Insert an element array to the specified index of the vector.
+ *
+ * This function shifts the trailing elements once for the whole array, and
+ * reallocates the internal array at most once.
+ *
+ * @param self          The pointer to Vector structure
+ * @param idx           The specified index
+ * @param elements      The element array
+ * @param count         The number of elements in the array
+ *
+ * @retval true         The elements are successfully inserted
+ * @retval false        The elements cannot be inserted due to invalid index
+ *                      (> vector size), too many elements, or insufficient
+ *                      memory, and the vector is intact
+ */
+bool VectorInsertRange(Vector* self, unsigned idx, void** elements,
+                       unsigned count);
+
+/**
+ * @brief Push an element array to the tail of the vector.
+ *
+ * @param self          The pointer to Vector structure
+ * @param elements      The element array
+ * @param count         The number of elements in the array
+ *
+ * @retval true         The elements are successfully pushed
+ * @retval false        Too many elements or insufficient memory, and the vector
+ *                      is intact
+ */
+bool VectorAppendArray(Vector* self, void** elements, unsigned count);
+
+/**
+ * @brief Move all the elements of another vector to the tail of the vector.
+ *
+ * @param self          The pointer to the designated Vector structure
+ * @param other         The pointer to the source Vector structure
+ *
+ * @retval true         The elements are successfully moved
+ * @retval false        The same vector, too many elements, or insufficient
+ *                      memory, and both vectors are intact
+ *
+ * @note The source vector is finally empty and no longer owns the elements, so
+ * they are cleaned by the cleanup function of the designated vector.
+ */
+bool VectorExtend(Vector* self, Vector* other);
+
 /**
  * @brief Pop an element from the tail of the vector.
  *
@@ -183,6 +271,21 @@ bool VectorPopBack(Vector* self);
  */
 bool VectorRemove(Vector* self, unsigned idx);
 
+/**
+ * @brief Remove a range of elements starting from the specified index.
+ *
+ * This function shifts the trailing elements once for the whole range. Also,
+ * the cleanup function is invoked for each removed element.
+ *
+ * @param self          The pointer to Vector structure
+ * @param idx           The index of the first removed element
+ * @param count         The number of removed elements
+ *
+ * @retval true         The elements are successfully removed
+ * @retval false        The range exceeds the vector size
+ */
+bool VectorEraseRange(Vector* self, unsigned idx, unsigned count);
+
 /**
  * @brief Set an element at the specified index of the vector.
  *
@@ -244,6 +347,46 @@ unsigned VectorSize(Vector* self);
  */
 unsigned VectorCapacity(Vector* self);
 
+/**
+ * @brief Extend the vector capacity so that it can contain the specified number
+ * of elements without reallocation.
+ *
+ * Unlike VectorResize, the capacity is never reduced and no element is removed.
+ *
+ * @param self          The pointer to Vector structure
+ * @param capacity      The specified element count
+ *
+ * @retval true         The capacity is successfully extended or already enough
+ * @retval false        Insufficient memory
+ */
+bool VectorReserve(Vector* self, unsigned capacity);
+
+/**
+ * @brief Shrink the vector capacity to the number of stored elements.
+ *
+ * @param self          The pointer to Vector structure
+ *
+ * @retval true         The capacity is successfully shrunk
+ * @retval false        The reallocation fails, and the vector is intact
+ */
+bool VectorShrinkToFit(Vector* self);
+
+/**
+ * @brief Set the capacity growth policy.
+ *
+ * The full vector is extended by the growth ratio of the policy. If the shrink
+ * ratio is set, the removal which drops the load below it also shrinks the
+ * vector, leaving one growth step of headroom. The default policy doubles the
+ * capacity and never shrinks.
+ *
+ * @param self          The pointer to Vector structure
+ * @param policy        The pointer to the growth policy
+ *
+ * @retval true         The policy is successfully applied
+ * @retval false        Invalid policy @see CdsCheckGrowth
+ */
+bool VectorSetGrowth(Vector* self, const GrowthPolicy* policy);
+
 /**
  * @brief Sort the elements via the specified element comparison function.
  *
@@ -252,6 +395,82 @@ unsigned VectorCapacity(Vector* self);
  */
 void VectorSort(Vector* self, VectorCompare func);
 
+/**
+ * @brief The multi-threaded version of VectorSort.
+ *
+ * The elements are recursively halved and the top recursion levels are forked
+ * to the worker threads. Each leaf range is sorted by qsort, and the sorted
+ * halves are merged back through a scratch array. If a thread cannot be
+ * created, the subproblem is solved by the calling thread.
+ *
+ * @param self          The pointer to Vector structure
+ * @param func          The custom function
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @retval true         The elements are successfully sorted
+ * @retval false        Insufficient memory for the scratch array, and the
+ *                      vector is intact
+ *
+ * @note The element comparison function should be thread safe.
+ */
+bool VectorSortParallel(Vector* self, VectorCompare func, unsigned num_thread);
+
+/**
+ * @brief Sort the elements in the ascending order of their integer keys.
+ *
+ * The keys are extracted once per element, and the elements are then
+ * distributed by the key bytes from the least significant one, so no element
+ * comparison is involved. The bytes shared by all the keys are skipped. The
+ * sort is stable.
+ *
+ * @param self          The pointer to Vector structure
+ * @param func          The custom key extraction function
+ *
+ * @retval true         The elements are successfully sorted
+ * @retval false        Insufficient memory for the key arrays, and the vector
+ *                      is intact
+ */
+bool VectorSortRadix(Vector* self, VectorKey func);
+
+/**
+ * @brief Visit all the elements with the worker threads.
+ *
+ * The element array is partitioned into index ranges, and the ranges are
+ * claimed by the worker threads of CdsParallelRun. The elements of a range
+ * are visited in the index order, but the ranges run concurrently.
+ *
+ * @param self          The pointer to Vector structure
+ * @param func          The function to visit each element
+ * @param arg           The custom argument passed to the visit function
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @note The visit function should be thread safe, and the vector should not
+ *  be modified during the traversal.
+ */
+void VectorForEachParallel(Vector* self, VectorVisit func, void* arg,
+                           unsigned num_thread);
+
+/**
+ * @brief Reduce all the elements with the worker threads.
+ *
+ * Each index range accumulates the elements into its own partial result, and
+ * the partial results are combined in the index order as CdsParallelRun
+ * describes. So an order sensitive reduction, such as collecting the
+ * elements passing a filter, yields the same result as the sequential scan.
+ *
+ * @param self          The pointer to Vector structure
+ * @param reducer       The pointer to the reducer whose accumulate function
+ *                      receives the elements
+ * @param acc           The identity result on entry and the reduced one on
+ *                      return
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @note The reducer functions should be thread safe, and the vector should
+ *  not be modified during the traversal.
+ */
+void VectorReduceParallel(Vector* self, const Reducer* reducer, void* acc,
+                          unsigned num_thread);
+
 /**
  * @brief Initialize the vector iterator.
  *
@@ -283,6 +502,33 @@ bool VectorNext(Vector* self, void** p_element);
  */
 bool VectorReverseNext(Vector* self, void** p_element);
 
+/**
+ * @brief Initialize the external iterator.
+ *
+ * Unlike the internal iterator maintained by VectorFirst and VectorNext, the
+ * external iterator keeps its cursor in the caller provided structure. So any
+ * number of iterators can traverse the vector simultaneously, and the
+ * traversal does not modify the vector.
+ *
+ * @param self          The pointer to Vector structure
+ * @param iter          The pointer to the to be initialized iterator
+ * @param is_reverse    Whether to apply the reversed traversal
+ *
+ * @note The iterator is invalidated by the vector modification.
+ */
+void VectorIterInit(Vector* self, VectorIter* iter, bool is_reverse);
+
+/**
+ * @brief Get the element pointed by the external iterator and advance it.
+ *
+ * @param iter          The pointer to the external iterator
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The traversal end is not reached
+ * @retval false        The traversal end is reached
+ */
+bool VectorIterNext(VectorIter* iter, void** p_element);
+
 /**
  * @brief Set the custom element cleanup function
  *
@@ -291,6 +537,42 @@ bool VectorReverseNext(Vector* self, void** p_element);
  */
 void VectorSetClean(Vector* self, VectorClean func);
 
+/**
+ * @brief Write all the elements to the snapshot stream.
+ *
+ * The elements are packed into large chunks, each handed to the writer at
+ * once. Without the codec, the element is treated as integer.
+ *
+ * @param self          The pointer to Vector structure
+ * @param writer        The pointer to the writer
+ * @param codec         The pointer to the element codec or NULL
+ *
+ * @retval true         The snapshot is completely written
+ * @retval false        Insufficient memory, or the writer or the codec fails
+ */
+bool VectorSnapshot(Vector* self, const SnapshotWriter* writer,
+                    const SnapshotCodec* codec);
+
+/**
+ * @brief Append the elements from the snapshot stream written by
+ * VectorSnapshot.
+ *
+ * The capacity is extended once by the element count recorded in the snapshot
+ * header, and the elements are decoded right into the array.
+ *
+ * @param self          The pointer to Vector structure
+ * @param reader        The pointer to the reader
+ * @param codec         The pointer to the element codec or NULL
+ *
+ * @retval true         The snapshot is completely restored
+ * @retval false        Insufficient memory, the reader or the codec fails, or
+ *                      the snapshot is malformed
+ *
+ * @note On failure, the elements restored so far remain in the vector.
+ */
+bool VectorRestore(Vector* self, const SnapshotReader* reader,
+                   const SnapshotCodec* codec);
+
 #ifdef __cplusplus
 }
 #endif
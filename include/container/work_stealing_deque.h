@@ -0,0 +1,184 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file work_stealing_deque.h The lock free work stealing deque.
+ */
+
+#ifndef _WORK_STEALING_DEQUE_H_
+#define _WORK_STEALING_DEQUE_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** WorkStealingDequeData is the data type for the container private
+    information. */
+typedef struct _WorkStealingDequeData WorkStealingDequeData;
+
+/** Element clean function called when the deque is destructed. */
+typedef void (*WorkStealingDequeClean) (void*);
+
+
+/** The implementation for work stealing deque. */
+typedef struct _WorkStealingDeque {
+    /** The container private information */
+    WorkStealingDequeData *data;
+
+    /** Push an element to the bottom of the deque by the owner thread.
+        @see WorkStealingDequePush */
+    bool (*push) (struct _WorkStealingDeque*, void*);
+
+    /** Retrieve and remove an element from the bottom of the deque by the
+        owner thread.
+        @see WorkStealingDequePop */
+    bool (*pop) (struct _WorkStealingDeque*, void**);
+
+    /** Retrieve and remove an element from the top of the deque by any thread.
+        @see WorkStealingDequeSteal */
+    bool (*steal) (struct _WorkStealingDeque*, void**);
+
+    /** Return the number of stored elements.
+        @see WorkStealingDequeSize */
+    unsigned (*size) (struct _WorkStealingDeque*);
+
+    /** Return the deque capacity.
+        @see WorkStealingDequeCapacity */
+    unsigned (*capacity) (struct _WorkStealingDeque*);
+
+    /** Set the custom element cleanup function.
+        @see WorkStealingDequeSetClean */
+    void (*set_clean) (struct _WorkStealingDeque*, WorkStealingDequeClean);
+} WorkStealingDeque;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for WorkStealingDeque.
+ *
+ * The deque follows the Chase-Lev algorithm. Only the owner thread can push
+ * and pop at the bottom, while the other threads steal from the top without
+ * locks. The capacity is rounded up to the power of two and doubled when the
+ * deque is full.
+ *
+ * @param capacity      The initial capacity, 0 for default
+ *
+ * @retval obj          The successfully constructed deque
+ * @retval NULL         Insufficient memory for deque construction
+ */
+WorkStealingDeque* WorkStealingDequeInit(unsigned capacity);
+
+/**
+ * @brief The destructor for WorkStealingDeque.
+ *
+ * The remaining elements are cleaned. The destructor must not run
+ * concurrently with the other operations.
+ *
+ * @param obj           The pointer to the to be destructed deque
+ */
+void WorkStealingDequeDeinit(WorkStealingDeque* obj);
+
+/**
+ * @brief Push an element to the bottom of the deque.
+ *
+ * This function must be called by the owner thread. The array replaced by
+ * the extension is retired but kept until destruction, since the concurrent
+ * thieves may still read it.
+ *
+ * @param self          The pointer to WorkStealingDeque structure
+ * @param element       The specified element
+ *
+ * @retval true         The element is successfully pushed
+ * @retval false        The element cannot be pushed due to insufficient memory
+ */
+bool WorkStealingDequePush(WorkStealingDeque* self, void* element);
+
+/**
+ * @brief Retrieve and remove an element from the bottom of the deque.
+ *
+ * This function must be called by the owner thread, and it returns the most
+ * recently pushed element. The cleanup function is not invoked since the
+ * ownership of the element is passed to the caller.
+ *
+ * @param self          The pointer to WorkStealingDeque structure
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The element is successfully retrieved
+ * @retval false        The deque is empty or the last element is stolen
+ */
+bool WorkStealingDequePop(WorkStealingDeque* self, void** p_element);
+
+/**
+ * @brief Retrieve and remove an element from the top of the deque.
+ *
+ * This function can be called by any thread, and it returns the least
+ * recently pushed element. The steal retries when it loses the race to the
+ * other thieves or the owner.
+ *
+ * @param self          The pointer to WorkStealingDeque structure
+ * @param p_element     The pointer to the returned element
+ *
+ * @retval true         The element is successfully retrieved
+ * @retval false        The deque is empty
+ */
+bool WorkStealingDequeSteal(WorkStealingDeque* self, void** p_element);
+
+/**
+ * @brief Return the number of stored elements.
+ *
+ * The result is only a snapshot when other threads are accessing the deque.
+ *
+ * @param self          The pointer to WorkStealingDeque structure
+ *
+ * @retval size         The number of stored elements
+ */
+unsigned WorkStealingDequeSize(WorkStealingDeque* self);
+
+/**
+ * @brief Return the deque capacity.
+ *
+ * @param self          The pointer to WorkStealingDeque structure
+ *
+ * @retval cap          The deque capacity
+ */
+unsigned WorkStealingDequeCapacity(WorkStealingDeque* self);
+
+/**
+ * @brief Set the custom element cleanup function.
+ *
+ * @param self          The pointer to WorkStealingDeque structure
+ * @param func          The custom function
+ */
+void WorkStealingDequeSetClean(WorkStealingDeque* self,
+                               WorkStealingDequeClean func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
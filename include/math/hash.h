@@ -27,6 +27,9 @@ unsigned HashMurMur32(void* key, size_t size);
 /**
  * @brief Hash function proposed by Bob Jenkins in 1997.
  *
+ * This is the one-at-a-time hash which mixes a byte per round.
+ * http://www.burtleburtle.net/bob/hash/doobs.html
+ *
  * @param key           The designated key
  * @param size          Size of the data pointed by the key in bytes
  *
@@ -45,4 +48,67 @@ unsigned HashJenkins(void* key, size_t size);
  */
 unsigned HashDjb2(char* key);
 
+/**
+ * @brief The high throughput 64 bit hash function of the wyhash class.
+ *
+ * The keys up to 16 bytes are hashed with a single 128 bit multiplication.
+ * The keys up to 256 bytes are folded 16 bytes per round. The longer keys are
+ * accumulated in eight 64 bit lanes per 64 byte stripe, which is vectorized
+ * with SSE2, AVX2, or NEON if available. All the paths yield the same value on
+ * all the targets.
+ *
+ * @param key           The designated key
+ * @param size          Size of the data pointed by the key in bytes
+ * @param seed          The seed to derive the independent hash function
+ *
+ * @retval hash         The corresponding hash value
+ */
+uint64_t HashFast64(void* key, size_t size, uint64_t seed);
+
+/**
+ * @brief Scramble the 64 bit hash value with the finalizer of MurMur3.
+ *
+ * Every input bit affects every output bit, so the weak hash values spread
+ * over the buckets, counters, or registers evenly after the mixing.
+ *
+ * @param hash          The designated hash value
+ *
+ * @retval hash         The scrambled hash value
+ */
+static inline uint64_t HashMix64(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * @brief Hash the null-terminated string with HashFast64 and the zero seed.
+ *
+ * This adapts HashFast64 to the uint64_t (*)(void*) hash callbacks of the
+ * containers, like BloomFilterHash, CountMinSketchHash, and HyperLogLogHash,
+ * for the string keys.
+ *
+ * @param key           The designated null-terminated string
+ *
+ * @retval hash         The corresponding hash value
+ */
+uint64_t HashString64(void* key);
+
+/**
+ * @brief Hash a batch of keys with HashFast64 and the zero seed.
+ *
+ * The keys of the batch are independent, so the multiplications of the
+ * neighboring keys overlap in the pipeline and the next keys are prefetched.
+ *
+ * @param keys          The array of the designated keys
+ * @param sizes         The array of the key sizes in bytes
+ * @param hashes        The array to store the hash values
+ * @param count         The number of the keys
+ */
+void HashBulk(void** keys, const size_t* sizes, uint64_t* hashes, size_t count);
+
 #endif
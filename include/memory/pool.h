@@ -0,0 +1,157 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file pool.h The fixed size object pool for container nodes.
+ */
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** PoolData is the data type for the pool private information. */
+typedef struct _PoolData PoolData;
+
+
+/** The implementation for object pool. */
+typedef struct _Pool {
+    /** The pool private information */
+    PoolData *data;
+
+    /** Acquire an object from the pool.
+        @see PoolAlloc */
+    void* (*alloc) (struct _Pool*);
+
+    /** Return an object to the pool.
+        @see PoolFree */
+    void (*free) (struct _Pool*, void*);
+
+    /** Return the number of objects currently acquired from the pool.
+        @see PoolSize */
+    unsigned (*size) (struct _Pool*);
+
+    /** Prepare a contiguous region for the designated number of objects.
+        @see PoolReserve */
+    bool (*reserve) (struct _Pool*, unsigned);
+
+    /** Export the pool as a generic allocator.
+        @see PoolGetAllocator */
+    void (*get_allocator) (struct _Pool*, Allocator*);
+} Pool;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for Pool.
+ *
+ * The pool carves the objects from large slabs, so that no per object header
+ * is needed, and recycles the returned objects through an embedded free list.
+ * The slab size grows geometrically as the pool expands.
+ *
+ * @param size_obj      The object size in bytes
+ *
+ * @retval obj          The successfully constructed pool
+ * @retval NULL         Insufficient memory for pool construction
+ */
+Pool* PoolInit(size_t size_obj);
+
+/**
+ * @brief The destructor for Pool.
+ *
+ * All the slabs are released at once, including the objects not yet returned.
+ *
+ * @param obj           The pointer to the to be destructed pool
+ */
+void PoolDeinit(Pool* obj);
+
+/**
+ * @brief Acquire an object from the pool.
+ *
+ * The returned object is aligned to the pointer size.
+ *
+ * @param self          The pointer to Pool structure
+ *
+ * @retval ptr          The pointer to the acquired object
+ * @retval NULL         Insufficient memory space
+ */
+void* PoolAlloc(Pool* self);
+
+/**
+ * @brief Return an object to the pool.
+ *
+ * @param self          The pointer to Pool structure
+ * @param ptr           The pointer to the object acquired from the same pool
+ */
+void PoolFree(Pool* self, void* ptr);
+
+/**
+ * @brief Return the number of objects currently acquired from the pool.
+ *
+ * @param self          The pointer to Pool structure
+ *
+ * @retval size         The number of acquired objects
+ */
+unsigned PoolSize(Pool* self);
+
+/**
+ * @brief Prepare a contiguous region for the designated number of objects.
+ *
+ * If the current slab cannot hold the designated number of objects, a slab of
+ * exactly that capacity becomes the current bump region, and the remaining
+ * tail of the old slab is left unused till the pool is destructed. The
+ * geometric slab growth is not affected.
+ *
+ * @param self          The pointer to Pool structure
+ * @param count         The designated number of objects
+ *
+ * @retval true         The region is successfully prepared
+ * @retval false        Insufficient memory space
+ *
+ * @note The recycled objects are still acquired first, so the reserved objects
+ * are contiguous only if no object is waiting on the free list.
+ */
+bool PoolReserve(Pool* self, unsigned count);
+
+/**
+ * @brief Export the pool as a generic allocator.
+ *
+ * The exported allocator fails any request larger than the object size.
+ *
+ * @param self          The pointer to Pool structure
+ * @param alloc         The pointer to the returned allocator
+ */
+void PoolGetAllocator(Pool* self, Allocator* alloc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -10,10 +10,421 @@
 #include <assert.h>
 
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /** The key value pair for associative data structures. */
 typedef struct _Pair {
     void* key;
     void* value;
 } Pair;
 
+/** The memory allocator to manage the container nodes. */
+typedef struct _Allocator {
+    /** Allocate a memory block with the designated size in bytes. */
+    void* (*alloc) (void*, size_t);
+
+    /** Release the memory block acquired from alloc. */
+    void (*free) (void*, void*);
+
+    /** The context passed as the first argument of the above functions. */
+    void* ctx;
+} Allocator;
+
+/**
+ * @brief Set the global allocator for the container nodes.
+ *
+ * The node-based containers copy the global allocator at construction, so the
+ * change only affects the containers constructed afterward.
+ *
+ * @param alloc         The pointer to the allocator or NULL to restore the
+ *                      default malloc and free
+ */
+void CdsSetAllocator(const Allocator* alloc);
+
+/**
+ * @brief Get the global allocator for the container nodes.
+ *
+ * @retval alloc        The pointer to the global allocator
+ */
+const Allocator* CdsGetAllocator();
+
+/** The capacity policy for the array based containers. */
+typedef struct _GrowthPolicy {
+    /** The percentage of the old capacity to extend a full array to, which
+        should be greater than 100. */
+    unsigned ratio_grow;
+
+    /** The load percentage below which the array is automatically shrunk, or 0
+        to keep the array at its peak capacity. */
+    unsigned ratio_shrink;
+
+    /** The capacity which the automatic shrink never goes below. */
+    unsigned min_capacity;
+} GrowthPolicy;
+
+/** The default policy which doubles the capacity and never shrinks. */
+#define CDS_GROWTH_DEFAULT  {200, 0, 1}
+
+/**
+ * @brief Check whether the growth policy is applicable.
+ *
+ * Besides the growth ratio above 100 and the positive minimal capacity, the
+ * array shrunk for the load below the shrink ratio should not qualify for the
+ * shrink again. That is, the shrink ratio times the growth ratio should be
+ * smaller than 10000. This hysteresis keeps the alternating pushes and pops
+ * around the threshold from reallocating the array each time.
+ *
+ * @param policy        The pointer to the growth policy
+ *
+ * @retval true         The policy is applicable
+ * @retval false        The policy is invalid
+ */
+bool CdsCheckGrowth(const GrowthPolicy* policy);
+
+/**
+ * @brief Calculate the capacity to extend a full array to.
+ *
+ * @param policy        The pointer to the growth policy
+ * @param capacity      The current capacity
+ * @param count         The number of elements which should fit
+ *
+ * @retval cap          The extended capacity which is at least the element
+ *                      count and bounded by UINT_MAX
+ */
+unsigned CdsGrowCapacity(const GrowthPolicy* policy, unsigned capacity,
+                         unsigned count);
+
+/**
+ * @brief Calculate the capacity to automatically shrink an array to.
+ *
+ * @param policy        The pointer to the growth policy
+ * @param capacity      The current capacity
+ * @param size          The number of stored elements
+ *
+ * @retval cap          The shrunk capacity, or the current one if the load is
+ *                      not below the shrink ratio
+ */
+unsigned CdsShrinkCapacity(const GrowthPolicy* policy, unsigned capacity,
+                           unsigned size);
+
+/** The sink which receives the snapshot bytes. */
+typedef struct _SnapshotWriter {
+    /** Write the designated number of bytes, or return false to abort the
+        snapshot. */
+    bool (*write) (void*, const void*, size_t);
+
+    /** The context passed as the first argument of the above function. */
+    void* ctx;
+} SnapshotWriter;
+
+/** The source which provides the snapshot bytes. */
+typedef struct _SnapshotReader {
+    /** Fill the buffer with exactly the designated number of bytes, or return
+        false if the stream ends early. */
+    bool (*read) (void*, void*, size_t);
+
+    /** The context passed as the first argument of the above function. */
+    void* ctx;
+} SnapshotReader;
+
+/** The user supplied conversion between an item and its encoded bytes. */
+typedef struct _SnapshotCodec {
+    /** Encode the item into the buffer with the given capacity and return the
+        encoded size. If the size exceeds the capacity, the call is repeated
+        with a buffer large enough. */
+    size_t (*encode) (void*, void*, void*, size_t);
+
+    /** Decode an item from the encoded bytes, or return false for the
+        malformed ones. */
+    bool (*decode) (void*, const void*, size_t, void**);
+
+    /** The context passed as the first argument of the above functions. */
+    void* ctx;
+} SnapshotCodec;
+
+/** The view of a snapshot already in memory, such as an mmap-ed file. */
+typedef struct _SnapshotMemory {
+    const void* base;
+    size_t size;
+    size_t offset;
+} SnapshotMemory;
+
+/** The container kinds recorded in the snapshot header. */
+enum {
+    CDS_SNAPSHOT_HASH_MAP = 1,
+    CDS_SNAPSHOT_TREE_MAP,
+    CDS_SNAPSHOT_VECTOR,
+    CDS_SNAPSHOT_COUNT_MIN_SKETCH,
+    CDS_SNAPSHOT_HYPER_LOG_LOG,
+};
+
+/** The payload size in bytes at which the encoder flushes a chunk. */
+#define CDS_SNAPSHOT_CHUNK  (1 << 16)
+
+/** The chunked encoder which is allocated by the caller. */
+typedef struct _SnapshotEncoder {
+    SnapshotWriter writer_;
+    char* chunk_;
+    size_t size_;
+    size_t capacity_;
+} SnapshotEncoder;
+
+/** The chunked decoder which is allocated by the caller. */
+typedef struct _SnapshotDecoder {
+    SnapshotReader reader_;
+    char* chunk_;
+    size_t size_;
+    size_t capacity_;
+    size_t offset_;
+} SnapshotDecoder;
+
+/**
+ * @brief Start a snapshot and write its header.
+ *
+ * The snapshot starts with a header recording the container kind and the
+ * item count, which lets the restore presize the container. The items follow
+ * as the length prefixed fields packed in the chunks of about
+ * CDS_SNAPSHOT_CHUNK bytes, and each chunk is handed to the writer at once.
+ * An empty chunk ends the snapshot, so several snapshots can be concatenated
+ * in a single stream. All the integers are little endian.
+ *
+ * @param enc           The pointer to the encoder
+ * @param writer        The pointer to the writer
+ * @param kind          The container kind
+ * @param count         The number of items
+ *
+ * @retval true         The header is written
+ * @retval false        Insufficient memory or the writer fails
+ */
+bool CdsSnapshotBegin(SnapshotEncoder* enc, const SnapshotWriter* writer,
+                      unsigned kind, unsigned count);
+
+/**
+ * @brief Append a field of raw bytes to the snapshot.
+ *
+ * @param enc           The pointer to the encoder
+ * @param bytes         The pointer to the bytes
+ * @param size          The number of bytes
+ *
+ * @retval true         The field is appended
+ * @retval false        Insufficient memory or the writer fails
+ */
+bool CdsSnapshotAppend(SnapshotEncoder* enc, const void* bytes, size_t size);
+
+/**
+ * @brief Append a field encoded by the codec to the snapshot.
+ *
+ * The item is encoded in place into the pending chunk. Without the codec, the
+ * item is treated as integer and stored in 8 bytes.
+ *
+ * @param enc           The pointer to the encoder
+ * @param codec         The pointer to the codec or NULL
+ * @param item          The item
+ *
+ * @retval true         The field is appended
+ * @retval false        Insufficient memory or the writer fails
+ */
+bool CdsSnapshotEncode(SnapshotEncoder* enc, const SnapshotCodec* codec,
+                       void* item);
+
+/**
+ * @brief Finish the snapshot and release the encoder resource.
+ *
+ * @param enc           The pointer to the encoder
+ * @param commit        Whether to flush the pending chunk and the end mark,
+ *                      or to just abandon the snapshot
+ *
+ * @retval true         The snapshot is completely written
+ * @retval false        The writer fails or the snapshot is abandoned
+ */
+bool CdsSnapshotEnd(SnapshotEncoder* enc, bool commit);
+
+/**
+ * @brief Start a restore and read the snapshot header.
+ *
+ * @param dec           The pointer to the decoder
+ * @param reader        The pointer to the reader
+ * @param kind          The expected container kind
+ * @param p_count       The pointer to the returned item count
+ *
+ * @retval true         The header is valid
+ * @retval false        Insufficient memory, the reader fails, or the header
+ *                      is malformed or records another kind
+ */
+bool CdsRestoreBegin(SnapshotDecoder* dec, const SnapshotReader* reader,
+                     unsigned kind, unsigned* p_count);
+
+/**
+ * @brief Get the next field of raw bytes from the snapshot.
+ *
+ * @param dec           The pointer to the decoder
+ * @param p_bytes       The pointer to the returned bytes which remain valid
+ *                      until the next call
+ * @param p_size        The pointer to the returned number of bytes
+ *
+ * @retval true         The field is available
+ * @retval false        The reader fails or the snapshot is malformed
+ */
+bool CdsRestoreField(SnapshotDecoder* dec, const void** p_bytes,
+                     size_t* p_size);
+
+/**
+ * @brief Decode the next field from the snapshot with the codec.
+ *
+ * @param dec           The pointer to the decoder
+ * @param codec         The pointer to the codec or NULL for integer item
+ * @param p_item        The pointer to the returned item
+ *
+ * @retval true         The item is decoded
+ * @retval false        The reader fails or the snapshot is malformed
+ */
+bool CdsRestoreDecode(SnapshotDecoder* dec, const SnapshotCodec* codec,
+                      void** p_item);
+
+/**
+ * @brief Finish the restore and release the decoder resource.
+ *
+ * @param dec           The pointer to the decoder
+ * @param commit        Whether to check that the snapshot ends right after the
+ *                      consumed fields, or to just abandon the restore
+ *
+ * @retval true         The snapshot is completely consumed
+ * @retval false        The snapshot has extra fields or the reader fails
+ */
+bool CdsRestoreEnd(SnapshotDecoder* dec, bool commit);
+
+/**
+ * @brief The writer function which appends the bytes to a stdio file.
+ *
+ * @param file          The FILE pointer as the writer context
+ * @param bytes         The pointer to the bytes
+ * @param size          The number of bytes
+ *
+ * @retval true         The bytes are written
+ * @retval false        The file write fails
+ */
+bool CdsWriteFile(void* file, const void* bytes, size_t size);
+
+/**
+ * @brief The reader function which consumes the bytes from a stdio file.
+ *
+ * @param file          The FILE pointer as the reader context
+ * @param buf           The pointer to the buffer
+ * @param size          The number of bytes
+ *
+ * @retval true         The buffer is filled
+ * @retval false        The file ends early or the read fails
+ */
+bool CdsReadFile(void* file, void* buf, size_t size);
+
+/**
+ * @brief The reader function which consumes the bytes from a memory region.
+ *
+ * Together with an mmap-ed snapshot file, the restore runs with the chunk
+ * sized copies and without any system call.
+ *
+ * @param memory        The SnapshotMemory pointer as the reader context
+ * @param buf           The pointer to the buffer
+ * @param size          The number of bytes
+ *
+ * @retval true         The buffer is filled
+ * @retval false        The region ends early
+ */
+bool CdsReadMemory(void* memory, void* buf, size_t size);
+
+/** The user supplied reduction over the container items. */
+typedef struct _Reducer {
+    /** The size in bytes of the partial result. */
+    size_t size;
+
+    /** Fold an item, the Pair pointer for the maps or the element for the
+        sequences, into the partial result. */
+    void (*accumulate) (void*, void*, void*);
+
+    /** Merge the partial result of the later range (second argument) into the
+        one of the earlier range (first argument). */
+    void (*combine) (void*, const void*, void*);
+
+    /** The context passed as the last argument of the above functions. */
+    void* ctx;
+} Reducer;
+
+/** Process the designated chunk of a container. The last argument is the
+    partial result of the chunk, or NULL if there is no reduction. */
+typedef void (*CdsChunkTask) (void*, unsigned, void*);
+
+/**
+ * @brief Process the container chunks with the worker threads and reduce
+ * their partial results.
+ *
+ * This is the small thread pool behind the parallel traversals. Up to the
+ * designated number of workers, the calling thread included, repeatedly
+ * claim the next unprocessed chunk from a shared counter, so the fast ones
+ * pick up the rest of the slow ones. If a thread cannot be created, the
+ * remaining workers process its share.
+ *
+ * With the reducer, each chunk accumulates into its own copy of the initial
+ * result, and the copies are combined into the result in the chunk order
+ * after all the workers finish. So the initial result should be the identity
+ * of the combine function, and the combine function needs to be associative
+ * but not commutative. If the copies cannot be allocated, all the chunks are
+ * accumulated into the result in order by the calling thread.
+ *
+ * @param num_chunk     The number of chunks
+ * @param num_thread    The maximum number of concurrently running threads
+ * @param func          The function to process a chunk
+ * @param ctx           The context passed as the first argument of func
+ * @param reducer       The pointer to the reducer or NULL
+ * @param acc           The initial result on entry and the final one on return
+ *                      which is ignored without the reducer
+ */
+void CdsParallelRun(unsigned num_chunk, unsigned num_thread, CdsChunkTask func,
+                    void* ctx, const Reducer* reducer, void* acc);
+
+/**
+ * @brief Return the chunk count to split the designated number of items.
+ *
+ * A few chunks are prepared for each thread to balance the uneven ones, and
+ * each chunk holds enough items to amortize its claiming cost.
+ *
+ * @param num_item      The number of items
+ * @param num_thread    The maximum number of concurrently running threads
+ *
+ * @retval count        The chunk count which is at least 1
+ */
+unsigned CdsParallelChunks(unsigned num_item, unsigned num_thread);
+
+/** The number of chain length entries reported by the statistics of the hash
+    containers. The hot path counters of the statistics are compiled in only if
+    the library is built with CDS_ENABLE_STATS. */
+#define CDS_STATS_NUM_CHAIN (8)
+
+/** The byte arrays scanned by CdsFindByte should stay readable up to their
+    lengths rounded up to this block size. */
+#define CDS_BYTE_BLOCK      (16)
+
+/**
+ * @brief Find the designated byte in a short byte array.
+ *
+ * The bytes are compared a block at a time with SSE2 or NEON when the target
+ * supports them, and the arrays wider than a block are scanned with AVX2 if
+ * the running processor supports it. This serves the child selection of the
+ * wide trie nodes, which is otherwise bound by a mispredicted branch per byte.
+ *
+ * @param bytes         The byte array readable up to the length rounded up to
+ *                      CDS_BYTE_BLOCK
+ * @param count         The number of bytes to search
+ * @param ch            The designated byte
+ *
+ * @retval idx          The index of the first matched byte
+ * @retval -1           No such byte
+ */
+int CdsFindByte(const char* bytes, unsigned count, char ch);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
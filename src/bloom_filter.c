@@ -0,0 +1,230 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/bloom_filter.h"
+#include "math/hash.h"
+#include <math.h>
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+#define SIZE_BLOCK_WORD     (8)
+#define SIZE_BLOCK_BIT      (SIZE_BLOCK_WORD * 64)
+
+static const unsigned default_capacity = 1024;
+static const double default_fp_rate = 0.01;
+static const unsigned max_probe = 16;
+static const uint64_t max_block = 1ULL << 31;
+static const size_t size_cache_line = 64;
+
+struct _BloomFilterData {
+    uint64_t* arr_block_;
+    uint64_t mask_block_;
+    unsigned num_probe_;
+    unsigned size_;
+    unsigned capacity_;
+    BloomFilterHash func_hash_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Locate the block for the scrambled hash value, and fill the bit pattern of
+ * the probes within that block. The low bits select the block while the high
+ * bits derive the probes via double hashing.
+ */
+static inline uint64_t* PATTERN(BloomFilterData* data, uint64_t hash,
+                                uint64_t* pattern)
+{
+    unsigned i;
+    for (i = 0 ; i < SIZE_BLOCK_WORD ; ++i)
+        pattern[i] = 0;
+
+    unsigned pos = (unsigned)(hash >> 32);
+    unsigned step = (unsigned)(hash >> 48) | 1;
+    for (i = 0 ; i < data->num_probe_ ; ++i) {
+        unsigned bit = pos & (SIZE_BLOCK_BIT - 1);
+        pattern[bit >> 6] |= 1ULL << (bit & 63);
+        pos += step;
+    }
+
+    return data->arr_block_ + (hash & data->mask_block_) * SIZE_BLOCK_WORD;
+}
+
+/**
+ * Return the hash value of the key via the designated hash function.
+ */
+static inline uint64_t HASH(BloomFilterData* data, void* key)
+{
+    if (data->func_hash_)
+        return data->func_hash_(key);
+    return (uint64_t)(uintptr_t)key;
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+BloomFilter* BloomFilterInit(unsigned capacity, double fp_rate)
+{
+    if (capacity == 0)
+        capacity = default_capacity;
+    if (!(fp_rate > 0 && fp_rate < 1))
+        fp_rate = default_fp_rate;
+
+    /* The optimal number of bits per key is -ln(p) / ln(2)^2, and the optimal
+       number of probes is ln(2) times of that. */
+    double ln2 = log(2.0);
+    double bit_per_key = -log(fp_rate) / (ln2 * ln2);
+    unsigned num_probe = (unsigned)(bit_per_key * ln2 + 0.5);
+    if (num_probe < 1)
+        num_probe = 1;
+    if (num_probe > max_probe)
+        num_probe = max_probe;
+
+    /* Round the number of blocks up to the power of two. */
+    double num_bit = bit_per_key * (double)capacity;
+    uint64_t num_block = 1;
+    while ((double)(num_block * SIZE_BLOCK_BIT) < num_bit && num_block < max_block)
+        num_block <<= 1;
+
+    BloomFilter* obj = (BloomFilter*)malloc(sizeof(BloomFilter));
+    if (unlikely(!obj))
+        return NULL;
+
+    BloomFilterData* data = (BloomFilterData*)malloc(sizeof(BloomFilterData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    size_t size_arr = (size_t)num_block * SIZE_BLOCK_WORD * sizeof(uint64_t);
+    uint64_t* arr_block;
+    if (unlikely(posix_memalign((void**)&arr_block, size_cache_line,
+                                size_arr) != 0)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+    memset(arr_block, 0, size_arr);
+
+    data->arr_block_ = arr_block;
+    data->mask_block_ = num_block - 1;
+    data->num_probe_ = num_probe;
+    data->size_ = 0;
+    data->capacity_ = capacity;
+    data->func_hash_ = NULL;
+
+    obj->data = data;
+    obj->add = BloomFilterAdd;
+    obj->contain = BloomFilterContain;
+    obj->add_hash = BloomFilterAddHash;
+    obj->contain_hash = BloomFilterContainHash;
+    obj->size = BloomFilterSize;
+    obj->capacity = BloomFilterCapacity;
+    obj->clear = BloomFilterClear;
+    obj->set_hash = BloomFilterSetHash;
+
+    return obj;
+}
+
+void BloomFilterDeinit(BloomFilter* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    BloomFilterData* data = obj->data;
+    free(data->arr_block_);
+    free(data);
+    free(obj);
+    return;
+}
+
+void BloomFilterAdd(BloomFilter* self, void* key)
+{
+    BloomFilterAddHash(self, HASH(self->data, key));
+}
+
+bool BloomFilterContain(BloomFilter* self, void* key)
+{
+    return BloomFilterContainHash(self, HASH(self->data, key));
+}
+
+void BloomFilterAddHash(BloomFilter* self, uint64_t hash)
+{
+    BloomFilterData* data = self->data;
+    uint64_t pattern[SIZE_BLOCK_WORD];
+    uint64_t* block = PATTERN(data, HashMix64(hash), pattern);
+
+    unsigned i;
+    for (i = 0 ; i < SIZE_BLOCK_WORD ; ++i)
+        block[i] |= pattern[i];
+    ++(data->size_);
+    return;
+}
+
+bool BloomFilterContainHash(BloomFilter* self, uint64_t hash)
+{
+    BloomFilterData* data = self->data;
+    uint64_t pattern[SIZE_BLOCK_WORD];
+    uint64_t* block = PATTERN(data, HashMix64(hash), pattern);
+
+    /* Check the whole block without branches so that the comparison can be
+       vectorized. */
+    uint64_t miss = 0;
+    unsigned i;
+    for (i = 0 ; i < SIZE_BLOCK_WORD ; ++i)
+        miss |= pattern[i] & ~block[i];
+    return miss == 0;
+}
+
+unsigned BloomFilterSize(BloomFilter* self)
+{
+    return self->data->size_;
+}
+
+unsigned BloomFilterCapacity(BloomFilter* self)
+{
+    return self->data->capacity_;
+}
+
+void BloomFilterClear(BloomFilter* self)
+{
+    BloomFilterData* data = self->data;
+    size_t size_arr = (size_t)(data->mask_block_ + 1) * SIZE_BLOCK_WORD *
+                      sizeof(uint64_t);
+    memset(data->arr_block_, 0, size_arr);
+    data->size_ = 0;
+    return;
+}
+
+void BloomFilterSetHash(BloomFilter* self, BloomFilterHash func)
+{
+    self->data->func_hash_ = func;
+}
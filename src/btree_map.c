@@ -0,0 +1,933 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+#include "container/btree_map.h"
+#include "memory/pool.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+/* The minimum degree of the tree. Each node except the root stores at least
+   MIN_DEGREE - 1 and at most MAX_PAIR key value pairs. */
+#define MIN_DEGREE      (16)
+#define MAX_PAIR        (2 * MIN_DEGREE - 1)
+
+
+typedef struct _BTreeNode {
+    unsigned count_;
+    bool leaf_;
+    struct _BTreeNode* parent_;
+    Pair pairs_[MAX_PAIR];
+    struct _BTreeNode* children_[];
+} BTreeNode;
+
+struct _BTreeMapData {
+    int size_;
+    unsigned iter_index_;
+    bool iter_fresh_;
+    BTreeNode* root_;
+    BTreeNode* iter_node_;
+    BTreeMapCompare func_cmp_;
+    BTreeMapCleanKey func_clean_key_;
+    BTreeMapCleanValue func_clean_val_;
+    Allocator alloc_leaf_;
+    Allocator alloc_inner_;
+    Pool* pool_leaf_;
+    Pool* pool_inner_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+static const size_t size_leaf = sizeof(BTreeNode);
+static const size_t size_inner = sizeof(BTreeNode) +
+                                 sizeof(BTreeNode*) * (MAX_PAIR + 1);
+
+/**
+ * Allocate the tree node via the designated allocator.
+ */
+static inline BTreeNode* NEW_NODE(BTreeMapData* data, bool leaf)
+{
+    BTreeNode* node;
+    if (leaf)
+        node = (BTreeNode*)data->alloc_leaf_.alloc(data->alloc_leaf_.ctx, size_leaf);
+    else
+        node = (BTreeNode*)data->alloc_inner_.alloc(data->alloc_inner_.ctx, size_inner);
+    if (unlikely(!node))
+        return NULL;
+
+    node->count_ = 0;
+    node->leaf_ = leaf;
+    node->parent_ = NULL;
+    return node;
+}
+
+/**
+ * Release the tree node via the designated allocator.
+ */
+static inline void DELETE_NODE(BTreeMapData* data, BTreeNode* node)
+{
+    if (node->leaf_)
+        data->alloc_leaf_.free(data->alloc_leaf_.ctx, node);
+    else
+        data->alloc_inner_.free(data->alloc_inner_.ctx, node);
+}
+
+/**
+ * Binary search the node for the designated key. Return the index of the equal
+ * key if it is found. Otherwise, return the index of the first key which goes
+ * after the designated one.
+ */
+static inline unsigned SEARCH(BTreeMapData* data, BTreeNode* node, void* key,
+                              bool* p_found)
+{
+    BTreeMapCompare func_cmp = data->func_cmp_;
+    unsigned low = 0;
+    unsigned high = node->count_;
+    while (low < high) {
+        unsigned mid = (low + high) >> 1;
+        int order = func_cmp(key, node->pairs_[mid].key);
+        if (order == 0) {
+            *p_found = true;
+            return mid;
+        }
+        if (order > 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    *p_found = false;
+    return low;
+}
+
+/**
+ * Return the position of the child node in its parent.
+ */
+static inline unsigned CHILD_INDEX(BTreeNode* parent, BTreeNode* child)
+{
+    unsigned idx = 0;
+    while (parent->children_[idx] != child)
+        ++idx;
+    return idx;
+}
+
+/**
+ * Move the designated number of children to the target node and link them to
+ * their new parent.
+ */
+static inline void MOVE_CHILDREN(BTreeNode* tge, unsigned idx_tge,
+                                 BTreeNode* src, unsigned idx_src,
+                                 unsigned count)
+{
+    memmove(tge->children_ + idx_tge, src->children_ + idx_src,
+            sizeof(BTreeNode*) * count);
+    unsigned i;
+    for (i = 0 ; i < count ; ++i)
+        tge->children_[idx_tge + i]->parent_ = tge;
+}
+
+/**
+ * @brief Traverse all the tree nodes and clean the allocated resource.
+ *
+ * @param data          The pointer to the map private data
+ * @param node          The root of the to be released subtree
+ */
+void _BTreeMapDeinit(BTreeMapData* data, BTreeNode* node);
+
+/**
+ * @brief Return the leaf node having the minimal order in the subtree rooted
+ * by the designated node.
+ *
+ * @param curr          The pointer to the designated node
+ *
+ * @retval node         The target node
+ */
+BTreeNode* _BTreeMapMinimal(BTreeNode* curr);
+
+/**
+ * @brief Return the leaf node having the maximal order in the subtree rooted
+ * by the designated node.
+ *
+ * @param curr          The pointer to the designated node
+ *
+ * @retval node         The target node
+ */
+BTreeNode* _BTreeMapMaximal(BTreeNode* curr);
+
+/**
+ * @brief Return the position of the immediate successor of the designated
+ * pair.
+ *
+ * @param curr          The node storing the designated pair
+ * @param p_index       The pointer to the index of the designated pair which
+ *                      is then updated to the index of the successor
+ *
+ * @retval node         The node storing the successor
+ * @retval NULL         The designated pair has the maximum order
+ */
+BTreeNode* _BTreeMapSuccessor(BTreeNode* curr, unsigned* p_index);
+
+/**
+ * @brief Return the position of the immediate predecessor of the designated
+ * pair.
+ *
+ * @param curr          The node storing the designated pair
+ * @param p_index       The pointer to the index of the designated pair which
+ *                      is then updated to the index of the predecessor
+ *
+ * @retval node         The node storing the predecessor
+ * @retval NULL         The designated pair has the minimum order
+ */
+BTreeNode* _BTreeMapPredecessor(BTreeNode* curr, unsigned* p_index);
+
+/**
+ * @brief Get the node which stores the key having the same order with the
+ * designated one.
+ *
+ * @param data          The pointer to tree private data
+ * @param key           The designated key
+ * @param p_index       The pointer to the returned index of the key
+ *
+ * @retval node         The target node
+ * @retval NULL         The key cannot be found
+ */
+BTreeNode* _BTreeMapSearch(BTreeMapData* data, void* key, unsigned* p_index);
+
+/**
+ * @brief Split the full child of the designated node.
+ *
+ * The median pair of the child is lifted to the parent, and the pairs going
+ * after the median are moved to a new right sibling.
+ *
+ * @param data          The pointer to tree private data
+ * @param parent        The pointer to the parent node which is not full
+ * @param idx           The position of the full child
+ *
+ * @retval true         The child is successfully split
+ * @retval false        Insufficient memory for the new sibling
+ */
+bool _BTreeMapSplit(BTreeMapData* data, BTreeNode* parent, unsigned idx);
+
+/**
+ * @brief Merge the designated child, the separating pair, and the right
+ * sibling of the child into a single node.
+ *
+ * @param data          The pointer to tree private data
+ * @param parent        The pointer to the parent node
+ * @param idx           The position of the left child
+ */
+void _BTreeMapMerge(BTreeMapData* data, BTreeNode* parent, unsigned idx);
+
+/**
+ * @brief Ensure that the designated child stores at least MIN_DEGREE pairs by
+ * borrowing from or merging with its sibling.
+ *
+ * @param data          The pointer to tree private data
+ * @param parent        The pointer to the parent node
+ * @param idx           The position of the child
+ *
+ * @retval node         The child which should be descended into
+ */
+BTreeNode* _BTreeMapFill(BTreeMapData* data, BTreeNode* parent, unsigned idx);
+
+/**
+ * @brief The default hash key comparison function.
+ *
+ * @param lhs           The source key
+ * @param rhs           The target key
+ *
+ * @retval  1           The source key should go after the target one.
+ * @retval  0           The source key is equal to the target one.
+ * @retval -1           The source key should go before the target one.
+ */
+int _BTreeMapCompare(void* lhs, void* rhs);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+BTreeMap* BTreeMapInit()
+{
+    BTreeMap* obj = (BTreeMap*)malloc(sizeof(BTreeMap));
+    if (unlikely(!obj))
+        return NULL;
+
+    BTreeMapData* data = (BTreeMapData*)malloc(sizeof(BTreeMapData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    data->size_ = 0;
+    data->iter_index_ = 0;
+    data->iter_fresh_ = true;
+    data->root_ = NULL;
+    data->iter_node_ = NULL;
+    data->func_cmp_ = _BTreeMapCompare;
+    data->func_clean_key_ = NULL;
+    data->func_clean_val_ = NULL;
+    data->alloc_leaf_ = *CdsGetAllocator();
+    data->alloc_inner_ = data->alloc_leaf_;
+    data->pool_leaf_ = NULL;
+    data->pool_inner_ = NULL;
+
+    obj->data = data;
+    obj->put = BTreeMapPut;
+    obj->get = BTreeMapGet;
+    obj->find = BTreeMapFind;
+    obj->remove = BTreeMapRemove;
+    obj->size = BTreeMapSize;
+    obj->minimum = BTreeMapMinimum;
+    obj->maximum = BTreeMapMaximum;
+    obj->predecessor = BTreeMapPredecessor;
+    obj->successor = BTreeMapSuccessor;
+    obj->first = BTreeMapFirst;
+    obj->next = BTreeMapNext;
+    obj->reverse_next = BTreeMapReverseNext;
+    obj->set_compare = BTreeMapSetCompare;
+    obj->set_clean_key = BTreeMapSetCleanKey;
+    obj->set_clean_value = BTreeMapSetCleanValue;
+    obj->set_allocator = BTreeMapSetAllocator;
+    obj->use_pool = BTreeMapUsePool;
+
+    return obj;
+}
+
+void BTreeMapDeinit(BTreeMap* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    BTreeMapData* data = obj->data;
+
+    /* The pooled nodes are released at once, so the tree is traversed only for
+       the key value cleanup. */
+    bool pooled = data->pool_leaf_ != NULL;
+    if (data->root_ && (!pooled || data->func_clean_key_ || data->func_clean_val_))
+        _BTreeMapDeinit(data, data->root_);
+    if (pooled) {
+        PoolDeinit(data->pool_leaf_);
+        PoolDeinit(data->pool_inner_);
+    }
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool BTreeMapPut(BTreeMap* self, void* key, void* value)
+{
+    BTreeMapData* data = self->data;
+
+    /* Create the root for the empty tree. */
+    BTreeNode* root = data->root_;
+    if (unlikely(!root)) {
+        root = NEW_NODE(data, true);
+        if (unlikely(!root))
+            return false;
+        data->root_ = root;
+    }
+
+    /* Split the full root in advance, which is the only way to grow the tree
+       height. */
+    if (root->count_ == MAX_PAIR) {
+        BTreeNode* top = NEW_NODE(data, false);
+        if (unlikely(!top))
+            return false;
+        top->children_[0] = root;
+        root->parent_ = top;
+        if (unlikely(!_BTreeMapSplit(data, top, 0))) {
+            root->parent_ = NULL;
+            DELETE_NODE(data, top);
+            return false;
+        }
+        data->root_ = top;
+    }
+
+    /* Descend the tree and split each full node on the path beforehand, so the
+       leaf always has room for the new pair. */
+    BTreeNode* curr = data->root_;
+    while (true) {
+        bool found;
+        unsigned idx = SEARCH(data, curr, key, &found);
+
+        Pair* pair = NULL;
+        if (found)
+            pair = curr->pairs_ + idx;
+        else if (curr->leaf_) {
+            memmove(curr->pairs_ + idx + 1, curr->pairs_ + idx,
+                    sizeof(Pair) * (curr->count_ - idx));
+            curr->pairs_[idx].key = key;
+            curr->pairs_[idx].value = value;
+            ++(curr->count_);
+            ++(data->size_);
+            return true;
+        } else {
+            BTreeNode* child = curr->children_[idx];
+            if (child->count_ == MAX_PAIR) {
+                if (unlikely(!_BTreeMapSplit(data, curr, idx)))
+                    return false;
+
+                /* Pick the proper half, or the lifted median itself. */
+                int order = data->func_cmp_(key, curr->pairs_[idx].key);
+                if (order == 0)
+                    pair = curr->pairs_ + idx;
+                else if (order > 0)
+                    child = curr->children_[idx + 1];
+            }
+            if (!pair) {
+                curr = child;
+                continue;
+            }
+        }
+
+        /* Conflict with the already stored key value pair. */
+        if (data->func_clean_key_)
+            data->func_clean_key_(pair->key);
+        if (data->func_clean_val_)
+            data->func_clean_val_(pair->value);
+        pair->key = key;
+        pair->value = value;
+        return true;
+    }
+}
+
+void* BTreeMapGet(BTreeMap* self, void* key)
+{
+    unsigned idx;
+    BTreeNode* node = _BTreeMapSearch(self->data, key, &idx);
+    if (node)
+        return node->pairs_[idx].value;
+    return NULL;
+}
+
+bool BTreeMapFind(BTreeMap* self, void* key)
+{
+    unsigned idx;
+    BTreeNode* node = _BTreeMapSearch(self->data, key, &idx);
+    return (node)? true : false;
+}
+
+bool BTreeMapRemove(BTreeMap* self, void* key)
+{
+    BTreeMapData* data = self->data;
+    BTreeNode* curr = data->root_;
+    if (unlikely(!curr))
+        return false;
+
+    /* Descend the tree and ensure that each visited node except the root has
+       at least MIN_DEGREE pairs, so the removal never underflows a node. */
+    /* The removed pair is cleaned after the descent since its key may still
+       be compared against. */
+    bool removed = false;
+    Pair victim;
+    while (true) {
+        bool found;
+        unsigned idx = SEARCH(data, curr, key, &found);
+
+        if (found) {
+            if (!removed) {
+                victim = curr->pairs_[idx];
+                removed = true;
+            }
+
+            /* Simply drop the pair from the leaf. */
+            if (curr->leaf_) {
+                memmove(curr->pairs_ + idx, curr->pairs_ + idx + 1,
+                        sizeof(Pair) * (curr->count_ - idx - 1));
+                --(curr->count_);
+                break;
+            }
+
+            /* Replace the pair with its predecessor or successor, and then
+               remove that one from the corresponding subtree. */
+            BTreeNode* left = curr->children_[idx];
+            BTreeNode* right = curr->children_[idx + 1];
+            if (left->count_ >= MIN_DEGREE) {
+                BTreeNode* leaf = _BTreeMapMaximal(left);
+                curr->pairs_[idx] = leaf->pairs_[leaf->count_ - 1];
+                key = curr->pairs_[idx].key;
+                curr = left;
+            } else if (right->count_ >= MIN_DEGREE) {
+                BTreeNode* leaf = _BTreeMapMinimal(right);
+                curr->pairs_[idx] = leaf->pairs_[0];
+                key = curr->pairs_[idx].key;
+                curr = right;
+            } else {
+                /* Both children are minimal, so merge them with the pair, and
+                   then remove the pair from the merged node. */
+                _BTreeMapMerge(data, curr, idx);
+                curr = left;
+            }
+            continue;
+        }
+
+        if (curr->leaf_)
+            break;
+        curr = _BTreeMapFill(data, curr, idx);
+    }
+
+    /* Shrink the tree height if the root is drained by merging. */
+    BTreeNode* root = data->root_;
+    if (root->count_ == 0) {
+        if (root->leaf_)
+            data->root_ = NULL;
+        else {
+            data->root_ = root->children_[0];
+            data->root_->parent_ = NULL;
+        }
+        DELETE_NODE(data, root);
+    }
+
+    if (removed) {
+        if (data->func_clean_key_)
+            data->func_clean_key_(victim.key);
+        if (data->func_clean_val_)
+            data->func_clean_val_(victim.value);
+        --(data->size_);
+    }
+    return removed;
+}
+
+unsigned BTreeMapSize(BTreeMap* self)
+{
+    return self->data->size_;
+}
+
+Pair* BTreeMapMinimum(BTreeMap* self)
+{
+    BTreeNode* root = self->data->root_;
+    if (!root)
+        return NULL;
+    return _BTreeMapMinimal(root)->pairs_;
+}
+
+Pair* BTreeMapMaximum(BTreeMap* self)
+{
+    BTreeNode* root = self->data->root_;
+    if (!root)
+        return NULL;
+    BTreeNode* node = _BTreeMapMaximal(root);
+    return node->pairs_ + node->count_ - 1;
+}
+
+Pair* BTreeMapPredecessor(BTreeMap* self, void* key)
+{
+    unsigned idx;
+    BTreeNode* node = _BTreeMapSearch(self->data, key, &idx);
+    if (!node)
+        return NULL;
+
+    node = _BTreeMapPredecessor(node, &idx);
+    if (node)
+        return node->pairs_ + idx;
+    return NULL;
+}
+
+Pair* BTreeMapSuccessor(BTreeMap* self, void* key)
+{
+    unsigned idx;
+    BTreeNode* node = _BTreeMapSearch(self->data, key, &idx);
+    if (!node)
+        return NULL;
+
+    node = _BTreeMapSuccessor(node, &idx);
+    if (node)
+        return node->pairs_ + idx;
+    return NULL;
+}
+
+void BTreeMapFirst(BTreeMap* self)
+{
+    self->data->iter_fresh_ = true;
+    self->data->iter_node_ = NULL;
+}
+
+Pair* BTreeMapNext(BTreeMap* self)
+{
+    BTreeMapData* data = self->data;
+    BTreeNode* node = data->iter_node_;
+    unsigned idx = data->iter_index_;
+
+    /* The first call starts from the minimum pair. */
+    if (data->iter_fresh_) {
+        data->iter_fresh_ = false;
+        if (!data->root_)
+            return NULL;
+        node = _BTreeMapMinimal(data->root_);
+        idx = 0;
+    } else if (node)
+        node = _BTreeMapSuccessor(node, &idx);
+
+    data->iter_node_ = node;
+    data->iter_index_ = idx;
+    return (node)? node->pairs_ + idx : NULL;
+}
+
+Pair* BTreeMapReverseNext(BTreeMap* self)
+{
+    BTreeMapData* data = self->data;
+    BTreeNode* node = data->iter_node_;
+    unsigned idx = data->iter_index_;
+
+    /* The first call starts from the maximum pair. */
+    if (data->iter_fresh_) {
+        data->iter_fresh_ = false;
+        if (!data->root_)
+            return NULL;
+        node = _BTreeMapMaximal(data->root_);
+        idx = node->count_ - 1;
+    } else if (node)
+        node = _BTreeMapPredecessor(node, &idx);
+
+    data->iter_node_ = node;
+    data->iter_index_ = idx;
+    return (node)? node->pairs_ + idx : NULL;
+}
+
+void BTreeMapIterInit(BTreeMap* self, BTreeMapIter* iter, bool is_reverse)
+{
+    BTreeNode* root = self->data->root_;
+    iter->is_reverse_ = is_reverse;
+    if (!root) {
+        iter->node_ = NULL;
+        iter->index_ = 0;
+    } else if (is_reverse == false) {
+        iter->node_ = _BTreeMapMinimal(root);
+        iter->index_ = 0;
+    } else {
+        BTreeNode* node = _BTreeMapMaximal(root);
+        iter->node_ = node;
+        iter->index_ = node->count_ - 1;
+    }
+}
+
+Pair* BTreeMapIterNext(BTreeMapIter* iter)
+{
+    BTreeNode* curr = (BTreeNode*)iter->node_;
+    if (unlikely(!curr))
+        return NULL;
+
+    unsigned idx = iter->index_;
+    Pair* pair = curr->pairs_ + idx;
+    iter->node_ = (iter->is_reverse_ == false)?
+                  _BTreeMapSuccessor(curr, &idx) :
+                  _BTreeMapPredecessor(curr, &idx);
+    iter->index_ = idx;
+    return pair;
+}
+
+void BTreeMapSetCompare(BTreeMap* self, BTreeMapCompare func)
+{
+    self->data->func_cmp_ = func;
+}
+
+void BTreeMapSetCleanKey(BTreeMap* self, BTreeMapCleanKey func)
+{
+    self->data->func_clean_key_ = func;
+}
+
+void BTreeMapSetCleanValue(BTreeMap* self, BTreeMapCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+bool BTreeMapSetAllocator(BTreeMap* self, const Allocator* alloc)
+{
+    BTreeMapData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    /* Release the drained root which may be carved from the pool. */
+    if (data->root_) {
+        DELETE_NODE(data, data->root_);
+        data->root_ = NULL;
+    }
+    if (data->pool_leaf_) {
+        PoolDeinit(data->pool_leaf_);
+        PoolDeinit(data->pool_inner_);
+        data->pool_leaf_ = NULL;
+        data->pool_inner_ = NULL;
+    }
+    data->alloc_leaf_ = (alloc)? *alloc : *CdsGetAllocator();
+    data->alloc_inner_ = data->alloc_leaf_;
+    return true;
+}
+
+bool BTreeMapUsePool(BTreeMap* self)
+{
+    BTreeMapData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    Pool* pool_leaf = PoolInit(size_leaf);
+    if (unlikely(!pool_leaf))
+        return false;
+    Pool* pool_inner = PoolInit(size_inner);
+    if (unlikely(!pool_inner)) {
+        PoolDeinit(pool_leaf);
+        return false;
+    }
+
+    if (data->root_) {
+        DELETE_NODE(data, data->root_);
+        data->root_ = NULL;
+    }
+    if (data->pool_leaf_) {
+        PoolDeinit(data->pool_leaf_);
+        PoolDeinit(data->pool_inner_);
+    }
+    data->pool_leaf_ = pool_leaf;
+    data->pool_inner_ = pool_inner;
+    PoolGetAllocator(pool_leaf, &(data->alloc_leaf_));
+    PoolGetAllocator(pool_inner, &(data->alloc_inner_));
+    return true;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+void _BTreeMapDeinit(BTreeMapData* data, BTreeNode* node)
+{
+    BTreeMapCleanKey func_clean_key = data->func_clean_key_;
+    BTreeMapCleanValue func_clean_val = data->func_clean_val_;
+
+    unsigned i;
+    for (i = 0 ; i < node->count_ ; ++i) {
+        if (func_clean_key)
+            func_clean_key(node->pairs_[i].key);
+        if (func_clean_val)
+            func_clean_val(node->pairs_[i].value);
+    }
+
+    /* The tree height is logarithmic to the pair count with a large base, so
+       the recursion is shallow. */
+    if (!node->leaf_) {
+        for (i = 0 ; i <= node->count_ ; ++i)
+            _BTreeMapDeinit(data, node->children_[i]);
+    }
+
+    if (!data->pool_leaf_)
+        DELETE_NODE(data, node);
+    return;
+}
+
+BTreeNode* _BTreeMapMinimal(BTreeNode* curr)
+{
+    while (!curr->leaf_)
+        curr = curr->children_[0];
+    return curr;
+}
+
+BTreeNode* _BTreeMapMaximal(BTreeNode* curr)
+{
+    while (!curr->leaf_)
+        curr = curr->children_[curr->count_];
+    return curr;
+}
+
+BTreeNode* _BTreeMapSuccessor(BTreeNode* curr, unsigned* p_index)
+{
+    unsigned idx = *p_index;
+
+    /* The successor is the minimum of the right subtree. */
+    if (!curr->leaf_) {
+        *p_index = 0;
+        return _BTreeMapMinimal(curr->children_[idx + 1]);
+    }
+
+    if (idx + 1 < curr->count_) {
+        *p_index = idx + 1;
+        return curr;
+    }
+
+    /* Climb up till the subtree is the left child of a certain pair. */
+    BTreeNode* parent = curr->parent_;
+    while (parent) {
+        idx = CHILD_INDEX(parent, curr);
+        if (idx < parent->count_) {
+            *p_index = idx;
+            return parent;
+        }
+        curr = parent;
+        parent = curr->parent_;
+    }
+    return NULL;
+}
+
+BTreeNode* _BTreeMapPredecessor(BTreeNode* curr, unsigned* p_index)
+{
+    unsigned idx = *p_index;
+
+    /* The predecessor is the maximum of the left subtree. */
+    if (!curr->leaf_) {
+        BTreeNode* node = _BTreeMapMaximal(curr->children_[idx]);
+        *p_index = node->count_ - 1;
+        return node;
+    }
+
+    if (idx > 0) {
+        *p_index = idx - 1;
+        return curr;
+    }
+
+    /* Climb up till the subtree is the right child of a certain pair. */
+    BTreeNode* parent = curr->parent_;
+    while (parent) {
+        idx = CHILD_INDEX(parent, curr);
+        if (idx > 0) {
+            *p_index = idx - 1;
+            return parent;
+        }
+        curr = parent;
+        parent = curr->parent_;
+    }
+    return NULL;
+}
+
+BTreeNode* _BTreeMapSearch(BTreeMapData* data, void* key, unsigned* p_index)
+{
+    BTreeNode* curr = data->root_;
+    while (curr) {
+        bool found;
+        unsigned idx = SEARCH(data, curr, key, &found);
+        if (found) {
+            *p_index = idx;
+            return curr;
+        }
+        if (curr->leaf_)
+            break;
+        curr = curr->children_[idx];
+    }
+    return NULL;
+}
+
+bool _BTreeMapSplit(BTreeMapData* data, BTreeNode* parent, unsigned idx)
+{
+    BTreeNode* child = parent->children_[idx];
+    BTreeNode* sibling = NEW_NODE(data, child->leaf_);
+    if (unlikely(!sibling))
+        return false;
+
+    /* Move the upper half of the child to the new sibling. */
+    sibling->parent_ = parent;
+    sibling->count_ = MIN_DEGREE - 1;
+    memcpy(sibling->pairs_, child->pairs_ + MIN_DEGREE,
+           sizeof(Pair) * (MIN_DEGREE - 1));
+    if (!child->leaf_)
+        MOVE_CHILDREN(sibling, 0, child, MIN_DEGREE, MIN_DEGREE);
+    child->count_ = MIN_DEGREE - 1;
+
+    /* Lift the median to the parent and link the new sibling. */
+    unsigned count = parent->count_;
+    memmove(parent->pairs_ + idx + 1, parent->pairs_ + idx,
+            sizeof(Pair) * (count - idx));
+    memmove(parent->children_ + idx + 2, parent->children_ + idx + 1,
+            sizeof(BTreeNode*) * (count - idx));
+    parent->pairs_[idx] = child->pairs_[MIN_DEGREE - 1];
+    parent->children_[idx + 1] = sibling;
+    parent->count_ = count + 1;
+    return true;
+}
+
+void _BTreeMapMerge(BTreeMapData* data, BTreeNode* parent, unsigned idx)
+{
+    BTreeNode* left = parent->children_[idx];
+    BTreeNode* right = parent->children_[idx + 1];
+
+    /* Pull down the separating pair and append the right sibling. */
+    unsigned count = left->count_;
+    left->pairs_[count] = parent->pairs_[idx];
+    memcpy(left->pairs_ + count + 1, right->pairs_, sizeof(Pair) * right->count_);
+    if (!left->leaf_)
+        MOVE_CHILDREN(left, count + 1, right, 0, right->count_ + 1);
+    left->count_ = count + 1 + right->count_;
+
+    /* Remove the separating pair and the right sibling from the parent. */
+    unsigned count_parent = parent->count_;
+    memmove(parent->pairs_ + idx, parent->pairs_ + idx + 1,
+            sizeof(Pair) * (count_parent - idx - 1));
+    memmove(parent->children_ + idx + 1, parent->children_ + idx + 2,
+            sizeof(BTreeNode*) * (count_parent - idx - 1));
+    parent->count_ = count_parent - 1;
+
+    DELETE_NODE(data, right);
+    return;
+}
+
+BTreeNode* _BTreeMapFill(BTreeMapData* data, BTreeNode* parent, unsigned idx)
+{
+    BTreeNode* child = parent->children_[idx];
+    if (child->count_ >= MIN_DEGREE)
+        return child;
+
+    /* Borrow a pair from the left sibling through the parent. */
+    if (idx > 0 && parent->children_[idx - 1]->count_ >= MIN_DEGREE) {
+        BTreeNode* left = parent->children_[idx - 1];
+        memmove(child->pairs_ + 1, child->pairs_, sizeof(Pair) * child->count_);
+        child->pairs_[0] = parent->pairs_[idx - 1];
+        if (!child->leaf_) {
+            MOVE_CHILDREN(child, 1, child, 0, child->count_ + 1);
+            MOVE_CHILDREN(child, 0, left, left->count_, 1);
+        }
+        parent->pairs_[idx - 1] = left->pairs_[left->count_ - 1];
+        --(left->count_);
+        ++(child->count_);
+        return child;
+    }
+
+    /* Borrow a pair from the right sibling through the parent. */
+    if (idx < parent->count_ && parent->children_[idx + 1]->count_ >= MIN_DEGREE) {
+        BTreeNode* right = parent->children_[idx + 1];
+        child->pairs_[child->count_] = parent->pairs_[idx];
+        if (!child->leaf_) {
+            MOVE_CHILDREN(child, child->count_ + 1, right, 0, 1);
+            MOVE_CHILDREN(right, 0, right, 1, right->count_);
+        }
+        parent->pairs_[idx] = right->pairs_[0];
+        memmove(right->pairs_, right->pairs_ + 1, sizeof(Pair) * (right->count_ - 1));
+        --(right->count_);
+        ++(child->count_);
+        return child;
+    }
+
+    /* Otherwise, merge with a sibling. */
+    if (idx < parent->count_) {
+        _BTreeMapMerge(data, parent, idx);
+        return child;
+    }
+    _BTreeMapMerge(data, parent, idx - 1);
+    return parent->children_[idx - 1];
+}
+
+int _BTreeMapCompare(void* lhs, void* rhs)
+{
+    if ((intptr_t)lhs == (intptr_t)rhs)
+        return 0;
+    return ((intptr_t)lhs > (intptr_t)rhs)? 1 : (-1);
+}
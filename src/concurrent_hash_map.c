@@ -0,0 +1,310 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include "container/concurrent_hash_map.h"
+#include "container/hash_map.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const unsigned default_num_shard = 16;
+static const unsigned max_num_shard = 1024;
+static const size_t size_cache_line = 64;
+
+
+/* Each shard occupies its own cache lines to avoid false sharing between the
+   locks of the neighboring shards. */
+typedef struct _Shard {
+    pthread_rwlock_t lock_;
+    HashMap* map_;
+} __attribute__((aligned(64))) Shard;
+
+struct _ConcurrentHashMapData {
+    unsigned num_shard_;
+    Shard* arr_shard_;
+    ConcurrentHashMapHash func_hash_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Locate the shard which should contain the given key. The hash value is
+ * scrambled first so that the shard index is independent of the slot index
+ * derived by the shard's own map.
+ */
+static inline Shard* GET_SHARD(ConcurrentHashMapData* data, void* key)
+{
+    unsigned hash = data->func_hash_(key);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return data->arr_shard_ + (hash & (data->num_shard_ - 1));
+}
+
+/**
+ * @brief The default hash function.
+ *
+ * @param key           The designated key
+ *
+ * @retval Hash         The corresponding hash value
+ */
+unsigned _ConcurrentHashMapHash(void* key);
+
+/**
+ * @brief Release the shards which are already initialized.
+ *
+ * @param arr_shard     The array of shards
+ * @param num_shard     The number of initialized shards
+ */
+void _ConcurrentHashMapRelease(Shard* arr_shard, unsigned num_shard);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+ConcurrentHashMap* ConcurrentHashMapInit(unsigned num_shard)
+{
+    ConcurrentHashMap* obj = (ConcurrentHashMap*)malloc(sizeof(ConcurrentHashMap));
+    if (unlikely(!obj))
+        return NULL;
+
+    ConcurrentHashMapData* data =
+        (ConcurrentHashMapData*)malloc(sizeof(ConcurrentHashMapData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    /* Round the shard count up to the power of two for mask indexing. */
+    if (num_shard == 0)
+        num_shard = default_num_shard;
+    if (num_shard > max_num_shard)
+        num_shard = max_num_shard;
+    unsigned count = 1;
+    while (count < num_shard)
+        count <<= 1;
+    num_shard = count;
+
+    Shard* arr_shard;
+    if (unlikely(posix_memalign((void**)&arr_shard, size_cache_line,
+                                sizeof(Shard) * num_shard) != 0)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+
+    unsigned i;
+    for (i = 0 ; i < num_shard ; ++i) {
+        Shard* shard = arr_shard + i;
+        shard->map_ = HashMapInit();
+        if (unlikely(!shard->map_)) {
+            _ConcurrentHashMapRelease(arr_shard, i);
+            free(data);
+            free(obj);
+            return NULL;
+        }
+        if (unlikely(pthread_rwlock_init(&(shard->lock_), NULL) != 0)) {
+            HashMapDeinit(shard->map_);
+            _ConcurrentHashMapRelease(arr_shard, i);
+            free(data);
+            free(obj);
+            return NULL;
+        }
+    }
+
+    data->num_shard_ = num_shard;
+    data->arr_shard_ = arr_shard;
+    data->func_hash_ = _ConcurrentHashMapHash;
+
+    obj->data = data;
+    obj->put = ConcurrentHashMapPut;
+    obj->get = ConcurrentHashMapGet;
+    obj->contain = ConcurrentHashMapContain;
+    obj->remove = ConcurrentHashMapRemove;
+    obj->size = ConcurrentHashMapSize;
+    obj->for_each = ConcurrentHashMapForEach;
+    obj->set_hash = ConcurrentHashMapSetHash;
+    obj->set_compare = ConcurrentHashMapSetCompare;
+    obj->set_clean_key = ConcurrentHashMapSetCleanKey;
+    obj->set_clean_value = ConcurrentHashMapSetCleanValue;
+
+    return obj;
+}
+
+void ConcurrentHashMapDeinit(ConcurrentHashMap* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    ConcurrentHashMapData* data = obj->data;
+    _ConcurrentHashMapRelease(data->arr_shard_, data->num_shard_);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool ConcurrentHashMapPut(ConcurrentHashMap* self, void* key, void* value)
+{
+    Shard* shard = GET_SHARD(self->data, key);
+
+    pthread_rwlock_wrlock(&(shard->lock_));
+    bool status = HashMapPut(shard->map_, key, value);
+    pthread_rwlock_unlock(&(shard->lock_));
+    return status;
+}
+
+void* ConcurrentHashMapGet(ConcurrentHashMap* self, void* key)
+{
+    Shard* shard = GET_SHARD(self->data, key);
+
+    pthread_rwlock_rdlock(&(shard->lock_));
+    void* value = HashMapGet(shard->map_, key);
+    pthread_rwlock_unlock(&(shard->lock_));
+    return value;
+}
+
+bool ConcurrentHashMapContain(ConcurrentHashMap* self, void* key)
+{
+    Shard* shard = GET_SHARD(self->data, key);
+
+    pthread_rwlock_rdlock(&(shard->lock_));
+    bool found = HashMapContain(shard->map_, key);
+    pthread_rwlock_unlock(&(shard->lock_));
+    return found;
+}
+
+bool ConcurrentHashMapRemove(ConcurrentHashMap* self, void* key)
+{
+    Shard* shard = GET_SHARD(self->data, key);
+
+    pthread_rwlock_wrlock(&(shard->lock_));
+    bool status = HashMapRemove(shard->map_, key);
+    pthread_rwlock_unlock(&(shard->lock_));
+    return status;
+}
+
+unsigned ConcurrentHashMapSize(ConcurrentHashMap* self)
+{
+    ConcurrentHashMapData* data = self->data;
+
+    unsigned size = 0;
+    unsigned i;
+    for (i = 0 ; i < data->num_shard_ ; ++i) {
+        Shard* shard = data->arr_shard_ + i;
+        pthread_rwlock_rdlock(&(shard->lock_));
+        size += HashMapSize(shard->map_);
+        pthread_rwlock_unlock(&(shard->lock_));
+    }
+    return size;
+}
+
+void ConcurrentHashMapForEach(ConcurrentHashMap* self,
+                              ConcurrentHashMapVisit func, void* arg)
+{
+    ConcurrentHashMapData* data = self->data;
+
+    /* The external iterator does not touch the shard, so the shard can be
+       shared with other readers during iteration. */
+    unsigned i;
+    for (i = 0 ; i < data->num_shard_ ; ++i) {
+        Shard* shard = data->arr_shard_ + i;
+        pthread_rwlock_rdlock(&(shard->lock_));
+        HashMapIter iter;
+        HashMapIterInit(shard->map_, &iter);
+        Pair* ptr_pair;
+        while ((ptr_pair = HashMapIterNext(&iter)) != NULL)
+            func(ptr_pair, arg);
+        pthread_rwlock_unlock(&(shard->lock_));
+    }
+    return;
+}
+
+void ConcurrentHashMapSetHash(ConcurrentHashMap* self, ConcurrentHashMapHash func)
+{
+    ConcurrentHashMapData* data = self->data;
+    data->func_hash_ = func;
+
+    unsigned i;
+    for (i = 0 ; i < data->num_shard_ ; ++i)
+        HashMapSetHash(data->arr_shard_[i].map_, func);
+}
+
+void ConcurrentHashMapSetCompare(ConcurrentHashMap* self,
+                                 ConcurrentHashMapCompare func)
+{
+    ConcurrentHashMapData* data = self->data;
+
+    unsigned i;
+    for (i = 0 ; i < data->num_shard_ ; ++i)
+        HashMapSetCompare(data->arr_shard_[i].map_, func);
+}
+
+void ConcurrentHashMapSetCleanKey(ConcurrentHashMap* self,
+                                  ConcurrentHashMapCleanKey func)
+{
+    ConcurrentHashMapData* data = self->data;
+
+    unsigned i;
+    for (i = 0 ; i < data->num_shard_ ; ++i)
+        HashMapSetCleanKey(data->arr_shard_[i].map_, func);
+}
+
+void ConcurrentHashMapSetCleanValue(ConcurrentHashMap* self,
+                                    ConcurrentHashMapCleanValue func)
+{
+    ConcurrentHashMapData* data = self->data;
+
+    unsigned i;
+    for (i = 0 ; i < data->num_shard_ ; ++i)
+        HashMapSetCleanValue(data->arr_shard_[i].map_, func);
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+unsigned _ConcurrentHashMapHash(void* key)
+{
+    return (unsigned)(intptr_t)key;
+}
+
+void _ConcurrentHashMapRelease(Shard* arr_shard, unsigned num_shard)
+{
+    unsigned i;
+    for (i = 0 ; i < num_shard ; ++i) {
+        pthread_rwlock_destroy(&(arr_shard[i].lock_));
+        HashMapDeinit(arr_shard[i].map_);
+    }
+    free(arr_shard);
+    return;
+}
@@ -0,0 +1,694 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/count_min_sketch.h"
+#include "container/priority_queue.h"
+#include "math/hash.h"
+#include <math.h>
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const double default_epsilon = 0.001;
+static const double default_delta = 0.01;
+static const uint64_t max_width = 1ULL << 26;
+static const unsigned max_depth = 16;
+static const size_t size_cache_line = 64;
+
+#define INDEX_EMPTY     (UINT_MAX)
+#define SIZE_HEADER     (16)
+#define SIZE_FIELD      (1024)
+
+/* The tracked heavy hitter which is ordered in the min-heap by its estimate,
+   and located by its hash value via the open addressing index. */
+typedef struct _TopEntry {
+    void* key_;
+    uint64_t hash_;
+    uint64_t count_;
+    PriorityQueueHandle handle_;
+} TopEntry;
+
+struct _CountMinSketchData {
+    uint32_t* arr_counter_;
+    uint64_t mask_width_;
+    unsigned depth_;
+    uint64_t total_;
+    unsigned top_k_;
+    unsigned num_entry_;
+    TopEntry* arr_entry_;
+    unsigned* arr_index_;
+    unsigned mask_index_;
+    PriorityQueue* queue_;
+    CountMinSketchHash func_hash_;
+    CountMinSketchClean func_clean_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Derive the odd step for the row positions via double hashing, whose low
+ * bits come from the high bits of the scrambled hash value.
+ */
+static inline uint64_t STEP(uint64_t mix)
+{
+    return ((mix >> 32) | (mix << 32)) | 1;
+}
+
+/**
+ * Return the hash value of the key via the designated hash function.
+ */
+static inline uint64_t HASH(CountMinSketchData* data, void* key)
+{
+    if (data->func_hash_)
+        return data->func_hash_(key);
+    return (uint64_t)(uintptr_t)key;
+}
+
+/**
+ * Add the count to the counter and saturate at UINT32_MAX.
+ */
+static inline uint32_t SATURATE(uint32_t counter, uint64_t count)
+{
+    uint64_t sum = (count > UINT32_MAX)? UINT32_MAX : counter + count;
+    return (sum > UINT32_MAX)? UINT32_MAX : (uint32_t)sum;
+}
+
+static inline void STORE_U32(unsigned char* buf, uint32_t num)
+{
+    buf[0] = num;
+    buf[1] = num >> 8;
+    buf[2] = num >> 16;
+    buf[3] = num >> 24;
+}
+
+static inline uint32_t LOAD_U32(const unsigned char* buf)
+{
+    return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+           ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+/**
+ * @brief The heap order which lets the least frequent entry reside at the top.
+ *
+ * @param lhs           The source entry
+ * @param rhs           The target entry
+ *
+ * @retval  1           The source entry should go after the target one.
+ * @retval  0           The source entry is equal to the target one.
+ * @retval -1           The source entry should go before the target one.
+ */
+int _CountMinSketchCompare(const void* lhs, const void* rhs);
+
+/**
+ * @brief The sort order which lets the more frequent entry go first.
+ *
+ * @param lhs           The pointer to the source entry pointer
+ * @param rhs           The pointer to the target entry pointer
+ *
+ * @retval  1           The source entry should go after the target one.
+ * @retval  0           The source entry is equal to the target one.
+ * @retval -1           The source entry should go before the target one.
+ */
+int _CountMinSketchOrder(const void* lhs, const void* rhs);
+
+/**
+ * @brief Add the count to the counters of the hash value in all the rows.
+ *
+ * @param data          The pointer to the sketch private data
+ * @param hash          The hash value of the key
+ * @param count         The number of occurrences
+ *
+ * @retval estimate     The minimum of the updated counters
+ */
+uint64_t _CountMinSketchUpdate(CountMinSketchData* data, uint64_t hash,
+                               uint64_t count);
+
+/**
+ * @brief Return the minimum of the counters of the hash value.
+ *
+ * @param data          The pointer to the sketch private data
+ * @param hash          The hash value of the key
+ *
+ * @retval estimate     The estimated number of occurrences
+ */
+uint64_t _CountMinSketchQuery(CountMinSketchData* data, uint64_t hash);
+
+/**
+ * @brief Locate the index slot of the tracked entry with the hash value.
+ *
+ * @param data          The pointer to the sketch private data
+ * @param hash          The hash value of the key
+ *
+ * @retval slot         The pointer to the slot storing the entry offset, or
+ *                      to the empty slot for insertion
+ */
+unsigned* _CountMinSketchLocate(CountMinSketchData* data, uint64_t hash);
+
+/**
+ * @brief Remove the tracked entry with the hash value from the index.
+ *
+ * The following entries of the probe sequence are shifted backward, so no
+ * tombstone is left.
+ *
+ * @param data          The pointer to the sketch private data
+ * @param hash          The hash value of the tracked key
+ */
+void _CountMinSketchUnindex(CountMinSketchData* data, uint64_t hash);
+
+/**
+ * @brief Offer a key with its estimate to the heavy hitter heap.
+ *
+ * @param data          The pointer to the sketch private data
+ * @param key           The specified key
+ * @param hash          The hash value of the key
+ * @param estimate      The estimated number of occurrences
+ *
+ * @retval true         The key is retained by the heap
+ * @retval false        The key is not retained
+ */
+bool _CountMinSketchOffer(CountMinSketchData* data, void* key, uint64_t hash,
+                          uint64_t estimate);
+
+/**
+ * @brief Refresh the estimates of all the tracked entries from the counters.
+ *
+ * @param data          The pointer to the sketch private data
+ */
+void _CountMinSketchRefresh(CountMinSketchData* data);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+CountMinSketch* CountMinSketchInit(double epsilon, double delta, unsigned top_k)
+{
+    if (!(epsilon > 0 && epsilon < 1))
+        epsilon = default_epsilon;
+    if (!(delta > 0 && delta < 1))
+        delta = default_delta;
+
+    /* Round the width up to the power of two so that the row position is
+       derived by masking. */
+    double need = exp(1.0) / epsilon;
+    uint64_t width = 1;
+    while ((double)width < need && width < max_width)
+        width <<= 1;
+
+    unsigned depth = (unsigned)ceil(log(1 / delta));
+    if (depth < 1)
+        depth = 1;
+    if (depth > max_depth)
+        depth = max_depth;
+
+    CountMinSketch* obj = (CountMinSketch*)malloc(sizeof(CountMinSketch));
+    if (unlikely(!obj))
+        return NULL;
+
+    CountMinSketchData* data =
+        (CountMinSketchData*)malloc(sizeof(CountMinSketchData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    size_t size_arr = (size_t)width * depth * sizeof(uint32_t);
+    uint32_t* arr_counter;
+    if (unlikely(posix_memalign((void**)&arr_counter, size_cache_line,
+                                size_arr) != 0)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+    memset(arr_counter, 0, size_arr);
+
+    data->arr_counter_ = arr_counter;
+    data->mask_width_ = width - 1;
+    data->depth_ = depth;
+    data->total_ = 0;
+    data->top_k_ = top_k;
+    data->num_entry_ = 0;
+    data->arr_entry_ = NULL;
+    data->arr_index_ = NULL;
+    data->mask_index_ = 0;
+    data->queue_ = NULL;
+    data->func_hash_ = NULL;
+    data->func_clean_ = NULL;
+
+    /* Keep the index at most half full for the short probe sequences. */
+    if (top_k > 0) {
+        unsigned num_index = 2;
+        while (num_index < top_k * 2 && num_index < (1u << 31))
+            num_index <<= 1;
+
+        data->arr_entry_ = (TopEntry*)malloc(sizeof(TopEntry) * top_k);
+        data->arr_index_ = (unsigned*)malloc(sizeof(unsigned) * num_index);
+        data->mask_index_ = num_index - 1;
+        data->queue_ = PriorityQueueInit();
+        if (unlikely(!data->arr_entry_ || !data->arr_index_ || !data->queue_)) {
+            PriorityQueueDeinit(data->queue_);
+            free(data->arr_index_);
+            free(data->arr_entry_);
+            free(arr_counter);
+            free(data);
+            free(obj);
+            return NULL;
+        }
+        memset(data->arr_index_, 0xff, sizeof(unsigned) * num_index);
+        PriorityQueueSetCompare(data->queue_, _CountMinSketchCompare);
+    }
+
+    obj->data = data;
+    obj->add = CountMinSketchAdd;
+    obj->estimate = CountMinSketchEstimate;
+    obj->top_k = CountMinSketchTopK;
+    obj->total = CountMinSketchTotal;
+    obj->merge = CountMinSketchMerge;
+    obj->clear = CountMinSketchClear;
+    obj->set_hash = CountMinSketchSetHash;
+    obj->set_clean = CountMinSketchSetClean;
+
+    return obj;
+}
+
+void CountMinSketchDeinit(CountMinSketch* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    CountMinSketchData* data = obj->data;
+    if (data->func_clean_) {
+        unsigned i;
+        for (i = 0 ; i < data->num_entry_ ; ++i)
+            data->func_clean_(data->arr_entry_[i].key_);
+    }
+
+    PriorityQueueDeinit(data->queue_);
+    free(data->arr_index_);
+    free(data->arr_entry_);
+    free(data->arr_counter_);
+    free(data);
+    free(obj);
+    return;
+}
+
+uint64_t CountMinSketchAdd(CountMinSketch* self, void* key, uint64_t count)
+{
+    CountMinSketchData* data = self->data;
+    uint64_t hash = HASH(data, key);
+    uint64_t estimate = _CountMinSketchUpdate(data, hash, count);
+    data->total_ += count;
+
+    bool retain = data->top_k_ > 0 &&
+                  _CountMinSketchOffer(data, key, hash, estimate);
+    if (!retain && data->func_clean_)
+        data->func_clean_(key);
+    return estimate;
+}
+
+uint64_t CountMinSketchEstimate(CountMinSketch* self, void* key)
+{
+    CountMinSketchData* data = self->data;
+    return _CountMinSketchQuery(data, HASH(data, key));
+}
+
+unsigned CountMinSketchTopK(CountMinSketch* self, void** keys,
+                            uint64_t* counts)
+{
+    CountMinSketchData* data = self->data;
+    unsigned num = data->num_entry_;
+    if (num == 0)
+        return 0;
+
+    TopEntry** order = (TopEntry**)malloc(sizeof(TopEntry*) * num);
+    if (unlikely(!order))
+        return 0;
+
+    _CountMinSketchRefresh(data);
+
+    unsigned i;
+    for (i = 0 ; i < num ; ++i)
+        order[i] = data->arr_entry_ + i;
+    qsort(order, num, sizeof(TopEntry*), _CountMinSketchOrder);
+
+    for (i = 0 ; i < num ; ++i) {
+        keys[i] = order[i]->key_;
+        if (counts)
+            counts[i] = order[i]->count_;
+    }
+
+    free(order);
+    return num;
+}
+
+uint64_t CountMinSketchTotal(CountMinSketch* self)
+{
+    return self->data->total_;
+}
+
+bool CountMinSketchMerge(CountMinSketch* self, CountMinSketch* other)
+{
+    CountMinSketchData* dst = self->data;
+    CountMinSketchData* src = other->data;
+    if (dst->mask_width_ != src->mask_width_ || dst->depth_ != src->depth_)
+        return false;
+
+    size_t num = (size_t)(dst->mask_width_ + 1) * dst->depth_;
+    uint32_t* arr_dst = dst->arr_counter_;
+    const uint32_t* arr_src = src->arr_counter_;
+    size_t i;
+    for (i = 0 ; i < num ; ++i)
+        arr_dst[i] = SATURATE(arr_dst[i], arr_src[i]);
+    dst->total_ += src->total_;
+
+    /* The tracked entries of both sketches compete with the merged estimates. */
+    if (dst->top_k_ > 0) {
+        _CountMinSketchRefresh(dst);
+        unsigned j;
+        for (j = 0 ; j < src->num_entry_ ; ++j) {
+            TopEntry* entry = src->arr_entry_ + j;
+            uint64_t estimate = _CountMinSketchQuery(dst, entry->hash_);
+            _CountMinSketchOffer(dst, entry->key_, entry->hash_, estimate);
+        }
+    }
+    return true;
+}
+
+void CountMinSketchClear(CountMinSketch* self)
+{
+    CountMinSketchData* data = self->data;
+    size_t size_arr = (size_t)(data->mask_width_ + 1) * data->depth_ *
+                      sizeof(uint32_t);
+    memset(data->arr_counter_, 0, size_arr);
+    data->total_ = 0;
+
+    unsigned i;
+    for (i = 0 ; i < data->num_entry_ ; ++i) {
+        TopEntry* entry = data->arr_entry_ + i;
+        PriorityQueueRemove(data->queue_, entry->handle_);
+        if (data->func_clean_)
+            data->func_clean_(entry->key_);
+    }
+    data->num_entry_ = 0;
+    if (data->arr_index_)
+        memset(data->arr_index_, 0xff,
+               sizeof(unsigned) * (data->mask_index_ + 1));
+    return;
+}
+
+void CountMinSketchSetHash(CountMinSketch* self, CountMinSketchHash func)
+{
+    self->data->func_hash_ = func;
+}
+
+void CountMinSketchSetClean(CountMinSketch* self, CountMinSketchClean func)
+{
+    self->data->func_clean_ = func;
+}
+
+bool CountMinSketchSnapshot(CountMinSketch* self, const SnapshotWriter* writer,
+                            const SnapshotCodec* codec)
+{
+    CountMinSketchData* data = self->data;
+
+    SnapshotEncoder enc;
+    if (unlikely(!CdsSnapshotBegin(&enc, writer, CDS_SNAPSHOT_COUNT_MIN_SKETCH,
+                                   data->num_entry_)))
+        return CdsSnapshotEnd(&enc, false);
+
+    /* The dimensions and the total count lead the counters, which are packed
+       in little endian fields of up to SIZE_FIELD counters. */
+    unsigned char buf[SIZE_FIELD * sizeof(uint32_t)];
+    uint64_t width = data->mask_width_ + 1;
+    STORE_U32(buf, (uint32_t)width);
+    STORE_U32(buf + 4, data->depth_);
+    STORE_U32(buf + 8, (uint32_t)data->total_);
+    STORE_U32(buf + 12, (uint32_t)(data->total_ >> 32));
+    if (unlikely(!CdsSnapshotAppend(&enc, buf, SIZE_HEADER)))
+        return CdsSnapshotEnd(&enc, false);
+
+    size_t num = (size_t)width * data->depth_;
+    size_t base;
+    for (base = 0 ; base < num ; base += SIZE_FIELD) {
+        size_t size = (num - base < SIZE_FIELD)? num - base : SIZE_FIELD;
+        size_t i;
+        for (i = 0 ; i < size ; ++i)
+            STORE_U32(buf + i * sizeof(uint32_t), data->arr_counter_[base + i]);
+        if (unlikely(!CdsSnapshotAppend(&enc, buf, size * sizeof(uint32_t))))
+            return CdsSnapshotEnd(&enc, false);
+    }
+
+    unsigned i;
+    for (i = 0 ; i < data->num_entry_ ; ++i) {
+        if (unlikely(!CdsSnapshotEncode(&enc, codec, data->arr_entry_[i].key_)))
+            return CdsSnapshotEnd(&enc, false);
+    }
+    return CdsSnapshotEnd(&enc, true);
+}
+
+bool CountMinSketchRestore(CountMinSketch* self, const SnapshotReader* reader,
+                           const SnapshotCodec* codec)
+{
+    CountMinSketchData* data = self->data;
+
+    SnapshotDecoder dec;
+    unsigned count;
+    if (unlikely(!CdsRestoreBegin(&dec, reader, CDS_SNAPSHOT_COUNT_MIN_SKETCH,
+                                  &count)))
+        return CdsRestoreEnd(&dec, false);
+
+    const unsigned char* bytes;
+    size_t size;
+    if (unlikely(!CdsRestoreField(&dec, (const void**)&bytes, &size) ||
+                 size != SIZE_HEADER))
+        return CdsRestoreEnd(&dec, false);
+
+    uint64_t width = data->mask_width_ + 1;
+    if (LOAD_U32(bytes) != width || LOAD_U32(bytes + 4) != data->depth_)
+        return CdsRestoreEnd(&dec, false);
+    uint64_t total = LOAD_U32(bytes + 8) |
+                     ((uint64_t)LOAD_U32(bytes + 12) << 32);
+
+    size_t num = (size_t)width * data->depth_;
+    size_t base = 0;
+    while (base < num) {
+        if (unlikely(!CdsRestoreField(&dec, (const void**)&bytes, &size)))
+            return CdsRestoreEnd(&dec, false);
+        size_t num_field = size / sizeof(uint32_t);
+        if (unlikely(size % sizeof(uint32_t) != 0 || num_field == 0 ||
+                     num_field > num - base))
+            return CdsRestoreEnd(&dec, false);
+
+        size_t i;
+        for (i = 0 ; i < num_field ; ++i) {
+            uint32_t* counter = data->arr_counter_ + base + i;
+            *counter = SATURATE(*counter, LOAD_U32(bytes + i * sizeof(uint32_t)));
+        }
+        base += num_field;
+    }
+    data->total_ += total;
+
+    if (data->top_k_ > 0)
+        _CountMinSketchRefresh(data);
+
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        void* key;
+        if (unlikely(!CdsRestoreDecode(&dec, codec, &key)))
+            return CdsRestoreEnd(&dec, false);
+
+        uint64_t hash = HASH(data, key);
+        bool retain = data->top_k_ > 0 &&
+            _CountMinSketchOffer(data, key, hash,
+                                 _CountMinSketchQuery(data, hash));
+        if (!retain && data->func_clean_)
+            data->func_clean_(key);
+    }
+    return CdsRestoreEnd(&dec, true);
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+int _CountMinSketchCompare(const void* lhs, const void* rhs)
+{
+    uint64_t count_lhs = ((const TopEntry*)lhs)->count_;
+    uint64_t count_rhs = ((const TopEntry*)rhs)->count_;
+    return (count_lhs > count_rhs) - (count_lhs < count_rhs);
+}
+
+int _CountMinSketchOrder(const void* lhs, const void* rhs)
+{
+    return _CountMinSketchCompare(*(TopEntry* const*)rhs,
+                                  *(TopEntry* const*)lhs);
+}
+
+uint64_t _CountMinSketchUpdate(CountMinSketchData* data, uint64_t hash,
+                               uint64_t count)
+{
+    uint64_t mix = HashMix64(hash);
+    uint64_t step = STEP(mix);
+    uint64_t width = data->mask_width_ + 1;
+
+    uint32_t min = UINT32_MAX;
+    uint32_t* row = data->arr_counter_;
+    unsigned i;
+    for (i = 0 ; i < data->depth_ ; ++i) {
+        uint32_t* counter = row + (mix & data->mask_width_);
+        *counter = SATURATE(*counter, count);
+        if (*counter < min)
+            min = *counter;
+        mix += step;
+        row += width;
+    }
+    return min;
+}
+
+uint64_t _CountMinSketchQuery(CountMinSketchData* data, uint64_t hash)
+{
+    uint64_t mix = HashMix64(hash);
+    uint64_t step = STEP(mix);
+    uint64_t width = data->mask_width_ + 1;
+
+    uint32_t min = UINT32_MAX;
+    const uint32_t* row = data->arr_counter_;
+    unsigned i;
+    for (i = 0 ; i < data->depth_ ; ++i) {
+        uint32_t counter = row[mix & data->mask_width_];
+        if (counter < min)
+            min = counter;
+        mix += step;
+        row += width;
+    }
+    return min;
+}
+
+unsigned* _CountMinSketchLocate(CountMinSketchData* data, uint64_t hash)
+{
+    unsigned mask = data->mask_index_;
+    unsigned slot = (unsigned)(HashMix64(hash) >> 32) & mask;
+    while (true) {
+        unsigned* p_slot = data->arr_index_ + slot;
+        if (*p_slot == INDEX_EMPTY || data->arr_entry_[*p_slot].hash_ == hash)
+            return p_slot;
+        slot = (slot + 1) & mask;
+    }
+}
+
+void _CountMinSketchUnindex(CountMinSketchData* data, uint64_t hash)
+{
+    unsigned mask = data->mask_index_;
+    unsigned* arr_index = data->arr_index_;
+    unsigned hole = (unsigned)(_CountMinSketchLocate(data, hash) - arr_index);
+
+    /* Move back the entry whose home slot does not lie cyclically in
+       (hole, curr], so that its probe sequence stays unbroken. */
+    unsigned curr = hole;
+    while (true) {
+        curr = (curr + 1) & mask;
+        if (arr_index[curr] == INDEX_EMPTY)
+            break;
+        uint64_t hash_curr = data->arr_entry_[arr_index[curr]].hash_;
+        unsigned home = (unsigned)(HashMix64(hash_curr) >> 32) & mask;
+        if (((curr - home) & mask) >= ((curr - hole) & mask)) {
+            arr_index[hole] = arr_index[curr];
+            hole = curr;
+        }
+    }
+    arr_index[hole] = INDEX_EMPTY;
+}
+
+bool _CountMinSketchOffer(CountMinSketchData* data, void* key, uint64_t hash,
+                          uint64_t estimate)
+{
+    PriorityQueue* queue = data->queue_;
+
+    unsigned* p_slot = _CountMinSketchLocate(data, hash);
+    if (*p_slot != INDEX_EMPTY) {
+        TopEntry* entry = data->arr_entry_ + *p_slot;
+        if (estimate > entry->count_) {
+            entry->count_ = estimate;
+            PriorityQueueUpdate(queue, entry->handle_, entry);
+        }
+        return entry->key_ == key;
+    }
+
+    if (data->num_entry_ < data->top_k_) {
+        unsigned idx = data->num_entry_;
+        TopEntry* entry = data->arr_entry_ + idx;
+        entry->key_ = key;
+        entry->hash_ = hash;
+        entry->count_ = estimate;
+        entry->handle_ = PriorityQueuePushHandle(queue, entry);
+        if (unlikely(!entry->handle_))
+            return false;
+        *p_slot = idx;
+        ++(data->num_entry_);
+        return true;
+    }
+
+    /* The stored estimate of the least frequent entry may be stale, so it is
+       refreshed once before the comparison. */
+    void* element;
+    PriorityQueueTop(queue, &element);
+    TopEntry* entry = (TopEntry*)element;
+    uint64_t fresh = _CountMinSketchQuery(data, entry->hash_);
+    if (fresh > entry->count_) {
+        entry->count_ = fresh;
+        PriorityQueueUpdate(queue, entry->handle_, entry);
+        PriorityQueueTop(queue, &element);
+        entry = (TopEntry*)element;
+    }
+    if (estimate <= entry->count_)
+        return false;
+
+    _CountMinSketchUnindex(data, entry->hash_);
+    if (data->func_clean_)
+        data->func_clean_(entry->key_);
+
+    entry->key_ = key;
+    entry->hash_ = hash;
+    entry->count_ = estimate;
+    PriorityQueueUpdate(queue, entry->handle_, entry);
+    *_CountMinSketchLocate(data, hash) = (unsigned)(entry - data->arr_entry_);
+    return true;
+}
+
+void _CountMinSketchRefresh(CountMinSketchData* data)
+{
+    unsigned i;
+    for (i = 0 ; i < data->num_entry_ ; ++i) {
+        TopEntry* entry = data->arr_entry_ + i;
+        uint64_t fresh = _CountMinSketchQuery(data, entry->hash_);
+        if (fresh > entry->count_) {
+            entry->count_ = fresh;
+            PriorityQueueUpdate(data->queue_, entry->handle_, entry);
+        }
+    }
+}
@@ -0,0 +1,561 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/flat_hash_map.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const unsigned DEFAULT_CAPACITY = 64;
+static const unsigned GROUP_WIDTH = 16;
+
+/* The control tag of a full slot keeps the low 7 bits of the key hash, which
+   is always non-negative. The other two states are marked by negative tags. */
+static const int8_t CTRL_EMPTY = -128;
+static const int8_t CTRL_DELETED = -2;
+
+
+struct _FlatHashMapData {
+    unsigned size_;
+    unsigned num_slot_;
+    unsigned num_deleted_;
+    unsigned curr_limit_;
+    unsigned iter_slot_;
+    int8_t* arr_ctrl_;
+    Pair* arr_pair_;
+    FlatHashMapHash func_hash_;
+    FlatHashMapCompare func_cmp_;
+    FlatHashMapCleanKey func_clean_key_;
+    FlatHashMapCleanValue func_clean_val_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Scramble the user supplied hash so that both the slot position (high bits)
+ * and the control tag (low 7 bits) are well distributed.
+ */
+static inline unsigned MIX(unsigned hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+static inline int8_t TAG(unsigned hash)
+{
+    return (int8_t)(hash & 0x7f);
+}
+
+/* Return the bit mask of the control tags in the group equal to the given one. */
+static inline unsigned MATCH(const int8_t* group, int8_t tag)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#else
+    unsigned mask = 0;
+    unsigned i;
+    for (i = 0 ; i < GROUP_WIDTH ; ++i) {
+        if (group[i] == tag)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+/* Return the bit mask of the empty or deleted slots in the group. */
+static inline unsigned MATCH_FREE(const int8_t* group)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl));
+#else
+    unsigned mask = 0;
+    unsigned i;
+    for (i = 0 ; i < GROUP_WIDTH ; ++i) {
+        if (group[i] < -1)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Update the control tag of the designated slot. The tags of the leading group
+ * are mirrored behind the tail so that a group load never wraps around.
+ */
+static inline void SET_CTRL(FlatHashMapData* data, unsigned idx, int8_t tag)
+{
+    data->arr_ctrl_[idx] = tag;
+    if (idx < GROUP_WIDTH)
+        data->arr_ctrl_[data->num_slot_ + idx] = tag;
+}
+
+/**
+ * @brief Allocate the slot array and the control array with the specified
+ * capacity.
+ *
+ * @param data          The pointer to the map private data
+ * @param num_slot      The number of slots which must be the power of two
+ *
+ * @retval true         The arrays are successfully allocated
+ * @retval false        Insufficient memory
+ */
+bool _FlatHashMapAlloc(FlatHashMapData* data, unsigned num_slot);
+
+/**
+ * @brief Search the slot storing the designated key.
+ *
+ * @param data          The pointer to the map private data
+ * @param key           The designated key
+ * @param hash          The scrambled hash of the key
+ *
+ * @retval idx          The index to the target slot
+ * @retval num_slot     The key cannot be found
+ */
+unsigned _FlatHashMapSearch(FlatHashMapData* data, void* key, unsigned hash);
+
+/**
+ * @brief Search the first empty or deleted slot along the probing sequence.
+ *
+ * @param data          The pointer to the map private data
+ * @param hash          The scrambled hash of the key
+ *
+ * @retval idx          The index to the target slot
+ */
+unsigned _FlatHashMapSearchFree(FlatHashMapData* data, unsigned hash);
+
+/**
+ * @brief Re-distribute the stored pairs into the new slot array.
+ *
+ * If most of the occupied slots are deleted ones, the slot array is rebuilt
+ * with the same capacity. Otherwise, it is extended to the double capacity.
+ *
+ * @param data          The pointer to the map private data
+ *
+ * @retval true         The pairs are successfully re-distributed
+ * @retval false        Insufficient memory
+ */
+bool _FlatHashMapReHash(FlatHashMapData* data);
+
+/**
+ * @brief The default hash function.
+ *
+ * @param key           The designated key
+ *
+ * @retval Hash         The corresponding hash value
+ */
+unsigned _FlatHashMapHash(void* key);
+
+/**
+ * @brief The default hash key comparison function.
+ *
+ * @param lhs           The source key
+ * @param rhs           The target key
+ *
+ * @retval  1           The source key should go after the target one.
+ * @retval  0           The source key is equal to the target one.
+ * @retval -1           The source key should go before the target one.
+ */
+int _FlatHashMapCompare(void* lhs, void* rhs);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+FlatHashMap* FlatHashMapInit()
+{
+    FlatHashMap* obj = (FlatHashMap*)malloc(sizeof(FlatHashMap));
+    if (unlikely(!obj))
+        return NULL;
+
+    FlatHashMapData* data = (FlatHashMapData*)malloc(sizeof(FlatHashMapData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    if (unlikely(!_FlatHashMapAlloc(data, DEFAULT_CAPACITY))) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+
+    data->size_ = 0;
+    data->num_deleted_ = 0;
+    data->iter_slot_ = 0;
+    data->func_hash_ = _FlatHashMapHash;
+    data->func_cmp_ = _FlatHashMapCompare;
+    data->func_clean_key_ = NULL;
+    data->func_clean_val_ = NULL;
+
+    obj->data = data;
+    obj->put = FlatHashMapPut;
+    obj->get = FlatHashMapGet;
+    obj->contain = FlatHashMapContain;
+    obj->remove = FlatHashMapRemove;
+    obj->size = FlatHashMapSize;
+    obj->first = FlatHashMapFirst;
+    obj->next = FlatHashMapNext;
+    obj->set_hash = FlatHashMapSetHash;
+    obj->set_compare = FlatHashMapSetCompare;
+    obj->set_clean_key = FlatHashMapSetCleanKey;
+    obj->set_clean_value = FlatHashMapSetCleanValue;
+
+    return obj;
+}
+
+void FlatHashMapDeinit(FlatHashMap* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    FlatHashMapData* data = obj->data;
+    FlatHashMapCleanKey func_clean_key = data->func_clean_key_;
+    FlatHashMapCleanValue func_clean_val = data->func_clean_val_;
+
+    if (func_clean_key || func_clean_val) {
+        int8_t* arr_ctrl = data->arr_ctrl_;
+        Pair* arr_pair = data->arr_pair_;
+        unsigned num_slot = data->num_slot_;
+        unsigned i;
+        for (i = 0 ; i < num_slot ; ++i) {
+            if (arr_ctrl[i] < 0)
+                continue;
+            if (func_clean_key)
+                func_clean_key(arr_pair[i].key);
+            if (func_clean_val)
+                func_clean_val(arr_pair[i].value);
+        }
+    }
+
+    free(data->arr_ctrl_);
+    free(data->arr_pair_);
+    free(data);
+    free(obj);
+    return;
+}
+
+bool FlatHashMapPut(FlatHashMap* self, void* key, void* value)
+{
+    FlatHashMapData* data = self->data;
+    unsigned hash = MIX(data->func_hash_(key));
+
+    /* Check if the pair conflicts with a certain one stored in the map. If yes,
+       replace that one. */
+    unsigned idx = _FlatHashMapSearch(data, key, hash);
+    if (idx != data->num_slot_) {
+        Pair* pair = data->arr_pair_ + idx;
+        if (data->func_clean_key_)
+            data->func_clean_key_(pair->key);
+        if (data->func_clean_val_)
+            data->func_clean_val_(pair->value);
+        pair->key = key;
+        pair->value = value;
+        return true;
+    }
+
+    /* Consuming an empty slot may require rehashing to keep the probing
+       sequences short. A deleted slot can be reused directly. */
+    idx = _FlatHashMapSearchFree(data, hash);
+    if (data->arr_ctrl_[idx] == CTRL_EMPTY &&
+        (data->size_ + data->num_deleted_) >= data->curr_limit_) {
+        if (likely(_FlatHashMapReHash(data)))
+            idx = _FlatHashMapSearchFree(data, hash);
+        else {
+            /* Keep at least one empty slot to terminate the probing. */
+            if ((data->size_ + data->num_deleted_ + 1) >= data->num_slot_)
+                return false;
+        }
+    }
+
+    if (data->arr_ctrl_[idx] == CTRL_DELETED)
+        --(data->num_deleted_);
+    SET_CTRL(data, idx, TAG(hash));
+    data->arr_pair_[idx].key = key;
+    data->arr_pair_[idx].value = value;
+    ++(data->size_);
+
+    return true;
+}
+
+void* FlatHashMapGet(FlatHashMap* self, void* key)
+{
+    FlatHashMapData* data = self->data;
+    unsigned hash = MIX(data->func_hash_(key));
+    unsigned idx = _FlatHashMapSearch(data, key, hash);
+    return (idx != data->num_slot_)? data->arr_pair_[idx].value : NULL;
+}
+
+bool FlatHashMapContain(FlatHashMap* self, void* key)
+{
+    FlatHashMapData* data = self->data;
+    unsigned hash = MIX(data->func_hash_(key));
+    unsigned idx = _FlatHashMapSearch(data, key, hash);
+    return (idx != data->num_slot_)? true : false;
+}
+
+bool FlatHashMapRemove(FlatHashMap* self, void* key)
+{
+    FlatHashMapData* data = self->data;
+    unsigned hash = MIX(data->func_hash_(key));
+    unsigned idx = _FlatHashMapSearch(data, key, hash);
+    unsigned num_slot = data->num_slot_;
+    if (idx == num_slot)
+        return false;
+
+    Pair* pair = data->arr_pair_ + idx;
+    if (data->func_clean_key_)
+        data->func_clean_key_(pair->key);
+    if (data->func_clean_val_)
+        data->func_clean_val_(pair->value);
+
+    /* If no probing group covering this slot was ever completely occupied, no
+       probing sequence can pass through it. Thus it can be marked as empty
+       rather than leaving a tombstone. */
+    unsigned mask = num_slot - 1;
+    unsigned idx_before = (idx - GROUP_WIDTH) & mask;
+    unsigned empty_after = MATCH(data->arr_ctrl_ + idx, CTRL_EMPTY);
+    unsigned empty_before = MATCH(data->arr_ctrl_ + idx_before, CTRL_EMPTY);
+    if (empty_after && empty_before &&
+        ((unsigned)__builtin_ctz(empty_after) +
+         (unsigned)(__builtin_clz(empty_before) - (32 - GROUP_WIDTH))) < GROUP_WIDTH)
+        SET_CTRL(data, idx, CTRL_EMPTY);
+    else {
+        SET_CTRL(data, idx, CTRL_DELETED);
+        ++(data->num_deleted_);
+    }
+
+    --(data->size_);
+    return true;
+}
+
+unsigned FlatHashMapSize(FlatHashMap* self)
+{
+    return self->data->size_;
+}
+
+void FlatHashMapFirst(FlatHashMap* self)
+{
+    self->data->iter_slot_ = 0;
+}
+
+Pair* FlatHashMapNext(FlatHashMap* self)
+{
+    FlatHashMapData* data = self->data;
+    int8_t* arr_ctrl = data->arr_ctrl_;
+    unsigned num_slot = data->num_slot_;
+    unsigned iter = data->iter_slot_;
+
+    while (iter < num_slot) {
+        if (arr_ctrl[iter] >= 0) {
+            data->iter_slot_ = iter + 1;
+            return data->arr_pair_ + iter;
+        }
+        ++iter;
+    }
+
+    data->iter_slot_ = num_slot;
+    return NULL;
+}
+
+void FlatHashMapIterInit(FlatHashMap* self, FlatHashMapIter* iter)
+{
+    iter->data_ = self->data;
+    iter->slot_ = 0;
+}
+
+Pair* FlatHashMapIterNext(FlatHashMapIter* iter)
+{
+    FlatHashMapData* data = iter->data_;
+    int8_t* arr_ctrl = data->arr_ctrl_;
+    unsigned num_slot = data->num_slot_;
+    unsigned slot = iter->slot_;
+
+    while (slot < num_slot) {
+        if (arr_ctrl[slot] >= 0) {
+            iter->slot_ = slot + 1;
+            return data->arr_pair_ + slot;
+        }
+        ++slot;
+    }
+
+    iter->slot_ = num_slot;
+    return NULL;
+}
+
+void FlatHashMapSetHash(FlatHashMap* self, FlatHashMapHash func)
+{
+    self->data->func_hash_ = func;
+}
+
+void FlatHashMapSetCompare(FlatHashMap* self, FlatHashMapCompare func)
+{
+    self->data->func_cmp_ = func;
+}
+
+void FlatHashMapSetCleanKey(FlatHashMap* self, FlatHashMapCleanKey func)
+{
+    self->data->func_clean_key_ = func;
+}
+
+void FlatHashMapSetCleanValue(FlatHashMap* self, FlatHashMapCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+bool _FlatHashMapAlloc(FlatHashMapData* data, unsigned num_slot)
+{
+    int8_t* arr_ctrl = (int8_t*)malloc(sizeof(int8_t) * (num_slot + GROUP_WIDTH));
+    if (unlikely(!arr_ctrl))
+        return false;
+
+    Pair* arr_pair = (Pair*)malloc(sizeof(Pair) * num_slot);
+    if (unlikely(!arr_pair)) {
+        free(arr_ctrl);
+        return false;
+    }
+
+    memset(arr_ctrl, CTRL_EMPTY, sizeof(int8_t) * (num_slot + GROUP_WIDTH));
+    data->arr_ctrl_ = arr_ctrl;
+    data->arr_pair_ = arr_pair;
+    data->num_slot_ = num_slot;
+    data->curr_limit_ = num_slot - (num_slot >> 3);
+    return true;
+}
+
+unsigned _FlatHashMapSearch(FlatHashMapData* data, void* key, unsigned hash)
+{
+    FlatHashMapCompare func_cmp = data->func_cmp_;
+    int8_t* arr_ctrl = data->arr_ctrl_;
+    Pair* arr_pair = data->arr_pair_;
+    unsigned mask = data->num_slot_ - 1;
+    int8_t tag = TAG(hash);
+
+    /* Probe the groups with triangular strides which finally visit all the
+       group positions of the power of two slot array. */
+    unsigned pos = (hash >> 7) & mask;
+    unsigned stride = 0;
+    while (true) {
+        const int8_t* group = arr_ctrl + pos;
+        unsigned match = MATCH(group, tag);
+        while (match) {
+            unsigned idx = (pos + __builtin_ctz(match)) & mask;
+            if (func_cmp(key, arr_pair[idx].key) == 0)
+                return idx;
+            match &= match - 1;
+        }
+
+        /* An empty slot terminates the probing sequence. */
+        if (likely(MATCH(group, CTRL_EMPTY)))
+            break;
+
+        stride += GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+
+    return data->num_slot_;
+}
+
+unsigned _FlatHashMapSearchFree(FlatHashMapData* data, unsigned hash)
+{
+    int8_t* arr_ctrl = data->arr_ctrl_;
+    unsigned mask = data->num_slot_ - 1;
+
+    unsigned pos = (hash >> 7) & mask;
+    unsigned stride = 0;
+    while (true) {
+        unsigned match = MATCH_FREE(arr_ctrl + pos);
+        if (likely(match))
+            return (pos + __builtin_ctz(match)) & mask;
+
+        stride += GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+}
+
+bool _FlatHashMapReHash(FlatHashMapData* data)
+{
+    int8_t* arr_ctrl = data->arr_ctrl_;
+    Pair* arr_pair = data->arr_pair_;
+    unsigned num_slot = data->num_slot_;
+
+    unsigned num_slot_new = num_slot;
+    if (data->size_ > (data->curr_limit_ >> 1)) {
+        if (unlikely(num_slot > (UINT_MAX >> 1)))
+            return false;
+        num_slot_new = num_slot << 1;
+    }
+
+    /* Try to allocate the new arrays. The rehashing should be canceled due to
+       insufficient memory space. */
+    if (unlikely(!_FlatHashMapAlloc(data, num_slot_new)))
+        return false;
+
+    /* Migrate each key value pair to the new slot array. */
+    FlatHashMapHash func_hash = data->func_hash_;
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        if (arr_ctrl[i] < 0)
+            continue;
+        unsigned hash = MIX(func_hash(arr_pair[i].key));
+        unsigned idx = _FlatHashMapSearchFree(data, hash);
+        SET_CTRL(data, idx, TAG(hash));
+        data->arr_pair_[idx] = arr_pair[i];
+    }
+
+    data->num_deleted_ = 0;
+    free(arr_ctrl);
+    free(arr_pair);
+    return true;
+}
+
+unsigned _FlatHashMapHash(void* key)
+{
+    return (unsigned)(intptr_t)key;
+}
+
+int _FlatHashMapCompare(void* lhs, void* rhs)
+{
+    if ((intptr_t)lhs == (intptr_t)rhs)
+        return 0;
+    return ((intptr_t)lhs > (intptr_t)rhs)? 1 : (-1);
+}
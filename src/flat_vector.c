@@ -0,0 +1,364 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/flat_vector.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+struct _FlatVectorData {
+    unsigned size_;
+    unsigned capacity_;
+    size_t size_element_;
+    char* elements_;
+    FlatVectorClean func_clean_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+static inline char* SLOT(FlatVectorData* data, unsigned idx)
+{
+    return data->elements_ + data->size_element_ * idx;
+}
+
+/**
+ * @brief Resize the internal array so that it can contain the specified number
+ *        of elements.
+ *
+ * If the given element count is smaller than the old element count, the trailing
+ * elements are removed. Also, the cleanup function is triggered.
+ *
+ * @param data          The pointer to the vector private data
+ * @param capacity      The specified element count
+ *
+ * @retval true         The vector is successfully resized
+ * @retval false        The vector cannot be resized due to insufficient memory
+ */
+bool _FlatVectorResize(FlatVectorData* data, unsigned capacity);
+
+/**
+ * @brief Open an uninitialized slot at the specified index and shift the
+ *        trailing elements.
+ *
+ * @param data          The pointer to the vector private data
+ * @param idx           The specified index which should not exceed the size
+ *
+ * @retval slot         The address of the opened slot
+ * @retval NULL         Insufficient memory to extend the internal array
+ */
+char* _FlatVectorOpen(FlatVectorData* data, unsigned idx);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+FlatVector* FlatVectorInit(size_t size_element, unsigned capacity)
+{
+    if (unlikely(size_element == 0))
+        return NULL;
+
+    FlatVector* obj = (FlatVector*)malloc(sizeof(FlatVector));
+    if (unlikely(!obj))
+        return NULL;
+
+    FlatVectorData* data = (FlatVectorData*)malloc(sizeof(FlatVectorData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    char* elements = (char*)malloc(size_element * capacity);
+    if (unlikely(!elements && capacity > 0)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+
+    data->size_ = 0;
+    data->capacity_ = capacity;
+    data->size_element_ = size_element;
+    data->elements_ = elements;
+    data->func_clean_ = NULL;
+
+    obj->data = data;
+    obj->push_back = FlatVectorPushBack;
+    obj->emplace_back = FlatVectorEmplaceBack;
+    obj->insert = FlatVectorInsert;
+    obj->emplace = FlatVectorEmplace;
+    obj->pop_back = FlatVectorPopBack;
+    obj->remove = FlatVectorRemove;
+    obj->set = FlatVectorSet;
+    obj->get = FlatVectorGet;
+    obj->at = FlatVectorAt;
+    obj->array = FlatVectorArray;
+    obj->resize = FlatVectorResize;
+    obj->size = FlatVectorSize;
+    obj->capacity = FlatVectorCapacity;
+    obj->element_size = FlatVectorElementSize;
+    obj->sort = FlatVectorSort;
+    obj->set_clean = FlatVectorSetClean;
+
+    return obj;
+}
+
+void FlatVectorDeinit(FlatVector* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    FlatVectorData* data = obj->data;
+    FlatVectorClean func_clean = data->func_clean_;
+    if (func_clean) {
+        unsigned size = data->size_;
+        unsigned i;
+        for (i = 0 ; i < size ; ++i)
+            func_clean(SLOT(data, i));
+    }
+
+    free(data->elements_);
+    free(data);
+    free(obj);
+    return;
+}
+
+bool FlatVectorPushBack(FlatVector* self, const void* element)
+{
+    FlatVectorData* data = self->data;
+    char* slot = _FlatVectorOpen(data, data->size_);
+    if (unlikely(!slot))
+        return false;
+
+    memcpy(slot, element, data->size_element_);
+    return true;
+}
+
+void* FlatVectorEmplaceBack(FlatVector* self)
+{
+    FlatVectorData* data = self->data;
+    return _FlatVectorOpen(data, data->size_);
+}
+
+bool FlatVectorInsert(FlatVector* self, unsigned idx, const void* element)
+{
+    FlatVectorData* data = self->data;
+    if (unlikely(idx > data->size_))
+        return false;
+
+    char* slot = _FlatVectorOpen(data, idx);
+    if (unlikely(!slot))
+        return false;
+
+    memcpy(slot, element, data->size_element_);
+    return true;
+}
+
+void* FlatVectorEmplace(FlatVector* self, unsigned idx)
+{
+    FlatVectorData* data = self->data;
+    if (unlikely(idx > data->size_))
+        return NULL;
+
+    return _FlatVectorOpen(data, idx);
+}
+
+bool FlatVectorPopBack(FlatVector* self)
+{
+    FlatVectorData* data = self->data;
+    unsigned size = data->size_;
+    if (unlikely(size == 0))
+        return false;
+
+    --size;
+    data->size_ = size;
+    FlatVectorClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(SLOT(data, size));
+
+    return true;
+}
+
+bool FlatVectorRemove(FlatVector* self, unsigned idx)
+{
+    FlatVectorData* data = self->data;
+    unsigned size = data->size_;
+    if (unlikely(idx >= size))
+        return false;
+
+    char* slot = SLOT(data, idx);
+    FlatVectorClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(slot);
+
+    /* Shift the trailing elements if necessary. */
+    unsigned num_shift = size - idx - 1;
+    if (likely(num_shift > 0)) {
+        size_t size_element = data->size_element_;
+        memmove(slot, slot + size_element, size_element * num_shift);
+    }
+
+    data->size_ = size - 1;
+    return true;
+}
+
+bool FlatVectorSet(FlatVector* self, unsigned idx, const void* element)
+{
+    FlatVectorData* data = self->data;
+    if (unlikely(idx >= data->size_))
+        return false;
+
+    char* slot = SLOT(data, idx);
+    FlatVectorClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(slot);
+
+    memcpy(slot, element, data->size_element_);
+    return true;
+}
+
+bool FlatVectorGet(FlatVector* self, unsigned idx, void* p_element)
+{
+    FlatVectorData* data = self->data;
+    if (unlikely(idx >= data->size_))
+        return false;
+
+    memcpy(p_element, SLOT(data, idx), data->size_element_);
+    return true;
+}
+
+void* FlatVectorAt(FlatVector* self, unsigned idx)
+{
+    FlatVectorData* data = self->data;
+    if (unlikely(idx >= data->size_))
+        return NULL;
+
+    return SLOT(data, idx);
+}
+
+void* FlatVectorArray(FlatVector* self)
+{
+    return self->data->elements_;
+}
+
+bool FlatVectorResize(FlatVector* self, unsigned capacity)
+{
+    return _FlatVectorResize(self->data, capacity);
+}
+
+unsigned FlatVectorSize(FlatVector* self)
+{
+    return self->data->size_;
+}
+
+unsigned FlatVectorCapacity(FlatVector* self)
+{
+    return self->data->capacity_;
+}
+
+size_t FlatVectorElementSize(FlatVector* self)
+{
+    return self->data->size_element_;
+}
+
+void FlatVectorSort(FlatVector* self, FlatVectorCompare func)
+{
+    FlatVectorData* data = self->data;
+    if (likely(data->size_ > 1))
+        qsort(data->elements_, data->size_, data->size_element_, func);
+}
+
+void FlatVectorSetClean(FlatVector* self, FlatVectorClean func)
+{
+    self->data->func_clean_ = func;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+bool _FlatVectorResize(FlatVectorData* data, unsigned capacity)
+{
+    unsigned old_size = data->size_;
+
+    /* Remove the trailing elements if the given element number is smaller than
+       the old element count. */
+    if (unlikely(capacity < old_size)) {
+        FlatVectorClean func_clean = data->func_clean_;
+        if (func_clean) {
+            unsigned idx;
+            for (idx = capacity ; idx < old_size ; ++idx)
+                func_clean(SLOT(data, idx));
+        }
+        data->size_ = capacity;
+    }
+
+    if (unlikely(capacity == data->capacity_))
+        return true;
+
+    /* Keep the array allocated, so that an empty vector still owns a valid
+       element address. */
+    size_t size_alloc = data->size_element_ * capacity;
+    if (unlikely(size_alloc == 0))
+        size_alloc = data->size_element_;
+
+    char* new_elements = (char*)realloc(data->elements_, size_alloc);
+    if (unlikely(!new_elements))
+        return false;
+
+    data->elements_ = new_elements;
+    data->capacity_ = capacity;
+    return true;
+}
+
+char* _FlatVectorOpen(FlatVectorData* data, unsigned idx)
+{
+    unsigned size = data->size_;
+    unsigned capacity = data->capacity_;
+
+    /* If the internal array is full, extend it to double capacity. */
+    if (size == capacity) {
+        if (unlikely(capacity == UINT_MAX))
+            return NULL;
+        unsigned new_capacity = (capacity > 0)? (capacity << 1) : 1;
+        if (unlikely(new_capacity < capacity))
+            new_capacity = UINT_MAX;
+        if (unlikely(!_FlatVectorResize(data, new_capacity)))
+            return NULL;
+    }
+
+    /* Shift the trailing elements if necessary. */
+    char* slot = SLOT(data, idx);
+    unsigned num_shift = size - idx;
+    if (num_shift > 0) {
+        size_t size_element = data->size_element_;
+        memmove(slot + size_element, slot, size_element * num_shift);
+    }
+
+    data->size_ = size + 1;
+    return slot;
+}
@@ -1,5 +1,131 @@
 #include "math/hash.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/* The AVX2 accumulation is compiled for the x86 targets and selected at
+   runtime. */
+#if defined(__GNUC__) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define HASH_DISPATCH_AVX2
+#include <immintrin.h>
+#endif
+
+
+/*-------------------------------------------------------*
+ *         Internal operations for the 64 bit hash       *
+ *-------------------------------------------------------*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/* The keys longer than this size are hashed by the stripe accumulation. */
+static const size_t HASH_SIZE_MEDIUM = 256;
+
+/* The stripe accumulation consumes 64 bytes per stripe and scrambles the
+   lanes every 16 stripes. */
+#define HASH_SIZE_STRIPE    (64)
+#define HASH_NUM_LANE       (8)
+#define HASH_NUM_STRIPE     (16)
+
+static const uint64_t HASH_SECRET[HASH_NUM_LANE] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+    0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull,
+    0x1d8e4e27c47d124full, 0xbe4ba423396cfeb8ull,
+    0xcb00c391bb52a824ull, 0x7c01812cf721ad1cull,
+};
+
+static const uint64_t HASH_PRIME32 = 0x9e3779b1ull;
+
+/**
+ * Load the little endian integers from the unaligned bytes.
+ */
+static inline uint64_t READ64(const uint8_t* bytes)
+{
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(uint64_t));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static inline uint64_t READ32(const uint8_t* bytes)
+{
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(uint32_t));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+/**
+ * Multiply the two integers into 128 bits and fold the halves.
+ */
+static inline uint64_t MUM(uint64_t lhs, uint64_t rhs)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t)lhs * rhs;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+    uint64_t lhs_hi = lhs >> 32, lhs_lo = (uint32_t)lhs;
+    uint64_t rhs_hi = rhs >> 32, rhs_lo = (uint32_t)rhs;
+    uint64_t hh = lhs_hi * rhs_hi, hl = lhs_hi * rhs_lo;
+    uint64_t lh = lhs_lo * rhs_hi, ll = lhs_lo * rhs_lo;
+    uint64_t mid = (ll >> 32) + (uint32_t)hl + (uint32_t)lh;
+    uint64_t lo = (mid << 32) | (uint32_t)ll;
+    uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+    return lo ^ hi;
+#endif
+}
+
+/**
+ * @brief Accumulate the stripes of the long key into the lanes.
+ *
+ * Each lane adds the product of the low and the high halves of its keyed
+ * word, and it also adds the raw word of its neighboring lane. The lanes are
+ * scrambled after every HASH_NUM_STRIPE stripes, and the last stripe is
+ * aligned to the key end.
+ *
+ * @param acc           The lanes to accumulate
+ * @param bytes         The key bytes
+ * @param size          The key size which is larger than a stripe
+ * @param keys          The seeded lane keys
+ */
+void _HashLongScalar(uint64_t* acc, const uint8_t* bytes, size_t size,
+                     const uint64_t* keys);
+
+#if defined(__SSE2__)
+void _HashLongSse2(uint64_t* acc, const uint8_t* bytes, size_t size,
+                   const uint64_t* keys);
+#endif
+
+#if defined(HASH_DISPATCH_AVX2)
+__attribute__((target("avx2")))
+void _HashLongAvx2(uint64_t* acc, const uint8_t* bytes, size_t size,
+                   const uint64_t* keys);
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+void _HashLongNeon(uint64_t* acc, const uint8_t* bytes, size_t size,
+                   const uint64_t* keys);
+#endif
+
+/**
+ * @brief Hash the key longer than HASH_SIZE_MEDIUM.
+ *
+ * @param bytes         The key bytes
+ * @param size          The key size
+ * @param seed          The mixed seed
+ *
+ * @retval hash         The corresponding hash value
+ */
+uint64_t _HashLong(const uint8_t* bytes, size_t size, uint64_t seed);
+
 
 unsigned HashMurMur32(void* key, size_t size)
 {
@@ -64,4 +190,279 @@ unsigned HashDjb2(char* key)
         hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
 
     return hash;
-}
\ No newline at end of file
+}
+
+unsigned HashJenkins(void* key, size_t size)
+{
+    if (!key || size == 0)
+        return 0;
+
+    const uint8_t* bytes = (const uint8_t*)key;
+    unsigned hash = 0;
+    size_t i;
+    for (i = 0 ; i < size ; ++i) {
+        hash += bytes[i];
+        hash += hash << 10;
+        hash ^= hash >> 6;
+    }
+
+    hash += hash << 3;
+    hash ^= hash >> 11;
+    hash += hash << 15;
+    return hash;
+}
+
+uint64_t HashFast64(void* key, size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = (const uint8_t*)key;
+    seed ^= MUM(seed ^ HASH_SECRET[0], HASH_SECRET[1]);
+
+    uint64_t lhs, rhs;
+    if (likely(size <= 16)) {
+        /* Cover the short key with the overlapping reads. */
+        if (size >= 4) {
+            size_t mid = (size >> 3) << 2;
+            lhs = (READ32(bytes) << 32) | READ32(bytes + mid);
+            rhs = (READ32(bytes + size - 4) << 32) |
+                  READ32(bytes + size - 4 - mid);
+        } else if (size > 0) {
+            lhs = ((uint64_t)bytes[0] << 16) |
+                  ((uint64_t)bytes[size >> 1] << 8) | bytes[size - 1];
+            rhs = 0;
+        } else
+            lhs = rhs = 0;
+    } else if (size <= HASH_SIZE_MEDIUM) {
+        size_t rest = size;
+        while (rest > 16) {
+            seed = MUM(READ64(bytes) ^ HASH_SECRET[1], READ64(bytes + 8) ^ seed);
+            bytes += 16;
+            rest -= 16;
+        }
+        lhs = READ64(bytes + rest - 16);
+        rhs = READ64(bytes + rest - 8);
+    } else
+        return _HashLong(bytes, size, seed);
+
+    lhs ^= HASH_SECRET[1];
+    rhs ^= seed;
+    return MUM(HASH_SECRET[0] ^ size, MUM(lhs, rhs) ^ HASH_SECRET[1]);
+}
+
+uint64_t HashString64(void* key)
+{
+    return HashFast64(key, strlen((char*)key), 0);
+}
+
+void HashBulk(void** keys, const size_t* sizes, uint64_t* hashes, size_t count)
+{
+    static const size_t dist_prefetch = 4;
+
+    size_t i;
+    for (i = 0 ; i < count ; ++i) {
+        if (i + dist_prefetch < count)
+            __builtin_prefetch(keys[i + dist_prefetch]);
+        hashes[i] = HashFast64(keys[i], sizes[i], 0);
+    }
+}
+
+
+/*-------------------------------------------------------*
+ *     Implementation for the stripe accumulation        *
+ *-------------------------------------------------------*/
+uint64_t _HashLong(const uint8_t* bytes, size_t size, uint64_t seed)
+{
+    uint64_t acc[HASH_NUM_LANE] = {
+        HASH_SECRET[0], HASH_SECRET[1], HASH_SECRET[2], HASH_SECRET[3],
+        HASH_SECRET[4], HASH_SECRET[5], HASH_SECRET[6], HASH_SECRET[7],
+    };
+    uint64_t keys[HASH_NUM_LANE];
+    unsigned i;
+    for (i = 0 ; i < HASH_NUM_LANE ; ++i)
+        keys[i] = HASH_SECRET[(i + 3) & (HASH_NUM_LANE - 1)] + seed;
+
+#if defined(HASH_DISPATCH_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+        _HashLongAvx2(acc, bytes, size, keys);
+    else
+        _HashLongSse2(acc, bytes, size, keys);
+#elif defined(__SSE2__)
+    _HashLongSse2(acc, bytes, size, keys);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    _HashLongNeon(acc, bytes, size, keys);
+#else
+    _HashLongScalar(acc, bytes, size, keys);
+#endif
+
+    /* Merge the lanes pairwise and then mix in the size. */
+    uint64_t hash = size * HASH_SECRET[4];
+    for (i = 0 ; i < HASH_NUM_LANE ; i += 2)
+        hash += MUM(acc[i] ^ HASH_SECRET[i], acc[i + 1] ^ HASH_SECRET[i + 1]);
+    return MUM(hash ^ HASH_SECRET[0], seed ^ HASH_SECRET[1]);
+}
+
+void _HashLongScalar(uint64_t* acc, const uint8_t* bytes, size_t size,
+                     const uint64_t* keys)
+{
+    size_t num_stripe = (size - 1) / HASH_SIZE_STRIPE;
+    size_t stripe;
+    unsigned i;
+    for (stripe = 0 ; stripe <= num_stripe ; ++stripe) {
+        const uint8_t* block = (stripe < num_stripe)?
+                               bytes + stripe * HASH_SIZE_STRIPE :
+                               bytes + size - HASH_SIZE_STRIPE;
+        for (i = 0 ; i < HASH_NUM_LANE ; ++i) {
+            uint64_t word = READ64(block + i * 8);
+            uint64_t keyed = word ^ keys[i];
+            acc[i ^ 1] += word;
+            acc[i] += (keyed & 0xffffffff) * (keyed >> 32);
+        }
+
+        if (stripe % HASH_NUM_STRIPE == HASH_NUM_STRIPE - 1 &&
+            stripe < num_stripe) {
+            for (i = 0 ; i < HASH_NUM_LANE ; ++i) {
+                acc[i] ^= acc[i] >> 47;
+                acc[i] ^= keys[i];
+                acc[i] *= HASH_PRIME32;
+            }
+        }
+    }
+}
+
+#if defined(__SSE2__)
+void _HashLongSse2(uint64_t* acc, const uint8_t* bytes, size_t size,
+                   const uint64_t* keys)
+{
+    __m128i vec_acc[4], vec_key[4];
+    unsigned i;
+    for (i = 0 ; i < 4 ; ++i) {
+        vec_acc[i] = _mm_loadu_si128((const __m128i*)(acc + i * 2));
+        vec_key[i] = _mm_loadu_si128((const __m128i*)(keys + i * 2));
+    }
+    const __m128i prime = _mm_set1_epi32((int)HASH_PRIME32);
+
+    size_t num_stripe = (size - 1) / HASH_SIZE_STRIPE;
+    size_t stripe;
+    for (stripe = 0 ; stripe <= num_stripe ; ++stripe) {
+        const uint8_t* block = (stripe < num_stripe)?
+                               bytes + stripe * HASH_SIZE_STRIPE :
+                               bytes + size - HASH_SIZE_STRIPE;
+        for (i = 0 ; i < 4 ; ++i) {
+            __m128i word = _mm_loadu_si128((const __m128i*)(block + i * 16));
+            __m128i keyed = _mm_xor_si128(word, vec_key[i]);
+            __m128i keyed_hi = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+            __m128i product = _mm_mul_epu32(keyed, keyed_hi);
+            __m128i swap = _mm_shuffle_epi32(word, _MM_SHUFFLE(1, 0, 3, 2));
+            vec_acc[i] = _mm_add_epi64(vec_acc[i], swap);
+            vec_acc[i] = _mm_add_epi64(vec_acc[i], product);
+        }
+
+        if (stripe % HASH_NUM_STRIPE == HASH_NUM_STRIPE - 1 &&
+            stripe < num_stripe) {
+            for (i = 0 ; i < 4 ; ++i) {
+                __m128i lane = vec_acc[i];
+                lane = _mm_xor_si128(lane, _mm_srli_epi64(lane, 47));
+                lane = _mm_xor_si128(lane, vec_key[i]);
+                __m128i lo = _mm_mul_epu32(lane, prime);
+                __m128i hi = _mm_mul_epu32(_mm_srli_epi64(lane, 32), prime);
+                vec_acc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+            }
+        }
+    }
+
+    for (i = 0 ; i < 4 ; ++i)
+        _mm_storeu_si128((__m128i*)(acc + i * 2), vec_acc[i]);
+}
+#endif
+
+#if defined(HASH_DISPATCH_AVX2)
+__attribute__((target("avx2")))
+void _HashLongAvx2(uint64_t* acc, const uint8_t* bytes, size_t size,
+                   const uint64_t* keys)
+{
+    __m256i vec_acc[2], vec_key[2];
+    unsigned i;
+    for (i = 0 ; i < 2 ; ++i) {
+        vec_acc[i] = _mm256_loadu_si256((const __m256i*)(acc + i * 4));
+        vec_key[i] = _mm256_loadu_si256((const __m256i*)(keys + i * 4));
+    }
+    const __m256i prime = _mm256_set1_epi32((int)HASH_PRIME32);
+
+    size_t num_stripe = (size - 1) / HASH_SIZE_STRIPE;
+    size_t stripe;
+    for (stripe = 0 ; stripe <= num_stripe ; ++stripe) {
+        const uint8_t* block = (stripe < num_stripe)?
+                               bytes + stripe * HASH_SIZE_STRIPE :
+                               bytes + size - HASH_SIZE_STRIPE;
+        for (i = 0 ; i < 2 ; ++i) {
+            __m256i word = _mm256_loadu_si256((const __m256i*)(block + i * 32));
+            __m256i keyed = _mm256_xor_si256(word, vec_key[i]);
+            __m256i keyed_hi = _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+            __m256i product = _mm256_mul_epu32(keyed, keyed_hi);
+            __m256i swap = _mm256_shuffle_epi32(word, _MM_SHUFFLE(1, 0, 3, 2));
+            vec_acc[i] = _mm256_add_epi64(vec_acc[i], swap);
+            vec_acc[i] = _mm256_add_epi64(vec_acc[i], product);
+        }
+
+        if (stripe % HASH_NUM_STRIPE == HASH_NUM_STRIPE - 1 &&
+            stripe < num_stripe) {
+            for (i = 0 ; i < 2 ; ++i) {
+                __m256i lane = vec_acc[i];
+                lane = _mm256_xor_si256(lane, _mm256_srli_epi64(lane, 47));
+                lane = _mm256_xor_si256(lane, vec_key[i]);
+                __m256i lo = _mm256_mul_epu32(lane, prime);
+                __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(lane, 32), prime);
+                vec_acc[i] = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+            }
+        }
+    }
+
+    for (i = 0 ; i < 2 ; ++i)
+        _mm256_storeu_si256((__m256i*)(acc + i * 4), vec_acc[i]);
+}
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+void _HashLongNeon(uint64_t* acc, const uint8_t* bytes, size_t size,
+                   const uint64_t* keys)
+{
+    uint64x2_t vec_acc[4], vec_key[4];
+    unsigned i;
+    for (i = 0 ; i < 4 ; ++i) {
+        vec_acc[i] = vld1q_u64(acc + i * 2);
+        vec_key[i] = vld1q_u64(keys + i * 2);
+    }
+    const uint32x2_t prime = vdup_n_u32((uint32_t)HASH_PRIME32);
+
+    size_t num_stripe = (size - 1) / HASH_SIZE_STRIPE;
+    size_t stripe;
+    for (stripe = 0 ; stripe <= num_stripe ; ++stripe) {
+        const uint8_t* block = (stripe < num_stripe)?
+                               bytes + stripe * HASH_SIZE_STRIPE :
+                               bytes + size - HASH_SIZE_STRIPE;
+        for (i = 0 ; i < 4 ; ++i) {
+            uint64x2_t word = vreinterpretq_u64_u8(vld1q_u8(block + i * 16));
+            uint64x2_t keyed = veorq_u64(word, vec_key[i]);
+            uint64x2_t product = vmull_u32(vmovn_u64(keyed),
+                                           vshrn_n_u64(keyed, 32));
+            uint64x2_t swap = vextq_u64(word, word, 1);
+            vec_acc[i] = vaddq_u64(vec_acc[i], swap);
+            vec_acc[i] = vaddq_u64(vec_acc[i], product);
+        }
+
+        if (stripe % HASH_NUM_STRIPE == HASH_NUM_STRIPE - 1 &&
+            stripe < num_stripe) {
+            for (i = 0 ; i < 4 ; ++i) {
+                uint64x2_t lane = vec_acc[i];
+                lane = veorq_u64(lane, vshrq_n_u64(lane, 47));
+                lane = veorq_u64(lane, vec_key[i]);
+                uint64x2_t lo = vmull_u32(vmovn_u64(lane), prime);
+                uint64x2_t hi = vmull_u32(vshrn_n_u64(lane, 32), prime);
+                vec_acc[i] = vaddq_u64(lo, vshlq_n_u64(hi, 32));
+            }
+        }
+    }
+
+    for (i = 0 ; i < 4 ; ++i)
+        vst1q_u64(acc + i * 2, vec_acc[i]);
+}
+#endif
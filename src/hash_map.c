@@ -22,7 +22,12 @@
  */
 
 #include "container/hash_map.h"
+#include "container/bloom_filter.h"
 #include "math/hash.h"
+#include "memory/pool.h"
+#ifdef CDS_ENABLE_STATS
+#include <time.h>
+#endif
 
 
 /*===========================================================================*
@@ -34,12 +39,17 @@ static const unsigned magic_primes[] = {
     201326611, 402653189, 805306457, 1610612741,
 };
 static const int num_prime = sizeof(magic_primes) / sizeof(unsigned);
-static const double load_factor = 0.75;
+static const double default_load_factor = 0.75;
+static const unsigned pow2_init_slot = 1024;
+static const unsigned migrate_step = 4;
+static const unsigned batch_step = 16;
+static const double filter_fp_rate = 0.01;
 
 
 typedef struct _SlotNode {
     Pair pair_;
     struct _SlotNode* next_;
+    unsigned hash_;
 } SlotNode;
 
 struct _HashMapData {
@@ -48,20 +58,260 @@ struct _HashMapData {
     unsigned num_slot_;
     unsigned curr_limit_;
     unsigned iter_slot_;
+    unsigned num_slot_old_;
+    unsigned idx_migrate_;
+    bool incremental_;
+    bool pow2_;
+    double load_factor_;
     SlotNode** arr_slot_;
+    SlotNode** arr_slot_old_;
     SlotNode* iter_node_;
     HashMapHash func_hash_;
+    HashMapHash64 func_hash64_;
+    HashMapMix func_mix_;
     HashMapCompare func_cmp_;
     HashMapCleanKey func_clean_key_;
     HashMapCleanValue func_clean_val_;
+    size_t size_key_;
+    size_t size_val_;
+    size_t off_val_;
+    size_t size_node_;
+    Allocator alloc_;
+    Pool* pool_;
+    BloomFilter* filter_;
+#ifdef CDS_ENABLE_STATS
+    HashMapStats stats_;
+#endif
 };
 
+/* The parallel traversal whose slot ranges are claimed by the workers. */
+typedef struct _TraverseTask {
+    HashMapData* data_;
+    HashMapVisit func_visit_;
+    void* arg_;
+    const Reducer* reducer_;
+    unsigned num_chunk_;
+} TraverseTask;
+
 
 /*===========================================================================*
  *                  Definition for internal operations                       *
  *===========================================================================*/
 #define likely(x)       __builtin_expect(!!(x), 1)
 #define unlikely(x)     __builtin_expect(!!(x), 0)
+#define prefetch(x)     __builtin_prefetch((x))
+
+/* The statistics counters are compiled out by default. They are updated with
+   relaxed atomics since the lookups of the map wrapped by ConcurrentHashMap run
+   concurrently under the shared lock. */
+#ifdef CDS_ENABLE_STATS
+#define STATS_ADD(data, field, count) \
+    __atomic_fetch_add(&((data)->stats_.field), (count), __ATOMIC_RELAXED)
+#define STATS_CLOCK(var)        unsigned long long var = STATS_NOW()
+#define STATS_LAPSE(data, field, var) \
+    STATS_ADD(data, field, STATS_NOW() - (var))
+#else
+#define STATS_ADD(data, field, count)
+#define STATS_CLOCK(var)
+#define STATS_LAPSE(data, field, var)
+#endif
+
+#ifdef CDS_ENABLE_STATS
+/**
+ * Read the monotonic clock in nanoseconds.
+ */
+static inline unsigned long long STATS_NOW()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return (unsigned long long)spec.tv_sec * 1000000000ULL + spec.tv_nsec;
+}
+#endif
+
+/**
+ * Calculate the hash value of the given key. In power-of-two mode, the value is
+ * further scrambled by the finalizer mix since only its low bits are used. The
+ * 64 bit hash value is folded, and for the inline keys without custom hash
+ * function, the key bytes are hashed.
+ */
+static inline unsigned HASH(HashMapData* data, void* key)
+{
+    unsigned hash;
+    if (likely(data->func_hash_ != NULL))
+        hash = data->func_hash_(key);
+    else {
+        uint64_t wide = (data->func_hash64_)? data->func_hash64_(key) :
+                        HashFast64(key, data->size_key_, 0);
+        hash = (unsigned)(wide ^ (wide >> 32));
+    }
+    if (data->pow2_ && data->func_mix_)
+        hash = data->func_mix_(hash);
+    return hash;
+}
+
+/**
+ * Check if the slot node stores the given key. For the inline keys without
+ * custom comparison function, the key bytes are compared.
+ */
+static inline bool MATCH(HashMapData* data, SlotNode* node, unsigned hash, void* key)
+{
+    if (node->hash_ != hash)
+        return false;
+    if (likely(data->func_cmp_ != NULL))
+        return data->func_cmp_(key, node->pair_.key) == 0;
+    return memcmp(key, node->pair_.key, data->size_key_) == 0;
+}
+
+/**
+ * Map the hash value to the slot index.
+ */
+static inline unsigned SLOT_INDEX(HashMapData* data, unsigned hash, unsigned num_slot)
+{
+    if (data->pow2_)
+        return hash & (num_slot - 1);
+    return hash % num_slot;
+}
+
+/**
+ * Locate the slot list which should contain the key with the given hash. While
+ * an incremental rehashing is in progress, the keys belonged to the not yet
+ * migrated slots still reside in the old slot array.
+ */
+static inline SlotNode** GET_SLOT(HashMapData* data, unsigned hash)
+{
+    if (unlikely(data->arr_slot_old_ != NULL)) {
+        unsigned idx = SLOT_INDEX(data, hash, data->num_slot_old_);
+        if (idx >= data->idx_migrate_)
+            return data->arr_slot_old_ + idx;
+    }
+    return data->arr_slot_ + SLOT_INDEX(data, hash, data->num_slot_);
+}
+
+/**
+ * Allocate the slot node via the designated allocator.
+ */
+static inline SlotNode* NEW_NODE(HashMapData* data)
+{
+    STATS_ADD(data, bytes_alloc, data->size_node_);
+    return (SlotNode*)data->alloc_.alloc(data->alloc_.ctx, data->size_node_);
+}
+
+/**
+ * Release the slot node via the designated allocator.
+ */
+static inline void DELETE_NODE(HashMapData* data, SlotNode* node)
+{
+    data->alloc_.free(data->alloc_.ctx, node);
+}
+
+/**
+ * Link the new node to the slot list and record its hash value in the filter.
+ */
+static inline void LINK_NODE(HashMapData* data, SlotNode** slot, SlotNode* node)
+{
+    node->next_ = *slot;
+    *slot = node;
+    ++(data->size_);
+    if (data->filter_)
+        BloomFilterAddHash(data->filter_, node->hash_);
+}
+
+/**
+ * Check if the key with the given hash may be stored in the map.
+ */
+static inline bool MAY_CONTAIN(HashMapData* data, unsigned hash)
+{
+    return !data->filter_ || BloomFilterContainHash(data->filter_, hash);
+}
+
+/**
+ * Store the key into the slot node. In inline mode, the key bytes are copied
+ * into the storage trailing the node.
+ */
+static inline void SET_KEY(HashMapData* data, SlotNode* node, void* key)
+{
+    if (data->size_key_ > 0) {
+        void* buf = (char*)node + sizeof(SlotNode);
+        if (key != buf)
+            memcpy(buf, key, data->size_key_);
+        key = buf;
+    }
+    node->pair_.key = key;
+}
+
+/**
+ * Store the value into the slot node. In inline mode, the value bytes are
+ * copied into the storage trailing the inline key.
+ */
+static inline void SET_VALUE(HashMapData* data, SlotNode* node, void* value)
+{
+    if (data->size_val_ > 0) {
+        void* buf = (char*)node + data->off_val_;
+        if (value != buf)
+            memcpy(buf, value, data->size_val_);
+        value = buf;
+    }
+    node->pair_.value = value;
+}
+
+/**
+ * Return the slot list pointed by the iterator. The old slot array, if any, is
+ * visited before the current one.
+ */
+static inline SlotNode* GET_ITER_SLOT(HashMapData* data, unsigned iter)
+{
+    unsigned num_slot_old = data->num_slot_old_;
+    if (iter < num_slot_old)
+        return data->arr_slot_old_[iter];
+    return data->arr_slot_[iter - num_slot_old];
+}
+
+/**
+ * Write a key or value to the snapshot. The inline bytes are stored as they
+ * are, and the pointers are encoded by the codec.
+ */
+static inline bool SNAPSHOT_ITEM(SnapshotEncoder* enc, const SnapshotCodec* codec,
+                                 void* item, size_t size)
+{
+    if (size > 0)
+        return CdsSnapshotAppend(enc, item, size);
+    return CdsSnapshotEncode(enc, codec, item);
+}
+
+/**
+ * Read a key or value from the snapshot. The inline bytes are copied out of
+ * the chunk into the aligned buffer before being passed to the custom
+ * functions.
+ */
+static inline bool RESTORE_ITEM(SnapshotDecoder* dec, const SnapshotCodec* codec,
+                                size_t size, void* buf, void** p_item)
+{
+    if (size == 0)
+        return CdsRestoreDecode(dec, codec, p_item);
+
+    const void* bytes;
+    size_t len;
+    if (unlikely(!CdsRestoreField(dec, &bytes, &len) || len != size))
+        return false;
+    memcpy(buf, bytes, size);
+    *p_item = buf;
+    return true;
+}
+
+/**
+ * @brief Hash a group of keys and prefetch their slot lists.
+ *
+ * The slot entries are prefetched first, and the list heads are prefetched in
+ * a second pass so that the slot loads issued by the first pass overlap.
+ *
+ * @param data          The pointer to the map private data
+ * @param keys          Array of the keys
+ * @param hashes        Array to store the hash values
+ * @param slots         Array to store the located slot lists
+ * @param count         The number of keys, at most batch_step
+ */
+void _HashMapPrefetch(HashMapData* data, void** keys, unsigned* hashes,
+                      SlotNode*** slots, unsigned count);
 
 /**
  * @brief The default hash function.
@@ -84,18 +334,99 @@ unsigned _HashMapHash(void* key);
  */
 int _HashMapCompare(void* lhs, void* rhs);
 
+/**
+ * @brief The default finalizer mix applied in power-of-two mode.
+ *
+ * This is the 32 bit finalizer of MurMur3 which spreads the entropy of the
+ * high bits to the low ones.
+ *
+ * @param hash          The hash value calculated by the hash function
+ *
+ * @retval Hash         The scrambled hash value
+ */
+unsigned _HashMapMix(unsigned hash);
+
 /**
  * @brief Extend the slot array and re-distribute the stored pairs.
  *
+ * In incremental mode, this function only allocates the new slot array. The
+ * stored pairs are then migrated step by step via _HashMapMigrate.
+ *
  * @param data         The pointer to the map private data
  */
 void _HashMapReHash(HashMapData* data);
 
+/**
+ * @brief Allocate a slot array with the designated size and re-distribute the
+ * stored pairs to it.
+ *
+ * @param data          The pointer to the map private data
+ * @param num_slot_new  The size of the new slot array
+ * @param incremental   Whether to keep the old slot array for the incremental
+ *                      migration
+ *
+ * @retval true         The slot array is successfully replaced
+ * @retval false        Insufficient memory for the new slot array
+ */
+bool _HashMapResize(HashMapData* data, unsigned num_slot_new, bool incremental);
+
+/**
+ * @brief Calculate the slot array size which can hold the designated number
+ * of pairs without extension.
+ *
+ * @param capacity      The designated number of pairs
+ * @param factor        The loading factor
+ * @param pow2          Whether the power-of-two slot array is applied
+ * @param p_idx_prime   The pointer to the returned index to the magic primes
+ *
+ * @retval num_slot     The required slot array size
+ */
+unsigned _HashMapFitSlot(unsigned capacity, double factor, bool pow2,
+                         int* p_idx_prime);
+
+/**
+ * @brief Migrate the designated number of slot lists from the old slot array
+ * to the current one.
+ *
+ * The old slot array is released once all of its slot lists are migrated.
+ *
+ * @param data          The pointer to the map private data
+ * @param count         The number of slot lists to migrate
+ */
+void _HashMapMigrate(HashMapData* data, unsigned count);
+
+/**
+ * @brief Rebuild the filter from the cached hash values of the stored pairs.
+ *
+ * The new filter is sized with the current slot array. If it cannot be
+ * allocated, the old filter is kept since it still covers all the stored keys.
+ *
+ * @param data          The pointer to the map private data
+ *
+ * @retval true         The filter is successfully rebuilt
+ * @retval false        Insufficient memory for the new filter
+ */
+bool _HashMapBuildFilter(HashMapData* data);
+
+/**
+ * @brief Visit or accumulate the pairs of the designated slot range.
+ *
+ * @param arg           The pointer to the traversal task
+ * @param chunk         The index of the slot range
+ * @param acc           The partial result or NULL for the visit
+ */
+void _HashMapTraverseChunk(void* arg, unsigned chunk, void* acc);
+
 
 /*===========================================================================*
  *               Implementation for the exported operations                  *
  *===========================================================================*/
 HashMap* HashMapInit()
+{
+    return HashMapInitWithCapacity(0);
+}
+
+HashMap* HashMapInitWithCapacity(unsigned capacity)
 {
     HashMap* obj = (HashMap*)malloc(sizeof(HashMap));
     if (unlikely(!obj))
@@ -107,25 +438,48 @@ HashMap* HashMapInit()
         return NULL;
     }
 
-    SlotNode** arr_slot = (SlotNode**)malloc(sizeof(SlotNode*) * magic_primes[0]);
+    int idx_prime;
+    unsigned num_slot = _HashMapFitSlot(capacity, default_load_factor, false,
+                                       &idx_prime);
+    SlotNode** arr_slot = (SlotNode**)malloc(sizeof(SlotNode*) * num_slot);
     if (unlikely(!arr_slot)) {
         free(data);
         free(obj);
         return NULL;
     }
     unsigned i;
-    for (i = 0 ; i < magic_primes[0] ; ++i)
+    for (i = 0 ; i < num_slot ; ++i)
         arr_slot[i] = NULL;
 
     data->size_ = 0;
-    data->idx_prime_ = 0;
-    data->num_slot_ = magic_primes[0];
-    data->curr_limit_ = (unsigned)((double)magic_primes[0] * load_factor);
+    data->idx_prime_ = idx_prime;
+    data->num_slot_ = num_slot;
+    data->curr_limit_ = (unsigned)((double)num_slot * default_load_factor);
+    data->num_slot_old_ = 0;
+    data->idx_migrate_ = 0;
+    data->incremental_ = false;
+    data->pow2_ = false;
+    data->load_factor_ = default_load_factor;
     data->arr_slot_ = arr_slot;
+    data->arr_slot_old_ = NULL;
     data->func_hash_ = _HashMapHash;
+    data->func_hash64_ = NULL;
+    data->func_mix_ = _HashMapMix;
     data->func_cmp_ = _HashMapCompare;
     data->func_clean_key_ = NULL;
     data->func_clean_val_ = NULL;
+    data->size_key_ = 0;
+    data->size_val_ = 0;
+    data->off_val_ = sizeof(SlotNode);
+    data->size_node_ = sizeof(SlotNode);
+    data->alloc_ = *CdsGetAllocator();
+    data->pool_ = NULL;
+    data->filter_ = NULL;
+#ifdef CDS_ENABLE_STATS
+    memset(&(data->stats_), 0, sizeof(HashMapStats));
+    data->stats_.instrumented = true;
+#endif
+    STATS_ADD(data, bytes_alloc, sizeof(SlotNode*) * num_slot);
 
     obj->data = data;
     obj->put = HashMapPut;
@@ -135,10 +489,23 @@ HashMap* HashMapInit()
     obj->size = HashMapSize;
     obj->first = HashMapFirst;
     obj->next = HashMapNext;
+    obj->put_batch = HashMapPutBatch;
+    obj->get_batch = HashMapGetBatch;
     obj->set_hash = HashMapSetHash;
+    obj->set_hash64 = HashMapSetHash64;
     obj->set_compare = HashMapSetCompare;
     obj->set_clean_key = HashMapSetCleanKey;
     obj->set_clean_value = HashMapSetCleanValue;
+    obj->set_incremental_rehash = HashMapSetIncrementalReHash;
+    obj->set_power_of_two = HashMapSetPowerOfTwo;
+    obj->set_mix = HashMapSetMix;
+    obj->set_load_factor = HashMapSetLoadFactor;
+    obj->set_allocator = HashMapSetAllocator;
+    obj->use_pool = HashMapUsePool;
+    obj->reserve = HashMapReserve;
+    obj->set_inline = HashMapSetInline;
+    obj->use_filter = HashMapUseFilter;
+    obj->get_stats = HashMapGetStats;
 
     return obj;
 }
@@ -149,27 +516,36 @@ void HashMapDeinit(HashMap* obj)
         return;
 
     HashMapData* data = obj->data;
-    SlotNode** arr_slot = data->arr_slot_;
     HashMapCleanKey func_clean_key = data->func_clean_key_;
     HashMapCleanValue func_clean_val = data->func_clean_val_;
 
-    unsigned num_slot = data->num_slot_;
-    unsigned i;
-    for (i = 0 ; i < num_slot ; ++i) {
-        SlotNode* pred;
-        SlotNode* curr = arr_slot[i];
-        while (curr) {
-            pred = curr;
-            curr = curr->next_;
-            if (func_clean_key)
-                func_clean_key(pred->pair_.key);
-            if (func_clean_val)
-                func_clean_val(pred->pair_.value);
-            free(pred);
+    /* The pooled nodes are released at once, so the slot lists are traversed
+       only for the key value cleanup. */
+    Pool* pool = data->pool_;
+    if (!pool || func_clean_key || func_clean_val) {
+        unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+        unsigned i;
+        for (i = 0 ; i < num_slot ; ++i) {
+            SlotNode* pred;
+            SlotNode* curr = GET_ITER_SLOT(data, i);
+            while (curr) {
+                pred = curr;
+                curr = curr->next_;
+                if (func_clean_key)
+                    func_clean_key(pred->pair_.key);
+                if (func_clean_val)
+                    func_clean_val(pred->pair_.value);
+                if (!pool)
+                    DELETE_NODE(data, pred);
+            }
         }
     }
+    if (pool)
+        PoolDeinit(pool);
 
-    free(arr_slot);
+    BloomFilterDeinit(data->filter_);
+    free(data->arr_slot_old_);
+    free(data->arr_slot_);
     free(data);
     free(obj);
     return;
@@ -181,44 +557,40 @@ bool HashMapPut(HashMap* self, void* key, void* value)
     HashMapData* data = self->data;
     if (data->size_ >= data->curr_limit_)
         _HashMapReHash(data);
+    if (unlikely(data->arr_slot_old_ != NULL))
+        _HashMapMigrate(data, migrate_step);
 
-    /* Calculate the slot index. */
-    unsigned hash = data->func_hash_(key);
-    hash = hash % data->num_slot_;
+    /* Locate the slot list. */
+    unsigned hash = HASH(data, key);
+    SlotNode** slot = GET_SLOT(data, hash);
+    STATS_ADD(data, num_lookup, 1);
 
     /* Check if the pair conflicts with a certain one stored in the map. If yes,
        replace that one. */
-    HashMapCompare func_cmp = data->func_cmp_;
-    SlotNode** arr_slot = data->arr_slot_;
-    SlotNode* curr = arr_slot[hash];
+    SlotNode* curr = *slot;
     while (curr) {
-        if (func_cmp(key, curr->pair_.key) == 0) {
+        STATS_ADD(data, num_probe, 1);
+        if (MATCH(data, curr, hash, key)) {
             if (data->func_clean_key_)
                 data->func_clean_key_(curr->pair_.key);
             if (data->func_clean_val_)
                 data->func_clean_val_(curr->pair_.value);
-            curr->pair_.key = key;
-            curr->pair_.value = value;
+            SET_KEY(data, curr, key);
+            SET_VALUE(data, curr, value);
             return true;
         }
         curr = curr->next_;
     }
 
     /* Insert the new pair into the slot list. */
-    SlotNode* node = (SlotNode*)malloc(sizeof(SlotNode));
+    SlotNode* node = NEW_NODE(data);
     if (unlikely(!node))
         return false;
 
-    node->pair_.key = key;
-    node->pair_.value = value;
-    if (!(arr_slot[hash])) {
-        node->next_ = NULL;
-        arr_slot[hash] = node;
-    } else {
-        node->next_ = arr_slot[hash];
-        arr_slot[hash] = node;
-    }
-    ++(data->size_);
+    SET_KEY(data, node, key);
+    SET_VALUE(data, node, value);
+    node->hash_ = hash;
+    LINK_NODE(data, slot, node);
 
     return true;
 }
@@ -226,17 +598,23 @@ bool HashMapPut(HashMap* self, void* key, void* value)
 void* HashMapGet(HashMap* self, void* key)
 {
     HashMapData* data = self->data;
+    if (unlikely(data->arr_slot_old_ != NULL))
+        _HashMapMigrate(data, migrate_step);
 
-    /* Calculate the slot index. */
-    unsigned hash = data->func_hash_(key);
-    hash = hash % data->num_slot_;
+    /* Reject the absent key via the filter, and then locate the slot
+       list. */
+    unsigned hash = HASH(data, key);
+    STATS_ADD(data, num_lookup, 1);
+    if (!MAY_CONTAIN(data, hash))
+        return NULL;
+    SlotNode** slot = GET_SLOT(data, hash);
 
     /* Search the slot list to check if there is a pair having the same key
        with the designated one. */
-    HashMapCompare func_cmp = data->func_cmp_;
-    SlotNode* curr = data->arr_slot_[hash];
+    SlotNode* curr = *slot;
     while (curr) {
-        if (func_cmp(key, curr->pair_.key) == 0)
+        STATS_ADD(data, num_probe, 1);
+        if (MATCH(data, curr, hash, key))
             return curr->pair_.value;
         curr = curr->next_;
     }
@@ -247,17 +625,23 @@ void* HashMapGet(HashMap* self, void* key)
 bool HashMapContain(HashMap* self, void* key)
 {
     HashMapData* data = self->data;
+    if (unlikely(data->arr_slot_old_ != NULL))
+        _HashMapMigrate(data, migrate_step);
 
-    /* Calculate the slot index. */
-    unsigned hash = data->func_hash_(key);
-    hash = hash % data->num_slot_;
+    /* Reject the absent key via the filter, and then locate the slot
+       list. */
+    unsigned hash = HASH(data, key);
+    STATS_ADD(data, num_lookup, 1);
+    if (!MAY_CONTAIN(data, hash))
+        return false;
+    SlotNode** slot = GET_SLOT(data, hash);
 
     /* Search the slot list to check if there is a pair having the same key
        with the designated one. */
-    HashMapCompare func_cmp = data->func_cmp_;
-    SlotNode* curr = data->arr_slot_[hash];
+    SlotNode* curr = *slot;
     while (curr) {
-        if (func_cmp(key, curr->pair_.key) == 0)
+        STATS_ADD(data, num_probe, 1);
+        if (MATCH(data, curr, hash, key))
             return true;
         curr = curr->next_;
     }
@@ -268,29 +652,34 @@ bool HashMapContain(HashMap* self, void* key)
 bool HashMapRemove(HashMap* self, void* key)
 {
     HashMapData* data = self->data;
+    if (unlikely(data->arr_slot_old_ != NULL))
+        _HashMapMigrate(data, migrate_step);
 
-    /* Calculate the slot index. */
-    unsigned hash = data->func_hash_(key);
-    hash = hash % data->num_slot_;
+    /* Reject the absent key via the filter, and then locate the slot
+       list. */
+    unsigned hash = HASH(data, key);
+    STATS_ADD(data, num_lookup, 1);
+    if (!MAY_CONTAIN(data, hash))
+        return false;
+    SlotNode** slot = GET_SLOT(data, hash);
 
     /* Search the slot list for the deletion target. */
-    HashMapCompare func_cmp = data->func_cmp_;
     SlotNode* pred = NULL;
-    SlotNode** arr_slot = data->arr_slot_;
-    SlotNode* curr = arr_slot[hash];
+    SlotNode* curr = *slot;
     while (curr) {
-        if (func_cmp(key, curr->pair_.key) == 0) {
+        STATS_ADD(data, num_probe, 1);
+        if (MATCH(data, curr, hash, key)) {
             if (data->func_clean_key_)
                 data->func_clean_key_(curr->pair_.key);
             if (data->func_clean_val_)
                 data->func_clean_val_(curr->pair_.value);
 
             if (!pred)
-                arr_slot[hash] = curr->next_;
+                *slot = curr->next_;
             else
                 pred->next_ = curr->next_;
 
-            free(curr);
+            DELETE_NODE(data, curr);
             --(data->size_);
             return true;
         }
@@ -310,7 +699,7 @@ void HashMapFirst(HashMap* self)
 {
     HashMapData* data = self->data;
     data->iter_slot_ = 0;
-    data->iter_node_ = data->arr_slot_[0];
+    data->iter_node_ = GET_ITER_SLOT(data, 0);
     return;
 }
 
@@ -318,24 +707,204 @@ Pair* HashMapNext(HashMap* self)
 {
     HashMapData* data = self->data;
 
-    SlotNode** arr_slot = data->arr_slot_;
-    while (data->iter_slot_ < data->num_slot_) {
+    unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+    while (data->iter_slot_ < num_slot) {
         if (data->iter_node_) {
             Pair* ptr_pair = &(data->iter_node_->pair_);
             data->iter_node_ = data->iter_node_->next_;
             return ptr_pair;
         }
         ++(data->iter_slot_);
-        if (data->iter_slot_ == data->num_slot_)
+        if (data->iter_slot_ == num_slot)
             break;
-        data->iter_node_ = arr_slot[data->iter_slot_];
+        data->iter_node_ = GET_ITER_SLOT(data, data->iter_slot_);
     }
     return NULL;
 }
 
+void HashMapIterInit(HashMap* self, HashMapIter* iter)
+{
+    HashMapData* data = self->data;
+    iter->data_ = data;
+    iter->slot_ = 0;
+    iter->node_ = GET_ITER_SLOT(data, 0);
+    return;
+}
+
+Pair* HashMapIterNext(HashMapIter* iter)
+{
+    HashMapData* data = iter->data_;
+    SlotNode* node = (SlotNode*)iter->node_;
+    unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+    unsigned slot = iter->slot_;
+
+    while (!node) {
+        ++slot;
+        if (slot >= num_slot) {
+            iter->slot_ = num_slot;
+            return NULL;
+        }
+        node = GET_ITER_SLOT(data, slot);
+    }
+
+    iter->slot_ = slot;
+    iter->node_ = node->next_;
+    return &(node->pair_);
+}
+
+bool HashMapPutBatch(HashMap* self, void** keys, void** values, unsigned size)
+{
+    HashMapData* data = self->data;
+    unsigned hashes[batch_step];
+    SlotNode** slots[batch_step];
+
+    unsigned base;
+    for (base = 0 ; base < size ; base += batch_step) {
+        unsigned count = size - base;
+        if (count > batch_step)
+            count = batch_step;
+
+        /* Reserve the room for the whole group in advance, since extending the
+           slot array invalidates the located slots. */
+        while (data->size_ + count > data->curr_limit_) {
+            unsigned num_slot = data->num_slot_;
+            _HashMapReHash(data);
+            if (unlikely(data->num_slot_ == num_slot))
+                break;
+        }
+        if (unlikely(data->arr_slot_old_ != NULL))
+            _HashMapMigrate(data, migrate_step);
+
+        _HashMapPrefetch(data, keys + base, hashes, slots, count);
+
+        unsigned i;
+        for (i = 0 ; i < count ; ++i) {
+            void* key = keys[base + i];
+            void* value = values[base + i];
+            unsigned hash = hashes[i];
+            SlotNode** slot = slots[i];
+
+            /* Check if the pair conflicts with a certain one stored in the
+               map. If yes, replace that one. */
+            STATS_ADD(data, num_lookup, 1);
+            SlotNode* curr = *slot;
+            while (curr) {
+                STATS_ADD(data, num_probe, 1);
+                if (MATCH(data, curr, hash, key))
+                    break;
+                curr = curr->next_;
+            }
+            if (curr) {
+                if (data->func_clean_key_)
+                    data->func_clean_key_(curr->pair_.key);
+                if (data->func_clean_val_)
+                    data->func_clean_val_(curr->pair_.value);
+                SET_KEY(data, curr, key);
+                SET_VALUE(data, curr, value);
+                continue;
+            }
+
+            /* Insert the new pair into the slot list. */
+            SlotNode* node = NEW_NODE(data);
+            if (unlikely(!node))
+                return false;
+
+            SET_KEY(data, node, key);
+            SET_VALUE(data, node, value);
+            node->hash_ = hash;
+            LINK_NODE(data, slot, node);
+        }
+    }
+
+    return true;
+}
+
+unsigned HashMapGetBatch(HashMap* self, void** keys, void** values, unsigned size)
+{
+    HashMapData* data = self->data;
+    unsigned hashes[batch_step];
+    SlotNode** slots[batch_step];
+    unsigned found = 0;
+
+    unsigned base;
+    for (base = 0 ; base < size ; base += batch_step) {
+        unsigned count = size - base;
+        if (count > batch_step)
+            count = batch_step;
+
+        if (unlikely(data->arr_slot_old_ != NULL))
+            _HashMapMigrate(data, migrate_step);
+
+        _HashMapPrefetch(data, keys + base, hashes, slots, count);
+
+        unsigned i;
+        for (i = 0 ; i < count ; ++i) {
+            void* key = keys[base + i];
+            unsigned hash = hashes[i];
+            void* value = NULL;
+
+            STATS_ADD(data, num_lookup, 1);
+            SlotNode* curr = (MAY_CONTAIN(data, hash))? *slots[i] : NULL;
+            while (curr) {
+                STATS_ADD(data, num_probe, 1);
+                if (MATCH(data, curr, hash, key)) {
+                    value = curr->pair_.value;
+                    ++found;
+                    break;
+                }
+                curr = curr->next_;
+            }
+            values[base + i] = value;
+        }
+    }
+
+    return found;
+}
+
+void HashMapForEachParallel(HashMap* self, HashMapVisit func, void* arg,
+                            unsigned num_thread)
+{
+    HashMapData* data = self->data;
+    TraverseTask task;
+    task.data_ = data;
+    task.func_visit_ = func;
+    task.arg_ = arg;
+    task.reducer_ = NULL;
+    task.num_chunk_ = CdsParallelChunks(data->num_slot_old_ + data->num_slot_,
+                                        num_thread);
+    CdsParallelRun(task.num_chunk_, num_thread, _HashMapTraverseChunk, &task,
+                   NULL, NULL);
+}
+
+void HashMapReduceParallel(HashMap* self, const Reducer* reducer, void* acc,
+                           unsigned num_thread)
+{
+    HashMapData* data = self->data;
+    TraverseTask task;
+    task.data_ = data;
+    task.func_visit_ = NULL;
+    task.arg_ = NULL;
+    task.reducer_ = reducer;
+    task.num_chunk_ = CdsParallelChunks(data->num_slot_old_ + data->num_slot_,
+                                        num_thread);
+    CdsParallelRun(task.num_chunk_, num_thread, _HashMapTraverseChunk, &task,
+                   reducer, acc);
+}
+
 void HashMapSetHash(HashMap* self, HashMapHash func)
 {
     self->data->func_hash_ = func;
+    self->data->func_hash64_ = NULL;
+}
+
+void HashMapSetHash64(HashMap* self, HashMapHash64 func)
+{
+    HashMapData* data = self->data;
+    data->func_hash64_ = func;
+    if (func || data->size_key_ > 0)
+        data->func_hash_ = NULL;
+    else
+        data->func_hash_ = _HashMapHash;
 }
 
 void HashMapSetCompare(HashMap* self, HashMapCompare func)
@@ -353,10 +922,307 @@ void HashMapSetCleanValue(HashMap* self, HashMapCleanValue func)
     self->data->func_clean_val_ = func;
 }
 
+void HashMapSetIncrementalReHash(HashMap* self, bool enable)
+{
+    HashMapData* data = self->data;
+    data->incremental_ = enable;
+
+    /* Finish the pending migration when switching back to one-shot mode. */
+    if (!enable && data->arr_slot_old_)
+        _HashMapMigrate(data, data->num_slot_old_);
+}
+
+bool HashMapSetPowerOfTwo(HashMap* self, bool enable)
+{
+    HashMapData* data = self->data;
+    if (data->pow2_ == enable)
+        return true;
+
+    /* The slot layout can only be switched while the map is empty. */
+    if (data->size_ > 0)
+        return false;
+
+    unsigned num_slot = (enable)? pow2_init_slot : magic_primes[0];
+    SlotNode** arr_slot = (SlotNode**)malloc(sizeof(SlotNode*) * num_slot);
+    if (unlikely(!arr_slot))
+        return false;
+    STATS_ADD(data, bytes_alloc, sizeof(SlotNode*) * num_slot);
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i)
+        arr_slot[i] = NULL;
+
+    free(data->arr_slot_old_);
+    free(data->arr_slot_);
+    data->arr_slot_ = arr_slot;
+    data->arr_slot_old_ = NULL;
+    data->num_slot_ = num_slot;
+    data->num_slot_old_ = 0;
+    data->idx_migrate_ = 0;
+    data->idx_prime_ = 0;
+    data->pow2_ = enable;
+    data->curr_limit_ = (unsigned)((double)num_slot * data->load_factor_);
+    if (data->filter_)
+        _HashMapBuildFilter(data);
+    return true;
+}
+
+void HashMapSetMix(HashMap* self, HashMapMix func)
+{
+    self->data->func_mix_ = func;
+}
+
+bool HashMapSetLoadFactor(HashMap* self, double factor)
+{
+    if (!(factor > 0))
+        return false;
+
+    HashMapData* data = self->data;
+    data->load_factor_ = factor;
+    data->curr_limit_ = (unsigned)((double)data->num_slot_ * factor);
+    return true;
+}
+
+bool HashMapSetAllocator(HashMap* self, const Allocator* alloc)
+{
+    HashMapData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    if (data->pool_) {
+        PoolDeinit(data->pool_);
+        data->pool_ = NULL;
+    }
+    data->alloc_ = (alloc)? *alloc : *CdsGetAllocator();
+    return true;
+}
+
+bool HashMapUsePool(HashMap* self)
+{
+    HashMapData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    Pool* pool = PoolInit(data->size_node_);
+    if (unlikely(!pool))
+        return false;
+
+    if (data->pool_)
+        PoolDeinit(data->pool_);
+    data->pool_ = pool;
+    PoolGetAllocator(pool, &(data->alloc_));
+    return true;
+}
+
+bool HashMapReserve(HashMap* self, unsigned capacity)
+{
+    HashMapData* data = self->data;
+
+    /* The slot array is replaced at once, so any pending migration should be
+       finished first. */
+    if (data->arr_slot_old_)
+        _HashMapMigrate(data, data->num_slot_old_);
+
+    int idx_prime;
+    unsigned num_slot = _HashMapFitSlot(capacity, data->load_factor_, data->pow2_,
+                                       &idx_prime);
+    if (num_slot <= data->num_slot_)
+        return true;
+
+    if (unlikely(!_HashMapResize(data, num_slot, false)))
+        return false;
+    if (!data->pow2_)
+        data->idx_prime_ = idx_prime;
+    return true;
+}
+
+bool HashMapSetInline(HashMap* self, size_t size_key, size_t size_value)
+{
+    HashMapData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    /* The value bytes are aligned to the pointer size. */
+    size_t align = sizeof(void*);
+    size_t off_val = sizeof(SlotNode) + (size_key + align - 1) / align * align;
+    size_t size_node = off_val + size_value;
+
+    /* The pooled objects should be re-sized for the new node layout. */
+    if (data->pool_ && size_node != data->size_node_) {
+        Pool* pool = PoolInit(size_node);
+        if (unlikely(!pool))
+            return false;
+        PoolDeinit(data->pool_);
+        data->pool_ = pool;
+        PoolGetAllocator(pool, &(data->alloc_));
+    }
+
+    /* Switch the default hash and comparison functions between the pointer
+       value and the key bytes. */
+    if (size_key > 0) {
+        if (data->func_hash_ == _HashMapHash)
+            data->func_hash_ = NULL;
+        if (data->func_cmp_ == _HashMapCompare)
+            data->func_cmp_ = NULL;
+    } else {
+        if (!data->func_hash_ && !data->func_hash64_)
+            data->func_hash_ = _HashMapHash;
+        if (!data->func_cmp_)
+            data->func_cmp_ = _HashMapCompare;
+    }
+
+    data->size_key_ = size_key;
+    data->size_val_ = size_value;
+    data->off_val_ = off_val;
+    data->size_node_ = size_node;
+    return true;
+}
+
+bool HashMapUseFilter(HashMap* self, bool enable)
+{
+    HashMapData* data = self->data;
+    if (!enable) {
+        BloomFilterDeinit(data->filter_);
+        data->filter_ = NULL;
+        return true;
+    }
+    if (data->filter_)
+        return true;
+    return _HashMapBuildFilter(data);
+}
+
+void HashMapGetStats(HashMap* self, HashMapStats* p_stats)
+{
+    HashMapData* data = self->data;
+#ifdef CDS_ENABLE_STATS
+    *p_stats = data->stats_;
+#else
+    memset(p_stats, 0, sizeof(HashMapStats));
+#endif
+
+    unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+    p_stats->size = data->size_;
+    p_stats->num_slot = num_slot;
+    p_stats->load_factor = (double)data->size_ / num_slot;
+    p_stats->max_chain = 0;
+    memset(p_stats->chains, 0, sizeof(p_stats->chains));
+
+    /* Walk each slot list for the chain length distribution. */
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        unsigned len = 0;
+        SlotNode* curr;
+        for (curr = GET_ITER_SLOT(data, i) ; curr ; curr = curr->next_)
+            ++len;
+        if (len > p_stats->max_chain)
+            p_stats->max_chain = len;
+        if (len >= CDS_STATS_NUM_CHAIN)
+            len = CDS_STATS_NUM_CHAIN - 1;
+        ++(p_stats->chains[len]);
+    }
+    return;
+}
+
+bool HashMapSnapshot(HashMap* self, const SnapshotWriter* writer,
+                     const SnapshotCodec* codec_key,
+                     const SnapshotCodec* codec_value)
+{
+    HashMapData* data = self->data;
+    SnapshotEncoder enc;
+    if (unlikely(!CdsSnapshotBegin(&enc, writer, CDS_SNAPSHOT_HASH_MAP,
+                                   data->size_)))
+        return false;
+
+    HashMapIter iter;
+    HashMapIterInit(self, &iter);
+    Pair* pair;
+    while ((pair = HashMapIterNext(&iter))) {
+        if (unlikely(!SNAPSHOT_ITEM(&enc, codec_key, pair->key,
+                                    data->size_key_) ||
+                     !SNAPSHOT_ITEM(&enc, codec_value, pair->value,
+                                    data->size_val_)))
+            return CdsSnapshotEnd(&enc, false);
+    }
+    return CdsSnapshotEnd(&enc, true);
+}
+
+bool HashMapRestore(HashMap* self, const SnapshotReader* reader,
+                    const SnapshotCodec* codec_key,
+                    const SnapshotCodec* codec_value)
+{
+    HashMapData* data = self->data;
+    SnapshotDecoder dec;
+    unsigned count;
+    if (unlikely(!CdsRestoreBegin(&dec, reader, CDS_SNAPSHOT_HASH_MAP, &count)))
+        return CdsRestoreEnd(&dec, false);
+
+    /* Presize the slot array for all the pairs, so that the restore never
+       triggers the rehash. */
+    unsigned capacity = (count > UINT_MAX - data->size_)?
+                        UINT_MAX : data->size_ + count;
+    if (unlikely(!HashMapReserve(self, capacity)))
+        return CdsRestoreEnd(&dec, false);
+
+    char* buf = NULL;
+    if (data->size_key_ + data->size_val_ > 0) {
+        buf = (char*)malloc(data->size_key_ + data->size_val_);
+        if (unlikely(!buf))
+            return CdsRestoreEnd(&dec, false);
+    }
+
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        void* key;
+        void* value;
+        if (unlikely(!RESTORE_ITEM(&dec, codec_key, data->size_key_, buf,
+                                   &key)))
+            break;
+        if (unlikely(!RESTORE_ITEM(&dec, codec_value, data->size_val_,
+                                   buf? buf + data->size_key_ : NULL,
+                                   &value))) {
+            if (data->size_key_ == 0 && data->func_clean_key_)
+                data->func_clean_key_(key);
+            break;
+        }
+        if (unlikely(!HashMapPut(self, key, value))) {
+            if (data->size_key_ == 0 && data->func_clean_key_)
+                data->func_clean_key_(key);
+            if (data->size_val_ == 0 && data->func_clean_val_)
+                data->func_clean_val_(value);
+            break;
+        }
+    }
+
+    free(buf);
+    return CdsRestoreEnd(&dec, i == count);
+}
+
 
 /*===========================================================================*
  *               Implementation for internal operations                      *
  *===========================================================================*/
+void _HashMapTraverseChunk(void* arg, unsigned chunk, void* acc)
+{
+    TraverseTask* task = (TraverseTask*)arg;
+    HashMapData* data = task->data_;
+    uint64_t num_slot = data->num_slot_old_ + data->num_slot_;
+    unsigned begin = (unsigned)(num_slot * chunk / task->num_chunk_);
+    unsigned end = (unsigned)(num_slot * (chunk + 1) / task->num_chunk_);
+
+    const Reducer* reducer = task->reducer_;
+    unsigned i;
+    for (i = begin ; i < end ; ++i) {
+        SlotNode* curr = GET_ITER_SLOT(data, i);
+        while (curr) {
+            if (reducer)
+                reducer->accumulate(acc, &(curr->pair_), reducer->ctx);
+            else
+                task->func_visit_(&(curr->pair_), task->arg_);
+            curr = curr->next_;
+        }
+    }
+    return;
+}
+
 unsigned _HashMapHash(void* key)
 {
     return (unsigned)(intptr_t)key;
@@ -369,12 +1235,52 @@ int _HashMapCompare(void* lhs, void* rhs)
     return ((intptr_t)lhs > (intptr_t)rhs)? 1 : (-1);
 }
 
+unsigned _HashMapMix(unsigned hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+void _HashMapPrefetch(HashMapData* data, void** keys, unsigned* hashes,
+                      SlotNode*** slots, unsigned count)
+{
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        unsigned hash = HASH(data, keys[i]);
+        SlotNode** slot = GET_SLOT(data, hash);
+        prefetch(slot);
+        hashes[i] = hash;
+        slots[i] = slot;
+    }
+
+    for (i = 0 ; i < count ; ++i) {
+        SlotNode* head = *slots[i];
+        if (head)
+            prefetch(head);
+    }
+    return;
+}
+
 void _HashMapReHash(HashMapData* data)
 {
+    /* Finish the pending migration before the next extension. */
+    if (data->arr_slot_old_)
+        _HashMapMigrate(data, data->num_slot_old_);
+
     unsigned num_slot_new;
 
+    /* In power-of-two mode, simply double the slot array. */
+    if (data->pow2_) {
+        if (unlikely(data->num_slot_ > (UINT_MAX >> 1)))
+            return;
+        num_slot_new = data->num_slot_ << 1;
+    }
     /* Consume the next prime for slot array extension. */
-    if (likely(data->idx_prime_ < (num_prime - 1))) {
+    else if (likely(data->idx_prime_ < (num_prime - 1))) {
         ++(data->idx_prime_);
         num_slot_new = magic_primes[data->idx_prime_];
     }
@@ -385,20 +1291,41 @@ void _HashMapReHash(HashMapData* data)
         num_slot_new = data->num_slot_ * 3;
     }
 
-    /* Try to allocate the new slot array. The rehashing should be canceled due
-       to insufficient memory space.  */
-    SlotNode** arr_slot_new = (SlotNode**)malloc(sizeof(SlotNode*) * num_slot_new);
-    if (unlikely(!arr_slot_new)) {
-        if (data->idx_prime_ < num_prime)
+    /* The rehashing should be canceled due to insufficient memory space. */
+    if (unlikely(!_HashMapResize(data, num_slot_new, data->incremental_))) {
+        if (!data->pow2_ && data->idx_prime_ < num_prime)
             --(data->idx_prime_);
-        return;
     }
+    return;
+}
+
+bool _HashMapResize(HashMapData* data, unsigned num_slot_new, bool incremental)
+{
+    STATS_CLOCK(begin);
+    SlotNode** arr_slot_new = (SlotNode**)malloc(sizeof(SlotNode*) * num_slot_new);
+    if (unlikely(!arr_slot_new))
+        return false;
+    STATS_ADD(data, bytes_alloc, sizeof(SlotNode*) * num_slot_new);
+    STATS_ADD(data, num_rehash, 1);
 
     unsigned i;
     for (i = 0 ; i < num_slot_new ; ++i)
         arr_slot_new[i] = NULL;
 
-    HashMapHash func_hash = data->func_hash_;
+    /* In incremental mode, keep the old slot array for gradual migration. */
+    if (incremental) {
+        data->arr_slot_old_ = data->arr_slot_;
+        data->num_slot_old_ = data->num_slot_;
+        data->idx_migrate_ = 0;
+        data->arr_slot_ = arr_slot_new;
+        data->num_slot_ = num_slot_new;
+        data->curr_limit_ = (unsigned)((double)num_slot_new * data->load_factor_);
+        if (data->filter_)
+            _HashMapBuildFilter(data);
+        STATS_LAPSE(data, ns_rehash, begin);
+        return true;
+    }
+
     SlotNode** arr_slot = data->arr_slot_;
     unsigned num_slot = data->num_slot_;
     for (i = 0 ; i < num_slot ; ++i) {
@@ -408,9 +1335,10 @@ void _HashMapReHash(HashMapData* data)
             pred = curr;
             curr = curr->next_;
 
-            /* Migrate each key value pair to the new slot. */
-            unsigned hash = func_hash(pred->pair_.key);
-            hash = hash % num_slot_new;
+            /* Migrate each key value pair to the new slot with its cached
+               hash value. */
+            unsigned hash = pred->hash_;
+            hash = SLOT_INDEX(data, hash, num_slot_new);
             if (!arr_slot_new[hash]) {
                 pred->next_ = NULL;
                 arr_slot_new[hash] = pred;
@@ -424,6 +1352,106 @@ void _HashMapReHash(HashMapData* data)
     free(arr_slot);
     data->arr_slot_ = arr_slot_new;
     data->num_slot_ = num_slot_new;
-    data->curr_limit_ = (unsigned)((double)num_slot_new * load_factor);
+    data->curr_limit_ = (unsigned)((double)num_slot_new * data->load_factor_);
+    if (data->filter_)
+        _HashMapBuildFilter(data);
+    STATS_LAPSE(data, ns_rehash, begin);
+    return true;
+}
+
+unsigned _HashMapFitSlot(unsigned capacity, double factor, bool pow2,
+                         int* p_idx_prime)
+{
+    unsigned num_slot;
+    int idx_prime = 0;
+
+    /* In power-of-two mode, keep doubling the initial slot array. */
+    if (pow2) {
+        num_slot = pow2_init_slot;
+        while ((double)num_slot * factor < (double)capacity) {
+            if (unlikely(num_slot > (UINT_MAX >> 1)))
+                break;
+            num_slot <<= 1;
+        }
+    }
+    /* Otherwise, pick the smallest fitting prime. If the prime list is
+       completely consumed, keep trebling the largest one like the rehashing. */
+    else {
+        while (idx_prime < num_prime &&
+               (double)magic_primes[idx_prime] * factor < (double)capacity)
+            ++idx_prime;
+        if (idx_prime < num_prime)
+            num_slot = magic_primes[idx_prime];
+        else {
+            num_slot = magic_primes[num_prime - 1];
+            while ((double)num_slot * factor < (double)capacity) {
+                if (unlikely(num_slot > UINT_MAX / 3))
+                    break;
+                num_slot *= 3;
+            }
+        }
+    }
+
+    *p_idx_prime = idx_prime;
+    return num_slot;
+}
+
+void _HashMapMigrate(HashMapData* data, unsigned count)
+{
+    SlotNode** arr_slot = data->arr_slot_;
+    SlotNode** arr_slot_old = data->arr_slot_old_;
+    unsigned num_slot = data->num_slot_;
+    unsigned num_slot_old = data->num_slot_old_;
+    unsigned idx = data->idx_migrate_;
+
+    while (count > 0 && idx < num_slot_old) {
+        SlotNode* pred;
+        SlotNode* curr = arr_slot_old[idx];
+        while (curr) {
+            pred = curr;
+            curr = curr->next_;
+
+            /* Migrate each key value pair to the new slot with its cached
+               hash value. */
+            unsigned hash = pred->hash_;
+            hash = SLOT_INDEX(data, hash, num_slot);
+            pred->next_ = arr_slot[hash];
+            arr_slot[hash] = pred;
+        }
+        arr_slot_old[idx] = NULL;
+        ++idx;
+        --count;
+    }
+
+    if (idx < num_slot_old) {
+        data->idx_migrate_ = idx;
+        return;
+    }
+
+    free(arr_slot_old);
+    data->arr_slot_old_ = NULL;
+    data->num_slot_old_ = 0;
+    data->idx_migrate_ = 0;
     return;
 }
+
+bool _HashMapBuildFilter(HashMapData* data)
+{
+    unsigned size = (unsigned)data->size_;
+    unsigned capacity = (data->curr_limit_ > size)? data->curr_limit_ : size;
+    BloomFilter* filter = BloomFilterInit(capacity, filter_fp_rate);
+    if (unlikely(!filter))
+        return false;
+
+    unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        SlotNode* curr;
+        for (curr = GET_ITER_SLOT(data, i) ; curr ; curr = curr->next_)
+            BloomFilterAddHash(filter, curr->hash_);
+    }
+
+    BloomFilterDeinit(data->filter_);
+    data->filter_ = filter;
+    return true;
+}
@@ -22,6 +22,12 @@
  */
 
 #include "container/hash_set.h"
+#include "container/bloom_filter.h"
+#include "memory/pool.h"
+#include <pthread.h>
+#ifdef CDS_ENABLE_STATS
+#include <time.h>
+#endif
 
 
 /*===========================================================================*
@@ -33,12 +39,16 @@ static const unsigned magic_primes[] = {
     201326611, 402653189, 805306457, 1610612741,
 };
 static const int num_prime = sizeof(magic_primes) / sizeof(unsigned);
-static const double load_factor = 0.75;
+static const double default_load_factor = 0.75;
+static const unsigned pow2_init_slot = 1024;
+static const unsigned migrate_step = 4;
+static const double filter_fp_rate = 0.01;
 
 
 typedef struct _SlotNode {
     void* key_;
     struct _SlotNode* next_;
+    unsigned hash_;
 } SlotNode;
 
 struct _HashSetData {
@@ -47,13 +57,43 @@ struct _HashSetData {
     unsigned num_slot_;
     unsigned curr_limit_;
     unsigned iter_slot_;
+    unsigned num_slot_old_;
+    unsigned idx_migrate_;
+    bool incremental_;
+    bool pow2_;
+    double load_factor_;
     SlotNode** arr_slot_;
+    SlotNode** arr_slot_old_;
     SlotNode* iter_node_;
     HashSetHash func_hash_;
+    HashSetHash64 func_hash64_;
+    HashSetMix func_mix_;
     HashSetCompare func_cmp_;
     HashSetCleanKey func_clean_key_;
+    Allocator alloc_;
+    Pool* pool_;
+    BloomFilter* filter_;
+#ifdef CDS_ENABLE_STATS
+    HashSetStats stats_;
+#endif
 };
 
+typedef struct _AlgebraTask {
+    HashSetData* dst_;
+    HashSetData* src_;
+    unsigned begin_;
+    unsigned end_;
+    bool cached_;
+    bool keep_;
+    bool status_;
+    bool forked_;
+    pthread_t thread_;
+    SlotNode* drops_;
+    SlotNode* arr_miss_;
+    unsigned num_item_;
+    unsigned cap_miss_;
+} AlgebraTask;
+
 
 /*===========================================================================*
  *                  Definition for internal operations                       *
@@ -61,15 +101,165 @@ struct _HashSetData {
 #define likely(x)       __builtin_expect(!!(x), 1)
 #define unlikely(x)     __builtin_expect(!!(x), 0)
 
+/* The statistics counters are compiled out by default. They are updated with
+   relaxed atomics, so that the concurrent lookups of a set shared read-only by
+   several threads stay race free. */
+#ifdef CDS_ENABLE_STATS
+#define STATS_ADD(data, field, count) \
+    __atomic_fetch_add(&((data)->stats_.field), (count), __ATOMIC_RELAXED)
+#define STATS_CLOCK(var)        unsigned long long var = STATS_NOW()
+#define STATS_LAPSE(data, field, var) \
+    STATS_ADD(data, field, STATS_NOW() - (var))
+#else
+#define STATS_ADD(data, field, count)
+#define STATS_CLOCK(var)
+#define STATS_LAPSE(data, field, var)
+#endif
+
+#ifdef CDS_ENABLE_STATS
 /**
- * @brief Initialize the set with the specified slot size.
- *
- * @param idx_prime     The index to the array of magic primes
- *
- * @retval obj          The successfully constructed set
- * @retval NULL         Insufficient memory for set construction
+ * Read the monotonic clock in nanoseconds.
+ */
+static inline unsigned long long STATS_NOW()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return (unsigned long long)spec.tv_sec * 1000000000ULL + spec.tv_nsec;
+}
+#endif
+
+/**
+ * Calculate the hash value of the given key. In power-of-two mode, the value is
+ * further scrambled by the finalizer mix since only its low bits are used. The
+ * 64 bit hash value is folded.
+ */
+static inline unsigned HASH(HashSetData* data, void* key)
+{
+    unsigned hash;
+    if (likely(data->func_hash_ != NULL))
+        hash = data->func_hash_(key);
+    else {
+        uint64_t wide = data->func_hash64_(key);
+        hash = (unsigned)(wide ^ (wide >> 32));
+    }
+    if (data->pow2_ && data->func_mix_)
+        hash = data->func_mix_(hash);
+    return hash;
+}
+
+/**
+ * Map the hash value to the slot index.
+ */
+static inline unsigned SLOT_INDEX(HashSetData* data, unsigned hash, unsigned num_slot)
+{
+    if (data->pow2_)
+        return hash & (num_slot - 1);
+    return hash % num_slot;
+}
+
+/**
+ * Locate the slot list which should contain the key with the given hash. While
+ * an incremental rehashing is in progress, the keys belonged to the not yet
+ * migrated slots still reside in the old slot array.
+ */
+static inline SlotNode** GET_SLOT(HashSetData* data, unsigned hash)
+{
+    if (unlikely(data->arr_slot_old_ != NULL)) {
+        unsigned idx = SLOT_INDEX(data, hash, data->num_slot_old_);
+        if (idx >= data->idx_migrate_)
+            return data->arr_slot_old_ + idx;
+    }
+    return data->arr_slot_ + SLOT_INDEX(data, hash, data->num_slot_);
+}
+
+/**
+ * Check if the hash values cached by the source set can be reused by the
+ * designated one.
+ */
+static inline bool SAME_HASH(HashSetData* dst, HashSetData* src)
+{
+    if (dst->func_hash_ != src->func_hash_ ||
+        dst->func_hash64_ != src->func_hash64_ || dst->pow2_ != src->pow2_)
+        return false;
+    return !dst->pow2_ || dst->func_mix_ == src->func_mix_;
+}
+
+/**
+ * Return the hash value of the key held by the node of another set for the
+ * designated set. The cached one is reused if both sets hash alike.
+ */
+static inline unsigned HASH_OF(HashSetData* data, SlotNode* node, bool cached)
+{
+    return (cached)? node->hash_ : HASH(data, node->key_);
+}
+
+/**
+ * Check if the key with the given hash may be stored in the set.
+ */
+static inline bool MAY_CONTAIN(HashSetData* data, unsigned hash)
+{
+    return !data->filter_ || BloomFilterContainHash(data->filter_, hash);
+}
+
+/**
+ * Locate the link which points to the node holding the given key.
+ */
+static inline SlotNode** LOCATE(HashSetData* data, void* key, unsigned hash)
+{
+    if (!MAY_CONTAIN(data, hash))
+        return NULL;
+
+    HashSetCompare func_cmp = data->func_cmp_;
+    SlotNode** link = GET_SLOT(data, hash);
+    while (*link) {
+        SlotNode* curr = *link;
+        if (curr->hash_ == hash && func_cmp(key, curr->key_) == 0)
+            return link;
+        link = &(curr->next_);
+    }
+    return NULL;
+}
+
+/**
+ * Allocate the slot node via the designated allocator.
+ */
+static inline SlotNode* NEW_NODE(HashSetData* data)
+{
+    STATS_ADD(data, bytes_alloc, sizeof(SlotNode));
+    return (SlotNode*)data->alloc_.alloc(data->alloc_.ctx, sizeof(SlotNode));
+}
+
+/**
+ * Release the slot node via the designated allocator.
  */
-HashSet* _HashSetInit(int idx_prime);
+static inline void DELETE_NODE(HashSetData* data, SlotNode* node)
+{
+    data->alloc_.free(data->alloc_.ctx, node);
+}
+
+/**
+ * Link the new node to the slot list and record its hash value in the filter.
+ */
+static inline void LINK_NODE(HashSetData* data, SlotNode** slot, SlotNode* node)
+{
+    node->next_ = *slot;
+    *slot = node;
+    ++(data->size_);
+    if (data->filter_)
+        BloomFilterAddHash(data->filter_, node->hash_);
+}
+
+/**
+ * Return the slot list pointed by the iterator. The old slot array, if any, is
+ * visited before the current one.
+ */
+static inline SlotNode* GET_ITER_SLOT(HashSetData* data, unsigned iter)
+{
+    unsigned num_slot_old = data->num_slot_old_;
+    if (iter < num_slot_old)
+        return data->arr_slot_old_[iter];
+    return data->arr_slot_[iter - num_slot_old];
+}
 
 /**
  * @brief The default hash function.
@@ -92,20 +282,236 @@ unsigned _HashSetHash(void* key);
  */
 int _HashSetCompare(void* lhs, void* rhs);
 
+/**
+ * @brief The default finalizer mix applied in power-of-two mode.
+ *
+ * This is the 32 bit finalizer of MurMur3 which spreads the entropy of the
+ * high bits to the low ones.
+ *
+ * @param hash          The hash value calculated by the hash function
+ *
+ * @retval Hash         The scrambled hash value
+ */
+unsigned _HashSetMix(unsigned hash);
+
 /**
  * @brief Extend the slot array and re-distribute the stored keys.
  *
- * @param data          The pointer to the map private data
+ * In incremental mode, this function only allocates the new slot array. The
+ * stored keys are then migrated step by step via _HashSetMigrate.
+ *
+ * @param data          The pointer to the set private data
  */
 void _HashSetReHash(HashSetData* data);
 
+/**
+ * @brief Allocate a slot array with the designated size and re-distribute the
+ * stored keys to it.
+ *
+ * @param data          The pointer to the set private data
+ * @param num_slot_new  The size of the new slot array
+ * @param incremental   Whether to keep the old slot array for the incremental
+ *                      migration
+ *
+ * @retval true         The slot array is successfully replaced
+ * @retval false        Insufficient memory for the new slot array
+ */
+bool _HashSetResize(HashSetData* data, unsigned num_slot_new, bool incremental);
+
+/**
+ * @brief Calculate the slot array size which can hold the designated number
+ * of keys without extension.
+ *
+ * @param capacity      The designated number of keys
+ * @param factor        The loading factor
+ * @param pow2          Whether the power-of-two slot array is applied
+ * @param p_idx_prime   The pointer to the returned index to the magic primes
+ *
+ * @retval num_slot     The required slot array size
+ */
+unsigned _HashSetFitSlot(unsigned capacity, double factor, bool pow2,
+                         int* p_idx_prime);
+
+/**
+ * @brief Migrate the designated number of slot lists from the old slot array
+ * to the current one.
+ *
+ * The old slot array is released once all of its slot lists are migrated.
+ *
+ * @param data          The pointer to the set private data
+ * @param count         The number of slot lists to migrate
+ */
+void _HashSetMigrate(HashSetData* data, unsigned count);
+
+/**
+ * @brief Rebuild the filter from the cached hash values of the stored keys.
+ *
+ * The new filter is sized with the current slot array. If it cannot be
+ * allocated, the old filter is kept since it still covers all the stored keys.
+ *
+ * @param data          The pointer to the set private data
+ *
+ * @retval true         The filter is successfully rebuilt
+ * @retval false        Insufficient memory for the new filter
+ */
+bool _HashSetBuildFilter(HashSetData* data);
+
+/**
+ * @brief Clean the keys and release the nodes of the given node chain.
+ *
+ * @param data          The pointer to the set private data
+ * @param chain         The first node of the chain
+ */
+bool _HashSetBuildFilter(HashSetData* data)
+{
+    unsigned capacity = (data->curr_limit_ > data->size_)?
+                        data->curr_limit_ : data->size_;
+    BloomFilter* filter = BloomFilterInit(capacity, filter_fp_rate);
+    if (unlikely(!filter))
+        return false;
+
+    unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        SlotNode* curr;
+        for (curr = GET_ITER_SLOT(data, i) ; curr ; curr = curr->next_)
+            BloomFilterAddHash(filter, curr->hash_);
+    }
+
+    BloomFilterDeinit(data->filter_);
+    data->filter_ = filter;
+    return true;
+}
+
+void _HashSetDrop(HashSetData* data, SlotNode* chain);
+
+/**
+ * @brief Partition the slot array into equal ranges and scan them concurrently.
+ *
+ * The last range is scanned by the calling thread. If a thread cannot be
+ * created, its range is also scanned by the calling thread.
+ *
+ * @param tasks         The array of the prepared tasks
+ * @param count         The number of tasks
+ * @param num_slot      The size of the partitioned slot array
+ * @param func          The routine to scan a single range
+ */
+void _HashSetDispatch(AlgebraTask* tasks, unsigned count, unsigned num_slot,
+                      void* (*func) (void*));
+
+/**
+ * @brief Collect the keys of the source slot range which are absent from the
+ * designated set.
+ *
+ * @param arg           The pointer to the AlgebraTask structure
+ *
+ * @retval NULL         The collected keys are stored in the task
+ */
+void* _HashSetMergeTask(void* arg);
+
+/**
+ * @brief Unlink the nodes of the designated slot range whose keys are present
+ * in (or absent from) the source set.
+ *
+ * @param arg           The pointer to the AlgebraTask structure
+ *
+ * @retval NULL         The unlinked nodes are chained in the task
+ */
+void* _HashSetFilterTask(void* arg);
+
+/**
+ * @brief Keep or drop the keys of the designated set which are also present in
+ * the source set.
+ *
+ * @param dst           The pointer to the designated set private data
+ * @param src           The pointer to the source set private data
+ * @param keep          Keep the common keys if true, drop them otherwise
+ * @param num_thread    The maximum number of concurrently running threads
+ */
+void _HashSetFilter(HashSetData* dst, HashSetData* src, bool keep,
+                    unsigned num_thread);
+
 
 /*===========================================================================*
  *               Implementation for the exported operations                  *
  *===========================================================================*/
 HashSet* HashSetInit()
 {
-    return _HashSetInit(0);
+    return HashSetInitWithCapacity(0);
+}
+
+HashSet* HashSetInitWithCapacity(unsigned capacity)
+{
+    HashSet* obj = (HashSet*)malloc(sizeof(HashSet));
+    if (unlikely(!obj))
+        return NULL;
+
+    HashSetData* data = (HashSetData*)malloc(sizeof(HashSetData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    int idx_prime;
+    unsigned num_slot = _HashSetFitSlot(capacity, default_load_factor, false,
+                                       &idx_prime);
+    SlotNode** arr_slot = (SlotNode**)malloc(sizeof(SlotNode*) * num_slot);
+    if (unlikely(!arr_slot)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i)
+        arr_slot[i] = NULL;
+
+    data->size_ = 0;
+    data->idx_prime_ = idx_prime;
+    data->num_slot_ = num_slot;
+    data->curr_limit_ = (unsigned)((double)num_slot * default_load_factor);
+    data->num_slot_old_ = 0;
+    data->idx_migrate_ = 0;
+    data->incremental_ = false;
+    data->pow2_ = false;
+    data->load_factor_ = default_load_factor;
+    data->arr_slot_ = arr_slot;
+    data->arr_slot_old_ = NULL;
+    data->func_hash_ = _HashSetHash;
+    data->func_hash64_ = NULL;
+    data->func_mix_ = _HashSetMix;
+    data->func_cmp_ = _HashSetCompare;
+    data->func_clean_key_ = NULL;
+    data->alloc_ = *CdsGetAllocator();
+    data->pool_ = NULL;
+    data->filter_ = NULL;
+#ifdef CDS_ENABLE_STATS
+    memset(&(data->stats_), 0, sizeof(HashSetStats));
+    data->stats_.instrumented = true;
+#endif
+    STATS_ADD(data, bytes_alloc, sizeof(SlotNode*) * num_slot);
+
+    obj->data = data;
+    obj->add = HashSetAdd;
+    obj->find = HashSetFind;
+    obj->remove = HashSetRemove;
+    obj->size = HashSetSize;
+    obj->first = HashSetFirst;
+    obj->next = HashSetNext;
+    obj->set_hash = HashSetSetHash;
+    obj->set_hash64 = HashSetSetHash64;
+    obj->set_compare = HashSetSetCompare;
+    obj->set_clean_key = HashSetSetCleanKey;
+    obj->set_incremental_rehash = HashSetSetIncrementalReHash;
+    obj->set_power_of_two = HashSetSetPowerOfTwo;
+    obj->set_mix = HashSetSetMix;
+    obj->set_load_factor = HashSetSetLoadFactor;
+    obj->set_allocator = HashSetSetAllocator;
+    obj->use_pool = HashSetUsePool;
+    obj->reserve = HashSetReserve;
+    obj->use_filter = HashSetUseFilter;
+    obj->get_stats = HashSetGetStats;
+
+    return obj;
 }
 
 void HashSetDeinit(HashSet* obj)
@@ -114,24 +520,33 @@ void HashSetDeinit(HashSet* obj)
         return;
 
     HashSetData* data = obj->data;
-    SlotNode** arr_slot = data->arr_slot_;
     HashSetCleanKey func_clean_key = data->func_clean_key_;
 
-    unsigned num_slot = data->num_slot_;
-    unsigned i;
-    for (i = 0 ; i < num_slot ; ++i) {
-        SlotNode* pred;
-        SlotNode* curr = arr_slot[i];
-        while (curr) {
-            pred = curr;
-            curr = curr->next_;
-            if (func_clean_key)
-                func_clean_key(pred->key_);
-            free(pred);
+    /* The pooled nodes are released at once, so the slot lists are traversed
+       only for the key cleanup. */
+    Pool* pool = data->pool_;
+    if (!pool || func_clean_key) {
+        unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+        unsigned i;
+        for (i = 0 ; i < num_slot ; ++i) {
+            SlotNode* pred;
+            SlotNode* curr = GET_ITER_SLOT(data, i);
+            while (curr) {
+                pred = curr;
+                curr = curr->next_;
+                if (func_clean_key)
+                    func_clean_key(pred->key_);
+                if (!pool)
+                    DELETE_NODE(data, pred);
+            }
         }
     }
+    if (pool)
+        PoolDeinit(pool);
 
-    free(arr_slot);
+    BloomFilterDeinit(data->filter_);
+    free(data->arr_slot_old_);
+    free(data->arr_slot_);
     free(data);
     free(obj);
     return;
@@ -143,18 +558,21 @@ bool HashSetAdd(HashSet* self, void* key)
     HashSetData* data = self->data;
     if (data->size_ >= data->curr_limit_)
         _HashSetReHash(data);
+    if (unlikely(data->arr_slot_old_ != NULL))
+        _HashSetMigrate(data, migrate_step);
 
-    /* Calculate the slot index. */
-    unsigned hash = data->func_hash_(key);
-    hash = hash % data->num_slot_;
+    /* Locate the slot list. */
+    unsigned hash = HASH(data, key);
+    SlotNode** slot = GET_SLOT(data, hash);
+    STATS_ADD(data, num_lookup, 1);
 
     /* Check if the key conflicts with a certain one stored in the set. If yes,
        replace that one. */
     HashSetCompare func_cmp = data->func_cmp_;
-    SlotNode** arr_slot = data->arr_slot_;
-    SlotNode* curr = arr_slot[hash];
+    SlotNode* curr = *slot;
     while (curr) {
-        if (func_cmp(key, curr->key_) == 0) {
+        STATS_ADD(data, num_probe, 1);
+        if (curr->hash_ == hash && func_cmp(key, curr->key_) == 0) {
             if (data->func_clean_key_)
                 data->func_clean_key_(curr->key_);
             curr->key_ = key;
@@ -164,19 +582,13 @@ bool HashSetAdd(HashSet* self, void* key)
     }
 
     /* Insert the new key into the slot list. */
-    SlotNode* node = (SlotNode*)malloc(sizeof(SlotNode));
+    SlotNode* node = NEW_NODE(data);
     if (unlikely(!node))
         return false;
 
     node->key_ = key;
-    if (!(arr_slot[hash])) {
-        node->next_ = NULL;
-        arr_slot[hash] = node;
-    } else {
-        node->next_ = arr_slot[hash];
-        arr_slot[hash] = node;
-    }
-    ++(data->size_);
+    node->hash_ = hash;
+    LINK_NODE(data, slot, node);
 
     return true;
 }
@@ -184,16 +596,23 @@ bool HashSetAdd(HashSet* self, void* key)
 bool HashSetFind(HashSet* self, void* key)
 {
     HashSetData* data = self->data;
-
-    /* Calculate the slot index. */
-    unsigned hash = data->func_hash_(key);
-    hash = hash % data->num_slot_;
+    if (unlikely(data->arr_slot_old_ != NULL))
+        _HashSetMigrate(data, migrate_step);
+
+    /* Reject the absent key via the filter, and then locate the slot
+       list. */
+    unsigned hash = HASH(data, key);
+    STATS_ADD(data, num_lookup, 1);
+    if (!MAY_CONTAIN(data, hash))
+        return false;
+    SlotNode** slot = GET_SLOT(data, hash);
 
     /* Search the slot list to check if the specified key exists. */
     HashSetCompare func_cmp = data->func_cmp_;
-    SlotNode* curr = data->arr_slot_[hash];
+    SlotNode* curr = *slot;
     while (curr) {
-        if (func_cmp(key, curr->key_) == 0)
+        STATS_ADD(data, num_probe, 1);
+        if (curr->hash_ == hash && func_cmp(key, curr->key_) == 0)
             return true;
         curr = curr->next_;
     }
@@ -204,27 +623,33 @@ bool HashSetFind(HashSet* self, void* key)
 bool HashSetRemove(HashSet* self, void* key)
 {
     HashSetData* data = self->data;
-
-    /* Calculate the slot index. */
-    unsigned hash = data->func_hash_(key);
-    hash = hash % data->num_slot_;
+    if (unlikely(data->arr_slot_old_ != NULL))
+        _HashSetMigrate(data, migrate_step);
+
+    /* Reject the absent key via the filter, and then locate the slot
+       list. */
+    unsigned hash = HASH(data, key);
+    STATS_ADD(data, num_lookup, 1);
+    if (!MAY_CONTAIN(data, hash))
+        return false;
+    SlotNode** slot = GET_SLOT(data, hash);
 
     /* Search the slot list for the remove target. */
     HashSetCompare func_cmp = data->func_cmp_;
     SlotNode* pred = NULL;
-    SlotNode** arr_slot = data->arr_slot_;
-    SlotNode* curr = arr_slot[hash];
+    SlotNode* curr = *slot;
     while (curr) {
-        if (func_cmp(key, curr->key_) == 0) {
+        STATS_ADD(data, num_probe, 1);
+        if (curr->hash_ == hash && func_cmp(key, curr->key_) == 0) {
             if (data->func_clean_key_)
                 data->func_clean_key_(curr->key_);
 
             if (!pred)
-                arr_slot[hash] = curr->next_;
+                *slot = curr->next_;
             else
                 pred->next_ = curr->next_;
 
-            free(curr);
+            DELETE_NODE(data, curr);
             --(data->size_);
             return true;
         }
@@ -244,7 +669,7 @@ void HashSetFirst(HashSet* self)
 {
     HashSetData* data = self->data;
     data->iter_slot_ = 0;
-    data->iter_node_ = data->arr_slot_[0];
+    data->iter_node_ = GET_ITER_SLOT(data, 0);
     return;
 }
 
@@ -252,24 +677,62 @@ void* HashSetNext(HashSet* self)
 {
     HashSetData* data = self->data;
 
-    SlotNode** arr_slot = data->arr_slot_;
-    while (data->iter_slot_ < data->num_slot_) {
+    unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+    while (data->iter_slot_ < num_slot) {
         if (data->iter_node_) {
             void* key = data->iter_node_->key_;
             data->iter_node_ = data->iter_node_->next_;
             return key;
         }
         ++(data->iter_slot_);
-        if (data->iter_slot_ == data->num_slot_)
+        if (data->iter_slot_ == num_slot)
             break;
-        data->iter_node_ = arr_slot[data->iter_slot_];
+        data->iter_node_ = GET_ITER_SLOT(data, data->iter_slot_);
     }
     return NULL;
 }
 
+void HashSetIterInit(HashSet* self, HashSetIter* iter)
+{
+    HashSetData* data = self->data;
+    iter->data_ = data;
+    iter->slot_ = 0;
+    iter->node_ = GET_ITER_SLOT(data, 0);
+    return;
+}
+
+void* HashSetIterNext(HashSetIter* iter)
+{
+    HashSetData* data = iter->data_;
+    SlotNode* node = (SlotNode*)iter->node_;
+    unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+    unsigned slot = iter->slot_;
+
+    while (!node) {
+        ++slot;
+        if (slot >= num_slot) {
+            iter->slot_ = num_slot;
+            return NULL;
+        }
+        node = GET_ITER_SLOT(data, slot);
+    }
+
+    iter->slot_ = slot;
+    iter->node_ = node->next_;
+    return node->key_;
+}
+
 void HashSetSetHash(HashSet* self, HashSetHash func)
 {
     self->data->func_hash_ = func;
+    self->data->func_hash64_ = NULL;
+}
+
+void HashSetSetHash64(HashSet* self, HashSetHash64 func)
+{
+    HashSetData* data = self->data;
+    data->func_hash64_ = func;
+    data->func_hash_ = (func)? NULL : _HashSetHash;
 }
 
 void HashSetSetCompare(HashSet* self, HashSetCompare func)
@@ -282,29 +745,186 @@ void HashSetSetCleanKey(HashSet* self, HashSetCleanKey func)
     self->data->func_clean_key_ = func;
 }
 
+void HashSetSetIncrementalReHash(HashSet* self, bool enable)
+{
+    HashSetData* data = self->data;
+    data->incremental_ = enable;
+
+    /* Finish the pending migration when switching back to one-shot mode. */
+    if (!enable && data->arr_slot_old_)
+        _HashSetMigrate(data, data->num_slot_old_);
+}
+
+bool HashSetSetPowerOfTwo(HashSet* self, bool enable)
+{
+    HashSetData* data = self->data;
+    if (data->pow2_ == enable)
+        return true;
+
+    /* The slot layout can only be switched while the set is empty. */
+    if (data->size_ > 0)
+        return false;
+
+    unsigned num_slot = (enable)? pow2_init_slot : magic_primes[0];
+    SlotNode** arr_slot = (SlotNode**)malloc(sizeof(SlotNode*) * num_slot);
+    if (unlikely(!arr_slot))
+        return false;
+    STATS_ADD(data, bytes_alloc, sizeof(SlotNode*) * num_slot);
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i)
+        arr_slot[i] = NULL;
+
+    free(data->arr_slot_old_);
+    free(data->arr_slot_);
+    data->arr_slot_ = arr_slot;
+    data->arr_slot_old_ = NULL;
+    data->num_slot_ = num_slot;
+    data->num_slot_old_ = 0;
+    data->idx_migrate_ = 0;
+    data->idx_prime_ = 0;
+    data->pow2_ = enable;
+    data->curr_limit_ = (unsigned)((double)num_slot * data->load_factor_);
+    if (data->filter_)
+        _HashSetBuildFilter(data);
+    return true;
+}
+
+void HashSetSetMix(HashSet* self, HashSetMix func)
+{
+    self->data->func_mix_ = func;
+}
+
+bool HashSetSetLoadFactor(HashSet* self, double factor)
+{
+    if (!(factor > 0))
+        return false;
+
+    HashSetData* data = self->data;
+    data->load_factor_ = factor;
+    data->curr_limit_ = (unsigned)((double)data->num_slot_ * factor);
+    return true;
+}
+
+bool HashSetSetAllocator(HashSet* self, const Allocator* alloc)
+{
+    HashSetData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    if (data->pool_) {
+        PoolDeinit(data->pool_);
+        data->pool_ = NULL;
+    }
+    data->alloc_ = (alloc)? *alloc : *CdsGetAllocator();
+    return true;
+}
+
+bool HashSetUsePool(HashSet* self)
+{
+    HashSetData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    Pool* pool = PoolInit(sizeof(SlotNode));
+    if (unlikely(!pool))
+        return false;
+
+    if (data->pool_)
+        PoolDeinit(data->pool_);
+    data->pool_ = pool;
+    PoolGetAllocator(pool, &(data->alloc_));
+    return true;
+}
+
+bool HashSetReserve(HashSet* self, unsigned capacity)
+{
+    HashSetData* data = self->data;
+
+    /* The slot array is replaced at once, so any pending migration should be
+       finished first. */
+    if (data->arr_slot_old_)
+        _HashSetMigrate(data, data->num_slot_old_);
+
+    int idx_prime;
+    unsigned num_slot = _HashSetFitSlot(capacity, data->load_factor_, data->pow2_,
+                                       &idx_prime);
+    if (num_slot <= data->num_slot_)
+        return true;
+
+    if (unlikely(!_HashSetResize(data, num_slot, false)))
+        return false;
+    if (!data->pow2_)
+        data->idx_prime_ = idx_prime;
+    return true;
+}
+
+bool HashSetUseFilter(HashSet* self, bool enable)
+{
+    HashSetData* data = self->data;
+    if (!enable) {
+        BloomFilterDeinit(data->filter_);
+        data->filter_ = NULL;
+        return true;
+    }
+    if (data->filter_)
+        return true;
+    return _HashSetBuildFilter(data);
+}
+
+void HashSetGetStats(HashSet* self, HashSetStats* p_stats)
+{
+    HashSetData* data = self->data;
+#ifdef CDS_ENABLE_STATS
+    *p_stats = data->stats_;
+#else
+    memset(p_stats, 0, sizeof(HashSetStats));
+#endif
+
+    unsigned num_slot = data->num_slot_old_ + data->num_slot_;
+    p_stats->size = data->size_;
+    p_stats->num_slot = num_slot;
+    p_stats->load_factor = (double)data->size_ / num_slot;
+    p_stats->max_chain = 0;
+    memset(p_stats->chains, 0, sizeof(p_stats->chains));
+
+    /* Walk each slot list for the chain length distribution. */
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        unsigned len = 0;
+        SlotNode* curr;
+        for (curr = GET_ITER_SLOT(data, i) ; curr ; curr = curr->next_)
+            ++len;
+        if (len > p_stats->max_chain)
+            p_stats->max_chain = len;
+        if (len >= CDS_STATS_NUM_CHAIN)
+            len = CDS_STATS_NUM_CHAIN - 1;
+        ++(p_stats->chains[len]);
+    }
+    return;
+}
+
 HashSet* HashSetUnion(HashSet* lhs, HashSet* rhs)
 {
-    /* Predict the required slot size for the result set. */
+    /* The source sets are scanned via their slot arrays directly, so any
+       pending migration should be finished first. */
+    if (lhs->data->arr_slot_old_)
+        _HashSetMigrate(lhs->data, lhs->data->num_slot_old_);
+    if (rhs->data->arr_slot_old_)
+        _HashSetMigrate(rhs->data, rhs->data->num_slot_old_);
+
+    /* Predict the required capacity for the result set. */
     unsigned size_lhs = lhs->data->size_;
     unsigned size_rhs = rhs->data->size_;
-    unsigned size_slot = (unsigned)((double)(size_lhs + size_rhs) / load_factor);
-    int idx_prime = 0;
-    while (idx_prime < num_prime) {
-        if (size_slot < magic_primes[idx_prime])
-            break;
-        ++idx_prime;
-    }
-    if (idx_prime == num_prime)
-        --idx_prime;
 
     /* Initialize the result set. */
-    HashSet* result = _HashSetInit(idx_prime);
+    HashSet* result = HashSetInitWithCapacity(size_lhs + size_rhs);
     if (!result)
         return NULL;
 
     HashSetData* data_lhs = lhs->data;
     HashSetData* data_result = result->data;
     data_result->func_hash_ = data_lhs->func_hash_;
+    data_result->func_hash64_ = data_lhs->func_hash64_;
     data_result->func_cmp_ = data_lhs->func_cmp_;
 
     /* Collect the first source set. */
@@ -348,7 +968,14 @@ HashSet* HashSetUnion(HashSet* lhs, HashSet* rhs)
 
 HashSet* HashSetIntersect(HashSet* lhs, HashSet* rhs)
 {
-    /* Predict the required slot size for the result set. */
+    /* The source sets are scanned via their slot arrays directly, so any
+       pending migration should be finished first. */
+    if (lhs->data->arr_slot_old_)
+        _HashSetMigrate(lhs->data, lhs->data->num_slot_old_);
+    if (rhs->data->arr_slot_old_)
+        _HashSetMigrate(rhs->data, rhs->data->num_slot_old_);
+
+    /* Predict the required capacity for the result set. */
     unsigned size_lhs = lhs->data->size_;
     unsigned size_rhs = rhs->data->size_;
     unsigned size_elem;
@@ -362,24 +989,16 @@ HashSet* HashSetIntersect(HashSet* lhs, HashSet* rhs)
         set_src = rhs;
         set_tge = lhs;
     }
-    unsigned size_slot = (unsigned)((double)size_elem / load_factor);
-    int idx_prime = 0;
-    while (idx_prime < num_prime) {
-        if (size_slot < magic_primes[idx_prime])
-            break;
-        ++idx_prime;
-    }
-    if (idx_prime == num_prime)
-        --idx_prime;
 
     /* Initialize the result set. */
-    HashSet* result = _HashSetInit(idx_prime);
+    HashSet* result = HashSetInitWithCapacity(size_elem);
     if (!result)
         return NULL;
 
     HashSetData* data_src = set_src->data;
     HashSetData* data_result = result->data;
     data_result->func_hash_ = data_src->func_hash_;
+    data_result->func_hash64_ = data_src->func_hash64_;
     data_result->func_cmp_ = data_src->func_cmp_;
 
     /* Collect the keys belonged to both source sets. */
@@ -409,28 +1028,27 @@ HashSet* HashSetIntersect(HashSet* lhs, HashSet* rhs)
 
 HashSet* HashSetDifference(HashSet* lhs, HashSet* rhs)
 {
-    /* Predict the required slot size for the result set. */
+    /* The source sets are scanned via their slot arrays directly, so any
+       pending migration should be finished first. */
+    if (lhs->data->arr_slot_old_)
+        _HashSetMigrate(lhs->data, lhs->data->num_slot_old_);
+    if (rhs->data->arr_slot_old_)
+        _HashSetMigrate(rhs->data, rhs->data->num_slot_old_);
+
+    /* Predict the required capacity for the result set. */
     unsigned size_lhs = lhs->data->size_;
     unsigned size_rhs = rhs->data->size_;
     unsigned size_elem = (size_lhs > size_rhs)? size_lhs : size_rhs;
-    unsigned size_slot = (unsigned)((double)size_elem / load_factor);
-    int idx_prime = 0;
-    while (idx_prime < num_prime) {
-        if (size_slot < magic_primes[idx_prime])
-            break;
-        ++idx_prime;
-    }
-    if (idx_prime == num_prime)
-        --idx_prime;
 
     /* Create the result set. */
-    HashSet* result = _HashSetInit(idx_prime);
+    HashSet* result = HashSetInitWithCapacity(size_elem);
     if (!result)
         return NULL;
 
     HashSetData* data_lhs = lhs->data;
     HashSetData* data_result = result->data;
     data_result->func_hash_ = data_lhs->func_hash_;
+    data_result->func_hash64_ = data_lhs->func_hash64_;
     data_result->func_cmp_ = data_lhs->func_cmp_;
 
     /* Collect the keys only belonged to the first source set. */
@@ -458,55 +1076,142 @@ HashSet* HashSetDifference(HashSet* lhs, HashSet* rhs)
     return result;
 }
 
+bool HashSetUnionInto(HashSet* lhs, HashSet* rhs)
+{
+    if (lhs == rhs)
+        return true;
+
+    /* The source set is scanned via its slot array directly, so any pending
+       migration should be finished first. */
+    HashSetData* dst = lhs->data;
+    HashSetData* src = rhs->data;
+    if (src->arr_slot_old_)
+        _HashSetMigrate(src, src->num_slot_old_);
+
+    bool cached = SAME_HASH(dst, src);
+    SlotNode** arr_slot = src->arr_slot_;
+    unsigned num_slot = src->num_slot_;
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        SlotNode* curr;
+        for (curr = arr_slot[i] ; curr ; curr = curr->next_) {
+            if (dst->size_ >= dst->curr_limit_)
+                _HashSetReHash(dst);
+            if (unlikely(dst->arr_slot_old_ != NULL))
+                _HashSetMigrate(dst, migrate_step);
+
+            /* The key already stored in the designated set is kept. */
+            unsigned hash = HASH_OF(dst, curr, cached);
+            if (LOCATE(dst, curr->key_, hash))
+                continue;
 
-/*===========================================================================*
- *               Implementation for internal operations                      *
- *===========================================================================*/
-HashSet* _HashSetInit(int idx_prime)
+            SlotNode* node = NEW_NODE(dst);
+            if (unlikely(!node))
+                return false;
+
+            node->key_ = curr->key_;
+            node->hash_ = hash;
+            LINK_NODE(dst, GET_SLOT(dst, hash), node);
+        }
+    }
+
+    return true;
+}
+
+bool HashSetUnionIntoParallel(HashSet* lhs, HashSet* rhs, unsigned num_thread)
 {
-    HashSet* obj = (HashSet*)malloc(sizeof(HashSet));
-    if (unlikely(!obj))
-        return NULL;
+    if (lhs == rhs)
+        return true;
+    if (num_thread <= 1)
+        return HashSetUnionInto(lhs, rhs);
+
+    /* Both sets are scanned concurrently without migration, so any pending
+       migration should be finished first. */
+    HashSetData* dst = lhs->data;
+    HashSetData* src = rhs->data;
+    if (dst->arr_slot_old_)
+        _HashSetMigrate(dst, dst->num_slot_old_);
+    if (src->arr_slot_old_)
+        _HashSetMigrate(src, src->num_slot_old_);
+
+    AlgebraTask* tasks = (AlgebraTask*)malloc(sizeof(AlgebraTask) * num_thread);
+    if (unlikely(!tasks))
+        return false;
 
-    HashSetData* data = (HashSetData*)malloc(sizeof(HashSetData));
-    if (unlikely(!data)) {
-        free(obj);
-        return NULL;
+    /* Collect the absent keys of each source slot range concurrently. */
+    bool cached = SAME_HASH(dst, src);
+    unsigned i;
+    for (i = 0 ; i < num_thread ; ++i) {
+        tasks[i].dst_ = dst;
+        tasks[i].src_ = src;
+        tasks[i].cached_ = cached;
+        tasks[i].status_ = true;
+        tasks[i].arr_miss_ = NULL;
+        tasks[i].num_item_ = 0;
+        tasks[i].cap_miss_ = 0;
     }
+    _HashSetDispatch(tasks, num_thread, src->num_slot_, _HashSetMergeTask);
 
-    SlotNode** arr_slot = (SlotNode**)malloc(sizeof(SlotNode*) * magic_primes[0]);
-    if (unlikely(!arr_slot)) {
-        free(data);
-        free(obj);
-        return NULL;
+    bool status = true;
+    unsigned num_miss = 0;
+    for (i = 0 ; i < num_thread ; ++i) {
+        status = status && tasks[i].status_;
+        num_miss += tasks[i].num_item_;
     }
-    unsigned i;
-    for (i = 0 ; i < magic_primes[0] ; ++i)
-        arr_slot[i] = NULL;
 
-    data->size_ = 0;
-    data->idx_prime_ = 0;
-    data->num_slot_ = magic_primes[0];
-    data->curr_limit_ = (unsigned)((double)magic_primes[0] * load_factor);
-    data->arr_slot_ = arr_slot;
-    data->func_hash_ = _HashSetHash;
-    data->func_cmp_ = _HashSetCompare;
-    data->func_clean_key_ = NULL;
+    /* The collected keys are distinct, so they are linked to the slot lists
+       without any further comparison. */
+    if (status)
+        status = HashSetReserve(lhs, dst->size_ + num_miss);
+    for (i = 0 ; i < num_thread ; ++i) {
+        SlotNode* arr_miss = tasks[i].arr_miss_;
+        unsigned num_item = tasks[i].num_item_;
+        unsigned j;
+        for (j = 0 ; status && j < num_item ; ++j) {
+            SlotNode* node = NEW_NODE(dst);
+            if (unlikely(!node)) {
+                status = false;
+                break;
+            }
+            SlotNode** slot = dst->arr_slot_ +
+                              SLOT_INDEX(dst, arr_miss[j].hash_, dst->num_slot_);
+            node->key_ = arr_miss[j].key_;
+            node->hash_ = arr_miss[j].hash_;
+            LINK_NODE(dst, slot, node);
+        }
+        free(arr_miss);
+    }
 
-    obj->data = data;
-    obj->add = HashSetAdd;
-    obj->find = HashSetFind;
-    obj->remove = HashSetRemove;
-    obj->size = HashSetSize;
-    obj->first = HashSetFirst;
-    obj->next = HashSetNext;
-    obj->set_hash = HashSetSetHash;
-    obj->set_compare = HashSetSetCompare;
-    obj->set_clean_key = HashSetSetCleanKey;
+    free(tasks);
+    return status;
+}
 
-    return obj;
+void HashSetRetain(HashSet* lhs, HashSet* rhs)
+{
+    if (lhs != rhs)
+        _HashSetFilter(lhs->data, rhs->data, true, 1);
+}
+
+void HashSetRetainParallel(HashSet* lhs, HashSet* rhs, unsigned num_thread)
+{
+    if (lhs != rhs)
+        _HashSetFilter(lhs->data, rhs->data, true, num_thread);
+}
+
+void HashSetSubtract(HashSet* lhs, HashSet* rhs)
+{
+    _HashSetFilter(lhs->data, rhs->data, false, 1);
 }
 
+void HashSetSubtractParallel(HashSet* lhs, HashSet* rhs, unsigned num_thread)
+{
+    _HashSetFilter(lhs->data, rhs->data, false, num_thread);
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
 unsigned _HashSetHash(void* key)
 {
     return (unsigned)(uintptr_t)key;
@@ -519,12 +1224,32 @@ int _HashSetCompare(void* lhs, void* rhs)
     return ((intptr_t)lhs > (intptr_t)rhs)? 1 : (-1);
 }
 
+unsigned _HashSetMix(unsigned hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
 void _HashSetReHash(HashSetData* data)
 {
+    /* Finish the pending migration before the next extension. */
+    if (data->arr_slot_old_)
+        _HashSetMigrate(data, data->num_slot_old_);
+
     unsigned num_slot_new;
 
+    /* In power-of-two mode, simply double the slot array. */
+    if (data->pow2_) {
+        if (unlikely(data->num_slot_ > (UINT_MAX >> 1)))
+            return;
+        num_slot_new = data->num_slot_ << 1;
+    }
     /* Consume the next prime for slot array extension. */
-    if (likely(data->idx_prime_ < (num_prime - 1))) {
+    else if (likely(data->idx_prime_ < (num_prime - 1))) {
         ++(data->idx_prime_);
         num_slot_new = magic_primes[data->idx_prime_];
     }
@@ -535,20 +1260,41 @@ void _HashSetReHash(HashSetData* data)
         num_slot_new = data->num_slot_ * 3;
     }
 
-    /* Try to allocate the new slot array. The rehashing should be canceled due
-       to insufficient memory space.  */
-    SlotNode** arr_slot_new = (SlotNode**)malloc(sizeof(SlotNode*) * num_slot_new);
-    if (unlikely(!arr_slot_new)) {
-        if (data->idx_prime_ < num_prime)
+    /* The rehashing should be canceled due to insufficient memory space. */
+    if (unlikely(!_HashSetResize(data, num_slot_new, data->incremental_))) {
+        if (!data->pow2_ && data->idx_prime_ < num_prime)
             --(data->idx_prime_);
-        return;
     }
+    return;
+}
+
+bool _HashSetResize(HashSetData* data, unsigned num_slot_new, bool incremental)
+{
+    STATS_CLOCK(begin);
+    SlotNode** arr_slot_new = (SlotNode**)malloc(sizeof(SlotNode*) * num_slot_new);
+    if (unlikely(!arr_slot_new))
+        return false;
+    STATS_ADD(data, bytes_alloc, sizeof(SlotNode*) * num_slot_new);
+    STATS_ADD(data, num_rehash, 1);
 
     unsigned i;
     for (i = 0 ; i < num_slot_new ; ++i)
         arr_slot_new[i] = NULL;
 
-    HashSetHash func_hash = data->func_hash_;
+    /* In incremental mode, keep the old slot array for gradual migration. */
+    if (incremental) {
+        data->arr_slot_old_ = data->arr_slot_;
+        data->num_slot_old_ = data->num_slot_;
+        data->idx_migrate_ = 0;
+        data->arr_slot_ = arr_slot_new;
+        data->num_slot_ = num_slot_new;
+        data->curr_limit_ = (unsigned)((double)num_slot_new * data->load_factor_);
+        if (data->filter_)
+            _HashSetBuildFilter(data);
+        STATS_LAPSE(data, ns_rehash, begin);
+        return true;
+    }
+
     SlotNode** arr_slot = data->arr_slot_;
     unsigned num_slot = data->num_slot_;
     for (i = 0 ; i < num_slot ; ++i) {
@@ -558,9 +1304,9 @@ void _HashSetReHash(HashSetData* data)
             pred = curr;
             curr = curr->next_;
 
-            /* Migrate each key value pair to the new slot. */
-            unsigned hash = func_hash(pred->key_);
-            hash = hash % num_slot_new;
+            /* Migrate each key to the new slot with its cached hash value. */
+            unsigned hash = pred->hash_;
+            hash = SLOT_INDEX(data, hash, num_slot_new);
             if (!arr_slot_new[hash]) {
                 pred->next_ = NULL;
                 arr_slot_new[hash] = pred;
@@ -574,6 +1320,291 @@ void _HashSetReHash(HashSetData* data)
     free(arr_slot);
     data->arr_slot_ = arr_slot_new;
     data->num_slot_ = num_slot_new;
-    data->curr_limit_ = (unsigned)((double)num_slot_new * load_factor);
+    data->curr_limit_ = (unsigned)((double)num_slot_new * data->load_factor_);
+    if (data->filter_)
+        _HashSetBuildFilter(data);
+    STATS_LAPSE(data, ns_rehash, begin);
+    return true;
+}
+
+unsigned _HashSetFitSlot(unsigned capacity, double factor, bool pow2,
+                         int* p_idx_prime)
+{
+    unsigned num_slot;
+    int idx_prime = 0;
+
+    /* In power-of-two mode, keep doubling the initial slot array. */
+    if (pow2) {
+        num_slot = pow2_init_slot;
+        while ((double)num_slot * factor < (double)capacity) {
+            if (unlikely(num_slot > (UINT_MAX >> 1)))
+                break;
+            num_slot <<= 1;
+        }
+    }
+    /* Otherwise, pick the smallest fitting prime. If the prime list is
+       completely consumed, keep trebling the largest one like the rehashing. */
+    else {
+        while (idx_prime < num_prime &&
+               (double)magic_primes[idx_prime] * factor < (double)capacity)
+            ++idx_prime;
+        if (idx_prime < num_prime)
+            num_slot = magic_primes[idx_prime];
+        else {
+            num_slot = magic_primes[num_prime - 1];
+            while ((double)num_slot * factor < (double)capacity) {
+                if (unlikely(num_slot > UINT_MAX / 3))
+                    break;
+                num_slot *= 3;
+            }
+        }
+    }
+
+    *p_idx_prime = idx_prime;
+    return num_slot;
+}
+
+void _HashSetMigrate(HashSetData* data, unsigned count)
+{
+    SlotNode** arr_slot = data->arr_slot_;
+    SlotNode** arr_slot_old = data->arr_slot_old_;
+    unsigned num_slot = data->num_slot_;
+    unsigned num_slot_old = data->num_slot_old_;
+    unsigned idx = data->idx_migrate_;
+
+    while (count > 0 && idx < num_slot_old) {
+        SlotNode* pred;
+        SlotNode* curr = arr_slot_old[idx];
+        while (curr) {
+            pred = curr;
+            curr = curr->next_;
+
+            /* Migrate each key to the new slot with its cached hash value. */
+            unsigned hash = pred->hash_;
+            hash = SLOT_INDEX(data, hash, num_slot);
+            pred->next_ = arr_slot[hash];
+            arr_slot[hash] = pred;
+        }
+        arr_slot_old[idx] = NULL;
+        ++idx;
+        --count;
+    }
+
+    if (idx < num_slot_old) {
+        data->idx_migrate_ = idx;
+        return;
+    }
+
+    free(arr_slot_old);
+    data->arr_slot_old_ = NULL;
+    data->num_slot_old_ = 0;
+    data->idx_migrate_ = 0;
+    return;
+}
+
+void _HashSetDrop(HashSetData* data, SlotNode* chain)
+{
+    HashSetCleanKey func_clean_key = data->func_clean_key_;
+    while (chain) {
+        SlotNode* pred = chain;
+        chain = chain->next_;
+        if (func_clean_key)
+            func_clean_key(pred->key_);
+        DELETE_NODE(data, pred);
+    }
+    return;
+}
+
+void _HashSetDispatch(AlgebraTask* tasks, unsigned count, unsigned num_slot,
+                      void* (*func) (void*))
+{
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        tasks[i].begin_ = (unsigned)((uint64_t)num_slot * i / count);
+        tasks[i].end_ = (unsigned)((uint64_t)num_slot * (i + 1) / count);
+        tasks[i].forked_ = false;
+    }
+
+    for (i = 0 ; i + 1 < count ; ++i) {
+        tasks[i].forked_ =
+            pthread_create(&(tasks[i].thread_), NULL, func, tasks + i) == 0;
+        if (!tasks[i].forked_)
+            func(tasks + i);
+    }
+    func(tasks + count - 1);
+
+    for (i = 0 ; i + 1 < count ; ++i) {
+        if (tasks[i].forked_)
+            pthread_join(tasks[i].thread_, NULL);
+    }
+    return;
+}
+
+void* _HashSetMergeTask(void* arg)
+{
+    AlgebraTask* task = (AlgebraTask*)arg;
+    HashSetData* dst = task->dst_;
+    SlotNode** arr_slot = task->src_->arr_slot_;
+    bool cached = task->cached_;
+
+    unsigned i;
+    for (i = task->begin_ ; i < task->end_ ; ++i) {
+        SlotNode* curr;
+        for (curr = arr_slot[i] ; curr ; curr = curr->next_) {
+            unsigned hash = HASH_OF(dst, curr, cached);
+            if (LOCATE(dst, curr->key_, hash))
+                continue;
+
+            if (task->num_item_ == task->cap_miss_) {
+                unsigned cap = (task->cap_miss_)? task->cap_miss_ << 1 : 64;
+                SlotNode* arr_miss = (SlotNode*)realloc(task->arr_miss_,
+                                                        sizeof(SlotNode) * cap);
+                if (unlikely(!arr_miss)) {
+                    task->status_ = false;
+                    return NULL;
+                }
+                task->arr_miss_ = arr_miss;
+                task->cap_miss_ = cap;
+            }
+
+            SlotNode* miss = task->arr_miss_ + task->num_item_;
+            miss->key_ = curr->key_;
+            miss->hash_ = hash;
+            ++(task->num_item_);
+        }
+    }
+    return NULL;
+}
+
+void* _HashSetFilterTask(void* arg)
+{
+    AlgebraTask* task = (AlgebraTask*)arg;
+    HashSetData* src = task->src_;
+    SlotNode** arr_slot = task->dst_->arr_slot_;
+    bool cached = task->cached_;
+    bool keep = task->keep_;
+
+    unsigned i;
+    for (i = task->begin_ ; i < task->end_ ; ++i) {
+        SlotNode** link = arr_slot + i;
+        while (*link) {
+            SlotNode* curr = *link;
+            unsigned hash = HASH_OF(src, curr, cached);
+            bool common = LOCATE(src, curr->key_, hash) != NULL;
+            if (common == keep) {
+                link = &(curr->next_);
+                continue;
+            }
+            *link = curr->next_;
+            curr->next_ = task->drops_;
+            task->drops_ = curr;
+            ++(task->num_item_);
+        }
+    }
+    return NULL;
+}
+
+void _HashSetFilter(HashSetData* dst, HashSetData* src, bool keep,
+                    unsigned num_thread)
+{
+    /* Both sets are scanned via their slot arrays directly, so any pending
+       migration should be finished first. */
+    if (dst->arr_slot_old_)
+        _HashSetMigrate(dst, dst->num_slot_old_);
+    if (src->arr_slot_old_)
+        _HashSetMigrate(src, src->num_slot_old_);
+
+    SlotNode** arr_slot = dst->arr_slot_;
+    unsigned num_slot = dst->num_slot_;
+    bool cached = SAME_HASH(dst, src);
+    unsigned i;
+
+    /* Drop all the keys if the set is subtracted by itself. */
+    if (dst == src) {
+        for (i = 0 ; i < num_slot ; ++i) {
+            _HashSetDrop(dst, arr_slot[i]);
+            arr_slot[i] = NULL;
+        }
+        dst->size_ = 0;
+        if (dst->filter_)
+            BloomFilterClear(dst->filter_);
+        return;
+    }
+
+    /* For the single-threaded scan against a smaller source set, probe the
+       designated set with each source key instead. */
+    if (num_thread <= 1 && src->size_ < dst->size_) {
+        SlotNode* keeps = NULL;
+        unsigned num_keep = 0;
+        for (i = 0 ; i < src->num_slot_ ; ++i) {
+            SlotNode* curr;
+            for (curr = src->arr_slot_[i] ; curr ; curr = curr->next_) {
+                SlotNode** link = LOCATE(dst, curr->key_,
+                                         HASH_OF(dst, curr, cached));
+                if (!link)
+                    continue;
+
+                SlotNode* node = *link;
+                *link = node->next_;
+                if (keep) {
+                    node->next_ = keeps;
+                    keeps = node;
+                    ++num_keep;
+                } else {
+                    node->next_ = NULL;
+                    _HashSetDrop(dst, node);
+                    --(dst->size_);
+                }
+            }
+        }
+        if (!keep)
+            return;
+
+        /* Release the remaining keys and restore the kept ones with their
+           cached hash values. */
+        for (i = 0 ; i < num_slot ; ++i) {
+            _HashSetDrop(dst, arr_slot[i]);
+            arr_slot[i] = NULL;
+        }
+        while (keeps) {
+            SlotNode* node = keeps;
+            keeps = keeps->next_;
+            SlotNode** slot = arr_slot + SLOT_INDEX(dst, node->hash_, num_slot);
+            node->next_ = *slot;
+            *slot = node;
+        }
+        dst->size_ = num_keep;
+        return;
+    }
+
+    /* Otherwise, scan the designated slot array in partitions. The unlinked
+       nodes are released by the calling thread since neither the allocator nor
+       the key clean function is assumed to be thread safe. */
+    AlgebraTask single;
+    AlgebraTask* tasks = NULL;
+    if (num_thread > 1)
+        tasks = (AlgebraTask*)malloc(sizeof(AlgebraTask) * num_thread);
+    if (!tasks) {
+        tasks = &single;
+        num_thread = 1;
+    }
+
+    for (i = 0 ; i < num_thread ; ++i) {
+        tasks[i].dst_ = dst;
+        tasks[i].src_ = src;
+        tasks[i].cached_ = cached;
+        tasks[i].keep_ = keep;
+        tasks[i].drops_ = NULL;
+        tasks[i].num_item_ = 0;
+    }
+    _HashSetDispatch(tasks, num_thread, num_slot, _HashSetFilterTask);
+
+    for (i = 0 ; i < num_thread ; ++i) {
+        _HashSetDrop(dst, tasks[i].drops_);
+        dst->size_ -= tasks[i].num_item_;
+    }
+
+    if (tasks != &single)
+        free(tasks);
     return;
 }
@@ -0,0 +1,242 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/hyper_log_log.h"
+#include "math/hash.h"
+#include <math.h>
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const unsigned default_precision = 14;
+static const unsigned min_precision = 4;
+static const unsigned max_precision = 18;
+static const size_t size_cache_line = 64;
+
+struct _HyperLogLogData {
+    uint8_t* arr_reg_;
+    unsigned precision_;
+    HyperLogLogHash func_hash_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Return the hash value of the key via the designated hash function.
+ */
+static inline uint64_t HASH(HyperLogLogData* data, void* key)
+{
+    if (data->func_hash_)
+        return data->func_hash_(key);
+    return (uint64_t)(uintptr_t)key;
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+HyperLogLog* HyperLogLogInit(unsigned precision)
+{
+    if (precision < min_precision || precision > max_precision)
+        precision = default_precision;
+
+    HyperLogLog* obj = (HyperLogLog*)malloc(sizeof(HyperLogLog));
+    if (unlikely(!obj))
+        return NULL;
+
+    HyperLogLogData* data = (HyperLogLogData*)malloc(sizeof(HyperLogLogData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    size_t size_arr = (size_t)1 << precision;
+    uint8_t* arr_reg;
+    if (unlikely(posix_memalign((void**)&arr_reg, size_cache_line,
+                                size_arr) != 0)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+    memset(arr_reg, 0, size_arr);
+
+    data->arr_reg_ = arr_reg;
+    data->precision_ = precision;
+    data->func_hash_ = NULL;
+
+    obj->data = data;
+    obj->add = HyperLogLogAdd;
+    obj->add_hash = HyperLogLogAddHash;
+    obj->count = HyperLogLogCount;
+    obj->merge = HyperLogLogMerge;
+    obj->precision = HyperLogLogPrecision;
+    obj->clear = HyperLogLogClear;
+    obj->set_hash = HyperLogLogSetHash;
+
+    return obj;
+}
+
+void HyperLogLogDeinit(HyperLogLog* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    HyperLogLogData* data = obj->data;
+    free(data->arr_reg_);
+    free(data);
+    free(obj);
+    return;
+}
+
+void HyperLogLogAdd(HyperLogLog* self, void* key)
+{
+    HyperLogLogAddHash(self, HASH(self->data, key));
+}
+
+void HyperLogLogAddHash(HyperLogLog* self, uint64_t hash)
+{
+    HyperLogLogData* data = self->data;
+    unsigned precision = data->precision_;
+    hash = HashMix64(hash);
+
+    /* The sentinel bit bounds the rank when all the remaining bits are zero. */
+    unsigned idx = (unsigned)(hash >> (64 - precision));
+    uint64_t rest = (hash << precision) | (1ULL << (precision - 1));
+    uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+
+    if (rank > data->arr_reg_[idx])
+        data->arr_reg_[idx] = rank;
+    return;
+}
+
+uint64_t HyperLogLogCount(HyperLogLog* self)
+{
+    HyperLogLogData* data = self->data;
+    size_t num = (size_t)1 << data->precision_;
+    double m = (double)num;
+
+    double sum = 0;
+    size_t zero = 0;
+    size_t i;
+    for (i = 0 ; i < num ; ++i) {
+        uint8_t reg = data->arr_reg_[i];
+        sum += ldexp(1.0, -(int)reg);
+        zero += (reg == 0);
+    }
+
+    double alpha;
+    if (num == 16)
+        alpha = 0.673;
+    else if (num == 32)
+        alpha = 0.697;
+    else if (num == 64)
+        alpha = 0.709;
+    else
+        alpha = 0.7213 / (1 + 1.079 / m);
+
+    /* The 64 bit hash value makes the large range correction unnecessary. */
+    double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zero > 0)
+        estimate = m * log(m / (double)zero);
+    return (uint64_t)(estimate + 0.5);
+}
+
+bool HyperLogLogMerge(HyperLogLog* self, HyperLogLog* other)
+{
+    HyperLogLogData* dst = self->data;
+    HyperLogLogData* src = other->data;
+    if (dst->precision_ != src->precision_)
+        return false;
+
+    size_t num = (size_t)1 << dst->precision_;
+    uint8_t* arr_dst = dst->arr_reg_;
+    const uint8_t* arr_src = src->arr_reg_;
+    size_t i;
+    for (i = 0 ; i < num ; ++i)
+        arr_dst[i] = (arr_src[i] > arr_dst[i])? arr_src[i] : arr_dst[i];
+    return true;
+}
+
+unsigned HyperLogLogPrecision(HyperLogLog* self)
+{
+    return self->data->precision_;
+}
+
+void HyperLogLogClear(HyperLogLog* self)
+{
+    HyperLogLogData* data = self->data;
+    memset(data->arr_reg_, 0, (size_t)1 << data->precision_);
+    return;
+}
+
+void HyperLogLogSetHash(HyperLogLog* self, HyperLogLogHash func)
+{
+    self->data->func_hash_ = func;
+}
+
+bool HyperLogLogSnapshot(HyperLogLog* self, const SnapshotWriter* writer)
+{
+    HyperLogLogData* data = self->data;
+    size_t num = (size_t)1 << data->precision_;
+
+    /* The header records the register count, and the registers follow as a
+       single field. */
+    SnapshotEncoder enc;
+    if (unlikely(!CdsSnapshotBegin(&enc, writer, CDS_SNAPSHOT_HYPER_LOG_LOG,
+                                   (unsigned)num)))
+        return CdsSnapshotEnd(&enc, false);
+    if (unlikely(!CdsSnapshotAppend(&enc, data->arr_reg_, num)))
+        return CdsSnapshotEnd(&enc, false);
+    return CdsSnapshotEnd(&enc, true);
+}
+
+bool HyperLogLogRestore(HyperLogLog* self, const SnapshotReader* reader)
+{
+    HyperLogLogData* data = self->data;
+    size_t num = (size_t)1 << data->precision_;
+
+    SnapshotDecoder dec;
+    unsigned count;
+    if (unlikely(!CdsRestoreBegin(&dec, reader, CDS_SNAPSHOT_HYPER_LOG_LOG,
+                                  &count)))
+        return CdsRestoreEnd(&dec, false);
+
+    const uint8_t* bytes;
+    size_t size;
+    if (count != num ||
+        unlikely(!CdsRestoreField(&dec, (const void**)&bytes, &size)) ||
+        size != num)
+        return CdsRestoreEnd(&dec, false);
+
+    uint8_t* arr_reg = data->arr_reg_;
+    size_t i;
+    for (i = 0 ; i < num ; ++i)
+        arr_reg[i] = (bytes[i] > arr_reg[i])? bytes[i] : arr_reg[i];
+    return CdsRestoreEnd(&dec, true);
+}
@@ -22,6 +22,7 @@
  */
 
 #include "container/list.h"
+#include "memory/pool.h"
 
 
 /*===========================================================================*
@@ -39,6 +40,8 @@ struct _ListData {
     ListNode* head_;
     ListNode* iter_node_;
     ListClean func_clean_;
+    Allocator alloc_;
+    Pool* pool_;
 };
 
 
@@ -48,6 +51,62 @@ struct _ListData {
 #define likely(x)       __builtin_expect(!!(x), 1)
 #define unlikely(x)     __builtin_expect(!!(x), 0)
 
+/**
+ * Allocate the list node via the designated allocator.
+ */
+static inline ListNode* NEW_NODE(ListData* data)
+{
+    return (ListNode*)data->alloc_.alloc(data->alloc_.ctx, sizeof(ListNode));
+}
+
+/**
+ * Release the list node via the designated allocator.
+ */
+static inline void DELETE_NODE(ListData* data, ListNode* node)
+{
+    data->alloc_.free(data->alloc_.ctx, node);
+}
+
+/**
+ * Link the node before the designated successor in the circular list.
+ */
+static inline void LINK_BEFORE(ListNode* succ, ListNode* node)
+{
+    ListNode* pred = succ->pred_;
+    node->pred_ = pred;
+    node->succ_ = succ;
+    pred->succ_ = node;
+    succ->pred_ = node;
+}
+
+/**
+ * Check whether the nodes of the two lists can be exchanged.
+ */
+static inline bool SAME_ALLOCATOR(ListData* lhs, ListData* rhs)
+{
+    return lhs->alloc_.alloc == rhs->alloc_.alloc &&
+           lhs->alloc_.free == rhs->alloc_.free &&
+           lhs->alloc_.ctx == rhs->alloc_.ctx;
+}
+
+/**
+ * @brief Link the node to the list which is possibly empty.
+ *
+ * @param data          The pointer to the list private data
+ * @param succ          The successor node or NULL for the tail
+ * @param node          The node to be linked
+ */
+void _ListLink(ListData* data, ListNode* succ, ListNode* node);
+
+/**
+ * @brief Restore the predecessor links and the circular structure of the list
+ *        from the singly linked node chain.
+ *
+ * @param data          The pointer to the list private data
+ * @param first         The first node of the chain terminated by NULL
+ */
+void _ListRelink(ListData* data, ListNode* first);
+
 
 /*===========================================================================*
  *               Implementation for the exported operations                  *
@@ -68,6 +127,8 @@ List* ListInit()
     data->head_ = NULL;
     data->iter_node_ = NULL;
     data->func_clean_ = NULL;
+    data->alloc_ = *CdsGetAllocator();
+    data->pool_ = NULL;
 
     obj->data = data;
     obj->push_front = ListPushFront;
@@ -88,6 +149,20 @@ List* ListInit()
     obj->next = ListNext;
     obj->reverse_next = ListReverseNext;
     obj->set_clean = ListSetClean;
+    obj->set_allocator = ListSetAllocator;
+    obj->use_pool = ListUsePool;
+    obj->push_front_handle = ListPushFrontHandle;
+    obj->push_back_handle = ListPushBackHandle;
+    obj->insert_after = ListInsertAfter;
+    obj->insert_before = ListInsertBefore;
+    obj->erase = ListErase;
+    obj->front_handle = ListFrontHandle;
+    obj->back_handle = ListBackHandle;
+    obj->next_handle = ListNextHandle;
+    obj->prev_handle = ListPrevHandle;
+    obj->splice = ListSplice;
+    obj->sort = ListSort;
+    obj->merge = ListMerge;
 
     return obj;
 }
@@ -98,18 +173,25 @@ void ListDeinit(List* obj)
         return;
 
     ListData* data = obj->data;
+    ListClean func_clean = data->func_clean_;
+
+    /* The pooled nodes are released at once, so the list is traversed only for
+       the element cleanup. */
+    Pool* pool = data->pool_;
     ListNode* curr = data->head_;
-    if (curr) {
+    if (curr && (!pool || func_clean)) {
         ListNode* head = data->head_;
-        ListClean func_clean = data->func_clean_;
         do {
             ListNode* pred = curr;
             curr = curr->succ_;
             if (func_clean)
                 func_clean(pred->element_);
-            free(pred);
+            if (!pool)
+                DELETE_NODE(data, pred);
         } while (curr != head);
     }
+    if (pool)
+        PoolDeinit(pool);
 
     free(data);
     free(obj);
@@ -118,12 +200,12 @@ void ListDeinit(List* obj)
 
 bool ListPushFront(List* self, void* element)
 {
-    ListNode* new_node = (ListNode*)malloc(sizeof(ListNode));
+    ListData* data = self->data;
+    ListNode* new_node = NEW_NODE(data);
     if (unlikely(!new_node))
         return false;
     new_node->element_ = element;
 
-    ListData* data = self->data;
     ListNode* head = data->head_;
     if (unlikely(!head))
         new_node->pred_ = new_node->succ_ = new_node;
@@ -141,12 +223,12 @@ bool ListPushFront(List* self, void* element)
 
 bool ListPushBack(List* self, void* element)
 {
-    ListNode* new_node = (ListNode*)malloc(sizeof(ListNode));
+    ListData* data = self->data;
+    ListNode* new_node = NEW_NODE(data);
     if (unlikely(!new_node))
         return false;
     new_node->element_ = element;
 
-    ListData* data = self->data;
     ListNode* head = data->head_;
     if (unlikely(!head)) {
         new_node->pred_ = new_node->succ_ = new_node;
@@ -169,7 +251,7 @@ bool ListInsert(List* self, unsigned idx, void* element)
     if (unlikely(idx > size))
         return false;
 
-    ListNode* new_node = (ListNode*)malloc(sizeof(ListNode));
+    ListNode* new_node = NEW_NODE(data);
     if (unlikely(!new_node))
         return false;
     new_node->element_ = element;
@@ -208,7 +290,7 @@ bool ListPopFront(List* self)
     if (unlikely(head == head->pred_)) {
         if (func_clean)
             func_clean(head->element_);
-        free(head);
+        DELETE_NODE(data, head);
         data->head_ = NULL;
     } else {
         head->pred_->succ_ = head->succ_;
@@ -216,7 +298,7 @@ bool ListPopFront(List* self)
         data->head_ = head->succ_;
         if (func_clean)
             func_clean(head->element_);
-        free(head);
+        DELETE_NODE(data, head);
     }
 
     data->size_--;
@@ -234,7 +316,7 @@ bool ListPopBack(List* self)
     if (unlikely(head == head->succ_)) {
         if (func_clean)
             func_clean(head->element_);
-        free(head);
+        DELETE_NODE(data, head);
         data->head_ = NULL;
     } else {
         ListNode* tail = head->pred_;
@@ -242,7 +324,7 @@ bool ListPopBack(List* self)
         head->pred_ = tail->pred_;
         if (func_clean)
             func_clean(tail->element_);
-        free(tail);
+        DELETE_NODE(data, tail);
     }
 
     data->size_--;
@@ -278,7 +360,7 @@ bool ListRemove(List* self, unsigned idx)
     ListClean func_clean = data->func_clean_;
     if (func_clean)
         func_clean(track->element_);
-    free(track);
+    DELETE_NODE(data, track);
 
     data->size_ = size - 1;
     return true;
@@ -432,7 +514,358 @@ bool ListReverseNext(List* self, void** p_element)
     return true;
 }
 
+void ListIterInit(List* self, ListIter* iter, bool is_reverse)
+{
+    ListData* data = self->data;
+    ListNode* head = data->head_;
+    iter->data_ = data;
+    iter->round_ = 0;
+    iter->is_reverse_ = is_reverse;
+    iter->node_ = (!head || is_reverse == false)? head : head->pred_;
+}
+
+bool ListIterNext(ListIter* iter, void** p_element)
+{
+    unsigned round = iter->round_;
+    if (unlikely(round == iter->data_->size_))
+        return false;
+
+    ListNode* node = (ListNode*)iter->node_;
+    *p_element = node->element_;
+    iter->node_ = (iter->is_reverse_ == false)? node->succ_ : node->pred_;
+    iter->round_ = round + 1;
+    return true;
+}
+
 void ListSetClean(List* self, ListClean func)
 {
     self->data->func_clean_ = func;
 }
+
+bool ListSetAllocator(List* self, const Allocator* alloc)
+{
+    ListData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    if (data->pool_) {
+        PoolDeinit(data->pool_);
+        data->pool_ = NULL;
+    }
+    data->alloc_ = (alloc)? *alloc : *CdsGetAllocator();
+    return true;
+}
+
+bool ListUsePool(List* self)
+{
+    ListData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    Pool* pool = PoolInit(sizeof(ListNode));
+    if (unlikely(!pool))
+        return false;
+
+    if (data->pool_)
+        PoolDeinit(data->pool_);
+    data->pool_ = pool;
+    PoolGetAllocator(pool, &(data->alloc_));
+    return true;
+}
+
+ListHandle ListPushFrontHandle(List* self, void* element)
+{
+    ListData* data = self->data;
+    ListNode* new_node = NEW_NODE(data);
+    if (unlikely(!new_node))
+        return NULL;
+    new_node->element_ = element;
+
+    _ListLink(data, data->head_, new_node);
+    data->head_ = new_node;
+    return new_node;
+}
+
+ListHandle ListPushBackHandle(List* self, void* element)
+{
+    ListData* data = self->data;
+    ListNode* new_node = NEW_NODE(data);
+    if (unlikely(!new_node))
+        return NULL;
+    new_node->element_ = element;
+
+    _ListLink(data, NULL, new_node);
+    return new_node;
+}
+
+ListHandle ListInsertAfter(List* self, ListHandle pos, void* element)
+{
+    ListData* data = self->data;
+    ListNode* new_node = NEW_NODE(data);
+    if (unlikely(!new_node))
+        return NULL;
+    new_node->element_ = element;
+
+    LINK_BEFORE(pos->succ_, new_node);
+    data->size_++;
+    return new_node;
+}
+
+ListHandle ListInsertBefore(List* self, ListHandle pos, void* element)
+{
+    ListData* data = self->data;
+    ListNode* new_node = NEW_NODE(data);
+    if (unlikely(!new_node))
+        return NULL;
+    new_node->element_ = element;
+
+    LINK_BEFORE(pos, new_node);
+    if (pos == data->head_)
+        data->head_ = new_node;
+    data->size_++;
+    return new_node;
+}
+
+void ListErase(List* self, ListHandle pos)
+{
+    ListData* data = self->data;
+    ListNode* pred = pos->pred_;
+    ListNode* succ = pos->succ_;
+    pred->succ_ = succ;
+    succ->pred_ = pred;
+
+    if (unlikely(succ == pos))
+        data->head_ = NULL;
+    else if (pos == data->head_)
+        data->head_ = succ;
+
+    ListClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(pos->element_);
+    DELETE_NODE(data, pos);
+    data->size_--;
+}
+
+ListHandle ListFrontHandle(List* self)
+{
+    return self->data->head_;
+}
+
+ListHandle ListBackHandle(List* self)
+{
+    ListNode* head = self->data->head_;
+    return (head)? head->pred_ : NULL;
+}
+
+ListHandle ListNextHandle(List* self, ListHandle pos)
+{
+    ListNode* succ = pos->succ_;
+    return (succ == self->data->head_)? NULL : succ;
+}
+
+ListHandle ListPrevHandle(List* self, ListHandle pos)
+{
+    return (pos == self->data->head_)? NULL : pos->pred_;
+}
+
+void* ListHandleGet(ListHandle pos)
+{
+    return pos->element_;
+}
+
+void ListHandleSet(ListHandle pos, void* element)
+{
+    pos->element_ = element;
+}
+
+bool ListSplice(List* self, ListHandle pos, List* other, ListHandle first,
+                ListHandle last)
+{
+    ListData* data = self->data;
+    ListData* src = other->data;
+    if (unlikely(data != src && !SAME_ALLOCATOR(data, src)))
+        return false;
+
+    /* Only the moves across lists change the sizes. */
+    unsigned count = 0;
+    if (data != src) {
+        ListNode* curr = first;
+        count = 1;
+        while (curr != last) {
+            curr = curr->succ_;
+            ++count;
+        }
+    }
+
+    /* Detach the range from the source list. */
+    ListNode* pred = first->pred_;
+    ListNode* succ = last->succ_;
+    if (succ == first) {
+        if (data == src)
+            return true;
+        src->head_ = NULL;
+    } else {
+        pred->succ_ = succ;
+        succ->pred_ = pred;
+        if (src->head_ == first)
+            src->head_ = succ;
+    }
+    src->size_ -= count;
+
+    /* Attach the range before the designated node. */
+    ListNode* head = data->head_;
+    if (unlikely(!head)) {
+        first->pred_ = last;
+        last->succ_ = first;
+        data->head_ = first;
+    } else {
+        ListNode* target = (pos)? pos : head;
+        ListNode* target_pred = target->pred_;
+        target_pred->succ_ = first;
+        first->pred_ = target_pred;
+        last->succ_ = target;
+        target->pred_ = last;
+        if (pos == head)
+            data->head_ = first;
+    }
+    data->size_ += count;
+    return true;
+}
+
+void ListSort(List* self, ListCompare func)
+{
+    ListData* data = self->data;
+    ListNode* list = data->head_;
+    if (unlikely(data->size_ < 2))
+        return;
+
+    /* Sort the singly linked chain by merging the runs of doubling width. */
+    list->pred_->succ_ = NULL;
+    unsigned width = 1;
+    while (true) {
+        ListNode* lhs = list;
+        ListNode* tail = NULL;
+        unsigned num_merge = 0;
+        list = NULL;
+
+        while (lhs) {
+            ++num_merge;
+            ListNode* rhs = lhs;
+            unsigned size_lhs = 0;
+            while (size_lhs < width && rhs) {
+                rhs = rhs->succ_;
+                ++size_lhs;
+            }
+            unsigned size_rhs = width;
+
+            while (size_lhs > 0 || (size_rhs > 0 && rhs)) {
+                /* Take the left one for the equal elements to keep stable. */
+                ListNode* next;
+                if (size_lhs == 0) {
+                    next = rhs;
+                    rhs = rhs->succ_;
+                    --size_rhs;
+                } else if (size_rhs == 0 || !rhs ||
+                           func(lhs->element_, rhs->element_) <= 0) {
+                    next = lhs;
+                    lhs = lhs->succ_;
+                    --size_lhs;
+                } else {
+                    next = rhs;
+                    rhs = rhs->succ_;
+                    --size_rhs;
+                }
+
+                if (tail)
+                    tail->succ_ = next;
+                else
+                    list = next;
+                tail = next;
+            }
+            lhs = rhs;
+        }
+        tail->succ_ = NULL;
+
+        if (num_merge <= 1)
+            break;
+        width <<= 1;
+    }
+
+    _ListRelink(data, list);
+}
+
+bool ListMerge(List* self, List* other, ListCompare func)
+{
+    ListData* data = self->data;
+    ListData* src = other->data;
+    if (unlikely(data == src || !SAME_ALLOCATOR(data, src)))
+        return false;
+
+    ListNode* lhs = data->head_;
+    ListNode* rhs = src->head_;
+    if (unlikely(!rhs))
+        return true;
+
+    unsigned size = data->size_ + src->size_;
+    src->head_ = NULL;
+    src->size_ = 0;
+    if (unlikely(!lhs)) {
+        data->head_ = rhs;
+        data->size_ = size;
+        return true;
+    }
+
+    lhs->pred_->succ_ = NULL;
+    rhs->pred_->succ_ = NULL;
+    ListNode* list = NULL;
+    ListNode* tail = NULL;
+    while (lhs && rhs) {
+        ListNode* next;
+        if (func(lhs->element_, rhs->element_) <= 0) {
+            next = lhs;
+            lhs = lhs->succ_;
+        } else {
+            next = rhs;
+            rhs = rhs->succ_;
+        }
+        if (tail)
+            tail->succ_ = next;
+        else
+            list = next;
+        tail = next;
+    }
+    tail->succ_ = (lhs)? lhs : rhs;
+
+    data->size_ = size;
+    _ListRelink(data, list);
+    return true;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+void _ListLink(ListData* data, ListNode* succ, ListNode* node)
+{
+    ListNode* head = data->head_;
+    if (unlikely(!head)) {
+        node->pred_ = node->succ_ = node;
+        data->head_ = node;
+    } else
+        LINK_BEFORE((succ)? succ : head, node);
+    data->size_++;
+}
+
+void _ListRelink(ListData* data, ListNode* first)
+{
+    ListNode* pred = first;
+    ListNode* curr = first->succ_;
+    while (curr) {
+        curr->pred_ = pred;
+        pred = curr;
+        curr = curr->succ_;
+    }
+    pred->succ_ = first;
+    first->pred_ = pred;
+    data->head_ = first;
+}
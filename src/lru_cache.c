@@ -0,0 +1,617 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include "container/lru_cache.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const unsigned max_num_shard = 1024;
+static const unsigned init_slot = 64;
+static const double max_load_factor = 0.75;
+static const size_t size_cache_line = 64;
+
+
+typedef struct _CacheNode {
+    Pair pair_;
+    struct _CacheNode* next_;
+    struct _CacheNode* newer_;
+    struct _CacheNode* older_;
+    size_t charge_;
+    unsigned hash_;
+    bool referenced_;
+} CacheNode;
+
+/* Each shard occupies its own cache lines to avoid false sharing between the
+   locks of the neighboring shards. */
+typedef struct _Shard {
+    pthread_mutex_t lock_;
+    CacheNode** arr_slot_;
+    CacheNode* newest_;
+    CacheNode* oldest_;
+    unsigned num_slot_;
+    unsigned size_;
+    unsigned capacity_;
+    size_t charge_;
+    size_t limit_charge_;
+} __attribute__((aligned(64))) Shard;
+
+struct _LruCacheData {
+    unsigned num_shard_;
+    unsigned shift_shard_;
+    bool concurrent_;
+    bool clock_;
+    Shard* arr_shard_;
+    LruCacheHash func_hash_;
+    LruCacheCompare func_cmp_;
+    LruCacheCleanKey func_clean_key_;
+    LruCacheCleanValue func_clean_val_;
+    LruCacheCharge func_charge_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Calculate the scrambled hash value of the given key. The high bits select
+ * the shard while the low bits select the slot.
+ */
+static inline unsigned HASH(LruCacheData* data, void* key)
+{
+    unsigned hash = data->func_hash_(key);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/**
+ * Locate the shard which should contain the key with the given hash.
+ */
+static inline Shard* GET_SHARD(LruCacheData* data, unsigned hash)
+{
+    return data->arr_shard_ + (unsigned)((uint64_t)hash >> data->shift_shard_);
+}
+
+/**
+ * Lock the shard in concurrent mode.
+ */
+static inline void LOCK(LruCacheData* data, Shard* shard)
+{
+    if (data->concurrent_)
+        pthread_mutex_lock(&(shard->lock_));
+}
+
+/**
+ * Unlock the shard in concurrent mode.
+ */
+static inline void UNLOCK(LruCacheData* data, Shard* shard)
+{
+    if (data->concurrent_)
+        pthread_mutex_unlock(&(shard->lock_));
+}
+
+/**
+ * Locate the link which points to the node holding the given key.
+ */
+static inline CacheNode** LOCATE(LruCacheData* data, Shard* shard, void* key,
+                                 unsigned hash)
+{
+    LruCacheCompare func_cmp = data->func_cmp_;
+    CacheNode** link = shard->arr_slot_ + (hash & (shard->num_slot_ - 1));
+    while (*link) {
+        CacheNode* curr = *link;
+        if (curr->hash_ == hash && func_cmp(key, curr->pair_.key) == 0)
+            return link;
+        link = &(curr->next_);
+    }
+    return NULL;
+}
+
+/**
+ * Link the node as the most recently used one.
+ */
+static inline void LINK_NEWEST(Shard* shard, CacheNode* node)
+{
+    node->newer_ = NULL;
+    node->older_ = shard->newest_;
+    if (shard->newest_)
+        shard->newest_->newer_ = node;
+    else
+        shard->oldest_ = node;
+    shard->newest_ = node;
+}
+
+/**
+ * Unlink the node from the recency list.
+ */
+static inline void UNLINK(Shard* shard, CacheNode* node)
+{
+    if (node->newer_)
+        node->newer_->older_ = node->older_;
+    else
+        shard->newest_ = node->older_;
+    if (node->older_)
+        node->older_->newer_ = node->newer_;
+    else
+        shard->oldest_ = node->newer_;
+}
+
+/**
+ * Invoke the cleanup functions for the pair held by the node.
+ */
+static inline void CLEAN(LruCacheData* data, CacheNode* node)
+{
+    if (data->func_clean_key_)
+        data->func_clean_key_(node->pair_.key);
+    if (data->func_clean_val_)
+        data->func_clean_val_(node->pair_.value);
+}
+
+/**
+ * @brief The default hash function.
+ *
+ * @param key           The designated key
+ *
+ * @retval Hash         The corresponding hash value
+ */
+unsigned _LruCacheHash(void* key);
+
+/**
+ * @brief The default hash key comparison function.
+ *
+ * @param lhs           The source key
+ * @param rhs           The target key
+ *
+ * @retval  1           The source key should go after the target one.
+ * @retval  0           The source key is equal to the target one.
+ * @retval -1           The source key should go before the target one.
+ */
+int _LruCacheCompare(void* lhs, void* rhs);
+
+/**
+ * @brief Double the slot array of the shard and re-distribute the stored
+ * pairs with their cached hash values.
+ *
+ * The extension is skipped if the new slot array cannot be allocated.
+ *
+ * @param shard         The pointer to the shard
+ */
+void _LruCacheReHash(Shard* shard);
+
+/**
+ * @brief Evict the least recently used pairs until the shard meets both the
+ * capacity and the charge limit.
+ *
+ * @param data          The pointer to the cache private data
+ * @param shard         The pointer to the shard
+ * @param keep          The node which should not be evicted
+ */
+void _LruCacheEvict(LruCacheData* data, Shard* shard, CacheNode* keep);
+
+/**
+ * @brief Release the shards which are already initialized.
+ *
+ * @param data          The pointer to the cache private data
+ * @param num_shard     The number of initialized shards
+ */
+void _LruCacheRelease(LruCacheData* data, unsigned num_shard);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+LruCache* LruCacheInit(unsigned capacity, unsigned num_shard)
+{
+    LruCache* obj = (LruCache*)malloc(sizeof(LruCache));
+    if (unlikely(!obj))
+        return NULL;
+
+    LruCacheData* data = (LruCacheData*)malloc(sizeof(LruCacheData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    /* Round the shard count up to the power of two for shift indexing. */
+    bool concurrent = num_shard > 0;
+    if (num_shard == 0)
+        num_shard = 1;
+    if (num_shard > max_num_shard)
+        num_shard = max_num_shard;
+    unsigned count = 1;
+    unsigned shift = 32;
+    while (count < num_shard) {
+        count <<= 1;
+        --shift;
+    }
+    num_shard = count;
+
+    Shard* arr_shard;
+    if (unlikely(posix_memalign((void**)&arr_shard, size_cache_line,
+                                sizeof(Shard) * num_shard) != 0)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+    data->arr_shard_ = arr_shard;
+    data->concurrent_ = concurrent;
+
+    unsigned capacity_shard = (capacity == 0)? UINT_MAX :
+                              (capacity + num_shard - 1) / num_shard;
+    unsigned i;
+    for (i = 0 ; i < num_shard ; ++i) {
+        Shard* shard = arr_shard + i;
+        shard->arr_slot_ = (CacheNode**)calloc(init_slot, sizeof(CacheNode*));
+        if (unlikely(!shard->arr_slot_)) {
+            _LruCacheRelease(data, i);
+            free(data);
+            free(obj);
+            return NULL;
+        }
+        if (concurrent &&
+            unlikely(pthread_mutex_init(&(shard->lock_), NULL) != 0)) {
+            free(shard->arr_slot_);
+            _LruCacheRelease(data, i);
+            free(data);
+            free(obj);
+            return NULL;
+        }
+        shard->newest_ = NULL;
+        shard->oldest_ = NULL;
+        shard->num_slot_ = init_slot;
+        shard->size_ = 0;
+        shard->capacity_ = capacity_shard;
+        shard->charge_ = 0;
+        shard->limit_charge_ = 0;
+    }
+
+    data->num_shard_ = num_shard;
+    data->shift_shard_ = shift;
+    data->clock_ = false;
+    data->func_hash_ = _LruCacheHash;
+    data->func_cmp_ = _LruCacheCompare;
+    data->func_clean_key_ = NULL;
+    data->func_clean_val_ = NULL;
+    data->func_charge_ = NULL;
+
+    obj->data = data;
+    obj->put = LruCachePut;
+    obj->get = LruCacheGet;
+    obj->contain = LruCacheContain;
+    obj->remove = LruCacheRemove;
+    obj->size = LruCacheSize;
+    obj->total_charge = LruCacheTotalCharge;
+    obj->set_hash = LruCacheSetHash;
+    obj->set_compare = LruCacheSetCompare;
+    obj->set_clean_key = LruCacheSetCleanKey;
+    obj->set_clean_value = LruCacheSetCleanValue;
+    obj->set_charge = LruCacheSetCharge;
+    obj->set_clock = LruCacheSetClock;
+
+    return obj;
+}
+
+void LruCacheDeinit(LruCache* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    LruCacheData* data = obj->data;
+    _LruCacheRelease(data, data->num_shard_);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool LruCachePut(LruCache* self, void* key, void* value)
+{
+    LruCacheData* data = self->data;
+    unsigned hash = HASH(data, key);
+    size_t charge = (data->func_charge_)? data->func_charge_(key, value) : 1;
+    Shard* shard = GET_SHARD(data, hash);
+    LOCK(data, shard);
+
+    /* Replace the existing pair and promote it. */
+    CacheNode** link = LOCATE(data, shard, key, hash);
+    CacheNode* node;
+    if (link) {
+        node = *link;
+        CLEAN(data, node);
+        node->pair_.key = key;
+        node->pair_.value = value;
+        shard->charge_ = shard->charge_ - node->charge_ + charge;
+        node->charge_ = charge;
+        node->referenced_ = false;
+        UNLINK(shard, node);
+        LINK_NEWEST(shard, node);
+    }
+    /* Otherwise, insert the new pair as the most recently used one. */
+    else {
+        node = (CacheNode*)malloc(sizeof(CacheNode));
+        if (unlikely(!node)) {
+            UNLOCK(data, shard);
+            return false;
+        }
+        node->pair_.key = key;
+        node->pair_.value = value;
+        node->charge_ = charge;
+        node->hash_ = hash;
+        node->referenced_ = false;
+
+        CacheNode** slot = shard->arr_slot_ + (hash & (shard->num_slot_ - 1));
+        node->next_ = *slot;
+        *slot = node;
+        LINK_NEWEST(shard, node);
+        ++(shard->size_);
+        shard->charge_ += charge;
+        if (shard->size_ > (unsigned)((double)shard->num_slot_ * max_load_factor))
+            _LruCacheReHash(shard);
+    }
+
+    _LruCacheEvict(data, shard, node);
+    UNLOCK(data, shard);
+    return true;
+}
+
+void* LruCacheGet(LruCache* self, void* key)
+{
+    LruCacheData* data = self->data;
+    unsigned hash = HASH(data, key);
+    Shard* shard = GET_SHARD(data, hash);
+    LOCK(data, shard);
+
+    void* value = NULL;
+    CacheNode** link = LOCATE(data, shard, key, hash);
+    if (link) {
+        CacheNode* node = *link;
+        value = node->pair_.value;
+        if (data->clock_)
+            node->referenced_ = true;
+        else if (node != shard->newest_) {
+            UNLINK(shard, node);
+            LINK_NEWEST(shard, node);
+        }
+    }
+
+    UNLOCK(data, shard);
+    return value;
+}
+
+bool LruCacheContain(LruCache* self, void* key)
+{
+    LruCacheData* data = self->data;
+    unsigned hash = HASH(data, key);
+    Shard* shard = GET_SHARD(data, hash);
+    LOCK(data, shard);
+    bool found = LOCATE(data, shard, key, hash) != NULL;
+    UNLOCK(data, shard);
+    return found;
+}
+
+bool LruCacheRemove(LruCache* self, void* key)
+{
+    LruCacheData* data = self->data;
+    unsigned hash = HASH(data, key);
+    Shard* shard = GET_SHARD(data, hash);
+    LOCK(data, shard);
+
+    CacheNode** link = LOCATE(data, shard, key, hash);
+    if (!link) {
+        UNLOCK(data, shard);
+        return false;
+    }
+
+    CacheNode* node = *link;
+    *link = node->next_;
+    UNLINK(shard, node);
+    --(shard->size_);
+    shard->charge_ -= node->charge_;
+    UNLOCK(data, shard);
+
+    /* The pair is no longer reachable, so it is cleaned outside the lock. */
+    CLEAN(data, node);
+    free(node);
+    return true;
+}
+
+unsigned LruCacheSize(LruCache* self)
+{
+    LruCacheData* data = self->data;
+
+    unsigned size = 0;
+    unsigned i;
+    for (i = 0 ; i < data->num_shard_ ; ++i) {
+        Shard* shard = data->arr_shard_ + i;
+        LOCK(data, shard);
+        size += shard->size_;
+        UNLOCK(data, shard);
+    }
+    return size;
+}
+
+size_t LruCacheTotalCharge(LruCache* self)
+{
+    LruCacheData* data = self->data;
+
+    size_t charge = 0;
+    unsigned i;
+    for (i = 0 ; i < data->num_shard_ ; ++i) {
+        Shard* shard = data->arr_shard_ + i;
+        LOCK(data, shard);
+        charge += shard->charge_;
+        UNLOCK(data, shard);
+    }
+    return charge;
+}
+
+void LruCacheSetHash(LruCache* self, LruCacheHash func)
+{
+    self->data->func_hash_ = func;
+}
+
+void LruCacheSetCompare(LruCache* self, LruCacheCompare func)
+{
+    self->data->func_cmp_ = func;
+}
+
+void LruCacheSetCleanKey(LruCache* self, LruCacheCleanKey func)
+{
+    self->data->func_clean_key_ = func;
+}
+
+void LruCacheSetCleanValue(LruCache* self, LruCacheCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+void LruCacheSetCharge(LruCache* self, LruCacheCharge func, size_t limit)
+{
+    LruCacheData* data = self->data;
+    data->func_charge_ = func;
+
+    unsigned num_shard = data->num_shard_;
+    size_t limit_shard = (limit + num_shard - 1) / num_shard;
+    unsigned i;
+    for (i = 0 ; i < num_shard ; ++i)
+        data->arr_shard_[i].limit_charge_ = limit_shard;
+}
+
+void LruCacheSetClock(LruCache* self, bool enable)
+{
+    self->data->clock_ = enable;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+unsigned _LruCacheHash(void* key)
+{
+    return (unsigned)(intptr_t)key;
+}
+
+int _LruCacheCompare(void* lhs, void* rhs)
+{
+    if ((intptr_t)lhs == (intptr_t)rhs)
+        return 0;
+    return ((intptr_t)lhs > (intptr_t)rhs)? 1 : (-1);
+}
+
+void _LruCacheReHash(Shard* shard)
+{
+    unsigned num_slot = shard->num_slot_;
+    if (unlikely(num_slot > (UINT_MAX >> 1)))
+        return;
+
+    unsigned num_slot_new = num_slot << 1;
+    CacheNode** arr_slot_new =
+        (CacheNode**)calloc(num_slot_new, sizeof(CacheNode*));
+    if (unlikely(!arr_slot_new))
+        return;
+
+    CacheNode** arr_slot = shard->arr_slot_;
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        CacheNode* curr = arr_slot[i];
+        while (curr) {
+            CacheNode* pred = curr;
+            curr = curr->next_;
+            CacheNode** slot = arr_slot_new + (pred->hash_ & (num_slot_new - 1));
+            pred->next_ = *slot;
+            *slot = pred;
+        }
+    }
+
+    free(arr_slot);
+    shard->arr_slot_ = arr_slot_new;
+    shard->num_slot_ = num_slot_new;
+    return;
+}
+
+void _LruCacheEvict(LruCacheData* data, Shard* shard, CacheNode* keep)
+{
+    bool clock = data->clock_;
+    while (shard->size_ > shard->capacity_ ||
+           (shard->limit_charge_ > 0 && shard->charge_ > shard->limit_charge_)) {
+        CacheNode* victim = shard->oldest_;
+        if (victim == keep) {
+            /* Only the protected pair remains unchecked, so any referenced
+               pairs have been cleared and moved ahead of it. */
+            if (victim == shard->newest_)
+                break;
+            UNLINK(shard, victim);
+            LINK_NEWEST(shard, victim);
+            continue;
+        }
+
+        /* In CLOCK mode, the referenced pair gets a second chance. */
+        if (clock && victim->referenced_) {
+            victim->referenced_ = false;
+            UNLINK(shard, victim);
+            LINK_NEWEST(shard, victim);
+            continue;
+        }
+
+        CacheNode** link = shard->arr_slot_ +
+                           (victim->hash_ & (shard->num_slot_ - 1));
+        while (*link != victim)
+            link = &((*link)->next_);
+        *link = victim->next_;
+        UNLINK(shard, victim);
+        --(shard->size_);
+        shard->charge_ -= victim->charge_;
+        CLEAN(data, victim);
+        free(victim);
+    }
+    return;
+}
+
+void _LruCacheRelease(LruCacheData* data, unsigned num_shard)
+{
+    unsigned i;
+    for (i = 0 ; i < num_shard ; ++i) {
+        Shard* shard = data->arr_shard_ + i;
+        CacheNode* curr = shard->newest_;
+        while (curr) {
+            CacheNode* pred = curr;
+            curr = curr->older_;
+            CLEAN(data, pred);
+            free(pred);
+        }
+        free(shard->arr_slot_);
+        if (data->concurrent_)
+            pthread_mutex_destroy(&(shard->lock_));
+    }
+    free(data->arr_shard_);
+    return;
+}
@@ -0,0 +1,754 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include "container/persistent_tree_map.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+/* The bound of the shared nodes copied at each level of an update, which
+   covers the search path node, its sibling, and the grandchildren touched by
+   the rotations and the color flips. */
+static const unsigned copy_per_level = 8;
+
+
+/* The left leaning red black tree node, which is immutable once it is shared
+   by more than one version. */
+typedef struct _TreeNode {
+    Pair pair_;
+    struct _TreeNode* left_;
+    struct _TreeNode* right_;
+    unsigned* ref_pair_;
+    unsigned ref_;
+    bool red_;
+} TreeNode;
+
+struct _PersistentTreeMapData {
+    unsigned size_;
+    unsigned ref_;
+    unsigned num_spare_;
+    TreeNode* root_;
+    TreeNode* spare_;
+    PersistentTreeMapCompare func_cmp_;
+    PersistentTreeMapCleanKey func_clean_key_;
+    PersistentTreeMapCleanValue func_clean_val_;
+    Allocator alloc_;
+    pthread_mutex_t lock_;
+};
+
+struct _PersistentTreeMapView {
+    PersistentTreeMapData* data_;
+    TreeNode* root_;
+    unsigned size_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief The default function for key comparison.
+ *
+ * @param lhs           The source key
+ * @param rhs           The target key
+ *
+ * @retval 1            The source key should go after the target one
+ * @retval 0            The source key is equal to the target one
+ * @retval -1           The source key should go before the target one
+ */
+int _PersistentTreeMapCompare(void* lhs, void* rhs);
+
+/**
+ * @brief Drop a reference to the node, and reclaim the node together with
+ * its pair and its subtrees if no version refers to it.
+ *
+ * @param data          The pointer to the map private data
+ * @param node          The pointer to the node or NULL
+ */
+void _PersistentTreeMapRelease(PersistentTreeMapData* data, TreeNode* node);
+
+/**
+ * @brief Return the node exclusively owned by the current version.
+ *
+ * The node shared with the snapshots is replaced by a copy drawn from the
+ * spare nodes, and the copy shares the subtrees and the pair of the original.
+ *
+ * @param data          The pointer to the map private data
+ * @param node          The pointer to the node linked by an owned parent
+ *
+ * @retval node         The pointer to the owned node
+ */
+TreeNode* _PersistentTreeMapOwn(PersistentTreeMapData* data, TreeNode* node);
+
+/**
+ * @brief Prepare the spare nodes for the worst case copies of an update.
+ *
+ * The copies are drawn from the spare nodes, so the update never fails after
+ * it starts to restructure the tree.
+ *
+ * @param data          The pointer to the map private data
+ * @param size          The largest number of pairs during the update
+ *
+ * @retval true         The spare nodes are ready
+ * @retval false        Insufficient memory
+ */
+bool _PersistentTreeMapReserve(PersistentTreeMapData* data, unsigned size);
+
+/**
+ * @brief Search the subtree for the node holding the designated key.
+ *
+ * @param data          The pointer to the map private data
+ * @param node          The root of the subtree
+ * @param key           The designated key
+ *
+ * @retval node         The pointer to the node holding the key
+ * @retval NULL         The key cannot be found
+ */
+TreeNode* _PersistentTreeMapSearch(PersistentTreeMapData* data, TreeNode* node,
+                                   void* key);
+
+/**
+ * @brief Insert the new node into the owned subtree.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The root of the subtree
+ * @param node          The new node
+ * @param p_new         The pointer to the returned flag telling whether the
+ *                      node is linked, or only its pair replaces an existing
+ *                      one
+ *
+ * @retval curr         The new root of the subtree
+ */
+TreeNode* _PersistentTreeMapInsert(PersistentTreeMapData* data, TreeNode* curr,
+                                   TreeNode* node, bool* p_new);
+
+/**
+ * @brief Remove the designated key from the owned subtree.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The root of the subtree, which contains the key
+ * @param key           The designated key
+ *
+ * @retval curr         The new root of the subtree
+ */
+TreeNode* _PersistentTreeMapRemove(PersistentTreeMapData* data, TreeNode* curr,
+                                   void* key);
+
+/**
+ * @brief Remove the minimum node from the owned subtree.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The root of the subtree
+ *
+ * @retval curr         The new root of the subtree
+ */
+TreeNode* _PersistentTreeMapRemoveMin(PersistentTreeMapData* data,
+                                      TreeNode* curr);
+
+/**
+ * @brief Drop a reference to the private data, which is shared by the map and
+ * the snapshots, and release the data with the last reference.
+ *
+ * @param data          The pointer to the map private data
+ */
+void _PersistentTreeMapDrop(PersistentTreeMapData* data);
+
+/**
+ * Check if the node is red. The absent node is black.
+ */
+static inline bool RED(TreeNode* node)
+{
+    return node && node->red_;
+}
+
+/**
+ * Add a reference to the node.
+ */
+static inline void RETAIN(TreeNode* node)
+{
+    if (node)
+        __atomic_fetch_add(&(node->ref_), 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Drop a reference to the pair, and clean it if no node refers to it.
+ */
+static inline void RELEASE_PAIR(PersistentTreeMapData* data, TreeNode* node)
+{
+    if (__atomic_sub_fetch(node->ref_pair_, 1, __ATOMIC_ACQ_REL) > 0)
+        return;
+    if (data->func_clean_key_)
+        data->func_clean_key_(node->pair_.key);
+    if (data->func_clean_val_)
+        data->func_clean_val_(node->pair_.value);
+    data->alloc_.free(data->alloc_.ctx, node->ref_pair_);
+}
+
+/**
+ * Make the children of the owned node owned before modifying them.
+ */
+static inline void OWN_LEFT(PersistentTreeMapData* data, TreeNode* node)
+{
+    node->left_ = _PersistentTreeMapOwn(data, node->left_);
+}
+
+static inline void OWN_RIGHT(PersistentTreeMapData* data, TreeNode* node)
+{
+    node->right_ = _PersistentTreeMapOwn(data, node->right_);
+}
+
+/**
+ * Rotate the red right link of the owned node to the left.
+ */
+static inline TreeNode* ROTATE_LEFT(PersistentTreeMapData* data, TreeNode* node)
+{
+    OWN_RIGHT(data, node);
+    TreeNode* child = node->right_;
+    node->right_ = child->left_;
+    child->left_ = node;
+    child->red_ = node->red_;
+    node->red_ = true;
+    return child;
+}
+
+/**
+ * Rotate the red left link of the owned node to the right.
+ */
+static inline TreeNode* ROTATE_RIGHT(PersistentTreeMapData* data, TreeNode* node)
+{
+    OWN_LEFT(data, node);
+    TreeNode* child = node->left_;
+    node->left_ = child->right_;
+    child->right_ = node;
+    child->red_ = node->red_;
+    node->red_ = true;
+    return child;
+}
+
+/**
+ * Flip the colors of the owned node and its two children.
+ */
+static inline void FLIP(PersistentTreeMapData* data, TreeNode* node)
+{
+    OWN_LEFT(data, node);
+    OWN_RIGHT(data, node);
+    node->red_ = !node->red_;
+    node->left_->red_ = !node->left_->red_;
+    node->right_->red_ = !node->right_->red_;
+}
+
+/**
+ * Restore the left leaning invariant of the owned node on the way up.
+ */
+static inline TreeNode* BALANCE(PersistentTreeMapData* data, TreeNode* node)
+{
+    if (RED(node->right_) && !RED(node->left_))
+        node = ROTATE_LEFT(data, node);
+    if (RED(node->left_) && RED(node->left_->left_))
+        node = ROTATE_RIGHT(data, node);
+    if (RED(node->left_) && RED(node->right_))
+        FLIP(data, node);
+    return node;
+}
+
+/**
+ * Make the left child or one of its children red before descending to the
+ * left, so that the removal never ends at a black leaf.
+ */
+static inline TreeNode* MOVE_RED_LEFT(PersistentTreeMapData* data,
+                                      TreeNode* node)
+{
+    FLIP(data, node);
+    if (RED(node->right_->left_)) {
+        node->right_ = ROTATE_RIGHT(data, node->right_);
+        node = ROTATE_LEFT(data, node);
+        FLIP(data, node);
+    }
+    return node;
+}
+
+/**
+ * Make the right child or one of its children red before descending to the
+ * right.
+ */
+static inline TreeNode* MOVE_RED_RIGHT(PersistentTreeMapData* data,
+                                       TreeNode* node)
+{
+    FLIP(data, node);
+    if (RED(node->left_->left_)) {
+        node = ROTATE_RIGHT(data, node);
+        FLIP(data, node);
+    }
+    return node;
+}
+
+/**
+ * Push the node and its left descendants onto the iterator stack.
+ */
+static inline void PUSH_SPINE(PersistentTreeMapIter* iter, TreeNode* node)
+{
+    while (node) {
+        iter->stack_[iter->depth_++] = node;
+        node = node->left_;
+    }
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+PersistentTreeMap* PersistentTreeMapInit()
+{
+    PersistentTreeMap* obj = (PersistentTreeMap*)malloc(sizeof(PersistentTreeMap));
+    if (unlikely(!obj))
+        return NULL;
+
+    PersistentTreeMapData* data =
+        (PersistentTreeMapData*)malloc(sizeof(PersistentTreeMapData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    if (unlikely(pthread_mutex_init(&(data->lock_), NULL) != 0)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+
+    data->size_ = 0;
+    data->ref_ = 1;
+    data->num_spare_ = 0;
+    data->root_ = NULL;
+    data->spare_ = NULL;
+    data->func_cmp_ = _PersistentTreeMapCompare;
+    data->func_clean_key_ = NULL;
+    data->func_clean_val_ = NULL;
+    data->alloc_ = *CdsGetAllocator();
+
+    obj->data = data;
+    obj->put = PersistentTreeMapPut;
+    obj->get = PersistentTreeMapGet;
+    obj->find = PersistentTreeMapFind;
+    obj->remove = PersistentTreeMapRemove;
+    obj->size = PersistentTreeMapSize;
+    obj->snapshot = PersistentTreeMapSnapshot;
+    obj->set_compare = PersistentTreeMapSetCompare;
+    obj->set_clean_key = PersistentTreeMapSetCleanKey;
+    obj->set_clean_value = PersistentTreeMapSetCleanValue;
+
+    return obj;
+}
+
+void PersistentTreeMapDeinit(PersistentTreeMap* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    PersistentTreeMapData* data = obj->data;
+    _PersistentTreeMapRelease(data, data->root_);
+    data->root_ = NULL;
+
+    while (data->spare_) {
+        TreeNode* spare = data->spare_;
+        data->spare_ = spare->left_;
+        data->alloc_.free(data->alloc_.ctx, spare);
+    }
+    data->num_spare_ = 0;
+
+    _PersistentTreeMapDrop(data);
+    free(obj);
+    return;
+}
+
+bool PersistentTreeMapPut(PersistentTreeMap* self, void* key, void* value)
+{
+    PersistentTreeMapData* data = self->data;
+    Allocator* alloc = &(data->alloc_);
+
+    /* Prepare all the memory before touching the tree. */
+    TreeNode* node = (TreeNode*)alloc->alloc(alloc->ctx, sizeof(TreeNode));
+    unsigned* ref_pair = (unsigned*)alloc->alloc(alloc->ctx, sizeof(unsigned));
+    pthread_mutex_lock(&(data->lock_));
+    if (unlikely(!node || !ref_pair ||
+                 !_PersistentTreeMapReserve(data, data->size_ + 1))) {
+        pthread_mutex_unlock(&(data->lock_));
+        if (node)
+            alloc->free(alloc->ctx, node);
+        if (ref_pair)
+            alloc->free(alloc->ctx, ref_pair);
+        return false;
+    }
+
+    *ref_pair = 1;
+    node->pair_.key = key;
+    node->pair_.value = value;
+    node->left_ = NULL;
+    node->right_ = NULL;
+    node->ref_pair_ = ref_pair;
+    node->ref_ = 1;
+    node->red_ = true;
+
+    TreeNode* root = data->root_;
+    if (root)
+        root = _PersistentTreeMapOwn(data, root);
+    bool is_new;
+    root = _PersistentTreeMapInsert(data, root, node, &is_new);
+    root->red_ = false;
+    data->root_ = root;
+    if (is_new)
+        ++(data->size_);
+    pthread_mutex_unlock(&(data->lock_));
+
+    /* The pair has been moved to the existing node. */
+    if (!is_new)
+        alloc->free(alloc->ctx, node);
+    return true;
+}
+
+void* PersistentTreeMapGet(PersistentTreeMap* self, void* key)
+{
+    PersistentTreeMapData* data = self->data;
+    TreeNode* node = _PersistentTreeMapSearch(data, data->root_, key);
+    return (node)? node->pair_.value : NULL;
+}
+
+bool PersistentTreeMapFind(PersistentTreeMap* self, void* key)
+{
+    PersistentTreeMapData* data = self->data;
+    return _PersistentTreeMapSearch(data, data->root_, key) != NULL;
+}
+
+bool PersistentTreeMapRemove(PersistentTreeMap* self, void* key)
+{
+    PersistentTreeMapData* data = self->data;
+    if (!_PersistentTreeMapSearch(data, data->root_, key))
+        return false;
+
+    pthread_mutex_lock(&(data->lock_));
+    if (unlikely(!_PersistentTreeMapReserve(data, data->size_))) {
+        pthread_mutex_unlock(&(data->lock_));
+        return false;
+    }
+
+    TreeNode* root = _PersistentTreeMapOwn(data, data->root_);
+    if (!RED(root->left_) && !RED(root->right_))
+        root->red_ = true;
+    root = _PersistentTreeMapRemove(data, root, key);
+    if (root)
+        root->red_ = false;
+    data->root_ = root;
+    --(data->size_);
+    pthread_mutex_unlock(&(data->lock_));
+    return true;
+}
+
+unsigned PersistentTreeMapSize(PersistentTreeMap* self)
+{
+    return self->data->size_;
+}
+
+PersistentTreeMapView* PersistentTreeMapSnapshot(PersistentTreeMap* self)
+{
+    PersistentTreeMapView* view =
+        (PersistentTreeMapView*)malloc(sizeof(PersistentTreeMapView));
+    if (unlikely(!view))
+        return NULL;
+
+    /* The lock keeps the update from modifying the nodes it considers
+       exclusively owned while the root is being shared. */
+    PersistentTreeMapData* data = self->data;
+    pthread_mutex_lock(&(data->lock_));
+    view->data_ = data;
+    view->root_ = data->root_;
+    view->size_ = data->size_;
+    RETAIN(view->root_);
+    __atomic_fetch_add(&(data->ref_), 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&(data->lock_));
+
+    return view;
+}
+
+void PersistentTreeMapRelease(PersistentTreeMapView* view)
+{
+    if (unlikely(!view))
+        return;
+
+    /* The nodes are released before the data reference, so any shared node
+       implies a live snapshot to the update. */
+    PersistentTreeMapData* data = view->data_;
+    _PersistentTreeMapRelease(data, view->root_);
+    free(view);
+    _PersistentTreeMapDrop(data);
+    return;
+}
+
+void* PersistentTreeMapViewGet(PersistentTreeMapView* view, void* key)
+{
+    TreeNode* node = _PersistentTreeMapSearch(view->data_, view->root_, key);
+    return (node)? node->pair_.value : NULL;
+}
+
+bool PersistentTreeMapViewFind(PersistentTreeMapView* view, void* key)
+{
+    return _PersistentTreeMapSearch(view->data_, view->root_, key) != NULL;
+}
+
+unsigned PersistentTreeMapViewSize(PersistentTreeMapView* view)
+{
+    return view->size_;
+}
+
+void PersistentTreeMapViewIterInit(PersistentTreeMapView* view,
+                                   PersistentTreeMapIter* iter)
+{
+    iter->depth_ = 0;
+    PUSH_SPINE(iter, view->root_);
+    return;
+}
+
+Pair* PersistentTreeMapViewIterNext(PersistentTreeMapIter* iter)
+{
+    if (iter->depth_ == 0)
+        return NULL;
+
+    TreeNode* node = (TreeNode*)iter->stack_[--(iter->depth_)];
+    PUSH_SPINE(iter, node->right_);
+    return &(node->pair_);
+}
+
+void PersistentTreeMapSetCompare(PersistentTreeMap* self,
+                                 PersistentTreeMapCompare func)
+{
+    self->data->func_cmp_ = func;
+}
+
+void PersistentTreeMapSetCleanKey(PersistentTreeMap* self,
+                                  PersistentTreeMapCleanKey func)
+{
+    self->data->func_clean_key_ = func;
+}
+
+void PersistentTreeMapSetCleanValue(PersistentTreeMap* self,
+                                    PersistentTreeMapCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+int _PersistentTreeMapCompare(void* lhs, void* rhs)
+{
+    if ((intptr_t)lhs == (intptr_t)rhs)
+        return 0;
+    return ((intptr_t)lhs > (intptr_t)rhs)? 1 : (-1);
+}
+
+void _PersistentTreeMapRelease(PersistentTreeMapData* data, TreeNode* node)
+{
+    if (!node)
+        return;
+    if (__atomic_sub_fetch(&(node->ref_), 1, __ATOMIC_ACQ_REL) > 0)
+        return;
+
+    RELEASE_PAIR(data, node);
+    _PersistentTreeMapRelease(data, node->left_);
+    _PersistentTreeMapRelease(data, node->right_);
+    data->alloc_.free(data->alloc_.ctx, node);
+    return;
+}
+
+TreeNode* _PersistentTreeMapOwn(PersistentTreeMapData* data, TreeNode* node)
+{
+    /* The acquire load pairs with the release of the last snapshot, whose
+       reads of the node then happen before the following writes. */
+    if (__atomic_load_n(&(node->ref_), __ATOMIC_ACQUIRE) == 1)
+        return node;
+
+    TreeNode* copy = data->spare_;
+    data->spare_ = copy->left_;
+    --(data->num_spare_);
+
+    copy->pair_ = node->pair_;
+    copy->left_ = node->left_;
+    copy->right_ = node->right_;
+    copy->ref_pair_ = node->ref_pair_;
+    copy->ref_ = 1;
+    copy->red_ = node->red_;
+    RETAIN(copy->left_);
+    RETAIN(copy->right_);
+    __atomic_fetch_add(copy->ref_pair_, 1, __ATOMIC_RELAXED);
+
+    _PersistentTreeMapRelease(data, node);
+    return copy;
+}
+
+bool _PersistentTreeMapReserve(PersistentTreeMapData* data, unsigned size)
+{
+    /* Without any snapshot, all the nodes are exclusively owned. Otherwise,
+       the left leaning red black tree with n pairs is at most 2 * log(n + 1)
+       levels tall. The snapshot cannot be taken during the update, since both
+       hold the lock. */
+    unsigned num_need = 0;
+    if (__atomic_load_n(&(data->ref_), __ATOMIC_ACQUIRE) > 1) {
+        unsigned num_level = 1;
+        unsigned long long span = (unsigned long long)size + 1;
+        while (span) {
+            num_level += 2;
+            span >>= 1;
+        }
+        num_need = copy_per_level * num_level;
+    }
+
+    while (data->num_spare_ < num_need) {
+        TreeNode* spare =
+            (TreeNode*)data->alloc_.alloc(data->alloc_.ctx, sizeof(TreeNode));
+        if (unlikely(!spare))
+            return false;
+        spare->left_ = data->spare_;
+        data->spare_ = spare;
+        ++(data->num_spare_);
+    }
+
+    /* Trim the spare nodes left by the larger map. */
+    while (data->num_spare_ > num_need << 1) {
+        TreeNode* spare = data->spare_;
+        data->spare_ = spare->left_;
+        data->alloc_.free(data->alloc_.ctx, spare);
+        --(data->num_spare_);
+    }
+    return true;
+}
+
+TreeNode* _PersistentTreeMapSearch(PersistentTreeMapData* data, TreeNode* node,
+                                   void* key)
+{
+    PersistentTreeMapCompare func_cmp = data->func_cmp_;
+    while (node) {
+        int order = func_cmp(key, node->pair_.key);
+        if (order == 0)
+            return node;
+        node = (order < 0)? node->left_ : node->right_;
+    }
+    return NULL;
+}
+
+TreeNode* _PersistentTreeMapInsert(PersistentTreeMapData* data, TreeNode* curr,
+                                   TreeNode* node, bool* p_new)
+{
+    if (!curr) {
+        *p_new = true;
+        return node;
+    }
+
+    int order = data->func_cmp_(node->pair_.key, curr->pair_.key);
+    if (order == 0) {
+        /* Replace the pair, which stays visible to the snapshots sharing the
+           original one. */
+        RELEASE_PAIR(data, curr);
+        curr->pair_ = node->pair_;
+        curr->ref_pair_ = node->ref_pair_;
+        *p_new = false;
+        return curr;
+    }
+
+    if (order < 0) {
+        if (curr->left_)
+            OWN_LEFT(data, curr);
+        curr->left_ = _PersistentTreeMapInsert(data, curr->left_, node, p_new);
+    } else {
+        if (curr->right_)
+            OWN_RIGHT(data, curr);
+        curr->right_ = _PersistentTreeMapInsert(data, curr->right_, node, p_new);
+    }
+    return BALANCE(data, curr);
+}
+
+TreeNode* _PersistentTreeMapRemove(PersistentTreeMapData* data, TreeNode* curr,
+                                   void* key)
+{
+    PersistentTreeMapCompare func_cmp = data->func_cmp_;
+    if (func_cmp(key, curr->pair_.key) < 0) {
+        if (!RED(curr->left_) && !RED(curr->left_->left_))
+            curr = MOVE_RED_LEFT(data, curr);
+        OWN_LEFT(data, curr);
+        curr->left_ = _PersistentTreeMapRemove(data, curr->left_, key);
+        return BALANCE(data, curr);
+    }
+
+    if (RED(curr->left_))
+        curr = ROTATE_RIGHT(data, curr);
+    if (func_cmp(key, curr->pair_.key) == 0 && !curr->right_) {
+        _PersistentTreeMapRelease(data, curr);
+        return NULL;
+    }
+    if (!RED(curr->right_) && !RED(curr->right_->left_))
+        curr = MOVE_RED_RIGHT(data, curr);
+
+    OWN_RIGHT(data, curr);
+    if (func_cmp(key, curr->pair_.key) == 0) {
+        /* Move the successor pair here and remove the successor node. */
+        TreeNode* succ = curr->right_;
+        while (succ->left_)
+            succ = succ->left_;
+        __atomic_fetch_add(succ->ref_pair_, 1, __ATOMIC_RELAXED);
+        RELEASE_PAIR(data, curr);
+        curr->pair_ = succ->pair_;
+        curr->ref_pair_ = succ->ref_pair_;
+        curr->right_ = _PersistentTreeMapRemoveMin(data, curr->right_);
+    } else
+        curr->right_ = _PersistentTreeMapRemove(data, curr->right_, key);
+    return BALANCE(data, curr);
+}
+
+TreeNode* _PersistentTreeMapRemoveMin(PersistentTreeMapData* data,
+                                      TreeNode* curr)
+{
+    if (!curr->left_) {
+        _PersistentTreeMapRelease(data, curr);
+        return NULL;
+    }
+
+    if (!RED(curr->left_) && !RED(curr->left_->left_))
+        curr = MOVE_RED_LEFT(data, curr);
+    OWN_LEFT(data, curr);
+    curr->left_ = _PersistentTreeMapRemoveMin(data, curr->left_);
+    return BALANCE(data, curr);
+}
+
+void _PersistentTreeMapDrop(PersistentTreeMapData* data)
+{
+    if (__atomic_sub_fetch(&(data->ref_), 1, __ATOMIC_ACQ_REL) > 0)
+        return;
+
+    pthread_mutex_destroy(&(data->lock_));
+    free(data);
+    return;
+}
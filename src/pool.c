@@ -0,0 +1,239 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "memory/pool.h"
+
+
+/*===========================================================================*
+ *                        The pool private data                              *
+ *===========================================================================*/
+static const unsigned init_slab_obj = 64;
+static const unsigned max_slab_obj = 4096;
+
+
+typedef struct _Slab {
+    struct _Slab* next_;
+} Slab;
+
+typedef struct _Chunk {
+    struct _Chunk* next_;
+} Chunk;
+
+struct _PoolData {
+    unsigned size_;
+    unsigned num_slab_obj_;
+    size_t size_obj_;
+    char* bump_;
+    char* limit_;
+    Slab* slab_;
+    Chunk* free_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief Allocate a new slab and make it the current bump region.
+ *
+ * @param data          The pointer to the pool private data
+ * @param num_obj       The number of objects held by the slab
+ *
+ * @retval true         The slab is successfully allocated
+ * @retval false        Insufficient memory space
+ */
+bool _PoolExpand(PoolData* data, unsigned num_obj);
+
+/**
+ * @brief The allocation function for the exported allocator.
+ *
+ * @param ctx           The pointer to Pool structure
+ * @param size          The designated size in bytes
+ *
+ * @retval ptr          The pointer to the acquired object
+ * @retval NULL         Insufficient memory space or oversized request
+ */
+void* _PoolAllocatorAlloc(void* ctx, size_t size);
+
+/**
+ * @brief The release function for the exported allocator.
+ *
+ * @param ctx           The pointer to Pool structure
+ * @param ptr           The pointer to the object
+ */
+void _PoolAllocatorFree(void* ctx, void* ptr);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+Pool* PoolInit(size_t size_obj)
+{
+    Pool* obj = (Pool*)malloc(sizeof(Pool));
+    if (unlikely(!obj))
+        return NULL;
+
+    PoolData* data = (PoolData*)malloc(sizeof(PoolData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    /* Each object should be large enough to hold the free list link and be
+       aligned to the pointer size. */
+    if (size_obj < sizeof(Chunk))
+        size_obj = sizeof(Chunk);
+    size_t align = sizeof(void*);
+    size_obj = (size_obj + align - 1) & ~(align - 1);
+
+    data->size_ = 0;
+    data->num_slab_obj_ = init_slab_obj;
+    data->size_obj_ = size_obj;
+    data->bump_ = NULL;
+    data->limit_ = NULL;
+    data->slab_ = NULL;
+    data->free_ = NULL;
+
+    obj->data = data;
+    obj->alloc = PoolAlloc;
+    obj->free = PoolFree;
+    obj->size = PoolSize;
+    obj->reserve = PoolReserve;
+    obj->get_allocator = PoolGetAllocator;
+
+    return obj;
+}
+
+void PoolDeinit(Pool* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    PoolData* data = obj->data;
+    Slab* curr = data->slab_;
+    while (curr) {
+        Slab* pred = curr;
+        curr = curr->next_;
+        free(pred);
+    }
+
+    free(data);
+    free(obj);
+    return;
+}
+
+void* PoolAlloc(Pool* self)
+{
+    PoolData* data = self->data;
+
+    /* Recycle the returned object first. */
+    Chunk* chunk = data->free_;
+    if (chunk) {
+        data->free_ = chunk->next_;
+        ++(data->size_);
+        return chunk;
+    }
+
+    /* Carve a new object from the current slab. */
+    if (unlikely(data->bump_ == data->limit_)) {
+        unsigned num_obj = data->num_slab_obj_;
+        if (unlikely(!_PoolExpand(data, num_obj)))
+            return NULL;
+        if (num_obj < max_slab_obj)
+            data->num_slab_obj_ = num_obj << 1;
+    }
+    void* ptr = data->bump_;
+    data->bump_ += data->size_obj_;
+    ++(data->size_);
+    return ptr;
+}
+
+void PoolFree(Pool* self, void* ptr)
+{
+    if (unlikely(!ptr))
+        return;
+
+    PoolData* data = self->data;
+    Chunk* chunk = (Chunk*)ptr;
+    chunk->next_ = data->free_;
+    data->free_ = chunk;
+    --(data->size_);
+    return;
+}
+
+unsigned PoolSize(Pool* self)
+{
+    return self->data->size_;
+}
+
+bool PoolReserve(Pool* self, unsigned count)
+{
+    PoolData* data = self->data;
+    size_t size_free = data->limit_ - data->bump_;
+    if (size_free >= data->size_obj_ * count)
+        return true;
+    return _PoolExpand(data, count);
+}
+
+void PoolGetAllocator(Pool* self, Allocator* alloc)
+{
+    alloc->alloc = _PoolAllocatorAlloc;
+    alloc->free = _PoolAllocatorFree;
+    alloc->ctx = self;
+    return;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+bool _PoolExpand(PoolData* data, unsigned num_obj)
+{
+    /* The slab header is padded to keep the objects aligned. */
+    size_t size_head = (sizeof(Slab) + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    Slab* slab = (Slab*)malloc(size_head + data->size_obj_ * num_obj);
+    if (unlikely(!slab))
+        return false;
+
+    slab->next_ = data->slab_;
+    data->slab_ = slab;
+    data->bump_ = (char*)slab + size_head;
+    data->limit_ = data->bump_ + data->size_obj_ * num_obj;
+    return true;
+}
+
+void* _PoolAllocatorAlloc(void* ctx, size_t size)
+{
+    Pool* pool = (Pool*)ctx;
+    if (unlikely(size > pool->data->size_obj_))
+        return NULL;
+    return PoolAlloc(pool);
+}
+
+void _PoolAllocatorFree(void* ctx, void* ptr)
+{
+    PoolFree((Pool*)ctx, ptr);
+}
@@ -27,15 +27,27 @@
 /*===========================================================================*
  *                        The container private data                         *
  *===========================================================================*/
+/* The handle records the heap slot of its element. */
+typedef struct _PriorityQueueNode {
+    unsigned idx_;
+} PriorityQueueNode;
+
+/* The handle array parallels the element array, and it is allocated when the
+   first handle is requested. */
 struct _PriorityQueueData {
     unsigned size_;
     unsigned capacity_;
+    unsigned arity_;
     void** elements_;
+    PriorityQueueNode** handles_;
     PriorityQueueCompare func_cmp_;
     PriorityQueueClean func_clean_;
+    GrowthPolicy growth_;
 };
 
 static const unsigned DEFAULT_CAPACITY = 32;
+static const unsigned DEFAULT_ARITY = 2;
+static const unsigned MAX_ARITY = 64;
 
 
 /*===========================================================================*
@@ -44,19 +56,36 @@ static const unsigned DEFAULT_CAPACITY = 32;
 #define likely(x)       __builtin_expect(!!(x), 1)
 #define unlikely(x)     __builtin_expect(!!(x), 0)
 
-static inline unsigned PARENT(unsigned idx)
+static inline unsigned PARENT(unsigned idx, unsigned arity)
+{
+    return (idx - 1) / arity;
+}
+
+static inline unsigned CHILD(unsigned idx, unsigned arity)
 {
-    return idx >> 1;
+    return idx * arity + 1;
 }
 
-static inline unsigned LEFT(unsigned idx)
+/**
+ * Store the element and its handle to the designated heap slot.
+ */
+static inline void PLACE(PriorityQueueData* data, unsigned idx, void* element,
+                         PriorityQueueNode* handle)
 {
-    return idx << 1;
+    data->elements_[idx] = element;
+    if (data->handles_) {
+        data->handles_[idx] = handle;
+        if (handle)
+            handle->idx_ = idx;
+    }
 }
 
-static inline unsigned RIGHT(unsigned idx)
+/**
+ * Get the handle of the element in the designated heap slot.
+ */
+static inline PriorityQueueNode* HANDLE(PriorityQueueData* data, unsigned idx)
 {
-    return (idx << 1) + 1;
+    return (data->handles_)? data->handles_[idx] : NULL;
 }
 
 /**
@@ -71,6 +100,64 @@ static inline unsigned RIGHT(unsigned idx)
  */
 static int _PriorityQueueCompare(const void* lhs, const void* rhs);
 
+/**
+ * @brief Reallocate the heap array with the specified capacity.
+ *
+ * @param data          The pointer to the queue private data
+ * @param capacity      The capacity which is not smaller than the queue size
+ *
+ * @retval true         The array is successfully reallocated
+ * @retval false        Insufficient memory, and the array is intact
+ */
+bool _PriorityQueueRealloc(PriorityQueueData* data, unsigned capacity);
+
+/**
+ * @brief Move the element up until its parent goes before it.
+ *
+ * @param data          The pointer to the queue private data
+ * @param idx           The heap slot of the element
+ *
+ * @retval idx          The final heap slot of the element
+ */
+unsigned _PriorityQueueSiftUp(PriorityQueueData* data, unsigned idx);
+
+/**
+ * @brief Move the element down until it goes before all its children.
+ *
+ * @param data          The pointer to the queue private data
+ * @param idx           The heap slot of the element
+ */
+void _PriorityQueueSiftDown(PriorityQueueData* data, unsigned idx);
+
+/**
+ * @brief Append the element to the heap bottom and restore the order.
+ *
+ * @param data          The pointer to the queue private data
+ * @param element       The specified element
+ * @param handle        The handle of the element or NULL
+ *
+ * @retval true         The element is successfully pushed
+ * @retval false        Insufficient memory
+ */
+bool _PriorityQueuePush(PriorityQueueData* data, void* element,
+                        PriorityQueueNode* handle);
+
+/**
+ * @brief Remove the element from the designated heap slot without cleanup.
+ *
+ * @param data          The pointer to the queue private data
+ * @param idx           The heap slot of the element
+ */
+void _PriorityQueueErase(PriorityQueueData* data, unsigned idx);
+
+/**
+ * @brief Shrink the heap array if the load drops below the shrink ratio of the
+ *        growth policy.
+ *
+ * @param data          The pointer to the queue private data
+ */
+void _PriorityQueueShrink(PriorityQueueData* data);
+
 
 /*===========================================================================*
  *               Implementation for the exported operations                  *
@@ -96,21 +183,52 @@ PriorityQueue* PriorityQueueInit()
 
     data->size_ = 0;
     data->capacity_ = DEFAULT_CAPACITY;
+    data->arity_ = DEFAULT_ARITY;
     data->elements_ = elements;
+    data->handles_ = NULL;
     data->func_cmp_ = _PriorityQueueCompare;
     data->func_clean_ = NULL;
 
+    GrowthPolicy growth = CDS_GROWTH_DEFAULT;
+    data->growth_ = growth;
+
     obj->data = data;
     obj->push = PriorityQueuePush;
     obj->top = PriorityQueueTop;
     obj->pop = PriorityQueuePop;
     obj->size = PriorityQueueSize;
+    obj->capacity = PriorityQueueCapacity;
+    obj->reserve = PriorityQueueReserve;
+    obj->shrink_to_fit = PriorityQueueShrinkToFit;
+    obj->set_growth = PriorityQueueSetGrowth;
+    obj->push_batch = PriorityQueuePushBatch;
+    obj->pop_n = PriorityQueuePopN;
+    obj->push_handle = PriorityQueuePushHandle;
+    obj->update = PriorityQueueUpdate;
+    obj->remove = PriorityQueueRemove;
+    obj->set_arity = PriorityQueueSetArity;
     obj->set_compare = PriorityQueueSetCompare;
     obj->set_clean = PriorityQueueSetClean;
 
     return obj;
 }
 
+PriorityQueue* PriorityQueueInitFromArray(void** elements, unsigned count,
+                                          PriorityQueueCompare func)
+{
+    PriorityQueue* obj = PriorityQueueInit();
+    if (unlikely(!obj))
+        return NULL;
+
+    if (func)
+        obj->data->func_cmp_ = func;
+    if (unlikely(!PriorityQueuePushBatch(obj, elements, count))) {
+        PriorityQueueDeinit(obj);
+        return NULL;
+    }
+    return obj;
+}
+
 void PriorityQueueDeinit(PriorityQueue* obj)
 {
     if (unlikely(!obj))
@@ -121,12 +239,17 @@ void PriorityQueueDeinit(PriorityQueue* obj)
     void** elements = data->elements_;
     unsigned size = data->size_;
 
+    PriorityQueueNode** handles = data->handles_;
+
     unsigned i;
     for (i = 0 ; i < size ; ++i) {
         if (func_clean)
             func_clean(elements[i]);
+        if (handles)
+            free(handles[i]);
     }
 
+    free(handles);
     free(elements);
     free(data);
     free(obj);
@@ -134,93 +257,78 @@ void PriorityQueueDeinit(PriorityQueue* obj)
 }
 
 bool PriorityQueuePush(PriorityQueue* self, void* element)
+{
+    return _PriorityQueuePush(self->data, element, NULL);
+}
+
+bool PriorityQueuePushBatch(PriorityQueue* self, void** elements,
+                            unsigned count)
 {
     PriorityQueueData* data = self->data;
-    void** elements = data->elements_;
     unsigned size = data->size_;
-    unsigned capacity = data->capacity_;
+    if (unlikely(count == 0))
+        return true;
+    if (unlikely(count > UINT_MAX - size))
+        return false;
 
-    /* If the heap is full, extend it to double capacity. */
-    if (size == capacity) {
-        unsigned new_capacity = capacity << 1;
-        void** new_elements = (void**)realloc(elements, new_capacity * sizeof(void*));
-        if (!new_elements)
+    unsigned total = size + count;
+    if (total > data->capacity_) {
+        unsigned new_capacity = CdsGrowCapacity(&(data->growth_),
+                                                data->capacity_, total);
+        if (unlikely(!_PriorityQueueRealloc(data, new_capacity)))
             return false;
-        elements = data->elements_ = new_elements;
-        data->capacity_ = new_capacity;
     }
 
-    /* Push the element to the bottom of the heap. */
-    elements[data->size_] = element;
-    data->size_ = size + 1;
-
-    /* Adjust the heap structure. */
-    PriorityQueueCompare func_cmp = data->func_cmp_;
-    unsigned curr = data->size_;
-    unsigned parent;
-    int order;
-    while (curr > 1) {
-        parent = PARENT(curr);
-        order = func_cmp(elements[curr - 1], elements[parent - 1]);
-        if (order > 0)
+    unsigned i;
+    for (i = 0 ; i < count ; ++i)
+        PLACE(data, size + i, elements[i], NULL);
+    data->size_ = total;
+    if (unlikely(total == 1))
+        return true;
+
+    /* Sift down the parents of the appended elements and then their ancestors
+       level by level. For the empty heap, it is exactly Floyd's heapify. */
+    unsigned arity = data->arity_;
+    unsigned lo = (size > 0)? PARENT(size, arity) : 0;
+    unsigned hi = PARENT(total - 1, arity);
+    while (true) {
+        unsigned idx = hi + 1;
+        while (idx > lo)
+            _PriorityQueueSiftDown(data, --idx);
+        if (lo == 0)
             break;
-        element = elements[curr - 1];
-        elements[curr - 1] = elements[parent - 1];
-        elements[parent - 1] = element;
-        curr = parent;
+        lo = PARENT(lo, arity);
+        hi = PARENT(hi, arity);
     }
-
     return true;
 }
 
 bool PriorityQueuePop(PriorityQueue* self)
 {
     PriorityQueueData* data = self->data;
-    void** elements = data->elements_;
-    PriorityQueueCompare func_cmp = data->func_cmp_;
-    PriorityQueueClean func_clean = data->func_clean_;
-    unsigned size = data->size_;
-    if (unlikely(size == 0))
+    if (unlikely(data->size_ == 0))
         return false;
 
-    /* Remove the heap top element. */
+    PriorityQueueClean func_clean = data->func_clean_;
     if (func_clean)
-        func_clean(elements[0]);
-    --size;
-    elements[0] = elements[size];
-    data->size_ = size;
-
-    /* Adjust the heap structure. */
-    unsigned curr = 1;
-    unsigned child_l, child_r, next;
-    int order;
-    do {
-        child_l = LEFT(curr);
-        if (child_l > size)
-            break;
-
-        next = curr;
-        order = func_cmp(elements[child_l - 1], elements[next - 1]);
-        if (order <= 0)
-            next = child_l;
-
-        child_r = RIGHT(curr);
-        if (child_r <= size) {
-            order = func_cmp(elements[child_r - 1], elements[next - 1]);
-            if (order <= 0)
-                next = child_r;
-        }
-
-        if (next == curr)
-            break;
+        func_clean(data->elements_[0]);
+    _PriorityQueueErase(data, 0);
+    return true;
+}
 
-        void* element = elements[next - 1];
-        elements[next - 1] = elements[curr - 1];
-        elements[curr - 1] = element;
-        curr = next;
-    } while (true);
+unsigned PriorityQueuePopN(PriorityQueue* self, void** elements,
+                           unsigned count)
+{
+    PriorityQueueData* data = self->data;
+    if (count > data->size_)
+        count = data->size_;
 
-    return true;
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        elements[i] = data->elements_[0];
+        _PriorityQueueErase(data, 0);
+    }
+    return count;
 }
 
 bool PriorityQueueTop(PriorityQueue* self, void** p_element)
@@ -237,6 +345,108 @@ unsigned PriorityQueueSize(PriorityQueue* self)
     return self->data->size_;
 }
 
+unsigned PriorityQueueCapacity(PriorityQueue* self)
+{
+    return self->data->capacity_;
+}
+
+bool PriorityQueueReserve(PriorityQueue* self, unsigned capacity)
+{
+    PriorityQueueData* data = self->data;
+    if (capacity <= data->capacity_)
+        return true;
+
+    return _PriorityQueueRealloc(data, capacity);
+}
+
+bool PriorityQueueShrinkToFit(PriorityQueue* self)
+{
+    PriorityQueueData* data = self->data;
+    unsigned size = data->size_;
+    return _PriorityQueueRealloc(data, (size > 0)? size : 1);
+}
+
+bool PriorityQueueSetGrowth(PriorityQueue* self, const GrowthPolicy* policy)
+{
+    if (unlikely(!CdsCheckGrowth(policy)))
+        return false;
+
+    self->data->growth_ = *policy;
+    return true;
+}
+
+PriorityQueueHandle PriorityQueuePushHandle(PriorityQueue* self, void* element)
+{
+    PriorityQueueData* data = self->data;
+
+    /* Track the slots of all the elements once the first handle exists. */
+    if (unlikely(!data->handles_)) {
+        data->handles_ = (PriorityQueueNode**)calloc(data->capacity_,
+                                                     sizeof(PriorityQueueNode*));
+        if (unlikely(!data->handles_))
+            return NULL;
+    }
+
+    PriorityQueueNode* handle =
+        (PriorityQueueNode*)malloc(sizeof(PriorityQueueNode));
+    if (unlikely(!handle))
+        return NULL;
+
+    if (unlikely(!_PriorityQueuePush(data, element, handle))) {
+        free(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+void PriorityQueueUpdate(PriorityQueue* self, PriorityQueueHandle handle,
+                         void* element)
+{
+    PriorityQueueData* data = self->data;
+    unsigned idx = handle->idx_;
+
+    void* origin = data->elements_[idx];
+    PriorityQueueClean func_clean = data->func_clean_;
+    if (func_clean && origin != element)
+        func_clean(origin);
+    data->elements_[idx] = element;
+
+    /* The element moves toward at most one direction. */
+    if (_PriorityQueueSiftUp(data, idx) == idx)
+        _PriorityQueueSiftDown(data, idx);
+}
+
+void PriorityQueueRemove(PriorityQueue* self, PriorityQueueHandle handle)
+{
+    PriorityQueueData* data = self->data;
+    unsigned idx = handle->idx_;
+
+    PriorityQueueClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(data->elements_[idx]);
+    _PriorityQueueErase(data, idx);
+}
+
+bool PriorityQueueSetArity(PriorityQueue* self, unsigned arity)
+{
+    if (unlikely(arity < 2 || arity > MAX_ARITY))
+        return false;
+
+    PriorityQueueData* data = self->data;
+    if (arity == data->arity_)
+        return true;
+    data->arity_ = arity;
+
+    /* Rebuild the heap bottom up for the new layout. */
+    unsigned size = data->size_;
+    if (size > 1) {
+        unsigned idx = PARENT(size - 1, arity) + 1;
+        while (idx > 0)
+            _PriorityQueueSiftDown(data, --idx);
+    }
+    return true;
+}
+
 void PriorityQueueSetCompare(PriorityQueue* self, PriorityQueueCompare func)
 {
     self->data->func_cmp_ = func;
@@ -257,3 +467,129 @@ int _PriorityQueueCompare(const void* lhs, const void* rhs)
         return 0;
     return ((intptr_t)lhs >= (intptr_t)rhs)? 1 : (-1);
 }
+
+bool _PriorityQueueRealloc(PriorityQueueData* data, unsigned capacity)
+{
+    if (capacity == data->capacity_)
+        return true;
+
+    void** new_elements = (void**)realloc(data->elements_, capacity * sizeof(void*));
+    if (unlikely(!new_elements))
+        return false;
+    data->elements_ = new_elements;
+
+    /* Both arrays hold at least the recorded capacity. If the handle array
+       cannot be shrunk, the larger one still works. */
+    if (data->handles_) {
+        PriorityQueueNode** new_handles = (PriorityQueueNode**)
+            realloc(data->handles_, capacity * sizeof(PriorityQueueNode*));
+        if (likely(new_handles))
+            data->handles_ = new_handles;
+        else if (capacity > data->capacity_)
+            return false;
+    }
+
+    data->capacity_ = capacity;
+    return true;
+}
+
+unsigned _PriorityQueueSiftUp(PriorityQueueData* data, unsigned idx)
+{
+    void** elements = data->elements_;
+    PriorityQueueCompare func_cmp = data->func_cmp_;
+    unsigned arity = data->arity_;
+    void* element = elements[idx];
+    PriorityQueueNode* handle = HANDLE(data, idx);
+
+    /* Shift the parents down along the path and fill the hole at last. */
+    while (idx > 0) {
+        unsigned parent = PARENT(idx, arity);
+        if (func_cmp(element, elements[parent]) > 0)
+            break;
+        PLACE(data, idx, elements[parent], HANDLE(data, parent));
+        idx = parent;
+    }
+
+    PLACE(data, idx, element, handle);
+    return idx;
+}
+
+void _PriorityQueueSiftDown(PriorityQueueData* data, unsigned idx)
+{
+    void** elements = data->elements_;
+    PriorityQueueCompare func_cmp = data->func_cmp_;
+    unsigned arity = data->arity_;
+    unsigned size = data->size_;
+    void* element = elements[idx];
+    PriorityQueueNode* handle = HANDLE(data, idx);
+
+    while (true) {
+        unsigned child = CHILD(idx, arity);
+        if (child >= size)
+            break;
+
+        /* Select the child which should go first among the siblings. */
+        unsigned bound = (size - child > arity)? child + arity : size;
+        unsigned next = child;
+        for (++child ; child < bound ; ++child) {
+            if (func_cmp(elements[child], elements[next]) <= 0)
+                next = child;
+        }
+
+        if (func_cmp(elements[next], element) > 0)
+            break;
+        PLACE(data, idx, elements[next], HANDLE(data, next));
+        idx = next;
+    }
+
+    PLACE(data, idx, element, handle);
+}
+
+bool _PriorityQueuePush(PriorityQueueData* data, void* element,
+                        PriorityQueueNode* handle)
+{
+    unsigned size = data->size_;
+    unsigned capacity = data->capacity_;
+
+    /* If the heap is full, extend it by the growth policy. */
+    if (size == capacity) {
+        if (unlikely(capacity == UINT_MAX))
+            return false;
+        unsigned new_capacity = CdsGrowCapacity(&(data->growth_), capacity,
+                                                capacity + 1);
+        if (unlikely(!_PriorityQueueRealloc(data, new_capacity)))
+            return false;
+    }
+
+    /* Push the element to the bottom of the heap and adjust the structure. */
+    PLACE(data, size, element, handle);
+    data->size_ = size + 1;
+    _PriorityQueueSiftUp(data, size);
+    return true;
+}
+
+void _PriorityQueueErase(PriorityQueueData* data, unsigned idx)
+{
+    free(HANDLE(data, idx));
+
+    /* Fill the hole with the bottom element and adjust the structure. */
+    unsigned size = data->size_ - 1;
+    data->size_ = size;
+    if (idx < size) {
+        PLACE(data, idx, data->elements_[size], HANDLE(data, size));
+        if (_PriorityQueueSiftUp(data, idx) == idx)
+            _PriorityQueueSiftDown(data, idx);
+    }
+
+    _PriorityQueueShrink(data);
+}
+
+void _PriorityQueueShrink(PriorityQueueData* data)
+{
+    unsigned capacity = data->capacity_;
+    unsigned shrunk = CdsShrinkCapacity(&(data->growth_), capacity, data->size_);
+
+    /* The heap is still valid if the reallocation fails. */
+    if (unlikely(shrunk < capacity))
+        _PriorityQueueRealloc(data, shrunk);
+}
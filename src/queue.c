@@ -34,6 +34,7 @@ struct _QueueData {
     unsigned capacity_;
     void** elements_;
     QueueClean func_clean_;
+    GrowthPolicy growth_;
 };
 
 static const unsigned DEFAULT_CAPACITY = 32;
@@ -45,6 +46,26 @@ static const unsigned DEFAULT_CAPACITY = 32;
 #define likely(x)       __builtin_expect(!!(x), 1)
 #define unlikely(x)     __builtin_expect(!!(x), 0)
 
+/**
+ * @brief Relocate the circular elements to a new array with the specified
+ *        capacity, and let the front element lead the array.
+ *
+ * @param data          The pointer to the queue private data
+ * @param capacity      The capacity which is not smaller than the queue size
+ *
+ * @retval true         The elements are successfully relocated
+ * @retval false        Insufficient memory, and the array is intact
+ */
+bool _QueueRealloc(QueueData* data, unsigned capacity);
+
+/**
+ * @brief Shrink the internal array if the load drops below the shrink ratio
+ *        of the growth policy.
+ *
+ * @param data          The pointer to the queue private data
+ */
+void _QueueShrink(QueueData* data);
+
 
 /*===========================================================================*
  *               Implementation for the exported operations                  *
@@ -75,12 +96,19 @@ Queue* QueueInit()
     data->elements_ = elements;
     data->func_clean_ = NULL;
 
+    GrowthPolicy growth = CDS_GROWTH_DEFAULT;
+    data->growth_ = growth;
+
     obj->data = data;
     obj->push = QueuePush;
     obj->front = QueueFront;
     obj->back = QueueBack;
     obj->pop = QueuePop;
     obj->size = QueueSize;
+    obj->capacity = QueueCapacity;
+    obj->reserve = QueueReserve;
+    obj->shrink_to_fit = QueueShrinkToFit;
+    obj->set_growth = QueueSetGrowth;
     obj->set_clean = QueueSetClean;
 
     return obj;
@@ -117,29 +145,22 @@ void QueueDeinit(Queue* obj)
 bool QueuePush(Queue* self, void* element)
 {
     QueueData* data = self->data;
-    void** elements = data->elements_;
     unsigned size = data->size_;
     unsigned capacity = data->capacity_;
 
-    /* If the internal array is full, extend it to double capacity. */
+    /* If the internal array is full, extend it by the growth policy. */
     if (unlikely(size == capacity)) {
-        unsigned new_capacity = capacity << 1;
-        void** new_elements = (void**)realloc(elements, new_capacity * sizeof(void*));
-        if (unlikely(!new_elements))
+        if (unlikely(capacity == UINT_MAX))
             return false;
-        elements = data->elements_ = new_elements;
-        capacity = data->capacity_ = new_capacity;
-
-        /* If back index is smaller than front index, we should migrate the
-           circularly pushed elements to the newly allocated space. */
-        unsigned back = data->back_;
-        if (back <= data->front_) {
-            memmove(elements + size, elements, sizeof(void*) * back);
-            data->back_ += size;
-        }
+        unsigned new_capacity = CdsGrowCapacity(&(data->growth_), capacity,
+                                                capacity + 1);
+        if (unlikely(!_QueueRealloc(data, new_capacity)))
+            return false;
+        capacity = new_capacity;
     }
 
     /* Insert the element to the tail of the array. */
+    void** elements = data->elements_;
     unsigned back = data->back_;
     elements[back++] = element;
     if (unlikely(back == capacity))
@@ -193,6 +214,7 @@ bool QueuePop(Queue* self)
     data->front_ = front;
     data->size_ = size - 1;
 
+    _QueueShrink(data);
     return true;
 }
 
@@ -201,7 +223,80 @@ unsigned QueueSize(Queue* self)
     return self->data->size_;
 }
 
+unsigned QueueCapacity(Queue* self)
+{
+    return self->data->capacity_;
+}
+
+bool QueueReserve(Queue* self, unsigned capacity)
+{
+    QueueData* data = self->data;
+    if (capacity <= data->capacity_)
+        return true;
+
+    return _QueueRealloc(data, capacity);
+}
+
+bool QueueShrinkToFit(Queue* self)
+{
+    QueueData* data = self->data;
+    unsigned size = data->size_;
+    return _QueueRealloc(data, (size > 0)? size : 1);
+}
+
+bool QueueSetGrowth(Queue* self, const GrowthPolicy* policy)
+{
+    if (unlikely(!CdsCheckGrowth(policy)))
+        return false;
+
+    self->data->growth_ = *policy;
+    return true;
+}
+
 void QueueSetClean(Queue* self, QueueClean func)
 {
     self->data->func_clean_ = func;
 }
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+bool _QueueRealloc(QueueData* data, unsigned capacity)
+{
+    if (capacity == data->capacity_)
+        return true;
+
+    void** new_elements = (void**)malloc(capacity * sizeof(void*));
+    if (unlikely(!new_elements))
+        return false;
+
+    /* Unwrap the circular elements while copying them. */
+    void** elements = data->elements_;
+    unsigned size = data->size_;
+    unsigned front = data->front_;
+    unsigned num_head = data->capacity_ - front;
+    if (num_head >= size) {
+        memcpy(new_elements, elements + front, sizeof(void*) * size);
+    } else {
+        memcpy(new_elements, elements + front, sizeof(void*) * num_head);
+        memcpy(new_elements + num_head, elements, sizeof(void*) * (size - num_head));
+    }
+    free(elements);
+
+    data->elements_ = new_elements;
+    data->capacity_ = capacity;
+    data->front_ = 0;
+    data->back_ = (size == capacity)? 0 : size;
+    return true;
+}
+
+void _QueueShrink(QueueData* data)
+{
+    unsigned capacity = data->capacity_;
+    unsigned shrunk = CdsShrinkCapacity(&(data->growth_), capacity, data->size_);
+
+    /* The array is still valid if the reallocation fails. */
+    if (unlikely(shrunk < capacity))
+        _QueueRealloc(data, shrunk);
+}
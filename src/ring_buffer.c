@@ -0,0 +1,417 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/ring_buffer.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const unsigned default_capacity = 1024;
+static const unsigned max_capacity = 1u << 31;
+static const size_t size_cache_line = 64;
+
+
+/* The slot of the multiple producer multiple consumer buffer. The sequence
+   number tells whether the slot is ready for the producer or the consumer
+   holding the ticket of the current round. */
+typedef struct _Slot {
+    size_t seq_;
+    void* element_;
+} Slot;
+
+/* The producer index and the consumer index occupy their own cache lines. The
+   single producer single consumer buffer also caches the index of the opposite
+   side to avoid touching the shared cache line on every operation. */
+struct _RingBufferData {
+    size_t back_ __attribute__((aligned(64)));
+    size_t cache_front_;
+    size_t front_ __attribute__((aligned(64)));
+    size_t cache_back_;
+    size_t mask_ __attribute__((aligned(64)));
+    bool is_mpmc_;
+    void** elements_;
+    Slot* slots_;
+    RingBufferClean func_clean_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Load the index owned by the current side.
+ */
+static inline size_t LOAD_RELAXED(size_t* index)
+{
+    return __atomic_load_n(index, __ATOMIC_RELAXED);
+}
+
+/**
+ * Load the index published by the opposite side.
+ */
+static inline size_t LOAD_ACQUIRE(size_t* index)
+{
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Publish the index to the opposite side.
+ */
+static inline void STORE_RELEASE(size_t* index, size_t value)
+{
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Push a batch of elements to the single producer buffer.
+ *
+ * @param data          The pointer to the buffer private data
+ * @param elements      The array of the elements to push
+ * @param count         The number of the elements
+ *
+ * @retval num          The number of the pushed elements
+ */
+unsigned _RingBufferPushSpsc(RingBufferData* data, void** elements,
+                             unsigned count);
+
+/**
+ * @brief Retrieve a batch of elements from the single consumer buffer.
+ *
+ * @param data          The pointer to the buffer private data
+ * @param elements      The array to store the returned elements
+ * @param count         The maximum number of the elements to retrieve
+ *
+ * @retval num          The number of the retrieved elements
+ */
+unsigned _RingBufferPopSpsc(RingBufferData* data, void** elements,
+                            unsigned count);
+
+/**
+ * @brief Push a batch of elements to the multiple producer buffer.
+ *
+ * The producer claims the run of the consecutive free slots by advancing the
+ * back index once, fills them, and then publishes them one by one.
+ *
+ * @param data          The pointer to the buffer private data
+ * @param elements      The array of the elements to push
+ * @param count         The number of the elements
+ *
+ * @retval num          The number of the pushed elements
+ */
+unsigned _RingBufferPushMpmc(RingBufferData* data, void** elements,
+                             unsigned count);
+
+/**
+ * @brief Retrieve a batch of elements from the multiple consumer buffer.
+ *
+ * @param data          The pointer to the buffer private data
+ * @param elements      The array to store the returned elements
+ * @param count         The maximum number of the elements to retrieve
+ *
+ * @retval num          The number of the retrieved elements
+ */
+unsigned _RingBufferPopMpmc(RingBufferData* data, void** elements,
+                            unsigned count);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+RingBuffer* RingBufferInit(unsigned capacity, bool is_mpmc)
+{
+    RingBuffer* obj = (RingBuffer*)malloc(sizeof(RingBuffer));
+    if (unlikely(!obj))
+        return NULL;
+
+    RingBufferData* data;
+    if (unlikely(posix_memalign((void**)&data, size_cache_line,
+                                sizeof(RingBufferData)) != 0)) {
+        free(obj);
+        return NULL;
+    }
+
+    /* Round the capacity up to the power of two for mask indexing. The
+       sequence numbers need at least two slots to tell the rounds apart. */
+    if (capacity == 0)
+        capacity = default_capacity;
+    if (capacity > max_capacity)
+        capacity = max_capacity;
+    unsigned count = 2;
+    while (count < capacity)
+        count <<= 1;
+    capacity = count;
+
+    data->elements_ = NULL;
+    data->slots_ = NULL;
+    if (is_mpmc) {
+        data->slots_ = (Slot*)malloc(sizeof(Slot) * capacity);
+        if (unlikely(!data->slots_)) {
+            free(data);
+            free(obj);
+            return NULL;
+        }
+        unsigned i;
+        for (i = 0 ; i < capacity ; ++i)
+            data->slots_[i].seq_ = i;
+    } else {
+        data->elements_ = (void**)malloc(sizeof(void*) * capacity);
+        if (unlikely(!data->elements_)) {
+            free(data);
+            free(obj);
+            return NULL;
+        }
+    }
+
+    data->back_ = 0;
+    data->cache_front_ = 0;
+    data->front_ = 0;
+    data->cache_back_ = 0;
+    data->mask_ = capacity - 1;
+    data->is_mpmc_ = is_mpmc;
+    data->func_clean_ = NULL;
+
+    obj->data = data;
+    obj->push = RingBufferPush;
+    obj->pop = RingBufferPop;
+    obj->push_n = RingBufferPushN;
+    obj->pop_n = RingBufferPopN;
+    obj->size = RingBufferSize;
+    obj->capacity = RingBufferCapacity;
+    obj->set_clean = RingBufferSetClean;
+
+    return obj;
+}
+
+void RingBufferDeinit(RingBuffer* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    RingBufferData* data = obj->data;
+    RingBufferClean func_clean = data->func_clean_;
+    if (func_clean) {
+        void* element;
+        while (RingBufferPop(obj, &element))
+            func_clean(element);
+    }
+
+    free(data->elements_);
+    free(data->slots_);
+    free(data);
+    free(obj);
+    return;
+}
+
+bool RingBufferPush(RingBuffer* self, void* element)
+{
+    return RingBufferPushN(self, &element, 1) == 1;
+}
+
+bool RingBufferPop(RingBuffer* self, void** p_element)
+{
+    return RingBufferPopN(self, p_element, 1) == 1;
+}
+
+unsigned RingBufferPushN(RingBuffer* self, void** elements, unsigned count)
+{
+    RingBufferData* data = self->data;
+    if (data->is_mpmc_)
+        return _RingBufferPushMpmc(data, elements, count);
+    return _RingBufferPushSpsc(data, elements, count);
+}
+
+unsigned RingBufferPopN(RingBuffer* self, void** elements, unsigned count)
+{
+    RingBufferData* data = self->data;
+    if (data->is_mpmc_)
+        return _RingBufferPopMpmc(data, elements, count);
+    return _RingBufferPopSpsc(data, elements, count);
+}
+
+unsigned RingBufferSize(RingBuffer* self)
+{
+    RingBufferData* data = self->data;
+    size_t front = LOAD_ACQUIRE(&(data->front_));
+    size_t back = LOAD_ACQUIRE(&(data->back_));
+
+    /* The indexes are loaded separately, so clamp the transient skew. */
+    size_t size = back - front;
+    if (unlikely((intptr_t)size < 0))
+        return 0;
+    if (unlikely(size > data->mask_ + 1))
+        return data->mask_ + 1;
+    return size;
+}
+
+unsigned RingBufferCapacity(RingBuffer* self)
+{
+    return self->data->mask_ + 1;
+}
+
+void RingBufferSetClean(RingBuffer* self, RingBufferClean func)
+{
+    self->data->func_clean_ = func;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+unsigned _RingBufferPushSpsc(RingBufferData* data, void** elements,
+                             unsigned count)
+{
+    size_t capacity = data->mask_ + 1;
+    size_t back = LOAD_RELAXED(&(data->back_));
+
+    /* Refresh the cached consumer index only when the buffer seems full. */
+    size_t space = capacity - (back - data->cache_front_);
+    if (space < count) {
+        data->cache_front_ = LOAD_ACQUIRE(&(data->front_));
+        space = capacity - (back - data->cache_front_);
+    }
+    if (count > space)
+        count = space;
+
+    unsigned i;
+    for (i = 0 ; i < count ; ++i)
+        data->elements_[(back + i) & data->mask_] = elements[i];
+
+    STORE_RELEASE(&(data->back_), back + count);
+    return count;
+}
+
+unsigned _RingBufferPopSpsc(RingBufferData* data, void** elements,
+                            unsigned count)
+{
+    size_t front = LOAD_RELAXED(&(data->front_));
+
+    /* Refresh the cached producer index only when the buffer seems empty. */
+    size_t avail = data->cache_back_ - front;
+    if (avail < count) {
+        data->cache_back_ = LOAD_ACQUIRE(&(data->back_));
+        avail = data->cache_back_ - front;
+    }
+    if (count > avail)
+        count = avail;
+
+    unsigned i;
+    for (i = 0 ; i < count ; ++i)
+        elements[i] = data->elements_[(front + i) & data->mask_];
+
+    STORE_RELEASE(&(data->front_), front + count);
+    return count;
+}
+
+unsigned _RingBufferPushMpmc(RingBufferData* data, void** elements,
+                             unsigned count)
+{
+    if (unlikely(count == 0))
+        return 0;
+
+    Slot* slots = data->slots_;
+    size_t mask = data->mask_;
+    size_t back = LOAD_RELAXED(&(data->back_));
+    unsigned num;
+
+    while (true) {
+        /* The slot is free for the ticket when its sequence equals to it. */
+        size_t seq = LOAD_ACQUIRE(&(slots[back & mask].seq_));
+        intptr_t diff = (intptr_t)(seq - back);
+        if (diff < 0)
+            return 0;
+        if (diff > 0) {
+            back = LOAD_RELAXED(&(data->back_));
+            continue;
+        }
+
+        /* Collect the following free slots and claim them together. */
+        num = 1;
+        while (num < count && num <= mask) {
+            seq = LOAD_ACQUIRE(&(slots[(back + num) & mask].seq_));
+            if (seq != back + num)
+                break;
+            ++num;
+        }
+        if (__atomic_compare_exchange_n(&(data->back_), &back, back + num,
+                                        true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+            break;
+    }
+
+    unsigned i;
+    for (i = 0 ; i < num ; ++i) {
+        Slot* slot = slots + ((back + i) & mask);
+        slot->element_ = elements[i];
+        STORE_RELEASE(&(slot->seq_), back + i + 1);
+    }
+    return num;
+}
+
+unsigned _RingBufferPopMpmc(RingBufferData* data, void** elements,
+                            unsigned count)
+{
+    if (unlikely(count == 0))
+        return 0;
+
+    Slot* slots = data->slots_;
+    size_t mask = data->mask_;
+    size_t front = LOAD_RELAXED(&(data->front_));
+    unsigned num;
+
+    while (true) {
+        /* The slot is filled for the ticket when its sequence passes it. */
+        size_t seq = LOAD_ACQUIRE(&(slots[front & mask].seq_));
+        intptr_t diff = (intptr_t)(seq - (front + 1));
+        if (diff < 0)
+            return 0;
+        if (diff > 0) {
+            front = LOAD_RELAXED(&(data->front_));
+            continue;
+        }
+
+        num = 1;
+        while (num < count && num <= mask) {
+            seq = LOAD_ACQUIRE(&(slots[(front + num) & mask].seq_));
+            if (seq != front + num + 1)
+                break;
+            ++num;
+        }
+        if (__atomic_compare_exchange_n(&(data->front_), &front, front + num,
+                                        true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+            break;
+    }
+
+    /* Release the slots to the producers of the next round. */
+    unsigned i;
+    for (i = 0 ; i < num ; ++i) {
+        Slot* slot = slots + ((front + i) & mask);
+        elements[i] = slot->element_;
+        STORE_RELEASE(&(slot->seq_), front + i + mask + 1);
+    }
+    return num;
+}
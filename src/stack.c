@@ -33,6 +33,7 @@ struct _StackData {
     unsigned capacity_;
     void** elements_;
     StackClean func_clean_;
+    GrowthPolicy growth_;
 };
 
 static const unsigned DEFAULT_CAPACITY = 32;
@@ -44,6 +45,25 @@ static const unsigned DEFAULT_CAPACITY = 32;
 #define likely(x)       __builtin_expect(!!(x), 1)
 #define unlikely(x)     __builtin_expect(!!(x), 0)
 
+/**
+ * @brief Reallocate the internal array with the specified capacity.
+ *
+ * @param data          The pointer to the stack private data
+ * @param capacity      The capacity which is not smaller than the stack size
+ *
+ * @retval true         The array is successfully reallocated
+ * @retval false        Insufficient memory, and the array is intact
+ */
+bool _StackRealloc(StackData* data, unsigned capacity);
+
+/**
+ * @brief Shrink the internal array if the load drops below the shrink ratio
+ *        of the growth policy.
+ *
+ * @param data          The pointer to the stack private data
+ */
+void _StackShrink(StackData* data);
+
 
 /*===========================================================================*
  *               Implementation for the exported operations                  *
@@ -72,11 +92,18 @@ Stack* StackInit() {
     data->elements_ = elements;
     data->func_clean_ = NULL;
 
+    GrowthPolicy growth = CDS_GROWTH_DEFAULT;
+    data->growth_ = growth;
+
     obj->data = data;
     obj->push = StackPush;
     obj->top = StackTop;
     obj->pop = StackPop;
     obj->size = StackSize;
+    obj->capacity = StackCapacity;
+    obj->reserve = StackReserve;
+    obj->shrink_to_fit = StackShrinkToFit;
+    obj->set_growth = StackSetGrowth;
     obj->set_clean = StackSetClean;
 
     return obj;
@@ -107,22 +134,21 @@ void StackDeinit(Stack* obj) {
 bool StackPush(Stack *self, void* element) {
 
     StackData* data = self->data;
-    void** elements = data->elements_;
     unsigned size = data->size_;
     unsigned capacity = data->capacity_;
 
-    /* If the internal array is full, extend it to double capacity. */
+    /* If the internal array is full, extend it by the growth policy. */
     if (unlikely(size == capacity)) {
-        unsigned new_capacity = capacity << 1;
-        void** new_elements = (void**)realloc(elements, new_capacity * sizeof(void*));
-        if (unlikely(!new_elements))
+        if (unlikely(capacity == UINT_MAX))
+            return false;
+        unsigned new_capacity = CdsGrowCapacity(&(data->growth_), capacity,
+                                                capacity + 1);
+        if (unlikely(!_StackRealloc(data, new_capacity)))
             return false;
-        elements = data->elements_ = new_elements;
-        data->capacity_ = new_capacity;
     }
 
     /* Insert the element to the tail of the array. */
-    elements[size] = element;
+    data->elements_[size] = element;
     data->size_ = size + 1;
 
     return true;
@@ -143,6 +169,7 @@ bool StackPop(Stack *self) {
         func_clean(elements[size]);
     data->size_ = size;
 
+    _StackShrink(data);
     return true;
 }
 
@@ -162,6 +189,63 @@ unsigned StackSize(Stack *self) {
     return self->data->size_;
 }
 
+unsigned StackCapacity(Stack* self) {
+    return self->data->capacity_;
+}
+
+bool StackReserve(Stack* self, unsigned capacity) {
+
+    StackData* data = self->data;
+    if (capacity <= data->capacity_)
+        return true;
+
+    return _StackRealloc(data, capacity);
+}
+
+bool StackShrinkToFit(Stack* self) {
+
+    StackData* data = self->data;
+    unsigned size = data->size_;
+    return _StackRealloc(data, (size > 0)? size : 1);
+}
+
+bool StackSetGrowth(Stack* self, const GrowthPolicy* policy) {
+
+    if (unlikely(!CdsCheckGrowth(policy)))
+        return false;
+
+    self->data->growth_ = *policy;
+    return true;
+}
+
 void StackSetClean(Stack* self, StackClean func) {
     self->data->func_clean_ = func;
 }
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+bool _StackRealloc(StackData* data, unsigned capacity) {
+
+    if (capacity == data->capacity_)
+        return true;
+
+    void** new_elements = (void**)realloc(data->elements_, capacity * sizeof(void*));
+    if (unlikely(!new_elements))
+        return false;
+
+    data->elements_ = new_elements;
+    data->capacity_ = capacity;
+    return true;
+}
+
+void _StackShrink(StackData* data) {
+
+    unsigned capacity = data->capacity_;
+    unsigned shrunk = CdsShrinkCapacity(&(data->growth_), capacity, data->size_);
+
+    /* The array is still valid if the reallocation fails. */
+    if (unlikely(shrunk < capacity))
+        _StackRealloc(data, shrunk);
+}
@@ -0,0 +1,486 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/timer_wheel.h"
+#include "memory/pool.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+/* The node is linked through the pointer to its predecessor link, so it can
+   be unlinked without knowing the slot head. */
+typedef struct _TimerWheelNode {
+    struct _TimerWheelNode* next_;
+    struct _TimerWheelNode** p_prev_;
+    uint64_t expire_;
+    void* element_;
+    unsigned slot_;
+} TimerWheelNode;
+
+#define LEVEL_BITS      (6)
+#define NUM_SLOT        (1 << LEVEL_BITS)
+#define NUM_LEVEL       (11)
+
+/* The pseudo slots for the timers beyond the wheel. */
+static const unsigned SLOT_DUE = NUM_LEVEL * NUM_SLOT;
+static const unsigned SLOT_FIRING = NUM_LEVEL * NUM_SLOT + 1;
+
+#define SIZE_BATCH      (64)
+
+/* The timer is hashed to the level of the highest tick digit in which its
+   expiry differs from the current tick, so each occupied slot has a digit
+   larger than that of the current tick in its level. */
+struct _TimerWheelData {
+    uint64_t now_;
+    unsigned size_;
+    uint64_t bitmaps_[NUM_LEVEL];
+    TimerWheelNode* slots_[NUM_LEVEL * NUM_SLOT];
+    TimerWheelNode* due_;
+    TimerWheelClean func_clean_;
+    Allocator alloc_;
+    Pool* pool_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Allocate the timer node via the designated allocator.
+ */
+static inline TimerWheelNode* NEW_NODE(TimerWheelData* data)
+{
+    return (TimerWheelNode*)data->alloc_.alloc(data->alloc_.ctx,
+                                               sizeof(TimerWheelNode));
+}
+
+/**
+ * Release the timer node via the designated allocator.
+ */
+static inline void DELETE_NODE(TimerWheelData* data, TimerWheelNode* node)
+{
+    data->alloc_.free(data->alloc_.ctx, node);
+}
+
+/**
+ * Push the node to the head of the designated list.
+ */
+static inline void LINK(TimerWheelNode** p_head, TimerWheelNode* node)
+{
+    TimerWheelNode* next = *p_head;
+    node->next_ = next;
+    node->p_prev_ = p_head;
+    if (next)
+        next->p_prev_ = &(node->next_);
+    *p_head = node;
+}
+
+/**
+ * @brief Hash the node to the wheel slot or the due list by its expiry.
+ *
+ * @param data          The pointer to the wheel private data
+ * @param node          The pointer to the detached node
+ */
+void _TimerWheelPlace(TimerWheelData* data, TimerWheelNode* node);
+
+/**
+ * @brief Detach the node from its slot or list.
+ *
+ * @param data          The pointer to the wheel private data
+ * @param node          The pointer to the linked node
+ */
+void _TimerWheelUnlink(TimerWheelData* data, TimerWheelNode* node);
+
+/**
+ * @brief Detach the whole designated list to the local firing list.
+ *
+ * @param p_head        The pointer to the list head
+ * @param p_fire        The pointer to the local firing list head
+ */
+void _TimerWheelDetach(TimerWheelNode** p_head, TimerWheelNode** p_fire);
+
+/**
+ * @brief Release the nodes of the firing list and pass their elements to the
+ * expiry function in batches.
+ *
+ * The list head stays on the caller stack, so the expiry function can cancel
+ * or reschedule the nodes remaining in the list.
+ *
+ * @param data          The pointer to the wheel private data
+ * @param p_fire        The pointer to the local firing list head
+ * @param func          The expiry function
+ * @param arg           The custom argument passed to the expiry function
+ *
+ * @retval count        The number of expired timers
+ */
+unsigned _TimerWheelFire(TimerWheelData* data, TimerWheelNode** p_fire,
+                         TimerWheelExpire func, void* arg);
+
+/**
+ * @brief Find the earliest tick at which an occupied slot is reached.
+ *
+ * @param data          The pointer to the wheel private data
+ * @param p_tick        The pointer to the returned tick
+ * @param p_slot        The pointer to the returned slot index
+ *
+ * @retval true         The tick is found
+ * @retval false        The wheel is empty
+ */
+bool _TimerWheelNextSlot(TimerWheelData* data, uint64_t* p_tick,
+                         unsigned* p_slot);
+
+/**
+ * @brief Release all the pending timers and clean their elements.
+ *
+ * @param data          The pointer to the wheel private data
+ */
+void _TimerWheelDeinit(TimerWheelData* data);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+TimerWheel* TimerWheelInit(uint64_t now)
+{
+    TimerWheel* obj = (TimerWheel*)malloc(sizeof(TimerWheel));
+    if (unlikely(!obj))
+        return NULL;
+
+    TimerWheelData* data = (TimerWheelData*)malloc(sizeof(TimerWheelData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    data->now_ = now;
+    data->size_ = 0;
+    memset(data->bitmaps_, 0, sizeof(data->bitmaps_));
+    memset(data->slots_, 0, sizeof(data->slots_));
+    data->due_ = NULL;
+    data->func_clean_ = NULL;
+    data->alloc_ = *CdsGetAllocator();
+    data->pool_ = NULL;
+
+    obj->data = data;
+    obj->schedule = TimerWheelSchedule;
+    obj->reschedule = TimerWheelReschedule;
+    obj->cancel = TimerWheelCancel;
+    obj->advance = TimerWheelAdvance;
+    obj->next_expire = TimerWheelNextExpire;
+    obj->now = TimerWheelNow;
+    obj->size = TimerWheelSize;
+    obj->set_clean = TimerWheelSetClean;
+    obj->set_allocator = TimerWheelSetAllocator;
+    obj->use_pool = TimerWheelUsePool;
+
+    return obj;
+}
+
+void TimerWheelDeinit(TimerWheel* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    TimerWheelData* data = obj->data;
+
+    /* The pooled nodes are released at once, so the wheel is traversed only
+       for the element cleanup. */
+    Pool* pool = data->pool_;
+    if (!pool || data->func_clean_)
+        _TimerWheelDeinit(data);
+    if (pool)
+        PoolDeinit(pool);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+TimerWheelHandle TimerWheelSchedule(TimerWheel* self, uint64_t expire,
+                                    void* element)
+{
+    TimerWheelData* data = self->data;
+
+    TimerWheelNode* node = NEW_NODE(data);
+    if (unlikely(!node))
+        return NULL;
+
+    node->expire_ = expire;
+    node->element_ = element;
+    _TimerWheelPlace(data, node);
+    data->size_++;
+    return node;
+}
+
+void TimerWheelReschedule(TimerWheel* self, TimerWheelHandle handle,
+                          uint64_t expire)
+{
+    TimerWheelData* data = self->data;
+    _TimerWheelUnlink(data, handle);
+    handle->expire_ = expire;
+    _TimerWheelPlace(data, handle);
+}
+
+void TimerWheelCancel(TimerWheel* self, TimerWheelHandle handle)
+{
+    TimerWheelData* data = self->data;
+    _TimerWheelUnlink(data, handle);
+    if (data->func_clean_)
+        data->func_clean_(handle->element_);
+    DELETE_NODE(data, handle);
+    data->size_--;
+}
+
+unsigned TimerWheelAdvance(TimerWheel* self, uint64_t now,
+                           TimerWheelExpire func, void* arg)
+{
+    TimerWheelData* data = self->data;
+    if (unlikely(now < data->now_))
+        now = data->now_;
+
+    /* The timers scheduled to the past are expired first. */
+    TimerWheelNode* fire = NULL;
+    _TimerWheelDetach(&(data->due_), &fire);
+    unsigned count = _TimerWheelFire(data, &fire, func, arg);
+
+    /* Jump between the occupied slots. The level zero slot is expired as a
+       whole, and the higher level slot is cascaded to the lower levels. */
+    uint64_t tick;
+    unsigned slot;
+    while (_TimerWheelNextSlot(data, &tick, &slot) && tick <= now) {
+        data->now_ = tick;
+
+        TimerWheelNode* curr = data->slots_[slot];
+        data->slots_[slot] = NULL;
+        data->bitmaps_[slot / NUM_SLOT] &= ~(1ull << (slot % NUM_SLOT));
+
+        while (curr) {
+            TimerWheelNode* next = curr->next_;
+            if (curr->expire_ == tick) {
+                curr->slot_ = SLOT_FIRING;
+                LINK(&fire, curr);
+            } else
+                _TimerWheelPlace(data, curr);
+            curr = next;
+        }
+        count += _TimerWheelFire(data, &fire, func, arg);
+    }
+
+    data->now_ = now;
+    return count;
+}
+
+bool TimerWheelNextExpire(TimerWheel* self, uint64_t* p_tick)
+{
+    TimerWheelData* data = self->data;
+    if (data->due_) {
+        *p_tick = data->now_;
+        return true;
+    }
+
+    unsigned slot;
+    return _TimerWheelNextSlot(data, p_tick, &slot);
+}
+
+uint64_t TimerWheelNow(TimerWheel* self)
+{
+    return self->data->now_;
+}
+
+unsigned TimerWheelSize(TimerWheel* self)
+{
+    return self->data->size_;
+}
+
+void TimerWheelSetClean(TimerWheel* self, TimerWheelClean func)
+{
+    self->data->func_clean_ = func;
+}
+
+bool TimerWheelSetAllocator(TimerWheel* self, const Allocator* alloc)
+{
+    TimerWheelData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    if (data->pool_) {
+        PoolDeinit(data->pool_);
+        data->pool_ = NULL;
+    }
+    data->alloc_ = (alloc)? *alloc : *CdsGetAllocator();
+    return true;
+}
+
+bool TimerWheelUsePool(TimerWheel* self)
+{
+    TimerWheelData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    Pool* pool = PoolInit(sizeof(TimerWheelNode));
+    if (unlikely(!pool))
+        return false;
+
+    if (data->pool_)
+        PoolDeinit(data->pool_);
+    data->pool_ = pool;
+    PoolGetAllocator(pool, &(data->alloc_));
+    return true;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+void _TimerWheelPlace(TimerWheelData* data, TimerWheelNode* node)
+{
+    uint64_t expire = node->expire_;
+    uint64_t now = data->now_;
+
+    if (expire <= now) {
+        node->slot_ = SLOT_DUE;
+        LINK(&(data->due_), node);
+        return;
+    }
+
+    unsigned level = (63 - __builtin_clzll(expire ^ now)) / LEVEL_BITS;
+    unsigned digit = (expire >> (level * LEVEL_BITS)) & (NUM_SLOT - 1);
+    unsigned slot = level * NUM_SLOT + digit;
+
+    node->slot_ = slot;
+    LINK(&(data->slots_[slot]), node);
+    data->bitmaps_[level] |= 1ull << digit;
+}
+
+void _TimerWheelUnlink(TimerWheelData* data, TimerWheelNode* node)
+{
+    TimerWheelNode* next = node->next_;
+    *(node->p_prev_) = next;
+    if (next)
+        next->p_prev_ = node->p_prev_;
+
+    unsigned slot = node->slot_;
+    if (slot < SLOT_DUE && !data->slots_[slot])
+        data->bitmaps_[slot / NUM_SLOT] &= ~(1ull << (slot % NUM_SLOT));
+}
+
+void _TimerWheelDetach(TimerWheelNode** p_head, TimerWheelNode** p_fire)
+{
+    TimerWheelNode* head = *p_head;
+    *p_head = NULL;
+    *p_fire = head;
+    if (!head)
+        return;
+
+    head->p_prev_ = p_fire;
+    while (head) {
+        head->slot_ = SLOT_FIRING;
+        head = head->next_;
+    }
+}
+
+unsigned _TimerWheelFire(TimerWheelData* data, TimerWheelNode** p_fire,
+                         TimerWheelExpire func, void* arg)
+{
+    void* batch[SIZE_BATCH];
+    unsigned num = 0;
+    unsigned count = 0;
+
+    while (*p_fire) {
+        TimerWheelNode* node = *p_fire;
+        TimerWheelNode* next = node->next_;
+        *p_fire = next;
+        if (next)
+            next->p_prev_ = p_fire;
+
+        batch[num++] = node->element_;
+        DELETE_NODE(data, node);
+        data->size_--;
+
+        /* The callback may unlink the rest of the list, so the head is
+           reloaded after each batch. */
+        if (num == SIZE_BATCH) {
+            if (func)
+                func(batch, num, arg);
+            count += num;
+            num = 0;
+        }
+    }
+
+    if (num > 0) {
+        if (func)
+            func(batch, num, arg);
+        count += num;
+    }
+    return count;
+}
+
+bool _TimerWheelNextSlot(TimerWheelData* data, uint64_t* p_tick,
+                         unsigned* p_slot)
+{
+    uint64_t now = data->now_;
+
+    /* The lower level slot is always reached earlier, and the levels below
+       the first one having an occupied slot are empty. */
+    unsigned level;
+    for (level = 0 ; level < NUM_LEVEL ; ++level) {
+        unsigned shift = level * LEVEL_BITS;
+        unsigned digit = (now >> shift) & (NUM_SLOT - 1);
+        uint64_t mask = (digit == NUM_SLOT - 1)? 0 : ~0ull << (digit + 1);
+        uint64_t bitmap = data->bitmaps_[level] & mask;
+        if (!bitmap)
+            continue;
+
+        unsigned target = __builtin_ctzll(bitmap);
+        unsigned upper = shift + LEVEL_BITS;
+        uint64_t prefix = (upper < 64)? (now >> upper) << upper : 0;
+        *p_tick = prefix | ((uint64_t)target << shift);
+        *p_slot = level * NUM_SLOT + target;
+        return true;
+    }
+
+    return false;
+}
+
+void _TimerWheelDeinit(TimerWheelData* data)
+{
+    TimerWheelClean func_clean = data->func_clean_;
+
+    unsigned slot;
+    for (slot = 0 ; slot <= SLOT_DUE ; ++slot) {
+        TimerWheelNode* curr = (slot < SLOT_DUE)? data->slots_[slot] :
+                                                  data->due_;
+        while (curr) {
+            TimerWheelNode* next = curr->next_;
+            if (func_clean)
+                func_clean(curr->element_);
+            if (!data->pool_)
+                DELETE_NODE(data, curr);
+            curr = next;
+        }
+    }
+}
@@ -21,7 +21,9 @@
  *   IN THE SOFTWARE.
  */
 
+#include <pthread.h>
 #include "container/tree_map.h"
+#include "memory/pool.h"
 
 
 /*===========================================================================*
@@ -42,6 +44,7 @@ static const char UP_RIGHT = 4;
 
 typedef struct _TreeNode {
     char color_;
+    unsigned size_;
     Pair pair_;
     struct _TreeNode* parent_;
     struct _TreeNode* left_;
@@ -57,8 +60,33 @@ struct _TreeMapData {
     TreeMapCompare func_cmp_;
     TreeMapCleanKey func_clean_key_;
     TreeMapCleanValue func_clean_val_;
+    Allocator alloc_;
+    Pool* pool_;
+#ifdef CDS_ENABLE_STATS
+    TreeMapStats stats_;
+#endif
 };
 
+/* The union subproblem forked to a worker thread. The private data is copied
+   so that the insertion fixup of each thread has its own root scratch. */
+typedef struct _UnionTask {
+    TreeMapData data_;
+    TreeNode* lhs_;
+    TreeNode* rhs_;
+    TreeNode* root_;
+    TreeNode* dups_;
+    unsigned depth_fork_;
+} UnionTask;
+
+/* The parallel traversal whose rank ranges are claimed by the workers. */
+typedef struct _TraverseTask {
+    TreeMapData* data_;
+    TreeMapVisit func_visit_;
+    void* arg_;
+    const Reducer* reducer_;
+    unsigned num_chunk_;
+} TraverseTask;
+
 
 /*===========================================================================*
  *                  Definition for internal operations                       *
@@ -66,6 +94,33 @@ struct _TreeMapData {
 #define likely(x)       __builtin_expect(!!(x), 1)
 #define unlikely(x)     __builtin_expect(!!(x), 0)
 
+/* The statistics counters are compiled out by default. They are updated with
+   relaxed atomics, so that the concurrent lookups of a map shared read-only by
+   several threads stay race free. */
+#ifdef CDS_ENABLE_STATS
+#define STATS_ADD(data, field, count) \
+    __atomic_fetch_add(&((data)->stats_.field), (count), __ATOMIC_RELAXED)
+#else
+#define STATS_ADD(data, field, count)
+#endif
+
+/**
+ * Allocate the tree node via the designated allocator.
+ */
+static inline TreeNode* NEW_NODE(TreeMapData* data)
+{
+    STATS_ADD(data, bytes_alloc, sizeof(TreeNode));
+    return (TreeNode*)data->alloc_.alloc(data->alloc_.ctx, sizeof(TreeNode));
+}
+
+/**
+ * Release the tree node via the designated allocator.
+ */
+static inline void DELETE_NODE(TreeMapData* data, TreeNode* node)
+{
+    data->alloc_.free(data->alloc_.ctx, node);
+}
+
 /**
  * @brief Traverse all the tree nodes and clean the allocated resource.
  *
@@ -115,6 +170,17 @@ TreeNode* _TreeMapSuccessor(TreeNode* null, TreeNode* curr);
  */
 TreeNode* _TreeMapPredecessor(TreeNode* null, TreeNode* curr);
 
+/**
+ * @brief Return the number of nodes on the longest path from the designated
+ * node to a leaf.
+ *
+ * @param null          The dummy node of the tree
+ * @param curr          The pointer to the designated node
+ *
+ * @retval height       The height of the subtree
+ */
+unsigned _TreeMapHeight(TreeNode* null, TreeNode* curr);
+
 /**
  * @brief Make right rotation for the subtree rooted by the designated node.
  *
@@ -165,6 +231,166 @@ void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr);
  */
 TreeNode* _TreeMapSearch(TreeMapData* data, void* key);
 
+/**
+ * @brief Get the node which stores the first key going after the designated
+ * one, or not going before it if the bound is not strict.
+ *
+ * @param data          The pointer to tree private data
+ * @param key           The designated key
+ * @param strict        Whether to skip the key equal to the designated one
+ *
+ * @retval node         The target node
+ * @retval null         All the keys go before the designated one
+ */
+TreeNode* _TreeMapBound(TreeMapData* data, void* key, bool strict);
+
+/**
+ * @brief Build the balanced subtree from the sorted pairs in top down manner.
+ *
+ * Each node is linked to its parent before its children are built, so the
+ * partially built tree is always well formed for cleanup.
+ *
+ * @param data          The pointer to tree private data
+ * @param pairs         The array of sorted key value pairs
+ * @param size          The number of pairs
+ * @param depth         The depth of the subtree root
+ * @param depth_red     The depth from which the nodes are colored red
+ * @param parent        The parent of the subtree root
+ * @param p_link        The pointer to the link which refers to the subtree root
+ *
+ * @retval true         The subtree is successfully built
+ * @retval false        Insufficient memory for the nodes
+ */
+bool _TreeMapBuild(TreeMapData* data, Pair* pairs, unsigned size,
+                   unsigned depth, unsigned depth_red, TreeNode* parent,
+                   TreeNode** p_link);
+
+/**
+ * @brief Return the number of black nodes on the path from the subtree root
+ * to the dummy node.
+ *
+ * @param null          The pointer to the dummy node
+ * @param curr          The pointer to the subtree root
+ *
+ * @retval height       The black height
+ */
+unsigned _TreeMapBlackHeight(TreeNode* null, TreeNode* curr);
+
+/**
+ * @brief Join two subtrees and the node with the key going between them into
+ * a single red black tree.
+ *
+ * The node is linked at the spine of the higher tree where the black heights
+ * match, and the insertion fixup restores the tree property.
+ *
+ * @param data          The private data whose root is used as the scratch of
+ *                      the insertion fixup
+ * @param left          The subtree root with the smaller keys
+ * @param mid           The node with the key going between two subtrees
+ * @param right         The subtree root with the greater keys
+ *
+ * @retval root         The root of the joined tree
+ */
+TreeNode* _TreeMapJoin(TreeMapData* data, TreeNode* left, TreeNode* mid,
+                       TreeNode* right);
+
+/**
+ * @brief Split the subtree into two subtrees with keys going before and after
+ * the designated key respectively.
+ *
+ * @param data          The private data whose root is used as the scratch of
+ *                      the insertion fixup
+ * @param root          The root of the to be split subtree
+ * @param key           The designated key
+ * @param p_left        The pointer to the returned subtree with smaller keys
+ * @param p_right       The pointer to the returned subtree with greater keys
+ *
+ * @retval node         The detached node storing the designated key
+ * @retval NULL         The key cannot be found
+ */
+TreeNode* _TreeMapSplit(TreeMapData* data, TreeNode* root, void* key,
+                        TreeNode** p_left, TreeNode** p_right);
+
+/**
+ * @brief Unite two subtrees into a single one.
+ *
+ * @param data          The private data whose root is used as the scratch of
+ *                      the insertion fixup
+ * @param lhs           The root of the designated subtree
+ * @param rhs           The root of the source subtree
+ * @param depth_fork    The number of recursion levels forked to threads
+ * @param p_dups        The pointer to the list of the replaced nodes chained
+ *                      through their left links
+ *
+ * @retval root         The root of the united tree
+ */
+TreeNode* _TreeMapUnion(TreeMapData* data, TreeNode* lhs, TreeNode* rhs,
+                        unsigned depth_fork, TreeNode** p_dups);
+
+/**
+ * @brief The thread entry which solves a forked union subproblem.
+ *
+ * @param arg           The pointer to the UnionTask structure
+ *
+ * @retval NULL         The thread finishes
+ */
+void* _TreeMapUnionTask(void* arg);
+
+/**
+ * @brief Visit or accumulate the pairs of the designated rank range.
+ *
+ * @param arg           The pointer to the traversal task
+ * @param chunk         The index of the rank range
+ * @param acc           The partial result or NULL for the visit
+ */
+void _TreeMapTraverseChunk(void* arg, unsigned chunk, void* acc);
+
+/**
+ * @brief Prepare the spare nodes in the target map if the tree nodes cannot be
+ * moved to it directly.
+ *
+ * @param src           The private data of the source map
+ * @param dst           The private data of the target map
+ * @param count         The number of to be moved nodes
+ * @param p_spare       The pointer to the returned list of spare nodes chained
+ *                      through their left links, or NULL if the nodes can be
+ *                      moved directly
+ *
+ * @retval true         The nodes are ready to be transferred
+ * @retval false        Insufficient memory for the spare nodes
+ */
+bool _TreeMapPrepareTransfer(TreeMapData* src, TreeMapData* dst,
+                             unsigned count, TreeNode** p_spare);
+
+/**
+ * @brief Transfer the subtree from the source map to the target map.
+ *
+ * The dummy links are redirected to the target map. If the spare nodes are
+ * given, the pairs are copied to them and the source nodes are released.
+ *
+ * @param src           The private data of the source map
+ * @param dst           The private data of the target map
+ * @param curr          The root of the to be transferred subtree
+ * @param parent        The parent of the subtree root in the target map
+ * @param p_spare       The pointer to the list of spare nodes or NULL
+ *
+ * @retval root         The root of the transferred subtree
+ */
+TreeNode* _TreeMapTransfer(TreeMapData* src, TreeMapData* dst, TreeNode* curr,
+                           TreeNode* parent, TreeNode** p_spare);
+
+/**
+ * @brief The shared implementation of the serial and the parallel unions.
+ *
+ * @param self          The pointer to the designated TreeMap structure
+ * @param other         The pointer to the source TreeMap structure
+ * @param depth_fork    The number of recursion levels forked to threads
+ *
+ * @retval true         The source pairs are successfully moved
+ * @retval false        Insufficient memory for the node reallocation
+ */
+bool _TreeMapUnite(TreeMap* self, TreeMap* other, unsigned depth_fork);
+
 /**
  * @brief The default hash key comparison function.
  *
@@ -202,6 +428,7 @@ TreeMap* TreeMapInit()
     }
 
     null->color_ = COLOR_BLACK;
+    null->size_ = 0;
     null->parent_ = NULL;
     null->parent_ = null;
     null->right_ = null;
@@ -213,6 +440,12 @@ TreeMap* TreeMapInit()
     data->func_cmp_ = _TreeMapCompare;
     data->func_clean_key_ = NULL;
     data->func_clean_val_ = NULL;
+    data->alloc_ = *CdsGetAllocator();
+    data->pool_ = NULL;
+#ifdef CDS_ENABLE_STATS
+    memset(&(data->stats_), 0, sizeof(TreeMapStats));
+    data->stats_.instrumented = true;
+#endif
 
     obj->data = data;
     obj->put = TreeMapPut;
@@ -227,9 +460,18 @@ TreeMap* TreeMapInit()
     obj->first = TreeMapFirst;
     obj->next = TreeMapNext;
     obj->reverse_next = TreeMapReverseNext;
+    obj->lower_bound = TreeMapLowerBound;
+    obj->upper_bound = TreeMapUpperBound;
+    obj->range = TreeMapRange;
+    obj->rank = TreeMapRank;
+    obj->select = TreeMapSelect;
+    obj->build_sorted = TreeMapBuildSorted;
     obj->set_compare = TreeMapSetCompare;
     obj->set_clean_key = TreeMapSetCleanKey;
     obj->set_clean_value = TreeMapSetCleanValue;
+    obj->set_allocator = TreeMapSetAllocator;
+    obj->use_pool = TreeMapUsePool;
+    obj->get_stats = TreeMapGetStats;
 
     return obj;
 }
@@ -240,7 +482,15 @@ void TreeMapDeinit(TreeMap* obj)
         return;
 
     TreeMapData* data = obj->data;
-    _TreeMapDeinit(data);
+
+    /* The pooled nodes are released at once, so the tree is traversed only for
+       the key value cleanup. */
+    Pool* pool = data->pool_;
+    if (!pool || data->func_clean_key_ || data->func_clean_val_)
+        _TreeMapDeinit(data);
+    if (pool)
+        PoolDeinit(pool);
+
     free(data->null_);
     free(data);
     free(obj);
@@ -249,15 +499,16 @@ void TreeMapDeinit(TreeMap* obj)
 
 bool TreeMapPut(TreeMap* self, void* key, void* value)
 {
-    TreeNode* node = (TreeNode*)malloc(sizeof(TreeNode));
+    TreeMapData* data = self->data;
+    TreeNode* node = NEW_NODE(data);
     if (unlikely(!node))
         return false;
 
-    TreeMapData* data = self->data;
     TreeNode* null = data->null_;
     node->pair_.key = key;
     node->pair_.value = value;
     node->color_ = COLOR_RED;
+    node->size_ = 1;
     node->parent_ = null;
     node->left_ = null;
     node->right_ = null;
@@ -266,7 +517,9 @@ bool TreeMapPut(TreeMap* self, void* key, void* value)
     TreeNode* parent = null;
     TreeNode* curr = data->root_;
     char direct;
+    STATS_ADD(data, num_lookup, 1);
     while (curr != null) {
+        STATS_ADD(data, num_probe, 1);
         parent = curr;
         int order = func_cmp(key, curr->pair_.key);
         if (order > 0) {
@@ -279,7 +532,7 @@ bool TreeMapPut(TreeMap* self, void* key, void* value)
         }
         else {
             /* Conflict with the already stored key value pair. */
-            free(node);
+            DELETE_NODE(data, node);
             if (data->func_clean_key_)
                 data->func_clean_key_(curr->pair_.key);
             if (data->func_clean_val_)
@@ -303,6 +556,10 @@ bool TreeMapPut(TreeMap* self, void* key, void* value)
 
     data->size_++;
 
+    /* Count the new node in the subtree sizes of all its ancestors. */
+    for (curr = parent ; curr != null ; curr = curr->parent_)
+        ++(curr->size_);
+
     /* Maintain the red black tree structure. */
     _TreeMapInsertFixup(data, node);
 
@@ -350,7 +607,7 @@ bool TreeMapRemove(TreeMap* self, void* key)
             data->func_clean_key_(curr->pair_.key);
         if (data->func_clean_val_)
             data->func_clean_val_(curr->pair_.value);
-        free(curr);
+        DELETE_NODE(data, curr);
     } else {
         /* The specified node has two children. */
         if ((curr->left_ != null) && (curr->right_ != null)) {
@@ -374,7 +631,7 @@ bool TreeMapRemove(TreeMap* self, void* key)
                 data->func_clean_val_(curr->pair_.value);
             curr->pair_.key = succ->pair_.key;
             curr->pair_.value = succ->pair_.value;
-            free(succ);
+            DELETE_NODE(data, succ);
         }
         /* The specified node has one child. */
         else {
@@ -397,12 +654,16 @@ bool TreeMapRemove(TreeMap* self, void* key)
                 data->func_clean_key_(curr->pair_.key);
             if (data->func_clean_val_)
                 data->func_clean_val_(curr->pair_.value);
-            free(curr);
+            DELETE_NODE(data, curr);
         }
     }
 
-    /* Decrease the size. */
+    /* Decrease the size. The parent of the spliced node is linked by the
+       child, so the subtree sizes are fixed from there up to the root. */
     data->size_--;
+    TreeNode* anc;
+    for (anc = child->parent_ ; anc != null ; anc = anc->parent_)
+        --(anc->size_);
 
     /* Maintain the balanced tree structure. */
     if (color == COLOR_BLACK)
@@ -598,6 +859,221 @@ Pair* TreeMapReverseNext(TreeMap* self)
     return NULL;
 }
 
+void TreeMapIterInit(TreeMap* self, TreeMapIter* iter, bool is_reverse)
+{
+    TreeMapData* data = self->data;
+    iter->data_ = data;
+    iter->is_reverse_ = is_reverse;
+    iter->node_ = (is_reverse == false)?
+                  _TreeMapMinimal(data->null_, data->root_) :
+                  _TreeMapMaximal(data->null_, data->root_);
+}
+
+Pair* TreeMapIterNext(TreeMapIter* iter)
+{
+    TreeNode* null = iter->data_->null_;
+    TreeNode* curr = (TreeNode*)iter->node_;
+    if (unlikely(curr == null))
+        return NULL;
+
+    iter->node_ = (iter->is_reverse_ == false)?
+                  _TreeMapSuccessor(null, curr) :
+                  _TreeMapPredecessor(null, curr);
+    return &(curr->pair_);
+}
+
+void TreeMapLowerBound(TreeMap* self, void* key, TreeMapIter* iter)
+{
+    TreeMapData* data = self->data;
+    iter->data_ = data;
+    iter->is_reverse_ = false;
+    iter->node_ = _TreeMapBound(data, key, false);
+}
+
+void TreeMapUpperBound(TreeMap* self, void* key, TreeMapIter* iter)
+{
+    TreeMapData* data = self->data;
+    iter->data_ = data;
+    iter->is_reverse_ = false;
+    iter->node_ = _TreeMapBound(data, key, true);
+}
+
+unsigned TreeMapRange(TreeMap* self, void* lo, void* hi, TreeMapVisit func,
+                      void* arg)
+{
+    TreeMapData* data = self->data;
+    TreeMapCompare func_cmp = data->func_cmp_;
+    TreeNode* null = data->null_;
+
+    /* Locate the lower bound once and then follow the successor path, which
+       visits each tree edge at most twice through the whole scan. */
+    unsigned count = 0;
+    TreeNode* curr = _TreeMapBound(data, lo, false);
+    while (curr != null && func_cmp(curr->pair_.key, hi) < 0) {
+        func(&(curr->pair_), arg);
+        ++count;
+        curr = _TreeMapSuccessor(null, curr);
+    }
+    return count;
+}
+
+unsigned TreeMapRank(TreeMap* self, void* key)
+{
+    TreeMapData* data = self->data;
+    TreeMapCompare func_cmp = data->func_cmp_;
+    TreeNode* null = data->null_;
+    TreeNode* curr = data->root_;
+
+    /* Accumulate the left subtree and the node itself whenever descending to
+       the right. */
+    unsigned rank = 0;
+    while (curr != null) {
+        int order = func_cmp(key, curr->pair_.key);
+        if (order > 0) {
+            rank += curr->left_->size_ + 1;
+            curr = curr->right_;
+        } else if (order < 0)
+            curr = curr->left_;
+        else
+            return rank + curr->left_->size_;
+    }
+    return rank;
+}
+
+Pair* TreeMapSelect(TreeMap* self, unsigned order)
+{
+    TreeMapData* data = self->data;
+    TreeNode* null = data->null_;
+    TreeNode* curr = data->root_;
+    while (curr != null) {
+        unsigned size_left = curr->left_->size_;
+        if (order < size_left)
+            curr = curr->left_;
+        else if (order > size_left) {
+            order -= size_left + 1;
+            curr = curr->right_;
+        } else
+            return &(curr->pair_);
+    }
+    return NULL;
+}
+
+void TreeMapForEachParallel(TreeMap* self, TreeMapVisit func, void* arg,
+                            unsigned num_thread)
+{
+    TreeMapData* data = self->data;
+    TraverseTask task;
+    task.data_ = data;
+    task.func_visit_ = func;
+    task.arg_ = arg;
+    task.reducer_ = NULL;
+    task.num_chunk_ = CdsParallelChunks(data->size_, num_thread);
+    CdsParallelRun(task.num_chunk_, num_thread, _TreeMapTraverseChunk, &task,
+                   NULL, NULL);
+}
+
+void TreeMapReduceParallel(TreeMap* self, const Reducer* reducer, void* acc,
+                           unsigned num_thread)
+{
+    TreeMapData* data = self->data;
+    TraverseTask task;
+    task.data_ = data;
+    task.func_visit_ = NULL;
+    task.arg_ = NULL;
+    task.reducer_ = reducer;
+    task.num_chunk_ = CdsParallelChunks(data->size_, num_thread);
+    CdsParallelRun(task.num_chunk_, num_thread, _TreeMapTraverseChunk, &task,
+                   reducer, acc);
+}
+
+bool TreeMapBuildSorted(TreeMap* self, Pair* pairs, unsigned size)
+{
+    TreeMapData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    TreeMapCompare func_cmp = data->func_cmp_;
+    unsigned i;
+    for (i = 1 ; i < size ; ++i) {
+        if (func_cmp(pairs[i - 1].key, pairs[i].key) >= 0)
+            return false;
+    }
+    if (size == 0)
+        return true;
+
+    if (data->pool_) {
+        if (unlikely(!PoolReserve(data->pool_, size)))
+            return false;
+    }
+
+    /* Splitting at the middle fills all the levels except the deepest one, so
+       coloring that level red keeps the black height of all paths equal. */
+    unsigned depth_red = 0;
+    unsigned long long span = (unsigned long long)size + 1;
+    while (span >>= 1)
+        ++depth_red;
+
+    if (unlikely(!_TreeMapBuild(data, pairs, size, 0, depth_red,
+                                data->null_, &(data->root_)))) {
+        /* Release the partially built tree without touching the pairs. */
+        TreeMapCleanKey func_clean_key = data->func_clean_key_;
+        TreeMapCleanValue func_clean_val = data->func_clean_val_;
+        data->func_clean_key_ = NULL;
+        data->func_clean_val_ = NULL;
+        _TreeMapDeinit(data);
+        data->func_clean_key_ = func_clean_key;
+        data->func_clean_val_ = func_clean_val;
+        data->root_ = data->null_;
+        return false;
+    }
+
+    data->size_ = size;
+    return true;
+}
+
+bool TreeMapUnion(TreeMap* self, TreeMap* other)
+{
+    return _TreeMapUnite(self, other, 0);
+}
+
+bool TreeMapUnionParallel(TreeMap* self, TreeMap* other, unsigned num_thread)
+{
+    /* Each forked level doubles the number of running threads. */
+    unsigned depth_fork = 0;
+    while (num_thread >>= 1)
+        ++depth_fork;
+    return _TreeMapUnite(self, other, depth_fork);
+}
+
+bool TreeMapSplit(TreeMap* self, void* key, TreeMap* other)
+{
+    TreeMapData* src = self->data;
+    TreeMapData* dst = other->data;
+    if (self == other || dst->size_ > 0)
+        return false;
+
+    /* Prepare the nodes for the pairs not going before the key in advance, so
+       the failure leaves both maps untouched. */
+    unsigned count = src->size_ - TreeMapRank(self, key);
+    TreeNode* spare;
+    if (unlikely(!_TreeMapPrepareTransfer(src, dst, count, &spare)))
+        return false;
+
+    TreeNode* null = src->null_;
+    TreeNode* left;
+    TreeNode* right;
+    TreeNode* match = _TreeMapSplit(src, src->root_, key, &left, &right);
+    if (match)
+        right = _TreeMapJoin(src, null, match, right);
+
+    src->root_ = left;
+    src->size_ = left->size_;
+    dst->root_ = _TreeMapTransfer(src, dst, right, dst->null_,
+                                  (spare)? &spare : NULL);
+    dst->size_ = count;
+    return true;
+}
+
 void TreeMapSetCompare(TreeMap* self, TreeMapCompare func)
 {
     self->data->func_cmp_ = func;
@@ -613,6 +1089,122 @@ void TreeMapSetCleanValue(TreeMap* self, TreeMapCleanValue func)
     self->data->func_clean_val_ = func;
 }
 
+bool TreeMapSetAllocator(TreeMap* self, const Allocator* alloc)
+{
+    TreeMapData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    if (data->pool_) {
+        PoolDeinit(data->pool_);
+        data->pool_ = NULL;
+    }
+    data->alloc_ = (alloc)? *alloc : *CdsGetAllocator();
+    return true;
+}
+
+bool TreeMapUsePool(TreeMap* self)
+{
+    TreeMapData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    Pool* pool = PoolInit(sizeof(TreeNode));
+    if (unlikely(!pool))
+        return false;
+
+    if (data->pool_)
+        PoolDeinit(data->pool_);
+    data->pool_ = pool;
+    PoolGetAllocator(pool, &(data->alloc_));
+    return true;
+}
+
+void TreeMapGetStats(TreeMap* self, TreeMapStats* p_stats)
+{
+    TreeMapData* data = self->data;
+#ifdef CDS_ENABLE_STATS
+    *p_stats = data->stats_;
+#else
+    memset(p_stats, 0, sizeof(TreeMapStats));
+#endif
+
+    p_stats->size = data->size_;
+    p_stats->height = _TreeMapHeight(data->null_, data->root_);
+    return;
+}
+
+bool TreeMapSnapshot(TreeMap* self, const SnapshotWriter* writer,
+                     const SnapshotCodec* codec_key,
+                     const SnapshotCodec* codec_value)
+{
+    SnapshotEncoder enc;
+    if (unlikely(!CdsSnapshotBegin(&enc, writer, CDS_SNAPSHOT_TREE_MAP,
+                                   self->data->size_)))
+        return false;
+
+    /* Write the pairs in the key order, so that the restore can build the
+       tree bottom up. */
+    TreeMapIter iter;
+    TreeMapIterInit(self, &iter, false);
+    Pair* pair;
+    while ((pair = TreeMapIterNext(&iter))) {
+        if (unlikely(!CdsSnapshotEncode(&enc, codec_key, pair->key) ||
+                     !CdsSnapshotEncode(&enc, codec_value, pair->value)))
+            return CdsSnapshotEnd(&enc, false);
+    }
+    return CdsSnapshotEnd(&enc, true);
+}
+
+bool TreeMapRestore(TreeMap* self, const SnapshotReader* reader,
+                    const SnapshotCodec* codec_key,
+                    const SnapshotCodec* codec_value)
+{
+    TreeMapData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    SnapshotDecoder dec;
+    unsigned count;
+    if (unlikely(!CdsRestoreBegin(&dec, reader, CDS_SNAPSHOT_TREE_MAP, &count)))
+        return CdsRestoreEnd(&dec, false);
+
+    Pair* pairs = NULL;
+    if (count > 0) {
+        pairs = (Pair*)malloc(sizeof(Pair) * count);
+        if (unlikely(!pairs))
+            return CdsRestoreEnd(&dec, false);
+    }
+
+    unsigned num = 0;
+    while (num < count) {
+        Pair* pair = pairs + num;
+        if (unlikely(!CdsRestoreDecode(&dec, codec_key, &(pair->key))))
+            break;
+        if (unlikely(!CdsRestoreDecode(&dec, codec_value, &(pair->value)))) {
+            if (data->func_clean_key_)
+                data->func_clean_key_(pair->key);
+            break;
+        }
+        ++num;
+    }
+
+    bool done = CdsRestoreEnd(&dec, num == count) &&
+                TreeMapBuildSorted(self, pairs, num);
+    if (!done) {
+        unsigned i;
+        for (i = 0 ; i < num ; ++i) {
+            if (data->func_clean_key_)
+                data->func_clean_key_(pairs[i].key);
+            if (data->func_clean_val_)
+                data->func_clean_val_(pairs[i].value);
+        }
+    }
+
+    free(pairs);
+    return done;
+}
+
 
 /*===========================================================================*
  *               Implementation for internal operations                      *
@@ -652,7 +1244,7 @@ void _TreeMapDeinit(TreeMapData* data)
                 func_clean_key(temp->pair_.key);
             if (func_clean_val)
                 func_clean_val(temp->pair_.value);
-            free(temp);
+            DELETE_NODE(data, temp);
             continue;
         }
 
@@ -674,7 +1266,7 @@ void _TreeMapDeinit(TreeMapData* data)
                 func_clean_key(temp->pair_.key);
             if (func_clean_val)
                 func_clean_val(temp->pair_.value);
-            free(temp);
+            DELETE_NODE(data, temp);
             continue;
         }
 
@@ -689,7 +1281,7 @@ void _TreeMapDeinit(TreeMapData* data)
             func_clean_key(temp->pair_.key);
         if (func_clean_val)
             func_clean_val(temp->pair_.value);
-        free(temp);
+        DELETE_NODE(data, temp);
     }
 
     return;
@@ -751,8 +1343,21 @@ TreeNode* _TreeMapPredecessor(TreeNode* null, TreeNode* curr)
     return curr;
 }
 
+unsigned _TreeMapHeight(TreeNode* null, TreeNode* curr)
+{
+    if (curr == null)
+        return 0;
+
+    /* The red black tree is balanced, so the recursion depth is bounded by
+       twice the logarithm of the size. */
+    unsigned left = _TreeMapHeight(null, curr->left_);
+    unsigned right = _TreeMapHeight(null, curr->right_);
+    return ((left > right)? left : right) + 1;
+}
+
 void _TreeMapRightRotate(TreeMapData* data, TreeNode* curr)
 {
+    STATS_ADD(data, num_rotate, 1);
     TreeNode* null = data->null_;
     TreeNode* child = curr->left_;
     /**
@@ -786,11 +1391,16 @@ void _TreeMapRightRotate(TreeMapData* data, TreeNode* curr)
     curr->parent_ = child;
     child->right_ = curr;
 
+    /* x takes over the whole subtree, and y keeps only b and c. */
+    child->size_ = curr->size_;
+    curr->size_ = curr->left_->size_ + curr->right_->size_ + 1;
+
     return;
 }
 
 void _TreeMapLeftRotate(TreeMapData* data, TreeNode* curr)
 {
+    STATS_ADD(data, num_rotate, 1);
     TreeNode* null = data->null_;
     TreeNode* child = curr->right_;
     /**
@@ -824,6 +1434,10 @@ void _TreeMapLeftRotate(TreeMapData* data, TreeNode* curr)
     curr->parent_ = child;
     child->left_ = curr;
 
+    /* y takes over the whole subtree, and x keeps only a and b. */
+    child->size_ = curr->size_;
+    curr->size_ = curr->left_->size_ + curr->right_->size_ + 1;
+
     return;
 }
 
@@ -1065,7 +1679,9 @@ TreeNode* _TreeMapSearch(TreeMapData* data, void* key)
     TreeMapCompare func_cmp = data->func_cmp_;
     TreeNode* null = data->null_;
     TreeNode* curr = data->root_;
+    STATS_ADD(data, num_lookup, 1);
     while(curr != null) {
+        STATS_ADD(data, num_probe, 1);
         int order = func_cmp(key, curr->pair_.key);
         if (order == 0)
             break;
@@ -1079,6 +1695,379 @@ TreeNode* _TreeMapSearch(TreeMapData* data, void* key)
     return curr;
 }
 
+TreeNode* _TreeMapBound(TreeMapData* data, void* key, bool strict)
+{
+    TreeMapCompare func_cmp = data->func_cmp_;
+    TreeNode* null = data->null_;
+    TreeNode* curr = data->root_;
+    TreeNode* bound = null;
+    STATS_ADD(data, num_lookup, 1);
+    while (curr != null) {
+        STATS_ADD(data, num_probe, 1);
+        int order = func_cmp(key, curr->pair_.key);
+        if (order < 0 || (order == 0 && !strict)) {
+            bound = curr;
+            curr = curr->left_;
+        } else
+            curr = curr->right_;
+    }
+    return bound;
+}
+
+bool _TreeMapBuild(TreeMapData* data, Pair* pairs, unsigned size,
+                   unsigned depth, unsigned depth_red, TreeNode* parent,
+                   TreeNode** p_link)
+{
+    if (size == 0)
+        return true;
+
+    TreeNode* node = NEW_NODE(data);
+    if (unlikely(!node))
+        return false;
+
+    TreeNode* null = data->null_;
+    unsigned mid = size >> 1;
+    node->pair_ = pairs[mid];
+    node->color_ = (depth >= depth_red)? COLOR_RED : COLOR_BLACK;
+    node->size_ = size;
+    node->parent_ = parent;
+    node->left_ = null;
+    node->right_ = null;
+    *p_link = node;
+
+    if (unlikely(!_TreeMapBuild(data, pairs, mid, depth + 1, depth_red,
+                                node, &(node->left_))))
+        return false;
+    return _TreeMapBuild(data, pairs + mid + 1, size - mid - 1, depth + 1,
+                         depth_red, node, &(node->right_));
+}
+
+unsigned _TreeMapBlackHeight(TreeNode* null, TreeNode* curr)
+{
+    unsigned height = 0;
+    while (curr != null) {
+        if (curr->color_ == COLOR_BLACK)
+            ++height;
+        curr = curr->left_;
+    }
+    return height;
+}
+
+TreeNode* _TreeMapJoin(TreeMapData* data, TreeNode* left, TreeNode* mid,
+                       TreeNode* right)
+{
+    TreeNode* null = data->null_;
+
+    /* Blacken the subtree roots which may be left red by the split. */
+    if (left != null) {
+        left->color_ = COLOR_BLACK;
+        left->parent_ = null;
+    }
+    if (right != null) {
+        right->color_ = COLOR_BLACK;
+        right->parent_ = null;
+    }
+
+    unsigned height_left = _TreeMapBlackHeight(null, left);
+    unsigned height_right = _TreeMapBlackHeight(null, right);
+
+    /* The subtrees with equal black heights are simply hung under the node. */
+    if (height_left == height_right) {
+        mid->color_ = COLOR_BLACK;
+        mid->parent_ = null;
+        mid->left_ = left;
+        mid->right_ = right;
+        if (left != null)
+            left->parent_ = mid;
+        if (right != null)
+            right->parent_ = mid;
+        mid->size_ = left->size_ + right->size_ + 1;
+        return mid;
+    }
+
+    /* Walk down the inner spine of the higher tree till reaching the black
+       node whose black height matches the lower tree. */
+    bool higher_left = height_left > height_right;
+    TreeNode* root = (higher_left)? left : right;
+    TreeNode* lower = (higher_left)? right : left;
+    unsigned height = (higher_left)? height_left : height_right;
+    unsigned height_lower = (higher_left)? height_right : height_left;
+
+    TreeNode* parent = null;
+    TreeNode* curr = root;
+    while (curr->color_ == COLOR_RED || height > height_lower) {
+        if (curr->color_ == COLOR_BLACK)
+            --height;
+        parent = curr;
+        curr = (higher_left)? curr->right_ : curr->left_;
+    }
+
+    /* Replace the matched subtree with the red node which hangs the matched
+       subtree and the lower tree. */
+    mid->color_ = COLOR_RED;
+    mid->parent_ = parent;
+    if (higher_left) {
+        mid->left_ = curr;
+        mid->right_ = lower;
+        parent->right_ = mid;
+    } else {
+        mid->left_ = lower;
+        mid->right_ = curr;
+        parent->left_ = mid;
+    }
+    if (curr != null)
+        curr->parent_ = mid;
+    if (lower != null)
+        lower->parent_ = mid;
+    mid->size_ = curr->size_ + lower->size_ + 1;
+
+    unsigned delta = lower->size_ + 1;
+    for ( ; parent != null ; parent = parent->parent_)
+        parent->size_ += delta;
+
+    /* Resolve the possible double red violation. */
+    data->root_ = root;
+    _TreeMapInsertFixup(data, mid);
+    return data->root_;
+}
+
+TreeNode* _TreeMapSplit(TreeMapData* data, TreeNode* root, void* key,
+                        TreeNode** p_left, TreeNode** p_right)
+{
+    TreeNode* null = data->null_;
+    if (root == null) {
+        *p_left = null;
+        *p_right = null;
+        return NULL;
+    }
+
+    TreeNode* left = root->left_;
+    TreeNode* right = root->right_;
+    if (left != null)
+        left->parent_ = null;
+    if (right != null)
+        right->parent_ = null;
+
+    int order = data->func_cmp_(key, root->pair_.key);
+    if (order == 0) {
+        *p_left = left;
+        *p_right = right;
+        return root;
+    }
+
+    /* Split the subtree on the key side and then join the other part back
+       with the root. */
+    TreeNode* match;
+    TreeNode* part;
+    if (order < 0) {
+        match = _TreeMapSplit(data, left, key, p_left, &part);
+        *p_right = _TreeMapJoin(data, part, root, right);
+    } else {
+        match = _TreeMapSplit(data, right, key, &part, p_right);
+        *p_left = _TreeMapJoin(data, left, root, part);
+    }
+    return match;
+}
+
+TreeNode* _TreeMapUnion(TreeMapData* data, TreeNode* lhs, TreeNode* rhs,
+                        unsigned depth_fork, TreeNode** p_dups)
+{
+    TreeNode* null = data->null_;
+    if (rhs == null)
+        return lhs;
+    if (lhs == null)
+        return rhs;
+
+    /* Split the designated tree with the source root, and the replaced node is
+       queued for the final cleanup. */
+    TreeNode* rhs_left = rhs->left_;
+    TreeNode* rhs_right = rhs->right_;
+    if (rhs_left != null)
+        rhs_left->parent_ = null;
+    if (rhs_right != null)
+        rhs_right->parent_ = null;
+
+    TreeNode* lhs_left;
+    TreeNode* lhs_right;
+    TreeNode* dup = _TreeMapSplit(data, lhs, rhs->pair_.key, &lhs_left, &lhs_right);
+    if (dup) {
+        dup->left_ = *p_dups;
+        *p_dups = dup;
+    }
+
+    /* Unite the two halves independently, and fork the left half if the
+       thread budget allows. */
+    TreeNode* left;
+    TreeNode* right;
+    pthread_t thread;
+    UnionTask task;
+    bool forked = false;
+    if (depth_fork > 0) {
+        task.data_ = *data;
+        task.lhs_ = lhs_left;
+        task.rhs_ = rhs_left;
+        task.dups_ = NULL;
+        task.depth_fork_ = depth_fork - 1;
+        forked = pthread_create(&thread, NULL, _TreeMapUnionTask, &task) == 0;
+        depth_fork = depth_fork - 1;
+    }
+
+    if (!forked)
+        left = _TreeMapUnion(data, lhs_left, rhs_left, depth_fork, p_dups);
+    right = _TreeMapUnion(data, lhs_right, rhs_right, depth_fork, p_dups);
+
+    if (forked) {
+        pthread_join(thread, NULL);
+        left = task.root_;
+        if (task.dups_) {
+            TreeNode* tail = task.dups_;
+            while (tail->left_)
+                tail = tail->left_;
+            tail->left_ = *p_dups;
+            *p_dups = task.dups_;
+        }
+    }
+
+    return _TreeMapJoin(data, left, rhs, right);
+}
+
+void* _TreeMapUnionTask(void* arg)
+{
+    UnionTask* task = (UnionTask*)arg;
+    task->root_ = _TreeMapUnion(&(task->data_), task->lhs_, task->rhs_,
+                                task->depth_fork_, &(task->dups_));
+    return NULL;
+}
+
+bool _TreeMapPrepareTransfer(TreeMapData* src, TreeMapData* dst,
+                             unsigned count, TreeNode** p_spare)
+{
+    *p_spare = NULL;
+
+    /* The nodes are movable if they are released by the same allocator. */
+    if (!src->pool_ && !dst->pool_ &&
+        src->alloc_.alloc == dst->alloc_.alloc &&
+        src->alloc_.free == dst->alloc_.free &&
+        src->alloc_.ctx == dst->alloc_.ctx)
+        return true;
+
+    if (dst->pool_) {
+        if (unlikely(!PoolReserve(dst->pool_, count)))
+            return false;
+    }
+
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        TreeNode* node = NEW_NODE(dst);
+        if (unlikely(!node)) {
+            while (*p_spare) {
+                node = *p_spare;
+                *p_spare = node->left_;
+                DELETE_NODE(dst, node);
+            }
+            return false;
+        }
+        node->left_ = *p_spare;
+        *p_spare = node;
+    }
+    return true;
+}
+
+TreeNode* _TreeMapTransfer(TreeMapData* src, TreeMapData* dst, TreeNode* curr,
+                           TreeNode* parent, TreeNode** p_spare)
+{
+    if (curr == src->null_)
+        return dst->null_;
+
+    TreeNode* node = curr;
+    if (p_spare) {
+        node = *p_spare;
+        *p_spare = node->left_;
+        node->color_ = curr->color_;
+        node->size_ = curr->size_;
+        node->pair_ = curr->pair_;
+    }
+
+    node->parent_ = parent;
+    node->left_ = _TreeMapTransfer(src, dst, curr->left_, node, p_spare);
+    node->right_ = _TreeMapTransfer(src, dst, curr->right_, node, p_spare);
+
+    if (p_spare)
+        DELETE_NODE(src, curr);
+    return node;
+}
+
+bool _TreeMapUnite(TreeMap* self, TreeMap* other, unsigned depth_fork)
+{
+    TreeMapData* dst = self->data;
+    TreeMapData* src = other->data;
+    if (self == other || src->size_ == 0)
+        return true;
+
+    TreeNode* spare;
+    if (unlikely(!_TreeMapPrepareTransfer(src, dst, src->size_, &spare)))
+        return false;
+
+    /* The source map is not empty, so an empty spare list means moving. */
+    TreeNode* rhs = _TreeMapTransfer(src, dst, src->root_, dst->null_,
+                                     (spare)? &spare : NULL);
+    src->root_ = src->null_;
+    src->size_ = 0;
+
+    TreeNode* dups = NULL;
+    TreeNode* root = _TreeMapUnion(dst, dst->root_, rhs, depth_fork, &dups);
+    dst->root_ = root;
+    dst->size_ = root->size_;
+
+    /* Release the replaced pairs like the conflict handling of TreeMapPut. */
+    while (dups) {
+        TreeNode* node = dups;
+        dups = node->left_;
+        if (dst->func_clean_key_)
+            dst->func_clean_key_(node->pair_.key);
+        if (dst->func_clean_val_)
+            dst->func_clean_val_(node->pair_.value);
+        DELETE_NODE(dst, node);
+    }
+    return true;
+}
+
+void _TreeMapTraverseChunk(void* arg, unsigned chunk, void* acc)
+{
+    TraverseTask* task = (TraverseTask*)arg;
+    TreeMapData* data = task->data_;
+    TreeNode* null = data->null_;
+    uint64_t size = data->size_;
+    unsigned begin = (unsigned)(size * chunk / task->num_chunk_);
+    unsigned count = (unsigned)(size * (chunk + 1) / task->num_chunk_) - begin;
+    if (count == 0)
+        return;
+
+    /* Select the first node of the range via the subtree sizes. */
+    TreeNode* curr = data->root_;
+    unsigned order = begin;
+    while (true) {
+        unsigned size_left = curr->left_->size_;
+        if (order < size_left)
+            curr = curr->left_;
+        else if (order > size_left) {
+            order -= size_left + 1;
+            curr = curr->right_;
+        } else
+            break;
+    }
+
+    const Reducer* reducer = task->reducer_;
+    while (count-- > 0) {
+        if (reducer)
+            reducer->accumulate(acc, &(curr->pair_), reducer->ctx);
+        else
+            task->func_visit_(&(curr->pair_), task->arg_);
+        curr = _TreeMapSuccessor(null, curr);
+    }
+    return;
+}
+
 int _TreeMapCompare(void* lhs, void* rhs)
 {
     if ((intptr_t)lhs == (intptr_t)rhs)
@@ -22,6 +22,11 @@
  */
 
 #include "container/trie.h"
+#include "memory/pool.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 /*===========================================================================*
@@ -39,6 +44,13 @@ static const char UP_LEFT = 4;
 static const char UP_RIGHT = 5;
 static const char UP_MIDDLE = 6;
 
+/* The string spelled during prefix visit stays on the stack within this size. */
+#define SIZE_LOCAL_RECORD   (256)
+
+/* The frozen image signature and the alignment of the frozen nodes. */
+static const char frozen_magic[8] = {'C', 'D', 'S', 'T', 'R', 'I', 'E', '1'};
+static const uint32_t frozen_align = 4;
+
 
 typedef struct TrieNode_ {
     bool endstr_;
@@ -49,13 +61,70 @@ typedef struct TrieNode_ {
     struct TrieNode_* parent_;
 } TrieNode;
 
+/* The compressed node whose incoming edge is labeled by a byte span. The child
+   array is followed by the first label bytes of the children for scanning. */
+typedef struct RadixNode_ {
+    bool endstr_;
+    unsigned short count_;
+    unsigned short capacity_;
+    unsigned length_;
+    struct RadixNode_* parent_;
+    struct RadixNode_** children_;
+    char label_[];
+} RadixNode;
+
+/* The frozen image starts with this header, which is followed by the frozen
+   nodes. All the links are byte offsets from the image start. */
+typedef struct FrozenHeader_ {
+    char magic_[8];
+    uint32_t size_;
+    uint32_t depth_;
+    uint32_t length_;
+    uint32_t root_;
+} FrozenHeader;
+
+/* The frozen radix node. The child offsets are followed by the first label
+   bytes of the children and then the label of the node itself. */
+typedef struct FrozenNode_ {
+    uint8_t endstr_;
+    uint8_t padding_;
+    uint16_t count_;
+    uint32_t length_;
+    uint32_t children_[];
+} FrozenNode;
+
 struct TrieData_ {
+    bool radix_;
     unsigned size_;
     unsigned count_node_;
     unsigned depth_;
     TrieNode* root_;
+    RadixNode* radix_root_;
+    Allocator alloc_;
+    Pool* pool_;
+    const char* image_;
+    size_t length_image_;
 };
 
+/* The strings gathered in lexicographic order and the image being frozen. */
+typedef struct FreezeContext_ {
+    char* chars_;
+    size_t* offsets_;
+    size_t length_chars_;
+    size_t capacity_chars_;
+    unsigned count_;
+    char* image_;
+    size_t length_image_;
+    size_t capacity_image_;
+} FreezeContext;
+
+/* The strings collected from a frozen image. */
+typedef struct StringArray_ {
+    const char** strs_;
+    unsigned size_;
+    unsigned capacity_;
+} StringArray;
+
 
 /*===========================================================================*
  *                  Definition for internal operations                       *
@@ -70,6 +139,174 @@ struct TrieData_ {
  */
 void _TrieDeinit(TrieData* data);
 
+/**
+ * @brief Visit the strings matching the specified prefix in ternary mode.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The designated non-empty prefix
+ * @param record        The buffer to spell the visited strings
+ * @param limit         The maximum number of visited strings or 0 for no limit
+ * @param func          The function to visit each matched string
+ * @param arg           The custom argument passed to the visit function
+ *
+ * @retval count        The number of visited strings
+ */
+unsigned _TrieVisitPrefix(TrieData* data, const char* prefix, char* record,
+                          unsigned limit, TrieVisit func, void* arg);
+
+/**
+ * @brief Visit the strings stored in the middle subtree of the given node in
+ * ternary mode.
+ *
+ * @param curr          The root of the middle subtree
+ * @param pred          The parent node of the subtree or NULL for the whole trie
+ * @param record        The buffer holding the string spelled by the path
+ * @param length        The length of the spelled string
+ * @param limit         The maximum number of visited strings or 0 for no limit
+ * @param func          The function to visit each matched string
+ * @param arg           The custom argument passed to the visit function
+ *
+ * @retval count        The number of visited strings
+ */
+unsigned _TrieVisitSubtree(TrieNode* curr, TrieNode* pred, char* record,
+                           unsigned length, unsigned limit, TrieVisit func,
+                           void* arg);
+
+/**
+ * Allocate the trie node via the designated allocator.
+ */
+static inline TrieNode* NEW_NODE(TrieData* data)
+{
+    return (TrieNode*)data->alloc_.alloc(data->alloc_.ctx, sizeof(TrieNode));
+}
+
+/**
+ * Release the trie node via the designated allocator.
+ */
+static inline void DELETE_NODE(TrieData* data, TrieNode* node)
+{
+    data->alloc_.free(data->alloc_.ctx, node);
+}
+
+/**
+ * Allocate the radix node labeled by the designated byte span. The label is
+ * left for the caller to fill if the span is not given.
+ */
+static inline RadixNode* NEW_RADIX(TrieData* data, const char* label,
+                                   unsigned length)
+{
+    RadixNode* node = (RadixNode*)data->alloc_.alloc(data->alloc_.ctx,
+                                    sizeof(RadixNode) + sizeof(char) * length);
+    if (unlikely(!node))
+        return NULL;
+
+    node->endstr_ = false;
+    node->count_ = 0;
+    node->capacity_ = 0;
+    node->length_ = length;
+    node->parent_ = NULL;
+    node->children_ = NULL;
+    if (label)
+        memcpy(node->label_, label, sizeof(char) * length);
+    data->count_node_++;
+    return node;
+}
+
+/**
+ * Release the radix node and its child array.
+ */
+static inline void DELETE_RADIX(TrieData* data, RadixNode* node)
+{
+    if (node->children_)
+        data->alloc_.free(data->alloc_.ctx, node->children_);
+    data->alloc_.free(data->alloc_.ctx, node);
+    data->count_node_--;
+}
+
+/**
+ * Return the first label bytes of the children of the radix node.
+ */
+static inline char* TOKENS(RadixNode* node)
+{
+    return (char*)(node->children_ + node->capacity_);
+}
+
+/**
+ * Check if the label byte goes before the other one. The bytes are compared as
+ * unsigned char like strcmp, so the UTF-8 strings keep their code point order.
+ */
+static inline bool BEFORE(char lhs, char rhs)
+{
+    return (unsigned char)lhs < (unsigned char)rhs;
+}
+
+/**
+ * Return the slot of the child whose label starts with the designated byte.
+ */
+static inline RadixNode** FIND_CHILD(RadixNode* node, char ch)
+{
+    if (node->count_ == 0)
+        return NULL;
+    int idx = CdsFindByte(TOKENS(node), node->count_, ch);
+    return (idx >= 0)? node->children_ + idx : NULL;
+}
+
+/**
+ * Return the size of the child array whose byte tokens are padded for the
+ * block search.
+ */
+static inline size_t SIZE_CHILDREN(unsigned capacity)
+{
+    unsigned span = (capacity + CDS_BYTE_BLOCK - 1) & ~(CDS_BYTE_BLOCK - 1);
+    return sizeof(RadixNode*) * capacity + sizeof(char) * span;
+}
+
+/**
+ * Return the frozen node at the designated image offset.
+ */
+static inline const FrozenNode* FROZEN_NODE(const char* image, uint32_t offset)
+{
+    return (const FrozenNode*)(image + offset);
+}
+
+/**
+ * Return the first label bytes of the children of the frozen node.
+ */
+static inline char* FROZEN_TOKENS(const FrozenNode* node)
+{
+    return (char*)(node->children_ + node->count_);
+}
+
+/**
+ * Return the label of the frozen node.
+ */
+static inline char* FROZEN_LABEL(const FrozenNode* node)
+{
+    return FROZEN_TOKENS(node) + node->count_;
+}
+
+/**
+ * Return the child of the frozen node whose label starts with the designated
+ * byte.
+ */
+static inline const FrozenNode* FROZEN_FIND_CHILD(const char* image,
+                                                  const FrozenNode* node,
+                                                  char ch)
+{
+    if (node->count_ == 0)
+        return NULL;
+    int idx = CdsFindByte(FROZEN_TOKENS(node), node->count_, ch);
+    return (idx >= 0)? FROZEN_NODE(image, node->children_[idx]) : NULL;
+}
+
+/**
+ * Return the gathered string of the designated order.
+ */
+static inline const char* GATHERED(FreezeContext* ctx, unsigned order)
+{
+    return ctx->chars_ + ctx->offsets_[order];
+}
+
 static inline
 char DECIDE_BACKWARD_DIRECTION(TrieNode** p_curr)
 {
@@ -93,6 +330,311 @@ void FREE_LOCAL_RESOURCE(const char** strs, unsigned size, char* record)
     free(record);
 }
 
+/**
+ * @brief Link the child to the radix node in ascending order of the first
+ * label bytes, and extend the child array if necessary.
+ *
+ * @param data          The pointer to the trie private data
+ * @param node          The pointer to the parent node
+ * @param child         The pointer to the child node
+ * @param token         The first label byte of the child
+ *
+ * @retval true         The child is successfully linked
+ * @retval false        Insufficient memory to extend the child array
+ */
+bool _TrieRadixLink(TrieData* data, RadixNode* node, RadixNode* child,
+                    char token);
+
+/**
+ * @brief Unlink the child whose label starts with the designated byte.
+ *
+ * @param node          The pointer to the parent node
+ * @param token         The first label byte of the child
+ */
+void _TrieRadixUnlink(RadixNode* node, char token);
+
+/**
+ * @brief Locate the radix node whose path spells exactly the designated
+ * string.
+ *
+ * @param data          The pointer to the trie private data
+ * @param str           The designated string
+ *
+ * @retval node         The target node
+ * @retval NULL         No such path
+ */
+RadixNode* _TrieRadixSearch(TrieData* data, const char* str);
+
+/**
+ * @brief Insert a string into the trie in radix mode.
+ *
+ * @param data          The pointer to the trie private data
+ * @param str           The designated non-empty string
+ *
+ * @retval true         The string is successfully inserted
+ * @retval false        Insufficient memory for the new nodes
+ */
+bool _TrieRadixInsert(TrieData* data, const char* str);
+
+/**
+ * @brief Check if the trie contains the strings matching the specified prefix
+ * in radix mode.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The designated non-empty prefix
+ *
+ * @retval true         The trie contains the given prefix
+ * @retval false        No such prefix
+ */
+bool _TrieRadixHasPrefixAs(TrieData* data, const char* prefix);
+
+/**
+ * @brief Retrieve the strings from the trie matching the specified prefix in
+ * radix mode.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The designated non-empty prefix
+ * @param p_strs        The pointer to the returned array of strings
+ * @param p_size        The pointer to the returned array size
+ *
+ * @retval true         The strings matching the given prefix are returned
+ * @retval false        No string matching the given prefix or insufficient
+ *                      memory to store the matched strings
+ */
+bool _TrieRadixGetPrefixAs(TrieData* data, const char* prefix,
+                           const char*** p_strs, unsigned* p_size);
+
+/**
+ * @brief Locate the highest radix node whose path covers the specified prefix.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The designated non-empty prefix
+ * @param p_length      The pointer to the returned length of the prefix part
+ *                      going before the label of the located node
+ *
+ * @retval node         The located node
+ * @retval NULL         No string matching the given prefix
+ */
+RadixNode* _TrieRadixLocate(TrieData* data, const char* prefix,
+                            unsigned* p_length);
+
+/**
+ * @brief Visit the strings matching the specified prefix in radix mode.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The designated non-empty prefix
+ * @param record        The buffer to spell the visited strings
+ * @param limit         The maximum number of visited strings or 0 for no limit
+ * @param func          The function to visit each matched string
+ * @param arg           The custom argument passed to the visit function
+ *
+ * @retval count        The number of visited strings
+ */
+unsigned _TrieRadixVisitPrefix(TrieData* data, const char* prefix,
+                               char* record, unsigned limit, TrieVisit func,
+                               void* arg);
+
+/**
+ * @brief Visit the strings stored in the radix subtree.
+ *
+ * @param top           The pointer to the subtree root
+ * @param record        The buffer holding the string spelled by the path
+ * @param length        The length of the spelled string
+ * @param limit         The maximum number of visited strings or 0 for no limit
+ * @param func          The function to visit each matched string
+ * @param arg           The custom argument passed to the visit function
+ *
+ * @retval count        The number of visited strings
+ */
+unsigned _TrieRadixVisitSubtree(RadixNode* top, char* record, unsigned length,
+                                unsigned limit, TrieVisit func, void* arg);
+
+/**
+ * @brief Collect the strings stored in the subtree in lexicographic order.
+ *
+ * @param node          The pointer to the subtree root
+ * @param record        The buffer holding the string spelled by the path
+ * @param length        The length of the spelled string
+ * @param p_strs        The pointer to the array of collected strings
+ * @param p_size        The pointer to the number of collected strings
+ * @param p_capacity    The pointer to the array capacity
+ *
+ * @retval true         The strings are successfully collected
+ * @retval false        Insufficient memory to store the strings
+ */
+bool _TrieRadixCollect(RadixNode* node, char* record, unsigned length,
+                       const char*** p_strs, unsigned* p_size,
+                       unsigned* p_capacity);
+
+/**
+ * @brief Remove the nodes which no longer lead to any string, and merge the
+ * node having a single child to keep the edges compressed.
+ *
+ * @param data          The pointer to the trie private data
+ * @param node          The node whose string end mark is just cleared
+ */
+void _TrieRadixPrune(TrieData* data, RadixNode* node);
+
+/**
+ * @brief Release all the radix nodes in the subtree.
+ *
+ * @param data          The pointer to the trie private data
+ * @param node          The pointer to the subtree root
+ */
+void _TrieRadixDeinit(TrieData* data, RadixNode* node);
+
+/**
+ * @brief Locate the frozen node whose path spells exactly the designated
+ * string.
+ *
+ * @param data          The pointer to the trie private data
+ * @param str           The designated non-empty string
+ *
+ * @retval node         The target node
+ * @retval NULL         No such path
+ */
+const FrozenNode* _TrieFrozenSearch(TrieData* data, const char* str);
+
+/**
+ * @brief Locate the highest frozen node whose path covers the specified prefix.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The designated non-empty prefix
+ * @param p_length      The pointer to the returned length of the prefix part
+ *                      going before the label of the located node
+ *
+ * @retval node         The located node
+ * @retval NULL         No string matching the given prefix
+ */
+const FrozenNode* _TrieFrozenLocate(TrieData* data, const char* prefix,
+                                    unsigned* p_length);
+
+/**
+ * @brief Visit the strings matching the specified prefix in a frozen image.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The designated non-empty prefix
+ * @param record        The buffer to spell the visited strings
+ * @param limit         The maximum number of visited strings or 0 for no limit
+ * @param func          The function to visit each matched string
+ * @param arg           The custom argument passed to the visit function
+ *
+ * @retval count        The number of visited strings
+ */
+unsigned _TrieFrozenVisitPrefix(TrieData* data, const char* prefix,
+                                char* record, unsigned limit, TrieVisit func,
+                                void* arg);
+
+/**
+ * @brief Visit the strings stored in the frozen subtree in lexicographic order.
+ *
+ * @param image         The frozen image
+ * @param node          The pointer to the subtree root
+ * @param record        The buffer holding the string spelled by the path
+ * @param length        The length of the spelled string
+ * @param limit         The maximum number of visited strings or 0 for no limit
+ * @param func          The function to visit each matched string
+ * @param arg           The custom argument passed to the visit function
+ * @param p_count       The pointer to the number of visited strings
+ *
+ * @retval true         The visit should go on
+ * @retval false        The visit is stopped
+ */
+bool _TrieFrozenVisitSubtree(const char* image, const FrozenNode* node,
+                             char* record, unsigned length, unsigned limit,
+                             TrieVisit func, void* arg, unsigned* p_count);
+
+/**
+ * @brief Retrieve the strings from a frozen image matching the specified
+ * prefix.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The designated non-empty prefix
+ * @param p_strs        The pointer to the returned array of strings
+ * @param p_size        The pointer to the returned array size
+ *
+ * @retval true         The strings matching the given prefix are returned
+ * @retval false        No string matching the given prefix or insufficient
+ *                      memory to store the matched strings
+ */
+bool _TrieFrozenGetPrefixAs(TrieData* data, const char* prefix,
+                            const char*** p_strs, unsigned* p_size);
+
+/**
+ * @brief Append the duplicate of the visited string to the string array.
+ *
+ * @param str           The visited string
+ * @param arg           The pointer to the string array
+ *
+ * @retval true         The string is appended
+ * @retval false        Insufficient memory to store the string
+ */
+bool _TrieCollectString(const char* str, void* arg);
+
+/**
+ * @brief Append the visited string to the freezing context.
+ *
+ * @param str           The visited string
+ * @param arg           The pointer to the freezing context
+ *
+ * @retval true         The string is appended
+ * @retval false        Insufficient memory to store the string
+ */
+bool _TrieGatherString(const char* str, void* arg);
+
+/**
+ * @brief Gather all the stored strings in lexicographic order.
+ *
+ * @param data          The pointer to the trie private data
+ * @param ctx           The pointer to the freezing context
+ *
+ * @retval true         The strings are gathered
+ * @retval false        Insufficient memory to store the strings
+ */
+bool _TrieFreezeGather(TrieData* data, FreezeContext* ctx);
+
+/**
+ * @brief Reserve the zero filled and aligned space at the image tail.
+ *
+ * @param ctx           The pointer to the freezing context
+ * @param size          The requested size
+ * @param p_offset      The pointer to the returned offset of the space
+ *
+ * @retval true         The space is reserved
+ * @retval false        Insufficient memory or the image exceeds the offset range
+ */
+bool _TrieFreezeReserve(FreezeContext* ctx, size_t size, uint32_t* p_offset);
+
+/**
+ * @brief Freeze the radix node spanning the designated range of the gathered
+ * strings, and then its children recursively.
+ *
+ * @param ctx           The pointer to the freezing context
+ * @param lo            The inclusive lower bound of the string range
+ * @param hi            The exclusive upper bound of the string range
+ * @param begin         The position where the node label begins
+ * @param end           The position where the node label ends, which is the
+ *                      length of the path shared by the string range
+ * @param p_offset      The pointer to the returned node offset
+ *
+ * @retval true         The subtree is frozen
+ * @retval false        Insufficient memory or the image exceeds the offset range
+ */
+bool _TrieFreezeNode(FreezeContext* ctx, unsigned lo, unsigned hi,
+                     unsigned begin, unsigned end, uint32_t* p_offset);
+
+/**
+ * @brief Write the image to the designated file.
+ *
+ * @param path          The file path
+ * @param image         The image
+ * @param length        The image length
+ *
+ * @retval true         The image is written
+ * @retval false        The file cannot be written
+ */
+bool _TrieFreezeWrite(const char* path, const char* image, size_t length);
+
 
 /*===========================================================================*
  *               Implementation for the exported operations                  *
@@ -109,10 +651,16 @@ Trie* TrieInit()
         return NULL;
     }
 
+    data->radix_ = false;
     data->size_ = 0;
     data->count_node_ = 0;
     data->depth_ = 0;
     data->root_ = NULL;
+    data->radix_root_ = NULL;
+    data->alloc_ = *CdsGetAllocator();
+    data->pool_ = NULL;
+    data->image_ = NULL;
+    data->length_image_ = 0;
 
     obj->data = data;
     obj->insert = TrieInsert;
@@ -120,8 +668,13 @@ Trie* TrieInit()
     obj->has_exact = TrieHasExact;
     obj->has_prefix_as = TrieHasPrefixAs;
     obj->get_prefix_as = TrieGetPrefixAs;
+    obj->visit_prefix = TrieVisitPrefix;
     obj->remove = TrieRemove;
     obj->size = TrieSize;
+    obj->set_allocator = TrieSetAllocator;
+    obj->use_pool = TrieUsePool;
+    obj->use_radix = TrieUseRadix;
+    obj->freeze = TrieFreeze;
     return obj;
 }
 
@@ -131,13 +684,66 @@ void TrieDeinit(Trie* obj)
         return;
 
     TrieData* data = obj->data;
-    _TrieDeinit(data);
+
+    /* The pooled nodes are released at once without traversal. */
+    if (data->image_)
+        munmap((void*)data->image_, data->length_image_);
+    else if (data->pool_)
+        PoolDeinit(data->pool_);
+    else if (data->radix_) {
+        if (data->radix_root_)
+            _TrieRadixDeinit(data, data->radix_root_);
+    } else
+        _TrieDeinit(data);
 
     free(data);
     free(obj);
     return;
 }
 
+Trie* TrieLoad(const char* path)
+{
+    if (unlikely(!path))
+        return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(FrozenHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size_t length = info.st_size;
+    void* image = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED)
+        return NULL;
+
+    /* Only the header is verified, so the loading cost does not grow with the
+       image size. */
+    const FrozenHeader* header = (const FrozenHeader*)image;
+    if (memcmp(header->magic_, frozen_magic, sizeof(frozen_magic)) != 0 ||
+        header->length_ != length || header->root_ < sizeof(FrozenHeader) ||
+        header->root_ + sizeof(FrozenNode) > length) {
+        munmap(image, length);
+        return NULL;
+    }
+
+    Trie* obj = TrieInit();
+    if (unlikely(!obj)) {
+        munmap(image, length);
+        return NULL;
+    }
+
+    TrieData* data = obj->data;
+    data->image_ = (const char*)image;
+    data->length_image_ = length;
+    data->size_ = header->size_;
+    data->depth_ = header->depth_;
+    return obj;
+}
+
 bool TrieInsert(Trie* self, const char* str)
 {
     if (unlikely(!str))
@@ -146,6 +752,11 @@ bool TrieInsert(Trie* self, const char* str)
         return true;
 
     TrieData* data = self->data;
+    if (unlikely(data->image_))
+        return false;
+    if (data->radix_)
+        return _TrieRadixInsert(data, str);
+
     TrieNode* curr = data->root_;
     TrieNode* pred = NULL;
     unsigned depth = 0;
@@ -161,7 +772,7 @@ bool TrieInsert(Trie* self, const char* str)
             ++str;
             ++depth;
         } else {
-            if (ch < token) {
+            if (BEFORE(ch, token)) {
                 curr = curr->left_;
                 direct = DIRECT_LEFT;
             } else {
@@ -173,7 +784,7 @@ bool TrieInsert(Trie* self, const char* str)
 
     /* Cascade the trie node for the remaining suffix. */
     while ((ch = *str) != 0) {
-        TrieNode* new_node = (TrieNode*)malloc(sizeof(TrieNode));
+        TrieNode* new_node = NEW_NODE(data);
         if (unlikely(!new_node))
             return false;
         new_node->middle_ = new_node->left_ = new_node->right_ = NULL;
@@ -214,6 +825,16 @@ bool TrieInsert(Trie* self, const char* str)
 bool TrieBulkInsert(Trie* self, const char** strs, unsigned size)
 {
     TrieData* data = self->data;
+    if (unlikely(data->image_))
+        return false;
+    if (data->radix_) {
+        unsigned i;
+        for (i = 0 ; i < size ; ++i) {
+            if (!TrieInsert(self, strs[i]))
+                return false;
+        }
+        return true;
+    }
 
     unsigned i;
     for (i = 0 ; i < size ; ++i) {
@@ -238,7 +859,7 @@ bool TrieBulkInsert(Trie* self, const char** strs, unsigned size)
                 ++str;
                 ++depth;
             } else {
-                if (ch < token) {
+                if (BEFORE(ch, token)) {
                     curr = curr->left_;
                     direct = DIRECT_LEFT;
                 } else {
@@ -250,7 +871,7 @@ bool TrieBulkInsert(Trie* self, const char** strs, unsigned size)
 
         /* Cascade the trie node for the remaining suffix. */
         while ((ch = *str) != 0) {
-            TrieNode* new_node = (TrieNode*)malloc(sizeof(TrieNode));
+            TrieNode* new_node = NEW_NODE(data);
             if (unlikely(!new_node))
                 return false;
             new_node->middle_ = new_node->left_ = new_node->right_ = NULL;
@@ -297,6 +918,15 @@ bool TrieHasExact(Trie* self, const char* str)
         return false;
 
     TrieData* data = self->data;
+    if (data->image_) {
+        const FrozenNode* node = _TrieFrozenSearch(data, str);
+        return (node && node->endstr_)? true : false;
+    }
+    if (data->radix_) {
+        RadixNode* node = _TrieRadixSearch(data, str);
+        return (node && node->endstr_)? true : false;
+    }
+
     TrieNode* curr = data->root_;
     TrieNode* pred = NULL;
 
@@ -309,7 +939,7 @@ bool TrieHasExact(Trie* self, const char* str)
             curr = curr->middle_;
             ++str;
         } else {
-            if (ch < token)
+            if (BEFORE(ch, token))
                 curr = curr->left_;
             else
                 curr = curr->right_;
@@ -328,6 +958,13 @@ bool TrieHasPrefixAs(Trie* self, const char* prefix)
         return false;
 
     TrieData* data = self->data;
+    if (data->image_) {
+        unsigned length;
+        return (_TrieFrozenLocate(data, prefix, &length))? true : false;
+    }
+    if (data->radix_)
+        return _TrieRadixHasPrefixAs(data, prefix);
+
     TrieNode* curr = data->root_;
     TrieNode* pred = NULL;
 
@@ -340,7 +977,7 @@ bool TrieHasPrefixAs(Trie* self, const char* prefix)
             curr = curr->middle_;
             ++prefix;
         } else {
-            if (ch < token)
+            if (BEFORE(ch, token))
                 curr = curr->left_;
             else
                 curr = curr->right_;
@@ -357,9 +994,10 @@ bool TrieHasPrefixAs(Trie* self, const char* prefix)
     if (curr && pred && pred->endstr_)
         return true;
 
-    /* The slow trie traversal to find any node marked as string end. */
+    /* The slow trie traversal to find any node marked as string end, which is
+       bounded by the middle subtree of the last matched node. */
     char direct = DOWN_LEFT;
-    while (direct != STOP) {
+    while (curr != pred) {
         if (direct == DOWN_LEFT || direct == DOWN_MIDDLE || direct == DOWN_RIGHT) {
             if (curr->endstr_)
                 return true;
@@ -428,6 +1066,11 @@ bool TrieGetPrefixAs(Trie* self, const char* prefix, const char*** p_strs, unsig
         return false;
 
     TrieData* data = self->data;
+    if (data->image_)
+        return _TrieFrozenGetPrefixAs(data, prefix, p_strs, p_size);
+    if (data->radix_)
+        return _TrieRadixGetPrefixAs(data, prefix, p_strs, p_size);
+
     TrieNode* curr = data->root_;
     TrieNode* pred = NULL;
 
@@ -441,7 +1084,7 @@ bool TrieGetPrefixAs(Trie* self, const char* prefix, const char*** p_strs, unsig
             curr = curr->middle_;
             ++dup;
         } else {
-            if (ch < token)
+            if (BEFORE(ch, token))
                 curr = curr->left_;
             else
                 curr = curr->right_;
@@ -597,6 +1240,38 @@ bool TrieGetPrefixAs(Trie* self, const char* prefix, const char*** p_strs, unsig
     return ever_found;
 }
 
+unsigned TrieVisitPrefix(Trie* self, const char* prefix, unsigned limit,
+                         TrieVisit func, void* arg)
+{
+    if (unlikely(!prefix))
+        return 0;
+    if (unlikely(*prefix == 0))
+        return 0;
+
+    /* The strings are spelled on the stack unless the longest one ever stored
+       exceeds the local buffer. */
+    TrieData* data = self->data;
+    char local[SIZE_LOCAL_RECORD];
+    char* record = local;
+    if (data->depth_ >= SIZE_LOCAL_RECORD) {
+        record = (char*)malloc(sizeof(char) * (data->depth_ + 1));
+        if (unlikely(!record))
+            return 0;
+    }
+
+    unsigned count;
+    if (data->image_)
+        count = _TrieFrozenVisitPrefix(data, prefix, record, limit, func, arg);
+    else if (data->radix_)
+        count = _TrieRadixVisitPrefix(data, prefix, record, limit, func, arg);
+    else
+        count = _TrieVisitPrefix(data, prefix, record, limit, func, arg);
+
+    if (record != local)
+        free(record);
+    return count;
+}
+
 bool TrieRemove(Trie* self, const char* str)
 {
     if (unlikely(!str))
@@ -605,6 +1280,18 @@ bool TrieRemove(Trie* self, const char* str)
         return false;
 
     TrieData* data = self->data;
+    if (unlikely(data->image_))
+        return false;
+    if (data->radix_) {
+        RadixNode* node = _TrieRadixSearch(data, str);
+        if (!node || !node->endstr_)
+            return false;
+        node->endstr_ = false;
+        data->size_--;
+        _TrieRadixPrune(data, node);
+        return true;
+    }
+
     TrieNode* curr = data->root_;
     TrieNode* pred = NULL;
 
@@ -617,7 +1304,7 @@ bool TrieRemove(Trie* self, const char* str)
             curr = curr->middle_;
             ++str;
         } else {
-            if (ch < token)
+            if (BEFORE(ch, token))
                 curr = curr->left_;
             else
                 curr = curr->right_;
@@ -638,6 +1325,84 @@ unsigned TrieSize(Trie* self)
     return self->data->size_;
 }
 
+bool TrieSetAllocator(Trie* self, const Allocator* alloc)
+{
+    TrieData* data = self->data;
+    if (data->count_node_ > 0 || data->image_)
+        return false;
+
+    if (data->pool_) {
+        PoolDeinit(data->pool_);
+        data->pool_ = NULL;
+    }
+    data->alloc_ = (alloc)? *alloc : *CdsGetAllocator();
+    return true;
+}
+
+bool TrieUsePool(Trie* self)
+{
+    TrieData* data = self->data;
+    if (data->count_node_ > 0 || data->radix_ || data->image_)
+        return false;
+
+    Pool* pool = PoolInit(sizeof(TrieNode));
+    if (unlikely(!pool))
+        return false;
+
+    if (data->pool_)
+        PoolDeinit(data->pool_);
+    data->pool_ = pool;
+    PoolGetAllocator(pool, &(data->alloc_));
+    return true;
+}
+
+bool TrieUseRadix(Trie* self)
+{
+    TrieData* data = self->data;
+    if (data->count_node_ > 0 || data->pool_ || data->image_)
+        return false;
+
+    data->radix_ = true;
+    return true;
+}
+
+bool TrieFreeze(Trie* self, const char* path)
+{
+    if (unlikely(!path))
+        return false;
+
+    /* The loaded image is already frozen. */
+    TrieData* data = self->data;
+    if (data->image_)
+        return _TrieFreezeWrite(path, data->image_, data->length_image_);
+
+    FreezeContext ctx;
+    memset(&ctx, 0, sizeof(FreezeContext));
+
+    bool success = false;
+    /* The image ends with a zero filled block so that the block search over
+       the byte tokens of any node stays within the mapping. */
+    uint32_t root = 0;
+    uint32_t tail;
+    if (_TrieFreezeGather(data, &ctx) &&
+        _TrieFreezeReserve(&ctx, sizeof(FrozenHeader), &root) &&
+        _TrieFreezeNode(&ctx, 0, ctx.count_, 0, 0, &root) &&
+        _TrieFreezeReserve(&ctx, CDS_BYTE_BLOCK, &tail)) {
+        FrozenHeader* header = (FrozenHeader*)ctx.image_;
+        memcpy(header->magic_, frozen_magic, sizeof(frozen_magic));
+        header->size_ = ctx.count_;
+        header->depth_ = data->depth_;
+        header->length_ = ctx.length_image_;
+        header->root_ = root;
+        success = _TrieFreezeWrite(path, ctx.image_, ctx.length_image_);
+    }
+
+    free(ctx.chars_);
+    free(ctx.offsets_);
+    free(ctx.image_);
+    return success;
+}
+
 
 /*===========================================================================*
  *               Implementation for internal operations                      *
@@ -669,7 +1434,7 @@ void _TrieDeinit(TrieData* data)
 
             TrieNode* temp = curr;
             direct = DECIDE_BACKWARD_DIRECTION(&curr);
-            free(temp);
+            DELETE_NODE(data, temp);
             continue;
         }
 
@@ -687,7 +1452,7 @@ void _TrieDeinit(TrieData* data)
 
             TrieNode* temp = curr;
             direct = DECIDE_BACKWARD_DIRECTION(&curr);
-            free(temp);
+            DELETE_NODE(data, temp);
             continue;
         }
 
@@ -700,14 +1465,795 @@ void _TrieDeinit(TrieData* data)
 
             TrieNode* temp = curr;
             direct = DECIDE_BACKWARD_DIRECTION(&curr);
-            free(temp);
+            DELETE_NODE(data, temp);
             continue;
         }
 
         TrieNode* temp = curr;
         direct = DECIDE_BACKWARD_DIRECTION(&curr);
-        free(temp);
+        DELETE_NODE(data, temp);
     }
 
     return;
-}
\ No newline at end of file
+}
+
+unsigned _TrieVisitPrefix(TrieData* data, const char* prefix, char* record,
+                          unsigned limit, TrieVisit func, void* arg)
+{
+    TrieNode* curr = data->root_;
+    TrieNode* pred = NULL;
+
+    /* Longest prefix matching. */
+    const char* dup = prefix;
+    char ch;
+    while (curr && ((ch = *dup) != 0)) {
+        pred = curr;
+        char token = curr->token_;
+        if (ch == token) {
+            curr = curr->middle_;
+            ++dup;
+        } else {
+            if (BEFORE(ch, token))
+                curr = curr->left_;
+            else
+                curr = curr->right_;
+        }
+    }
+
+    /* No such prefix and early return. */
+    if (*dup != 0)
+        return 0;
+
+    unsigned length = dup - prefix;
+    memcpy(record, prefix, sizeof(char) * length);
+
+    /* The given prefix is exactly a stored string. */
+    unsigned count = 0;
+    if (pred->endstr_) {
+        record[length] = 0;
+        ++count;
+        if (!func(record, arg) || count == limit)
+            return count;
+    }
+
+    if (limit > 0)
+        limit -= count;
+    return count + _TrieVisitSubtree(curr, pred, record, length, limit, func,
+                                     arg);
+}
+
+unsigned _TrieVisitSubtree(TrieNode* curr, TrieNode* pred, char* record,
+                           unsigned length, unsigned limit, TrieVisit func,
+                           void* arg)
+{
+    /* The in order traversal bounded by the middle subtree of the given parent
+       node. The slot indexed by length holds the token of the current node. */
+    unsigned count = 0;
+    char direct = DOWN_MIDDLE;
+    while (curr && (curr != pred)) {
+        if (direct == DOWN_LEFT || direct == DOWN_MIDDLE || direct == DOWN_RIGHT) {
+            if (curr->left_) {
+                curr = curr->left_;
+                direct = DOWN_LEFT;
+                continue;
+            }
+            direct = UP_LEFT;
+        }
+
+        if (direct == UP_LEFT) {
+            record[length] = curr->token_;
+            if (curr->endstr_) {
+                record[length + 1] = 0;
+                ++count;
+                if (!func(record, arg) || count == limit)
+                    return count;
+            }
+
+            if (curr->middle_) {
+                curr = curr->middle_;
+                ++length;
+                direct = DOWN_MIDDLE;
+                continue;
+            }
+            direct = UP_MIDDLE;
+        }
+
+        if (direct == UP_MIDDLE && curr->right_) {
+            curr = curr->right_;
+            direct = DOWN_RIGHT;
+            continue;
+        }
+
+        direct = DECIDE_BACKWARD_DIRECTION(&curr);
+        if (direct == UP_MIDDLE)
+            --length;
+    }
+
+    return count;
+}
+
+bool _TrieRadixLink(TrieData* data, RadixNode* node, RadixNode* child,
+                    char token)
+{
+    unsigned count = node->count_;
+    char* tokens = TOKENS(node);
+
+    /* Keep the children in lexicographic order of their first bytes. */
+    unsigned idx = 0;
+    while (idx < count && BEFORE(tokens[idx], token))
+        ++idx;
+
+    if (count == node->capacity_) {
+        unsigned capacity = (count)? (count << 1) : 2;
+        RadixNode** children = (RadixNode**)data->alloc_.alloc(
+                                data->alloc_.ctx, SIZE_CHILDREN(capacity));
+        if (unlikely(!children))
+            return false;
+
+        char* new_tokens = (char*)(children + capacity);
+        if (count > 0) {
+            memcpy(children, node->children_, sizeof(RadixNode*) * count);
+            memcpy(new_tokens, tokens, sizeof(char) * count);
+            data->alloc_.free(data->alloc_.ctx, node->children_);
+        }
+        node->children_ = children;
+        node->capacity_ = capacity;
+        tokens = new_tokens;
+    }
+
+    memmove(node->children_ + idx + 1, node->children_ + idx,
+            sizeof(RadixNode*) * (count - idx));
+    memmove(tokens + idx + 1, tokens + idx, sizeof(char) * (count - idx));
+    node->children_[idx] = child;
+    tokens[idx] = token;
+    node->count_ = count + 1;
+    return true;
+}
+
+void _TrieRadixUnlink(RadixNode* node, char token)
+{
+    char* tokens = TOKENS(node);
+    unsigned idx = CdsFindByte(tokens, node->count_, token);
+    unsigned count = node->count_ - 1;
+    memmove(node->children_ + idx, node->children_ + idx + 1,
+            sizeof(RadixNode*) * (count - idx));
+    memmove(tokens + idx, tokens + idx + 1, sizeof(char) * (count - idx));
+    node->count_ = count;
+}
+
+RadixNode* _TrieRadixSearch(TrieData* data, const char* str)
+{
+    RadixNode* curr = data->radix_root_;
+    if (!curr)
+        return NULL;
+
+    while (*str != 0) {
+        RadixNode** slot = FIND_CHILD(curr, *str);
+        if (!slot)
+            return NULL;
+
+        /* The whole edge label should be matched. The label contains no null
+           byte, so the comparison stops at the string end. */
+        RadixNode* child = *slot;
+        unsigned length = child->length_;
+        if (strncmp(child->label_, str, length) != 0)
+            return NULL;
+        str += length;
+        curr = child;
+    }
+    return curr;
+}
+
+bool _TrieRadixInsert(TrieData* data, const char* str)
+{
+    RadixNode* curr = data->radix_root_;
+    if (unlikely(!curr)) {
+        curr = NEW_RADIX(data, NULL, 0);
+        if (unlikely(!curr))
+            return false;
+        data->radix_root_ = curr;
+    }
+
+    unsigned depth = strlen(str);
+    while (*str != 0) {
+        RadixNode** slot = FIND_CHILD(curr, *str);
+
+        /* Hang the remaining suffix as a new leaf. */
+        if (!slot) {
+            RadixNode* leaf = NEW_RADIX(data, str, strlen(str));
+            if (unlikely(!leaf))
+                return false;
+            if (unlikely(!_TrieRadixLink(data, curr, leaf, *str))) {
+                DELETE_RADIX(data, leaf);
+                return false;
+            }
+            leaf->parent_ = curr;
+            curr = leaf;
+            break;
+        }
+
+        RadixNode* child = *slot;
+        unsigned length = child->length_;
+        unsigned match = 1;
+        while (match < length && str[match] == child->label_[match])
+            ++match;
+        if (match == length) {
+            str += match;
+            curr = child;
+            continue;
+        }
+
+        /* Split the edge at the first mismatched byte. All the new nodes are
+           prepared before the trie is touched. */
+        RadixNode* mid = NEW_RADIX(data, child->label_, match);
+        if (unlikely(!mid))
+            return false;
+        RadixNode* leaf = NULL;
+        if (str[match] != 0) {
+            leaf = NEW_RADIX(data, str + match, strlen(str + match));
+            if (unlikely(!leaf)) {
+                DELETE_RADIX(data, mid);
+                return false;
+            }
+        }
+        bool linked = _TrieRadixLink(data, mid, child, child->label_[match]);
+        if (linked && leaf)
+            linked = _TrieRadixLink(data, mid, leaf, str[match]);
+        if (unlikely(!linked)) {
+            if (leaf)
+                DELETE_RADIX(data, leaf);
+            DELETE_RADIX(data, mid);
+            return false;
+        }
+
+        memmove(child->label_, child->label_ + match, length - match);
+        child->length_ = length - match;
+        child->parent_ = mid;
+        mid->parent_ = curr;
+        *slot = mid;
+        if (leaf) {
+            leaf->parent_ = mid;
+            curr = leaf;
+        } else
+            curr = mid;
+        break;
+    }
+
+    if (!(curr->endstr_)) {
+        curr->endstr_ = true;
+        data->size_++;
+    }
+    if (depth > data->depth_)
+        data->depth_ = depth;
+    return true;
+}
+
+bool _TrieRadixHasPrefixAs(TrieData* data, const char* prefix)
+{
+    RadixNode* curr = data->radix_root_;
+    if (!curr)
+        return false;
+
+    /* Each leaf marks a string end, so reaching any node or stopping inside
+       its label implies a matched string. */
+    while (true) {
+        RadixNode** slot = FIND_CHILD(curr, *prefix);
+        if (!slot)
+            return false;
+
+        RadixNode* child = *slot;
+        unsigned length = child->length_;
+        unsigned match = 1;
+        while (match < length && prefix[match] == child->label_[match])
+            ++match;
+        if (prefix[match] == 0)
+            return true;
+        if (match < length)
+            return false;
+        prefix += match;
+        curr = child;
+    }
+}
+
+bool _TrieRadixGetPrefixAs(TrieData* data, const char* prefix,
+                           const char*** p_strs, unsigned* p_size)
+{
+    unsigned length;
+    RadixNode* curr = _TrieRadixLocate(data, prefix, &length);
+    if (!curr)
+        return false;
+
+    /* Spell the path by extending the prefix with the rest of the label. */
+    char* record = (char*)malloc(sizeof(char) * (data->depth_ + 1));
+    if (unlikely(!record))
+        return false;
+    memcpy(record, prefix, sizeof(char) * length);
+    memcpy(record + length, curr->label_, sizeof(char) * curr->length_);
+    length += curr->length_;
+
+    unsigned capacity = 0;
+    unsigned size = 0;
+    const char** strs = NULL;
+    if (unlikely(!_TrieRadixCollect(curr, record, length, &strs, &size, &capacity))) {
+        FREE_LOCAL_RESOURCE(strs, size, record);
+        return false;
+    }
+
+    free(record);
+    *p_strs = strs;
+    *p_size = size;
+    return true;
+}
+
+RadixNode* _TrieRadixLocate(TrieData* data, const char* prefix,
+                            unsigned* p_length)
+{
+    RadixNode* curr = data->radix_root_;
+    if (!curr)
+        return NULL;
+
+    const char* dup = prefix;
+    while (true) {
+        RadixNode** slot = FIND_CHILD(curr, *dup);
+        if (!slot)
+            return NULL;
+
+        RadixNode* child = *slot;
+        unsigned length = child->length_;
+        unsigned match = 1;
+        while (match < length && dup[match] == child->label_[match])
+            ++match;
+        if (dup[match] == 0) {
+            *p_length = dup - prefix;
+            return child;
+        }
+        if (match < length)
+            return NULL;
+        curr = child;
+        dup += match;
+    }
+}
+
+unsigned _TrieRadixVisitPrefix(TrieData* data, const char* prefix,
+                               char* record, unsigned limit, TrieVisit func,
+                               void* arg)
+{
+    unsigned length;
+    RadixNode* top = _TrieRadixLocate(data, prefix, &length);
+    if (!top)
+        return 0;
+
+    memcpy(record, prefix, sizeof(char) * length);
+    memcpy(record + length, top->label_, sizeof(char) * top->length_);
+    length += top->length_;
+
+    return _TrieRadixVisitSubtree(top, record, length, limit, func, arg);
+}
+
+unsigned _TrieRadixVisitSubtree(RadixNode* top, char* record, unsigned length,
+                                unsigned limit, TrieVisit func, void* arg)
+{
+    /* The pre order traversal following the parent links. Since the children
+       are sorted by their first label bytes, the strings come out in
+       lexicographic order. */
+    unsigned count = 0;
+    RadixNode* curr = top;
+    while (true) {
+        if (curr->endstr_) {
+            record[length] = 0;
+            ++count;
+            if (!func(record, arg) || count == limit)
+                return count;
+        }
+
+        /* Descend to the first child. */
+        if (curr->count_ > 0) {
+            curr = curr->children_[0];
+            memcpy(record + length, curr->label_, sizeof(char) * curr->length_);
+            length += curr->length_;
+            continue;
+        }
+
+        /* Ascend until a next sibling is found. */
+        RadixNode* next = NULL;
+        while (curr != top) {
+            RadixNode* parent = curr->parent_;
+            length -= curr->length_;
+            RadixNode** slot = FIND_CHILD(parent, curr->label_[0]);
+            if (slot + 1 < parent->children_ + parent->count_) {
+                next = *(slot + 1);
+                break;
+            }
+            curr = parent;
+        }
+        if (!next)
+            return count;
+
+        curr = next;
+        memcpy(record + length, curr->label_, sizeof(char) * curr->length_);
+        length += curr->length_;
+    }
+}
+
+bool _TrieRadixCollect(RadixNode* node, char* record, unsigned length,
+                       const char*** p_strs, unsigned* p_size,
+                       unsigned* p_capacity)
+{
+    if (node->endstr_) {
+        unsigned size = *p_size;
+        if (size == *p_capacity) {
+            unsigned capacity = (size)? (size << 1) : 8;
+            const char** strs = (const char**)realloc(*p_strs,
+                                    sizeof(const char*) * capacity);
+            if (unlikely(!strs))
+                return false;
+            *p_strs = strs;
+            *p_capacity = capacity;
+        }
+
+        record[length] = 0;
+        char* str = strdup(record);
+        if (unlikely(!str))
+            return false;
+        (*p_strs)[size] = str;
+        *p_size = size + 1;
+    }
+
+    unsigned i;
+    for (i = 0 ; i < node->count_ ; ++i) {
+        RadixNode* child = node->children_[i];
+        memcpy(record + length, child->label_, sizeof(char) * child->length_);
+        if (unlikely(!_TrieRadixCollect(child, record, length + child->length_,
+                                        p_strs, p_size, p_capacity)))
+            return false;
+    }
+    return true;
+}
+
+void _TrieRadixPrune(TrieData* data, RadixNode* node)
+{
+    RadixNode* root = data->radix_root_;
+
+    /* Drop the leaf which no longer marks a string end. */
+    if (node->count_ == 0) {
+        RadixNode* parent = node->parent_;
+        _TrieRadixUnlink(parent, node->label_[0]);
+        DELETE_RADIX(data, node);
+        node = parent;
+    }
+    if (node == root || node->endstr_ || node->count_ != 1)
+        return;
+
+    /* Merge the pass through node with its only child. The merge is skipped
+       for insufficient memory since the trie is still valid. */
+    RadixNode* child = node->children_[0];
+    RadixNode* merge = NEW_RADIX(data, NULL, node->length_ + child->length_);
+    if (unlikely(!merge))
+        return;
+    memcpy(merge->label_, node->label_, sizeof(char) * node->length_);
+    memcpy(merge->label_ + node->length_, child->label_,
+           sizeof(char) * child->length_);
+
+    merge->endstr_ = child->endstr_;
+    merge->count_ = child->count_;
+    merge->capacity_ = child->capacity_;
+    merge->children_ = child->children_;
+    child->children_ = NULL;
+
+    unsigned i;
+    for (i = 0 ; i < merge->count_ ; ++i)
+        merge->children_[i]->parent_ = merge;
+
+    RadixNode* parent = node->parent_;
+    merge->parent_ = parent;
+    *FIND_CHILD(parent, node->label_[0]) = merge;
+
+    DELETE_RADIX(data, child);
+    DELETE_RADIX(data, node);
+}
+
+void _TrieRadixDeinit(TrieData* data, RadixNode* node)
+{
+    unsigned i;
+    for (i = 0 ; i < node->count_ ; ++i)
+        _TrieRadixDeinit(data, node->children_[i]);
+    DELETE_RADIX(data, node);
+}
+
+const FrozenNode* _TrieFrozenSearch(TrieData* data, const char* str)
+{
+    const char* image = data->image_;
+    const FrozenHeader* header = (const FrozenHeader*)image;
+    const FrozenNode* curr = FROZEN_NODE(image, header->root_);
+
+    while (*str != 0) {
+        curr = FROZEN_FIND_CHILD(image, curr, *str);
+        if (!curr)
+            return NULL;
+
+        unsigned length = curr->length_;
+        if (strncmp(FROZEN_LABEL(curr), str, length) != 0)
+            return NULL;
+        str += length;
+    }
+    return curr;
+}
+
+const FrozenNode* _TrieFrozenLocate(TrieData* data, const char* prefix,
+                                    unsigned* p_length)
+{
+    const char* image = data->image_;
+    const FrozenHeader* header = (const FrozenHeader*)image;
+    const FrozenNode* curr = FROZEN_NODE(image, header->root_);
+
+    const char* dup = prefix;
+    while (true) {
+        curr = FROZEN_FIND_CHILD(image, curr, *dup);
+        if (!curr)
+            return NULL;
+
+        const char* label = FROZEN_LABEL(curr);
+        unsigned length = curr->length_;
+        unsigned match = 1;
+        while (match < length && dup[match] == label[match])
+            ++match;
+        if (dup[match] == 0) {
+            *p_length = dup - prefix;
+            return curr;
+        }
+        if (match < length)
+            return NULL;
+        dup += match;
+    }
+}
+
+unsigned _TrieFrozenVisitPrefix(TrieData* data, const char* prefix,
+                                char* record, unsigned limit, TrieVisit func,
+                                void* arg)
+{
+    unsigned length;
+    const FrozenNode* top = _TrieFrozenLocate(data, prefix, &length);
+    if (!top)
+        return 0;
+
+    memcpy(record, prefix, sizeof(char) * length);
+    memcpy(record + length, FROZEN_LABEL(top), sizeof(char) * top->length_);
+    length += top->length_;
+
+    unsigned count = 0;
+    _TrieFrozenVisitSubtree(data->image_, top, record, length, limit, func, arg,
+                            &count);
+    return count;
+}
+
+bool _TrieFrozenVisitSubtree(const char* image, const FrozenNode* node,
+                             char* record, unsigned length, unsigned limit,
+                             TrieVisit func, void* arg, unsigned* p_count)
+{
+    /* The frozen nodes keep no parent link, so the traversal recurses once per
+       branching point on the path. */
+    if (node->endstr_) {
+        record[length] = 0;
+        ++(*p_count);
+        if (!func(record, arg) || *p_count == limit)
+            return false;
+    }
+
+    unsigned i;
+    for (i = 0 ; i < node->count_ ; ++i) {
+        const FrozenNode* child = FROZEN_NODE(image, node->children_[i]);
+        memcpy(record + length, FROZEN_LABEL(child),
+               sizeof(char) * child->length_);
+        if (!_TrieFrozenVisitSubtree(image, child, record,
+                                     length + child->length_, limit, func, arg,
+                                     p_count))
+            return false;
+    }
+    return true;
+}
+
+bool _TrieFrozenGetPrefixAs(TrieData* data, const char* prefix,
+                            const char*** p_strs, unsigned* p_size)
+{
+    unsigned length;
+    const FrozenNode* top = _TrieFrozenLocate(data, prefix, &length);
+    if (!top)
+        return false;
+
+    char* record = (char*)malloc(sizeof(char) * (data->depth_ + 1));
+    if (unlikely(!record))
+        return false;
+    memcpy(record, prefix, sizeof(char) * length);
+    memcpy(record + length, FROZEN_LABEL(top), sizeof(char) * top->length_);
+    length += top->length_;
+
+    /* Every frozen leaf marks a string end, so the subtree holds at least one
+       string and a short count means insufficient memory. */
+    StringArray array;
+    array.strs_ = NULL;
+    array.size_ = 0;
+    array.capacity_ = 0;
+    unsigned count = 0;
+    _TrieFrozenVisitSubtree(data->image_, top, record, length, 0,
+                            _TrieCollectString, &array, &count);
+    if (unlikely(count != array.size_ || array.size_ == 0)) {
+        FREE_LOCAL_RESOURCE(array.strs_, array.size_, record);
+        return false;
+    }
+
+    free(record);
+    *p_strs = array.strs_;
+    *p_size = array.size_;
+    return true;
+}
+
+bool _TrieCollectString(const char* str, void* arg)
+{
+    StringArray* array = (StringArray*)arg;
+    unsigned size = array->size_;
+    if (size == array->capacity_) {
+        unsigned capacity = (size)? (size << 1) : 8;
+        const char** strs = (const char**)realloc(array->strs_,
+                                sizeof(const char*) * capacity);
+        if (unlikely(!strs))
+            return false;
+        array->strs_ = strs;
+        array->capacity_ = capacity;
+    }
+
+    char* dup = strdup(str);
+    if (unlikely(!dup))
+        return false;
+    array->strs_[size] = dup;
+    array->size_ = size + 1;
+    return true;
+}
+
+bool _TrieGatherString(const char* str, void* arg)
+{
+    FreezeContext* ctx = (FreezeContext*)arg;
+    size_t length = strlen(str) + 1;
+    size_t need = ctx->length_chars_ + length;
+    if (need > ctx->capacity_chars_) {
+        size_t capacity = (ctx->capacity_chars_)? ctx->capacity_chars_ : 4096;
+        while (capacity < need)
+            capacity <<= 1;
+        char* chars = (char*)realloc(ctx->chars_, capacity);
+        if (unlikely(!chars))
+            return false;
+        ctx->chars_ = chars;
+        ctx->capacity_chars_ = capacity;
+    }
+
+    memcpy(ctx->chars_ + ctx->length_chars_, str, length);
+    ctx->offsets_[ctx->count_++] = ctx->length_chars_;
+    ctx->length_chars_ = need;
+    return true;
+}
+
+bool _TrieFreezeGather(TrieData* data, FreezeContext* ctx)
+{
+    unsigned size = data->size_;
+    ctx->offsets_ = (size_t*)malloc(sizeof(size_t) * (size + 1));
+    if (unlikely(!ctx->offsets_))
+        return false;
+    char* record = (char*)malloc(sizeof(char) * (data->depth_ + 1));
+    if (unlikely(!record))
+        return false;
+
+    /* Both node representations yield the strings in lexicographic order,
+       comparing the bytes as unsigned char like strcmp. The frozen children
+       are laid out in this order, so the loaded trie visits the same way. */
+    if (data->radix_) {
+        if (data->radix_root_)
+            _TrieRadixVisitSubtree(data->radix_root_, record, 0, 0,
+                                   _TrieGatherString, ctx);
+    } else
+        _TrieVisitSubtree(data->root_, NULL, record, 0, 0, _TrieGatherString,
+                          ctx);
+
+    free(record);
+    return ctx->count_ == size;
+}
+
+bool _TrieFreezeReserve(FreezeContext* ctx, size_t size, uint32_t* p_offset)
+{
+    size = (size + frozen_align - 1) & ~((size_t)frozen_align - 1);
+    size_t offset = ctx->length_image_;
+    size_t need = offset + size;
+    if (unlikely(need > UINT32_MAX))
+        return false;
+
+    if (need > ctx->capacity_image_) {
+        size_t capacity = (ctx->capacity_image_)? ctx->capacity_image_ : 4096;
+        while (capacity < need)
+            capacity <<= 1;
+        char* image = (char*)realloc(ctx->image_, capacity);
+        if (unlikely(!image))
+            return false;
+        ctx->image_ = image;
+        ctx->capacity_image_ = capacity;
+    }
+
+    memset(ctx->image_ + offset, 0, size);
+    ctx->length_image_ = need;
+    *p_offset = offset;
+    return true;
+}
+
+bool _TrieFreezeNode(FreezeContext* ctx, unsigned lo, unsigned hi,
+                     unsigned begin, unsigned end, uint32_t* p_offset)
+{
+    /* The sorted range starts with the shortest string, which ends exactly at
+       this node if it is not longer than the shared path. */
+    bool endstr = (lo < hi && GATHERED(ctx, lo)[end] == 0);
+    unsigned from = (endstr)? lo + 1 : lo;
+
+    /* Count the children grouped by the byte following the shared path. */
+    unsigned count = 0;
+    unsigned i = from;
+    while (i < hi) {
+        char token = GATHERED(ctx, i)[end];
+        do {
+            ++i;
+        } while (i < hi && GATHERED(ctx, i)[end] == token);
+        ++count;
+    }
+
+    unsigned length = end - begin;
+    size_t size = sizeof(FrozenNode) + sizeof(uint32_t) * count +
+                  sizeof(char) * (count + length);
+    uint32_t offset;
+    if (unlikely(!_TrieFreezeReserve(ctx, size, &offset)))
+        return false;
+
+    FrozenNode* node = (FrozenNode*)(ctx->image_ + offset);
+    node->endstr_ = endstr;
+    node->count_ = count;
+    node->length_ = length;
+    if (length > 0)
+        memcpy(FROZEN_LABEL(node), GATHERED(ctx, lo) + begin, length);
+
+    unsigned order = 0;
+    i = from;
+    while (i < hi) {
+        const char* head = GATHERED(ctx, i);
+        char token = head[end];
+        unsigned j = i + 1;
+        while (j < hi && GATHERED(ctx, j)[end] == token)
+            ++j;
+
+        /* The sorted group shares the common prefix of its first and last
+           strings, which bounds the label of the child. */
+        const char* tail = GATHERED(ctx, j - 1);
+        unsigned share = end + 1;
+        while (head[share] != 0 && head[share] == tail[share])
+            ++share;
+
+        uint32_t child;
+        if (unlikely(!_TrieFreezeNode(ctx, i, j, end, share, &child)))
+            return false;
+
+        /* The image may be moved by the reservation for the subtree. */
+        node = (FrozenNode*)(ctx->image_ + offset);
+        node->children_[order] = child;
+        FROZEN_TOKENS(node)[order] = token;
+        ++order;
+        i = j;
+    }
+
+    *p_offset = offset;
+    return true;
+}
+
+bool _TrieFreezeWrite(const char* path, const char* image, size_t length)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    bool success = (fwrite(image, sizeof(char), length, file) == length);
+    if (fclose(file) != 0)
+        success = false;
+    return success;
+}
@@ -0,0 +1,665 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/trie_map.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+/* The key spelled during prefix visit stays on the stack within this size. */
+#define SIZE_LOCAL_RECORD   (256)
+
+
+/* The compressed node whose incoming edge is labeled by a byte span. The child
+   array is followed by the first label bytes of the children for scanning. */
+typedef struct TrieMapNode_ {
+    bool endstr_;
+    unsigned short count_;
+    unsigned short capacity_;
+    unsigned length_;
+    void* value_;
+    struct TrieMapNode_* parent_;
+    struct TrieMapNode_** children_;
+    char label_[];
+} TrieMapNode;
+
+struct _TrieMapData {
+    unsigned size_;
+    unsigned count_node_;
+    unsigned depth_;
+    TrieMapNode* root_;
+    TrieMapCleanValue func_clean_val_;
+    Allocator alloc_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Allocate the trie node holding the designated label via the allocator.
+ */
+static inline TrieMapNode* NEW_NODE(TrieMapData* data, const char* label,
+                                    unsigned length)
+{
+    TrieMapNode* node = (TrieMapNode*)data->alloc_.alloc(data->alloc_.ctx,
+                                    sizeof(TrieMapNode) + sizeof(char) * length);
+    if (unlikely(!node))
+        return NULL;
+
+    node->endstr_ = false;
+    node->count_ = 0;
+    node->capacity_ = 0;
+    node->length_ = length;
+    node->value_ = NULL;
+    node->parent_ = NULL;
+    node->children_ = NULL;
+    if (label)
+        memcpy(node->label_, label, sizeof(char) * length);
+    data->count_node_++;
+    return node;
+}
+
+/**
+ * Release the trie node and its child array via the allocator.
+ */
+static inline void DELETE_NODE(TrieMapData* data, TrieMapNode* node)
+{
+    if (node->children_)
+        data->alloc_.free(data->alloc_.ctx, node->children_);
+    data->alloc_.free(data->alloc_.ctx, node);
+    data->count_node_--;
+}
+
+/**
+ * Return the first label bytes of the children of the trie node.
+ */
+static inline char* TOKENS(TrieMapNode* node)
+{
+    return (char*)(node->children_ + node->capacity_);
+}
+
+/**
+ * Check if the label byte goes before the other one. The bytes are compared as
+ * unsigned char like strcmp, so the UTF-8 strings keep their code point order.
+ */
+static inline bool BEFORE(char lhs, char rhs)
+{
+    return (unsigned char)lhs < (unsigned char)rhs;
+}
+
+/**
+ * Return the slot of the child whose label starts with the designated byte.
+ */
+static inline TrieMapNode** FIND_CHILD(TrieMapNode* node, char ch)
+{
+    if (node->count_ == 0)
+        return NULL;
+    int idx = CdsFindByte(TOKENS(node), node->count_, ch);
+    return (idx >= 0)? node->children_ + idx : NULL;
+}
+
+/**
+ * Return the size of the child array whose byte tokens are padded for the
+ * block search.
+ */
+static inline size_t SIZE_CHILDREN(unsigned capacity)
+{
+    unsigned span = (capacity + CDS_BYTE_BLOCK - 1) & ~(CDS_BYTE_BLOCK - 1);
+    return sizeof(TrieMapNode*) * capacity + sizeof(char) * span;
+}
+
+/**
+ * @brief Traverse all the trie nodes and clean the allocated resource.
+ *
+ * @param data          The pointer to the map private data
+ * @param node          The pointer to the subtree root
+ */
+void _TrieMapDeinit(TrieMapData* data, TrieMapNode* node);
+
+/**
+ * @brief Link the child to the trie node in ascending order of the first
+ * label bytes, and extend the child array if necessary.
+ *
+ * @param data          The pointer to the map private data
+ * @param node          The pointer to the parent node
+ * @param child         The pointer to the child node
+ * @param token         The first label byte of the child
+ *
+ * @retval true         The child is successfully linked
+ * @retval false        Insufficient memory to extend the child array
+ */
+bool _TrieMapLink(TrieMapData* data, TrieMapNode* node, TrieMapNode* child,
+                  char token);
+
+/**
+ * @brief Unlink the child whose label starts with the designated byte.
+ *
+ * @param node          The pointer to the parent node
+ * @param token         The first label byte of the child
+ */
+void _TrieMapUnlink(TrieMapNode* node, char token);
+
+/**
+ * @brief Locate the trie node whose path spells exactly the designated key.
+ *
+ * @param data          The pointer to the map private data
+ * @param key           The designated key
+ *
+ * @retval node         The target node
+ * @retval NULL         No such path
+ */
+TrieMapNode* _TrieMapSearch(TrieMapData* data, const char* key);
+
+/**
+ * @brief Locate the trie node for the designated key, and create the path
+ * if necessary.
+ *
+ * @param data          The pointer to the map private data
+ * @param key           The designated non-empty key
+ *
+ * @retval node         The node whose path spells the key
+ * @retval NULL         Insufficient memory for the new nodes
+ */
+TrieMapNode* _TrieMapReach(TrieMapData* data, const char* key);
+
+/**
+ * @brief Remove the nodes which no longer lead to any key, and merge the node
+ * having a single child to keep the edges compressed.
+ *
+ * @param data          The pointer to the map private data
+ * @param node          The node whose key end mark is just cleared
+ */
+void _TrieMapPrune(TrieMapData* data, TrieMapNode* node);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+TrieMap* TrieMapInit()
+{
+    TrieMap* obj = (TrieMap*)malloc(sizeof(TrieMap));
+    if (unlikely(!obj))
+        return NULL;
+
+    TrieMapData* data = (TrieMapData*)malloc(sizeof(TrieMapData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    data->size_ = 0;
+    data->count_node_ = 0;
+    data->depth_ = 0;
+    data->root_ = NULL;
+    data->func_clean_val_ = NULL;
+    data->alloc_ = *CdsGetAllocator();
+
+    obj->data = data;
+    obj->put = TrieMapPut;
+    obj->get = TrieMapGet;
+    obj->find = TrieMapFind;
+    obj->remove = TrieMapRemove;
+    obj->size = TrieMapSize;
+    obj->longest_prefix_match = TrieMapLongestPrefixMatch;
+    obj->visit_prefix = TrieMapVisitPrefix;
+    obj->set_clean_value = TrieMapSetCleanValue;
+    obj->set_allocator = TrieMapSetAllocator;
+    return obj;
+}
+
+void TrieMapDeinit(TrieMap* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    TrieMapData* data = obj->data;
+    if (data->root_)
+        _TrieMapDeinit(data, data->root_);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool TrieMapPut(TrieMap* self, const char* key, void* value)
+{
+    if (unlikely(!key))
+        return false;
+    if (unlikely(*key == 0))
+        return false;
+
+    TrieMapData* data = self->data;
+    TrieMapNode* node = _TrieMapReach(data, key);
+    if (unlikely(!node))
+        return false;
+
+    /* Conflict with the already stored key value pair. */
+    if (node->endstr_) {
+        if (data->func_clean_val_)
+            data->func_clean_val_(node->value_);
+    } else {
+        node->endstr_ = true;
+        data->size_++;
+    }
+    node->value_ = value;
+
+    unsigned depth = strlen(key);
+    if (depth > data->depth_)
+        data->depth_ = depth;
+    return true;
+}
+
+void* TrieMapGet(TrieMap* self, const char* key)
+{
+    if (unlikely(!key))
+        return NULL;
+
+    TrieMapNode* node = _TrieMapSearch(self->data, key);
+    return (node && node->endstr_)? node->value_ : NULL;
+}
+
+bool TrieMapFind(TrieMap* self, const char* key)
+{
+    if (unlikely(!key))
+        return false;
+
+    TrieMapNode* node = _TrieMapSearch(self->data, key);
+    return (node && node->endstr_)? true : false;
+}
+
+bool TrieMapRemove(TrieMap* self, const char* key)
+{
+    if (unlikely(!key))
+        return false;
+
+    TrieMapData* data = self->data;
+    TrieMapNode* node = _TrieMapSearch(data, key);
+    if (!node || !node->endstr_)
+        return false;
+
+    if (data->func_clean_val_)
+        data->func_clean_val_(node->value_);
+    node->endstr_ = false;
+    node->value_ = NULL;
+    data->size_--;
+    _TrieMapPrune(data, node);
+    return true;
+}
+
+unsigned TrieMapSize(TrieMap* self)
+{
+    return self->data->size_;
+}
+
+unsigned TrieMapLongestPrefixMatch(TrieMap* self, const char* str,
+                                   void** p_value)
+{
+    if (unlikely(!str))
+        return 0;
+
+    TrieMapNode* curr = self->data->root_;
+    if (!curr)
+        return 0;
+
+    /* Descend as long as the whole edge labels are matched, and remember the
+       last passed node ending a key. */
+    TrieMapNode* last = NULL;
+    unsigned length = 0;
+    unsigned match = 0;
+    while (str[length] != 0) {
+        TrieMapNode** slot = FIND_CHILD(curr, str[length]);
+        if (!slot)
+            break;
+
+        TrieMapNode* child = *slot;
+        if (strncmp(child->label_, str + length, child->length_) != 0)
+            break;
+        length += child->length_;
+        curr = child;
+        if (curr->endstr_) {
+            last = curr;
+            match = length;
+        }
+    }
+
+    if (last && p_value)
+        *p_value = last->value_;
+    return match;
+}
+
+unsigned TrieMapVisitPrefix(TrieMap* self, const char* prefix, unsigned limit,
+                            TrieMapVisit func, void* arg)
+{
+    if (unlikely(!prefix))
+        return 0;
+    if (unlikely(*prefix == 0))
+        return 0;
+
+    TrieMapData* data = self->data;
+    TrieMapNode* top = data->root_;
+    if (!top)
+        return 0;
+
+    /* Locate the highest node whose path covers the prefix. */
+    const char* dup = prefix;
+    while (true) {
+        TrieMapNode** slot = FIND_CHILD(top, *dup);
+        if (!slot)
+            return 0;
+
+        TrieMapNode* child = *slot;
+        unsigned length = child->length_;
+        unsigned match = 1;
+        while (match < length && dup[match] == child->label_[match])
+            ++match;
+        top = child;
+        if (dup[match] == 0)
+            break;
+        if (match < length)
+            return 0;
+        dup += match;
+    }
+
+    /* The keys are spelled on the stack unless the longest one ever stored
+       exceeds the local buffer. */
+    char local[SIZE_LOCAL_RECORD];
+    char* record = local;
+    if (data->depth_ >= SIZE_LOCAL_RECORD) {
+        record = (char*)malloc(sizeof(char) * (data->depth_ + 1));
+        if (unlikely(!record))
+            return 0;
+    }
+
+    unsigned length = dup - prefix;
+    memcpy(record, prefix, sizeof(char) * length);
+    memcpy(record + length, top->label_, sizeof(char) * top->length_);
+    length += top->length_;
+
+    /* The pre order traversal following the parent links. Since the children
+       are sorted by their first label bytes, the keys come out in
+       lexicographic order. */
+    unsigned count = 0;
+    TrieMapNode* curr = top;
+    while (true) {
+        if (curr->endstr_) {
+            record[length] = 0;
+            ++count;
+            if (!func(record, curr->value_, arg) || count == limit)
+                break;
+        }
+
+        /* Descend to the first child. */
+        if (curr->count_ > 0) {
+            curr = curr->children_[0];
+            memcpy(record + length, curr->label_, sizeof(char) * curr->length_);
+            length += curr->length_;
+            continue;
+        }
+
+        /* Ascend until a next sibling is found. */
+        TrieMapNode* next = NULL;
+        while (curr != top) {
+            TrieMapNode* parent = curr->parent_;
+            length -= curr->length_;
+            TrieMapNode** slot = FIND_CHILD(parent, curr->label_[0]);
+            if (slot + 1 < parent->children_ + parent->count_) {
+                next = *(slot + 1);
+                break;
+            }
+            curr = parent;
+        }
+        if (!next)
+            break;
+
+        curr = next;
+        memcpy(record + length, curr->label_, sizeof(char) * curr->length_);
+        length += curr->length_;
+    }
+
+    if (record != local)
+        free(record);
+    return count;
+}
+
+void TrieMapSetCleanValue(TrieMap* self, TrieMapCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+bool TrieMapSetAllocator(TrieMap* self, const Allocator* alloc)
+{
+    TrieMapData* data = self->data;
+    if (data->count_node_ > 0)
+        return false;
+
+    data->alloc_ = (alloc)? *alloc : *CdsGetAllocator();
+    return true;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+void _TrieMapDeinit(TrieMapData* data, TrieMapNode* node)
+{
+    unsigned i;
+    for (i = 0 ; i < node->count_ ; ++i)
+        _TrieMapDeinit(data, node->children_[i]);
+
+    if (node->endstr_ && data->func_clean_val_)
+        data->func_clean_val_(node->value_);
+    DELETE_NODE(data, node);
+}
+
+bool _TrieMapLink(TrieMapData* data, TrieMapNode* node, TrieMapNode* child,
+                  char token)
+{
+    unsigned count = node->count_;
+    char* tokens = TOKENS(node);
+
+    /* Keep the children in lexicographic order of their first bytes. */
+    unsigned idx = 0;
+    while (idx < count && BEFORE(tokens[idx], token))
+        ++idx;
+
+    if (count == node->capacity_) {
+        unsigned capacity = (count)? (count << 1) : 2;
+        TrieMapNode** children = (TrieMapNode**)data->alloc_.alloc(
+                                    data->alloc_.ctx, SIZE_CHILDREN(capacity));
+        if (unlikely(!children))
+            return false;
+
+        char* new_tokens = (char*)(children + capacity);
+        if (count > 0) {
+            memcpy(children, node->children_, sizeof(TrieMapNode*) * count);
+            memcpy(new_tokens, tokens, sizeof(char) * count);
+            data->alloc_.free(data->alloc_.ctx, node->children_);
+        }
+        node->children_ = children;
+        node->capacity_ = capacity;
+        tokens = new_tokens;
+    }
+
+    memmove(node->children_ + idx + 1, node->children_ + idx,
+            sizeof(TrieMapNode*) * (count - idx));
+    memmove(tokens + idx + 1, tokens + idx, sizeof(char) * (count - idx));
+    node->children_[idx] = child;
+    tokens[idx] = token;
+    node->count_ = count + 1;
+    return true;
+}
+
+void _TrieMapUnlink(TrieMapNode* node, char token)
+{
+    char* tokens = TOKENS(node);
+    unsigned idx = CdsFindByte(tokens, node->count_, token);
+    unsigned count = node->count_ - 1;
+    memmove(node->children_ + idx, node->children_ + idx + 1,
+            sizeof(TrieMapNode*) * (count - idx));
+    memmove(tokens + idx, tokens + idx + 1, sizeof(char) * (count - idx));
+    node->count_ = count;
+}
+
+TrieMapNode* _TrieMapSearch(TrieMapData* data, const char* key)
+{
+    TrieMapNode* curr = data->root_;
+    if (!curr || *key == 0)
+        return NULL;
+
+    while (*key != 0) {
+        TrieMapNode** slot = FIND_CHILD(curr, *key);
+        if (!slot)
+            return NULL;
+
+        /* The whole edge label should be matched. The label contains no null
+           byte, so the comparison stops at the key end. */
+        TrieMapNode* child = *slot;
+        unsigned length = child->length_;
+        if (strncmp(child->label_, key, length) != 0)
+            return NULL;
+        key += length;
+        curr = child;
+    }
+    return curr;
+}
+
+TrieMapNode* _TrieMapReach(TrieMapData* data, const char* key)
+{
+    TrieMapNode* curr = data->root_;
+    if (unlikely(!curr)) {
+        curr = NEW_NODE(data, NULL, 0);
+        if (unlikely(!curr))
+            return NULL;
+        data->root_ = curr;
+    }
+
+    while (*key != 0) {
+        TrieMapNode** slot = FIND_CHILD(curr, *key);
+
+        /* Hang the remaining suffix as a new leaf. */
+        if (!slot) {
+            TrieMapNode* leaf = NEW_NODE(data, key, strlen(key));
+            if (unlikely(!leaf))
+                return NULL;
+            if (unlikely(!_TrieMapLink(data, curr, leaf, *key))) {
+                DELETE_NODE(data, leaf);
+                return NULL;
+            }
+            leaf->parent_ = curr;
+            return leaf;
+        }
+
+        TrieMapNode* child = *slot;
+        unsigned length = child->length_;
+        unsigned match = 1;
+        while (match < length && key[match] == child->label_[match])
+            ++match;
+        if (match == length) {
+            key += match;
+            curr = child;
+            continue;
+        }
+
+        /* Split the edge at the first mismatched byte. All the new nodes are
+           prepared before the trie is touched. */
+        TrieMapNode* mid = NEW_NODE(data, child->label_, match);
+        if (unlikely(!mid))
+            return NULL;
+        TrieMapNode* leaf = NULL;
+        if (key[match] != 0) {
+            leaf = NEW_NODE(data, key + match, strlen(key + match));
+            if (unlikely(!leaf)) {
+                DELETE_NODE(data, mid);
+                return NULL;
+            }
+        }
+        bool linked = _TrieMapLink(data, mid, child, child->label_[match]);
+        if (linked && leaf)
+            linked = _TrieMapLink(data, mid, leaf, key[match]);
+        if (unlikely(!linked)) {
+            if (leaf)
+                DELETE_NODE(data, leaf);
+            DELETE_NODE(data, mid);
+            return NULL;
+        }
+
+        memmove(child->label_, child->label_ + match, length - match);
+        child->length_ = length - match;
+        child->parent_ = mid;
+        mid->parent_ = curr;
+        *slot = mid;
+        if (!leaf)
+            return mid;
+        leaf->parent_ = mid;
+        return leaf;
+    }
+    return curr;
+}
+
+void _TrieMapPrune(TrieMapData* data, TrieMapNode* node)
+{
+    TrieMapNode* root = data->root_;
+
+    /* Drop the leaf which no longer ends a key. */
+    if (node->count_ == 0) {
+        TrieMapNode* parent = node->parent_;
+        _TrieMapUnlink(parent, node->label_[0]);
+        DELETE_NODE(data, node);
+        node = parent;
+    }
+    if (node == root || node->endstr_ || node->count_ != 1)
+        return;
+
+    /* Merge the pass through node with its only child. The merge is skipped
+       for insufficient memory since the trie is still valid. */
+    TrieMapNode* child = node->children_[0];
+    TrieMapNode* merge = NEW_NODE(data, NULL, node->length_ + child->length_);
+    if (unlikely(!merge))
+        return;
+    memcpy(merge->label_, node->label_, sizeof(char) * node->length_);
+    memcpy(merge->label_ + node->length_, child->label_,
+           sizeof(char) * child->length_);
+
+    merge->endstr_ = child->endstr_;
+    merge->value_ = child->value_;
+    merge->count_ = child->count_;
+    merge->capacity_ = child->capacity_;
+    merge->children_ = child->children_;
+    child->children_ = NULL;
+
+    unsigned i;
+    for (i = 0 ; i < merge->count_ ; ++i)
+        merge->children_[i]->parent_ = merge;
+
+    TrieMapNode* parent = node->parent_;
+    merge->parent_ = parent;
+    *FIND_CHILD(parent, node->label_[0]) = merge;
+
+    DELETE_NODE(data, child);
+    DELETE_NODE(data, node);
+}
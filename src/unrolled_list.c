@@ -0,0 +1,644 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/unrolled_list.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+typedef struct _Chunk {
+    struct _Chunk* pred_;
+    struct _Chunk* succ_;
+    unsigned count_;
+    void* elements_[];
+} Chunk;
+
+struct _UnrolledListData {
+    unsigned size_;
+    unsigned cap_chunk_;
+    unsigned iter_offset_;
+    Chunk* head_;
+    Chunk* tail_;
+    Chunk* iter_chunk_;
+    UnrolledListClean func_clean_;
+    Allocator alloc_;
+};
+
+/* The default chunk size in bytes which spans four cache lines. */
+static const size_t SIZE_DEFAULT_CHUNK = 256;
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Allocate the chunk via the designated allocator.
+ */
+static inline Chunk* NEW_CHUNK(UnrolledListData* data)
+{
+    size_t size = sizeof(Chunk) + sizeof(void*) * data->cap_chunk_;
+    return (Chunk*)data->alloc_.alloc(data->alloc_.ctx, size);
+}
+
+/**
+ * Release the chunk via the designated allocator.
+ */
+static inline void DELETE_CHUNK(UnrolledListData* data, Chunk* chunk)
+{
+    data->alloc_.free(data->alloc_.ctx, chunk);
+}
+
+/**
+ * @brief Find the chunk holding the element at the specified index.
+ *
+ * The chunks are walked from the closer end of the list.
+ *
+ * @param data          The pointer to the list private data
+ * @param p_idx         The pointer to the index which is smaller than the list
+ *                      size, and is replaced with the offset in the chunk
+ *
+ * @retval chunk        The chunk holding the element
+ */
+Chunk* _UnrolledListLocate(UnrolledListData* data, unsigned* p_idx);
+
+/**
+ * @brief Allocate an empty chunk and link it after the designated one.
+ *
+ * @param data          The pointer to the list private data
+ * @param pred          The predecessor chunk or NULL to link the new head
+ *
+ * @retval chunk        The linked chunk
+ * @retval NULL         Insufficient memory
+ */
+Chunk* _UnrolledListLink(UnrolledListData* data, Chunk* pred);
+
+/**
+ * @brief Unlink the chunk and release it.
+ *
+ * @param data          The pointer to the list private data
+ * @param chunk         The designated chunk
+ */
+void _UnrolledListUnlink(UnrolledListData* data, Chunk* chunk);
+
+/**
+ * @brief Release the chunk emptied by the removal, or merge the sparse chunk
+ *        with its neighbor if the elements fit in one chunk.
+ *
+ * @param data          The pointer to the list private data
+ * @param chunk         The chunk which an element is just removed from
+ */
+void _UnrolledListRelieve(UnrolledListData* data, Chunk* chunk);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+UnrolledList* UnrolledListInit(unsigned cap_chunk)
+{
+    UnrolledList* obj = (UnrolledList*)malloc(sizeof(UnrolledList));
+    if (unlikely(!obj))
+        return NULL;
+
+    UnrolledListData* data = (UnrolledListData*)malloc(sizeof(UnrolledListData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    /* A full chunk is split in halves, so it should hold two elements at least. */
+    if (cap_chunk == 0)
+        cap_chunk = (SIZE_DEFAULT_CHUNK - sizeof(Chunk)) / sizeof(void*);
+    else if (cap_chunk < 2)
+        cap_chunk = 2;
+
+    data->size_ = 0;
+    data->cap_chunk_ = cap_chunk;
+    data->iter_offset_ = 0;
+    data->head_ = NULL;
+    data->tail_ = NULL;
+    data->iter_chunk_ = NULL;
+    data->func_clean_ = NULL;
+    data->alloc_ = *CdsGetAllocator();
+
+    obj->data = data;
+    obj->push_front = UnrolledListPushFront;
+    obj->push_back = UnrolledListPushBack;
+    obj->insert = UnrolledListInsert;
+    obj->pop_front = UnrolledListPopFront;
+    obj->pop_back = UnrolledListPopBack;
+    obj->remove = UnrolledListRemove;
+    obj->set_front = UnrolledListSetFront;
+    obj->set_back = UnrolledListSetBack;
+    obj->set_at = UnrolledListSetAt;
+    obj->get_front = UnrolledListGetFront;
+    obj->get_back = UnrolledListGetBack;
+    obj->get_at = UnrolledListGetAt;
+    obj->size = UnrolledListSize;
+    obj->reverse = UnrolledListReverse;
+    obj->first = UnrolledListFirst;
+    obj->next = UnrolledListNext;
+    obj->reverse_next = UnrolledListReverseNext;
+    obj->set_clean = UnrolledListSetClean;
+    obj->set_allocator = UnrolledListSetAllocator;
+
+    return obj;
+}
+
+void UnrolledListDeinit(UnrolledList* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    UnrolledListData* data = obj->data;
+    UnrolledListClean func_clean = data->func_clean_;
+
+    Chunk* curr = data->head_;
+    while (curr) {
+        Chunk* pred = curr;
+        curr = curr->succ_;
+        if (func_clean) {
+            unsigned i;
+            for (i = 0 ; i < pred->count_ ; ++i)
+                func_clean(pred->elements_[i]);
+        }
+        DELETE_CHUNK(data, pred);
+    }
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool UnrolledListPushFront(UnrolledList* self, void* element)
+{
+    UnrolledListData* data = self->data;
+    Chunk* head = data->head_;
+    if (unlikely(!head || head->count_ == data->cap_chunk_)) {
+        head = _UnrolledListLink(data, NULL);
+        if (unlikely(!head))
+            return false;
+    }
+
+    unsigned count = head->count_;
+    if (count > 0)
+        memmove(head->elements_ + 1, head->elements_, sizeof(void*) * count);
+    head->elements_[0] = element;
+    head->count_ = count + 1;
+
+    data->size_++;
+    return true;
+}
+
+bool UnrolledListPushBack(UnrolledList* self, void* element)
+{
+    UnrolledListData* data = self->data;
+    Chunk* tail = data->tail_;
+    if (unlikely(!tail || tail->count_ == data->cap_chunk_)) {
+        tail = _UnrolledListLink(data, tail);
+        if (unlikely(!tail))
+            return false;
+    }
+
+    tail->elements_[tail->count_++] = element;
+    data->size_++;
+    return true;
+}
+
+bool UnrolledListInsert(UnrolledList* self, unsigned idx, void* element)
+{
+    UnrolledListData* data = self->data;
+    unsigned size = data->size_;
+    if (unlikely(idx > size))
+        return false;
+    if (idx == size)
+        return UnrolledListPushBack(self, element);
+
+    unsigned offset = idx;
+    Chunk* chunk = _UnrolledListLocate(data, &offset);
+
+    /* Split the full chunk in halves and insert into the proper one. */
+    if (chunk->count_ == data->cap_chunk_) {
+        Chunk* succ = _UnrolledListLink(data, chunk);
+        if (unlikely(!succ))
+            return false;
+
+        unsigned half = chunk->count_ >> 1;
+        unsigned num_move = chunk->count_ - half;
+        memcpy(succ->elements_, chunk->elements_ + half, sizeof(void*) * num_move);
+        succ->count_ = num_move;
+        chunk->count_ = half;
+        if (offset > half) {
+            chunk = succ;
+            offset -= half;
+        }
+    }
+
+    unsigned num_shift = chunk->count_ - offset;
+    if (num_shift > 0) {
+        void** slot = chunk->elements_ + offset;
+        memmove(slot + 1, slot, sizeof(void*) * num_shift);
+    }
+    chunk->elements_[offset] = element;
+    chunk->count_++;
+
+    data->size_ = size + 1;
+    return true;
+}
+
+bool UnrolledListPopFront(UnrolledList* self)
+{
+    UnrolledListData* data = self->data;
+    Chunk* head = data->head_;
+    if (unlikely(!head))
+        return false;
+
+    UnrolledListClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(head->elements_[0]);
+
+    unsigned count = head->count_ - 1;
+    if (count > 0)
+        memmove(head->elements_, head->elements_ + 1, sizeof(void*) * count);
+    head->count_ = count;
+
+    data->size_--;
+    _UnrolledListRelieve(data, head);
+    return true;
+}
+
+bool UnrolledListPopBack(UnrolledList* self)
+{
+    UnrolledListData* data = self->data;
+    Chunk* tail = data->tail_;
+    if (unlikely(!tail))
+        return false;
+
+    unsigned count = tail->count_ - 1;
+    UnrolledListClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(tail->elements_[count]);
+    tail->count_ = count;
+
+    data->size_--;
+    _UnrolledListRelieve(data, tail);
+    return true;
+}
+
+bool UnrolledListRemove(UnrolledList* self, unsigned idx)
+{
+    UnrolledListData* data = self->data;
+    if (unlikely(idx >= data->size_))
+        return false;
+
+    unsigned offset = idx;
+    Chunk* chunk = _UnrolledListLocate(data, &offset);
+
+    void** slot = chunk->elements_ + offset;
+    UnrolledListClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(*slot);
+
+    unsigned num_shift = chunk->count_ - offset - 1;
+    if (num_shift > 0)
+        memmove(slot, slot + 1, sizeof(void*) * num_shift);
+    chunk->count_--;
+
+    data->size_--;
+    _UnrolledListRelieve(data, chunk);
+    return true;
+}
+
+bool UnrolledListSetFront(UnrolledList* self, void* element)
+{
+    UnrolledListData* data = self->data;
+    Chunk* head = data->head_;
+    if (unlikely(!head))
+        return false;
+
+    UnrolledListClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(head->elements_[0]);
+    head->elements_[0] = element;
+    return true;
+}
+
+bool UnrolledListSetBack(UnrolledList* self, void* element)
+{
+    UnrolledListData* data = self->data;
+    Chunk* tail = data->tail_;
+    if (unlikely(!tail))
+        return false;
+
+    void** slot = tail->elements_ + tail->count_ - 1;
+    UnrolledListClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(*slot);
+    *slot = element;
+    return true;
+}
+
+bool UnrolledListSetAt(UnrolledList* self, unsigned idx, void* element)
+{
+    UnrolledListData* data = self->data;
+    if (unlikely(idx >= data->size_))
+        return false;
+
+    unsigned offset = idx;
+    Chunk* chunk = _UnrolledListLocate(data, &offset);
+
+    void** slot = chunk->elements_ + offset;
+    UnrolledListClean func_clean = data->func_clean_;
+    if (func_clean)
+        func_clean(*slot);
+    *slot = element;
+    return true;
+}
+
+bool UnrolledListGetFront(UnrolledList* self, void** p_element)
+{
+    Chunk* head = self->data->head_;
+    if (unlikely(!head))
+        return false;
+
+    *p_element = head->elements_[0];
+    return true;
+}
+
+bool UnrolledListGetBack(UnrolledList* self, void** p_element)
+{
+    Chunk* tail = self->data->tail_;
+    if (unlikely(!tail))
+        return false;
+
+    *p_element = tail->elements_[tail->count_ - 1];
+    return true;
+}
+
+bool UnrolledListGetAt(UnrolledList* self, unsigned idx, void** p_element)
+{
+    UnrolledListData* data = self->data;
+    if (unlikely(idx >= data->size_))
+        return false;
+
+    unsigned offset = idx;
+    Chunk* chunk = _UnrolledListLocate(data, &offset);
+    *p_element = chunk->elements_[offset];
+    return true;
+}
+
+unsigned UnrolledListSize(UnrolledList* self)
+{
+    return self->data->size_;
+}
+
+void UnrolledListReverse(UnrolledList* self)
+{
+    UnrolledListData* data = self->data;
+
+    /* Reverse the elements of each chunk and then the chunk links. */
+    Chunk* curr = data->head_;
+    while (curr) {
+        void** head = curr->elements_;
+        void** tail = curr->elements_ + curr->count_ - 1;
+        while (head < tail) {
+            void* element = *head;
+            *head++ = *tail;
+            *tail-- = element;
+        }
+
+        Chunk* succ = curr->succ_;
+        curr->succ_ = curr->pred_;
+        curr->pred_ = succ;
+        curr = succ;
+    }
+
+    Chunk* head = data->head_;
+    data->head_ = data->tail_;
+    data->tail_ = head;
+    return;
+}
+
+void UnrolledListFirst(UnrolledList* self, bool is_reverse)
+{
+    UnrolledListData* data = self->data;
+    if (is_reverse == false) {
+        data->iter_chunk_ = data->head_;
+        data->iter_offset_ = 0;
+    } else {
+        Chunk* tail = data->tail_;
+        data->iter_chunk_ = tail;
+        data->iter_offset_ = (tail)? tail->count_ - 1 : 0;
+    }
+}
+
+bool UnrolledListNext(UnrolledList* self, void** p_element)
+{
+    UnrolledListData* data = self->data;
+    Chunk* chunk = data->iter_chunk_;
+    if (unlikely(!chunk))
+        return false;
+
+    unsigned offset = data->iter_offset_;
+    *p_element = chunk->elements_[offset++];
+    if (offset == chunk->count_) {
+        data->iter_chunk_ = chunk->succ_;
+        offset = 0;
+    }
+    data->iter_offset_ = offset;
+    return true;
+}
+
+bool UnrolledListReverseNext(UnrolledList* self, void** p_element)
+{
+    UnrolledListData* data = self->data;
+    Chunk* chunk = data->iter_chunk_;
+    if (unlikely(!chunk))
+        return false;
+
+    unsigned offset = data->iter_offset_;
+    *p_element = chunk->elements_[offset];
+    if (offset == 0) {
+        chunk = chunk->pred_;
+        data->iter_chunk_ = chunk;
+        offset = (chunk)? chunk->count_ : 1;
+    }
+    data->iter_offset_ = offset - 1;
+    return true;
+}
+
+void UnrolledListIterInit(UnrolledList* self, UnrolledListIter* iter,
+                          bool is_reverse)
+{
+    UnrolledListData* data = self->data;
+    iter->data_ = data;
+    iter->is_reverse_ = is_reverse;
+    if (is_reverse == false) {
+        iter->chunk_ = data->head_;
+        iter->offset_ = 0;
+    } else {
+        Chunk* tail = data->tail_;
+        iter->chunk_ = tail;
+        iter->offset_ = (tail)? tail->count_ - 1 : 0;
+    }
+}
+
+bool UnrolledListIterNext(UnrolledListIter* iter, void** p_element)
+{
+    Chunk* chunk = (Chunk*)iter->chunk_;
+    if (unlikely(!chunk))
+        return false;
+
+    unsigned offset = iter->offset_;
+    *p_element = chunk->elements_[offset];
+    if (iter->is_reverse_ == false) {
+        if (++offset == chunk->count_) {
+            iter->chunk_ = chunk->succ_;
+            offset = 0;
+        }
+    } else {
+        if (offset == 0) {
+            chunk = chunk->pred_;
+            iter->chunk_ = chunk;
+            offset = (chunk)? chunk->count_ : 1;
+        }
+        --offset;
+    }
+    iter->offset_ = offset;
+    return true;
+}
+
+void UnrolledListSetClean(UnrolledList* self, UnrolledListClean func)
+{
+    self->data->func_clean_ = func;
+}
+
+bool UnrolledListSetAllocator(UnrolledList* self, const Allocator* alloc)
+{
+    UnrolledListData* data = self->data;
+    if (data->size_ > 0)
+        return false;
+
+    data->alloc_ = (alloc)? *alloc : *CdsGetAllocator();
+    return true;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+Chunk* _UnrolledListLocate(UnrolledListData* data, unsigned* p_idx)
+{
+    unsigned idx = *p_idx;
+    Chunk* chunk;
+
+    if (idx < (data->size_ >> 1)) {
+        chunk = data->head_;
+        while (idx >= chunk->count_) {
+            idx -= chunk->count_;
+            chunk = chunk->succ_;
+        }
+    } else {
+        /* Count the distance from the tail end instead. */
+        unsigned rank = data->size_ - idx;
+        chunk = data->tail_;
+        while (rank > chunk->count_) {
+            rank -= chunk->count_;
+            chunk = chunk->pred_;
+        }
+        idx = chunk->count_ - rank;
+    }
+
+    *p_idx = idx;
+    return chunk;
+}
+
+Chunk* _UnrolledListLink(UnrolledListData* data, Chunk* pred)
+{
+    Chunk* chunk = NEW_CHUNK(data);
+    if (unlikely(!chunk))
+        return NULL;
+
+    Chunk* succ = (pred)? pred->succ_ : data->head_;
+    chunk->count_ = 0;
+    chunk->pred_ = pred;
+    chunk->succ_ = succ;
+    if (pred)
+        pred->succ_ = chunk;
+    else
+        data->head_ = chunk;
+    if (succ)
+        succ->pred_ = chunk;
+    else
+        data->tail_ = chunk;
+    return chunk;
+}
+
+void _UnrolledListUnlink(UnrolledListData* data, Chunk* chunk)
+{
+    Chunk* pred = chunk->pred_;
+    Chunk* succ = chunk->succ_;
+    if (pred)
+        pred->succ_ = succ;
+    else
+        data->head_ = succ;
+    if (succ)
+        succ->pred_ = pred;
+    else
+        data->tail_ = pred;
+    DELETE_CHUNK(data, chunk);
+}
+
+void _UnrolledListRelieve(UnrolledListData* data, Chunk* chunk)
+{
+    unsigned count = chunk->count_;
+    if (count == 0) {
+        _UnrolledListUnlink(data, chunk);
+        return;
+    }
+
+    /* Keep each chunk at least half full unless no neighbor can absorb it. */
+    unsigned cap_chunk = data->cap_chunk_;
+    if (count >= (cap_chunk >> 1))
+        return;
+
+    Chunk* succ = chunk->succ_;
+    if (succ && count + succ->count_ <= cap_chunk) {
+        memcpy(chunk->elements_ + count, succ->elements_,
+               sizeof(void*) * succ->count_);
+        chunk->count_ = count + succ->count_;
+        _UnrolledListUnlink(data, succ);
+        return;
+    }
+
+    Chunk* pred = chunk->pred_;
+    if (pred && pred->count_ + count <= cap_chunk) {
+        memcpy(pred->elements_ + pred->count_, chunk->elements_,
+               sizeof(void*) * count);
+        pred->count_ += count;
+        _UnrolledListUnlink(data, chunk);
+    }
+}
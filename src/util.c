@@ -0,0 +1,666 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "util.h"
+#include <pthread.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/* The AVX2 scan is compiled for the x86 targets and selected at runtime. */
+#if defined(__GNUC__) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define CDS_DISPATCH_AVX2
+#include <immintrin.h>
+#endif
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+/* The chunks prepared for each thread by CdsParallelChunks. */
+static const unsigned CHUNK_PER_THREAD = 4;
+
+/* The chunks smaller than this are not worth a separate claim. */
+static const unsigned SIZE_MIN_CHUNK = 1024;
+
+/* The state shared by the workers of CdsParallelRun. */
+typedef struct _ParallelJob {
+    CdsChunkTask func_;
+    void* ctx_;
+    char* partials_;
+    size_t size_acc_;
+    unsigned num_chunk_;
+    unsigned next_;
+} ParallelJob;
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief The default allocation function backed by malloc.
+ *
+ * @param ctx           The unused allocator context
+ * @param size          The designated size in bytes
+ *
+ * @retval ptr          The pointer to the allocated memory block
+ * @retval NULL         Insufficient memory space
+ */
+void* _CdsAlloc(void* ctx, size_t size);
+
+/**
+ * @brief The default release function backed by free.
+ *
+ * @param ctx           The unused allocator context
+ * @param ptr           The pointer to the memory block
+ */
+void _CdsFree(void* ctx, void* ptr);
+
+/**
+ * @brief The worker loop which claims and processes the chunks until none is
+ * left.
+ *
+ * @param arg           The pointer to the shared job
+ *
+ * @retval NULL         Always
+ */
+void* _CdsParallelWork(void* arg);
+
+/**
+ * Return the bit mask of the bytes in the block equal to the designated one.
+ */
+static inline unsigned MATCH_BLOCK(const char* block, char ch)
+{
+#if defined(__SSE2__)
+    __m128i bytes = _mm_loadu_si128((const __m128i*)block);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(ch)));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                        1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t equal = vceqq_u8(vld1q_u8((const uint8_t*)block),
+                                vdupq_n_u8((uint8_t)ch));
+    uint8x16_t bits = vandq_u8(equal, vld1q_u8(weights));
+    return (unsigned)vaddv_u8(vget_low_u8(bits)) |
+           ((unsigned)vaddv_u8(vget_high_u8(bits)) << 8);
+#else
+    unsigned mask = 0;
+    unsigned i;
+    for (i = 0 ; i < CDS_BYTE_BLOCK ; ++i) {
+        if (block[i] == ch)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief Scan the blocks starting from the designated position.
+ *
+ * @param bytes         The byte array
+ * @param base          The position of the first block
+ * @param count         The number of bytes to search
+ * @param ch            The designated byte
+ *
+ * @retval idx          The index of the first matched byte
+ * @retval -1           No such byte
+ */
+int _CdsFindByteBlock(const char* bytes, unsigned base, unsigned count,
+                      char ch);
+
+/* The snapshot layout: the magic, the version and the kind in the header, the
+   payload size prefixed to each chunk, and the length prefixed to each field. */
+static const uint32_t snapshot_magic = 0x53534443;
+static const unsigned snapshot_version = 1;
+#define SNAPSHOT_SIZE_HEADER    (12)
+#define SNAPSHOT_SIZE_PREFIX    (4)
+
+/**
+ * Store the little endian integers into the byte array.
+ */
+static inline void STORE_U32(char* bytes, uint32_t num)
+{
+    unsigned i;
+    for (i = 0 ; i < 4 ; ++i)
+        bytes[i] = (char)(num >> (i * 8));
+}
+
+static inline void STORE_U64(char* bytes, uint64_t num)
+{
+    STORE_U32(bytes, (uint32_t)num);
+    STORE_U32(bytes + 4, (uint32_t)(num >> 32));
+}
+
+/**
+ * Load the little endian integers from the byte array.
+ */
+static inline uint32_t LOAD_U32(const char* bytes)
+{
+    const unsigned char* src = (const unsigned char*)bytes;
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) |
+           ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static inline uint64_t LOAD_U64(const char* bytes)
+{
+    return (uint64_t)LOAD_U32(bytes) | ((uint64_t)LOAD_U32(bytes + 4) << 32);
+}
+
+/**
+ * @brief Hand the pending chunk to the writer.
+ *
+ * @param enc           The pointer to the encoder
+ *
+ * @retval true         The chunk is written
+ * @retval false        The writer fails
+ */
+bool _CdsSnapshotFlush(SnapshotEncoder* enc);
+
+/**
+ * @brief Make room for the next field in the pending chunk.
+ *
+ * The pending chunk is flushed first if the field does not fit, and the chunk
+ * buffer is extended for the field larger than the whole buffer.
+ *
+ * @param enc           The pointer to the encoder
+ * @param size          The field size
+ *
+ * @retval bytes        The pointer to the field bytes
+ * @retval NULL         Insufficient memory or the writer fails
+ */
+char* _CdsSnapshotReserve(SnapshotEncoder* enc, size_t size);
+
+/**
+ * @brief Seal the field written after the pending chunk, and flush the chunk
+ * if it is full.
+ *
+ * @param enc           The pointer to the encoder
+ * @param size          The field size
+ *
+ * @retval true         The field is sealed
+ * @retval false        The writer fails
+ */
+bool _CdsSnapshotCommit(SnapshotEncoder* enc, size_t size);
+
+/**
+ * @brief Read the next chunk into the decoder.
+ *
+ * @param dec           The pointer to the decoder
+ *
+ * @retval true         The chunk is loaded
+ * @retval false        Insufficient memory, the reader fails, or the snapshot
+ *                      ends
+ */
+bool _CdsRestoreLoad(SnapshotDecoder* dec);
+
+#if defined(CDS_DISPATCH_AVX2)
+/**
+ * @brief Scan the byte array with 32 byte compares, and leave the tail to the
+ * baseline blocks.
+ *
+ * @param bytes         The byte array
+ * @param count         The number of bytes to search
+ * @param ch            The designated byte
+ *
+ * @retval idx          The index of the first matched byte
+ * @retval -1           No such byte
+ */
+__attribute__((target("avx2")))
+int _CdsFindByteAvx2(const char* bytes, unsigned count, char ch);
+#endif
+
+
+/*===========================================================================*
+ *                        The global allocator                               *
+ *===========================================================================*/
+static Allocator global_alloc = {_CdsAlloc, _CdsFree, NULL};
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+void CdsSetAllocator(const Allocator* alloc)
+{
+    if (!alloc) {
+        global_alloc.alloc = _CdsAlloc;
+        global_alloc.free = _CdsFree;
+        global_alloc.ctx = NULL;
+        return;
+    }
+    global_alloc = *alloc;
+}
+
+const Allocator* CdsGetAllocator()
+{
+    return &global_alloc;
+}
+
+int CdsFindByte(const char* bytes, unsigned count, char ch)
+{
+#if defined(CDS_DISPATCH_AVX2)
+    if (count > CDS_BYTE_BLOCK && __builtin_cpu_supports("avx2"))
+        return _CdsFindByteAvx2(bytes, count, ch);
+#endif
+    return _CdsFindByteBlock(bytes, 0, count, ch);
+}
+
+
+bool CdsCheckGrowth(const GrowthPolicy* policy)
+{
+    if (unlikely(policy->ratio_grow <= 100 || policy->min_capacity == 0))
+        return false;
+
+    uint64_t product = (uint64_t)policy->ratio_shrink * policy->ratio_grow;
+    return product < 10000;
+}
+
+unsigned CdsGrowCapacity(const GrowthPolicy* policy, unsigned capacity,
+                         unsigned count)
+{
+    uint64_t grown = (uint64_t)capacity * policy->ratio_grow / 100;
+    if (grown <= capacity)
+        grown = (uint64_t)capacity + 1;
+    if (grown < count)
+        grown = count;
+    return (grown > UINT_MAX)? UINT_MAX : (unsigned)grown;
+}
+
+unsigned CdsShrinkCapacity(const GrowthPolicy* policy, unsigned capacity,
+                           unsigned size)
+{
+    unsigned ratio_shrink = policy->ratio_shrink;
+    if (likely(ratio_shrink == 0))
+        return capacity;
+    if ((uint64_t)size * 100 >= (uint64_t)capacity * ratio_shrink)
+        return capacity;
+
+    /* Leave the headroom of one growth step, so that the shrunk array does not
+       need to grow back right away. */
+    uint64_t shrunk = ((uint64_t)size * policy->ratio_grow + 99) / 100;
+    if (shrunk < policy->min_capacity)
+        shrunk = policy->min_capacity;
+    return (shrunk < capacity)? (unsigned)shrunk : capacity;
+}
+
+void CdsParallelRun(unsigned num_chunk, unsigned num_thread, CdsChunkTask func,
+                    void* ctx, const Reducer* reducer, void* acc)
+{
+    if (num_thread > num_chunk)
+        num_thread = num_chunk;
+
+    /* Prepare a copy of the initial result for each chunk. */
+    char* partials = NULL;
+    size_t size_acc = (reducer)? reducer->size : 0;
+    if (num_thread > 1 && reducer) {
+        partials = (char*)malloc(size_acc * num_chunk + 1);
+        if (unlikely(!partials))
+            num_thread = 1;
+    }
+
+    unsigned i;
+    if (num_thread <= 1) {
+        for (i = 0 ; i < num_chunk ; ++i)
+            func(ctx, i, (reducer)? acc : NULL);
+        return;
+    }
+
+    if (partials) {
+        for (i = 0 ; i < num_chunk ; ++i)
+            memcpy(partials + size_acc * i, acc, size_acc);
+    }
+
+    ParallelJob job;
+    job.func_ = func;
+    job.ctx_ = ctx;
+    job.partials_ = partials;
+    job.size_acc_ = size_acc;
+    job.num_chunk_ = num_chunk;
+    job.next_ = 0;
+
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * (num_thread - 1));
+    unsigned num_forked = 0;
+    if (likely(threads)) {
+        while (num_forked + 1 < num_thread) {
+            if (pthread_create(threads + num_forked, NULL,
+                               _CdsParallelWork, &job) != 0)
+                break;
+            ++num_forked;
+        }
+    }
+
+    _CdsParallelWork(&job);
+    for (i = 0 ; i < num_forked ; ++i)
+        pthread_join(threads[i], NULL);
+    free(threads);
+
+    if (partials) {
+        for (i = 0 ; i < num_chunk ; ++i)
+            reducer->combine(acc, partials + size_acc * i, reducer->ctx);
+        free(partials);
+    }
+    return;
+}
+
+unsigned CdsParallelChunks(unsigned num_item, unsigned num_thread)
+{
+    if (num_thread <= 1)
+        return 1;
+
+    unsigned num_chunk = num_item / SIZE_MIN_CHUNK;
+    unsigned limit = (num_thread > UINT_MAX / CHUNK_PER_THREAD)?
+                     UINT_MAX : num_thread * CHUNK_PER_THREAD;
+    if (num_chunk > limit)
+        num_chunk = limit;
+    return (num_chunk > 0)? num_chunk : 1;
+}
+
+bool CdsSnapshotBegin(SnapshotEncoder* enc, const SnapshotWriter* writer,
+                      unsigned kind, unsigned count)
+{
+    enc->writer_ = *writer;
+    enc->size_ = 0;
+    enc->capacity_ = SNAPSHOT_SIZE_PREFIX * 2 + CDS_SNAPSHOT_CHUNK;
+    enc->chunk_ = (char*)malloc(enc->capacity_);
+    if (unlikely(!enc->chunk_))
+        return false;
+
+    char header[SNAPSHOT_SIZE_HEADER];
+    STORE_U32(header, snapshot_magic);
+    STORE_U32(header + 4, (uint32_t)(snapshot_version | (kind << 16)));
+    STORE_U32(header + 8, count);
+    if (unlikely(!writer->write(writer->ctx, header, SNAPSHOT_SIZE_HEADER))) {
+        free(enc->chunk_);
+        enc->chunk_ = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool CdsSnapshotAppend(SnapshotEncoder* enc, const void* bytes, size_t size)
+{
+    char* field = _CdsSnapshotReserve(enc, size);
+    if (unlikely(!field))
+        return false;
+    memcpy(field, bytes, size);
+    return _CdsSnapshotCommit(enc, size);
+}
+
+bool CdsSnapshotEncode(SnapshotEncoder* enc, const SnapshotCodec* codec,
+                       void* item)
+{
+    if (!codec) {
+        char* field = _CdsSnapshotReserve(enc, sizeof(uint64_t));
+        if (unlikely(!field))
+            return false;
+        STORE_U64(field, (uint64_t)(uintptr_t)item);
+        return _CdsSnapshotCommit(enc, sizeof(uint64_t));
+    }
+
+    /* Try the room left in the pending chunk first, which fits most items. */
+    size_t used = SNAPSHOT_SIZE_PREFIX * 2 + enc->size_;
+    char* field = enc->chunk_ + used;
+    size_t room = enc->capacity_ - used;
+    size_t size = codec->encode(codec->ctx, item, field, room);
+    if (size > room) {
+        field = _CdsSnapshotReserve(enc, size);
+        if (unlikely(!field))
+            return false;
+        if (unlikely(codec->encode(codec->ctx, item, field, size) != size))
+            return false;
+    }
+    return _CdsSnapshotCommit(enc, size);
+}
+
+bool CdsSnapshotEnd(SnapshotEncoder* enc, bool commit)
+{
+    /* The empty chunk written by the last flush marks the end. */
+    bool done = false;
+    if (commit && enc->chunk_) {
+        done = (enc->size_ == 0 || _CdsSnapshotFlush(enc)) &&
+               _CdsSnapshotFlush(enc);
+    }
+    free(enc->chunk_);
+    enc->chunk_ = NULL;
+    return done;
+}
+
+bool CdsRestoreBegin(SnapshotDecoder* dec, const SnapshotReader* reader,
+                     unsigned kind, unsigned* p_count)
+{
+    dec->reader_ = *reader;
+    dec->chunk_ = NULL;
+    dec->size_ = 0;
+    dec->capacity_ = 0;
+    dec->offset_ = 0;
+
+    char header[SNAPSHOT_SIZE_HEADER];
+    if (unlikely(!reader->read(reader->ctx, header, SNAPSHOT_SIZE_HEADER)))
+        return false;
+    if (LOAD_U32(header) != snapshot_magic)
+        return false;
+    if (LOAD_U32(header + 4) != (uint32_t)(snapshot_version | (kind << 16)))
+        return false;
+    *p_count = LOAD_U32(header + 8);
+    return true;
+}
+
+bool CdsRestoreField(SnapshotDecoder* dec, const void** p_bytes,
+                     size_t* p_size)
+{
+    if (dec->offset_ == dec->size_) {
+        if (unlikely(!_CdsRestoreLoad(dec)))
+            return false;
+    }
+
+    size_t remain = dec->size_ - dec->offset_;
+    if (unlikely(remain < SNAPSHOT_SIZE_PREFIX))
+        return false;
+    const char* field = dec->chunk_ + dec->offset_;
+    size_t size = LOAD_U32(field);
+    if (unlikely(size > remain - SNAPSHOT_SIZE_PREFIX))
+        return false;
+
+    *p_bytes = field + SNAPSHOT_SIZE_PREFIX;
+    *p_size = size;
+    dec->offset_ += SNAPSHOT_SIZE_PREFIX + size;
+    return true;
+}
+
+bool CdsRestoreDecode(SnapshotDecoder* dec, const SnapshotCodec* codec,
+                      void** p_item)
+{
+    const void* bytes;
+    size_t size;
+    if (unlikely(!CdsRestoreField(dec, &bytes, &size)))
+        return false;
+
+    if (!codec) {
+        if (unlikely(size != sizeof(uint64_t)))
+            return false;
+        *p_item = (void*)(uintptr_t)LOAD_U64((const char*)bytes);
+        return true;
+    }
+    return codec->decode(codec->ctx, bytes, size, p_item);
+}
+
+bool CdsRestoreEnd(SnapshotDecoder* dec, bool commit)
+{
+    bool done = false;
+    if (commit && dec->offset_ == dec->size_) {
+        char prefix[SNAPSHOT_SIZE_PREFIX];
+        done = dec->reader_.read(dec->reader_.ctx, prefix, SNAPSHOT_SIZE_PREFIX)
+               && LOAD_U32(prefix) == 0;
+    }
+    free(dec->chunk_);
+    dec->chunk_ = NULL;
+    return done;
+}
+
+bool CdsWriteFile(void* file, const void* bytes, size_t size)
+{
+    return fwrite(bytes, 1, size, (FILE*)file) == size;
+}
+
+bool CdsReadFile(void* file, void* buf, size_t size)
+{
+    return fread(buf, 1, size, (FILE*)file) == size;
+}
+
+bool CdsReadMemory(void* memory, void* buf, size_t size)
+{
+    SnapshotMemory* region = (SnapshotMemory*)memory;
+    if (unlikely(size > region->size - region->offset))
+        return false;
+    memcpy(buf, (const char*)region->base + region->offset, size);
+    region->offset += size;
+    return true;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+void* _CdsAlloc(void* ctx, size_t size)
+{
+    return malloc(size);
+}
+
+void _CdsFree(void* ctx, void* ptr)
+{
+    free(ptr);
+}
+
+void* _CdsParallelWork(void* arg)
+{
+    ParallelJob* job = (ParallelJob*)arg;
+    while (true) {
+        unsigned chunk = __atomic_fetch_add(&(job->next_), 1, __ATOMIC_RELAXED);
+        if (chunk >= job->num_chunk_)
+            break;
+        void* partial = (job->partials_)?
+                        job->partials_ + job->size_acc_ * chunk : NULL;
+        job->func_(job->ctx_, chunk, partial);
+    }
+    return NULL;
+}
+
+bool _CdsSnapshotFlush(SnapshotEncoder* enc)
+{
+    STORE_U32(enc->chunk_, (uint32_t)enc->size_);
+    size_t size = SNAPSHOT_SIZE_PREFIX + enc->size_;
+    enc->size_ = 0;
+    return enc->writer_.write(enc->writer_.ctx, enc->chunk_, size);
+}
+
+char* _CdsSnapshotReserve(SnapshotEncoder* enc, size_t size)
+{
+    if (unlikely(size > UINT32_MAX - CDS_SNAPSHOT_CHUNK))
+        return NULL;
+
+    size_t need = SNAPSHOT_SIZE_PREFIX * 2 + enc->size_ + size;
+    if (need > enc->capacity_ && enc->size_ > 0) {
+        if (unlikely(!_CdsSnapshotFlush(enc)))
+            return NULL;
+        need = SNAPSHOT_SIZE_PREFIX * 2 + size;
+    }
+    if (need > enc->capacity_) {
+        char* chunk = (char*)realloc(enc->chunk_, need);
+        if (unlikely(!chunk))
+            return NULL;
+        enc->chunk_ = chunk;
+        enc->capacity_ = need;
+    }
+    return enc->chunk_ + SNAPSHOT_SIZE_PREFIX * 2 + enc->size_;
+}
+
+bool _CdsSnapshotCommit(SnapshotEncoder* enc, size_t size)
+{
+    STORE_U32(enc->chunk_ + SNAPSHOT_SIZE_PREFIX + enc->size_, (uint32_t)size);
+    enc->size_ += SNAPSHOT_SIZE_PREFIX + size;
+    if (enc->size_ >= CDS_SNAPSHOT_CHUNK)
+        return _CdsSnapshotFlush(enc);
+    return true;
+}
+
+bool _CdsRestoreLoad(SnapshotDecoder* dec)
+{
+    char prefix[SNAPSHOT_SIZE_PREFIX];
+    if (unlikely(!dec->reader_.read(dec->reader_.ctx, prefix,
+                                    SNAPSHOT_SIZE_PREFIX)))
+        return false;
+    size_t size = LOAD_U32(prefix);
+    if (unlikely(size == 0))
+        return false;
+
+    if (size > dec->capacity_) {
+        char* chunk = (char*)realloc(dec->chunk_, size);
+        if (unlikely(!chunk))
+            return false;
+        dec->chunk_ = chunk;
+        dec->capacity_ = size;
+    }
+    if (unlikely(!dec->reader_.read(dec->reader_.ctx, dec->chunk_, size)))
+        return false;
+    dec->size_ = size;
+    dec->offset_ = 0;
+    return true;
+}
+
+int _CdsFindByteBlock(const char* bytes, unsigned base, unsigned count,
+                      char ch)
+{
+    /* The bytes beyond the count in the last block are masked out. */
+    for ( ; base < count ; base += CDS_BYTE_BLOCK) {
+        unsigned mask = MATCH_BLOCK(bytes + base, ch);
+        unsigned remain = count - base;
+        if (remain < CDS_BYTE_BLOCK)
+            mask &= (1u << remain) - 1;
+        if (mask)
+            return base + __builtin_ctz(mask);
+    }
+    return -1;
+}
+
+#if defined(CDS_DISPATCH_AVX2)
+__attribute__((target("avx2")))
+int _CdsFindByteAvx2(const char* bytes, unsigned count, char ch)
+{
+    __m256i key = _mm256_set1_epi8(ch);
+    unsigned base = 0;
+    for ( ; base + 2 * CDS_BYTE_BLOCK <= count ; base += 2 * CDS_BYTE_BLOCK) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(bytes + base));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+                            _mm256_cmpeq_epi8(block, key));
+        if (mask)
+            return base + __builtin_ctz(mask);
+    }
+    return _CdsFindByteBlock(bytes, base, count, ch);
+}
+#endif
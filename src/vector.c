@@ -22,6 +22,7 @@
  */
 
 #include "container/vector.h"
+#include <pthread.h>
 
 
 /*===========================================================================*
@@ -33,8 +34,42 @@ struct _VectorData {
     unsigned iter_;
     void** elements_;
     VectorClean func_clean_;
+    GrowthPolicy growth_;
 };
 
+/* The sort subproblem forked to a worker thread. */
+typedef struct _SortTask {
+    void** elements_;
+    void** buffer_;
+    unsigned size_;
+    unsigned depth_fork_;
+    VectorCompare func_;
+} SortTask;
+
+/* The element tagged with its radix sort key. */
+typedef struct _KeyedElement {
+    uint64_t key_;
+    void* element_;
+} KeyedElement;
+
+/* The parallel traversal whose index ranges are claimed by the workers. */
+typedef struct _TraverseTask {
+    VectorData* data_;
+    VectorVisit func_visit_;
+    void* arg_;
+    const Reducer* reducer_;
+    unsigned num_chunk_;
+} TraverseTask;
+
+/* The ranges shorter than this are never forked, since the thread creation
+   would cost more than the sort itself. */
+static const unsigned SIZE_SORT_FORK = 8192;
+
+/* The number of bits distributed by each radix sort pass. */
+static const unsigned BIT_RADIX = 8;
+#define SIZE_RADIX      (256)
+#define NUM_RADIX_PASS  (8)
+
 
 /*===========================================================================*
  *                  Definition for internal operations                       *
@@ -59,6 +94,57 @@ struct _VectorData {
  */
 bool _VectorReisze(VectorData* data, unsigned capacity);
 
+/**
+ * @brief Extend the internal array by the growth policy so that it can contain
+ *        the specified number of elements.
+ *
+ * @param data          The pointer to the vector private data
+ * @param count         The number of elements which should fit
+ *
+ * @retval true         The array is successfully extended or already enough
+ * @retval false        Insufficient memory
+ */
+bool _VectorGrow(VectorData* data, unsigned count);
+
+/**
+ * @brief Shrink the internal array if the load drops below the shrink ratio
+ *        of the growth policy.
+ *
+ * @param data          The pointer to the vector private data
+ */
+void _VectorShrink(VectorData* data);
+
+/**
+ * @brief Sort the designated element range and fork the first half to a worker
+ * thread if the thread budget allows.
+ *
+ * @param elements      The pointer to the first element of the range
+ * @param buffer        The scratch array with the same size as the range
+ * @param size          The number of elements in the range
+ * @param depth_fork    The number of recursion levels allowed to fork
+ * @param func          The element comparison function
+ */
+void _VectorSortRange(void** elements, void** buffer, unsigned size,
+                      unsigned depth_fork, VectorCompare func);
+
+/**
+ * @brief The thread entry which sorts a forked element range.
+ *
+ * @param arg           The pointer to the SortTask structure
+ *
+ * @retval NULL         The thread finishes
+ */
+void* _VectorSortTask(void* arg);
+
+/**
+ * @brief Visit or accumulate the elements of the designated index range.
+ *
+ * @param arg           The pointer to the traversal task
+ * @param chunk         The index of the index range
+ * @param acc           The partial result or NULL for the visit
+ */
+void _VectorTraverseChunk(void* arg, unsigned chunk, void* acc);
+
 
 /*===========================================================================*
  *               Implementation for the exported operations                  *
@@ -87,16 +173,26 @@ Vector* VectorInit(unsigned capacity)
     data->elements_ = elements;
     data->func_clean_ = NULL;
 
+    GrowthPolicy growth = CDS_GROWTH_DEFAULT;
+    data->growth_ = growth;
+
     obj->data = data;
     obj->push_back = VectorPushBack;
     obj->insert = VectorInsert;
+    obj->insert_range = VectorInsertRange;
+    obj->append_array = VectorAppendArray;
+    obj->extend = VectorExtend;
     obj->pop_back = VectorPopBack;
     obj->remove = VectorRemove;
+    obj->erase_range = VectorEraseRange;
     obj->set = VectorSet;
     obj->get = VectorGet;
     obj->resize = VectorResize;
     obj->size = VectorSize;
     obj->capacity = VectorCapacity;
+    obj->reserve = VectorReserve;
+    obj->shrink_to_fit = VectorShrinkToFit;
+    obj->set_growth = VectorSetGrowth;
     obj->sort = VectorSort;
     obj->first = VectorFirst;
     obj->next = VectorNext;
@@ -134,9 +230,11 @@ bool VectorPushBack(Vector* self, void* element)
     unsigned size = data->size_;
     unsigned capacity = data->capacity_;
 
-    /* If the internal array is full, extend it to double capacity. */
+    /* If the internal array is full, extend it by the growth policy. */
     if (size == capacity) {
-        bool rtn = _VectorReisze(data, capacity << 1);
+        if (unlikely(size == UINT_MAX))
+            return false;
+        bool rtn = _VectorGrow(data, size + 1);
         if (rtn == false)
             return false;
     }
@@ -155,9 +253,11 @@ bool VectorInsert(Vector* self, unsigned idx, void* element)
     if (unlikely(idx > size))
         return false;
 
-    /* If the internal array is full, extend it to double capacity. */
+    /* If the internal array is full, extend it by the growth policy. */
     if (size == capacity) {
-        bool rtn = _VectorReisze(data, capacity << 1);
+        if (unlikely(size == UINT_MAX))
+            return false;
+        bool rtn = _VectorGrow(data, size + 1);
         if (rtn == false)
             return false;
     }
@@ -173,6 +273,54 @@ bool VectorInsert(Vector* self, unsigned idx, void* element)
     return true;
 }
 
+bool VectorInsertRange(Vector* self, unsigned idx, void** elements,
+                       unsigned count)
+{
+    VectorData* data = self->data;
+    unsigned size = data->size_;
+    if (unlikely(idx > size))
+        return false;
+    if (unlikely(count > UINT_MAX - size))
+        return false;
+    if (unlikely(count == 0))
+        return true;
+
+    /* Reallocate at most once for the whole range. */
+    if (unlikely(!_VectorGrow(data, size + count)))
+        return false;
+
+    /* Shift the trailing elements once for the whole range. */
+    void** dst = data->elements_;
+    unsigned num_shift = size - idx;
+    if (num_shift > 0)
+        memmove(dst + idx + count, dst + idx, sizeof(void*) * num_shift);
+
+    memcpy(dst + idx, elements, sizeof(void*) * count);
+    data->size_ = size + count;
+    return true;
+}
+
+bool VectorAppendArray(Vector* self, void** elements, unsigned count)
+{
+    return VectorInsertRange(self, self->data->size_, elements, count);
+}
+
+bool VectorExtend(Vector* self, Vector* other)
+{
+    if (unlikely(self == other))
+        return false;
+
+    VectorData* src = other->data;
+    if (unlikely(!VectorInsertRange(self, self->data->size_, src->elements_,
+                                    src->size_)))
+        return false;
+
+    /* The moved elements are now owned by the designated vector. */
+    src->size_ = 0;
+    _VectorShrink(src);
+    return true;
+}
+
 bool VectorPopBack(Vector* self)
 {
     VectorData* data = self->data;
@@ -187,6 +335,7 @@ bool VectorPopBack(Vector* self)
     if (func_clean)
         func_clean(element);
 
+    _VectorShrink(data);
     return true;
 }
 
@@ -208,6 +357,34 @@ bool VectorRemove(Vector* self, unsigned idx)
         memmove(elements + idx, elements + idx + 1, sizeof(void*) * num_shift);
 
     data->size_ = size - 1;
+    _VectorShrink(data);
+    return true;
+}
+
+bool VectorEraseRange(Vector* self, unsigned idx, unsigned count)
+{
+    VectorData* data = self->data;
+    unsigned size = data->size_;
+    if (unlikely(idx > size || count > size - idx))
+        return false;
+    if (unlikely(count == 0))
+        return true;
+
+    void** elements = data->elements_;
+    VectorClean func_clean = data->func_clean_;
+    if (func_clean) {
+        unsigned i;
+        for (i = idx ; i < idx + count ; ++i)
+            func_clean(elements[i]);
+    }
+
+    /* Shift the trailing elements once for the whole range. */
+    unsigned num_shift = size - idx - count;
+    if (num_shift > 0)
+        memmove(elements + idx, elements + idx + count, sizeof(void*) * num_shift);
+
+    data->size_ = size - count;
+    _VectorShrink(data);
     return true;
 }
 
@@ -250,12 +427,146 @@ unsigned VectorCapacity(Vector* self)
     return self->data->capacity_;
 }
 
+bool VectorReserve(Vector* self, unsigned capacity)
+{
+    VectorData* data = self->data;
+    if (capacity <= data->capacity_)
+        return true;
+
+    return _VectorReisze(data, capacity);
+}
+
+bool VectorShrinkToFit(Vector* self)
+{
+    VectorData* data = self->data;
+    unsigned size = data->size_;
+    return _VectorReisze(data, (size > 0)? size : 1);
+}
+
+bool VectorSetGrowth(Vector* self, const GrowthPolicy* policy)
+{
+    if (unlikely(!CdsCheckGrowth(policy)))
+        return false;
+
+    self->data->growth_ = *policy;
+    return true;
+}
+
 void VectorSort(Vector* self, VectorCompare func)
 {
     VectorData* data = self->data;
     qsort(data->elements_, data->size_, sizeof(void*), func);
 }
 
+bool VectorSortParallel(Vector* self, VectorCompare func, unsigned num_thread)
+{
+    VectorData* data = self->data;
+    unsigned size = data->size_;
+
+    unsigned depth_fork = 0;
+    while (num_thread >>= 1)
+        ++depth_fork;
+    if (depth_fork == 0 || size < SIZE_SORT_FORK) {
+        qsort(data->elements_, size, sizeof(void*), func);
+        return true;
+    }
+
+    void** buffer = (void**)malloc(sizeof(void*) * size);
+    if (unlikely(!buffer))
+        return false;
+
+    _VectorSortRange(data->elements_, buffer, size, depth_fork, func);
+    free(buffer);
+    return true;
+}
+
+bool VectorSortRadix(Vector* self, VectorKey func)
+{
+    VectorData* data = self->data;
+    unsigned size = data->size_;
+    if (size < 2)
+        return true;
+
+    KeyedElement* src = (KeyedElement*)malloc(sizeof(KeyedElement) * size * 2);
+    if (unlikely(!src))
+        return false;
+    KeyedElement* dst = src + size;
+    KeyedElement* keyed = src;
+
+    /* Extract the keys and count all the radix digits in a single scan. The
+       bits differing from the first key tell the passes worth distributing. */
+    unsigned counts[NUM_RADIX_PASS][SIZE_RADIX];
+    memset(counts, 0, sizeof(counts));
+
+    void** elements = data->elements_;
+    uint64_t first = func(elements[0]);
+    uint64_t diff = 0;
+    unsigned i, pass;
+    for (i = 0 ; i < size ; ++i) {
+        uint64_t key = func(elements[i]);
+        src[i].key_ = key;
+        src[i].element_ = elements[i];
+        diff |= key ^ first;
+        for (pass = 0 ; pass < NUM_RADIX_PASS ; ++pass)
+            ++counts[pass][(key >> (pass * BIT_RADIX)) & (SIZE_RADIX - 1)];
+    }
+
+    for (pass = 0 ; pass < NUM_RADIX_PASS ; ++pass) {
+        unsigned shift = pass * BIT_RADIX;
+        if (((diff >> shift) & (SIZE_RADIX - 1)) == 0)
+            continue;
+
+        unsigned* offsets = counts[pass];
+        unsigned sum = 0;
+        unsigned digit;
+        for (digit = 0 ; digit < SIZE_RADIX ; ++digit) {
+            unsigned count = offsets[digit];
+            offsets[digit] = sum;
+            sum += count;
+        }
+
+        for (i = 0 ; i < size ; ++i)
+            dst[offsets[(src[i].key_ >> shift) & (SIZE_RADIX - 1)]++] = src[i];
+
+        KeyedElement* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    for (i = 0 ; i < size ; ++i)
+        elements[i] = src[i].element_;
+    free(keyed);
+    return true;
+}
+
+void VectorForEachParallel(Vector* self, VectorVisit func, void* arg,
+                           unsigned num_thread)
+{
+    VectorData* data = self->data;
+    TraverseTask task;
+    task.data_ = data;
+    task.func_visit_ = func;
+    task.arg_ = arg;
+    task.reducer_ = NULL;
+    task.num_chunk_ = CdsParallelChunks(data->size_, num_thread);
+    CdsParallelRun(task.num_chunk_, num_thread, _VectorTraverseChunk, &task,
+                   NULL, NULL);
+}
+
+void VectorReduceParallel(Vector* self, const Reducer* reducer, void* acc,
+                          unsigned num_thread)
+{
+    VectorData* data = self->data;
+    TraverseTask task;
+    task.data_ = data;
+    task.func_visit_ = NULL;
+    task.arg_ = NULL;
+    task.reducer_ = reducer;
+    task.num_chunk_ = CdsParallelChunks(data->size_, num_thread);
+    CdsParallelRun(task.num_chunk_, num_thread, _VectorTraverseChunk, &task,
+                   reducer, acc);
+}
+
 void VectorFirst(Vector* self, bool is_reverse)
 {
     self->data->iter_ = (is_reverse == false)? 0 : (self->data->size_ - 1);
@@ -285,11 +596,82 @@ bool VectorReverseNext(Vector* self, void** p_element)
     return true;
 }
 
+void VectorIterInit(Vector* self, VectorIter* iter, bool is_reverse)
+{
+    iter->data_ = self->data;
+    iter->is_reverse_ = is_reverse;
+    iter->idx_ = (is_reverse == false)? 0 : self->data->size_;
+}
+
+bool VectorIterNext(VectorIter* iter, void** p_element)
+{
+    VectorData* data = iter->data_;
+    unsigned idx = iter->idx_;
+
+    /* In reversed traversal, the cursor points to the successor of the next
+       element. */
+    if (iter->is_reverse_) {
+        if (unlikely(idx == 0))
+            return false;
+        --idx;
+        *p_element = data->elements_[idx];
+        iter->idx_ = idx;
+        return true;
+    }
+
+    if (unlikely(idx >= data->size_))
+        return false;
+    *p_element = data->elements_[idx];
+    iter->idx_ = idx + 1;
+    return true;
+}
+
 void VectorSetClean(Vector* self, VectorClean func)
 {
     self->data->func_clean_ = func;
 }
 
+bool VectorSnapshot(Vector* self, const SnapshotWriter* writer,
+                    const SnapshotCodec* codec)
+{
+    VectorData* data = self->data;
+    SnapshotEncoder enc;
+    if (unlikely(!CdsSnapshotBegin(&enc, writer, CDS_SNAPSHOT_VECTOR,
+                                   data->size_)))
+        return false;
+
+    unsigned i;
+    for (i = 0 ; i < data->size_ ; ++i) {
+        if (unlikely(!CdsSnapshotEncode(&enc, codec, data->elements_[i])))
+            return CdsSnapshotEnd(&enc, false);
+    }
+    return CdsSnapshotEnd(&enc, true);
+}
+
+bool VectorRestore(Vector* self, const SnapshotReader* reader,
+                   const SnapshotCodec* codec)
+{
+    VectorData* data = self->data;
+    SnapshotDecoder dec;
+    unsigned count;
+    if (unlikely(!CdsRestoreBegin(&dec, reader, CDS_SNAPSHOT_VECTOR, &count)))
+        return CdsRestoreEnd(&dec, false);
+
+    /* Extend the array once, and decode the elements right into it. */
+    if (unlikely(count > UINT_MAX - data->size_ ||
+                 !VectorReserve(self, data->size_ + count)))
+        return CdsRestoreEnd(&dec, false);
+
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        if (unlikely(!CdsRestoreDecode(&dec, codec,
+                                       data->elements_ + data->size_)))
+            break;
+        ++(data->size_);
+    }
+    return CdsRestoreEnd(&dec, i == count);
+}
+
 /*===========================================================================*
  *               Implementation for internal operations                      *
  *===========================================================================*/
@@ -311,10 +693,13 @@ bool _VectorReisze(VectorData* data, unsigned capacity)
         data->size_ = capacity;
     }
 
-    if (unlikely(capacity == old_size))
+    if (unlikely(capacity == data->capacity_))
         return true;
 
-    void** new_elements = (void**)realloc(elements, sizeof(void*) * capacity);
+    /* Keep a slot for the empty array, since realloc may release the block for
+       the zero size request. */
+    size_t size_alloc = sizeof(void*) * ((capacity > 0)? capacity : 1);
+    void** new_elements = (void**)realloc(elements, size_alloc);
     if (new_elements) {
         data->elements_  = new_elements;
         data->capacity_ = capacity;
@@ -322,3 +707,98 @@ bool _VectorReisze(VectorData* data, unsigned capacity)
 
     return (new_elements)? true : false;
 }
+
+bool _VectorGrow(VectorData* data, unsigned count)
+{
+    unsigned capacity = data->capacity_;
+    if (count <= capacity)
+        return true;
+
+    return _VectorReisze(data, CdsGrowCapacity(&(data->growth_), capacity, count));
+}
+
+void _VectorShrink(VectorData* data)
+{
+    unsigned capacity = data->capacity_;
+    unsigned shrunk = CdsShrinkCapacity(&(data->growth_), capacity, data->size_);
+
+    /* The array is still valid if the reallocation fails. */
+    if (unlikely(shrunk < capacity))
+        _VectorReisze(data, shrunk);
+}
+
+void _VectorSortRange(void** elements, void** buffer, unsigned size,
+                      unsigned depth_fork, VectorCompare func)
+{
+    if (depth_fork == 0 || size < SIZE_SORT_FORK) {
+        qsort(elements, size, sizeof(void*), func);
+        return;
+    }
+
+    /* Sort the two halves independently, and fork the first one. */
+    unsigned half = size >> 1;
+    pthread_t thread;
+    SortTask task;
+    task.elements_ = elements;
+    task.buffer_ = buffer;
+    task.size_ = half;
+    task.depth_fork_ = depth_fork - 1;
+    task.func_ = func;
+    bool forked = pthread_create(&thread, NULL, _VectorSortTask, &task) == 0;
+
+    if (!forked)
+        _VectorSortRange(elements, buffer, half, depth_fork - 1, func);
+    _VectorSortRange(elements + half, buffer + half, size - half,
+                     depth_fork - 1, func);
+    if (forked)
+        pthread_join(thread, NULL);
+
+    /* Merge the halves into the scratch array. Once the first half runs out,
+       the rest of the second half is already in place. */
+    void** lhs = elements;
+    void** lhs_end = elements + half;
+    void** rhs = lhs_end;
+    void** rhs_end = elements + size;
+    if (func(rhs, lhs_end - 1) >= 0)
+        return;
+
+    void** dst = buffer;
+    while (lhs < lhs_end && rhs < rhs_end) {
+        if (func(rhs, lhs) < 0)
+            *dst++ = *rhs++;
+        else
+            *dst++ = *lhs++;
+    }
+    while (lhs < lhs_end)
+        *dst++ = *lhs++;
+
+    memcpy(elements, buffer, sizeof(void*) * (dst - buffer));
+}
+
+void* _VectorSortTask(void* arg)
+{
+    SortTask* task = (SortTask*)arg;
+    _VectorSortRange(task->elements_, task->buffer_, task->size_,
+                     task->depth_fork_, task->func_);
+    return NULL;
+}
+
+void _VectorTraverseChunk(void* arg, unsigned chunk, void* acc)
+{
+    TraverseTask* task = (TraverseTask*)arg;
+    uint64_t size = task->data_->size_;
+    unsigned begin = (unsigned)(size * chunk / task->num_chunk_);
+    unsigned end = (unsigned)(size * (chunk + 1) / task->num_chunk_);
+    void** elements = task->data_->elements_;
+
+    const Reducer* reducer = task->reducer_;
+    unsigned i;
+    if (reducer) {
+        for (i = begin ; i < end ; ++i)
+            reducer->accumulate(acc, elements[i], reducer->ctx);
+    } else {
+        for (i = begin ; i < end ; ++i)
+            task->func_visit_(elements[i], task->arg_);
+    }
+    return;
+}
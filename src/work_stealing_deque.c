@@ -0,0 +1,295 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/work_stealing_deque.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const unsigned default_capacity = 64;
+static const unsigned max_capacity = 1u << 31;
+static const size_t size_cache_line = 64;
+
+
+/* The circular element array. The replaced arrays are chained for the
+   deferred release. */
+typedef struct _Array {
+    int64_t mask_;
+    struct _Array* prev_;
+    void* elements_[];
+} Array;
+
+/* The top index is contended by the thieves, and the bottom index is written
+   by the owner, so they occupy their own cache lines. */
+struct _WorkStealingDequeData {
+    int64_t top_ __attribute__((aligned(64)));
+    int64_t bottom_ __attribute__((aligned(64)));
+    Array* array_;
+    WorkStealingDequeClean func_clean_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * Read the element which may be concurrently accessed by the other threads.
+ */
+static inline void* GET_ELEMENT(Array* array, int64_t idx)
+{
+    return __atomic_load_n(&(array->elements_[idx & array->mask_]),
+                           __ATOMIC_RELAXED);
+}
+
+/**
+ * Write the element which may be concurrently accessed by the other threads.
+ */
+static inline void SET_ELEMENT(Array* array, int64_t idx, void* element)
+{
+    __atomic_store_n(&(array->elements_[idx & array->mask_]), element,
+                     __ATOMIC_RELAXED);
+}
+
+/**
+ * Allocate the circular array with the designated capacity.
+ */
+static inline Array* NEW_ARRAY(int64_t capacity, Array* prev)
+{
+    Array* array = (Array*)malloc(sizeof(Array) + sizeof(void*) * capacity);
+    if (unlikely(!array))
+        return NULL;
+    array->mask_ = capacity - 1;
+    array->prev_ = prev;
+    return array;
+}
+
+/**
+ * @brief Replace the full array with the one of double capacity.
+ *
+ * @param data          The pointer to the deque private data
+ * @param top           The top index
+ * @param bottom        The bottom index
+ *
+ * @retval array        The extended array
+ * @retval NULL         Insufficient memory or the maximum capacity is reached
+ */
+Array* _WorkStealingDequeGrow(WorkStealingDequeData* data, int64_t top,
+                              int64_t bottom);
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+WorkStealingDeque* WorkStealingDequeInit(unsigned capacity)
+{
+    WorkStealingDeque* obj =
+        (WorkStealingDeque*)malloc(sizeof(WorkStealingDeque));
+    if (unlikely(!obj))
+        return NULL;
+
+    WorkStealingDequeData* data;
+    if (unlikely(posix_memalign((void**)&data, size_cache_line,
+                                sizeof(WorkStealingDequeData)) != 0)) {
+        free(obj);
+        return NULL;
+    }
+
+    /* Round the capacity up to the power of two for mask indexing. */
+    if (capacity == 0)
+        capacity = default_capacity;
+    if (capacity > max_capacity)
+        capacity = max_capacity;
+    unsigned count = 1;
+    while (count < capacity)
+        count <<= 1;
+
+    data->array_ = NEW_ARRAY(count, NULL);
+    if (unlikely(!data->array_)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+
+    data->top_ = 0;
+    data->bottom_ = 0;
+    data->func_clean_ = NULL;
+
+    obj->data = data;
+    obj->push = WorkStealingDequePush;
+    obj->pop = WorkStealingDequePop;
+    obj->steal = WorkStealingDequeSteal;
+    obj->size = WorkStealingDequeSize;
+    obj->capacity = WorkStealingDequeCapacity;
+    obj->set_clean = WorkStealingDequeSetClean;
+
+    return obj;
+}
+
+void WorkStealingDequeDeinit(WorkStealingDeque* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    WorkStealingDequeData* data = obj->data;
+    Array* array = data->array_;
+    WorkStealingDequeClean func_clean = data->func_clean_;
+    if (func_clean) {
+        int64_t idx;
+        for (idx = data->top_ ; idx < data->bottom_ ; ++idx)
+            func_clean(array->elements_[idx & array->mask_]);
+    }
+
+    while (array) {
+        Array* prev = array->prev_;
+        free(array);
+        array = prev;
+    }
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool WorkStealingDequePush(WorkStealingDeque* self, void* element)
+{
+    WorkStealingDequeData* data = self->data;
+    int64_t bottom = __atomic_load_n(&(data->bottom_), __ATOMIC_RELAXED);
+    int64_t top = __atomic_load_n(&(data->top_), __ATOMIC_ACQUIRE);
+    Array* array = __atomic_load_n(&(data->array_), __ATOMIC_RELAXED);
+
+    if (unlikely(bottom - top > array->mask_)) {
+        array = _WorkStealingDequeGrow(data, top, bottom);
+        if (unlikely(!array))
+            return false;
+    }
+
+    /* Publish the element before the thieves can see the new bottom. */
+    SET_ELEMENT(array, bottom, element);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&(data->bottom_), bottom + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool WorkStealingDequePop(WorkStealingDeque* self, void** p_element)
+{
+    WorkStealingDequeData* data = self->data;
+    int64_t bottom = __atomic_load_n(&(data->bottom_), __ATOMIC_RELAXED) - 1;
+    Array* array = __atomic_load_n(&(data->array_), __ATOMIC_RELAXED);
+
+    /* Reserve the bottom element first, and then check the thieves. */
+    __atomic_store_n(&(data->bottom_), bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t top = __atomic_load_n(&(data->top_), __ATOMIC_RELAXED);
+
+    if (unlikely(top > bottom)) {
+        __atomic_store_n(&(data->bottom_), bottom + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    void* element = GET_ELEMENT(array, bottom);
+    if (top == bottom) {
+        /* Race with the thieves for the last element. */
+        bool won = __atomic_compare_exchange_n(&(data->top_), &top, top + 1,
+                                               false, __ATOMIC_SEQ_CST,
+                                               __ATOMIC_RELAXED);
+        __atomic_store_n(&(data->bottom_), bottom + 1, __ATOMIC_RELAXED);
+        if (!won)
+            return false;
+    }
+
+    *p_element = element;
+    return true;
+}
+
+bool WorkStealingDequeSteal(WorkStealingDeque* self, void** p_element)
+{
+    WorkStealingDequeData* data = self->data;
+
+    while (true) {
+        int64_t top = __atomic_load_n(&(data->top_), __ATOMIC_ACQUIRE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        int64_t bottom = __atomic_load_n(&(data->bottom_), __ATOMIC_ACQUIRE);
+        if (top >= bottom)
+            return false;
+
+        Array* array = __atomic_load_n(&(data->array_), __ATOMIC_ACQUIRE);
+        void* element = GET_ELEMENT(array, top);
+        if (__atomic_compare_exchange_n(&(data->top_), &top, top + 1, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            *p_element = element;
+            return true;
+        }
+    }
+}
+
+unsigned WorkStealingDequeSize(WorkStealingDeque* self)
+{
+    WorkStealingDequeData* data = self->data;
+    int64_t top = __atomic_load_n(&(data->top_), __ATOMIC_ACQUIRE);
+    int64_t bottom = __atomic_load_n(&(data->bottom_), __ATOMIC_ACQUIRE);
+
+    /* The owner may temporarily reserve the bottom element. */
+    return (bottom > top)? bottom - top : 0;
+}
+
+unsigned WorkStealingDequeCapacity(WorkStealingDeque* self)
+{
+    Array* array = __atomic_load_n(&(self->data->array_), __ATOMIC_ACQUIRE);
+    return array->mask_ + 1;
+}
+
+void WorkStealingDequeSetClean(WorkStealingDeque* self,
+                               WorkStealingDequeClean func)
+{
+    self->data->func_clean_ = func;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+Array* _WorkStealingDequeGrow(WorkStealingDequeData* data, int64_t top,
+                              int64_t bottom)
+{
+    Array* old_array = data->array_;
+    int64_t capacity = old_array->mask_ + 1;
+    if (unlikely(capacity >= max_capacity))
+        return NULL;
+
+    /* The elements keep their indexes, so the thieves holding the old array
+       still read the same elements. */
+    Array* new_array = NEW_ARRAY(capacity << 1, old_array);
+    if (unlikely(!new_array))
+        return NULL;
+
+    int64_t idx;
+    for (idx = top ; idx < bottom ; ++idx)
+        SET_ELEMENT(new_array, idx, GET_ELEMENT(old_array, idx));
+
+    __atomic_store_n(&(data->array_), new_array, __ATOMIC_RELEASE);
+    return new_array;
+}
@@ -0,0 +1,175 @@
+#include "container/bloom_filter.h"
+#include "math/hash.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_BIG_TEST = 65536;
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    BloomFilter* filter = BloomFilterInit(0, 0);
+    CU_ASSERT(filter != NULL);
+    CU_ASSERT_EQUAL(filter->capacity(filter), 1024);
+    CU_ASSERT_EQUAL(filter->size(filter), 0);
+    BloomFilterDeinit(filter);
+
+    filter = BloomFilterInit(SIZE_SML_TEST, 2.0);
+    CU_ASSERT(filter != NULL);
+    CU_ASSERT_EQUAL(filter->capacity(filter), SIZE_SML_TEST);
+    BloomFilterDeinit(filter);
+
+    /* Deinitializing a null filter should be harmless. */
+    BloomFilterDeinit(NULL);
+}
+
+void TestAddContain()
+{
+    BloomFilter* filter = BloomFilterInit(SIZE_BIG_TEST, 0.01);
+    CU_ASSERT(filter != NULL);
+
+    /* No false negative is allowed. */
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i)
+        filter->add(filter, (void*)(intptr_t)(i << 1));
+    CU_ASSERT_EQUAL(filter->size(filter), SIZE_BIG_TEST);
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i)
+        CU_ASSERT(filter->contain(filter, (void*)(intptr_t)(i << 1)) == true);
+
+    /* The false positive rate should stay around the designated one. */
+    int num_fp = 0;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        if (filter->contain(filter, (void*)(intptr_t)((i << 1) + 1)))
+            ++num_fp;
+    }
+    CU_ASSERT(num_fp < SIZE_BIG_TEST / 40);
+
+    filter->clear(filter);
+    CU_ASSERT_EQUAL(filter->size(filter), 0);
+    num_fp = 0;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        if (filter->contain(filter, (void*)(intptr_t)(i << 1)))
+            ++num_fp;
+    }
+    CU_ASSERT_EQUAL(num_fp, 0);
+
+    BloomFilterDeinit(filter);
+}
+
+void TestPrecomputedHash()
+{
+    BloomFilter* filter = BloomFilterInit(SIZE_SML_TEST, 0.001);
+    CU_ASSERT(filter != NULL);
+
+    /* The consecutive values of a weak hash function should still spread. */
+    unsigned i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        filter->add_hash(filter, i);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(filter->contain_hash(filter, i) == true);
+
+    int num_fp = 0;
+    for (i = SIZE_SML_TEST ; i < SIZE_SML_TEST * 3 ; ++i) {
+        if (filter->contain_hash(filter, i))
+            ++num_fp;
+    }
+    CU_ASSERT(num_fp < SIZE_SML_TEST / 50);
+
+    BloomFilterDeinit(filter);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to complex data maintenance                  *
+ *-----------------------------------------------------------------------------*/
+void TestCustomHash()
+{
+    char buf[SIZE_TNY_TEST];
+    BloomFilter* filter = BloomFilterInit(SIZE_SML_TEST, 0.01);
+    CU_ASSERT(filter != NULL);
+    filter->set_hash(filter, HashString64);
+
+    /* The keys are matched by content rather than by address. */
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        filter->add(filter, buf);
+    }
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        char* key = strdup(buf);
+        CU_ASSERT(filter->contain(filter, key) == true);
+        free(key);
+    }
+
+    /* Restore the default hash function. */
+    filter->clear(filter);
+    filter->set_hash(filter, NULL);
+    filter->add(filter, buf);
+    CU_ASSERT(filter->contain(filter, buf) == true);
+
+    BloomFilterDeinit(filter);
+}
+
+
+bool AddSuite()
+{
+    {
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Key Insertion and Query", TestAddContain);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Precomputed Hash Value", TestPrecomputedHash);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Custom Hash Function", TestCustomHash);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for BloomFilter structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
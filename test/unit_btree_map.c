@@ -0,0 +1,736 @@
+#include "container/btree_map.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 1024;
+static const int SIZE_LGE_TEST = 4096;
+static const int SIZE_MID_STR = 32;
+
+static const int RANGE_CHAR = 26;
+static const int BASE_CHAR = 97;
+
+static const int MASK_YEAR = 50;
+static const int MASK_LEVEL = 100;
+
+typedef struct Employ_ {
+    int year;
+    int level;
+    int id;
+} Employ;
+
+
+/*-----------------------------------------------------------------------------*
+ * The utilities for hash value generation, key comparison, and resource clean *
+ *-----------------------------------------------------------------------------*/
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanKey(void* key)
+{
+    free(key);
+}
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    BTreeMap* map;
+    CU_ASSERT((map = BTreeMapInit()) != NULL);
+    BTreeMapDeinit(map);
+
+    /* Enlarge the map size to test the destructor. */
+    CU_ASSERT((map = BTreeMapInit()) != NULL);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    for (i = SIZE_MID_TEST - 1; i >= SIZE_SML_TEST; --i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    BTreeMapDeinit(map);
+
+    /* The trival trees which keep only the root leaf. */
+    CU_ASSERT((map = BTreeMapInit()) != NULL);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)0, (void*)(intptr_t)0) == true);
+    BTreeMapDeinit(map);
+
+    CU_ASSERT((map = BTreeMapInit()) != NULL);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)1) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)0, (void*)(intptr_t)0) == true);
+    BTreeMapDeinit(map);
+}
+
+void TestOrderRelation()
+{
+    BTreeMap* map = BTreeMapInit();
+
+    /* Get the minimum and maximum keys from empty tree. */
+    CU_ASSERT(map->minimum(map) == NULL);
+    CU_ASSERT(map->maximum(map) == NULL);
+
+    /* The keys fit in a single leaf, so the root handles all the queries. */
+    CU_ASSERT(map->put(map, (void*)(intptr_t)10, (void*)(intptr_t)10) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)15, (void*)(intptr_t)15) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)20, (void*)(intptr_t)20) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)25, (void*)(intptr_t)25) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)22, (void*)(intptr_t)22) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)9, (void*)(intptr_t)9) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)6, (void*)(intptr_t)6) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)1) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)4, (void*)(intptr_t)4) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)7, (void*)(intptr_t)7) == true);
+
+    /* Check structure correctness. */
+    Pair* ptr_pair = map->predecessor(map, (void*)(intptr_t)4);
+    CU_ASSERT_EQUAL(1, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(1, (int)(intptr_t)ptr_pair->value);
+    ptr_pair = map->successor(map, (void*)(intptr_t)4);
+    CU_ASSERT_EQUAL(6, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(6, (int)(intptr_t)ptr_pair->value);
+
+    ptr_pair = map->predecessor(map, (void*)(intptr_t)6);
+    CU_ASSERT_EQUAL(4, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(4, (int)(intptr_t)ptr_pair->value);
+    ptr_pair = map->successor(map, (void*)(intptr_t)6);
+    CU_ASSERT_EQUAL(7, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(7, (int)(intptr_t)ptr_pair->value);
+
+    ptr_pair = map->predecessor(map, (void*)(intptr_t)7);
+    CU_ASSERT_EQUAL(6, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(6, (int)(intptr_t)ptr_pair->value);
+    ptr_pair = map->successor(map, (void*)(intptr_t)7);
+    CU_ASSERT_EQUAL(9, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(9, (int)(intptr_t)ptr_pair->value);
+
+    ptr_pair = map->predecessor(map, (void*)(intptr_t)9);
+    CU_ASSERT_EQUAL(7, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(7, (int)(intptr_t)ptr_pair->value);
+    ptr_pair = map->successor(map, (void*)(intptr_t)9);
+    CU_ASSERT_EQUAL(10, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(10, (int)(intptr_t)ptr_pair->value);
+
+    ptr_pair = map->predecessor(map, (void*)(intptr_t)10);
+    CU_ASSERT_EQUAL(9, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(9, (int)(intptr_t)ptr_pair->value);
+    ptr_pair = map->successor(map, (void*)(intptr_t)10);
+    CU_ASSERT_EQUAL(15, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(15, (int)(intptr_t)ptr_pair->value);
+
+    ptr_pair = map->predecessor(map, (void*)(intptr_t)15);
+    CU_ASSERT_EQUAL(10, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(10, (int)(intptr_t)ptr_pair->value);
+    ptr_pair = map->successor(map, (void*)(intptr_t)15);
+    CU_ASSERT_EQUAL(20, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(20, (int)(intptr_t)ptr_pair->value);
+
+    ptr_pair = map->predecessor(map, (void*)(intptr_t)20);
+    CU_ASSERT_EQUAL(15, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(15, (int)(intptr_t)ptr_pair->value);
+    ptr_pair = map->successor(map, (void*)(intptr_t)20);
+    CU_ASSERT_EQUAL(22, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(22, (int)(intptr_t)ptr_pair->value);
+
+    ptr_pair = map->predecessor(map, (void*)(intptr_t)22);
+    CU_ASSERT_EQUAL(20, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(20, (int)(intptr_t)ptr_pair->value);
+    ptr_pair = map->successor(map, (void*)(intptr_t)22);
+    CU_ASSERT_EQUAL(25, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(25, (int)(intptr_t)ptr_pair->value);
+
+    /* Check the minimum and maximum key. */
+    ptr_pair = map->minimum(map);
+    CU_ASSERT_EQUAL(1, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(1, (int)(intptr_t)ptr_pair->value);
+    CU_ASSERT(map->predecessor(map, ptr_pair->key) == NULL);
+
+    ptr_pair = map->maximum(map);
+    CU_ASSERT_EQUAL(25, (int)(intptr_t)ptr_pair->key);
+    CU_ASSERT_EQUAL(25, (int)(intptr_t)ptr_pair->value);
+    CU_ASSERT(map->successor(map, ptr_pair->key) == NULL);
+
+    /* Get the predecessor and successor for the non-existing key. */
+    CU_ASSERT(map->predecessor(map, (void*)(intptr_t)100) == NULL);
+    CU_ASSERT(map->successor(map, (void*)(intptr_t)100) == NULL);
+
+    /* Check the map size. */
+    CU_ASSERT_EQUAL(map->size(map), 10);
+
+    BTreeMapDeinit(map);
+}
+
+void TestPutGetNum()
+{
+    srand(time(NULL));
+
+    int elems[SIZE_SML_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        elems[i] = i;
+
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int src = rand() % SIZE_SML_TEST;
+        int tge = rand() % SIZE_SML_TEST;
+        int temp = elems[src];
+        elems[src] = elems[tge];
+        elems[tge] = temp;
+    }
+
+    BTreeMap* map = BTreeMapInit();
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+
+    for (i = 1 ; i < SIZE_SML_TEST - 1 ; ++i) {
+        void* value = map->get(map, (void*)(intptr_t)i);
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)value);
+    }
+
+    CU_ASSERT(map->get(map, (void*)(intptr_t)-1) == NULL);
+
+    BTreeMapDeinit(map);
+}
+
+void TestRemoveNum()
+{
+    srand(time(NULL));
+
+    int elems[SIZE_LGE_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        elems[i] = i;
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        int src = rand() % SIZE_LGE_TEST;
+        int tge = rand() % SIZE_LGE_TEST;
+        int temp = elems[src];
+        elems[src] = elems[tge];
+        elems[tge] = temp;
+    }
+
+    BTreeMap* map = BTreeMapInit();
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+
+    /* Remove part of the key value pairs. */
+    int bgn = 0;
+    int end = SIZE_TNY_TEST;
+    for (i = bgn ; i < end ; ++i)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+
+    bgn = SIZE_LGE_TEST - 1;
+    end = SIZE_LGE_TEST - SIZE_TNY_TEST;
+    for (i = bgn ; i >= end ; --i)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+
+    int divd = SIZE_LGE_TEST >> 1;
+    bgn = divd - SIZE_TNY_TEST;
+    end = divd + SIZE_TNY_TEST;
+    for (i = bgn ; i <= end ; ++i)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+
+    /* Querying for the keys that are already removed should fail. */
+    bgn = 0;
+    end = SIZE_TNY_TEST;
+    for (i = bgn ; i < end ; ++i) {
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == false);
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == false);
+    }
+
+    /* Querying for the keys that still exist should success. */
+    bgn = SIZE_TNY_TEST;
+    end = SIZE_SML_TEST - SIZE_TNY_TEST;
+    for (i = bgn ; i < end ; ++i)
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == true);
+
+    bgn = SIZE_SML_TEST + SIZE_TNY_TEST + 1;
+    end = SIZE_MID_TEST - SIZE_TNY_TEST;
+    for (i = bgn ; i < end ; ++i)
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == true);
+
+    BTreeMapDeinit(map);
+
+    /* Test the trival tree handling. */
+    map = BTreeMapInit();
+    map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)1);
+    CU_ASSERT(map->remove(map, (void*)(intptr_t)1) == true);
+    CU_ASSERT(map->minimum(map) == NULL);
+    CU_ASSERT(map->maximum(map) == NULL);
+    CU_ASSERT(map->predecessor(map, (void*)(intptr_t)1) == NULL);
+    CU_ASSERT(map->successor(map, (void*)(intptr_t)1) == NULL);
+
+    map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)1);
+    map->put(map, (void*)(intptr_t)2, (void*)(intptr_t)2);
+    CU_ASSERT(map->remove(map, (void*)(intptr_t)1) == true);
+
+    Pair* ptr_pair = map->maximum(map);
+    CU_ASSERT_EQUAL(ptr_pair->key, (void*)(intptr_t)2);
+    CU_ASSERT_EQUAL(ptr_pair->value, (void*)(intptr_t)2);
+
+    ptr_pair = map->minimum(map);
+    CU_ASSERT_EQUAL(ptr_pair->key, (void*)(intptr_t)2);
+    CU_ASSERT_EQUAL(ptr_pair->value, (void*)(intptr_t)2);
+
+    CU_ASSERT(map->predecessor(map, (void*)(intptr_t)2) == NULL);
+    CU_ASSERT(map->successor(map, (void*)(intptr_t)2) == NULL);
+
+    BTreeMapDeinit(map);
+}
+
+void TestRandomChurn()
+{
+    srand(time(NULL));
+
+    /* Mirror the map with a presence table to cover the node split, borrow,
+       and merge paths under random interleaved updates. */
+    bool exist[SIZE_LGE_TEST];
+    memset(exist, 0, sizeof(exist));
+
+    BTreeMap* map = BTreeMapInit();
+    int count = 0;
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST * 8 ; ++i) {
+        int key = rand() % SIZE_LGE_TEST;
+        if (rand() % 3 != 0) {
+            CU_ASSERT(map->put(map, (void*)(intptr_t)key, (void*)(intptr_t)key) == true);
+            if (!exist[key])
+                ++count;
+            exist[key] = true;
+        } else {
+            CU_ASSERT(map->remove(map, (void*)(intptr_t)key) == exist[key]);
+            if (exist[key])
+                --count;
+            exist[key] = false;
+        }
+    }
+    CU_ASSERT_EQUAL(map->size(map), count);
+
+    /* The traversal should visit the surviving keys in ascending order. */
+    int prev = -1;
+    int visit = 0;
+    Pair* ptr_pair;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        CU_ASSERT(key > prev);
+        CU_ASSERT(exist[key] == true);
+        prev = key;
+        ++visit;
+    }
+    CU_ASSERT_EQUAL(visit, count);
+
+    /* Drain the map and ensure the tree is shrunk to empty. */
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == exist[i]);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    CU_ASSERT(map->minimum(map) == NULL);
+    CU_ASSERT(map->maximum(map) == NULL);
+
+    BTreeMapDeinit(map);
+}
+
+void TestIterate()
+{
+    srand(time(NULL));
+
+    int elems[SIZE_SML_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        elems[i] = i;
+
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int src = rand() % SIZE_SML_TEST;
+        int tge = rand() % SIZE_SML_TEST;
+        int temp = elems[src];
+        elems[src] = elems[tge];
+        elems[tge] = temp;
+    }
+
+    BTreeMap* map = BTreeMapInit();
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+
+    map->first(map);
+    i = 0;
+    Pair* ptr_pair;
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->key);
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->value);
+        ++i;
+    }
+    CU_ASSERT(map->next(map) == NULL);
+
+    /* The previous iteration should not change the structure layout. */
+    map->first(map);
+    i = 0;
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->key);
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->value);
+        ++i;
+    }
+
+    BTreeMapDeinit(map);
+}
+
+void TestReverseIterate()
+{
+    srand(time(NULL));
+
+    int elems[SIZE_SML_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        elems[i] = i;
+
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int src = rand() % SIZE_SML_TEST;
+        int tge = rand() % SIZE_SML_TEST;
+        int temp = elems[src];
+        elems[src] = elems[tge];
+        elems[tge] = temp;
+    }
+
+    BTreeMap* map = BTreeMapInit();
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+
+    map->first(map);
+    i = SIZE_SML_TEST - 1;
+    Pair* ptr_pair;
+    while ((ptr_pair = map->reverse_next(map)) != NULL) {
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->key);
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->value);
+        --i;
+    }
+    CU_ASSERT(map->next(map) == NULL);
+
+    /* The previous iteration should not change the structure layout. */
+    map->first(map);
+    i = SIZE_SML_TEST - 1;
+    while ((ptr_pair = map->reverse_next(map)) != NULL) {
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->key);
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->value);
+        --i;
+    }
+
+    BTreeMapDeinit(map);
+}
+
+void TestExternalIterator()
+{
+    BTreeMap* map = BTreeMapInit();
+
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int key = (i * 7) % SIZE_SML_TEST;
+        map->put(map, (void*)(intptr_t)key, (void*)(intptr_t)key);
+    }
+
+    /* Run the forward and the reverse iterators simultaneously. */
+    BTreeMapIter fwd, rev;
+    BTreeMapIterInit(map, &fwd, false);
+    BTreeMapIterInit(map, &rev, true);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Pair* ptr_fwd = BTreeMapIterNext(&fwd);
+        Pair* ptr_rev = BTreeMapIterNext(&rev);
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_fwd->key);
+        CU_ASSERT_EQUAL(SIZE_SML_TEST - 1 - i, (int)(intptr_t)ptr_rev->key);
+    }
+    CU_ASSERT(BTreeMapIterNext(&fwd) == NULL);
+    CU_ASSERT(BTreeMapIterNext(&rev) == NULL);
+    BTreeMapDeinit(map);
+
+    /* Traverse an empty map. */
+    map = BTreeMapInit();
+    BTreeMapIterInit(map, &fwd, false);
+    CU_ASSERT(BTreeMapIterNext(&fwd) == NULL);
+    BTreeMapDeinit(map);
+}
+
+void TestPutDupText()
+{
+    char buf[SIZE_TNY_TEST];
+    char* keys[SIZE_TNY_TEST];
+    BTreeMap* map = BTreeMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = i;
+        employ->level = i;
+        employ->id = i;
+        map->put(map, (void*)keys[i], (void*)employ);
+    }
+
+    /* Insert the new key value pairs with the same key set. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = SIZE_TNY_TEST - i;
+        employ->level = SIZE_TNY_TEST - i;
+        employ->id = SIZE_TNY_TEST - i;
+        CU_ASSERT(map->put(map, (void*)keys[i], (void*)employ) == true);
+    }
+
+    /* Now the values of the existing pairs should be replaced. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        Employ* employ = map->get(map, (void*)keys[i]);
+        CU_ASSERT_EQUAL(SIZE_TNY_TEST - i, employ->year);
+        CU_ASSERT_EQUAL(SIZE_TNY_TEST - i, employ->level);
+        CU_ASSERT_EQUAL(SIZE_TNY_TEST - i, employ->id);
+    }
+
+    BTreeMapDeinit(map);
+}
+
+void TestRemoveTxt()
+{
+    char buf[SIZE_TNY_TEST];
+    char* keys[SIZE_TNY_TEST];
+    BTreeMap* map = BTreeMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = i;
+        employ->level = i;
+        employ->id = i;
+        map->put(map, (void*)keys[i], (void*)employ);
+    }
+
+    /* Remove the first half of the key value pairs. */
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i)
+        CU_ASSERT(map->remove(map, (void*)keys[i]) == true);
+
+    /* Querying for the keys that are already removed should fail. */
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        CU_ASSERT(map->remove(map, (void*)buf) == false);
+        CU_ASSERT(map->find(map, (void*)buf) == false);
+    }
+
+    /* Querying for the keys that still exist should success. */
+    for (i = SIZE_TNY_TEST >> 1 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(map->find(map, (void*)keys[i]) == true);
+
+    BTreeMapDeinit(map);
+}
+
+void TestBulkTxt()
+{
+    char buf[SIZE_MID_TEST];
+    char* keys[SIZE_MID_TEST];
+    BTreeMap* map = BTreeMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = i;
+        employ->level = i;
+        employ->id = i;
+        map->put(map, (void*)keys[i], (void*)employ);
+    }
+
+    /* Remove the first half of the key value pairs. */
+    for (i = 0 ; i < SIZE_MID_TEST >> 1 ; ++i)
+        CU_ASSERT(map->remove(map, (void*)keys[i]) == true);
+
+    /* Querying for the keys that are already removed should fail. */
+    for (i = 0 ; i < SIZE_MID_TEST >> 1 ; ++i) {
+        snprintf(buf, SIZE_MID_TEST, "key -> %d", i);
+        CU_ASSERT(map->remove(map, (void*)buf) == false);
+        CU_ASSERT(map->find(map, (void*)buf) == false);
+    }
+
+    /* Querying for the keys that still exist should success. */
+    for (i = SIZE_MID_TEST >> 1 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(map->find(map, (void*)keys[i]) == true);
+
+    BTreeMapDeinit(map);
+}
+
+static int num_alloc;
+
+void* CountAlloc(void* ctx, size_t size)
+{
+    ++num_alloc;
+    return malloc(size);
+}
+
+void CountFree(void* ctx, void* ptr)
+{
+    --num_alloc;
+    free(ptr);
+}
+
+void TestAllocator()
+{
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+
+    /* Apply the custom allocator to the map. */
+    BTreeMap* map = BTreeMapInit();
+    CU_ASSERT(map->set_allocator(map, &alloc) == true);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    /* Each node packs many pairs, so far fewer nodes than pairs are used. */
+    int num_node = num_alloc;
+    CU_ASSERT(num_node > 0 && num_node < (SIZE_SML_TEST >> 3));
+    CU_ASSERT(map->set_allocator(map, NULL) == false);
+    CU_ASSERT(map->use_pool(map) == false);
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2)
+        map->remove(map, (void*)(intptr_t)i);
+    CU_ASSERT(num_alloc > 0 && num_alloc <= num_node);
+    BTreeMapDeinit(map);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* The global allocator is captured at construction. */
+    CdsSetAllocator(&alloc);
+    map = BTreeMapInit();
+    CdsSetAllocator(NULL);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, num_node);
+    BTreeMapDeinit(map);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* Manage the nodes with the internal pool. */
+    map = BTreeMapInit();
+    CU_ASSERT(map->use_pool(map) == true);
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    for (i = 0 ; i < SIZE_LGE_TEST ; i += 2)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == (i & 1));
+
+    /* The in-order traversal should be intact. */
+    i = 1;
+    Pair* ptr_pair;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, i);
+        i += 2;
+    }
+    BTreeMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                      The driver for BTreeMap unit test                      *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        /* Verify the basic operations and the structural correctness. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Order Relation", TestOrderRelation);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Numerics Put and Get", TestPutGetNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Numerics Remove", TestRemoveNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Random Put and Remove", TestRandomChurn);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Iterator", TestIterate);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Reverse Iterator", TestReverseIterate);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "External Iterator", TestExternalIterator);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Test its robustness to maintain complex data types and large data set. */
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Pair Replacement", TestPutDupText);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Text Remove and Garbage Collection", TestRemoveTxt);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Bulk Text Maintenance", TestBulkTxt);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Node Allocation via Allocator and Pool", TestAllocator);
+        if (!unit)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for map structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
@@ -0,0 +1,264 @@
+#include <pthread.h>
+#include "container/concurrent_hash_map.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 1024;
+static const int SIZE_MID_STR = 32;
+
+#define NUM_THREAD 8
+
+typedef struct Employ_ {
+    int year;
+    int level;
+    int id;
+} Employ;
+
+typedef struct Task_ {
+    ConcurrentHashMap* map;
+    int bgn;
+    int end;
+    int fail;
+} Task;
+
+
+/*-----------------------------------------------------------------------------*
+ *   The utilities for hash value generation, key comparison, and thread job   *
+ *-----------------------------------------------------------------------------*/
+unsigned HashKey(void* key)
+{
+    char* str = (char*)key;
+    unsigned long hash = 5381;
+    int c;
+
+    while (c = *str++)
+        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+
+    return hash;
+}
+
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanKey(void* key)
+{
+    free(key);
+}
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+void CountPair(Pair* ptr_pair, void* arg)
+{
+    int* count = (int*)arg;
+    if ((int)(intptr_t)ptr_pair->key == (int)(intptr_t)ptr_pair->value)
+        ++(*count);
+}
+
+void* PutAndGet(void* arg)
+{
+    Task* task = (Task*)arg;
+    ConcurrentHashMap* map = task->map;
+
+    int i;
+    for (i = task->bgn ; i < task->end ; ++i) {
+        if (!map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i))
+            ++(task->fail);
+    }
+    for (i = task->bgn ; i < task->end ; ++i) {
+        if ((int)(intptr_t)map->get(map, (void*)(intptr_t)i) != i)
+            ++(task->fail);
+    }
+
+    /* Remove the odd keys owned by this thread. */
+    for (i = task->bgn ; i < task->end ; ++i) {
+        if ((i & 1) && !map->remove(map, (void*)(intptr_t)i))
+            ++(task->fail);
+    }
+    return NULL;
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    ConcurrentHashMap* map;
+    CU_ASSERT((map = ConcurrentHashMapInit(0)) != NULL);
+
+    /* Enlarge the map size to test the destructor. */
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+
+    ConcurrentHashMapDeinit(map);
+
+    /* The shard count is adjusted to the power of two. */
+    CU_ASSERT((map = ConcurrentHashMapInit(3)) != NULL);
+    ConcurrentHashMapDeinit(map);
+}
+
+void TestPutGetRemoveNum()
+{
+    ConcurrentHashMap* map = ConcurrentHashMapInit(4);
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)i), i);
+    }
+
+    /* Remove the first half of the key value pairs. */
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i) {
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == false);
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == false);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_TNY_TEST >> 1);
+
+    /* Visit the remaining pairs. */
+    int count = 0;
+    map->for_each(map, CountPair, &count);
+    CU_ASSERT_EQUAL(count, SIZE_TNY_TEST >> 1);
+
+    ConcurrentHashMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *              Unit tests relevant to complex data maintenance                *
+ *-----------------------------------------------------------------------------*/
+void TestBulkTxt()
+{
+    char buf[SIZE_MID_STR];
+    ConcurrentHashMap* map = ConcurrentHashMapInit(0);
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = i;
+        employ->level = i;
+        employ->id = i;
+        map->put(map, (void*)strdup(buf), (void*)employ);
+    }
+
+    /* Replace and remove some pairs to test the cleanup functions. */
+    for (i = 0 ; i < SIZE_MID_TEST >> 1 ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        CU_ASSERT(map->remove(map, (void*)buf) == true);
+    }
+    for (i = SIZE_MID_TEST >> 1 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        Employ* employ = (Employ*)map->get(map, (void*)buf);
+        CU_ASSERT(employ != NULL && employ->id == i);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST >> 1);
+
+    ConcurrentHashMapDeinit(map);
+}
+
+void TestMultiThread()
+{
+    ConcurrentHashMap* map = ConcurrentHashMapInit(0);
+
+    /* Each thread maintains its own key range of the shared map. */
+    pthread_t threads[NUM_THREAD];
+    Task tasks[NUM_THREAD];
+    int i;
+    for (i = 0 ; i < NUM_THREAD ; ++i) {
+        tasks[i].map = map;
+        tasks[i].bgn = i * SIZE_MID_TEST;
+        tasks[i].end = (i + 1) * SIZE_MID_TEST;
+        tasks[i].fail = 0;
+        CU_ASSERT(pthread_create(&threads[i], NULL, PutAndGet, &tasks[i]) == 0);
+    }
+    for (i = 0 ; i < NUM_THREAD ; ++i) {
+        pthread_join(threads[i], NULL);
+        CU_ASSERT_EQUAL(tasks[i].fail, 0);
+    }
+
+    int num = NUM_THREAD * SIZE_MID_TEST;
+    CU_ASSERT_EQUAL(map->size(map), num >> 1);
+    for (i = 0 ; i < num ; ++i)
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == ((i & 1) == 0));
+
+    ConcurrentHashMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                The driver for ConcurrentHashMap unit test                   *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        /* Verify the basic operations and the structural correctness. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Map New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Numeric Key Put, Get, and Remove", TestPutGetRemoveNum);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Test its robustness to maintain complex data and concurrent access. */
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Large Amount Pair Maintenance", TestBulkTxt);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Multi-threaded Access", TestMultiThread);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for map structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
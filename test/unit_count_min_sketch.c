@@ -0,0 +1,335 @@
+#include "container/count_min_sketch.h"
+#include "math/hash.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 16;
+static const int SIZE_SML_TEST = 1024;
+static const int SIZE_BIG_TEST = 65536;
+
+
+/*-----------------------------------------------------------------------------*
+ *               The utilities for resource clean and key codec                *
+ *-----------------------------------------------------------------------------*/
+void CleanKey(void* key)
+{
+    free(key);
+}
+
+size_t EncodeKey(void* ctx, void* key, void* buf, size_t capacity)
+{
+    size_t size = strlen((char*)key);
+    if (size <= capacity)
+        memcpy(buf, key, size);
+    return size;
+}
+
+bool DecodeKey(void* ctx, const void* bytes, size_t size, void** p_key)
+{
+    char* key = (char*)malloc(size + 1);
+    if (!key)
+        return false;
+    memcpy(key, bytes, size);
+    key[size] = 0;
+    *p_key = key;
+    return true;
+}
+
+/* The key i occurs SIZE_SML_TEST / (i + 1) times, so the small keys are the
+   heavy hitters. */
+unsigned Frequency(int key)
+{
+    return SIZE_SML_TEST / (key + 1);
+}
+
+char* NewKey(int key)
+{
+    char* text = (char*)malloc(16);
+    snprintf(text, 16, "key%d", key);
+    return text;
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    CountMinSketch* sketch = CountMinSketchInit(0, 0, 0);
+    CU_ASSERT(sketch != NULL);
+    CU_ASSERT_EQUAL(sketch->total(sketch), 0);
+    CU_ASSERT_EQUAL(sketch->estimate(sketch, (void*)(intptr_t)1), 0);
+
+    void* keys[1];
+    CU_ASSERT_EQUAL(sketch->add(sketch, (void*)(intptr_t)1, 3), 3);
+    CU_ASSERT_EQUAL(sketch->top_k(sketch, keys, NULL), 0);
+    CountMinSketchDeinit(sketch);
+
+    sketch = CountMinSketchInit(0.01, 0.001, SIZE_TNY_TEST);
+    CU_ASSERT(sketch != NULL);
+    CountMinSketchDeinit(sketch);
+
+    /* Deinitializing a null sketch should be harmless. */
+    CountMinSketchDeinit(NULL);
+}
+
+void TestAddEstimate()
+{
+    double epsilon = 0.001;
+    CountMinSketch* sketch = CountMinSketchInit(epsilon, 0.01, 0);
+
+    uint64_t total = 0;
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        unsigned freq = Frequency(i % SIZE_SML_TEST) + 1;
+        sketch->add(sketch, (void*)(intptr_t)i, freq);
+        total += freq;
+    }
+    CU_ASSERT_EQUAL(sketch->total(sketch), total);
+
+    /* The estimate never goes below the true count, and rarely exceeds it by
+       epsilon times of the total count. */
+    int num_over = 0;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        uint64_t freq = Frequency(i % SIZE_SML_TEST) + 1;
+        uint64_t estimate = sketch->estimate(sketch, (void*)(intptr_t)i);
+        CU_ASSERT(estimate >= freq);
+        if ((double)(estimate - freq) > epsilon * total)
+            ++num_over;
+    }
+    CU_ASSERT(num_over < SIZE_BIG_TEST / 100);
+
+    sketch->clear(sketch);
+    CU_ASSERT_EQUAL(sketch->total(sketch), 0);
+    CU_ASSERT_EQUAL(sketch->estimate(sketch, (void*)(intptr_t)0), 0);
+
+    CountMinSketchDeinit(sketch);
+}
+
+void TestTopK()
+{
+    CountMinSketch* sketch = CountMinSketchInit(0.001, 0.01, SIZE_TNY_TEST);
+
+    /* Interleave the keys so that the heavy hitters arrive gradually. */
+    int round, i;
+    for (round = 0 ; round < SIZE_SML_TEST ; ++round) {
+        for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+            if (round < (int)Frequency(i))
+                sketch->add(sketch, (void*)(intptr_t)i, 1);
+        }
+    }
+
+    void* keys[SIZE_TNY_TEST];
+    uint64_t counts[SIZE_TNY_TEST];
+    CU_ASSERT_EQUAL(sketch->top_k(sketch, keys, counts), SIZE_TNY_TEST);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        CU_ASSERT_EQUAL((int)(intptr_t)keys[i], i);
+        CU_ASSERT(counts[i] >= Frequency(i));
+        if (i > 0)
+            CU_ASSERT(counts[i] <= counts[i - 1]);
+    }
+
+    sketch->clear(sketch);
+    CU_ASSERT_EQUAL(sketch->top_k(sketch, keys, counts), 0);
+
+    CountMinSketchDeinit(sketch);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to complex data maintenance                  *
+ *-----------------------------------------------------------------------------*/
+void TestMerge()
+{
+    CountMinSketch* whole = CountMinSketchInit(0.001, 0.01, SIZE_TNY_TEST);
+    CountMinSketch* lhs = CountMinSketchInit(0.001, 0.01, SIZE_TNY_TEST);
+    CountMinSketch* rhs = CountMinSketchInit(0.001, 0.01, SIZE_TNY_TEST);
+
+    /* Split the stream so that the heavy hitters of each half differ. */
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        void* key = (void*)(intptr_t)i;
+        unsigned freq = Frequency(i);
+        whole->add(whole, key, freq);
+        CountMinSketch* part = (i % 2 == 0)? lhs : rhs;
+        part->add(part, key, freq);
+    }
+    CU_ASSERT(lhs->merge(lhs, rhs) == true);
+    CU_ASSERT_EQUAL(lhs->total(lhs), whole->total(whole));
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        void* key = (void*)(intptr_t)i;
+        CU_ASSERT_EQUAL(lhs->estimate(lhs, key), whole->estimate(whole, key));
+    }
+
+    void* keys[SIZE_TNY_TEST];
+    CU_ASSERT_EQUAL(lhs->top_k(lhs, keys, NULL), SIZE_TNY_TEST);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT_EQUAL((int)(intptr_t)keys[i], i);
+
+    /* The sketches with different dimensions cannot be merged. */
+    CountMinSketch* other = CountMinSketchInit(0.01, 0.01, SIZE_TNY_TEST);
+    CU_ASSERT(lhs->merge(lhs, other) == false);
+
+    CountMinSketchDeinit(other);
+    CountMinSketchDeinit(rhs);
+    CountMinSketchDeinit(lhs);
+    CountMinSketchDeinit(whole);
+}
+
+void TestOwnership()
+{
+    CountMinSketch* sketch = CountMinSketchInit(0.01, 0.01, SIZE_TNY_TEST);
+    sketch->set_hash(sketch, HashString64);
+    sketch->set_clean(sketch, CleanKey);
+
+    /* Every passed key is owned by the sketch, whether tracked or not. */
+    int i, j;
+    for (i = SIZE_SML_TEST - 1 ; i >= 0 ; --i) {
+        for (j = 0 ; j < (int)Frequency(i) ; ++j)
+            sketch->add(sketch, NewKey(i), 1);
+    }
+
+    char* expect = NewKey(0);
+    void* keys[SIZE_TNY_TEST];
+    CU_ASSERT_EQUAL(sketch->top_k(sketch, keys, NULL), SIZE_TNY_TEST);
+    CU_ASSERT_STRING_EQUAL((char*)keys[0], expect);
+    CU_ASSERT(sketch->estimate(sketch, expect) >= SIZE_SML_TEST);
+    free(expect);
+
+    sketch->clear(sketch);
+    sketch->add(sketch, NewKey(1), 1);
+    CountMinSketchDeinit(sketch);
+}
+
+void TestSnapshot()
+{
+    CountMinSketch* sketch = CountMinSketchInit(0.001, 0.01, SIZE_TNY_TEST);
+    sketch->set_hash(sketch, HashString64);
+    sketch->set_clean(sketch, CleanKey);
+
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        sketch->add(sketch, NewKey(i), Frequency(i));
+
+    SnapshotCodec codec = {EncodeKey, DecodeKey, NULL};
+    FILE* file = tmpfile();
+    CU_ASSERT(file != NULL);
+    SnapshotWriter writer = {CdsWriteFile, file};
+    CU_ASSERT(CountMinSketchSnapshot(sketch, &writer, &codec) == true);
+    CU_ASSERT(CountMinSketchSnapshot(sketch, &writer, &codec) == true);
+
+    /* Restoring into the empty sketch copies it, and restoring again merges. */
+    CountMinSketch* copy = CountMinSketchInit(0.001, 0.01, SIZE_TNY_TEST);
+    copy->set_hash(copy, HashString64);
+    copy->set_clean(copy, CleanKey);
+    rewind(file);
+    SnapshotReader reader = {CdsReadFile, file};
+    CU_ASSERT(CountMinSketchRestore(copy, &reader, &codec) == true);
+    CU_ASSERT_EQUAL(copy->total(copy), sketch->total(sketch));
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        char* key = NewKey(i);
+        CU_ASSERT_EQUAL(copy->estimate(copy, key), sketch->estimate(sketch, key));
+        free(key);
+    }
+
+    CU_ASSERT(CountMinSketchRestore(copy, &reader, &codec) == true);
+    CU_ASSERT_EQUAL(copy->total(copy), sketch->total(sketch) * 2);
+
+    void* keys[SIZE_TNY_TEST];
+    uint64_t counts[SIZE_TNY_TEST];
+    CU_ASSERT_EQUAL(copy->top_k(copy, keys, counts), SIZE_TNY_TEST);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        char* key = NewKey(i);
+        CU_ASSERT_STRING_EQUAL((char*)keys[i], key);
+        CU_ASSERT(counts[i] >= Frequency(i) * 2);
+        free(key);
+    }
+
+    /* The stream is exhausted after the snapshots. */
+    CU_ASSERT(CountMinSketchRestore(copy, &reader, &codec) == false);
+    fclose(file);
+
+    /* The sketch with different dimensions rejects the snapshot. */
+    CountMinSketch* other = CountMinSketchInit(0.01, 0.01, SIZE_TNY_TEST);
+    file = tmpfile();
+    writer.ctx = file;
+    CU_ASSERT(CountMinSketchSnapshot(sketch, &writer, &codec) == true);
+    rewind(file);
+    reader.ctx = file;
+    CU_ASSERT(CountMinSketchRestore(other, &reader, &codec) == false);
+    CU_ASSERT_EQUAL(other->total(other), 0);
+    fclose(file);
+
+    CountMinSketchDeinit(other);
+    CountMinSketchDeinit(copy);
+    CountMinSketchDeinit(sketch);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                  The driver for CountMinSketch unit test                    *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Count and Estimate", TestAddEstimate);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Top-k Heavy Hitters", TestTopK);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Merge", TestMerge);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Key Ownership", TestOwnership);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Snapshot and Restore", TestSnapshot);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for CountMinSketch structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
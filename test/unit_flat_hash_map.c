@@ -0,0 +1,444 @@
+#include "container/flat_hash_map.h"
+#include "math/hash.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 1024;
+static const int SIZE_MID_STR = 32;
+
+static const int RANGE_CHAR = 26;
+static const int BASE_CHAR = 97;
+
+static const int MASK_YEAR = 50;
+static const int MASK_LEVEL = 100;
+
+typedef struct Employ_ {
+    int year;
+    int level;
+    int id;
+} Employ;
+
+
+/*-----------------------------------------------------------------------------*
+ * The utilities for hash value generation, key comparison, and resource clean *
+ *-----------------------------------------------------------------------------*/
+/**
+ * The famous djb2 string hash function directly pulled from:
+ * http://www.cse.yorku.ca/~oz/hash.html
+ */
+unsigned HashKey(void* key)
+{
+    char* str = (char*)key;
+    unsigned long hash = 5381;
+    int c;
+
+    while (c = *str++)
+        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+
+    return hash;
+}
+
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanKey(void* key)
+{
+    free(key);
+}
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    FlatHashMap* map;
+    CU_ASSERT((map = FlatHashMapInit()) != NULL);
+
+    /* Enlarge the map size to test the destructor. */
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+
+    FlatHashMapDeinit(map);
+}
+
+void TestPutGetNum()
+{
+    FlatHashMap* map = FlatHashMapInit();
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == true);
+        int val = (int)(intptr_t)map->get(map, (void*)(intptr_t)i);
+        CU_ASSERT_EQUAL(i, val);
+    }
+    FlatHashMapDeinit(map);
+}
+
+void TestRemoveNum()
+{
+    FlatHashMap* map = FlatHashMapInit();
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    /* Remove the first half of the key value pairs. */
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+
+    /* Querying for the keys that are already removed should fail. */
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i) {
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == false);
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == false);
+    }
+
+    /* Querying for the keys that still exist should success. */
+    for (i = SIZE_TNY_TEST >> 1 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == true);
+
+    CU_ASSERT_EQUAL(map->size(map), SIZE_TNY_TEST >> 1);
+
+    FlatHashMapDeinit(map);
+}
+
+void TestIterateNum()
+{
+    FlatHashMap* map = FlatHashMapInit();
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    /* The pairs are scattered in the slot array, so we check that each key is
+       visited exactly once. */
+    bool visit[SIZE_TNY_TEST];
+    memset(visit, 0, sizeof(bool) * SIZE_TNY_TEST);
+    Pair* ptr_pair;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        CU_ASSERT_EQUAL(key, (int)(intptr_t)ptr_pair->value);
+        CU_ASSERT(visit[key] == false);
+        visit[key] = true;
+    }
+    CU_ASSERT(map->next(map) == NULL);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(visit[i] == true);
+
+    /* The previous iteration should not change the structure layout. */
+    i = 0;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL)
+        ++i;
+    CU_ASSERT_EQUAL(i, SIZE_TNY_TEST);
+
+    FlatHashMapDeinit(map);
+}
+
+void TestExternalIterator()
+{
+    FlatHashMap* map = FlatHashMapInit();
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    /* The external iterators are independent of each other, so they can be
+       nested. */
+    bool visit[SIZE_TNY_TEST];
+    memset(visit, 0, sizeof(bool) * SIZE_TNY_TEST);
+    FlatHashMapIter outer, inner;
+    FlatHashMapIterInit(map, &outer);
+    Pair* ptr_pair;
+    int count = 0;
+    while ((ptr_pair = FlatHashMapIterNext(&outer)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        CU_ASSERT(visit[key] == false);
+        visit[key] = true;
+        FlatHashMapIterInit(map, &inner);
+        while (FlatHashMapIterNext(&inner) != NULL)
+            ++count;
+    }
+    CU_ASSERT(FlatHashMapIterNext(&outer) == NULL);
+    CU_ASSERT_EQUAL(count, SIZE_TNY_TEST * SIZE_TNY_TEST);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(visit[i] == true);
+
+    FlatHashMapDeinit(map);
+}
+
+void TestChurnNum()
+{
+    FlatHashMap* map = FlatHashMapInit();
+
+    /* Repeatedly insert and remove the keys to accumulate the deleted slots. */
+    int round, i;
+    for (round = 0 ; round < 8 ; ++round) {
+        int base = round * SIZE_MID_TEST;
+        for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+            CU_ASSERT(map->put(map, (void*)(intptr_t)(base + i),
+                                    (void*)(intptr_t)i) == true);
+        for (i = 0 ; i < SIZE_MID_TEST ; i += 2)
+            CU_ASSERT(map->remove(map, (void*)(intptr_t)(base + i)) == true);
+    }
+    CU_ASSERT_EQUAL(map->size(map), 8 * (SIZE_MID_TEST >> 1));
+
+    for (round = 0 ; round < 8 ; ++round) {
+        int base = round * SIZE_MID_TEST;
+        for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+            bool exist = map->contain(map, (void*)(intptr_t)(base + i));
+            CU_ASSERT(exist == ((i & 1) == 1));
+            if (exist)
+                CU_ASSERT_EQUAL(i, (int)(intptr_t)map->get(map, (void*)(intptr_t)(base + i)));
+        }
+    }
+
+    FlatHashMapDeinit(map);
+}
+
+void TestPutGetTxt()
+{
+    char buf[SIZE_TNY_TEST];
+    char* keys[SIZE_TNY_TEST];
+    FlatHashMap* map = FlatHashMapInit();
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+        map->put(map, (void*)keys[i], (void*)(intptr_t)i);
+    }
+
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        CU_ASSERT(map->contain(map, (void*)keys[i]) == true);
+        int val = (int)(intptr_t)map->get(map, (void*)keys[i]);
+        CU_ASSERT_EQUAL(i, val);
+        free(keys[i]);
+    }
+
+    FlatHashMapDeinit(map);
+}
+
+void TestRemoveTxt()
+{
+    char buf[SIZE_TNY_TEST];
+    char* keys[SIZE_TNY_TEST];
+    FlatHashMap* map = FlatHashMapInit();
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = i;
+        employ->level = i;
+        employ->id = i;
+        map->put(map, (void*)keys[i], (void*)employ);
+    }
+
+    /* Remove the first half of the key value pairs. */
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i)
+        CU_ASSERT(map->remove(map, (void*)keys[i]) == true);
+
+    /* Querying for the keys that are already removed should fail. */
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        CU_ASSERT(map->remove(map, (void*)buf) == false);
+        CU_ASSERT(map->contain(map, (void*)buf) == false);
+    }
+
+    /* Querying for the keys that still exist should success. */
+    for (i = SIZE_TNY_TEST >> 1 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(map->contain(map, (void*)keys[i]) == true);
+
+    FlatHashMapDeinit(map);
+}
+
+void TestPutDupTxt()
+{
+    char buf[SIZE_TNY_TEST];
+    char* keys[SIZE_TNY_TEST];
+    FlatHashMap* map = FlatHashMapInit();
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = i;
+        employ->level = i;
+        employ->id = i;
+        map->put(map, (void*)keys[i], (void*)employ);
+    }
+
+    /* Insert the new key value pairs with the same key set. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = SIZE_TNY_TEST - i;
+        employ->level = SIZE_TNY_TEST - i;
+        employ->id = SIZE_TNY_TEST - i;
+        CU_ASSERT(map->put(map, (void*)keys[i], (void*)employ) == true);
+    }
+
+    /* Now the values of the existing pairs should be replaced. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        Employ* employ = map->get(map, (void*)keys[i]);
+        CU_ASSERT_EQUAL(SIZE_TNY_TEST - i, employ->year);
+        CU_ASSERT_EQUAL(SIZE_TNY_TEST - i, employ->level);
+        CU_ASSERT_EQUAL(SIZE_TNY_TEST - i, employ->id);
+    }
+
+    FlatHashMapDeinit(map);
+}
+
+void TestBulkTxt()
+{
+    char buf[SIZE_MID_TEST];
+    char* keys[SIZE_MID_TEST];
+    FlatHashMap* map = FlatHashMapInit();
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = i;
+        employ->level = i;
+        employ->id = i;
+        map->put(map, (void*)keys[i], (void*)employ);
+    }
+
+    /* Remove the first half of the key value pairs. */
+    for (i = 0 ; i < SIZE_MID_TEST >> 1 ; ++i)
+        CU_ASSERT(map->remove(map, (void*)keys[i]) == true);
+
+    /* Querying for the keys that are already removed should fail. */
+    for (i = 0 ; i < SIZE_MID_TEST >> 1 ; ++i) {
+        snprintf(buf, SIZE_MID_TEST, "key -> %d", i);
+        CU_ASSERT(map->remove(map, (void*)buf) == false);
+        CU_ASSERT(map->contain(map, (void*)buf) == false);
+    }
+
+    /* Querying for the keys that still exist should success. */
+    for (i = SIZE_MID_TEST >> 1 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(map->contain(map, (void*)keys[i]) == true);
+
+    FlatHashMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                      The driver for FlatHashMap unit test                       *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        /* Verify the basic operations and the structural correctness. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Map New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Numeric Key Put and Get", TestPutGetNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Numeric Key Remove", TestRemoveNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Map Iterator", TestIterateNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Map External Iterator", TestExternalIterator);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Slot Reuse after Removal", TestChurnNum);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Test its robustness to maintain complex data types and large data set. */
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Object Key Put and Get", TestPutGetTxt);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Pair Replacement", TestPutDupTxt);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Object Key Remove and Garbage Collection", TestRemoveTxt);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Large Amount Pair Maintenance", TestBulkTxt);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for map structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
+
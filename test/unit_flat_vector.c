@@ -0,0 +1,309 @@
+#include "container/flat_vector.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int DEFAULT_CAPACITY = 4;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 2048;
+
+typedef struct Record_ {
+    int key;
+    int value;
+    double weight;
+} Record;
+
+
+/*-----------------------------------------------------------------------------*
+ *                      The utilities for resource clean                       *
+ *-----------------------------------------------------------------------------*/
+static int num_clean;
+static int sum_clean;
+
+void CleanRecord(void* element)
+{
+    ++num_clean;
+    sum_clean += ((Record*)element)->key;
+}
+
+int CompareRecord(const void* lhs, const void* rhs)
+{
+    int key_lhs = ((const Record*)lhs)->key;
+    int key_rhs = ((const Record*)rhs)->key;
+    if (key_lhs == key_rhs)
+        return 0;
+    return (key_lhs > key_rhs)? 1 : -1;
+}
+
+void ResetClean()
+{
+    num_clean = 0;
+    sum_clean = 0;
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    FlatVector* vector = FlatVectorInit(sizeof(Record), DEFAULT_CAPACITY);
+    CU_ASSERT(vector != NULL);
+    CU_ASSERT_EQUAL(vector->size(vector), 0);
+    CU_ASSERT_EQUAL(vector->capacity(vector), DEFAULT_CAPACITY);
+    CU_ASSERT_EQUAL(vector->element_size(vector), sizeof(Record));
+    CU_ASSERT(vector->at(vector, 0) == NULL);
+    CU_ASSERT(vector->pop_back(vector) == false);
+    CU_ASSERT(vector->remove(vector, 0) == false);
+    FlatVectorDeinit(vector);
+
+    /* Zero capacity and zero element size. */
+    vector = FlatVectorInit(sizeof(int), 0);
+    CU_ASSERT(vector != NULL);
+    int num = 7;
+    CU_ASSERT(vector->push_back(vector, &num) == true);
+    CU_ASSERT_EQUAL(FLAT_VECTOR_AT(vector, int, 0), 7);
+    FlatVectorDeinit(vector);
+
+    CU_ASSERT(FlatVectorInit(0, DEFAULT_CAPACITY) == NULL);
+
+    /* Pass NULL pointer. */
+    FlatVectorDeinit(NULL);
+}
+
+void TestPushAndEmplace()
+{
+    FlatVector* vector = FlatVectorInit(sizeof(Record), DEFAULT_CAPACITY);
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        if (i % 2 == 0) {
+            Record record = {i, -i, i * 0.5};
+            CU_ASSERT(vector->push_back(vector, &record) == true);
+        } else {
+            Record* slot = (Record*)vector->emplace_back(vector);
+            CU_ASSERT(slot != NULL);
+            slot->key = i;
+            slot->value = -i;
+            slot->weight = i * 0.5;
+        }
+    }
+    CU_ASSERT_EQUAL(vector->size(vector), SIZE_MID_TEST);
+    CU_ASSERT(vector->capacity(vector) >= (unsigned)SIZE_MID_TEST);
+
+    /* The elements are contiguous. */
+    Record* records = FLAT_VECTOR_ARRAY(vector, Record);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        CU_ASSERT_EQUAL(records[i].key, i);
+        CU_ASSERT_EQUAL(records[i].value, -i);
+        CU_ASSERT_EQUAL(vector->at(vector, i), records + i);
+    }
+
+    Record record;
+    CU_ASSERT(vector->get(vector, SIZE_MID_TEST - 1, &record) == true);
+    CU_ASSERT_EQUAL(record.key, SIZE_MID_TEST - 1);
+    CU_ASSERT(vector->get(vector, SIZE_MID_TEST, &record) == false);
+    CU_ASSERT(vector->at(vector, SIZE_MID_TEST) == NULL);
+
+    FlatVectorDeinit(vector);
+}
+
+void TestInsertAndRemove()
+{
+    FlatVector* vector = FlatVectorInit(sizeof(Record), DEFAULT_CAPACITY);
+    vector->set_clean(vector, CleanRecord);
+    ResetClean();
+
+    /* Build the sequence from the odd keys appended and the even keys inserted
+       in front of them. */
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Record record = {2 * i + 1, 0, 0};
+        CU_ASSERT(vector->push_back(vector, &record) == true);
+    }
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Record* slot = (Record*)vector->emplace(vector, 2 * i);
+        CU_ASSERT(slot != NULL);
+        slot->key = 2 * i;
+    }
+    Record record = {-1, 0, 0};
+    CU_ASSERT(vector->insert(vector, 2 * SIZE_SML_TEST + 1, &record) == false);
+    CU_ASSERT(vector->emplace(vector, 2 * SIZE_SML_TEST + 1) == NULL);
+
+    Record* records = FLAT_VECTOR_ARRAY(vector, Record);
+    for (i = 0 ; i < 2 * SIZE_SML_TEST ; ++i)
+        CU_ASSERT_EQUAL(records[i].key, i);
+
+    /* Remove the head, the middle, and the tail elements. */
+    CU_ASSERT(vector->remove(vector, 0) == true);
+    CU_ASSERT_EQUAL(sum_clean, 0);
+    CU_ASSERT(vector->remove(vector, SIZE_SML_TEST - 1) == true);
+    CU_ASSERT_EQUAL(sum_clean, SIZE_SML_TEST);
+    CU_ASSERT(vector->pop_back(vector) == true);
+    CU_ASSERT_EQUAL(sum_clean, 3 * SIZE_SML_TEST - 1);
+    CU_ASSERT_EQUAL(num_clean, 3);
+    CU_ASSERT(vector->remove(vector, 2 * SIZE_SML_TEST - 3) == false);
+
+    CU_ASSERT(vector->insert(vector, 0, &record) == true);
+    CU_ASSERT_EQUAL(FLAT_VECTOR_AT(vector, Record, 0).key, -1);
+    CU_ASSERT_EQUAL(FLAT_VECTOR_AT(vector, Record, 1).key, 1);
+    CU_ASSERT_EQUAL(vector->size(vector), 2 * SIZE_SML_TEST - 2);
+
+    ResetClean();
+    FlatVectorDeinit(vector);
+    CU_ASSERT_EQUAL(num_clean, 2 * SIZE_SML_TEST - 2);
+}
+
+void TestReplace()
+{
+    FlatVector* vector = FlatVectorInit(sizeof(Record), DEFAULT_CAPACITY);
+    vector->set_clean(vector, CleanRecord);
+    ResetClean();
+
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Record record = {i, i, 0};
+        vector->push_back(vector, &record);
+    }
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Record record = {SIZE_SML_TEST + i, -i, 0};
+        CU_ASSERT(vector->set(vector, i, &record) == true);
+    }
+    CU_ASSERT_EQUAL(num_clean, SIZE_SML_TEST);
+    CU_ASSERT_EQUAL(sum_clean, SIZE_SML_TEST * (SIZE_SML_TEST - 1) / 2);
+
+    Record record = {0, 0, 0};
+    CU_ASSERT(vector->set(vector, SIZE_SML_TEST, &record) == false);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        CU_ASSERT(vector->get(vector, i, &record) == true);
+        CU_ASSERT_EQUAL(record.key, SIZE_SML_TEST + i);
+        CU_ASSERT_EQUAL(record.value, -i);
+    }
+
+    FlatVectorDeinit(vector);
+}
+
+void TestResize()
+{
+    FlatVector* vector = FlatVectorInit(sizeof(Record), DEFAULT_CAPACITY);
+    vector->set_clean(vector, CleanRecord);
+    ResetClean();
+
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Record record = {i, 0, 0};
+        vector->push_back(vector, &record);
+    }
+
+    /* Shrink the vector and clean the trailing elements. */
+    CU_ASSERT(vector->resize(vector, SIZE_SML_TEST / 2) == true);
+    CU_ASSERT_EQUAL(vector->size(vector), SIZE_SML_TEST / 2);
+    CU_ASSERT_EQUAL(vector->capacity(vector), SIZE_SML_TEST / 2);
+    CU_ASSERT_EQUAL(num_clean, SIZE_SML_TEST / 2);
+
+    /* Extend the vector and keep the elements. */
+    CU_ASSERT(vector->resize(vector, SIZE_MID_TEST) == true);
+    CU_ASSERT_EQUAL(vector->size(vector), SIZE_SML_TEST / 2);
+    CU_ASSERT_EQUAL(vector->capacity(vector), SIZE_MID_TEST);
+    for (i = 0 ; i < SIZE_SML_TEST / 2 ; ++i)
+        CU_ASSERT_EQUAL(FLAT_VECTOR_AT(vector, Record, i).key, i);
+
+    /* Clear the vector and reuse it. */
+    CU_ASSERT(vector->resize(vector, 0) == true);
+    CU_ASSERT_EQUAL(vector->size(vector), 0);
+    CU_ASSERT_EQUAL(num_clean, SIZE_SML_TEST);
+    Record record = {1, 0, 0};
+    CU_ASSERT(vector->push_back(vector, &record) == true);
+
+    FlatVectorDeinit(vector);
+}
+
+void TestSort()
+{
+    srand(time(NULL));
+
+    FlatVector* vector = FlatVectorInit(sizeof(Record), DEFAULT_CAPACITY);
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        Record record = {i, -i, 0};
+        vector->push_back(vector, &record);
+    }
+    Record* records = FLAT_VECTOR_ARRAY(vector, Record);
+    for (i = SIZE_MID_TEST - 1 ; i > 0 ; --i) {
+        int tge = rand() % (i + 1);
+        Record record = records[i];
+        records[i] = records[tge];
+        records[tge] = record;
+    }
+
+    vector->sort(vector, CompareRecord);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        CU_ASSERT_EQUAL(records[i].key, i);
+        CU_ASSERT_EQUAL(records[i].value, -i);
+    }
+
+    FlatVectorDeinit(vector);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                    The driver for FlatVector unit test                      *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+    if (!suite)
+        return false;
+
+    CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Element Push and Emplace", TestPushAndEmplace);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Element Insert and Remove", TestInsertAndRemove);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Element Replace", TestReplace);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Resize", TestResize);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Sort", TestSort);
+    if (!unit)
+        return false;
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for vector structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
@@ -14,6 +14,11 @@ typedef struct _Employ {
 
 bool AddBasicSuite();
 void TestMurMur32();
+void TestJenkins();
+void TestFast64();
+void TestBulk();
+void TestString64();
+void TestMix64();
 
 
 int main()
@@ -54,6 +59,26 @@ bool AddBasicSuite()
     if (!test)
         return false;
 
+    test = CU_add_test(suite, "Jenkins one-at-a-time hash", TestJenkins);
+    if (!test)
+        return false;
+
+    test = CU_add_test(suite, "Fast 64 bit hash", TestFast64);
+    if (!test)
+        return false;
+
+    test = CU_add_test(suite, "Bulk 64 bit hash", TestBulk);
+    if (!test)
+        return false;
+
+    test = CU_add_test(suite, "String 64 bit hash", TestString64);
+    if (!test)
+        return false;
+
+    test = CU_add_test(suite, "64 bit hash finalizer", TestMix64);
+    if (!test)
+        return false;
+
     return true;
 }
 
@@ -94,4 +119,124 @@ void TestMurMur32()
     free(employ);
 
     return;
-}
\ No newline at end of file
+}
+
+void TestJenkins()
+{
+    CU_ASSERT_EQUAL(HashJenkins(NULL, 32), 0);
+    CU_ASSERT_EQUAL(HashJenkins("NULL", 0), 0);
+
+    /* Test the published value of the single byte key. */
+    CU_ASSERT_EQUAL(HashJenkins((void*)"a", 1), 0xca2e9442);
+    CU_ASSERT(HashJenkins((void*)"ab", 2) != HashJenkins((void*)"ba", 2));
+
+    int key_int = 32767;
+    unsigned value = HashJenkins((void*)&key_int, sizeof(int));
+    CU_ASSERT_EQUAL(value, HashJenkins((void*)&key_int, sizeof(int)));
+}
+
+void TestFast64()
+{
+    /* Cover all the key size classes and the stripe boundaries. */
+    enum { SIZE_MAX_KEY = 4096 + 131 };
+    uint8_t* bytes = (uint8_t*)malloc(SIZE_MAX_KEY + 8);
+    uint64_t* hashes = (uint64_t*)malloc(sizeof(uint64_t) * (SIZE_MAX_KEY + 1));
+    size_t i;
+    for (i = 0 ; i < SIZE_MAX_KEY + 8 ; ++i)
+        bytes[i] = (uint8_t)(i * 131 + 7);
+
+    size_t size;
+    for (size = 0 ; size <= SIZE_MAX_KEY ; ++size) {
+        hashes[size] = HashFast64(bytes, size, 0);
+
+        /* The value is independent of the key alignment. */
+        memmove(bytes + 3, bytes, size);
+        CU_ASSERT_EQUAL(HashFast64(bytes + 3, size, 0), hashes[size]);
+        memmove(bytes, bytes + 3, size);
+
+        /* The seed derives another function. */
+        CU_ASSERT(HashFast64(bytes, size, 1) != hashes[size]);
+
+        /* Flipping any bit changes the value. */
+        if (size > 0) {
+            size_t pos = size / 2;
+            bytes[pos] ^= 0x10;
+            CU_ASSERT(HashFast64(bytes, size, 0) != hashes[size]);
+            bytes[pos] ^= 0x10;
+        }
+    }
+
+    /* The prefixes of the same bytes yield distinct values. */
+    unsigned num_collide = 0;
+    for (size = 1 ; size <= SIZE_MAX_KEY ; ++size) {
+        if (hashes[size] == hashes[size - 1])
+            ++num_collide;
+    }
+    CU_ASSERT_EQUAL(num_collide, 0);
+
+    /* Check the bit balance of the values for the small integer keys. */
+    unsigned count[64] = {0};
+    uint64_t key;
+    for (key = 0 ; key < 4096 ; ++key) {
+        uint64_t hash = HashFast64(&key, sizeof(uint64_t), 0);
+        unsigned bit;
+        for (bit = 0 ; bit < 64 ; ++bit)
+            count[bit] += (hash >> bit) & 1;
+    }
+    for (i = 0 ; i < 64 ; ++i)
+        CU_ASSERT(count[i] > 1792 && count[i] < 2304);
+
+    free(hashes);
+    free(bytes);
+}
+
+void TestBulk()
+{
+    enum { NUM_KEY = 64 };
+    char* keys[NUM_KEY];
+    size_t sizes[NUM_KEY];
+    uint64_t hashes[NUM_KEY];
+
+    int i;
+    for (i = 0 ; i < NUM_KEY ; ++i) {
+        sizes[i] = i * 17;
+        keys[i] = (char*)malloc(sizes[i] + 1);
+        memset(keys[i], 'a' + i % 26, sizes[i]);
+    }
+    HashBulk((void**)keys, sizes, hashes, NUM_KEY);
+    for (i = 0 ; i < NUM_KEY ; ++i) {
+        CU_ASSERT_EQUAL(hashes[i], HashFast64(keys[i], sizes[i], 0));
+        free(keys[i]);
+    }
+
+    HashBulk(NULL, NULL, NULL, 0);
+}
+
+void TestString64()
+{
+    /* The adapter hashes the bytes before the terminator only. */
+    const char* strs[] = {"", "a", "key", "a string longer than sixteen bytes"};
+    int i;
+    for (i = 0 ; i < 4 ; ++i) {
+        CU_ASSERT_EQUAL(HashString64((void*)strs[i]),
+                        HashFast64((void*)strs[i], strlen(strs[i]), 0));
+    }
+
+    char buf[] = "key\0tail";
+    CU_ASSERT_EQUAL(HashString64(buf), HashString64("key"));
+}
+
+void TestMix64()
+{
+    /* The finalizer keeps zero, and flipping an input bit flips about half of
+       the output bits. */
+    CU_ASSERT_EQUAL(HashMix64(0), 0);
+
+    unsigned bit;
+    for (bit = 0 ; bit < 64 ; ++bit) {
+        uint64_t diff = HashMix64(0x123456789abcdefULL) ^
+                        HashMix64(0x123456789abcdefULL ^ (1ULL << bit));
+        int count = __builtin_popcountll(diff);
+        CU_ASSERT(count > 16 && count < 48);
+    }
+}
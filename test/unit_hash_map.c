@@ -41,6 +41,11 @@ unsigned HashKey(void* key)
     return hash;
 }
 
+uint64_t HashKey64(void* key)
+{
+    return HashFast64(key, strlen((char*)key), 0);
+}
+
 int CompareKey(void* lhs, void* rhs)
 {
     return strcmp((char*)lhs, (char*)rhs);
@@ -56,6 +61,25 @@ void CleanValue(void* value)
     free(value);
 }
 
+size_t EncodeText(void* ctx, void* item, void* buf, size_t capacity)
+{
+    size_t size = strlen((char*)item);
+    if (size <= capacity)
+        memcpy(buf, item, size);
+    return size;
+}
+
+bool DecodeText(void* ctx, const void* buf, size_t size, void** p_item)
+{
+    char* text = (char*)malloc(size + 1);
+    if (!text)
+        return false;
+    memcpy(text, buf, size);
+    text[size] = 0;
+    *p_item = text;
+    return true;
+}
+
 
 /*-----------------------------------------------------------------------------*
  *            Unit tests relevant to basic structure verification              *
@@ -145,6 +169,64 @@ void TestIterateNum()
     HashMapDeinit(map);
 }
 
+void TestExternalIterator()
+{
+    HashMap* map = HashMapInit();
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    /* The external iterators are independent of each other, so they can be
+       nested. */
+    HashMapIter outer, inner;
+    HashMapIterInit(map, &outer);
+    Pair* ptr_outer;
+    int count = 0;
+    i = 0;
+    while ((ptr_outer = HashMapIterNext(&outer)) != NULL) {
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_outer->key);
+        ++i;
+        HashMapIterInit(map, &inner);
+        while (HashMapIterNext(&inner) != NULL)
+            ++count;
+    }
+    CU_ASSERT(HashMapIterNext(&outer) == NULL);
+    CU_ASSERT_EQUAL(i, SIZE_TNY_TEST);
+    CU_ASSERT_EQUAL(count, SIZE_TNY_TEST * SIZE_TNY_TEST);
+
+    /* The external iterator should not disturb the internal one. */
+    i = 0;
+    Pair* ptr_pair;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL) {
+        HashMapIterInit(map, &inner);
+        CU_ASSERT(HashMapIterNext(&inner) != NULL);
+        ++i;
+    }
+    CU_ASSERT_EQUAL(i, SIZE_TNY_TEST);
+    HashMapDeinit(map);
+
+    /* Visit both the old and the new slot arrays during incremental
+       re-hashing. */
+    map = HashMapInit();
+    map->set_incremental_rehash(map, true);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    count = 0;
+    HashMapIterInit(map, &outer);
+    while (HashMapIterNext(&outer) != NULL)
+        ++count;
+    CU_ASSERT_EQUAL(count, SIZE_MID_TEST);
+    HashMapDeinit(map);
+
+    /* Traverse an empty map. */
+    map = HashMapInit();
+    HashMapIterInit(map, &outer);
+    CU_ASSERT(HashMapIterNext(&outer) == NULL);
+    HashMapDeinit(map);
+}
+
 void TestPutGetTxt()
 {
     char buf[SIZE_TNY_TEST];
@@ -291,6 +373,695 @@ void TestBulkTxt()
     HashMapDeinit(map);
 }
 
+void TestBatchTxt()
+{
+    char buf[SIZE_MID_STR];
+    void* keys[SIZE_MID_TEST];
+    void* values[SIZE_MID_TEST];
+    HashMap* map = HashMapInit();
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->year = i;
+        employ->level = i;
+        employ->id = i;
+        values[i] = employ;
+    }
+    CU_ASSERT(map->put_batch(map, keys, values, SIZE_MID_TEST) == true);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+
+    /* Query the keys with duplicated buffers and mixed with missing ones. */
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        if (i & 1)
+            snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        else
+            snprintf(buf, SIZE_MID_STR, "miss -> %d", i);
+        keys[i] = strdup(buf);
+    }
+    unsigned found = map->get_batch(map, keys, values, SIZE_MID_TEST);
+    CU_ASSERT_EQUAL(found, SIZE_MID_TEST >> 1);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        if (i & 1) {
+            CU_ASSERT(values[i] != NULL);
+            CU_ASSERT_EQUAL(((Employ*)values[i])->id, i);
+        } else
+            CU_ASSERT(values[i] == NULL);
+        free(keys[i]);
+    }
+
+    /* Duplicated keys in a batch are replaced in array order. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i >> 1);
+        keys[i] = strdup(buf);
+        Employ* employ = (Employ*)malloc(sizeof(Employ));
+        employ->id = i;
+        values[i] = employ;
+    }
+    CU_ASSERT(map->put_batch(map, keys, values, SIZE_TNY_TEST) == true);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        Employ* employ = (Employ*)map->get(map, (void*)buf);
+        CU_ASSERT_EQUAL(employ->id, (i << 1) + 1);
+    }
+
+    HashMapDeinit(map);
+
+    /* The batch operations should also work during incremental re-hashing. */
+    map = HashMapInit();
+    map->set_incremental_rehash(map, true);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        keys[i] = (void*)(intptr_t)i;
+        values[i] = (void*)(intptr_t)(i + 1);
+    }
+    CU_ASSERT(map->put_batch(map, keys, values, SIZE_MID_TEST) == true);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        values[i] = NULL;
+    CU_ASSERT_EQUAL(map->get_batch(map, keys, values, SIZE_MID_TEST), SIZE_MID_TEST);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT_EQUAL((int)(intptr_t)values[i], i + 1);
+    HashMapDeinit(map);
+}
+
+void TestIncrementalReHash()
+{
+    HashMap* map = HashMapInit();
+    map->set_incremental_rehash(map, true);
+
+    /* Insert enough pairs to trigger several rounds of re-hashing. */
+    int i;
+    int num = (SIZE_MID_TEST << 1) + SIZE_SML_TEST;
+    for (i = 0 ; i < num ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(map->size(map), num);
+
+    /* Each pair should be visited exactly once by the iterator while the
+       migration is still in progress. */
+    int count = 0;
+    Pair* ptr_pair;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL)
+        ++count;
+    CU_ASSERT_EQUAL(count, num);
+
+    for (i = 0 ; i < num ; ++i) {
+        int val = (int)(intptr_t)map->get(map, (void*)(intptr_t)i);
+        CU_ASSERT_EQUAL(i, val);
+    }
+
+    /* Remove the even keys. */
+    for (i = 0 ; i < num ; i += 2)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+    for (i = 0 ; i < num ; ++i)
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == (i & 1));
+    CU_ASSERT_EQUAL(map->size(map), num >> 1);
+
+    count = 0;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT(((int)(intptr_t)ptr_pair->key & 1) == 1);
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, num >> 1);
+
+    /* Switching back to one-shot mode should keep the data intact. */
+    map->set_incremental_rehash(map, false);
+    for (i = 1 ; i < num ; i += 2)
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == true);
+
+    HashMapDeinit(map);
+}
+
+static int num_hash_call;
+
+unsigned HashCount(void* key)
+{
+    ++num_hash_call;
+    return (unsigned)(intptr_t)key;
+}
+
+void TestHashCache()
+{
+    HashMap* map = HashMapInit();
+    map->set_hash(map, HashCount);
+    num_hash_call = 0;
+
+    /* The re-hashing should reuse the cached hash values. */
+    int i;
+    for (i = 1 ; i <= SIZE_MID_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(num_hash_call, SIZE_MID_TEST);
+
+    for (i = 1 ; i <= SIZE_MID_TEST ; ++i)
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(num_hash_call, SIZE_MID_TEST << 1);
+
+    HashMapDeinit(map);
+}
+
+void TestHash64()
+{
+    HashMap* map = HashMapInit();
+    map->set_hash64(map, HashKey64);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+
+    /* The string keys are hashed with the 64 bit function. */
+    char buf[SIZE_MID_STR];
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key-%d", i);
+        CU_ASSERT(map->put(map, strdup(buf), (void*)(intptr_t)i) == true);
+    }
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key-%d", i);
+        CU_ASSERT_EQUAL(map->get(map, buf), (void*)(intptr_t)i);
+    }
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2) {
+        snprintf(buf, SIZE_MID_STR, "key-%d", i);
+        CU_ASSERT(map->remove(map, buf) == true);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST >> 1);
+    HashMapDeinit(map);
+
+    /* Passing NULL restores the default hash for the pointer keys. */
+    map = HashMapInit();
+    map->set_hash64(map, HashKey64);
+    map->set_hash64(map, NULL);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT_EQUAL(map->get(map, (void*)(intptr_t)i), (void*)(intptr_t)i);
+    HashMapDeinit(map);
+}
+
+void TestPowerOfTwo()
+{
+    HashMap* map = HashMapInit();
+    CU_ASSERT(map->set_power_of_two(map, true) == true);
+    CU_ASSERT(map->set_load_factor(map, 0) == false);
+    CU_ASSERT(map->set_load_factor(map, 1.5) == true);
+
+    int i;
+    int num = SIZE_MID_TEST << 2;
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(map->size(map), num);
+
+    /* The slot layout cannot be switched for a populated map. */
+    CU_ASSERT(map->set_power_of_two(map, false) == false);
+
+    for (i = 1 ; i <= num ; i += 2)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == ((i & 1) == 0));
+    CU_ASSERT_EQUAL(map->size(map), num >> 1);
+
+    HashMapDeinit(map);
+
+    /* Combine the raw hash value with the incremental rehashing. */
+    map = HashMapInit();
+    CU_ASSERT(map->set_power_of_two(map, true) == true);
+    map->set_mix(map, NULL);
+    map->set_incremental_rehash(map, true);
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(map->contain(map, (void*)(intptr_t)i) == true);
+
+    HashMapDeinit(map);
+}
+
+static int num_alloc;
+
+void* CountAlloc(void* ctx, size_t size)
+{
+    ++num_alloc;
+    return malloc(size);
+}
+
+void CountFree(void* ctx, void* ptr)
+{
+    --num_alloc;
+    free(ptr);
+}
+
+void TestReserve()
+{
+    /* With the identity hash, each key resides in its own slot of a large
+       enough slot array, so the keys are iterated in ascending order. */
+    int num = SIZE_MID_TEST << 1;
+    HashMap* map = HashMapInitWithCapacity(num);
+    int i;
+    for (i = 0 ; i < num ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+
+    int expect = 0;
+    map->first(map);
+    Pair* ptr_pair;
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, expect);
+        ++expect;
+    }
+    CU_ASSERT_EQUAL(expect, num);
+    HashMapDeinit(map);
+
+    /* Reserve the capacity for a populated map. */
+    map = HashMapInit();
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    CU_ASSERT(map->reserve(map, 0) == true);
+    CU_ASSERT(map->reserve(map, num) == true);
+    for (i = SIZE_SML_TEST ; i < num ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    expect = 0;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, expect);
+        ++expect;
+    }
+    CU_ASSERT_EQUAL(expect, num);
+    HashMapDeinit(map);
+
+    /* Reserve the capacity during the incremental rehashing. */
+    map = HashMapInit();
+    map->set_incremental_rehash(map, true);
+    for (i = 0 ; i < num ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    CU_ASSERT(map->reserve(map, num << 2) == true);
+    for (i = 0 ; i < num ; ++i)
+        CU_ASSERT(map->get(map, (void*)(intptr_t)i) == (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(map->size(map), num);
+    HashMapDeinit(map);
+}
+
+void TestFilter()
+{
+    int num = SIZE_MID_TEST << 2;
+    int mode;
+    for (mode = 0 ; mode < 2 ; ++mode) {
+        HashMap* map = HashMapInit();
+        map->set_incremental_rehash(map, mode == 1);
+        CU_ASSERT(map->use_filter(map, true) == true);
+
+        /* The filter should follow the slot array extension. */
+        int i;
+        for (i = 0 ; i < num ; ++i)
+            CU_ASSERT(map->put(map, (void*)(intptr_t)(i << 1),
+                               (void*)(intptr_t)i) == true);
+        for (i = 0 ; i < num ; ++i) {
+            CU_ASSERT(map->get(map, (void*)(intptr_t)(i << 1)) == (void*)(intptr_t)i);
+            CU_ASSERT(map->contain(map, (void*)(intptr_t)((i << 1) + 1)) == false);
+            CU_ASSERT(map->remove(map, (void*)(intptr_t)((i << 1) + 1)) == false);
+        }
+
+        /* The removed keys are not reported even if their bits remain. */
+        for (i = 0 ; i < num ; i += 2)
+            CU_ASSERT(map->remove(map, (void*)(intptr_t)(i << 1)) == true);
+        for (i = 0 ; i < num ; ++i)
+            CU_ASSERT(map->contain(map, (void*)(intptr_t)(i << 1)) == (i % 2 == 1));
+        CU_ASSERT_EQUAL(map->size(map), num >> 1);
+
+        /* The batch operations also consult the filter. */
+        void* keys[SIZE_TNY_TEST];
+        void* values[SIZE_TNY_TEST];
+        for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+            keys[i] = (void*)(intptr_t)((num + i) << 1);
+            values[i] = (void*)(intptr_t)(num + i);
+        }
+        CU_ASSERT(map->put_batch(map, keys, values, SIZE_TNY_TEST) == true);
+        for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+            keys[i] = (void*)(intptr_t)(i + num - (SIZE_TNY_TEST >> 1));
+        CU_ASSERT_EQUAL(map->get_batch(map, keys, values, SIZE_TNY_TEST),
+                        SIZE_TNY_TEST >> 2);
+
+        /* Switch the filter off and on with a populated map. */
+        CU_ASSERT(map->use_filter(map, false) == true);
+        CU_ASSERT(map->use_filter(map, true) == true);
+        for (i = 0 ; i < num + SIZE_TNY_TEST ; ++i)
+            CU_ASSERT(map->contain(map, (void*)(intptr_t)(i << 1)) ==
+                      (i % 2 == 1 || i >= num));
+        HashMapDeinit(map);
+    }
+}
+
+unsigned HashZero(void* key)
+{
+    return 0;
+}
+
+void TestStats()
+{
+    HashMap* map = HashMapInit();
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(map->get(map, (void*)(intptr_t)i) == (void*)(intptr_t)i);
+
+    /* The structural statistics are always available. */
+    HashMapStats stats;
+    map->get_stats(map, &stats);
+    CU_ASSERT_EQUAL(stats.size, SIZE_MID_TEST);
+    CU_ASSERT(stats.num_slot > SIZE_MID_TEST);
+    CU_ASSERT(stats.load_factor > 0 && stats.load_factor < 1);
+    CU_ASSERT(stats.max_chain >= 1);
+    unsigned num_slot = 0;
+    unsigned num_key = 0;
+    for (i = 0 ; i < CDS_STATS_NUM_CHAIN ; ++i) {
+        num_slot += stats.chains[i];
+        num_key += stats.chains[i] * i;
+    }
+    CU_ASSERT_EQUAL(num_slot, stats.num_slot);
+    CU_ASSERT(num_key <= SIZE_MID_TEST);
+
+    /* The counters are maintained only in the instrumented build. */
+    if (stats.instrumented) {
+        CU_ASSERT_EQUAL(stats.num_lookup, SIZE_MID_TEST << 1);
+        CU_ASSERT(stats.num_probe >= SIZE_MID_TEST);
+        CU_ASSERT(stats.num_rehash >= 1);
+        CU_ASSERT(stats.bytes_alloc > 0);
+    } else {
+        CU_ASSERT_EQUAL(stats.num_lookup, 0);
+        CU_ASSERT_EQUAL(stats.num_rehash, 0);
+        CU_ASSERT_EQUAL(stats.bytes_alloc, 0);
+    }
+    HashMapDeinit(map);
+
+    /* All the keys collide in a single slot list. */
+    map = HashMapInit();
+    map->set_hash(map, HashZero);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    map->get_stats(map, &stats);
+    CU_ASSERT_EQUAL(stats.max_chain, SIZE_TNY_TEST);
+    CU_ASSERT_EQUAL(stats.chains[CDS_STATS_NUM_CHAIN - 1], 1);
+    CU_ASSERT_EQUAL(stats.chains[0], stats.num_slot - 1);
+    if (stats.instrumented)
+        CU_ASSERT_EQUAL(stats.num_probe,
+                        SIZE_TNY_TEST * (SIZE_TNY_TEST - 1) / 2);
+    HashMapDeinit(map);
+}
+
+void TestAllocator()
+{
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+
+    /* Apply the custom allocator to the map. */
+    HashMap* map = HashMapInit();
+    CU_ASSERT(map->set_allocator(map, &alloc) == true);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST);
+    CU_ASSERT(map->set_allocator(map, NULL) == false);
+    CU_ASSERT(map->use_pool(map) == false);
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2)
+        map->remove(map, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST >> 1);
+    HashMapDeinit(map);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* The global allocator is captured at construction. */
+    CdsSetAllocator(&alloc);
+    map = HashMapInit();
+    CdsSetAllocator(NULL);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST);
+    HashMapDeinit(map);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* Manage the nodes with the internal pool. */
+    map = HashMapInit();
+    CU_ASSERT(map->use_pool(map) == true);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)(i + 1));
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        int val = (int)(intptr_t)map->get(map, (void*)(intptr_t)i);
+        CU_ASSERT_EQUAL(val, (i & 1)? i : i + 1);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+    HashMapDeinit(map);
+}
+
+void TestInline()
+{
+    HashMap* map = HashMapInit();
+    CU_ASSERT(map->set_inline(map, sizeof(uint64_t), sizeof(uint64_t)) == true);
+    CU_ASSERT(map->use_pool(map) == true);
+
+    /* The key and value bytes are copied, so the stack variables can be
+       reused for each insertion. */
+    uint64_t key, value;
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        key = (uint64_t)i << 32;
+        value = (uint64_t)i * 3;
+        CU_ASSERT(map->put(map, &key, &value) == true);
+    }
+    CU_ASSERT(map->set_inline(map, 0, 0) == false);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        key = (uint64_t)i << 32;
+        uint64_t* ptr_val = (uint64_t*)map->get(map, &key);
+        CU_ASSERT(ptr_val != NULL);
+        if (ptr_val)
+            CU_ASSERT_EQUAL(*ptr_val, (uint64_t)i * 3);
+    }
+    key = 1;
+    CU_ASSERT(map->contain(map, &key) == false);
+
+    /* Replace and remove the pairs via the key bytes. */
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2) {
+        key = (uint64_t)i << 32;
+        value = 0;
+        CU_ASSERT(map->put(map, &key, &value) == true);
+        CU_ASSERT(map->remove(map, &key) == true);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST >> 1);
+
+    /* The iterated pairs point to the stored bytes. */
+    HashMapIter iter;
+    HashMapIterInit(map, &iter);
+    Pair* ptr_pair;
+    int count = 0;
+    while ((ptr_pair = HashMapIterNext(&iter)) != NULL) {
+        uint64_t k = *(uint64_t*)ptr_pair->key;
+        uint64_t v = *(uint64_t*)ptr_pair->value;
+        CU_ASSERT_EQUAL((k >> 32) * 3, v);
+        CU_ASSERT((k >> 32) & 1);
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, SIZE_MID_TEST >> 1);
+    HashMapDeinit(map);
+
+    /* Store the text keys inline while keeping the value pointers. Each pair
+       then costs a single allocation. */
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+    map = HashMapInit();
+    map->set_allocator(map, &alloc);
+    CU_ASSERT(map->set_inline(map, SIZE_MID_STR, 0) == true);
+    char buf[SIZE_MID_STR];
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        memset(buf, 0, SIZE_MID_STR);
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        CU_ASSERT(map->put(map, buf, (void*)(intptr_t)i) == true);
+    }
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        memset(buf, 0, SIZE_MID_STR);
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, buf), i);
+    }
+    HashMapDeinit(map);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+}
+
+/* The pair count and the value sum folded by the parallel reduction. */
+typedef struct Total_ {
+    unsigned count;
+    uint64_t sum;
+} Total;
+
+void AccumulateTotal(void* acc, void* item, void* ctx)
+{
+    Total* total = (Total*)acc;
+    ++(total->count);
+    total->sum += (uint64_t)(intptr_t)((Pair*)item)->value;
+}
+
+void CombineTotal(void* dst, const void* src, void* ctx)
+{
+    ((Total*)dst)->count += ((const Total*)src)->count;
+    ((Total*)dst)->sum += ((const Total*)src)->sum;
+}
+
+void VisitSum(Pair* ptr_pair, void* arg)
+{
+    __atomic_fetch_add((uint64_t*)arg, (uint64_t)(intptr_t)ptr_pair->value,
+                       __ATOMIC_RELAXED);
+}
+
+void TestTraverseParallel()
+{
+    HashMap* map = HashMapInit();
+    map->set_incremental_rehash(map, true);
+
+    /* Stop right after a rehashing is triggered, so that the pairs are spread
+       over both the old and the new slot arrays. */
+    int size = SIZE_MID_TEST << 6;
+    int i;
+    for (i = 0 ; i < size ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    uint64_t expect = (uint64_t)size * (size - 1) / 2;
+    unsigned num_thread;
+    for (num_thread = 1 ; num_thread <= 8 ; num_thread <<= 1) {
+        uint64_t sum = 0;
+        HashMapForEachParallel(map, VisitSum, &sum, num_thread);
+        CU_ASSERT_EQUAL(sum, expect);
+
+        Reducer reducer = {sizeof(Total), AccumulateTotal, CombineTotal, NULL};
+        Total total = {0, 0};
+        HashMapReduceParallel(map, &reducer, &total, num_thread);
+        CU_ASSERT_EQUAL(total.count, size);
+        CU_ASSERT_EQUAL(total.sum, expect);
+    }
+
+    HashMapDeinit(map);
+}
+
+void TestSnapshot()
+{
+    HashMap* map = HashMapInit();
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+
+    /* The text keys span several chunks, and the integer values need no
+       codec. */
+    int count = SIZE_MID_TEST << 3;
+    char buf[SIZE_MID_STR];
+    int i;
+    for (i = 0 ; i < count ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        map->put(map, strdup(buf), (void*)(intptr_t)i);
+    }
+
+    SnapshotCodec codec = {EncodeText, DecodeText, NULL};
+    FILE* file = tmpfile();
+    CU_ASSERT(file != NULL);
+    SnapshotWriter writer = {CdsWriteFile, file};
+    CU_ASSERT(HashMapSnapshot(map, &writer, &codec, NULL) == true);
+    HashMapDeinit(map);
+
+    /* Restore the map from the file. */
+    map = HashMapInit();
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    rewind(file);
+    SnapshotReader reader = {CdsReadFile, file};
+    CU_ASSERT(HashMapRestore(map, &reader, &codec, NULL) == true);
+    CU_ASSERT_EQUAL(map->size(map), count);
+    for (i = 0 ; i < count ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, buf), i);
+    }
+
+    /* The truncated snapshot is rejected, and the pairs restored so far are
+       kept. */
+    long size = ftell(file);
+    char* bytes = (char*)malloc(size);
+    rewind(file);
+    CU_ASSERT(fread(bytes, 1, size, file) == (size_t)size);
+    fclose(file);
+
+    SnapshotMemory memory = {bytes, size >> 1, 0};
+    reader.read = CdsReadMemory;
+    reader.ctx = &memory;
+    CU_ASSERT(HashMapRestore(map, &reader, &codec, NULL) == false);
+    CU_ASSERT_EQUAL(map->size(map), count);
+    HashMapDeinit(map);
+
+    /* Restore the map again from the memory region as if it is mmap-ed. */
+    map = HashMapInit();
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    memory.size = size;
+    memory.offset = 0;
+    CU_ASSERT(HashMapRestore(map, &reader, &codec, NULL) == true);
+    CU_ASSERT_EQUAL(map->size(map), count);
+    HashMapDeinit(map);
+
+    /* The snapshot without the end mark is rejected. */
+    bytes[size - 1] = 1;
+    map = HashMapInit();
+    map->set_hash(map, HashKey);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    memory.offset = 0;
+    CU_ASSERT(HashMapRestore(map, &reader, &codec, NULL) == false);
+    CU_ASSERT_EQUAL(map->size(map), count);
+    HashMapDeinit(map);
+    free(bytes);
+
+    /* The inline keys and values are stored as raw bytes. */
+    map = HashMapInit();
+    map->set_inline(map, sizeof(uint64_t), sizeof(uint64_t));
+    uint64_t key, value;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        key = (uint64_t)i << 32;
+        value = (uint64_t)i * 3;
+        map->put(map, &key, &value);
+    }
+    file = tmpfile();
+    writer.ctx = file;
+    CU_ASSERT(HashMapSnapshot(map, &writer, NULL, NULL) == true);
+    HashMapDeinit(map);
+
+    map = HashMapInit();
+    map->set_inline(map, sizeof(uint64_t), sizeof(uint64_t));
+    rewind(file);
+    reader.read = CdsReadFile;
+    reader.ctx = file;
+    CU_ASSERT(HashMapRestore(map, &reader, NULL, NULL) == true);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        key = (uint64_t)i << 32;
+        uint64_t* ptr_val = (uint64_t*)map->get(map, &key);
+        CU_ASSERT(ptr_val != NULL);
+        if (ptr_val)
+            CU_ASSERT_EQUAL(*ptr_val, (uint64_t)i * 3);
+    }
+    HashMapDeinit(map);
+
+    /* The key size mismatch is detected. */
+    map = HashMapInit();
+    map->set_inline(map, sizeof(uint32_t), sizeof(uint64_t));
+    rewind(file);
+    CU_ASSERT(HashMapRestore(map, &reader, NULL, NULL) == false);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    HashMapDeinit(map);
+    fclose(file);
+}
 
 /*-----------------------------------------------------------------------------*
  *                      The driver for HashMap unit test                       *
@@ -318,6 +1089,10 @@ bool AddSuite()
         unit = CU_add_test(suite, "Map Iterator", TestIterateNum);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Map External Iterator", TestExternalIterator);
+        if (!unit)
+            return false;
     }
     {
         /* Test its robustness to maintain complex data types and large data set. */
@@ -340,6 +1115,54 @@ bool AddSuite()
         unit = CU_add_test(suite, "Large Amount Pair Maintenance", TestBulkTxt);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Batch Put and Get", TestBatchTxt);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Incremental Re-hashing", TestIncrementalReHash);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Hash Value Caching", TestHashCache);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "64 Bit Hash Function", TestHash64);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Power-of-two Slot Array", TestPowerOfTwo);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Capacity Reservation", TestReserve);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Bloom Filter in Front of Slot Array", TestFilter);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Runtime Statistics", TestStats);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Pair Allocation via Allocator and Pool", TestAllocator);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Inline Key and Value Storage", TestInline);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Snapshot and Restore", TestSnapshot);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Parallel Traversal", TestTraverseParallel);
+        if (!unit)
+            return false;
     }
     return true;
 }
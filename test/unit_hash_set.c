@@ -1,4 +1,5 @@
 #include "container/hash_set.h"
+#include "math/hash.h"
 #include "CUnit/Util.h"
 #include "CUnit/Basic.h"
 
@@ -27,6 +28,11 @@ unsigned HashKey(void* key)
     return hash;
 }
 
+uint64_t HashKey64(void* key)
+{
+    return HashFast64(key, strlen((char*)key), 0);
+}
+
 int CompareKey(void* lhs, void* rhs)
 {
     return strcmp((char*)lhs, (char*)rhs);
@@ -124,6 +130,47 @@ void TestIterateNum()
     HashSetDeinit(set);
 }
 
+void TestExternalIterator()
+{
+    HashSet* set = HashSetInit();
+
+    int i;
+    for (i = 1 ; i < SIZE_TNY_TEST ; ++i)
+        set->add(set, (void*)(intptr_t)i);
+
+    /* The external iterators are independent of each other, so they can be
+       nested. */
+    HashSetIter outer, inner;
+    HashSetIterInit(set, &outer);
+    void* key;
+    int count = 0;
+    i = 1;
+    while ((key = HashSetIterNext(&outer)) != NULL) {
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)key);
+        ++i;
+        HashSetIterInit(set, &inner);
+        while (HashSetIterNext(&inner) != NULL)
+            ++count;
+    }
+    CU_ASSERT(HashSetIterNext(&outer) == NULL);
+    CU_ASSERT_EQUAL(i, SIZE_TNY_TEST);
+    CU_ASSERT_EQUAL(count, (SIZE_TNY_TEST - 1) * (SIZE_TNY_TEST - 1));
+    HashSetDeinit(set);
+
+    /* Visit both the old and the new slot arrays during incremental
+       re-hashing. */
+    set = HashSetInit();
+    set->set_incremental_rehash(set, true);
+    for (i = 1 ; i <= SIZE_MID_TEST ; ++i)
+        set->add(set, (void*)(intptr_t)i);
+    count = 0;
+    HashSetIterInit(set, &outer);
+    while (HashSetIterNext(&outer) != NULL)
+        ++count;
+    CU_ASSERT_EQUAL(count, SIZE_MID_TEST);
+    HashSetDeinit(set);
+}
+
 
 /*-----------------------------------------------------------------------------*
  *              Unit tests relevant to complex data maintenance                *
@@ -470,6 +517,474 @@ void TestDifferenceOperation()
         free(keys[i]);
 }
 
+HashSet* CreateTxtSet(char** keys, int bgn, int end)
+{
+    HashSet* set = HashSetInit();
+    set->set_hash(set, HashKey);
+    set->set_compare(set, CompareKey);
+    int i;
+    for (i = bgn ; i < end ; ++i)
+        set->add(set, keys[i]);
+    return set;
+}
+
+void CheckTxtSet(HashSet* set, char** keys, int bgn, int end)
+{
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(set->find(set, keys[i]) == (i >= bgn && i < end));
+    CU_ASSERT_EQUAL(set->size(set), end - bgn);
+}
+
+void TestInPlaceOperation()
+{
+    char buf[SIZE_TNY_TEST];
+    char* keys[SIZE_MID_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key -> %d", i);
+        keys[i] = strdup(buf);
+    }
+    int half = SIZE_MID_TEST >> 1;
+    int quarter = SIZE_MID_TEST >> 2;
+    int num_thread;
+
+    for (num_thread = 1 ; num_thread <= 4 ; num_thread += 3) {
+        /* Merge the overlapped sets. */
+        HashSet* set_lhs = CreateTxtSet(keys, 0, SIZE_MID_TEST - quarter);
+        HashSet* set_rhs = CreateTxtSet(keys, quarter, SIZE_MID_TEST);
+        CU_ASSERT(HashSetUnionIntoParallel(set_lhs, set_rhs, num_thread) == true);
+        CheckTxtSet(set_lhs, keys, 0, SIZE_MID_TEST);
+        CheckTxtSet(set_rhs, keys, quarter, SIZE_MID_TEST);
+        HashSetDeinit(set_lhs);
+        HashSetDeinit(set_rhs);
+
+        /* Retain against the smaller and the larger source sets. */
+        set_lhs = CreateTxtSet(keys, 0, SIZE_MID_TEST - quarter);
+        set_rhs = CreateTxtSet(keys, half, SIZE_MID_TEST);
+        HashSetRetainParallel(set_lhs, set_rhs, num_thread);
+        CheckTxtSet(set_lhs, keys, half, SIZE_MID_TEST - quarter);
+        HashSetRetainParallel(set_rhs, set_lhs, num_thread);
+        CheckTxtSet(set_rhs, keys, half, SIZE_MID_TEST - quarter);
+        HashSetDeinit(set_lhs);
+        HashSetDeinit(set_rhs);
+
+        set_lhs = CreateTxtSet(keys, half, SIZE_MID_TEST);
+        set_rhs = CreateTxtSet(keys, 0, SIZE_MID_TEST - quarter);
+        HashSetRetainParallel(set_lhs, set_rhs, num_thread);
+        CheckTxtSet(set_lhs, keys, half, SIZE_MID_TEST - quarter);
+        HashSetDeinit(set_lhs);
+        HashSetDeinit(set_rhs);
+
+        /* Subtract the smaller and the larger source sets. */
+        set_lhs = CreateTxtSet(keys, 0, SIZE_MID_TEST - quarter);
+        set_rhs = CreateTxtSet(keys, half, SIZE_MID_TEST);
+        HashSetSubtractParallel(set_lhs, set_rhs, num_thread);
+        CheckTxtSet(set_lhs, keys, 0, half);
+        HashSetDeinit(set_lhs);
+        HashSetDeinit(set_rhs);
+
+        set_lhs = CreateTxtSet(keys, half, SIZE_MID_TEST);
+        set_rhs = CreateTxtSet(keys, 0, SIZE_MID_TEST - quarter);
+        HashSetSubtractParallel(set_lhs, set_rhs, num_thread);
+        CheckTxtSet(set_lhs, keys, SIZE_MID_TEST - quarter, SIZE_MID_TEST);
+        HashSetSubtractParallel(set_lhs, set_lhs, num_thread);
+        CheckTxtSet(set_lhs, keys, 0, 0);
+        HashSetDeinit(set_lhs);
+        HashSetDeinit(set_rhs);
+    }
+
+    /* The serial in-place operations without the reusable cached hash values,
+       and the removed keys are cleaned. */
+    HashSet* set_lhs = HashSetInit();
+    set_lhs->set_hash64(set_lhs, HashKey64);
+    set_lhs->set_compare(set_lhs, CompareKey);
+    set_lhs->set_clean_key(set_lhs, CleanKey);
+    for (i = 0 ; i < half ; ++i)
+        set_lhs->add(set_lhs, strdup(keys[i]));
+    HashSet* set_rhs = CreateTxtSet(keys, quarter, SIZE_MID_TEST);
+    HashSetRetain(set_lhs, set_rhs);
+    CheckTxtSet(set_lhs, keys, quarter, half);
+    HashSetSubtract(set_lhs, set_rhs);
+    CheckTxtSet(set_lhs, keys, 0, 0);
+    HashSetDeinit(set_rhs);
+
+    set_rhs = CreateTxtSet(keys, 0, half);
+    set_rhs->set_clean_key(set_rhs, NULL);
+    set_lhs->set_clean_key(set_lhs, NULL);
+    CU_ASSERT(HashSetUnionInto(set_lhs, set_rhs) == true);
+    CheckTxtSet(set_lhs, keys, 0, half);
+    HashSetDeinit(set_lhs);
+    HashSetDeinit(set_rhs);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        free(keys[i]);
+}
+
+void TestIncrementalReHash()
+{
+    HashSet* set = HashSetInit();
+    set->set_incremental_rehash(set, true);
+
+    /* Insert enough keys to trigger several rounds of re-hashing. */
+    int i;
+    int num = (SIZE_MID_TEST << 1) + SIZE_SML_TEST;
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(set->add(set, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(set->size(set), num);
+
+    /* Each key should be visited exactly once by the iterator while the
+       migration is still in progress. */
+    int count = 0;
+    void* key;
+    set->first(set);
+    while ((key = set->next(set)) != NULL)
+        ++count;
+    CU_ASSERT_EQUAL(count, num);
+
+    /* Remove the even keys. */
+    for (i = 2 ; i <= num ; i += 2)
+        CU_ASSERT(set->remove(set, (void*)(intptr_t)i) == true);
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(set->find(set, (void*)(intptr_t)i) == (i & 1));
+    CU_ASSERT_EQUAL(set->size(set), num >> 1);
+
+    count = 0;
+    set->first(set);
+    while ((key = set->next(set)) != NULL) {
+        CU_ASSERT(((int)(intptr_t)key & 1) == 1);
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, num >> 1);
+
+    /* The set operations should see the keys not yet migrated. */
+    HashSet* other = HashSetInit();
+    other->set_incremental_rehash(other, true);
+    for (i = 1 ; i <= SIZE_SML_TEST << 1 ; ++i)
+        other->add(other, (void*)(intptr_t)i);
+    HashSet* result = HashSetIntersect(set, other);
+    CU_ASSERT(result != NULL);
+    CU_ASSERT_EQUAL(result->size(result), SIZE_SML_TEST);
+    HashSetDeinit(result);
+    HashSetDeinit(other);
+
+    HashSetDeinit(set);
+}
+
+static int num_hash_call;
+
+unsigned HashCount(void* key)
+{
+    ++num_hash_call;
+    return (unsigned)(intptr_t)key;
+}
+
+void TestHashCache()
+{
+    HashSet* set = HashSetInit();
+    set->set_hash(set, HashCount);
+    num_hash_call = 0;
+
+    /* The re-hashing should reuse the cached hash values. */
+    int i;
+    for (i = 1 ; i <= SIZE_MID_TEST ; ++i)
+        CU_ASSERT(set->add(set, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(num_hash_call, SIZE_MID_TEST);
+
+    for (i = 1 ; i <= SIZE_MID_TEST ; ++i)
+        CU_ASSERT(set->find(set, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(num_hash_call, SIZE_MID_TEST << 1);
+
+    HashSetDeinit(set);
+}
+
+void TestHash64()
+{
+    HashSet* set = HashSetInit();
+    set->set_hash64(set, HashKey64);
+    set->set_compare(set, CompareKey);
+    set->set_clean_key(set, CleanKey);
+
+    /* The string keys are hashed with the 64 bit function. */
+    char buf[SIZE_TNY_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key-%d", i);
+        CU_ASSERT(set->add(set, strdup(buf)) == true);
+    }
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key-%d", i);
+        CU_ASSERT(set->find(set, buf) == true);
+    }
+
+    /* The derived set inherits the 64 bit function. */
+    HashSet* other = HashSetInit();
+    other->set_hash64(other, HashKey64);
+    other->set_compare(other, CompareKey);
+    HashSet* result = HashSetUnion(set, other);
+    CU_ASSERT(result != NULL);
+    CU_ASSERT_EQUAL(result->size(result), SIZE_MID_TEST);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_TNY_TEST, "key-%d", i);
+        CU_ASSERT(result->find(result, buf) == true);
+    }
+
+    HashSetDeinit(result);
+    HashSetDeinit(other);
+    HashSetDeinit(set);
+}
+
+void TestPowerOfTwo()
+{
+    HashSet* set = HashSetInit();
+    CU_ASSERT(set->set_power_of_two(set, true) == true);
+    CU_ASSERT(set->set_load_factor(set, 0) == false);
+    CU_ASSERT(set->set_load_factor(set, 1.5) == true);
+
+    int i;
+    int num = SIZE_MID_TEST << 2;
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(set->add(set, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(set->size(set), num);
+
+    /* The slot layout cannot be switched for a populated set. */
+    CU_ASSERT(set->set_power_of_two(set, false) == false);
+
+    for (i = 1 ; i <= num ; i += 2)
+        CU_ASSERT(set->remove(set, (void*)(intptr_t)i) == true);
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(set->find(set, (void*)(intptr_t)i) == ((i & 1) == 0));
+    CU_ASSERT_EQUAL(set->size(set), num >> 1);
+
+    HashSetDeinit(set);
+
+    /* Combine the raw hash value with the incremental rehashing. */
+    set = HashSetInit();
+    CU_ASSERT(set->set_power_of_two(set, true) == true);
+    set->set_mix(set, NULL);
+    set->set_incremental_rehash(set, true);
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(set->add(set, (void*)(intptr_t)i) == true);
+    for (i = 1 ; i <= num ; ++i)
+        CU_ASSERT(set->find(set, (void*)(intptr_t)i) == true);
+
+    HashSetDeinit(set);
+}
+
+void TestReserve()
+{
+    /* With the identity hash, each key resides in its own slot of a large
+       enough slot array, so the keys are iterated in ascending order. */
+    int num = SIZE_MID_TEST << 1;
+    HashSet* set = HashSetInitWithCapacity(num);
+    int i;
+    for (i = 0 ; i < num ; ++i)
+        CU_ASSERT(set->add(set, (void*)(intptr_t)(i + 1)) == true);
+
+    int expect = 0;
+    set->first(set);
+    void* key;
+    while ((key = set->next(set)) != NULL) {
+        CU_ASSERT_EQUAL((int)(intptr_t)key - 1, expect);
+        ++expect;
+    }
+    CU_ASSERT_EQUAL(expect, num);
+    HashSetDeinit(set);
+
+    /* Reserve the capacity for a populated set. */
+    set = HashSetInit();
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        set->add(set, (void*)(intptr_t)(i + 1));
+    CU_ASSERT(set->reserve(set, 0) == true);
+    CU_ASSERT(set->reserve(set, num) == true);
+    for (i = SIZE_SML_TEST ; i < num ; ++i)
+        set->add(set, (void*)(intptr_t)(i + 1));
+
+    expect = 0;
+    set->first(set);
+    while ((key = set->next(set)) != NULL) {
+        CU_ASSERT_EQUAL((int)(intptr_t)key - 1, expect);
+        ++expect;
+    }
+    CU_ASSERT_EQUAL(expect, num);
+    HashSetDeinit(set);
+
+    /* Reserve the capacity during the incremental rehashing. */
+    set = HashSetInit();
+    set->set_incremental_rehash(set, true);
+    for (i = 0 ; i < num ; ++i)
+        set->add(set, (void*)(intptr_t)(i + 1));
+    CU_ASSERT(set->reserve(set, num << 2) == true);
+    for (i = 0 ; i < num ; ++i)
+        CU_ASSERT(set->find(set, (void*)(intptr_t)(i + 1)) == true);
+    CU_ASSERT_EQUAL(set->size(set), num);
+    HashSetDeinit(set);
+}
+
+static int num_alloc;
+
+void* CountAlloc(void* ctx, size_t size)
+{
+    ++num_alloc;
+    return malloc(size);
+}
+
+void CountFree(void* ctx, void* ptr)
+{
+    --num_alloc;
+    free(ptr);
+}
+
+void TestFilter()
+{
+    int num = SIZE_MID_TEST << 2;
+    int mode;
+    for (mode = 0 ; mode < 2 ; ++mode) {
+        HashSet* set = HashSetInit();
+        set->set_incremental_rehash(set, mode == 1);
+        CU_ASSERT(set->use_filter(set, true) == true);
+
+        /* The filter should follow the slot array extension. */
+        int i;
+        for (i = 0 ; i < num ; ++i)
+            CU_ASSERT(set->add(set, (void*)(intptr_t)(i << 1)) == true);
+        for (i = 0 ; i < num ; ++i) {
+            CU_ASSERT(set->find(set, (void*)(intptr_t)(i << 1)) == true);
+            CU_ASSERT(set->find(set, (void*)(intptr_t)((i << 1) + 1)) == false);
+            CU_ASSERT(set->remove(set, (void*)(intptr_t)((i << 1) + 1)) == false);
+        }
+
+        /* The removed keys are not reported even if their bits remain. */
+        for (i = 0 ; i < num ; i += 2)
+            CU_ASSERT(set->remove(set, (void*)(intptr_t)(i << 1)) == true);
+        for (i = 0 ; i < num ; ++i)
+            CU_ASSERT(set->find(set, (void*)(intptr_t)(i << 1)) == (i % 2 == 1));
+        CU_ASSERT_EQUAL(set->size(set), num >> 1);
+
+        /* The filter of the designated set covers the merged keys. */
+        HashSet* other = HashSetInit();
+        CU_ASSERT(other->use_filter(other, true) == true);
+        for (i = 0 ; i < num ; i += 2)
+            other->add(other, (void*)(intptr_t)(i << 1));
+        CU_ASSERT(HashSetUnionInto(set, other) == true);
+        for (i = 0 ; i < num ; ++i)
+            CU_ASSERT(set->find(set, (void*)(intptr_t)(i << 1)) == true);
+        HashSetSubtract(set, other);
+        for (i = 0 ; i < num ; ++i)
+            CU_ASSERT(set->find(set, (void*)(intptr_t)(i << 1)) == (i % 2 == 1));
+        HashSetDeinit(other);
+
+        /* Switch the filter off and on with a populated set. */
+        CU_ASSERT(set->use_filter(set, false) == true);
+        CU_ASSERT(set->use_filter(set, true) == true);
+        CU_ASSERT(set->use_filter(set, true) == true);
+        for (i = 0 ; i < num ; ++i)
+            CU_ASSERT(set->find(set, (void*)(intptr_t)(i << 1)) == (i % 2 == 1));
+        HashSetDeinit(set);
+    }
+}
+
+unsigned HashZero(void* key)
+{
+    return 0;
+}
+
+void TestStats()
+{
+    HashSet* set = HashSetInit();
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        set->add(set, (void*)(intptr_t)i);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(set->find(set, (void*)(intptr_t)i) == true);
+
+    /* The structural statistics are always available. */
+    HashSetStats stats;
+    set->get_stats(set, &stats);
+    CU_ASSERT_EQUAL(stats.size, SIZE_MID_TEST);
+    CU_ASSERT(stats.num_slot > SIZE_MID_TEST);
+    CU_ASSERT(stats.load_factor > 0 && stats.load_factor < 1);
+    CU_ASSERT(stats.max_chain >= 1);
+    unsigned num_slot = 0;
+    unsigned num_key = 0;
+    for (i = 0 ; i < CDS_STATS_NUM_CHAIN ; ++i) {
+        num_slot += stats.chains[i];
+        num_key += stats.chains[i] * i;
+    }
+    CU_ASSERT_EQUAL(num_slot, stats.num_slot);
+    CU_ASSERT(num_key <= SIZE_MID_TEST);
+
+    /* The counters are maintained only in the instrumented build. */
+    if (stats.instrumented) {
+        CU_ASSERT_EQUAL(stats.num_lookup, SIZE_MID_TEST << 1);
+        CU_ASSERT(stats.num_probe >= SIZE_MID_TEST);
+        CU_ASSERT(stats.num_rehash >= 1);
+        CU_ASSERT(stats.bytes_alloc > 0);
+    } else {
+        CU_ASSERT_EQUAL(stats.num_lookup, 0);
+        CU_ASSERT_EQUAL(stats.num_rehash, 0);
+        CU_ASSERT_EQUAL(stats.bytes_alloc, 0);
+    }
+    HashSetDeinit(set);
+
+    /* All the keys collide in a single slot list. */
+    set = HashSetInit();
+    set->set_hash(set, HashZero);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        set->add(set, (void*)(intptr_t)i);
+    set->get_stats(set, &stats);
+    CU_ASSERT_EQUAL(stats.max_chain, SIZE_TNY_TEST);
+    CU_ASSERT_EQUAL(stats.chains[CDS_STATS_NUM_CHAIN - 1], 1);
+    CU_ASSERT_EQUAL(stats.chains[0], stats.num_slot - 1);
+    if (stats.instrumented)
+        CU_ASSERT_EQUAL(stats.num_probe,
+                        SIZE_TNY_TEST * (SIZE_TNY_TEST - 1) / 2);
+    HashSetDeinit(set);
+}
+
+void TestAllocator()
+{
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+
+    /* Apply the custom allocator to the set. */
+    HashSet* set = HashSetInit();
+    CU_ASSERT(set->set_allocator(set, &alloc) == true);
+    int i;
+    for (i = 1 ; i <= SIZE_SML_TEST ; ++i)
+        set->add(set, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST);
+    CU_ASSERT(set->set_allocator(set, NULL) == false);
+    CU_ASSERT(set->use_pool(set) == false);
+    for (i = 2 ; i <= SIZE_SML_TEST ; i += 2)
+        set->remove(set, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST >> 1);
+    HashSetDeinit(set);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* The global allocator is captured at construction. */
+    CdsSetAllocator(&alloc);
+    set = HashSetInit();
+    CdsSetAllocator(NULL);
+    for (i = 1 ; i <= SIZE_SML_TEST ; ++i)
+        set->add(set, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST);
+    HashSetDeinit(set);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* Manage the nodes with the internal pool. */
+    set = HashSetInit();
+    CU_ASSERT(set->use_pool(set) == true);
+    for (i = 1 ; i <= SIZE_MID_TEST ; ++i)
+        set->add(set, (void*)(intptr_t)i);
+    for (i = 2 ; i <= SIZE_MID_TEST ; i += 2)
+        CU_ASSERT(set->remove(set, (void*)(intptr_t)i) == true);
+    for (i = 1 ; i <= SIZE_MID_TEST ; ++i)
+        CU_ASSERT(set->find(set, (void*)(intptr_t)i) == (i & 1));
+    CU_ASSERT_EQUAL(set->size(set), SIZE_MID_TEST >> 1);
+    HashSetDeinit(set);
+}
+
 
 /*-----------------------------------------------------------------------------*
  *                      The driver for HashSet unit test                       *
@@ -497,6 +1012,10 @@ bool AddSuite()
         unit = CU_add_test(suite, "Set Iterator", TestIterateNum);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Set External Iterator", TestExternalIterator);
+        if (!unit)
+            return false;
     }
     {
         /* Test its robustness to maintain complex data types and large data set. */
@@ -519,6 +1038,34 @@ bool AddSuite()
         unit = CU_add_test(suite, "Large Amount Key Maintenance", TestBulkTxt);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Incremental Re-hashing", TestIncrementalReHash);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Hash Value Caching", TestHashCache);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "64 Bit Hash Function", TestHash64);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Power-of-two Slot Array", TestPowerOfTwo);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Capacity Reservation", TestReserve);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Bloom Filter in Front of Slot Array", TestFilter);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Runtime Statistics", TestStats);
+        if (!unit)
+            return false;
     }
     {
         /* Test set arithmetic operation. */
@@ -537,6 +1084,14 @@ bool AddSuite()
         unit = CU_add_test(suite, "Difference", TestDifferenceOperation);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "In-place Operations", TestInPlaceOperation);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Key Allocation via Allocator and Pool", TestAllocator);
+        if (!unit)
+            return false;
     }
     return true;
 }
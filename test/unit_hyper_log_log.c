@@ -0,0 +1,215 @@
+#include "container/hyper_log_log.h"
+#include "math/hash.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_SML_TEST = 1000;
+static const int SIZE_BIG_TEST = 200000;
+
+
+/*-----------------------------------------------------------------------------*
+ *                   The utilities for estimate verification                   *
+ *-----------------------------------------------------------------------------*/
+/* Check if the estimate lies within the designated relative error. */
+bool Near(uint64_t estimate, uint64_t expect, double error)
+{
+    double diff = (double)estimate - (double)expect;
+    if (diff < 0)
+        diff = -diff;
+    return diff <= error * (double)expect;
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    HyperLogLog* hll = HyperLogLogInit(0);
+    CU_ASSERT(hll != NULL);
+    CU_ASSERT_EQUAL(hll->precision(hll), 14);
+    CU_ASSERT_EQUAL(hll->count(hll), 0);
+    HyperLogLogDeinit(hll);
+
+    hll = HyperLogLogInit(4);
+    CU_ASSERT(hll != NULL);
+    CU_ASSERT_EQUAL(hll->precision(hll), 4);
+    HyperLogLogDeinit(hll);
+
+    /* Deinitializing a null estimator should be harmless. */
+    HyperLogLogDeinit(NULL);
+}
+
+void TestAddCount()
+{
+    HyperLogLog* hll = HyperLogLogInit(14);
+
+    /* The duplicated keys should not inflate the estimate. */
+    int i, j;
+    for (j = 0 ; j < 4 ; ++j) {
+        for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+            hll->add(hll, (void*)(intptr_t)i);
+    }
+    CU_ASSERT(Near(hll->count(hll), SIZE_SML_TEST, 0.02));
+
+    /* The standard error is 0.81% for the default precision. */
+    for (i = SIZE_SML_TEST ; i < SIZE_BIG_TEST ; ++i)
+        hll->add(hll, (void*)(intptr_t)i);
+    CU_ASSERT(Near(hll->count(hll), SIZE_BIG_TEST, 0.03));
+
+    hll->clear(hll);
+    CU_ASSERT_EQUAL(hll->count(hll), 0);
+
+    HyperLogLogDeinit(hll);
+}
+
+void TestCustomHash()
+{
+    HyperLogLog* hll = HyperLogLogInit(12);
+    hll->set_hash(hll, HashString64);
+
+    char buf[32];
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        snprintf(buf, sizeof(buf), "user%012d", i % (SIZE_BIG_TEST / 2));
+        hll->add(hll, buf);
+    }
+    CU_ASSERT(Near(hll->count(hll), SIZE_BIG_TEST / 2, 0.06));
+
+    /* The weak precomputed hash values are scrambled before use. */
+    hll->clear(hll);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        hll->add_hash(hll, (uint64_t)i);
+    CU_ASSERT(Near(hll->count(hll), SIZE_SML_TEST, 0.06));
+
+    HyperLogLogDeinit(hll);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to complex data maintenance                  *
+ *-----------------------------------------------------------------------------*/
+void TestMerge()
+{
+    HyperLogLog* whole = HyperLogLogInit(12);
+    HyperLogLog* lhs = HyperLogLogInit(12);
+    HyperLogLog* rhs = HyperLogLogInit(12);
+
+    /* The halves overlap, so the merge counts the union. */
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        void* key = (void*)(intptr_t)i;
+        whole->add(whole, key);
+        if (i < SIZE_BIG_TEST * 2 / 3)
+            lhs->add(lhs, key);
+        if (i >= SIZE_BIG_TEST / 3)
+            rhs->add(rhs, key);
+    }
+    CU_ASSERT(lhs->merge(lhs, rhs) == true);
+    CU_ASSERT_EQUAL(lhs->count(lhs), whole->count(whole));
+
+    HyperLogLog* other = HyperLogLogInit(10);
+    CU_ASSERT(lhs->merge(lhs, other) == false);
+
+    HyperLogLogDeinit(other);
+    HyperLogLogDeinit(rhs);
+    HyperLogLogDeinit(lhs);
+    HyperLogLogDeinit(whole);
+}
+
+void TestSnapshot()
+{
+    HyperLogLog* hll = HyperLogLogInit(0);
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i)
+        hll->add(hll, (void*)(intptr_t)i);
+
+    FILE* file = tmpfile();
+    CU_ASSERT(file != NULL);
+    SnapshotWriter writer = {CdsWriteFile, file};
+    CU_ASSERT(HyperLogLogSnapshot(hll, &writer) == true);
+
+    /* Restoring into the empty estimator copies it. */
+    HyperLogLog* copy = HyperLogLogInit(0);
+    rewind(file);
+    SnapshotReader reader = {CdsReadFile, file};
+    CU_ASSERT(HyperLogLogRestore(copy, &reader) == true);
+    CU_ASSERT_EQUAL(copy->count(copy), hll->count(hll));
+    CU_ASSERT(HyperLogLogRestore(copy, &reader) == false);
+
+    /* The estimator with a different precision rejects the snapshot. */
+    HyperLogLog* other = HyperLogLogInit(10);
+    rewind(file);
+    CU_ASSERT(HyperLogLogRestore(other, &reader) == false);
+    CU_ASSERT_EQUAL(other->count(other), 0);
+    fclose(file);
+
+    HyperLogLogDeinit(other);
+    HyperLogLogDeinit(copy);
+    HyperLogLogDeinit(hll);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                    The driver for HyperLogLog unit test                     *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Key Insertion and Count", TestAddCount);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Custom Hash Function", TestCustomHash);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Merge", TestMerge);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Snapshot and Restore", TestSnapshot);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for HyperLogLog structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
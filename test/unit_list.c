@@ -444,6 +444,251 @@ void TestIterator()
     ListDeinit(list);
 }
 
+void TestExternalIterator()
+{
+    List* list = ListInit();
+
+    /* Traverse an empty list. */
+    ListIter fwd, rev;
+    void* elem_fwd;
+    void* elem_rev;
+    ListIterInit(list, &fwd, false);
+    CU_ASSERT(ListIterNext(&fwd, &elem_fwd) == false);
+
+    int i;
+    for (i = 1 ; i <= 4 ; ++i)
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)i) == true);
+
+    /* Run the forward and the reverse iterators simultaneously. */
+    ListIterInit(list, &fwd, false);
+    ListIterInit(list, &rev, true);
+    for (i = 1 ; i <= 4 ; ++i) {
+        CU_ASSERT(ListIterNext(&fwd, &elem_fwd) == true);
+        CU_ASSERT(ListIterNext(&rev, &elem_rev) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)elem_fwd, i);
+        CU_ASSERT_EQUAL((int)(intptr_t)elem_rev, 5 - i);
+    }
+    CU_ASSERT(ListIterNext(&fwd, &elem_fwd) == false);
+    CU_ASSERT(ListIterNext(&rev, &elem_rev) == false);
+
+    ListDeinit(list);
+}
+
+void CheckSequence(List* list, const int* expect, unsigned size)
+{
+    CU_ASSERT_EQUAL(list->size(list), size);
+
+    /* Walk the handles in both directions. */
+    unsigned i = 0;
+    ListHandle node = list->front_handle(list);
+    while (node) {
+        CU_ASSERT(i < size);
+        if (i >= size)
+            return;
+        CU_ASSERT_EQUAL((int)(intptr_t)ListHandleGet(node), expect[i]);
+        node = list->next_handle(list, node);
+        ++i;
+    }
+    CU_ASSERT_EQUAL(i, size);
+
+    node = list->back_handle(list);
+    while (node) {
+        CU_ASSERT(i > 0);
+        if (i == 0)
+            return;
+        --i;
+        CU_ASSERT_EQUAL((int)(intptr_t)ListHandleGet(node), expect[i]);
+        node = list->prev_handle(list, node);
+    }
+    CU_ASSERT_EQUAL(i, 0);
+}
+
+void TestHandle()
+{
+    List* list = ListInit();
+    CU_ASSERT(list->front_handle(list) == NULL);
+    CU_ASSERT(list->back_handle(list) == NULL);
+
+    /* Insert the elements around the captured handles. */
+    ListHandle two = list->push_back_handle(list, (void*)(intptr_t)2);
+    ListHandle four = list->push_back_handle(list, (void*)(intptr_t)4);
+    ListHandle one = list->push_front_handle(list, (void*)(intptr_t)1);
+    CU_ASSERT(two && four && one);
+    CU_ASSERT(list->insert_after(list, two, (void*)(intptr_t)3) != NULL);
+    CU_ASSERT(list->insert_after(list, four, (void*)(intptr_t)5) != NULL);
+    ListHandle zero = list->insert_before(list, one, (void*)(intptr_t)0);
+    CU_ASSERT(zero == list->front_handle(list));
+    {
+        int expect[] = {0, 1, 2, 3, 4, 5};
+        CheckSequence(list, expect, 6);
+    }
+
+    /* Replace and erase the elements via the handles. */
+    ListHandleSet(two, (void*)(intptr_t)20);
+    list->erase(list, zero);
+    list->erase(list, list->back_handle(list));
+    list->erase(list, four);
+    {
+        int expect[] = {1, 20, 3};
+        CheckSequence(list, expect, 3);
+    }
+
+    /* The handles stay valid while the other nodes are updated. */
+    CU_ASSERT(list->pop_front(list) == true);
+    CU_ASSERT_EQUAL((int)(intptr_t)ListHandleGet(two), 20);
+    list->erase(list, two);
+    list->erase(list, list->front_handle(list));
+    CU_ASSERT_EQUAL(list->size(list), 0);
+    CU_ASSERT(list->front_handle(list) == NULL);
+
+    /* The handles cleanup the erased elements. */
+    list->set_clean(list, CleanElement);
+    ListHandle node = list->push_back_handle(list, malloc(sizeof(int)));
+    list->push_back_handle(list, malloc(sizeof(int)));
+    list->erase(list, node);
+    CU_ASSERT_EQUAL(list->size(list), 1);
+
+    ListDeinit(list);
+}
+
+void TestSplice()
+{
+    List* dst = ListInit();
+    List* src = ListInit();
+
+    int i;
+    ListHandle handles[8];
+    for (i = 0 ; i < 4 ; ++i)
+        dst->push_back(dst, (void*)(intptr_t)i);
+    for (i = 0 ; i < 8 ; ++i)
+        handles[i] = src->push_back_handle(src, (void*)(intptr_t)(10 + i));
+
+    /* Move the middle range of the source before the designated node. */
+    ListHandle pos = dst->next_handle(dst, dst->front_handle(dst));
+    CU_ASSERT(dst->splice(dst, pos, src, handles[2], handles[4]) == true);
+    {
+        int expect_dst[] = {0, 12, 13, 14, 1, 2, 3};
+        int expect_src[] = {10, 11, 15, 16, 17};
+        CheckSequence(dst, expect_dst, 7);
+        CheckSequence(src, expect_src, 5);
+    }
+
+    /* Move the source head to the front and the source tail to the back. */
+    CU_ASSERT(dst->splice(dst, dst->front_handle(dst), src, handles[0],
+                          handles[0]) == true);
+    CU_ASSERT(dst->splice(dst, NULL, src, handles[7], handles[7]) == true);
+    {
+        int expect_dst[] = {10, 0, 12, 13, 14, 1, 2, 3, 17};
+        int expect_src[] = {11, 15, 16};
+        CheckSequence(dst, expect_dst, 9);
+        CheckSequence(src, expect_src, 3);
+    }
+
+    /* Rotate the range within the same list. */
+    CU_ASSERT(dst->splice(dst, NULL, dst, handles[2], handles[4]) == true);
+    CU_ASSERT(dst->splice(dst, NULL, dst, dst->front_handle(dst),
+                          dst->back_handle(dst)) == true);
+    {
+        int expect_dst[] = {10, 0, 1, 2, 3, 17, 12, 13, 14};
+        CheckSequence(dst, expect_dst, 9);
+    }
+
+    /* Drain the whole source into an empty list. */
+    List* empty = ListInit();
+    CU_ASSERT(empty->splice(empty, NULL, src, src->front_handle(src),
+                            src->back_handle(src)) == true);
+    {
+        int expect[] = {11, 15, 16};
+        CheckSequence(empty, expect, 3);
+    }
+    CU_ASSERT_EQUAL(src->size(src), 0);
+    CU_ASSERT(src->front_handle(src) == NULL);
+
+    /* The nodes cannot cross the lists with different allocators. */
+    CU_ASSERT(src->use_pool(src) == true);
+    src->push_back(src, (void*)(intptr_t)99);
+    CU_ASSERT(dst->splice(dst, NULL, src, src->front_handle(src),
+                          src->front_handle(src)) == false);
+    CU_ASSERT_EQUAL(src->size(src), 1);
+    CU_ASSERT_EQUAL(dst->size(dst), 9);
+
+    ListDeinit(empty);
+    ListDeinit(src);
+    ListDeinit(dst);
+}
+
+/* Order the elements by the key and leave the sequence number for checking
+   the stability. */
+static const int SEQ_BASE = 1000;
+
+int CompareKey(const void* lhs, const void* rhs)
+{
+    int key_lhs = (int)(intptr_t)lhs / SEQ_BASE;
+    int key_rhs = (int)(intptr_t)rhs / SEQ_BASE;
+    return (key_lhs > key_rhs) - (key_lhs < key_rhs);
+}
+
+void TestSortMerge()
+{
+    List* list = ListInit();
+
+    /* Sort the trivial lists. */
+    list->sort(list, CompareKey);
+    list->push_back(list, (void*)(intptr_t)SEQ_BASE);
+    list->sort(list, CompareKey);
+    CU_ASSERT_EQUAL(list->size(list), 1);
+    list->pop_back(list);
+
+    /* Sort the elements with plenty of the duplicated keys. */
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        int key = (i * 37) % 11;
+        list->push_back(list, (void*)(intptr_t)(key * SEQ_BASE + i));
+    }
+    list->sort(list, CompareKey);
+    CU_ASSERT_EQUAL(list->size(list), SIZE_TNY_TEST);
+
+    int prev = -1;
+    unsigned count = 0;
+    ListHandle node = list->front_handle(list);
+    while (node) {
+        int curr = (int)(intptr_t)ListHandleGet(node);
+        CU_ASSERT(prev < curr);
+        prev = curr;
+        node = list->next_handle(list, node);
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, SIZE_TNY_TEST);
+
+    /* Merge two sorted lists and keep the elements of the target first. */
+    List* lhs = ListInit();
+    List* rhs = ListInit();
+    for (i = 0 ; i < 6 ; ++i) {
+        lhs->push_back(lhs, (void*)(intptr_t)(i * 2 * SEQ_BASE));
+        rhs->push_back(rhs, (void*)(intptr_t)(i * SEQ_BASE + 1));
+    }
+    CU_ASSERT(lhs->merge(lhs, lhs, CompareKey) == false);
+    CU_ASSERT(lhs->merge(lhs, rhs, CompareKey) == true);
+    {
+        int expect[] = {0, 1, 1001, 2000, 2001, 3001, 4000, 4001, 5001,
+                        6000, 8000, 10000};
+        CheckSequence(lhs, expect, 12);
+    }
+    CU_ASSERT_EQUAL(rhs->size(rhs), 0);
+
+    /* Merge with the empty lists. */
+    CU_ASSERT(lhs->merge(lhs, rhs, CompareKey) == true);
+    CU_ASSERT(rhs->merge(rhs, lhs, CompareKey) == true);
+    CU_ASSERT_EQUAL(lhs->size(lhs), 0);
+    CU_ASSERT_EQUAL(rhs->size(rhs), 12);
+    CU_ASSERT_EQUAL((int)(intptr_t)ListHandleGet(rhs->back_handle(rhs)),
+                    10000);
+
+    ListDeinit(rhs);
+    ListDeinit(lhs);
+    ListDeinit(list);
+}
+
 
 /*-----------------------------------------------------------------------------*
  *              Unit tests relevant to complex data maintenance                *
@@ -622,6 +867,69 @@ void TestObjectReplace()
     }
 }
 
+static int num_alloc;
+
+void* CountAlloc(void* ctx, size_t size)
+{
+    ++num_alloc;
+    return malloc(size);
+}
+
+void CountFree(void* ctx, void* ptr)
+{
+    --num_alloc;
+    free(ptr);
+}
+
+void TestAllocator()
+{
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+
+    /* Apply the custom allocator to the list. */
+    List* list = ListInit();
+    CU_ASSERT(list->set_allocator(list, &alloc) == true);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        list->push_back(list, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST);
+    CU_ASSERT(list->set_allocator(list, NULL) == false);
+    CU_ASSERT(list->use_pool(list) == false);
+    for (i = 0 ; i < SIZE_SML_TEST >> 1 ; ++i)
+        list->pop_front(list);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST >> 1);
+    ListDeinit(list);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* The global allocator is captured at construction. */
+    CdsSetAllocator(&alloc);
+    list = ListInit();
+    CdsSetAllocator(NULL);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        list->push_front(list, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST);
+    ListDeinit(list);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* Manage the nodes with the internal pool. */
+    list = ListInit();
+    CU_ASSERT(list->use_pool(list) == true);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        list->push_back(list, (void*)(intptr_t)i);
+    for (i = 0 ; i < SIZE_MID_TEST >> 1 ; ++i)
+        list->pop_back(list);
+    for (i = 0 ; i < SIZE_MID_TEST >> 1 ; ++i)
+        list->insert(list, 0, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(list->size(list), SIZE_MID_TEST);
+
+    void* element;
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT_EQUAL((int)(intptr_t)element, (SIZE_MID_TEST >> 1) - 1);
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT_EQUAL((int)(intptr_t)element, (SIZE_MID_TEST >> 1) - 1);
+    ListDeinit(list);
+}
+
 
 /*-----------------------------------------------------------------------------*
  *                      The driver for List unit test                        *
@@ -664,6 +972,22 @@ bool AddSuite()
         unit = CU_add_test(suite, "List Iterator", TestIterator);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "List External Iterator", TestExternalIterator);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Node Handle Operation", TestHandle);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "List Splice", TestSplice);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "List Sort and Merge", TestSortMerge);
+        if (!unit)
+            return false;
     }
     {
         CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
@@ -681,6 +1005,10 @@ bool AddSuite()
         unit = CU_add_test(suite, "Object Replace", TestObjectReplace);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Node Allocation via Allocator and Pool", TestAllocator);
+        if (!unit)
+            return false;
     }
 
     return true;
@@ -0,0 +1,330 @@
+#include <pthread.h>
+#include "container/lru_cache.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 4;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_BIG_TEST = 65536;
+#define NUM_THREAD      (4)
+
+
+/*-----------------------------------------------------------------------------*
+ *         The utilities for key comparison and resource clean                 *
+ *-----------------------------------------------------------------------------*/
+static int num_clean;
+
+unsigned HashKey(void* key)
+{
+    char* str = (char*)key;
+    unsigned hash = 5381;
+    int c;
+    while ((c = *str++))
+        hash = ((hash << 5) + hash) + c;
+    return hash;
+}
+
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanObject(void* obj)
+{
+    free(obj);
+    ++num_clean;
+}
+
+size_t ChargeValue(void* key, void* value)
+{
+    return strlen((char*)value);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    LruCache* cache = LruCacheInit(SIZE_SML_TEST, 0);
+    CU_ASSERT(cache != NULL);
+    CU_ASSERT_EQUAL(cache->size(cache), 0);
+    LruCacheDeinit(cache);
+
+    cache = LruCacheInit(0, 3);
+    CU_ASSERT(cache != NULL);
+    LruCacheDeinit(cache);
+
+    /* Deinitializing a null cache should be harmless. */
+    LruCacheDeinit(NULL);
+}
+
+void TestPutGet()
+{
+    LruCache* cache = LruCacheInit(SIZE_TNY_TEST, 0);
+    int i;
+    for (i = 1 ; i <= SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(cache->put(cache, (void*)(intptr_t)i, (void*)(intptr_t)(i * 10)) == true);
+    CU_ASSERT_EQUAL(cache->size(cache), SIZE_TNY_TEST);
+
+    /* Promote the oldest pair, so the second one becomes the eviction victim.
+       The containment check does not affect the recency. */
+    CU_ASSERT(cache->get(cache, (void*)(intptr_t)1) == (void*)(intptr_t)10);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)2) == true);
+    CU_ASSERT(cache->put(cache, (void*)(intptr_t)5, (void*)(intptr_t)50) == true);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)2) == false);
+    CU_ASSERT(cache->get(cache, (void*)(intptr_t)2) == NULL);
+    CU_ASSERT_EQUAL(cache->size(cache), SIZE_TNY_TEST);
+
+    /* Replace a pair, which also promotes it. */
+    CU_ASSERT(cache->put(cache, (void*)(intptr_t)3, (void*)(intptr_t)31) == true);
+    CU_ASSERT(cache->put(cache, (void*)(intptr_t)6, (void*)(intptr_t)60) == true);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)4) == false);
+    CU_ASSERT(cache->get(cache, (void*)(intptr_t)3) == (void*)(intptr_t)31);
+
+    CU_ASSERT(cache->remove(cache, (void*)(intptr_t)3) == true);
+    CU_ASSERT(cache->remove(cache, (void*)(intptr_t)3) == false);
+    CU_ASSERT_EQUAL(cache->size(cache), SIZE_TNY_TEST - 1);
+    CU_ASSERT_EQUAL(cache->total_charge(cache), SIZE_TNY_TEST - 1);
+
+    LruCacheDeinit(cache);
+}
+
+void TestUnlimited()
+{
+    /* Without the capacity limit, the slot array keeps growing. */
+    LruCache* cache = LruCacheInit(0, 0);
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i)
+        CU_ASSERT(cache->put(cache, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(cache->size(cache), SIZE_BIG_TEST);
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i)
+        CU_ASSERT(cache->get(cache, (void*)(intptr_t)i) == (void*)(intptr_t)i);
+    LruCacheDeinit(cache);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to complex data maintenance                  *
+ *-----------------------------------------------------------------------------*/
+void TestEviction()
+{
+    char buf[SIZE_SML_TEST];
+    LruCache* cache = LruCacheInit(SIZE_SML_TEST, 0);
+    cache->set_hash(cache, HashKey);
+    cache->set_compare(cache, CompareKey);
+    cache->set_clean_key(cache, CleanObject);
+    cache->set_clean_value(cache, CleanObject);
+
+    /* Each evicted pair is cleaned like a removed one. */
+    num_clean = 0;
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST << 1 ; ++i) {
+        snprintf(buf, SIZE_SML_TEST, "key -> %d", i);
+        char* key = strdup(buf);
+        snprintf(buf, SIZE_SML_TEST, "value -> %d", i);
+        cache->put(cache, key, strdup(buf));
+    }
+    CU_ASSERT_EQUAL(num_clean, SIZE_SML_TEST << 1);
+    CU_ASSERT_EQUAL(cache->size(cache), SIZE_SML_TEST);
+
+    for (i = 0 ; i < SIZE_SML_TEST << 1 ; ++i) {
+        snprintf(buf, SIZE_SML_TEST, "key -> %d", i);
+        CU_ASSERT(cache->contain(cache, buf) == (i >= SIZE_SML_TEST));
+    }
+
+    /* The replaced pair is cleaned as well. */
+    snprintf(buf, SIZE_SML_TEST, "key -> %d", SIZE_SML_TEST);
+    cache->put(cache, strdup(buf), strdup("replaced"));
+    CU_ASSERT_EQUAL(num_clean, (SIZE_SML_TEST << 1) + 2);
+    CU_ASSERT(strcmp((char*)cache->get(cache, buf), "replaced") == 0);
+
+    LruCacheDeinit(cache);
+    CU_ASSERT_EQUAL(num_clean, SIZE_SML_TEST * 4 + 2);
+}
+
+void TestCharge()
+{
+    LruCache* cache = LruCacheInit(0, 0);
+    cache->set_charge(cache, ChargeValue, 10);
+
+    /* The least recently used pairs are evicted until the charge fits. */
+    cache->put(cache, (void*)(intptr_t)1, "aaaa");
+    cache->put(cache, (void*)(intptr_t)2, "bbbb");
+    CU_ASSERT_EQUAL(cache->total_charge(cache), 8);
+    cache->put(cache, (void*)(intptr_t)3, "cccc");
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)1) == false);
+    CU_ASSERT_EQUAL(cache->total_charge(cache), 8);
+
+    /* The inserted pair is kept even if its charge alone exceeds the limit. */
+    cache->put(cache, (void*)(intptr_t)4, "dddddddddddd");
+    CU_ASSERT_EQUAL(cache->size(cache), 1);
+    CU_ASSERT_EQUAL(cache->total_charge(cache), 12);
+
+    cache->put(cache, (void*)(intptr_t)4, "dd");
+    CU_ASSERT_EQUAL(cache->total_charge(cache), 2);
+    LruCacheDeinit(cache);
+}
+
+void TestClock()
+{
+    LruCache* cache = LruCacheInit(SIZE_TNY_TEST, 0);
+    cache->set_clock(cache, true);
+    int i;
+    for (i = 1 ; i <= SIZE_TNY_TEST ; ++i)
+        cache->put(cache, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    /* The referenced pairs get the second chance. */
+    cache->get(cache, (void*)(intptr_t)1);
+    cache->get(cache, (void*)(intptr_t)2);
+    cache->put(cache, (void*)(intptr_t)5, (void*)(intptr_t)5);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)1) == true);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)2) == true);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)3) == false);
+
+    /* The reference bits are cleared by the previous sweep. */
+    cache->put(cache, (void*)(intptr_t)6, (void*)(intptr_t)6);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)4) == false);
+    cache->put(cache, (void*)(intptr_t)7, (void*)(intptr_t)7);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)5) == false);
+    CU_ASSERT_EQUAL(cache->size(cache), SIZE_TNY_TEST);
+
+    /* With every pair referenced, the sweep still terminates. */
+    cache->get(cache, (void*)(intptr_t)1);
+    cache->get(cache, (void*)(intptr_t)2);
+    cache->get(cache, (void*)(intptr_t)6);
+    cache->get(cache, (void*)(intptr_t)7);
+    cache->put(cache, (void*)(intptr_t)8, (void*)(intptr_t)8);
+    CU_ASSERT_EQUAL(cache->size(cache), SIZE_TNY_TEST);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)8) == true);
+    CU_ASSERT(cache->contain(cache, (void*)(intptr_t)1) == false);
+
+    LruCacheDeinit(cache);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to concurrent data exchange                  *
+ *-----------------------------------------------------------------------------*/
+void* Access(void* arg)
+{
+    LruCache* cache = (LruCache*)arg;
+    unsigned seed = (unsigned)(uintptr_t)pthread_self();
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        seed = seed * 1103515245 + 12345;
+        intptr_t key = (seed >> 8) % (SIZE_SML_TEST << 2);
+        switch (seed % 4) {
+            case 0:
+                cache->remove(cache, (void*)key);
+                break;
+            case 1:
+                cache->put(cache, (void*)key, (void*)(key * 2));
+                break;
+            default: {
+                void* value = cache->get(cache, (void*)key);
+                if (value && (intptr_t)value != key * 2)
+                    return (void*)(intptr_t)1;
+            }
+        }
+    }
+    return NULL;
+}
+
+void TestConcurrentAccess()
+{
+    int mode;
+    for (mode = 0 ; mode < 2 ; ++mode) {
+        LruCache* cache = LruCacheInit(SIZE_SML_TEST, 8);
+        cache->set_clock(cache, mode == 1);
+
+        pthread_t threads[NUM_THREAD];
+        int i;
+        for (i = 0 ; i < NUM_THREAD ; ++i)
+            pthread_create(&threads[i], NULL, Access, cache);
+        for (i = 0 ; i < NUM_THREAD ; ++i) {
+            void* status;
+            pthread_join(threads[i], &status);
+            CU_ASSERT(status == NULL);
+        }
+        CU_ASSERT(cache->size(cache) <= SIZE_SML_TEST);
+        LruCacheDeinit(cache);
+    }
+}
+
+
+bool AddSuite()
+{
+    {
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Put Get and Recency", TestPutGet);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Unlimited Capacity", TestUnlimited);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Eviction and Garbage Collection",
+                                    TestEviction);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Charge Limit", TestCharge);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "CLOCK Eviction", TestClock);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Concurrent Data Exchange", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Sharded Concurrent Access",
+                                    TestConcurrentAccess);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for LruCache structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
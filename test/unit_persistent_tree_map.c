@@ -0,0 +1,367 @@
+#include <pthread.h>
+#include "container/persistent_tree_map.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 1024;
+static const int SIZE_MID_STR = 32;
+static const int NUM_ROUND = 64;
+#define NUM_THREAD      (4)
+
+
+/*-----------------------------------------------------------------------------*
+ *         The utilities for key comparison and resource clean                 *
+ *-----------------------------------------------------------------------------*/
+static int num_clean;
+
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanObject(void* obj)
+{
+    free(obj);
+    ++num_clean;
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    PersistentTreeMap* map;
+    CU_ASSERT((map = PersistentTreeMapInit()) != NULL);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    PersistentTreeMapDeinit(map);
+
+    /* Enlarge the map size to test the destructor. */
+    CU_ASSERT((map = PersistentTreeMapInit()) != NULL);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    PersistentTreeMapDeinit(map);
+
+    /* Deinitializing a null map or releasing a null snapshot should be
+       harmless. */
+    PersistentTreeMapDeinit(NULL);
+    PersistentTreeMapRelease(NULL);
+}
+
+void TestPutGetRemove()
+{
+    PersistentTreeMap* map = PersistentTreeMapInit();
+
+    /* Insert the keys in the ascending, the descending, and the scattered
+       orders. */
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    for (i = SIZE_MID_TEST - 1 ; i >= SIZE_SML_TEST ; --i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        intptr_t key = (i * 7919) % SIZE_MID_TEST;
+        CU_ASSERT(map->put(map, (void*)key, (void*)(key * 2)) == true);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == true);
+        CU_ASSERT_EQUAL((intptr_t)map->get(map, (void*)(intptr_t)i), i * 2);
+    }
+    CU_ASSERT(map->find(map, (void*)(intptr_t)SIZE_MID_TEST) == false);
+    CU_ASSERT(map->get(map, (void*)(intptr_t)SIZE_MID_TEST) == NULL);
+
+    /* Remove the scattered half, and then the rest. */
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2) {
+        intptr_t key = (i * 7919) % SIZE_MID_TEST;
+        CU_ASSERT(map->remove(map, (void*)key) == true);
+        CU_ASSERT(map->remove(map, (void*)key) == false);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST >> 1);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        intptr_t key = (i * 7919) % SIZE_MID_TEST;
+        CU_ASSERT(map->find(map, (void*)key) == (i % 2 == 1));
+    }
+    for (i = 1 ; i < SIZE_MID_TEST ; i += 2) {
+        intptr_t key = (i * 7919) % SIZE_MID_TEST;
+        CU_ASSERT(map->remove(map, (void*)key) == true);
+    }
+    CU_ASSERT_EQUAL(map->size(map), 0);
+
+    PersistentTreeMapDeinit(map);
+}
+
+void TestSnapshot()
+{
+    PersistentTreeMap* map = PersistentTreeMapInit();
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    PersistentTreeMapView* old = map->snapshot(map);
+    CU_ASSERT(old != NULL);
+
+    /* Update the map after the snapshot. */
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)(i + 1));
+    for (i = 1 ; i < SIZE_SML_TEST ; i += 2)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+    for (i = SIZE_SML_TEST ; i < SIZE_MID_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST - (SIZE_SML_TEST >> 1));
+
+    /* The snapshot keeps the original version. */
+    CU_ASSERT_EQUAL(PersistentTreeMapViewSize(old), SIZE_SML_TEST);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        bool found = PersistentTreeMapViewFind(old, (void*)(intptr_t)i);
+        CU_ASSERT(found == (i < SIZE_SML_TEST));
+        if (found)
+            CU_ASSERT_EQUAL((intptr_t)PersistentTreeMapViewGet(
+                                old, (void*)(intptr_t)i), i);
+    }
+
+    PersistentTreeMapIter iter;
+    PersistentTreeMapViewIterInit(old, &iter);
+    Pair* ptr_pair;
+    i = 0;
+    while ((ptr_pair = PersistentTreeMapViewIterNext(&iter)) != NULL) {
+        CU_ASSERT_EQUAL((intptr_t)ptr_pair->key, i);
+        CU_ASSERT_EQUAL((intptr_t)ptr_pair->value, i);
+        ++i;
+    }
+    CU_ASSERT_EQUAL(i, SIZE_SML_TEST);
+
+    /* The new snapshot follows the current version. */
+    PersistentTreeMapView* now = map->snapshot(map);
+    PersistentTreeMapViewIterInit(now, &iter);
+    unsigned count = 0;
+    intptr_t prev = -1;
+    while ((ptr_pair = PersistentTreeMapViewIterNext(&iter)) != NULL) {
+        intptr_t key = (intptr_t)ptr_pair->key;
+        CU_ASSERT(key > prev);
+        CU_ASSERT((key >= SIZE_SML_TEST) || (key % 2 == 0));
+        CU_ASSERT_EQUAL((intptr_t)ptr_pair->value,
+                        (key < SIZE_SML_TEST)? key + 1 : key);
+        prev = key;
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, map->size(map));
+    PersistentTreeMapRelease(old);
+
+    /* The snapshot outlives the map. */
+    PersistentTreeMapDeinit(map);
+    CU_ASSERT_EQUAL(PersistentTreeMapViewSize(now), count);
+    CU_ASSERT_EQUAL((intptr_t)PersistentTreeMapViewGet(
+                        now, (void*)(intptr_t)SIZE_SML_TEST), SIZE_SML_TEST);
+    PersistentTreeMapRelease(now);
+
+    /* The empty map can also be captured. */
+    map = PersistentTreeMapInit();
+    old = map->snapshot(map);
+    map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)1);
+    CU_ASSERT_EQUAL(PersistentTreeMapViewSize(old), 0);
+    CU_ASSERT(PersistentTreeMapViewFind(old, (void*)(intptr_t)1) == false);
+    PersistentTreeMapViewIterInit(old, &iter);
+    CU_ASSERT(PersistentTreeMapViewIterNext(&iter) == NULL);
+    PersistentTreeMapRelease(old);
+    PersistentTreeMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to complex data maintenance                  *
+ *-----------------------------------------------------------------------------*/
+void TestGarbageCollection()
+{
+    PersistentTreeMap* map = PersistentTreeMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanObject);
+    map->set_clean_value(map, CleanObject);
+
+    char buf[SIZE_MID_STR];
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        map->put(map, strdup(buf), strdup("old"));
+    }
+    PersistentTreeMapView* view = map->snapshot(map);
+
+    /* The replaced pairs are still visible to the snapshot, while the new
+       pairs held only by the map are cleaned by the removal. */
+    num_clean = 0;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        map->put(map, strdup(buf), strdup("new"));
+    }
+    CU_ASSERT_EQUAL(num_clean, 0);
+    for (i = 0 ; i < SIZE_TNY_TEST ; i += 2) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        CU_ASSERT(map->remove(map, buf) == true);
+    }
+    CU_ASSERT_EQUAL(num_clean, SIZE_TNY_TEST);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        char* value = (char*)PersistentTreeMapViewGet(view, buf);
+        CU_ASSERT(value != NULL && strcmp(value, "old") == 0);
+    }
+
+    /* Releasing the snapshot reclaims the old version. */
+    PersistentTreeMapRelease(view);
+    CU_ASSERT_EQUAL(num_clean, SIZE_TNY_TEST * 3);
+
+    /* Without any snapshot, the update cleans the pairs right away. */
+    for (i = 1 ; i < SIZE_TNY_TEST ; i += 2) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        CU_ASSERT(map->remove(map, buf) == true);
+    }
+    CU_ASSERT_EQUAL(num_clean, SIZE_TNY_TEST * 4);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+
+    /* The pairs held by both the map and the snapshot are cleaned once. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        map->put(map, strdup(buf), strdup("new"));
+    }
+    view = map->snapshot(map);
+    num_clean = 0;
+    PersistentTreeMapDeinit(map);
+    CU_ASSERT_EQUAL(num_clean, 0);
+    PersistentTreeMapRelease(view);
+    CU_ASSERT_EQUAL(num_clean, SIZE_TNY_TEST * 2);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to concurrent data exchange                  *
+ *-----------------------------------------------------------------------------*/
+static int done_write;
+
+/* Each round stamps the keys in the ascending order, so any consistent version
+   sees a prefix of the keys with the round and the rest with the previous
+   one. */
+void* Read(void* arg)
+{
+    PersistentTreeMap* map = (PersistentTreeMap*)arg;
+    while (!__atomic_load_n(&done_write, __ATOMIC_ACQUIRE)) {
+        PersistentTreeMapView* view = map->snapshot(map);
+        if (!view)
+            return (void*)(intptr_t)1;
+        if (PersistentTreeMapViewSize(view) != (unsigned)SIZE_SML_TEST)
+            return (void*)(intptr_t)1;
+
+        PersistentTreeMapIter iter;
+        PersistentTreeMapViewIterInit(view, &iter);
+        Pair* ptr_pair = PersistentTreeMapViewIterNext(&iter);
+        intptr_t first = (intptr_t)ptr_pair->value;
+        intptr_t prev = first;
+        while ((ptr_pair = PersistentTreeMapViewIterNext(&iter)) != NULL) {
+            intptr_t round = (intptr_t)ptr_pair->value;
+            if (round > prev || round < first - 1)
+                return (void*)(intptr_t)1;
+            prev = round;
+        }
+        PersistentTreeMapRelease(view);
+    }
+    return NULL;
+}
+
+void TestConcurrentSnapshot()
+{
+    PersistentTreeMap* map = PersistentTreeMapInit();
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)0);
+
+    done_write = 0;
+    pthread_t threads[NUM_THREAD];
+    for (i = 0 ; i < NUM_THREAD ; ++i)
+        pthread_create(&threads[i], NULL, Read, map);
+
+    int round;
+    for (round = 1 ; round <= NUM_ROUND ; ++round) {
+        for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+            map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)round);
+    }
+    __atomic_store_n(&done_write, 1, __ATOMIC_RELEASE);
+
+    for (i = 0 ; i < NUM_THREAD ; ++i) {
+        void* status;
+        pthread_join(threads[i], &status);
+        CU_ASSERT(status == NULL);
+    }
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT_EQUAL((intptr_t)map->get(map, (void*)(intptr_t)i), NUM_ROUND);
+    PersistentTreeMapDeinit(map);
+}
+
+
+bool AddSuite()
+{
+    {
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Put Get and Remove", TestPutGetRemove);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Snapshot Isolation", TestSnapshot);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Version Garbage Collection",
+                                    TestGarbageCollection);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Concurrent Data Exchange", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Snapshot During Update",
+                                    TestConcurrentSnapshot);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for PersistentTreeMap structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
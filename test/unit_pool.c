@@ -0,0 +1,166 @@
+#include "memory/pool.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_MID_TEST = 1024;
+static const int SIZE_LGE_TEST = 16384;
+
+typedef struct Employ_ {
+    int year;
+    int level;
+    int id;
+} Employ;
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    Pool* pool;
+    CU_ASSERT((pool = PoolInit(sizeof(Employ))) != NULL);
+
+    /* Acquire lots of objects without returning them to test the destructor. */
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        CU_ASSERT(pool->alloc(pool) != NULL);
+    CU_ASSERT_EQUAL(pool->size(pool), SIZE_LGE_TEST);
+
+    PoolDeinit(pool);
+}
+
+void TestAllocFree()
+{
+    Pool* pool = PoolInit(sizeof(Employ));
+    Employ* employs[SIZE_MID_TEST];
+
+    /* The acquired objects should be aligned and not overlap each other. */
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        employs[i] = (Employ*)pool->alloc(pool);
+        CU_ASSERT(((uintptr_t)employs[i] & (sizeof(void*) - 1)) == 0);
+        employs[i]->year = i;
+        employs[i]->level = i;
+        employs[i]->id = i;
+    }
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(employs[i]->id == i && employs[i]->year == i);
+
+    /* The returned objects should be recycled. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        pool->free(pool, employs[i]);
+    CU_ASSERT_EQUAL(pool->size(pool), SIZE_MID_TEST - SIZE_TNY_TEST);
+
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        Employ* employ = (Employ*)pool->alloc(pool);
+        int j;
+        bool recycled = false;
+        for (j = 0 ; j < SIZE_TNY_TEST ; ++j) {
+            if (employ == employs[j]) {
+                recycled = true;
+                break;
+            }
+        }
+        CU_ASSERT(recycled == true);
+    }
+    CU_ASSERT_EQUAL(pool->size(pool), SIZE_MID_TEST);
+
+    PoolDeinit(pool);
+}
+
+void TestAllocator()
+{
+    Pool* pool = PoolInit(sizeof(Employ));
+    Allocator alloc;
+    pool->get_allocator(pool, &alloc);
+
+    /* The exported allocator should reject oversized requests. */
+    void* ptr = alloc.alloc(alloc.ctx, sizeof(Employ));
+    CU_ASSERT(ptr != NULL);
+    CU_ASSERT(alloc.alloc(alloc.ctx, sizeof(Employ) << 4) == NULL);
+    CU_ASSERT_EQUAL(pool->size(pool), 1);
+
+    alloc.free(alloc.ctx, ptr);
+    CU_ASSERT_EQUAL(pool->size(pool), 0);
+
+    PoolDeinit(pool);
+}
+
+void TestReserve()
+{
+    Pool* pool = PoolInit(sizeof(Employ));
+
+    /* Warm up the pool so that the reservation exceeds the current slab. */
+    CU_ASSERT(pool->alloc(pool) != NULL);
+    CU_ASSERT(pool->reserve(pool, SIZE_MID_TEST) == true);
+
+    /* The reserved objects should be carved from one contiguous region. */
+    size_t align = sizeof(void*);
+    size_t stride = (sizeof(Employ) + align - 1) & ~(align - 1);
+    char* base = (char*)pool->alloc(pool);
+    CU_ASSERT(base != NULL);
+    int i;
+    for (i = 1 ; i < SIZE_MID_TEST ; ++i) {
+        char* ptr = (char*)pool->alloc(pool);
+        CU_ASSERT((size_t)(ptr - base) == stride * i);
+    }
+    CU_ASSERT_EQUAL(pool->size(pool), SIZE_MID_TEST + 1);
+
+    PoolDeinit(pool);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                        The driver for Pool unit test                        *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+    if (!suite)
+        return false;
+
+    CU_pTest unit = CU_add_test(suite, "Pool New and Delete", TestNewDelete);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Object Acquire and Return", TestAllocFree);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Generic Allocator Export", TestAllocator);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Contiguous Reservation", TestReserve);
+    if (!unit)
+        return false;
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for pool structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
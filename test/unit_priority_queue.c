@@ -4,6 +4,7 @@
 
 
 static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 2048;
 
 typedef struct Tuple_ {
     int first;
@@ -32,6 +33,20 @@ int CompareObjects(const void* lhs, const void* rhs)
     return (tpl_lhs->first > tpl_rhs->first)? (-1) : 1;
 }
 
+/* Sort the expected integers in the ascending order. */
+int CompareAscend(const void* lhs, const void* rhs)
+{
+    int num_lhs = *(int*)lhs;
+    int num_rhs = *(int*)rhs;
+    return (num_lhs > num_rhs) - (num_lhs < num_rhs);
+}
+
+/* Sort the expected integers in the descending order. */
+int CompareDescend(const void* lhs, const void* rhs)
+{
+    return CompareAscend(rhs, lhs);
+}
+
 void CleanObject(void* element)
 {
     free(element);
@@ -133,6 +148,218 @@ void TestOrderObjects()
     PriorityQueueDeinit(queue);
 }
 
+void TestGrowth()
+{
+    PriorityQueue* queue = PriorityQueueInit();
+
+    /* The policies without hysteresis are rejected. */
+    GrowthPolicy invalid_grow = {100, 0, 1};
+    GrowthPolicy invalid_shrink = {200, 50, 1};
+    CU_ASSERT(queue->set_growth(queue, &invalid_grow) == false);
+    CU_ASSERT(queue->set_growth(queue, &invalid_shrink) == false);
+
+    GrowthPolicy policy = {150, 25, 8};
+    CU_ASSERT(queue->set_growth(queue, &policy) == true);
+
+    int i;
+    for (i = SIZE_MID_TEST ; i > 0 ; --i)
+        CU_ASSERT(queue->push(queue, (void*)(intptr_t)i) == true);
+    unsigned peak = queue->capacity(queue);
+    CU_ASSERT(peak >= (unsigned)SIZE_MID_TEST);
+
+    /* Drain the burst and the heap follows. */
+    void* element;
+    for (i = 1 ; i <= SIZE_MID_TEST - 4 ; ++i) {
+        CU_ASSERT(queue->top(queue, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, i);
+        CU_ASSERT(queue->pop(queue) == true);
+    }
+    CU_ASSERT(queue->capacity(queue) < peak);
+    CU_ASSERT(queue->capacity(queue) >= policy.min_capacity);
+
+    /* Reserve and shrink explicitly. */
+    CU_ASSERT(queue->reserve(queue, SIZE_MID_TEST) == true);
+    CU_ASSERT_EQUAL(queue->capacity(queue), SIZE_MID_TEST);
+    CU_ASSERT(queue->shrink_to_fit(queue) == true);
+    CU_ASSERT_EQUAL(queue->capacity(queue), 4);
+    for (i = SIZE_MID_TEST - 3 ; i <= SIZE_MID_TEST ; ++i) {
+        CU_ASSERT(queue->top(queue, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, i);
+        CU_ASSERT(queue->pop(queue) == true);
+    }
+
+    PriorityQueueDeinit(queue);
+}
+
+void TestArity()
+{
+    PriorityQueue* queue = PriorityQueueInit();
+    CU_ASSERT(queue->set_arity(queue, 1) == false);
+    CU_ASSERT(queue->set_arity(queue, 65) == false);
+
+    /* Switch the arity while the heap is populated. */
+    unsigned arities[] = {4, 3, 8, 2, 64};
+    unsigned num_arity = sizeof(arities) / sizeof(unsigned);
+    int i;
+    unsigned j;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(queue->push(queue, (void*)(intptr_t)(rand() % SIZE_SML_TEST)) == true);
+    for (j = 0 ; j < num_arity ; ++j) {
+        CU_ASSERT(queue->set_arity(queue, arities[j]) == true);
+
+        /* Refill the heap with the new arity and then check the order. */
+        for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+            CU_ASSERT(queue->push(queue, (void*)(intptr_t)(rand() % SIZE_SML_TEST)) == true);
+        intptr_t prev = -1;
+        for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+            void* element;
+            CU_ASSERT(queue->top(queue, &element) == true);
+            CU_ASSERT((intptr_t)element >= prev);
+            prev = (intptr_t)element;
+            CU_ASSERT(queue->pop(queue) == true);
+        }
+    }
+
+    intptr_t prev = -1;
+    void* element;
+    while (queue->top(queue, &element)) {
+        CU_ASSERT((intptr_t)element >= prev);
+        prev = (intptr_t)element;
+        queue->pop(queue);
+    }
+
+    PriorityQueueDeinit(queue);
+}
+
+void TestHandle()
+{
+    PriorityQueue* queue = PriorityQueueInit();
+    queue->set_compare(queue, CompareObjects);
+    queue->set_clean(queue, CleanObject);
+    CU_ASSERT(queue->set_arity(queue, 4) == true);
+
+    /* Mix the elements pushed with and without the handles. */
+    PriorityQueueHandle handles[SIZE_SML_TEST];
+    Tuple* tuples[SIZE_SML_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Tuple* tuple = (Tuple*)malloc(sizeof(Tuple));
+        tuple->first = i;
+        tuple->second = i;
+        tuples[i] = tuple;
+        if (i & 1) {
+            CU_ASSERT(queue->push(queue, tuple) == true);
+            handles[i] = NULL;
+        } else
+            CU_ASSERT((handles[i] = queue->push_handle(queue, tuple)) != NULL);
+    }
+
+    /* Replace and remove the elements via the handles. */
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2) {
+        if (i % 3 == 0) {
+            Tuple* tuple = (Tuple*)malloc(sizeof(Tuple));
+            tuple->first = i + SIZE_SML_TEST;
+            tuple->second = i;
+            queue->update(queue, handles[i], tuple);
+            tuples[i] = tuple;
+        } else if (i % 5 == 0) {
+            queue->remove(queue, handles[i]);
+            tuples[i] = NULL;
+        }
+    }
+
+    /* The handles survive the arity change. Modify the priorities in place to
+       let the elements float and sink. */
+    CU_ASSERT(queue->set_arity(queue, 3) == true);
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2) {
+        if (!tuples[i] || i % 7 != 0)
+            continue;
+        tuples[i]->first = (i % 4 == 0)? -i : i + SIZE_MID_TEST;
+        queue->update(queue, handles[i], tuples[i]);
+    }
+
+    /* Collect the expected priorities in the descending order. */
+    int expect[SIZE_SML_TEST];
+    int num_expect = 0;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        if (tuples[i])
+            expect[num_expect++] = tuples[i]->first;
+    }
+    qsort(expect, num_expect, sizeof(int), CompareDescend);
+    CU_ASSERT_EQUAL(queue->size(queue), num_expect);
+
+    void* elem;
+    for (i = 0 ; i < num_expect ; ++i) {
+        CU_ASSERT(queue->top(queue, &elem) == true);
+        CU_ASSERT_EQUAL(((Tuple*)elem)->first, expect[i]);
+        CU_ASSERT(queue->pop(queue) == true);
+    }
+    CU_ASSERT_EQUAL(queue->size(queue), 0);
+
+    /* The remaining handles are released by the destructor. */
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Tuple* tuple = (Tuple*)malloc(sizeof(Tuple));
+        tuple->first = i;
+        CU_ASSERT(queue->push_handle(queue, tuple) != NULL);
+    }
+
+    PriorityQueueDeinit(queue);
+}
+
+void TestBatch()
+{
+    /* Heapify the empty and the populated arrays. */
+    PriorityQueue* queue = PriorityQueueInitFromArray(NULL, 0, NULL);
+    CU_ASSERT(queue != NULL);
+    CU_ASSERT_EQUAL(queue->size(queue), 0);
+    PriorityQueueDeinit(queue);
+
+    void* elements[SIZE_MID_TEST];
+    int expect[SIZE_MID_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        expect[i] = rand() % SIZE_SML_TEST;
+        elements[i] = (void*)(intptr_t)expect[i];
+    }
+    queue = PriorityQueueInitFromArray(elements, SIZE_MID_TEST, CompareNumerics);
+    CU_ASSERT_EQUAL(queue->size(queue), SIZE_MID_TEST);
+    qsort(expect, SIZE_MID_TEST, sizeof(int), CompareAscend);
+
+    /* Pull the top elements in the priority order. */
+    void* top[SIZE_MID_TEST];
+    CU_ASSERT_EQUAL(queue->pop_n(queue, top, 0), 0);
+    CU_ASSERT_EQUAL(queue->pop_n(queue, top, 16), 16);
+    CU_ASSERT_EQUAL(queue->pop_n(queue, top + 16, SIZE_MID_TEST), SIZE_MID_TEST - 16);
+    CU_ASSERT_EQUAL(queue->pop_n(queue, top, 1), 0);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT_EQUAL((int)(intptr_t)top[i], expect[i]);
+    PriorityQueueDeinit(queue);
+
+    /* Append the batches of various sizes to the heaps of various arities. */
+    unsigned arities[] = {2, 4, 5};
+    unsigned j;
+    for (j = 0 ; j < sizeof(arities) / sizeof(unsigned) ; ++j) {
+        queue = PriorityQueueInit();
+        CU_ASSERT(queue->set_arity(queue, arities[j]) == true);
+        queue->push_handle(queue, (void*)(intptr_t)SIZE_SML_TEST);
+
+        int num = 1;
+        int count;
+        for (count = 0 ; num + count <= SIZE_MID_TEST ; count = count * 2 + 1) {
+            for (i = 0 ; i < count ; ++i)
+                elements[i] = (void*)(intptr_t)(rand() % SIZE_SML_TEST);
+            CU_ASSERT(queue->push_batch(queue, elements, count) == true);
+            num += count;
+            CU_ASSERT_EQUAL(queue->size(queue), num);
+        }
+
+        CU_ASSERT_EQUAL(queue->pop_n(queue, top, SIZE_MID_TEST), num);
+        for (i = 1 ; i < num ; ++i)
+            CU_ASSERT((intptr_t)top[i - 1] <= (intptr_t)top[i]);
+        PriorityQueueDeinit(queue);
+    }
+}
+
 /*-----------------------------------------------------------------------------*
  *                      The driver for PriorityQueue unit test                        *
  *-----------------------------------------------------------------------------*/
@@ -150,6 +377,18 @@ bool AddSuite()
         unit = CU_add_test(suite, "Integer Push, Pop, and Get", TestOrderNumerics);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Capacity Growth and Shrink", TestGrowth);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Heap Arity", TestArity);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Batch Heapify and Pop", TestBatch);
+        if (!unit)
+            return false;
     }
     {
         CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
@@ -159,6 +398,10 @@ bool AddSuite()
         CU_pTest unit = CU_add_test(suite, "Object Push, Pop, and Get", TestOrderObjects);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Object Update and Remove via Handle", TestHandle);
+        if (!unit)
+            return false;
     }
     return true;
 }
@@ -4,6 +4,7 @@
 
 
 static const int SIZE_SML_TEST = 32;
+static const int SIZE_MID_TEST = 2048;
 
 typedef struct Tuple_ {
     int first;
@@ -141,6 +142,60 @@ void TestOrderObjects()
 }
 
 
+void TestGrowth()
+{
+    Queue* queue = QueueInit();
+
+    /* The policies without hysteresis are rejected. */
+    GrowthPolicy invalid_grow = {100, 0, 1};
+    GrowthPolicy invalid_shrink = {200, 50, 1};
+    CU_ASSERT(queue->set_growth(queue, &invalid_grow) == false);
+    CU_ASSERT(queue->set_growth(queue, &invalid_shrink) == false);
+
+    GrowthPolicy policy = {150, 25, 8};
+    CU_ASSERT(queue->set_growth(queue, &policy) == true);
+
+    /* Let the elements wrap around before each growth. */
+    int front = 0, back = 0;
+    void* element;
+    while (back < SIZE_MID_TEST) {
+        CU_ASSERT(queue->push(queue, (void*)(intptr_t)back++) == true);
+        if (back % 3 == 0) {
+            CU_ASSERT(queue->front(queue, &element) == true);
+            CU_ASSERT_EQUAL((int)(intptr_t)element, front++);
+            CU_ASSERT(queue->pop(queue) == true);
+        }
+    }
+    unsigned peak = queue->capacity(queue);
+    CU_ASSERT(peak >= queue->size(queue));
+
+    /* Drain the burst and the array follows. */
+    while (back - front > 4) {
+        CU_ASSERT(queue->front(queue, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, front++);
+        CU_ASSERT(queue->pop(queue) == true);
+    }
+    CU_ASSERT(queue->capacity(queue) < peak);
+    CU_ASSERT(queue->capacity(queue) >= policy.min_capacity);
+    CU_ASSERT(queue->back(queue, &element) == true);
+    CU_ASSERT_EQUAL((int)(intptr_t)element, back - 1);
+
+    /* Reserve and shrink explicitly. */
+    CU_ASSERT(queue->reserve(queue, SIZE_MID_TEST) == true);
+    CU_ASSERT_EQUAL(queue->capacity(queue), SIZE_MID_TEST);
+    CU_ASSERT(queue->reserve(queue, 1) == true);
+    CU_ASSERT_EQUAL(queue->capacity(queue), SIZE_MID_TEST);
+    CU_ASSERT(queue->shrink_to_fit(queue) == true);
+    CU_ASSERT_EQUAL(queue->capacity(queue), queue->size(queue));
+    while (front < back) {
+        CU_ASSERT(queue->front(queue, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, front++);
+        CU_ASSERT(queue->pop(queue) == true);
+    }
+
+    QueueDeinit(queue);
+}
+
 /*-----------------------------------------------------------------------------*
  *                       The driver for Queue unit test                        *
  *-----------------------------------------------------------------------------*/
@@ -158,6 +213,10 @@ bool AddSuite()
         unit = CU_add_test(suite, "Numerics Push, Pop, and Get", TestOrderNumerics);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Capacity Growth and Shrink", TestGrowth);
+        if (!unit)
+            return false;
     }
     {
         CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
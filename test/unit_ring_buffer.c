@@ -0,0 +1,323 @@
+#include <pthread.h>
+#include <sched.h>
+#include "container/ring_buffer.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_SML_TEST = 32;
+static const int SIZE_BIG_TEST = 65536;
+static const int SIZE_BATCH = 16;
+#define NUM_PRODUCER    (4)
+#define NUM_CONSUMER    (4)
+
+
+/*-----------------------------------------------------------------------------*
+ *                  The utilities for element resource clean                   *
+ *-----------------------------------------------------------------------------*/
+void CleanObject(void* element)
+{
+    free(element);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    RingBuffer* buf;
+    CU_ASSERT((buf = RingBufferInit(0, false)) != NULL);
+    CU_ASSERT_EQUAL(buf->capacity(buf), 1024);
+    RingBufferDeinit(buf);
+
+    /* The capacity is rounded up to the power of two. */
+    CU_ASSERT((buf = RingBufferInit(1, true)) != NULL);
+    CU_ASSERT_EQUAL(buf->capacity(buf), 2);
+    RingBufferDeinit(buf);
+    CU_ASSERT((buf = RingBufferInit(100, false)) != NULL);
+    CU_ASSERT_EQUAL(buf->capacity(buf), 128);
+
+    /* The remaining elements are cleaned by the destructor. */
+    buf->set_clean(buf, CleanObject);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(buf->push(buf, malloc(sizeof(int))) == true);
+    RingBufferDeinit(buf);
+
+    CU_ASSERT((buf = RingBufferInit(SIZE_SML_TEST, true)) != NULL);
+    buf->set_clean(buf, CleanObject);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(buf->push(buf, malloc(sizeof(int))) == true);
+    RingBufferDeinit(buf);
+
+    /* Test the boundary case. */
+    RingBufferDeinit(NULL);
+}
+
+void CheckPushPop(bool is_mpmc)
+{
+    RingBuffer* buf = RingBufferInit(SIZE_SML_TEST, is_mpmc);
+    void* element;
+    CU_ASSERT(buf->pop(buf, &element) == false);
+
+    /* Run several rounds to let the indexes wrap around the slots. */
+    int round, i;
+    for (round = 0 ; round < 4 ; ++round) {
+        for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+            CU_ASSERT(buf->push(buf, (void*)(intptr_t)i) == true);
+        CU_ASSERT(buf->push(buf, (void*)(intptr_t)i) == false);
+        CU_ASSERT_EQUAL(buf->size(buf), SIZE_SML_TEST);
+
+        for (i = 0 ; i < SIZE_SML_TEST >> 1 ; ++i) {
+            CU_ASSERT(buf->pop(buf, &element) == true);
+            CU_ASSERT_EQUAL((int)(intptr_t)element, i);
+        }
+        for (i = 0 ; i < SIZE_SML_TEST >> 2 ; ++i)
+            CU_ASSERT(buf->push(buf, (void*)(intptr_t)(SIZE_SML_TEST + i)) == true);
+
+        int expect = SIZE_SML_TEST >> 1;
+        while (buf->pop(buf, &element)) {
+            CU_ASSERT_EQUAL((int)(intptr_t)element, expect);
+            ++expect;
+        }
+        CU_ASSERT_EQUAL(expect, SIZE_SML_TEST + (SIZE_SML_TEST >> 2));
+        CU_ASSERT_EQUAL(buf->size(buf), 0);
+    }
+
+    RingBufferDeinit(buf);
+}
+
+void TestPushPop()
+{
+    CheckPushPop(false);
+    CheckPushPop(true);
+}
+
+void CheckBatch(bool is_mpmc)
+{
+    RingBuffer* buf = RingBufferInit(SIZE_SML_TEST, is_mpmc);
+
+    void* in[SIZE_SML_TEST * 2];
+    void* out[SIZE_SML_TEST * 2];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST * 2 ; ++i)
+        in[i] = (void*)(intptr_t)i;
+
+    /* The batch push stops at the buffer capacity. */
+    CU_ASSERT_EQUAL(buf->push_n(buf, in, 0), 0);
+    CU_ASSERT_EQUAL(buf->push_n(buf, in, SIZE_SML_TEST - 8), SIZE_SML_TEST - 8);
+    CU_ASSERT_EQUAL(buf->push_n(buf, in + SIZE_SML_TEST - 8, 16), 8);
+    CU_ASSERT_EQUAL(buf->push_n(buf, in, 1), 0);
+
+    /* The batch pop stops at the buffer size. */
+    CU_ASSERT_EQUAL(buf->pop_n(buf, out, 0), 0);
+    CU_ASSERT_EQUAL(buf->pop_n(buf, out, 20), 20);
+    CU_ASSERT_EQUAL(buf->push_n(buf, in + SIZE_SML_TEST, SIZE_SML_TEST), 20);
+    CU_ASSERT_EQUAL(buf->pop_n(buf, out + 20, SIZE_SML_TEST * 2),
+                    SIZE_SML_TEST);
+    CU_ASSERT_EQUAL(buf->pop_n(buf, out, 1), 0);
+    for (i = 0 ; i < SIZE_SML_TEST + 20 ; ++i)
+        CU_ASSERT_EQUAL(out[i], in[i]);
+
+    RingBufferDeinit(buf);
+}
+
+void TestBatch()
+{
+    CheckBatch(false);
+    CheckBatch(true);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *              Unit tests relevant to concurrent data exchange                *
+ *-----------------------------------------------------------------------------*/
+typedef struct Task_ {
+    RingBuffer* buf;
+    int id;
+    int num_task;
+    int* num_done;
+    char* seen;
+    int fail;
+} Task;
+
+/* The element encodes the producer and the per producer sequence number, so
+   the consumers can verify that each producer's elements keep their order. */
+void* Produce(void* arg)
+{
+    Task* task = (Task*)arg;
+    RingBuffer* buf = task->buf;
+    void* batch[SIZE_BATCH];
+
+    int i = 0;
+    while (i < task->num_task) {
+        int count = 0;
+        while (count < SIZE_BATCH && i + count < task->num_task) {
+            int value = task->id * task->num_task + i + count;
+            batch[count++] = (void*)(intptr_t)value;
+        }
+
+        /* Alternate between the single and the batch operations. */
+        int done;
+        if (i & SIZE_BATCH)
+            done = buf->push(buf, batch[0]);
+        else
+            done = buf->push_n(buf, batch, count);
+        if (done == 0)
+            sched_yield();
+        i += done;
+    }
+    return NULL;
+}
+
+void* Consume(void* arg)
+{
+    Task* task = (Task*)arg;
+    RingBuffer* buf = task->buf;
+    void* batch[SIZE_BATCH];
+    int last[NUM_PRODUCER];
+    int i;
+    for (i = 0 ; i < NUM_PRODUCER ; ++i)
+        last[i] = -1;
+
+    int total = task->num_task * NUM_PRODUCER;
+    while (__atomic_load_n(task->num_done, __ATOMIC_RELAXED) < total) {
+        unsigned count = buf->pop_n(buf, batch, (task->id & 1)? 1 : SIZE_BATCH);
+        if (count == 0) {
+            sched_yield();
+            continue;
+        }
+        __atomic_add_fetch(task->num_done, count, __ATOMIC_RELAXED);
+
+        for (i = 0 ; i < (int)count ; ++i) {
+            int value = (int)(intptr_t)batch[i];
+            int producer = value / task->num_task;
+            if (task->seen[value] || value <= last[producer])
+                task->fail++;
+            task->seen[value] = 1;
+            last[producer] = value;
+        }
+    }
+    return NULL;
+}
+
+void CheckExchange(bool is_mpmc, int num_producer, int num_consumer)
+{
+    RingBuffer* buf = RingBufferInit(SIZE_SML_TEST * 4, is_mpmc);
+    int num_task = SIZE_BIG_TEST / num_producer;
+    int num_done = 0;
+    char* seen = (char*)calloc(num_task * NUM_PRODUCER, sizeof(char));
+
+    pthread_t threads[NUM_PRODUCER + NUM_CONSUMER];
+    Task tasks[NUM_PRODUCER + NUM_CONSUMER];
+    int num_thread = num_producer + num_consumer;
+    int i;
+    for (i = 0 ; i < num_thread ; ++i) {
+        tasks[i].buf = buf;
+        tasks[i].id = (i < num_producer)? i : i - num_producer;
+        tasks[i].num_task = num_task;
+        tasks[i].num_done = &num_done;
+        tasks[i].seen = seen;
+        tasks[i].fail = 0;
+    }
+
+    /* Pretend the missing producers have finished their work. */
+    num_done = (NUM_PRODUCER - num_producer) * num_task;
+
+    for (i = 0 ; i < num_thread ; ++i) {
+        void* (*func) (void*) = (i < num_producer)? Produce : Consume;
+        CU_ASSERT(pthread_create(&threads[i], NULL, func, &tasks[i]) == 0);
+    }
+    for (i = 0 ; i < num_thread ; ++i) {
+        pthread_join(threads[i], NULL);
+        CU_ASSERT_EQUAL(tasks[i].fail, 0);
+    }
+
+    int count = 0;
+    for (i = 0 ; i < num_task * NUM_PRODUCER ; ++i)
+        count += seen[i];
+    CU_ASSERT_EQUAL(count, num_task * num_producer);
+    CU_ASSERT_EQUAL(buf->size(buf), 0);
+
+    free(seen);
+    RingBufferDeinit(buf);
+}
+
+void TestSingleProducerSingleConsumer()
+{
+    CheckExchange(false, 1, 1);
+}
+
+void TestMultiProducerMultiConsumer()
+{
+    CheckExchange(true, NUM_PRODUCER, NUM_CONSUMER);
+    CheckExchange(true, 1, NUM_CONSUMER);
+    CheckExchange(true, NUM_PRODUCER, 1);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                    The driver for RingBuffer unit test                      *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "RingBuffer New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Push and Pop", TestPushPop);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Batch Push and Pop", TestBatch);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Concurrent Data Exchange", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Single Producer Single Consumer",
+                                    TestSingleProducerSingleConsumer);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Multiple Producers Multiple Consumers",
+                           TestMultiProducerMultiConsumer);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for RingBuffer structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
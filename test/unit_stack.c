@@ -4,6 +4,7 @@
 
 
 static const int SIZE_SML_TEST = 64;
+static const int SIZE_MID_TEST = 2048;
 
 typedef struct Tuple_ {
     int first;
@@ -101,6 +102,49 @@ void TestOrderObjects()
 }
 
 
+void TestGrowth()
+{
+    Stack* stack = StackInit();
+
+    /* The policies without hysteresis are rejected. */
+    GrowthPolicy invalid_grow = {100, 0, 1};
+    GrowthPolicy invalid_shrink = {200, 50, 1};
+    CU_ASSERT(stack->set_growth(stack, &invalid_grow) == false);
+    CU_ASSERT(stack->set_growth(stack, &invalid_shrink) == false);
+
+    GrowthPolicy policy = {150, 25, 8};
+    CU_ASSERT(stack->set_growth(stack, &policy) == true);
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(stack->push(stack, (void*)(intptr_t)i) == true);
+    unsigned peak = stack->capacity(stack);
+    CU_ASSERT(peak >= (unsigned)SIZE_MID_TEST);
+
+    /* Drain the burst and the array follows. */
+    void* element;
+    for (i = SIZE_MID_TEST - 1 ; i >= 4 ; --i) {
+        CU_ASSERT(stack->top(stack, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, i);
+        CU_ASSERT(stack->pop(stack) == true);
+    }
+    CU_ASSERT(stack->capacity(stack) < peak);
+    CU_ASSERT(stack->capacity(stack) >= policy.min_capacity);
+
+    /* Reserve and shrink explicitly. */
+    CU_ASSERT(stack->reserve(stack, SIZE_MID_TEST) == true);
+    CU_ASSERT_EQUAL(stack->capacity(stack), SIZE_MID_TEST);
+    CU_ASSERT(stack->shrink_to_fit(stack) == true);
+    CU_ASSERT_EQUAL(stack->capacity(stack), 4);
+    for (i = 3 ; i >= 0 ; --i) {
+        CU_ASSERT(stack->top(stack, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, i);
+        CU_ASSERT(stack->pop(stack) == true);
+    }
+
+    StackDeinit(stack);
+}
+
 /*-----------------------------------------------------------------------------*
  *                       The driver for Stack unit test                        *
  *-----------------------------------------------------------------------------*/
@@ -118,6 +162,10 @@ bool AddSuite()
         unit = CU_add_test(suite, "Numerics Push, Pop, and Get", TestOrderNumerics);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Capacity Growth and Shrink", TestGrowth);
+        if (!unit)
+            return false;
     }
     {
         CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
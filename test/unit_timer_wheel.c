@@ -0,0 +1,388 @@
+#include "container/timer_wheel.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 4096;
+
+/* The record of the expired elements shared with the expiry functions. */
+typedef struct Record_ {
+    TimerWheel* wheel;
+    uint64_t* expires;
+    bool* fired;
+    uint64_t last;
+    unsigned count;
+    unsigned num_batch;
+    bool in_order;
+    bool on_time;
+} Record;
+
+
+/*-----------------------------------------------------------------------------*
+ *          The utilities for timer expiry and resource clean                  *
+ *-----------------------------------------------------------------------------*/
+/* Verify that the elements expire once, not early, and in tick order. */
+void ExpireRecord(void** elements, unsigned count, void* arg)
+{
+    Record* record = (Record*)arg;
+    uint64_t now = record->wheel->now(record->wheel);
+
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        int idx = (int)(intptr_t)elements[i];
+        uint64_t expire = record->expires[idx];
+        if (record->fired[idx] || expire > now)
+            record->on_time = false;
+        if (expire < record->last)
+            record->in_order = false;
+        record->fired[idx] = true;
+        record->last = expire;
+    }
+    record->count += count;
+    record->num_batch++;
+}
+
+void ExpireObject(void** elements, unsigned count, void* arg)
+{
+    unsigned* p_count = (unsigned*)arg;
+    unsigned i;
+    for (i = 0 ; i < count ; ++i)
+        free(elements[i]);
+    *p_count += count;
+}
+
+void CleanObject(void* element)
+{
+    free(element);
+}
+
+uint64_t RandomTick()
+{
+    return ((uint64_t)rand() << 31) ^ (uint64_t)rand();
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    TimerWheel* wheel;
+    CU_ASSERT((wheel = TimerWheelInit(0)) != NULL);
+    TimerWheelDeinit(wheel);
+
+    /* The pending timers should be cleaned by the destructor. */
+    CU_ASSERT((wheel = TimerWheelInit(1000)) != NULL);
+    wheel->set_clean(wheel, CleanObject);
+
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int* elem = (int*)malloc(sizeof(int));
+        CU_ASSERT(wheel->schedule(wheel, (uint64_t)i * i * i, elem) != NULL);
+    }
+    CU_ASSERT_EQUAL(wheel->size(wheel), SIZE_SML_TEST);
+    CU_ASSERT_EQUAL(wheel->now(wheel), 1000);
+
+    TimerWheelDeinit(wheel);
+}
+
+void TestAdvance()
+{
+    srand(time(NULL));
+
+    uint64_t* expires = (uint64_t*)malloc(sizeof(uint64_t) * SIZE_MID_TEST);
+    bool* fired = (bool*)calloc(SIZE_MID_TEST, sizeof(bool));
+
+    /* Spread the timers across all the wheel levels. */
+    uint64_t base = RandomTick();
+    TimerWheel* wheel = TimerWheelInit(base);
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        unsigned shift = rand() % 40;
+        expires[i] = base + 1 + (RandomTick() & ((1ull << shift) - 1));
+        CU_ASSERT(wheel->schedule(wheel, expires[i], (void*)(intptr_t)i) != NULL);
+    }
+    CU_ASSERT_EQUAL(wheel->size(wheel), SIZE_MID_TEST);
+
+    Record record = {wheel, expires, fired, 0, 0, 0, true, true};
+
+    /* Advance in the short steps and then the long jumps. */
+    uint64_t now = base;
+    for (i = 0 ; i < 1000 ; ++i) {
+        now += rand() % 128;
+        wheel->advance(wheel, now, ExpireRecord, &record);
+        CU_ASSERT_EQUAL(wheel->now(wheel), now);
+    }
+    while (wheel->size(wheel) > 0) {
+        uint64_t tick;
+        CU_ASSERT(wheel->next_expire(wheel, &tick) == true);
+        CU_ASSERT(tick > now);
+        now += (RandomTick() & ((1ull << (rand() % 40)) - 1)) + 1;
+        unsigned count = record.count;
+        unsigned size = wheel->size(wheel);
+        CU_ASSERT_EQUAL(wheel->advance(wheel, now, ExpireRecord, &record),
+                        size - wheel->size(wheel));
+        CU_ASSERT_EQUAL(record.count - count, size - wheel->size(wheel));
+    }
+    CU_ASSERT(record.in_order == true);
+    CU_ASSERT(record.on_time == true);
+    CU_ASSERT_EQUAL(record.count, SIZE_MID_TEST);
+    CU_ASSERT(wheel->next_expire(wheel, NULL) == false);
+
+    /* The timers missing the deadline should all be expired. */
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        CU_ASSERT(fired[i] == true);
+        CU_ASSERT(expires[i] <= now);
+    }
+
+    TimerWheelDeinit(wheel);
+    free(fired);
+    free(expires);
+}
+
+void TestBatch()
+{
+    uint64_t expires[SIZE_SML_TEST];
+    bool fired[SIZE_SML_TEST];
+    memset(fired, 0, sizeof(fired));
+
+    /* The timers of the same tick are expired in batches. */
+    TimerWheel* wheel = TimerWheelInit(0);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        expires[i] = 5000;
+        wheel->schedule(wheel, expires[i], (void*)(intptr_t)i);
+    }
+
+    uint64_t tick;
+    CU_ASSERT(wheel->next_expire(wheel, &tick) == true);
+    CU_ASSERT(tick <= 5000);
+
+    Record record = {wheel, expires, fired, 0, 0, 0, true, true};
+    CU_ASSERT_EQUAL(wheel->advance(wheel, 4999, ExpireRecord, &record), 0);
+    CU_ASSERT_EQUAL(wheel->next_expire(wheel, &tick), true);
+    CU_ASSERT_EQUAL(tick, 5000);
+    CU_ASSERT_EQUAL(wheel->advance(wheel, 5000, ExpireRecord, &record),
+                    SIZE_SML_TEST);
+    CU_ASSERT(record.num_batch < SIZE_SML_TEST);
+    CU_ASSERT(record.on_time == true);
+
+    /* The timers scheduled to the past are expired by the next advance. */
+    record.num_batch = 0;
+    record.count = 0;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        expires[i] = i;
+        fired[i] = false;
+        wheel->schedule(wheel, expires[i], (void*)(intptr_t)i);
+    }
+    CU_ASSERT_EQUAL(wheel->next_expire(wheel, &tick), true);
+    CU_ASSERT_EQUAL(tick, 5000);
+    CU_ASSERT_EQUAL(wheel->advance(wheel, 5000, ExpireRecord, &record),
+                    SIZE_SML_TEST);
+    CU_ASSERT_EQUAL(wheel->size(wheel), 0);
+
+    TimerWheelDeinit(wheel);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to complex data maintenance                  *
+ *-----------------------------------------------------------------------------*/
+void TestCancelReschedule()
+{
+    srand(time(NULL));
+
+    uint64_t expires[SIZE_SML_TEST];
+    bool fired[SIZE_SML_TEST];
+    TimerWheelHandle handles[SIZE_SML_TEST];
+    memset(fired, 0, sizeof(fired));
+
+    TimerWheel* wheel = TimerWheelInit(0);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        expires[i] = 1 + rand() % 100000;
+        handles[i] = wheel->schedule(wheel, expires[i], (void*)(intptr_t)i);
+        CU_ASSERT(handles[i] != NULL);
+    }
+
+    /* Cancel the even timers and push back the odd ones. */
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2) {
+        wheel->cancel(wheel, handles[i]);
+        fired[i] = true;
+    }
+    for (i = 1 ; i < SIZE_SML_TEST ; i += 2) {
+        expires[i] += 100000;
+        wheel->reschedule(wheel, handles[i], expires[i]);
+    }
+    CU_ASSERT_EQUAL(wheel->size(wheel), SIZE_SML_TEST / 2);
+
+    Record record = {wheel, expires, fired, 0, 0, 0, true, true};
+    CU_ASSERT_EQUAL(wheel->advance(wheel, 100000, ExpireRecord, &record), 0);
+    CU_ASSERT_EQUAL(wheel->advance(wheel, 200000, ExpireRecord, &record),
+                    SIZE_SML_TEST / 2);
+    CU_ASSERT(record.on_time == true);
+    CU_ASSERT(record.in_order == true);
+
+    /* The cleanup function is invoked for the canceled timers only. */
+    unsigned count = 0;
+    wheel->set_clean(wheel, CleanObject);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int* elem = (int*)malloc(sizeof(int));
+        handles[i] = wheel->schedule(wheel, 200000 + i, elem);
+    }
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2)
+        wheel->cancel(wheel, handles[i]);
+    CU_ASSERT_EQUAL(wheel->advance(wheel, 300000, ExpireObject, &count),
+                    SIZE_SML_TEST / 2);
+    CU_ASSERT_EQUAL(count, SIZE_SML_TEST / 2);
+
+    TimerWheelDeinit(wheel);
+}
+
+/* The periodic timer is rescheduled from within the expiry function. */
+typedef struct Periodic_ {
+    TimerWheel* wheel;
+    TimerWheelHandle victim;
+    unsigned count;
+} Periodic;
+
+void ExpirePeriodic(void** elements, unsigned count, void* arg)
+{
+    Periodic* periodic = (Periodic*)arg;
+    TimerWheel* wheel = periodic->wheel;
+
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        if (periodic->victim) {
+            wheel->cancel(wheel, periodic->victim);
+            periodic->victim = NULL;
+        }
+        wheel->schedule(wheel, wheel->now(wheel) + 10, elements[i]);
+    }
+    periodic->count += count;
+}
+
+void TestReentrance()
+{
+    TimerWheel* wheel = TimerWheelInit(0);
+
+    /* The pending victim is canceled by the first callback. */
+    Periodic periodic = {wheel, NULL, 0};
+    wheel->schedule(wheel, 10, (void*)(intptr_t)1);
+    periodic.victim = wheel->schedule(wheel, 15, (void*)(intptr_t)2);
+
+    CU_ASSERT_EQUAL(wheel->advance(wheel, 1000, ExpirePeriodic, &periodic), 100);
+    CU_ASSERT_EQUAL(periodic.count, 100);
+    CU_ASSERT_EQUAL(wheel->size(wheel), 1);
+
+    uint64_t tick;
+    CU_ASSERT(wheel->next_expire(wheel, &tick) == true);
+    CU_ASSERT_EQUAL(tick, 1010);
+
+    /* The timer scheduled to the current tick waits for the next advance. */
+    periodic.count = 0;
+    wheel->schedule(wheel, 1000, (void*)(intptr_t)3);
+    CU_ASSERT_EQUAL(wheel->advance(wheel, 1000, ExpirePeriodic, &periodic), 1);
+    CU_ASSERT_EQUAL(wheel->size(wheel), 2);
+
+    TimerWheelDeinit(wheel);
+}
+
+void TestPool()
+{
+    TimerWheel* wheel = TimerWheelInit(0);
+    CU_ASSERT(wheel->use_pool(wheel) == true);
+
+    unsigned count = 0;
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        int* elem = (int*)malloc(sizeof(int));
+        CU_ASSERT(wheel->schedule(wheel, i % 256, elem) != NULL);
+    }
+    CU_ASSERT(wheel->use_pool(wheel) == false);
+    CU_ASSERT(wheel->set_allocator(wheel, NULL) == false);
+
+    CU_ASSERT_EQUAL(wheel->advance(wheel, 128, ExpireObject, &count), 129 * 16);
+    CU_ASSERT_EQUAL(count, 129 * 16);
+
+    /* The pooled nodes are released at once with the element cleanup. */
+    wheel->set_clean(wheel, CleanObject);
+    TimerWheelDeinit(wheel);
+
+    wheel = TimerWheelInit(0);
+    CU_ASSERT(wheel->use_pool(wheel) == true);
+    CU_ASSERT(wheel->set_allocator(wheel, NULL) == true);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        wheel->schedule(wheel, i, (void*)(intptr_t)i);
+    TimerWheelDeinit(wheel);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                      The driver for TimerWheel unit test                    *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Schedule and Advance", TestAdvance);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Batch Expiry", TestBatch);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Cancel and Reschedule via Handle",
+                                    TestCancelReschedule);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Reentrance from Expiry", TestReentrance);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Object Pool", TestPool);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for wheel structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
@@ -40,6 +40,30 @@ void CleanValue(void* value)
     free(value);
 }
 
+int CompareKeyReverse(void* lhs, void* rhs)
+{
+    return strcmp((char*)rhs, (char*)lhs);
+}
+
+size_t EncodeText(void* ctx, void* item, void* buf, size_t capacity)
+{
+    size_t size = strlen((char*)item);
+    if (size <= capacity)
+        memcpy(buf, item, size);
+    return size;
+}
+
+bool DecodeText(void* ctx, const void* buf, size_t size, void** p_item)
+{
+    char* text = (char*)malloc(size + 1);
+    if (!text)
+        return false;
+    memcpy(text, buf, size);
+    text[size] = 0;
+    *p_item = text;
+    return true;
+}
+
 
 /*-----------------------------------------------------------------------------*
  *            Unit tests relevant to basic structure verification              *
@@ -382,6 +406,400 @@ void TestReverseIterate()
     TreeMapDeinit(map);
 }
 
+void TestExternalIterator()
+{
+    TreeMap* map = TreeMapInit();
+
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int key = (i * 7) % SIZE_SML_TEST;
+        map->put(map, (void*)(intptr_t)key, (void*)(intptr_t)key);
+    }
+
+    /* Run the forward and the reverse iterators simultaneously. */
+    TreeMapIter fwd, rev;
+    TreeMapIterInit(map, &fwd, false);
+    TreeMapIterInit(map, &rev, true);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Pair* ptr_fwd = TreeMapIterNext(&fwd);
+        Pair* ptr_rev = TreeMapIterNext(&rev);
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_fwd->key);
+        CU_ASSERT_EQUAL(SIZE_SML_TEST - 1 - i, (int)(intptr_t)ptr_rev->key);
+    }
+    CU_ASSERT(TreeMapIterNext(&fwd) == NULL);
+    CU_ASSERT(TreeMapIterNext(&rev) == NULL);
+    TreeMapDeinit(map);
+
+    /* Traverse an empty map. */
+    map = TreeMapInit();
+    TreeMapIterInit(map, &fwd, false);
+    CU_ASSERT(TreeMapIterNext(&fwd) == NULL);
+    TreeMapDeinit(map);
+}
+
+void SumKey(Pair* ptr_pair, void* arg)
+{
+    *((int*)arg) += (int)(intptr_t)ptr_pair->key;
+}
+
+void TestRangeQuery()
+{
+    TreeMap* map = TreeMapInit();
+
+    /* Store only the even keys. */
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int key = ((i * 7) % SIZE_SML_TEST) << 1;
+        map->put(map, (void*)(intptr_t)key, (void*)(intptr_t)key);
+    }
+
+    /* The lower bound includes the equal key but the upper bound does not. */
+    TreeMapIter iter;
+    map->lower_bound(map, (void*)(intptr_t)10, &iter);
+    Pair* ptr_pair = TreeMapIterNext(&iter);
+    CU_ASSERT_EQUAL(10, (int)(intptr_t)ptr_pair->key);
+    ptr_pair = TreeMapIterNext(&iter);
+    CU_ASSERT_EQUAL(12, (int)(intptr_t)ptr_pair->key);
+
+    map->upper_bound(map, (void*)(intptr_t)10, &iter);
+    ptr_pair = TreeMapIterNext(&iter);
+    CU_ASSERT_EQUAL(12, (int)(intptr_t)ptr_pair->key);
+
+    map->lower_bound(map, (void*)(intptr_t)11, &iter);
+    ptr_pair = TreeMapIterNext(&iter);
+    CU_ASSERT_EQUAL(12, (int)(intptr_t)ptr_pair->key);
+
+    map->lower_bound(map, (void*)(intptr_t)-1, &iter);
+    ptr_pair = TreeMapIterNext(&iter);
+    CU_ASSERT_EQUAL(0, (int)(intptr_t)ptr_pair->key);
+
+    /* Bound beyond the maximum key reaches the map end. */
+    map->upper_bound(map, (void*)(intptr_t)((SIZE_SML_TEST - 1) << 1), &iter);
+    CU_ASSERT(TreeMapIterNext(&iter) == NULL);
+
+    /* Scan the range [10, 20) which covers 10, 12, 14, 16, and 18. */
+    int sum = 0;
+    unsigned count = map->range(map, (void*)(intptr_t)10, (void*)(intptr_t)20,
+                                SumKey, &sum);
+    CU_ASSERT_EQUAL(count, 5);
+    CU_ASSERT_EQUAL(sum, 70);
+
+    /* Scan the whole map and the empty ranges. */
+    sum = 0;
+    count = map->range(map, (void*)(intptr_t)0,
+                       (void*)(intptr_t)(SIZE_SML_TEST << 1), SumKey, &sum);
+    CU_ASSERT_EQUAL(count, SIZE_SML_TEST);
+    CU_ASSERT_EQUAL(sum, SIZE_SML_TEST * (SIZE_SML_TEST - 1));
+
+    count = map->range(map, (void*)(intptr_t)11, (void*)(intptr_t)12, SumKey, &sum);
+    CU_ASSERT_EQUAL(count, 0);
+    count = map->range(map, (void*)(intptr_t)20, (void*)(intptr_t)10, SumKey, &sum);
+    CU_ASSERT_EQUAL(count, 0);
+    TreeMapDeinit(map);
+
+    /* Query an empty map. */
+    map = TreeMapInit();
+    map->lower_bound(map, (void*)(intptr_t)0, &iter);
+    CU_ASSERT(TreeMapIterNext(&iter) == NULL);
+    count = map->range(map, (void*)(intptr_t)0, (void*)(intptr_t)10, SumKey, &sum);
+    CU_ASSERT_EQUAL(count, 0);
+    TreeMapDeinit(map);
+}
+
+void TestRankSelect()
+{
+    srand(time(NULL));
+
+    TreeMap* map = TreeMapInit();
+    CU_ASSERT(map->select(map, 0) == NULL);
+    CU_ASSERT_EQUAL(map->rank(map, (void*)(intptr_t)0), 0);
+
+    /* Shuffle the keys so that the rotations of both fixups are triggered. */
+    int elems[SIZE_MID_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        elems[i] = i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        int src = rand() % SIZE_MID_TEST;
+        int tge = rand() % SIZE_MID_TEST;
+        int temp = elems[src];
+        elems[src] = elems[tge];
+        elems[tge] = temp;
+    }
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+
+    /* Duplicated keys should not break the subtree sizes. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+
+    /* Remove the odd keys in the shuffled order. */
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        if (elems[i] & 1)
+            CU_ASSERT(map->remove(map, (void*)(intptr_t)elems[i]) == true);
+    }
+
+    /* The surviving even key 2k should be ranked as k. */
+    int half = SIZE_MID_TEST >> 1;
+    for (i = 0 ; i < half ; ++i) {
+        Pair* ptr_pair = map->select(map, i);
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, i << 1);
+        CU_ASSERT_EQUAL(map->rank(map, (void*)(intptr_t)(i << 1)), i);
+        CU_ASSERT_EQUAL(map->rank(map, (void*)(intptr_t)((i << 1) + 1)), i + 1);
+    }
+    CU_ASSERT(map->select(map, half) == NULL);
+    CU_ASSERT_EQUAL(map->rank(map, (void*)(intptr_t)-1), 0);
+
+    TreeMapDeinit(map);
+}
+
+void TestBuildSorted()
+{
+    Pair pairs[SIZE_MID_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        pairs[i].key = (void*)(intptr_t)(i << 1);
+        pairs[i].value = (void*)(intptr_t)i;
+    }
+
+    /* Try all the small sizes to cover the partially filled deepest level. */
+    int size;
+    for (size = 0 ; size <= SIZE_TNY_TEST ; ++size) {
+        TreeMap* map = TreeMapInit();
+        CU_ASSERT(map->build_sorted(map, pairs, size) == true);
+        CU_ASSERT_EQUAL(map->size(map), size);
+        for (i = 0 ; i < size ; ++i) {
+            CU_ASSERT_EQUAL(map->get(map, pairs[i].key), pairs[i].value);
+            CU_ASSERT_EQUAL(map->select(map, i)->key, pairs[i].key);
+        }
+        TreeMapDeinit(map);
+    }
+
+    /* The built tree should stay valid under the following modifications. */
+    TreeMap* map = TreeMapInit();
+    CU_ASSERT(map->use_pool(map) == true);
+    CU_ASSERT(map->build_sorted(map, pairs, SIZE_MID_TEST) == true);
+    CU_ASSERT(map->build_sorted(map, pairs, SIZE_MID_TEST) == false);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)((i << 1) + 1), (void*)(intptr_t)i);
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)(i << 1)) == true);
+
+    int prev = -1;
+    unsigned count = 0;
+    Pair* ptr_pair;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        CU_ASSERT(key > prev);
+        CU_ASSERT_EQUAL(map->rank(map, ptr_pair->key), count);
+        prev = key;
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, SIZE_MID_TEST + (SIZE_MID_TEST >> 1));
+    TreeMapDeinit(map);
+
+    /* The unsorted or duplicated keys should be rejected. */
+    map = TreeMapInit();
+    pairs[1].key = pairs[0].key;
+    CU_ASSERT(map->build_sorted(map, pairs, SIZE_TNY_TEST) == false);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    pairs[1].key = (void*)(intptr_t)-1;
+    CU_ASSERT(map->build_sorted(map, pairs, SIZE_TNY_TEST) == false);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    CU_ASSERT(map->minimum(map) == NULL);
+    TreeMapDeinit(map);
+}
+
+static int num_clean;
+
+void CountClean(void* value)
+{
+    ++num_clean;
+}
+
+void TestUnionSplit()
+{
+    srand(time(NULL));
+    num_clean = 0;
+
+    /* The designated map holds the multiples of 2 and the source map holds the
+       multiples of 3, so the multiples of 6 are replaced. */
+    TreeMap* lhs = TreeMapInit();
+    TreeMap* rhs = TreeMapInit();
+    lhs->set_clean_value(lhs, CountClean);
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i) {
+        int key = rand() % SIZE_LGE_TEST;
+        lhs->put(lhs, (void*)(intptr_t)(key << 1), (void*)(intptr_t)0);
+        rhs->put(rhs, (void*)(intptr_t)(key * 3), (void*)(intptr_t)1);
+    }
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i) {
+        lhs->put(lhs, (void*)(intptr_t)(i << 1), (void*)(intptr_t)0);
+        rhs->put(rhs, (void*)(intptr_t)(i * 3), (void*)(intptr_t)1);
+    }
+    num_clean = 0;
+
+    CU_ASSERT(TreeMapUnion(lhs, rhs) == true);
+    CU_ASSERT_EQUAL(rhs->size(rhs), 0);
+    CU_ASSERT(rhs->minimum(rhs) == NULL);
+
+    int num_dup = (SIZE_LGE_TEST + 2) / 3;
+    CU_ASSERT_EQUAL(num_clean, num_dup);
+    CU_ASSERT_EQUAL(lhs->size(lhs), (SIZE_LGE_TEST << 1) - num_dup);
+
+    int prev = -1;
+    unsigned count = 0;
+    Pair* ptr_pair;
+    lhs->first(lhs);
+    while ((ptr_pair = lhs->next(lhs)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        CU_ASSERT(key > prev);
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->value, (key % 3 == 0)? 1 : 0);
+        CU_ASSERT_EQUAL(lhs->rank(lhs, ptr_pair->key), count);
+        prev = key;
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, lhs->size(lhs));
+
+    /* Split into the map with the internal pool, which copies the nodes. */
+    CU_ASSERT(rhs->use_pool(rhs) == true);
+    int pivot = SIZE_LGE_TEST;
+    unsigned rank = lhs->rank(lhs, (void*)(intptr_t)pivot);
+    unsigned size = lhs->size(lhs);
+    CU_ASSERT(TreeMapSplit(lhs, (void*)(intptr_t)pivot, rhs) == true);
+    CU_ASSERT_EQUAL(lhs->size(lhs), rank);
+    CU_ASSERT_EQUAL(rhs->size(rhs), size - rank);
+    CU_ASSERT_EQUAL((int)(intptr_t)rhs->minimum(rhs)->key, pivot);
+    CU_ASSERT((int)(intptr_t)lhs->maximum(lhs)->key < pivot);
+    CU_ASSERT(TreeMapSplit(lhs, (void*)(intptr_t)0, rhs) == false);
+
+    /* Both halves should stay valid under the following modifications. */
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        lhs->remove(lhs, (void*)(intptr_t)(i << 1));
+        rhs->put(rhs, (void*)(intptr_t)(pivot + (i << 2) + 1), (void*)(intptr_t)0);
+    }
+    for (i = 0 ; i < (int)rhs->size(rhs) ; ++i) {
+        ptr_pair = rhs->select(rhs, i);
+        CU_ASSERT_EQUAL(rhs->rank(rhs, ptr_pair->key), i);
+    }
+
+    /* Fold the split part back from the pool, which copies the nodes again. */
+    size = lhs->size(lhs) + rhs->size(rhs);
+    CU_ASSERT(TreeMapUnion(lhs, rhs) == true);
+    CU_ASSERT_EQUAL(lhs->size(lhs), size);
+    TreeMapDeinit(rhs);
+
+    /* Split at both ends. */
+    rhs = TreeMapInit();
+    CU_ASSERT(TreeMapSplit(lhs, (void*)(intptr_t)(SIZE_LGE_TEST << 3), rhs) == true);
+    CU_ASSERT_EQUAL(rhs->size(rhs), 0);
+    CU_ASSERT(TreeMapSplit(lhs, (void*)(intptr_t)-1, rhs) == true);
+    CU_ASSERT_EQUAL(lhs->size(lhs), 0);
+    CU_ASSERT_EQUAL(rhs->size(rhs), size);
+    TreeMapDeinit(lhs);
+    TreeMapDeinit(rhs);
+}
+
+/* The running order check folded by the parallel reduction. */
+typedef struct Order_ {
+    unsigned count;
+    intptr_t first;
+    intptr_t last;
+    bool sorted;
+} Order;
+
+void AccumulateOrder(void* acc, void* item, void* ctx)
+{
+    Order* order = (Order*)acc;
+    intptr_t key = (intptr_t)((Pair*)item)->key;
+    if (order->count == 0)
+        order->first = key;
+    else if (order->last >= key)
+        order->sorted = false;
+    order->last = key;
+    ++(order->count);
+}
+
+void CombineOrder(void* dst, const void* src, void* ctx)
+{
+    Order* lhs = (Order*)dst;
+    const Order* rhs = (const Order*)src;
+    if (rhs->count == 0)
+        return;
+    if (lhs->count == 0) {
+        *lhs = *rhs;
+        return;
+    }
+    lhs->sorted = lhs->sorted && rhs->sorted && lhs->last < rhs->first;
+    lhs->last = rhs->last;
+    lhs->count += rhs->count;
+}
+
+void VisitSum(Pair* ptr_pair, void* arg)
+{
+    __atomic_fetch_add((uint64_t*)arg, (uint64_t)(intptr_t)ptr_pair->value,
+                       __ATOMIC_RELAXED);
+}
+
+void TestTraverseParallel()
+{
+    TreeMap* map = TreeMapInit();
+    int size = SIZE_LGE_TEST << 4;
+    int i;
+    for (i = 0 ; i < size ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    uint64_t expect = (uint64_t)size * (size - 1) / 2;
+    unsigned num_thread;
+    for (num_thread = 1 ; num_thread <= 8 ; num_thread <<= 1) {
+        uint64_t sum = 0;
+        TreeMapForEachParallel(map, VisitSum, &sum, num_thread);
+        CU_ASSERT_EQUAL(sum, expect);
+
+        /* The partial results are combined in the key order. */
+        Reducer reducer = {sizeof(Order), AccumulateOrder, CombineOrder, NULL};
+        Order order = {0, 0, 0, true};
+        TreeMapReduceParallel(map, &reducer, &order, num_thread);
+        CU_ASSERT_EQUAL(order.count, size);
+        CU_ASSERT(order.sorted == true);
+        CU_ASSERT_EQUAL(order.first, 0);
+        CU_ASSERT_EQUAL(order.last, size - 1);
+    }
+    TreeMapDeinit(map);
+
+    /* The empty map leaves the identity result. */
+    map = TreeMapInit();
+    Reducer reducer = {sizeof(Order), AccumulateOrder, CombineOrder, NULL};
+    Order order = {0, 0, 0, true};
+    TreeMapReduceParallel(map, &reducer, &order, 4);
+    CU_ASSERT_EQUAL(order.count, 0);
+    TreeMapDeinit(map);
+}
+
+void TestUnionParallel()
+{
+    TreeMap* lhs = TreeMapInit();
+    TreeMap* rhs = TreeMapInit();
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i) {
+        lhs->put(lhs, (void*)(intptr_t)(i << 1), (void*)(intptr_t)i);
+        rhs->put(rhs, (void*)(intptr_t)((i << 1) + 1), (void*)(intptr_t)i);
+    }
+
+    CU_ASSERT(TreeMapUnionParallel(lhs, rhs, 4) == true);
+    CU_ASSERT_EQUAL(lhs->size(lhs), SIZE_LGE_TEST << 1);
+    CU_ASSERT_EQUAL(rhs->size(rhs), 0);
+    for (i = 0 ; i < (SIZE_LGE_TEST << 1) ; ++i) {
+        Pair* ptr_pair = lhs->select(lhs, i);
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, i);
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->value, i >> 1);
+    }
+
+    TreeMapDeinit(lhs);
+    TreeMapDeinit(rhs);
+}
+
 void TestPutDupText()
 {
     char buf[SIZE_TNY_TEST];
@@ -500,6 +918,192 @@ void TestBulkTxt()
     TreeMapDeinit(map);
 }
 
+void TestStats()
+{
+    TreeMap* map = TreeMapInit();
+    TreeMapStats stats;
+    map->get_stats(map, &stats);
+    CU_ASSERT_EQUAL(stats.size, 0);
+    CU_ASSERT_EQUAL(stats.height, 0);
+
+    /* The ascending insertion keeps rotating the tree. */
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == true);
+
+    /* The red black tree is at most twice as high as the perfect one. */
+    map->get_stats(map, &stats);
+    CU_ASSERT_EQUAL(stats.size, SIZE_LGE_TEST);
+    CU_ASSERT(stats.height >= 13 && stats.height <= 24);
+
+    /* The counters are maintained only in the instrumented build. */
+    if (stats.instrumented) {
+        CU_ASSERT_EQUAL(stats.num_lookup, SIZE_LGE_TEST << 1);
+        CU_ASSERT(stats.num_probe >= SIZE_LGE_TEST);
+        CU_ASSERT(stats.num_rotate > 0);
+        CU_ASSERT_EQUAL(stats.bytes_alloc % SIZE_LGE_TEST, 0);
+    } else {
+        CU_ASSERT_EQUAL(stats.num_lookup, 0);
+        CU_ASSERT_EQUAL(stats.num_rotate, 0);
+        CU_ASSERT_EQUAL(stats.bytes_alloc, 0);
+    }
+    TreeMapDeinit(map);
+}
+
+void TestSnapshot()
+{
+    TreeMap* map = TreeMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+
+    char buf[SIZE_MID_STR];
+    int i;
+    for (i = SIZE_LGE_TEST - 1 ; i >= 0 ; --i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %05d", i);
+        map->put(map, strdup(buf), (void*)(intptr_t)i);
+    }
+
+    SnapshotCodec codec = {EncodeText, DecodeText, NULL};
+    FILE* file = tmpfile();
+    CU_ASSERT(file != NULL);
+    SnapshotWriter writer = {CdsWriteFile, file};
+    CU_ASSERT(TreeMapSnapshot(map, &writer, &codec, NULL) == true);
+
+    /* The restore only builds the empty map. */
+    rewind(file);
+    SnapshotReader reader = {CdsReadFile, file};
+    CU_ASSERT(TreeMapRestore(map, &reader, &codec, NULL) == false);
+    TreeMapDeinit(map);
+
+    /* The tree is built from the sorted pairs and stays balanced. */
+    map = TreeMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    rewind(file);
+    CU_ASSERT(TreeMapRestore(map, &reader, &codec, NULL) == true);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_LGE_TEST);
+
+    TreeMapIter iter;
+    TreeMapIterInit(map, &iter, false);
+    Pair* ptr_pair;
+    i = 0;
+    while ((ptr_pair = TreeMapIterNext(&iter)) != NULL) {
+        snprintf(buf, SIZE_MID_STR, "key -> %05d", i);
+        CU_ASSERT(strcmp((char*)ptr_pair->key, buf) == 0);
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->value, i);
+        ++i;
+    }
+    CU_ASSERT_EQUAL(i, SIZE_LGE_TEST);
+
+    TreeMapStats stats;
+    map->get_stats(map, &stats);
+    CU_ASSERT(stats.height <= 13);
+    if (stats.instrumented)
+        CU_ASSERT_EQUAL(stats.num_rotate, 0);
+    CU_ASSERT(map->put(map, strdup("key"), (void*)(intptr_t)0) == true);
+    CU_ASSERT(map->remove(map, "key -> 00000") == true);
+    TreeMapDeinit(map);
+
+    /* The pairs out of the map order are released. */
+    map = TreeMapInit();
+    map->set_compare(map, CompareKeyReverse);
+    map->set_clean_key(map, CleanKey);
+    rewind(file);
+    CU_ASSERT(TreeMapRestore(map, &reader, &codec, NULL) == false);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    TreeMapDeinit(map);
+
+    /* The truncated snapshot is rejected. */
+    long size = ftell(file);
+    char* bytes = (char*)malloc(size);
+    rewind(file);
+    CU_ASSERT(fread(bytes, 1, size, file) == (size_t)size);
+    fclose(file);
+
+    map = TreeMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    SnapshotMemory memory = {bytes, size - 1, 0};
+    reader.read = CdsReadMemory;
+    reader.ctx = &memory;
+    CU_ASSERT(TreeMapRestore(map, &reader, &codec, NULL) == false);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+
+    memory.size = size;
+    memory.offset = 0;
+    CU_ASSERT(TreeMapRestore(map, &reader, &codec, NULL) == true);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_LGE_TEST);
+    TreeMapDeinit(map);
+    free(bytes);
+}
+
+static int num_alloc;
+
+void* CountAlloc(void* ctx, size_t size)
+{
+    ++num_alloc;
+    return malloc(size);
+}
+
+void CountFree(void* ctx, void* ptr)
+{
+    --num_alloc;
+    free(ptr);
+}
+
+void TestAllocator()
+{
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+
+    /* Apply the custom allocator to the map. */
+    TreeMap* map = TreeMapInit();
+    CU_ASSERT(map->set_allocator(map, &alloc) == true);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST);
+    CU_ASSERT(map->set_allocator(map, NULL) == false);
+    CU_ASSERT(map->use_pool(map) == false);
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2)
+        map->remove(map, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST >> 1);
+    TreeMapDeinit(map);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* The global allocator is captured at construction. */
+    CdsSetAllocator(&alloc);
+    map = TreeMapInit();
+    CdsSetAllocator(NULL);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST);
+    TreeMapDeinit(map);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* Manage the nodes with the internal pool. */
+    map = TreeMapInit();
+    CU_ASSERT(map->use_pool(map) == true);
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    for (i = 0 ; i < SIZE_LGE_TEST ; i += 2)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == (i & 1));
+
+    /* The in-order traversal should be intact. */
+    i = 1;
+    Pair* ptr_pair;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, i);
+        i += 2;
+    }
+    TreeMapDeinit(map);
+}
+
 
 /*-----------------------------------------------------------------------------*
  *                      The driver for TreeMap unit test                       *
@@ -535,6 +1139,34 @@ bool AddSuite()
         unit = CU_add_test(suite, "Reverse Iterator", TestReverseIterate);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "External Iterator", TestExternalIterator);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Bound Cursor and Range Query", TestRangeQuery);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Rank and Select", TestRankSelect);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Bulk Build from Sorted Pairs", TestBuildSorted);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Union and Split", TestUnionSplit);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Parallel Union", TestUnionParallel);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Parallel Traversal", TestTraverseParallel);
+        if (!unit)
+            return false;
     }
     {
         /* Test its robustness to maintain complex data types and large data set. */
@@ -553,6 +1185,18 @@ bool AddSuite()
         unit = CU_add_test(suite, "Bulk Text Maintenance", TestBulkTxt);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Node Allocation via Allocator and Pool", TestAllocator);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Runtime Statistics", TestStats);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Snapshot and Restore", TestSnapshot);
+        if (!unit)
+            return false;
     }
 
     return true;
@@ -7,6 +7,23 @@ static const int SIZE_TXT_BUFF = 32;
 static const int SIZE_TNY_TEST = 128;
 static const int SIZE_SML_TEST = 512;
 
+/* Whether the structure verification runs against the radix representation. */
+static bool use_radix = false;
+
+Trie* NewTrie()
+{
+    Trie* trie = TrieInit();
+    if (trie && use_radix)
+        trie->use_radix(trie);
+    return trie;
+}
+
+int EnterRadixMode()
+{
+    use_radix = true;
+    return 0;
+}
+
 
 /*-----------------------------------------------------------------------------*
  *            Unit tests relevant to basic structure verification              *
@@ -28,7 +45,7 @@ void TestNewDelete()
     }
 
     Trie* trie;
-    CU_ASSERT((trie = TrieInit()) != NULL);
+    CU_ASSERT((trie = NewTrie()) != NULL);
 
     /* Enlarge the trie size to test the destructor. */
     for (i = 0 ; i < SIZE_SML_TEST ; ++i)
@@ -43,7 +60,7 @@ void TestNewDelete()
 void TestInsert()
 {
     {
-        Trie* trie = TrieInit();
+        Trie* trie = NewTrie();
 
         const char* prefix = "abcdefghijklmnopqrstuvwxyz\0";
         int len = strlen(prefix);
@@ -68,7 +85,7 @@ void TestInsert()
         TrieDeinit(trie);
     }
     {
-        Trie* trie = TrieInit();
+        Trie* trie = NewTrie();
 
         const char* suffix = "abcdefghijklmnopqrstuvwxyz\0";
         int len = strlen(suffix);
@@ -92,7 +109,7 @@ void TestInsert()
 
 void TestSearchExact()
 {
-    Trie* trie = TrieInit();
+    Trie* trie = NewTrie();
 
     const char* seq = "nopqrstuvwxyzzyxwvutsrqponmlkjihgfedcba\0";
     int len = strlen(seq);
@@ -133,7 +150,7 @@ void TestSearchExact()
 
 void TestSearchPrefix()
 {
-    Trie* trie = TrieInit();
+    Trie* trie = NewTrie();
 
     char buf[4];
     char ch_i, ch_j, ch_k;
@@ -209,7 +226,7 @@ void TestSearchPrefix()
 
 void TestBulkInsert()
 {
-    Trie* trie = TrieInit();
+    Trie* trie = NewTrie();
 
     const char *seq = "abcdefghijklmnopqrstuvwxyzzyxwvutsrqponmlkjihgfedcba"
                       "ABCDEFGHIJKLMNOPQRSTUVWXYZZYXWVUTSRQPONMLKJIHGFEDCBA\0";
@@ -271,7 +288,7 @@ void TestBulkInsert()
 
 void TestRemoveAndVerify()
 {
-    Trie* trie = TrieInit();
+    Trie* trie = NewTrie();
 
     char buf[4];
     char ch_i, ch_j, ch_k;
@@ -338,9 +355,34 @@ void TestRemoveAndVerify()
     TrieDeinit(trie);
 }
 
+void TestStalePrefix()
+{
+    /* The ternary removal keeps the nodes of the removed strings, so the
+       search should not climb out of the stale branch under the prefix. */
+    Trie* trie = TrieInit();
+    CU_ASSERT(trie->insert(trie, "abc") == true);
+    CU_ASSERT(trie->insert(trie, "abd") == true);
+    CU_ASSERT(trie->insert(trie, "b") == true);
+    CU_ASSERT(trie->insert(trie, "aa") == true);
+
+    CU_ASSERT(trie->remove(trie, "abc") == true);
+    CU_ASSERT(trie->has_prefix_as(trie, "ab") == true);
+    CU_ASSERT(trie->remove(trie, "abd") == true);
+    CU_ASSERT(trie->has_prefix_as(trie, "ab") == false);
+    CU_ASSERT(trie->has_prefix_as(trie, "abc") == false);
+    CU_ASSERT(trie->has_prefix_as(trie, "a") == true);
+    CU_ASSERT(trie->has_prefix_as(trie, "b") == true);
+
+    CU_ASSERT(trie->remove(trie, "aa") == true);
+    CU_ASSERT(trie->has_prefix_as(trie, "a") == false);
+    CU_ASSERT(trie->has_prefix_as(trie, "b") == true);
+
+    TrieDeinit(trie);
+}
+
 void TestGetPrefix()
 {
-    Trie *trie = TrieInit();
+    Trie *trie = NewTrie();
     const char** strs;
     unsigned size;
 
@@ -505,6 +547,490 @@ void TestGetPrefix()
     TrieDeinit(trie);
 }
 
+typedef struct {
+    unsigned count;
+    unsigned stop;
+    char** strs;
+} Record;
+
+bool RecordString(const char* str, void* arg)
+{
+    Record* record = (Record*)arg;
+    record->strs[record->count++] = strdup(str);
+    return record->count != record->stop;
+}
+
+void ResetRecord(Record* record, unsigned stop)
+{
+    unsigned i;
+    for (i = 0 ; i < record->count ; ++i)
+        free(record->strs[i]);
+    record->count = 0;
+    record->stop = stop;
+}
+
+void TestVisitPrefix()
+{
+    Trie* trie = NewTrie();
+    Record record;
+    record.count = 0;
+    record.stop = 0;
+    record.strs = (char**)malloc(sizeof(char*) * SIZE_SML_TEST);
+
+    /* Pass dummy or non-existing prefix. */
+    CU_ASSERT_EQUAL(trie->visit_prefix(trie, NULL, 0, RecordString, &record), 0);
+    CU_ASSERT_EQUAL(trie->visit_prefix(trie, "\0", 0, RecordString, &record), 0);
+    CU_ASSERT_EQUAL(trie->visit_prefix(trie, "ab\0", 0, RecordString, &record), 0);
+
+    /* Insert all the strings up to 4 bytes from a four letter alphabet, and
+       skip some of them to leave the string end marks sparse. */
+    char buf[SIZE_TXT_BUFF];
+    int num = 0;
+    int i, j;
+    for (i = 0 ; i < 4 + 16 + 64 + 256 ; ++i) {
+        int order = i;
+        int len = 1;
+        int span = 4;
+        while (order >= span) {
+            order -= span;
+            span <<= 2;
+            ++len;
+        }
+        for (j = len - 1 ; j >= 0 ; --j) {
+            buf[j] = 'a' + (order & 3);
+            order >>= 2;
+        }
+        buf[len] = 0;
+        if (i % 3 == 0 || len == 4) {
+            CU_ASSERT(trie->insert(trie, buf) == true);
+            ++num;
+        }
+    }
+
+    /* The visit order and results should agree with the retrieved array. */
+    const char** strs;
+    unsigned size;
+    const char* prefixes[] = {"a", "b", "ab", "bcd", "dddd", "da", "c"};
+    int num_prefix = sizeof(prefixes) / sizeof(const char*);
+    for (i = 0 ; i < num_prefix ; ++i) {
+        ResetRecord(&record, 0);
+        unsigned count = trie->visit_prefix(trie, prefixes[i], 0, RecordString,
+                                            &record);
+        CU_ASSERT(trie->get_prefix_as(trie, prefixes[i], &strs, &size) == true);
+        CU_ASSERT_EQUAL(count, size);
+        CU_ASSERT_EQUAL(record.count, size);
+        for (j = 0 ; j < (int)size ; ++j) {
+            CU_ASSERT(strcmp(record.strs[j], strs[j]) == 0);
+            if (j > 0)
+                CU_ASSERT(strcmp(record.strs[j - 1], record.strs[j]) < 0);
+            free((char*)strs[j]);
+        }
+        free(strs);
+    }
+
+    /* Stop at the designated limit. */
+    ResetRecord(&record, 0);
+    CU_ASSERT_EQUAL(trie->visit_prefix(trie, "b", 5, RecordString, &record), 5);
+    CU_ASSERT_EQUAL(record.count, 5);
+    CU_ASSERT(trie->get_prefix_as(trie, "b", &strs, &size) == true);
+    for (j = 0 ; j < (int)size ; ++j) {
+        if (j < 5)
+            CU_ASSERT(strcmp(record.strs[j], strs[j]) == 0);
+        free((char*)strs[j]);
+    }
+    free(strs);
+
+    /* Stop as soon as the visit function declines. */
+    ResetRecord(&record, 3);
+    CU_ASSERT_EQUAL(trie->visit_prefix(trie, "c", 0, RecordString, &record), 3);
+    CU_ASSERT_EQUAL(record.count, 3);
+
+    /* Walk through the whole trie via all the first letters. */
+    unsigned total = 0;
+    for (i = 0 ; i < 4 ; ++i) {
+        buf[0] = 'a' + i;
+        buf[1] = 0;
+        ResetRecord(&record, 0);
+        total += trie->visit_prefix(trie, buf, 0, RecordString, &record);
+    }
+    CU_ASSERT_EQUAL(total, num);
+
+    /* The string longer than the local spelling buffer. */
+    char* longest = (char*)malloc(sizeof(char) * (SIZE_SML_TEST + 1));
+    memset(longest, 'e', sizeof(char) * SIZE_SML_TEST);
+    longest[SIZE_SML_TEST] = 0;
+    CU_ASSERT(trie->insert(trie, longest) == true);
+    ResetRecord(&record, 0);
+    CU_ASSERT_EQUAL(trie->visit_prefix(trie, "e", 0, RecordString, &record), 1);
+    CU_ASSERT(strcmp(record.strs[0], longest) == 0);
+    free(longest);
+
+    ResetRecord(&record, 0);
+    free(record.strs);
+    TrieDeinit(trie);
+}
+
+void TestUnicodeOrder()
+{
+    /* The UTF-8 bytes of "pé" and "pó" and a raw high byte should follow the
+       ASCII ones as in strcmp. */
+    const char* sorted[] = {"p", "pa", "pz", "p\x7f", "p\xc3\xa9",
+                            "p\xc3\xa9t", "p\xc3\xb3", "p\xff"};
+    int num = sizeof(sorted) / sizeof(const char*);
+
+    Trie* trie = NewTrie();
+    int i;
+    for (i = num - 1 ; i >= 0 ; --i)
+        CU_ASSERT(trie->insert(trie, sorted[i]) == true);
+
+    Record record;
+    record.count = 0;
+    record.stop = 0;
+    record.strs = (char**)malloc(sizeof(char*) * SIZE_TNY_TEST);
+    CU_ASSERT_EQUAL(trie->visit_prefix(trie, "p", 0, RecordString, &record), num);
+    for (i = 0 ; i < num && i < (int)record.count ; ++i)
+        CU_ASSERT(strcmp(record.strs[i], sorted[i]) == 0);
+
+    /* The frozen image keeps the same order. */
+    const char* path = "unit_trie.unicode";
+    CU_ASSERT(trie->freeze(trie, path) == true);
+    Trie* frozen = TrieLoad(path);
+    CU_ASSERT(frozen != NULL);
+    ResetRecord(&record, 0);
+    CU_ASSERT_EQUAL(frozen->visit_prefix(frozen, "p", 0, RecordString, &record),
+                    num);
+    for (i = 0 ; i < num && i < (int)record.count ; ++i)
+        CU_ASSERT(strcmp(record.strs[i], sorted[i]) == 0);
+    CU_ASSERT(frozen->has_exact(frozen, "p\xc3\xa9") == true);
+    CU_ASSERT(frozen->has_prefix_as(frozen, "p\xc3") == true);
+    TrieDeinit(frozen);
+    remove(path);
+
+    ResetRecord(&record, 0);
+    free(record.strs);
+    TrieDeinit(trie);
+}
+
+void TestFreeze()
+{
+    const char* path = "unit_trie.frozen";
+    Trie* trie = NewTrie();
+
+    /* Freeze and load the empty trie. */
+    CU_ASSERT(trie->freeze(trie, NULL) == false);
+    CU_ASSERT(trie->freeze(trie, path) == true);
+    Trie* frozen = TrieLoad(path);
+    CU_ASSERT(frozen != NULL);
+    CU_ASSERT_EQUAL(frozen->size(frozen), 0);
+    CU_ASSERT(frozen->has_prefix_as(frozen, "a") == false);
+    TrieDeinit(frozen);
+
+    /* Insert the strings sharing long prefixes, and then remove some of them. */
+    char buf[SIZE_TXT_BUFF];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "key%d", i * 7);
+        CU_ASSERT(trie->insert(trie, buf) == true);
+    }
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 5) {
+        snprintf(buf, SIZE_TXT_BUFF, "key%d", i * 7);
+        CU_ASSERT(trie->remove(trie, buf) == true);
+    }
+
+    /* The image should keep the bytes above 0x7f after the ASCII ones. */
+    CU_ASSERT(trie->insert(trie, "key\xc3\xa9") == true);
+    CU_ASSERT(trie->insert(trie, "key\xff") == true);
+    CU_ASSERT(trie->freeze(trie, path) == true);
+
+    frozen = TrieLoad(path);
+    CU_ASSERT(frozen != NULL);
+    CU_ASSERT_EQUAL(frozen->size(frozen), trie->size(trie));
+
+    /* The queries should agree with the original trie. */
+    for (i = 0 ; i < SIZE_SML_TEST * 7 ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "key%d", i);
+        CU_ASSERT(frozen->has_exact(frozen, buf) == trie->has_exact(trie, buf));
+        CU_ASSERT(frozen->has_prefix_as(frozen, buf) ==
+                  trie->has_prefix_as(trie, buf));
+    }
+    CU_ASSERT(frozen->has_exact(frozen, "key") == false);
+    CU_ASSERT(frozen->has_prefix_as(frozen, "ke") == true);
+    CU_ASSERT(frozen->has_prefix_as(frozen, "kez") == false);
+
+    const char** strs;
+    const char** dups;
+    unsigned size, num_dup;
+    const char* prefixes[] = {"k", "key1", "key35", "key7", "key3493"};
+    int num_prefix = sizeof(prefixes) / sizeof(const char*);
+    for (i = 0 ; i < num_prefix ; ++i) {
+        CU_ASSERT(frozen->get_prefix_as(frozen, prefixes[i], &strs, &size) == true);
+        CU_ASSERT(trie->get_prefix_as(trie, prefixes[i], &dups, &num_dup) == true);
+        CU_ASSERT_EQUAL(size, num_dup);
+        unsigned j;
+        for (j = 0 ; j < size ; ++j) {
+            CU_ASSERT(strcmp(strs[j], dups[j]) == 0);
+            free((char*)strs[j]);
+            free((char*)dups[j]);
+        }
+        free(strs);
+        free(dups);
+    }
+    CU_ASSERT(frozen->get_prefix_as(frozen, "key0", &strs, &size) == false);
+
+    Record record;
+    record.count = 0;
+    record.stop = 0;
+    record.strs = (char**)malloc(sizeof(char*) * SIZE_SML_TEST);
+    CU_ASSERT_EQUAL(frozen->visit_prefix(frozen, "key1", 3, RecordString,
+                                         &record), 3);
+    CU_ASSERT(trie->get_prefix_as(trie, "key1", &dups, &num_dup) == true);
+    for (i = 0 ; i < (int)num_dup ; ++i) {
+        if (i < 3)
+            CU_ASSERT(strcmp(record.strs[i], dups[i]) == 0);
+        free((char*)dups[i]);
+    }
+    free(dups);
+    ResetRecord(&record, 0);
+
+    CU_ASSERT_EQUAL(frozen->visit_prefix(frozen, "key", 0, RecordString,
+                                         &record), trie->size(trie));
+    for (i = 1 ; i < (int)record.count ; ++i)
+        CU_ASSERT(strcmp(record.strs[i - 1], record.strs[i]) < 0);
+    CU_ASSERT(strcmp(record.strs[record.count - 1], "key\xff") == 0);
+    ResetRecord(&record, 0);
+    free(record.strs);
+
+    /* The loaded trie is read-only. */
+    CU_ASSERT(frozen->insert(frozen, "key") == false);
+    CU_ASSERT(frozen->bulk_insert(frozen, prefixes, num_prefix) == false);
+    CU_ASSERT(frozen->remove(frozen, "key7") == false);
+    CU_ASSERT(frozen->has_exact(frozen, "key7") == true);
+    CU_ASSERT(frozen->use_pool(frozen) == false);
+    CU_ASSERT(frozen->use_radix(frozen) == false);
+    CU_ASSERT(frozen->set_allocator(frozen, NULL) == false);
+
+    /* Freeze the loaded trie again. */
+    const char* copy = "unit_trie.refrozen";
+    CU_ASSERT(frozen->freeze(frozen, copy) == true);
+    TrieDeinit(frozen);
+    frozen = TrieLoad(copy);
+    CU_ASSERT(frozen != NULL);
+    CU_ASSERT_EQUAL(frozen->size(frozen), trie->size(trie));
+    CU_ASSERT(frozen->has_exact(frozen, "key7") == true);
+    TrieDeinit(frozen);
+    remove(copy);
+
+    /* Reject the file which is not a frozen image. */
+    FILE* file = fopen(path, "wb");
+    fputs("not a frozen trie image", file);
+    fclose(file);
+    CU_ASSERT(TrieLoad(path) == NULL);
+    CU_ASSERT(TrieLoad("unit_trie.missing") == NULL);
+
+    remove(path);
+    TrieDeinit(trie);
+}
+
+void TestWideNode()
+{
+    Trie* trie = NewTrie();
+
+    /* Let the root and its children fan out to all the possible bytes, so
+       that the child selection spans several search blocks. */
+    char buf[SIZE_TXT_BUFF];
+    int i, j;
+    for (i = 1 ; i < 256 ; ++i) {
+        buf[0] = (char)i;
+        buf[1] = 0;
+        CU_ASSERT(trie->insert(trie, buf) == true);
+        for (j = 1 ; j < 256 ; j += 7) {
+            buf[1] = (char)j;
+            buf[2] = 0;
+            CU_ASSERT(trie->insert(trie, buf) == true);
+        }
+    }
+
+    const char* path = "unit_trie_wide.frozen";
+    CU_ASSERT(trie->freeze(trie, path) == true);
+    Trie* frozen = TrieLoad(path);
+    CU_ASSERT(frozen != NULL);
+
+    for (i = 1 ; i < 256 ; ++i) {
+        buf[0] = (char)i;
+        buf[1] = 0;
+        CU_ASSERT(trie->has_exact(trie, buf) == true);
+        CU_ASSERT(frozen->has_exact(frozen, buf) == true);
+        for (j = 1 ; j < 256 ; ++j) {
+            buf[1] = (char)j;
+            buf[2] = 0;
+            bool expect = (j % 7 == 1);
+            CU_ASSERT(trie->has_exact(trie, buf) == expect);
+            CU_ASSERT(frozen->has_exact(frozen, buf) == expect);
+        }
+    }
+    TrieDeinit(frozen);
+    remove(path);
+
+    /* Remove the children in the middle of the token arrays. */
+    for (i = 1 ; i < 256 ; i += 2) {
+        buf[0] = (char)i;
+        for (j = 8 ; j < 256 ; j += 14) {
+            buf[1] = (char)j;
+            buf[2] = 0;
+            CU_ASSERT(trie->remove(trie, buf) == true);
+        }
+    }
+    for (i = 1 ; i < 256 ; ++i) {
+        buf[0] = (char)i;
+        for (j = 1 ; j < 256 ; j += 7) {
+            buf[1] = (char)j;
+            buf[2] = 0;
+            bool expect = !((i % 2) && (j % 14 == 8));
+            CU_ASSERT(trie->has_exact(trie, buf) == expect);
+        }
+    }
+
+    TrieDeinit(trie);
+}
+
+static int num_alloc;
+
+void* CountAlloc(void* ctx, size_t size)
+{
+    ++num_alloc;
+    return malloc(size);
+}
+
+void CountFree(void* ctx, void* ptr)
+{
+    --num_alloc;
+    free(ptr);
+}
+
+void TestAllocator()
+{
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+
+    char buf[SIZE_TXT_BUFF];
+    int i;
+
+    /* Apply the custom allocator to the trie. */
+    Trie* trie = TrieInit();
+    CU_ASSERT(trie->set_allocator(trie, &alloc) == true);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "key -> %d", i);
+        trie->insert(trie, buf);
+    }
+    CU_ASSERT(num_alloc > 0);
+    CU_ASSERT(trie->set_allocator(trie, NULL) == false);
+    CU_ASSERT(trie->use_pool(trie) == false);
+    TrieDeinit(trie);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* The global allocator is captured at construction. */
+    CdsSetAllocator(&alloc);
+    trie = TrieInit();
+    CdsSetAllocator(NULL);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "key -> %d", i);
+        trie->insert(trie, buf);
+    }
+    CU_ASSERT(num_alloc > 0);
+    TrieDeinit(trie);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* Manage the nodes with the internal pool. */
+    trie = TrieInit();
+    CU_ASSERT(trie->use_pool(trie) == true);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "key -> %d", i);
+        CU_ASSERT(trie->insert(trie, buf) == true);
+    }
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "key -> %d", i);
+        CU_ASSERT(trie->has_exact(trie, buf) == true);
+    }
+    CU_ASSERT_EQUAL(trie->size(trie), SIZE_SML_TEST);
+    TrieDeinit(trie);
+}
+
+void TestRadix()
+{
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+
+    /* The radix representation excludes the pool and needs an empty trie. */
+    Trie* trie = TrieInit();
+    CU_ASSERT(trie->use_pool(trie) == true);
+    CU_ASSERT(trie->use_radix(trie) == false);
+    TrieDeinit(trie);
+
+    trie = TrieInit();
+    CU_ASSERT(trie->set_allocator(trie, &alloc) == true);
+    CU_ASSERT(trie->use_radix(trie) == true);
+    CU_ASSERT(trie->use_pool(trie) == false);
+    CU_ASSERT(trie->insert(trie, "romane") == true);
+    CU_ASSERT(trie->use_radix(trie) == false);
+
+    /* Split the edges at various positions. */
+    CU_ASSERT(trie->insert(trie, "romanus") == true);
+    CU_ASSERT(trie->insert(trie, "romulus") == true);
+    CU_ASSERT(trie->insert(trie, "rubens") == true);
+    CU_ASSERT(trie->insert(trie, "ruber") == true);
+    CU_ASSERT(trie->insert(trie, "rub") == true);
+    CU_ASSERT(trie->insert(trie, "rub") == true);
+    CU_ASSERT(trie->insert(trie, "rubicon") == true);
+    CU_ASSERT_EQUAL(trie->size(trie), 7);
+
+    CU_ASSERT(trie->has_exact(trie, "rub") == true);
+    CU_ASSERT(trie->has_exact(trie, "ru") == false);
+    CU_ASSERT(trie->has_exact(trie, "rubicons") == false);
+    CU_ASSERT(trie->has_prefix_as(trie, "rom") == true);
+    CU_ASSERT(trie->has_prefix_as(trie, "romu") == true);
+    CU_ASSERT(trie->has_prefix_as(trie, "romx") == false);
+    CU_ASSERT(trie->has_prefix_as(trie, "rubicons") == false);
+
+    /* The strings are retrieved in lexicographic order. */
+    const char* expect[] = {"rub", "rubens", "ruber", "rubicon"};
+    const char** strs;
+    unsigned size;
+    CU_ASSERT(trie->get_prefix_as(trie, "ru", &strs, &size) == true);
+    CU_ASSERT_EQUAL(size, 4);
+    unsigned i;
+    for (i = 0 ; i < size ; ++i) {
+        CU_ASSERT(strcmp(strs[i], expect[i]) == 0);
+        free((char*)strs[i]);
+    }
+    free(strs);
+
+    /* Removing the strings merges the pass through nodes back. */
+    CU_ASSERT(trie->remove(trie, "rub") == true);
+    CU_ASSERT(trie->remove(trie, "rub") == false);
+    CU_ASSERT(trie->remove(trie, "rubicon") == true);
+    CU_ASSERT(trie->has_exact(trie, "rubens") == true);
+    CU_ASSERT(trie->has_exact(trie, "ruber") == true);
+    CU_ASSERT(trie->has_prefix_as(trie, "rubi") == false);
+    CU_ASSERT(trie->remove(trie, "ruber") == true);
+    CU_ASSERT(trie->get_prefix_as(trie, "r", &strs, &size) == true);
+    CU_ASSERT_EQUAL(size, 4);
+    for (i = 0 ; i < size ; ++i)
+        free((char*)strs[i]);
+    free(strs);
+
+    CU_ASSERT(trie->remove(trie, "romane") == true);
+    CU_ASSERT(trie->remove(trie, "romanus") == true);
+    CU_ASSERT(trie->remove(trie, "romulus") == true);
+    CU_ASSERT(trie->remove(trie, "rubens") == true);
+    CU_ASSERT_EQUAL(trie->size(trie), 0);
+    CU_ASSERT(trie->has_prefix_as(trie, "r") == false);
+
+    /* Only the root node and its child array remain. */
+    CU_ASSERT(num_alloc <= 2);
+    TrieDeinit(trie);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+}
+
 /*-----------------------------------------------------------------------------*
  *                       The driver for Trie unit test                         *
  *-----------------------------------------------------------------------------*/
@@ -538,10 +1064,87 @@ bool AddSuite()
     if (!unit)
         return false;
 
+    unit = CU_add_test(suite, "String Search Stale Prefix", TestStalePrefix);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Retrieve Prefix As", TestGetPrefix);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Visit Prefix As", TestVisitPrefix);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Visit in UTF-8 Order", TestUnicodeOrder);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Frozen Image Save and Load", TestFreeze);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Wide Node Child Selection", TestWideNode);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Node Allocation via Allocator and Pool", TestAllocator);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Radix Node Maintenance", TestRadix);
+    if (!unit)
+        return false;
+
+    /* Repeat the structure verification with the radix representation. */
+    suite = CU_add_suite("Radix Structure Verification", EnterRadixMode, NULL);
+    if (!suite)
+        return false;
+
+    unit = CU_add_test(suite, "Trie New and Delete", TestNewDelete);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Insert", TestInsert);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Search Exact Match", TestSearchExact);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Search Prefix Match", TestSearchPrefix);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Bulk Insert", TestBulkInsert);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Remove and Search Verification", TestRemoveAndVerify);
+    if (!unit)
+        return false;
+
     unit = CU_add_test(suite, "String Retrieve Prefix As", TestGetPrefix);
     if (!unit)
         return false;
 
+    unit = CU_add_test(suite, "String Visit Prefix As", TestVisitPrefix);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Visit in UTF-8 Order", TestUnicodeOrder);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Frozen Image Save and Load", TestFreeze);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Wide Node Child Selection", TestWideNode);
+    if (!unit)
+        return false;
+
     return true;
 }
 
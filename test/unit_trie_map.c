@@ -0,0 +1,402 @@
+#include "container/trie_map.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TXT_BUFF = 32;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 2048;
+
+
+/*-----------------------------------------------------------------------------*
+ *            The utilities for value cleanup and allocation counting          *
+ *-----------------------------------------------------------------------------*/
+static int num_clean;
+
+void CleanValue(void* value)
+{
+    ++num_clean;
+    free(value);
+}
+
+static int num_alloc;
+
+void* CountAlloc(void* ctx, size_t size)
+{
+    ++num_alloc;
+    return malloc(size);
+}
+
+void CountFree(void* ctx, void* ptr)
+{
+    --num_alloc;
+    free(ptr);
+}
+
+int* NewValue(int num)
+{
+    int* value = (int*)malloc(sizeof(int));
+    *value = num;
+    return value;
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    TrieMap* map = TrieMapInit();
+    CU_ASSERT(map != NULL);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    CU_ASSERT_EQUAL(map->get(map, "key"), NULL);
+    CU_ASSERT(map->find(map, "key") == false);
+    CU_ASSERT(map->remove(map, "key") == false);
+    TrieMapDeinit(map);
+
+    /* Pass NULL pointer. */
+    TrieMapDeinit(NULL);
+}
+
+void TestPutGet()
+{
+    TrieMap* map = TrieMapInit();
+    map->set_clean_value(map, CleanValue);
+    num_clean = 0;
+
+    /* Reject the dummy keys. */
+    CU_ASSERT(map->put(map, NULL, NULL) == false);
+    CU_ASSERT(map->put(map, "\0", NULL) == false);
+
+    char buf[SIZE_TXT_BUFF];
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "/user/%d/profile", i);
+        CU_ASSERT(map->put(map, buf, NewValue(i)) == true);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "/user/%d/profile", i);
+        int* value = (int*)map->get(map, buf);
+        CU_ASSERT(value != NULL && *value == i);
+        CU_ASSERT(map->find(map, buf) == true);
+    }
+    CU_ASSERT_EQUAL(map->get(map, "/user/"), NULL);
+    CU_ASSERT_EQUAL(map->get(map, "/user/1/profiles"), NULL);
+    CU_ASSERT(map->find(map, "/user/1/prof") == false);
+    CU_ASSERT(map->find(map, "\0") == false);
+    CU_ASSERT(map->find(map, NULL) == false);
+
+    /* Replace the values of the existing keys. */
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2) {
+        snprintf(buf, SIZE_TXT_BUFF, "/user/%d/profile", i);
+        CU_ASSERT(map->put(map, buf, NewValue(-i)) == true);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+    CU_ASSERT_EQUAL(num_clean, SIZE_MID_TEST / 2);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "/user/%d/profile", i);
+        int* value = (int*)map->get(map, buf);
+        CU_ASSERT(value != NULL && *value == ((i % 2)? i : -i));
+    }
+
+    /* The key may end at the node splitting an edge. */
+    CU_ASSERT(map->put(map, "/user/1", NewValue(1)) == true);
+    CU_ASSERT(map->put(map, "/us", NewValue(2)) == true);
+    CU_ASSERT(*(int*)map->get(map, "/user/1") == 1);
+    CU_ASSERT(*(int*)map->get(map, "/us") == 2);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST + 2);
+
+    TrieMapDeinit(map);
+    CU_ASSERT_EQUAL(num_clean, SIZE_MID_TEST / 2 + SIZE_MID_TEST + 2);
+}
+
+void TestRemove()
+{
+    TrieMap* map = TrieMapInit();
+    map->set_clean_value(map, CleanValue);
+    num_clean = 0;
+
+    char buf[SIZE_TXT_BUFF];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "k%d", i);
+        CU_ASSERT(map->put(map, buf, NewValue(i)) == true);
+    }
+
+    /* Remove the keys with odd suffixes. */
+    for (i = 1 ; i < SIZE_SML_TEST ; i += 2) {
+        snprintf(buf, SIZE_TXT_BUFF, "k%d", i);
+        CU_ASSERT(map->remove(map, buf) == true);
+        CU_ASSERT(map->remove(map, buf) == false);
+    }
+    CU_ASSERT_EQUAL(num_clean, SIZE_SML_TEST / 2);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_SML_TEST / 2);
+
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "k%d", i);
+        int* value = (int*)map->get(map, buf);
+        if (i % 2) {
+            CU_ASSERT_EQUAL(value, NULL);
+        } else {
+            CU_ASSERT(value != NULL && *value == i);
+        }
+    }
+
+    /* Removing a pass through prefix keeps the longer keys. */
+    CU_ASSERT(map->remove(map, "k") == false);
+    CU_ASSERT(map->remove(map, "k2") == true);
+    CU_ASSERT(*(int*)map->get(map, "k20") == 20);
+    CU_ASSERT(*(int*)map->get(map, "k200") == 200);
+
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2) {
+        snprintf(buf, SIZE_TXT_BUFF, "k%d", i);
+        CU_ASSERT(map->remove(map, buf) == (i != 2));
+    }
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    CU_ASSERT_EQUAL(num_clean, SIZE_SML_TEST);
+
+    TrieMapDeinit(map);
+    CU_ASSERT_EQUAL(num_clean, SIZE_SML_TEST);
+}
+
+void TestLongestPrefixMatch()
+{
+    TrieMap* map = TrieMapInit();
+    void* value;
+
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "/", &value), 0);
+
+    /* Route the URLs with the most specific rules. */
+    CU_ASSERT(map->put(map, "/", (void*)(intptr_t)1) == true);
+    CU_ASSERT(map->put(map, "/api", (void*)(intptr_t)2) == true);
+    CU_ASSERT(map->put(map, "/api/v1", (void*)(intptr_t)3) == true);
+    CU_ASSERT(map->put(map, "/api/v1/users", (void*)(intptr_t)4) == true);
+    CU_ASSERT(map->put(map, "/static", (void*)(intptr_t)5) == true);
+
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "/api/v1/users/7", &value),
+                    strlen("/api/v1/users"));
+    CU_ASSERT_EQUAL((intptr_t)value, 4);
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "/api/v1/items", &value),
+                    strlen("/api/v1"));
+    CU_ASSERT_EQUAL((intptr_t)value, 3);
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "/api/v2", &value),
+                    strlen("/api"));
+    CU_ASSERT_EQUAL((intptr_t)value, 2);
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "/api", &value),
+                    strlen("/api"));
+    CU_ASSERT_EQUAL((intptr_t)value, 2);
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "/stat", &value), 1);
+    CU_ASSERT_EQUAL((intptr_t)value, 1);
+
+    /* No rule matches the string. */
+    value = NULL;
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "api", &value), 0);
+    CU_ASSERT_EQUAL(value, NULL);
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "\0", &value), 0);
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, NULL, &value), 0);
+
+    /* The match falls back after the rules are removed. */
+    CU_ASSERT(map->remove(map, "/api/v1") == true);
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "/api/v1/items", &value),
+                    strlen("/api"));
+    CU_ASSERT_EQUAL((intptr_t)value, 2);
+    CU_ASSERT(map->remove(map, "/") == true);
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "/stat", NULL), 0);
+    CU_ASSERT_EQUAL(map->longest_prefix_match(map, "/static/a.png", NULL),
+                    strlen("/static"));
+
+    TrieMapDeinit(map);
+}
+
+typedef struct {
+    unsigned count;
+    unsigned stop;
+    int sum;
+    char last[64];
+    bool ordered;
+} Record;
+
+bool RecordPair(const char* key, void* value, void* arg)
+{
+    Record* record = (Record*)arg;
+    if (record->count > 0 && strcmp(record->last, key) >= 0)
+        record->ordered = false;
+    strncpy(record->last, key, sizeof(record->last) - 1);
+    record->sum += (int)(intptr_t)value;
+    ++record->count;
+    return record->count != record->stop;
+}
+
+void TestVisitPrefix()
+{
+    TrieMap* map = TrieMapInit();
+    Record record;
+    memset(&record, 0, sizeof(Record));
+    record.ordered = true;
+
+    CU_ASSERT_EQUAL(map->visit_prefix(map, "a", 0, RecordPair, &record), 0);
+
+    char buf[SIZE_TXT_BUFF];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "item%d", i);
+        CU_ASSERT(map->put(map, buf, (void*)(intptr_t)i) == true);
+    }
+
+    /* Visit the pairs under a prefix in lexicographic order. Among item0 to
+       item511, the keys starting with item5 sum up as below. */
+    int expect = 5;
+    for (i = 50 ; i < 60 ; ++i)
+        expect += i;
+    for (i = 500 ; i < SIZE_SML_TEST ; ++i)
+        expect += i;
+    CU_ASSERT_EQUAL(map->visit_prefix(map, "item5", 0, RecordPair, &record),
+                    1 + 10 + 12);
+    CU_ASSERT_EQUAL(record.sum, expect);
+    CU_ASSERT(record.ordered == true);
+
+    /* Stop at the limit or by the visit function. */
+    memset(&record, 0, sizeof(Record));
+    record.ordered = true;
+    CU_ASSERT_EQUAL(map->visit_prefix(map, "item", 3, RecordPair, &record), 3);
+    CU_ASSERT(strcmp(record.last, "item10") == 0);
+
+    memset(&record, 0, sizeof(Record));
+    record.ordered = true;
+    record.stop = 2;
+    CU_ASSERT_EQUAL(map->visit_prefix(map, "ite", 0, RecordPair, &record), 2);
+    CU_ASSERT(strcmp(record.last, "item1") == 0);
+
+    memset(&record, 0, sizeof(Record));
+    record.ordered = true;
+    CU_ASSERT_EQUAL(map->visit_prefix(map, "it", 0, RecordPair, &record),
+                    SIZE_SML_TEST);
+    CU_ASSERT(record.ordered == true);
+    CU_ASSERT_EQUAL(map->visit_prefix(map, "items", 0, RecordPair, &record), 0);
+    CU_ASSERT_EQUAL(map->visit_prefix(map, "\0", 0, RecordPair, &record), 0);
+
+    TrieMapDeinit(map);
+}
+
+void TestUnicodeOrder()
+{
+    /* The keys sorted by strcmp, where the bytes above 0x7f go last. */
+    const char* keys[] = {"p", "pa", "pz", "p\x7f", "p\xc3\xa9", "p\xc3\xa9t",
+                          "p\xc3\xb3", "p\xff"};
+    int num = sizeof(keys) / sizeof(keys[0]);
+
+    TrieMap* map = TrieMapInit();
+    int i;
+    for (i = num - 1 ; i >= 0 ; --i)
+        CU_ASSERT(map->put(map, keys[i], (void*)(intptr_t)i) == true);
+
+    Record record;
+    memset(&record, 0, sizeof(Record));
+    record.ordered = true;
+    CU_ASSERT_EQUAL(map->visit_prefix(map, "p", 0, RecordPair, &record), num);
+    CU_ASSERT(record.ordered == true);
+    CU_ASSERT(strcmp(record.last, "p\xff") == 0);
+
+    /* The first pair under the multibyte prefix is the shorter key. */
+    memset(&record, 0, sizeof(Record));
+    record.ordered = true;
+    record.stop = 1;
+    CU_ASSERT_EQUAL(map->visit_prefix(map, "p\xc3", 0, RecordPair, &record), 1);
+    CU_ASSERT(strcmp(record.last, "p\xc3\xa9") == 0);
+    CU_ASSERT_EQUAL(record.sum, 4);
+
+    TrieMapDeinit(map);
+}
+
+void TestAllocator()
+{
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+
+    TrieMap* map = TrieMapInit();
+    CU_ASSERT(map->set_allocator(map, &alloc) == true);
+
+    char buf[SIZE_TXT_BUFF];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "node%d", i * 13);
+        CU_ASSERT(map->put(map, buf, NULL) == true);
+    }
+    CU_ASSERT(num_alloc > 0);
+    CU_ASSERT(map->set_allocator(map, NULL) == false);
+
+    /* Removing all the keys merges the nodes back to the root. */
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "node%d", i * 13);
+        CU_ASSERT(map->remove(map, buf) == true);
+    }
+    CU_ASSERT(num_alloc <= 2);
+
+    TrieMapDeinit(map);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+}
+
+
+bool AddSuite()
+{
+    CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+    if (!suite)
+        return false;
+
+    CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Put and Get", TestPutGet);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Remove and Search Verification", TestRemove);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Longest Prefix Match", TestLongestPrefixMatch);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Visit Prefix As", TestVisitPrefix);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Visit in UTF-8 Order", TestUnicodeOrder);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Node Allocation via Allocator", TestAllocator);
+    if (!unit)
+        return false;
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suites to verify TrieMap functionalities. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
@@ -0,0 +1,339 @@
+#include "container/typed_hash_map.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_MID_TEST = 1024;
+static const int SIZE_LRG_TEST = 65536;
+static const int SIZE_MID_STR = 32;
+
+typedef struct Employ_ {
+    int year;
+    int level;
+    int id;
+} Employ;
+
+
+/*-----------------------------------------------------------------------------*
+ *         The compile time hash and key comparison of the tested maps         *
+ *-----------------------------------------------------------------------------*/
+static inline unsigned HashNum(int key)
+{
+    return (unsigned)key;
+}
+
+static inline int CompareNum(int lhs, int rhs)
+{
+    return (lhs == rhs)? 0 : 1;
+}
+
+/**
+ * The famous djb2 string hash function directly pulled from:
+ * http://www.cse.yorku.ca/~oz/hash.html
+ */
+static inline unsigned HashTxt(const char* key)
+{
+    unsigned long hash = 5381;
+    int c;
+
+    while ((c = *key++))
+        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+
+    return hash;
+}
+
+/* Hash every key to the same value to stress the probing sequence. */
+#define HASH_CONST(key)         (0u)
+
+TYPED_HASH_MAP_DEFINE(NumMap, int, int, HashNum, CompareNum)
+TYPED_HASH_MAP_DEFINE(TxtMap, const char*, Employ, HashTxt, strcmp)
+TYPED_HASH_MAP_DEFINE(CollideMap, int, int, HASH_CONST, CompareNum)
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    NumMap* map;
+    CU_ASSERT((map = NumMapInit()) != NULL);
+
+    /* Enlarge the map size to test the destructor. */
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(NumMapPut(map, i, i) == true);
+
+    NumMapDeinit(map);
+    NumMapDeinit(NULL);
+}
+
+void TestPutGetNum()
+{
+    NumMap* map = NumMapInit();
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        NumMapPut(map, i, i);
+
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        CU_ASSERT(NumMapContain(map, i) == true);
+        int* val = NumMapGet(map, i);
+        CU_ASSERT(val != NULL);
+        if (val)
+            CU_ASSERT_EQUAL(i, *val);
+    }
+    CU_ASSERT(NumMapGet(map, SIZE_TNY_TEST) == NULL);
+
+    /* The existing value is replaced, and can be updated in place. */
+    CU_ASSERT(NumMapPut(map, 0, 100) == true);
+    CU_ASSERT_EQUAL(*NumMapGet(map, 0), 100);
+    *NumMapGet(map, 0) += 1;
+    CU_ASSERT_EQUAL(*NumMapGet(map, 0), 101);
+    CU_ASSERT_EQUAL(NumMapSize(map), SIZE_TNY_TEST);
+
+    NumMapDeinit(map);
+}
+
+void TestRemoveNum()
+{
+    NumMap* map = NumMapInit();
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        NumMapPut(map, i, i);
+
+    /* Remove the first half of the key value pairs. */
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i)
+        CU_ASSERT(NumMapRemove(map, i) == true);
+
+    /* Querying for the keys that are already removed should fail. */
+    for (i = 0 ; i < SIZE_TNY_TEST >> 1 ; ++i) {
+        CU_ASSERT(NumMapRemove(map, i) == false);
+        CU_ASSERT(NumMapContain(map, i) == false);
+    }
+
+    /* Querying for the keys that still exist should success. */
+    for (i = SIZE_TNY_TEST >> 1 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(NumMapContain(map, i) == true);
+
+    CU_ASSERT_EQUAL(NumMapSize(map), SIZE_TNY_TEST >> 1);
+
+    NumMapDeinit(map);
+}
+
+void TestIterateNum()
+{
+    NumMap* map = NumMapInit();
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        NumMapPut(map, i, -i);
+
+    /* The pairs are scattered in the slot array, so we check that each key is
+       visited exactly once. */
+    bool visit[SIZE_TNY_TEST];
+    memset(visit, 0, sizeof(bool) * SIZE_TNY_TEST);
+    NumMapIter iter;
+    NumMapIterInit(map, &iter);
+    NumMapPair* ptr_pair;
+    while ((ptr_pair = NumMapIterNext(&iter)) != NULL) {
+        CU_ASSERT_EQUAL(ptr_pair->key, -ptr_pair->value);
+        CU_ASSERT(visit[ptr_pair->key] == false);
+        visit[ptr_pair->key] = true;
+    }
+    CU_ASSERT(NumMapIterNext(&iter) == NULL);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(visit[i] == true);
+
+    NumMapDeinit(map);
+}
+
+void TestChurnNum()
+{
+    NumMap* map = NumMapInit();
+
+    /* Repeatedly insert and remove the keys to accumulate the deleted slots. */
+    int round, i;
+    for (round = 0 ; round < 8 ; ++round) {
+        int base = round * SIZE_MID_TEST;
+        for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+            CU_ASSERT(NumMapPut(map, base + i, i) == true);
+        for (i = 0 ; i < SIZE_MID_TEST ; i += 2)
+            CU_ASSERT(NumMapRemove(map, base + i) == true);
+    }
+    CU_ASSERT_EQUAL(NumMapSize(map), 8 * (SIZE_MID_TEST >> 1));
+
+    for (round = 0 ; round < 8 ; ++round) {
+        int base = round * SIZE_MID_TEST;
+        for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+            int* val = NumMapGet(map, base + i);
+            CU_ASSERT((val != NULL) == ((i & 1) == 1));
+            if (val)
+                CU_ASSERT_EQUAL(i, *val);
+        }
+    }
+
+    NumMapDeinit(map);
+}
+
+void TestCollideNum()
+{
+    CollideMap* map = CollideMapInit();
+
+    /* All the keys share one probing sequence. */
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(CollideMapPut(map, i, i) == true);
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 3)
+        CU_ASSERT(CollideMapRemove(map, i) == true);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        int* val = CollideMapGet(map, i);
+        CU_ASSERT((val != NULL) == (i % 3 != 0));
+        if (val)
+            CU_ASSERT_EQUAL(i, *val);
+    }
+
+    CollideMapDeinit(map);
+}
+
+void TestReserve()
+{
+    NumMap* map = NumMapInitCapacity(SIZE_LRG_TEST);
+    CU_ASSERT(map != NULL);
+
+    /* The reserved map should absorb the pairs without rehashing. */
+    unsigned num_slot = map->num_slot_;
+    int i;
+    for (i = 0 ; i < SIZE_LRG_TEST ; ++i)
+        NumMapPut(map, i, i);
+    CU_ASSERT_EQUAL(map->num_slot_, num_slot);
+
+    /* Reserving less room than the current one takes no effect, while the
+       larger one keeps all the pairs. */
+    CU_ASSERT(NumMapReserve(map, SIZE_TNY_TEST) == true);
+    CU_ASSERT_EQUAL(map->num_slot_, num_slot);
+    CU_ASSERT(NumMapReserve(map, SIZE_LRG_TEST << 2) == true);
+    CU_ASSERT(map->num_slot_ > num_slot);
+    CU_ASSERT_EQUAL(NumMapSize(map), SIZE_LRG_TEST);
+    for (i = 0 ; i < SIZE_LRG_TEST ; ++i)
+        CU_ASSERT_EQUAL(*NumMapGet(map, i), i);
+
+    NumMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to complex data maintenance                  *
+ *-----------------------------------------------------------------------------*/
+void TestPutGetTxt()
+{
+    char buf[SIZE_MID_STR];
+    char* keys[SIZE_TNY_TEST];
+    TxtMap* map = TxtMapInit();
+
+    /* The structures are stored by value in the slot array. */
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        keys[i] = strdup(buf);
+        Employ employ = {i, i << 1, i << 2};
+        CU_ASSERT(TxtMapPut(map, keys[i], employ) == true);
+    }
+
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "key -> %d", i);
+        Employ* employ = TxtMapGet(map, buf);
+        CU_ASSERT(employ != NULL);
+        if (employ) {
+            CU_ASSERT_EQUAL(employ->year, i);
+            CU_ASSERT_EQUAL(employ->level, i << 1);
+            CU_ASSERT_EQUAL(employ->id, i << 2);
+        }
+    }
+    CU_ASSERT(TxtMapContain(map, "key -> none") == false);
+
+    /* The stored keys are released by the caller after the traversal. */
+    TxtMapIter iter;
+    TxtMapPair* ptr_pair;
+    TxtMapIterInit(map, &iter);
+    while ((ptr_pair = TxtMapIterNext(&iter)) != NULL)
+        free((char*)ptr_pair->key);
+
+    TxtMapDeinit(map);
+}
+
+
+bool AddSuite()
+{
+    {
+        /* Test the basic functionalities. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Map New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Numeric Key Put and Get", TestPutGetNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Numeric Key Remove", TestRemoveNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Map External Iterator", TestIterateNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Slot Reuse after Removal", TestChurnNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Colliding Hash Probing", TestCollideNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Capacity Reservation", TestReserve);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Test its robustness to maintain complex data types. */
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Object Key and Value Put and Get", TestPutGetTxt);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for map structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
@@ -0,0 +1,878 @@
+#include "container/unrolled_list.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TXT_BUFF = 32;
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 2048;
+
+/* The small chunk lets the tests split and merge the chunks frequently. */
+static const int SIZE_CHUNK = 4;
+#define SIZE_REF_ARRAY  (1024)
+
+
+/*-----------------------------------------------------------------------------*
+ *                      The utilities for resource clean                       *
+ *-----------------------------------------------------------------------------*/
+void CleanElement(void* element)
+{
+    free(element);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    UnrolledList* list;
+    CU_ASSERT((list = UnrolledListInit(SIZE_CHUNK)) != NULL);
+
+    /* Enlarge the list size to test the destructor. */
+    unsigned i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)i) == true);
+
+    UnrolledListDeinit(list);
+}
+
+void TestPushFrontAndBack()
+{
+    {
+        UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+        void* element;
+        CU_ASSERT(list->get_front(list, &element) == false);
+        CU_ASSERT(list->get_back(list, &element) == false);
+        CU_ASSERT(list->get_at(list, 0, &element) == false);
+
+        /* Push elements to the list head. */
+        CU_ASSERT(list->push_front(list, (void*)(intptr_t)4) == true);
+        CU_ASSERT(list->push_front(list, (void*)(intptr_t)3) == true);
+        CU_ASSERT(list->push_front(list, (void*)(intptr_t)2) == true);
+        CU_ASSERT(list->push_front(list, (void*)(intptr_t)1) == true);
+
+        /* Check element insertion sequence. */
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+        CU_ASSERT(list->get_at(list, 0, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_at(list, 1, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+        CU_ASSERT(list->get_at(list, 2, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+        CU_ASSERT(list->get_at(list, 3, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+        CU_ASSERT_EQUAL(list->size(list), 4);
+        UnrolledListDeinit(list);
+    }
+    {
+        UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+        /* Push elements to the list tail. */
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)1) == true);
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)2) == true);
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)3) == true);
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)4) == true);
+
+        void* element;
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+        CU_ASSERT(list->get_at(list, 0, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_at(list, 1, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+        CU_ASSERT(list->get_at(list, 2, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+        CU_ASSERT(list->get_at(list, 3, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+        CU_ASSERT_EQUAL(list->size(list), 4);
+        UnrolledListDeinit(list);
+    }
+}
+
+void TestInsert()
+{
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+    /* Insert elements to the specified indexes. */
+    CU_ASSERT(list->insert(list, 1, (void*)(intptr_t)1) == false);
+
+    CU_ASSERT(list->insert(list, 0, (void*)(intptr_t)1) == true);
+    CU_ASSERT(list->insert(list, 1, (void*)(intptr_t)4) == true);
+    CU_ASSERT(list->insert(list, 1, (void*)(intptr_t)2) == true);
+    CU_ASSERT(list->insert(list, 2, (void*)(intptr_t)3) == true);
+    CU_ASSERT(list->insert(list, 0, (void*)(intptr_t)0) == true);
+
+    /* Check element insertion sequence. */
+    void* element;
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)0);
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+    CU_ASSERT(list->get_at(list, 0, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)0);
+    CU_ASSERT(list->get_at(list, 1, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+    CU_ASSERT(list->get_at(list, 2, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_at(list, 3, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+    CU_ASSERT(list->get_at(list, 4, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+    CU_ASSERT_EQUAL(list->size(list), 5);
+    UnrolledListDeinit(list);
+}
+
+void TestPopFrontAndBack()
+{
+    {
+        UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+        CU_ASSERT(list->pop_front(list) == false);
+
+        /* Prepare the initial elements. */
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)1) == true);
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)2) == true);
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)3) == true);
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)4) == true);
+
+        /* Pop elements from the list head and check the remaining element sequence. */
+        void* element;
+        CU_ASSERT(list->pop_front(list) == true);
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+        CU_ASSERT(list->get_at(list, 0, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+        CU_ASSERT(list->get_at(list, 1, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+        CU_ASSERT(list->get_at(list, 2, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+        CU_ASSERT(list->pop_front(list) == true);
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+        CU_ASSERT(list->get_at(list, 0, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+        CU_ASSERT(list->get_at(list, 1, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+        CU_ASSERT(list->pop_front(list) == true);
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+        CU_ASSERT(list->get_at(list, 0, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+        CU_ASSERT_EQUAL(list->size(list), 1);
+
+        CU_ASSERT(list->pop_front(list) == true);
+        CU_ASSERT(list->get_front(list, &element) == false);
+        CU_ASSERT(list->get_back(list, &element) == false);
+        CU_ASSERT(list->get_at(list, 0, &element) == false);
+
+        CU_ASSERT(list->pop_front(list) == false);
+
+        /* Insert the element again to check if the list is well handled in
+           the previous test. */
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)777) == true);
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)777);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)777);
+        CU_ASSERT_EQUAL(list->size(list), 1);
+
+        UnrolledListDeinit(list);
+    }
+    {
+        UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+        CU_ASSERT(list->pop_back(list) == false);
+
+        /* Prepare the initial elements. */
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)1) == true);
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)2) == true);
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)3) == true);
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)4) == true);
+
+        /* Pop elements from the list tail and check the remaining element sequence. */
+        void* element;
+        CU_ASSERT(list->pop_back(list) == true);
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+        CU_ASSERT(list->get_at(list, 0, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_at(list, 1, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+        CU_ASSERT(list->get_at(list, 2, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+
+        CU_ASSERT(list->pop_back(list) == true);
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+        CU_ASSERT(list->get_at(list, 0, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_at(list, 1, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+
+        CU_ASSERT(list->pop_back(list) == true);
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+        CU_ASSERT(list->get_at(list, 0, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+
+        CU_ASSERT_EQUAL(list->size(list), 1);
+
+        CU_ASSERT(list->pop_back(list) == true);
+        CU_ASSERT(list->get_front(list, &element) == false);
+        CU_ASSERT(list->get_back(list, &element) == false);
+        CU_ASSERT(list->get_at(list, 0, &element) == false);
+
+        CU_ASSERT(list->pop_back(list) == false);
+
+        /* Insert the element again to check if the list is well handled in
+           the previous test. */
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)777) == true);
+        CU_ASSERT(list->get_front(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)777);
+        CU_ASSERT(list->get_back(list, &element) == true);
+        CU_ASSERT_EQUAL(element, (void*)(intptr_t)777);
+        CU_ASSERT_EQUAL(list->size(list), 1);
+
+        UnrolledListDeinit(list);
+    }
+}
+
+void TestRemove()
+{
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+    /* Prepare the initial elements. */
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)1) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)2) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)3) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)4) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)5) == true);
+
+    /* Remove elements from the specified index and check the remaining
+       element sequence. */
+    void* element;
+    CU_ASSERT(list->remove(list, 0) == true);
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)5);
+    CU_ASSERT(list->get_at(list, 0, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_at(list, 1, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+    CU_ASSERT(list->get_at(list, 2, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+    CU_ASSERT(list->get_at(list, 3, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)5);
+
+    CU_ASSERT(list->remove(list, 1) == true);
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)5);
+    CU_ASSERT(list->get_at(list, 0, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_at(list, 1, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+    CU_ASSERT(list->get_at(list, 2, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)5);
+
+    CU_ASSERT(list->remove(list, 2) == true);
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+    CU_ASSERT(list->get_at(list, 0, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_at(list, 1, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+
+    CU_ASSERT(list->remove(list, 1) == true);
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_at(list, 0, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+
+    CU_ASSERT_EQUAL(list->size(list), 1);
+
+    CU_ASSERT(list->remove(list, 0) == true);
+    CU_ASSERT(list->remove(list, 0) == false);
+    CU_ASSERT(list->get_front(list, &element) == false);
+    CU_ASSERT(list->get_back(list, &element) == false);
+    CU_ASSERT(list->get_at(list, 0, &element) == false);
+
+    /* Insert the element again to check if the list is well handled in
+       the previous test. */
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)777) == true);
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)777);
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)777);
+    CU_ASSERT_EQUAL(list->size(list), 1);
+
+    UnrolledListDeinit(list);
+}
+
+void TestReplace()
+{
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+    CU_ASSERT(list->set_front(list, (void*)(intptr_t)0) == false);
+    CU_ASSERT(list->set_back(list, (void*)(intptr_t)0) == false);
+    CU_ASSERT(list->set_at(list, 0, (void*)(intptr_t)0) == false);
+
+    /* Prepare the initial elements. */
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)1) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)2) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)3) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)4) == true);
+
+    /* Replace the element residing at the list head and check the result. */
+    void* element;
+    CU_ASSERT(list->set_front(list, (void*)(intptr_t)-1) == true);
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)-1);
+
+    /* Replace the element residing at the list tail and check the result. */
+    CU_ASSERT(list->set_back(list, (void*)(intptr_t)-3) == true);
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)-3);
+
+    /* Replace the elements residing at the specified indexes and check the result. */
+    CU_ASSERT(list->set_at(list, 0, (void*)(intptr_t)10) == true);
+    CU_ASSERT(list->get_at(list, 0, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)10);
+
+    CU_ASSERT(list->set_at(list, 1, (void*)(intptr_t)20) == true);
+    CU_ASSERT(list->get_at(list, 1, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)20);
+
+    CU_ASSERT(list->set_at(list, 2, (void*)(intptr_t)30) == true);
+    CU_ASSERT(list->get_at(list, 2, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)30);
+
+    CU_ASSERT(list->set_at(list, 3, (void*)(intptr_t)40) == true);
+    CU_ASSERT(list->get_at(list, 3, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)40);
+
+    CU_ASSERT(list->set_at(list, 4, (void*)(intptr_t)0) == false);
+
+    UnrolledListDeinit(list);
+}
+
+void TestReverse()
+{
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+    /* Prepare the initial elements. */
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)1) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)2) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)3) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)4) == true);
+
+    list->reverse(list);
+
+    /* Check the reversed element sequence. */
+    void* element;
+    CU_ASSERT(list->get_at(list, 0, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)4);
+    CU_ASSERT(list->get_at(list, 1, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)3);
+    CU_ASSERT(list->get_at(list, 2, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)2);
+    CU_ASSERT(list->get_at(list, 3, &element) == true);
+    CU_ASSERT_EQUAL(element, (void*)(intptr_t)1);
+
+    UnrolledListDeinit(list);
+}
+
+void TestIterator()
+{
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+    /* Prepare the initial elements. */
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)1) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)2) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)3) == true);
+    CU_ASSERT(list->push_back(list, (void*)(intptr_t)4) == true);
+
+    /* Iterate through the list. */
+    void* element;
+    int check = 1;
+
+    list->first(list, false);
+    while (list->next(list, &element)) {
+        CU_ASSERT_EQUAL((int)(intptr_t)element, check);
+        ++check;
+    }
+
+    /* Iterate through the list in reversed order. */
+    check = 4;
+    list->first(list, true);
+    while (list->reverse_next(list, &element)) {
+        CU_ASSERT_EQUAL((int)(intptr_t)element, check);
+        --check;
+    }
+
+    UnrolledListDeinit(list);
+}
+
+void TestExternalIterator()
+{
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+
+    /* Traverse an empty list. */
+    UnrolledListIter fwd, rev;
+    void* elem_fwd;
+    void* elem_rev;
+    UnrolledListIterInit(list, &fwd, false);
+    CU_ASSERT(UnrolledListIterNext(&fwd, &elem_fwd) == false);
+
+    int i;
+    for (i = 1 ; i <= 4 ; ++i)
+        CU_ASSERT(list->push_back(list, (void*)(intptr_t)i) == true);
+
+    /* Run the forward and the reverse iterators simultaneously. */
+    UnrolledListIterInit(list, &fwd, false);
+    UnrolledListIterInit(list, &rev, true);
+    for (i = 1 ; i <= 4 ; ++i) {
+        CU_ASSERT(UnrolledListIterNext(&fwd, &elem_fwd) == true);
+        CU_ASSERT(UnrolledListIterNext(&rev, &elem_rev) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)elem_fwd, i);
+        CU_ASSERT_EQUAL((int)(intptr_t)elem_rev, 5 - i);
+    }
+    CU_ASSERT(UnrolledListIterNext(&fwd, &elem_fwd) == false);
+    CU_ASSERT(UnrolledListIterNext(&rev, &elem_rev) == false);
+
+    UnrolledListDeinit(list);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *              Unit tests relevant to complex data maintenance                *
+ *-----------------------------------------------------------------------------*/
+void TestObjectInsert()
+{
+    char* nums[SIZE_MID_TEST];
+    char buf[SIZE_TXT_BUFF];
+    int idx = 0;
+    while (idx < SIZE_MID_TEST) {
+        snprintf(buf, SIZE_TXT_BUFF, "%d", idx);
+        nums[idx] = strdup((const char*)buf);
+        ++idx;
+    }
+
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+    list->set_clean(list, CleanElement);
+
+    /* Push the elements ranging from 1536 to 2047 to the list tail. */
+    idx = SIZE_MID_TEST - SIZE_SML_TEST;
+    while (idx < SIZE_MID_TEST) {
+        CU_ASSERT(list->push_back(list, strdup(nums[idx])) == true);
+        ++idx;
+    }
+
+    /* Push the elements ranging from 0 to 511 to the list head. */
+    idx = SIZE_SML_TEST - 1;
+    while (idx >= 0) {
+        CU_ASSERT(list->push_front(list, strdup(nums[idx])) == true);
+        --idx;
+    }
+
+    /* Insert the elements ranging from 512 to 1535. */
+    idx = SIZE_SML_TEST;
+    int bnd = SIZE_MID_TEST - SIZE_SML_TEST;
+    while (idx < bnd) {
+        CU_ASSERT(list->insert(list, idx, strdup(nums[idx])) == true);
+        ++idx;
+    }
+
+    /* Check the element sequence. */
+    void* element;
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT(strcmp((char*)element, nums[0]) == 0);
+
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT(strcmp((char*)element, nums[SIZE_MID_TEST - 1]) == 0);
+
+    idx = 0;
+    while (idx < SIZE_MID_TEST) {
+        CU_ASSERT(list->get_at(list, idx, &element) == true);
+        CU_ASSERT(strcmp((char*)element, nums[idx]) == 0);
+        ++idx;
+    }
+
+    UnrolledListDeinit(list);
+
+    idx = 0;
+    while (idx < SIZE_MID_TEST) {
+        free(nums[idx]);
+        ++idx;
+    }
+}
+
+void TestObjectRemove()
+{
+    char* nums[SIZE_MID_TEST];
+    char buf[SIZE_TXT_BUFF];
+    int idx = 0;
+    while (idx < SIZE_MID_TEST) {
+        snprintf(buf, SIZE_TXT_BUFF, "%d", idx);
+        nums[idx] = strdup((const char*)buf);
+        ++idx;
+    }
+
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+    list->set_clean(list, CleanElement);
+
+    /* Push the elements ranging from 0 to 2047. */
+    idx = 0;
+    while (idx < SIZE_MID_TEST) {
+        CU_ASSERT(list->push_back(list, strdup(nums[idx])) == true);
+        ++idx;
+    }
+
+    /* Pop the elements ranging from 0 to 511 at the list head. */
+    idx = 0;
+    while (idx < SIZE_SML_TEST) {
+        CU_ASSERT(list->pop_front(list) == true);
+        ++idx;
+    }
+
+    /* Pop the elements ranging from 1536 to 2047 at the list tail. */
+    idx = 0;
+    while (idx < SIZE_SML_TEST) {
+        CU_ASSERT(list->pop_back(list) == true);
+        ++idx;
+    }
+
+    /* Remove the elements ranging from 1024 to 1535. */
+    idx = 0;
+    while (idx < SIZE_SML_TEST) {
+        CU_ASSERT(list->remove(list, SIZE_SML_TEST) == true);
+        ++idx;
+    }
+
+    /* Check the element sequence. */
+    void* element;
+    CU_ASSERT(list->get_front(list, &element) == true);
+    CU_ASSERT(strcmp((char*)element, nums[SIZE_SML_TEST]) == 0);
+
+    CU_ASSERT(list->get_back(list, &element) == true);
+    CU_ASSERT(strcmp((char*)element, nums[(SIZE_SML_TEST << 1) - 1]) == 0);
+
+    idx = 0;
+    while (idx < SIZE_SML_TEST) {
+        CU_ASSERT(list->get_at(list, idx, &element) == true);
+        CU_ASSERT(strcmp((char*)element, nums[idx + SIZE_SML_TEST]) == 0);
+        ++idx;
+    }
+
+    UnrolledListDeinit(list);
+
+    idx = 0;
+    while (idx < SIZE_MID_TEST) {
+        free(nums[idx]);
+        ++idx;
+    }
+}
+
+void TestObjectReplace()
+{
+    char* nums[SIZE_SML_TEST];
+    char buf[SIZE_TXT_BUFF];
+    int idx = 0;
+    while (idx < SIZE_SML_TEST) {
+        snprintf(buf, SIZE_TXT_BUFF, "%d", idx);
+        nums[idx] = strdup((const char*)buf);
+        ++idx;
+    }
+
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+    list->set_clean(list, CleanElement);
+
+    /* Push the elements ranging from 0 to 511. */
+    idx = 0;
+    while (idx < SIZE_SML_TEST) {
+        CU_ASSERT(list->push_back(list, strdup(nums[idx])) == true);
+        ++idx;
+    }
+
+    /* Reverse the list via element replacement. */
+    CU_ASSERT(list->set_front(list, strdup(nums[SIZE_SML_TEST - 1])) == true);
+    CU_ASSERT(list->set_back(list, strdup((nums[0]))) == true);
+    idx = 1;
+    while (idx < SIZE_SML_TEST - 1) {
+        CU_ASSERT(list->set_at(list, idx, strdup(nums[SIZE_SML_TEST - 1 - idx])) == true);
+        ++idx;
+    }
+
+    /* Check the element sequence. */
+    void* element;
+    idx = 0;
+    while (idx < SIZE_SML_TEST) {
+        CU_ASSERT(list->get_at(list, idx, &element) == true);
+        CU_ASSERT(strcmp((char*)element, nums[SIZE_SML_TEST - 1 - idx]) == 0);
+        ++idx;
+    }
+
+    UnrolledListDeinit(list);
+
+    idx = 0;
+    while (idx < SIZE_SML_TEST) {
+        free(nums[idx]);
+        ++idx;
+    }
+}
+
+static int num_alloc;
+
+void* CountAlloc(void* ctx, size_t size)
+{
+    ++num_alloc;
+    return malloc(size);
+}
+
+void CountFree(void* ctx, void* ptr)
+{
+    --num_alloc;
+    free(ptr);
+}
+
+void TestAllocator()
+{
+    Allocator alloc = {CountAlloc, CountFree, NULL};
+    num_alloc = 0;
+
+    /* Apply the custom allocator to the list. */
+    UnrolledList* list = UnrolledListInit(SIZE_CHUNK);
+    CU_ASSERT(list->set_allocator(list, &alloc) == true);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        list->push_back(list, (void*)(intptr_t)i);
+    CU_ASSERT_EQUAL(num_alloc, SIZE_SML_TEST / SIZE_CHUNK);
+    CU_ASSERT(list->set_allocator(list, NULL) == false);
+    for (i = 0 ; i < SIZE_SML_TEST >> 1 ; ++i)
+        list->pop_front(list);
+    CU_ASSERT_EQUAL(num_alloc, (SIZE_SML_TEST >> 1) / SIZE_CHUNK);
+    UnrolledListDeinit(list);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+
+    /* The global allocator is captured at construction. */
+    CdsSetAllocator(&alloc);
+    list = UnrolledListInit(0);
+    CdsSetAllocator(NULL);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        list->push_front(list, (void*)(intptr_t)i);
+    CU_ASSERT(num_alloc > 0);
+    CU_ASSERT(num_alloc < SIZE_SML_TEST / 16);
+    UnrolledListDeinit(list);
+    CU_ASSERT_EQUAL(num_alloc, 0);
+}
+
+void TestRandomOperation()
+{
+    srand(time(NULL));
+
+    /* Replay the random operations on a plain array as the reference. */
+    static intptr_t refs[SIZE_REF_ARRAY];
+    unsigned caps[] = {2, 3, SIZE_CHUNK, 0};
+    unsigned c;
+    for (c = 0 ; c < sizeof(caps) / sizeof(unsigned) ; ++c) {
+        UnrolledList* list = UnrolledListInit(caps[c]);
+        unsigned size = 0;
+        int round;
+        for (round = 0 ; round < SIZE_MID_TEST * 4 ; ++round) {
+            int op = rand() % 8;
+            if (size < 16)
+                op = 0;
+            else if (size >= SIZE_REF_ARRAY - 1)
+                op = 4;
+
+            intptr_t num = rand();
+            unsigned idx = (size > 0)? (unsigned)rand() % size : 0;
+            if (op < 2) {
+                idx = (unsigned)rand() % (size + 1);
+                CU_ASSERT(list->insert(list, idx, (void*)num) == true);
+                memmove(refs + idx + 1, refs + idx, sizeof(intptr_t) * (size - idx));
+                refs[idx] = num;
+                ++size;
+            } else if (op == 2) {
+                CU_ASSERT(list->push_front(list, (void*)num) == true);
+                memmove(refs + 1, refs, sizeof(intptr_t) * size);
+                refs[0] = num;
+                ++size;
+            } else if (op == 3) {
+                CU_ASSERT(list->push_back(list, (void*)num) == true);
+                refs[size++] = num;
+            } else if (op == 4 || op == 5) {
+                CU_ASSERT(list->remove(list, idx) == true);
+                memmove(refs + idx, refs + idx + 1, sizeof(intptr_t) * (size - idx - 1));
+                --size;
+            } else if (op == 6) {
+                CU_ASSERT(list->pop_front(list) == true);
+                memmove(refs, refs + 1, sizeof(intptr_t) * (size - 1));
+                --size;
+            } else {
+                CU_ASSERT(list->pop_back(list) == true);
+                --size;
+            }
+        }
+
+        CU_ASSERT_EQUAL(list->size(list), size);
+        void* element;
+        unsigned i;
+        for (i = 0 ; i < size ; ++i) {
+            CU_ASSERT(list->get_at(list, i, &element) == true);
+            CU_ASSERT_EQUAL((intptr_t)element, refs[i]);
+        }
+
+        UnrolledListIter iter;
+        UnrolledListIterInit(list, &iter, true);
+        i = size;
+        while (UnrolledListIterNext(&iter, &element))
+            CU_ASSERT_EQUAL((intptr_t)element, refs[--i]);
+        CU_ASSERT_EQUAL(i, 0);
+
+        list->reverse(list);
+        list->first(list, false);
+        i = size;
+        while (list->next(list, &element))
+            CU_ASSERT_EQUAL((intptr_t)element, refs[--i]);
+        CU_ASSERT_EQUAL(i, 0);
+
+        UnrolledListDeinit(list);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                    The driver for UnrolledList unit test                    *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "UnrolledList New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Push Front and Back", TestPushFrontAndBack);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Insert", TestInsert);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Pop Front and Back", TestPopFrontAndBack);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Remove", TestRemove);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Replace", TestReplace);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "UnrolledList Reverse", TestReverse);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "UnrolledList Iterator", TestIterator);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "UnrolledList External Iterator", TestExternalIterator);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Object Push and Insert", TestObjectInsert);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Object Pop and Remove", TestObjectRemove);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Object Replace", TestObjectReplace);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Chunk Allocation via Allocator", TestAllocator);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Random Operation against Array", TestRandomOperation);
+        if (!unit)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suites to verify UnrolledList functionalities. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
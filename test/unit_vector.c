@@ -10,6 +10,7 @@ static const int DEFAULT_CAPACITY = 512;
 static const int SIZE_TNY_TEST = 128;
 static const int SIZE_SML_TEST = 512;
 static const int SIZE_MID_TEST = 2048;
+static const int SIZE_BIG_TEST = 65536;
 
 typedef struct Tuple_ {
     int first;
@@ -34,6 +35,52 @@ int SortElement(const void* lhs, const void* rhs)
     return (tpl_lhs->first > tpl_rhs->first)? 1 : -1;
 }
 
+uint64_t ExtractKey(const void* element)
+{
+    /* Spread the key over both the low and the high bytes. */
+    return (uint64_t)((Tuple*)element)->first * 0x100000001ULL;
+}
+
+size_t EncodeTuple(void* ctx, void* item, void* buf, size_t capacity)
+{
+    if (capacity >= sizeof(Tuple))
+        memcpy(buf, item, sizeof(Tuple));
+    return sizeof(Tuple);
+}
+
+bool DecodeTuple(void* ctx, const void* buf, size_t size, void** p_item)
+{
+    if (size != sizeof(Tuple))
+        return false;
+    Tuple* tuple = (Tuple*)malloc(sizeof(Tuple));
+    if (!tuple)
+        return false;
+    memcpy(tuple, buf, sizeof(Tuple));
+    *p_item = tuple;
+    return true;
+}
+
+/* Encode the small integer as a field wider than a snapshot chunk. */
+size_t EncodeWide(void* ctx, void* item, void* buf, size_t capacity)
+{
+    size_t size = CDS_SNAPSHOT_CHUNK + CDS_SNAPSHOT_CHUNK / 2;
+    if (capacity >= size)
+        memset(buf, (int)(intptr_t)item, size);
+    return size;
+}
+
+bool DecodeWide(void* ctx, const void* buf, size_t size, void** p_item)
+{
+    const char* bytes = (const char*)buf;
+    size_t i;
+    for (i = 1 ; i < size ; ++i) {
+        if (bytes[i] != bytes[0])
+            return false;
+    }
+    *p_item = (void*)(intptr_t)bytes[0];
+    return true;
+}
+
 /*-----------------------------------------------------------------------------*
  *            Unit tests relevant to basic structure verification              *
  *-----------------------------------------------------------------------------*/
@@ -256,6 +303,37 @@ void TestIterator()
     VectorDeinit(vector);
 }
 
+void TestExternalIterator()
+{
+    Vector* vector = VectorInit(DEFAULT_CAPACITY);
+
+    unsigned i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        vector->push_back(vector, (void*)(intptr_t)i);
+
+    /* Run the forward and the reverse iterators simultaneously. */
+    VectorIter fwd, rev;
+    VectorIterInit(vector, &fwd, false);
+    VectorIterInit(vector, &rev, true);
+    void* elem_fwd;
+    void* elem_rev;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        CU_ASSERT(VectorIterNext(&fwd, &elem_fwd) == true);
+        CU_ASSERT(VectorIterNext(&rev, &elem_rev) == true);
+        CU_ASSERT_EQUAL((unsigned)(intptr_t)elem_fwd, i);
+        CU_ASSERT_EQUAL((unsigned)(intptr_t)elem_rev, SIZE_SML_TEST - 1 - i);
+    }
+    CU_ASSERT(VectorIterNext(&fwd, &elem_fwd) == false);
+    CU_ASSERT(VectorIterNext(&rev, &elem_rev) == false);
+    VectorDeinit(vector);
+
+    /* Traverse an empty vector. */
+    vector = VectorInit(DEFAULT_CAPACITY);
+    VectorIterInit(vector, &rev, true);
+    CU_ASSERT(VectorIterNext(&rev, &elem_rev) == false);
+    VectorDeinit(vector);
+}
+
 void TestSort()
 {
     srand(time(NULL));
@@ -292,6 +370,375 @@ void TestSort()
     VectorDeinit(vector);
 }
 
+Vector* NewShuffledVector(int size, int num_dup)
+{
+    Vector* vector = VectorInit(DEFAULT_CAPACITY);
+
+    int i;
+    for (i = 0 ; i < size ; ++i) {
+        Tuple* tuple = (Tuple*)malloc(sizeof(Tuple));
+        tuple->first = i / num_dup;
+        tuple->second = 0;
+        vector->push_back(vector, tuple);
+    }
+    for (i = size - 1 ; i > 0 ; --i) {
+        int tge = rand() % (i + 1);
+        void* src_tuple;
+        void* tge_tuple;
+        vector->get(vector, i, &src_tuple);
+        vector->get(vector, tge, &tge_tuple);
+        vector->set(vector, i, tge_tuple);
+        vector->set(vector, tge, src_tuple);
+    }
+
+    /* Record the shuffled order to verify the sort stability. */
+    for (i = 0 ; i < size ; ++i) {
+        void* tuple;
+        vector->get(vector, i, &tuple);
+        ((Tuple*)tuple)->second = i;
+    }
+
+    /* Set the cleanup function after the shuffle which replaces elements. */
+    vector->set_clean(vector, CleanElement);
+    return vector;
+}
+
+void TestSortParallel()
+{
+    srand(time(NULL));
+
+    Vector* vector = NewShuffledVector(SIZE_BIG_TEST, 3);
+    CU_ASSERT(VectorSortParallel(vector, SortElement, 4) == true);
+
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        void* tuple;
+        vector->get(vector, i, &tuple);
+        CU_ASSERT_EQUAL(((Tuple*)tuple)->first, i / 3);
+    }
+    VectorDeinit(vector);
+
+    /* Too few threads or elements to fork. */
+    vector = NewShuffledVector(SIZE_SML_TEST, 1);
+    CU_ASSERT(VectorSortParallel(vector, SortElement, 8) == true);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        void* tuple;
+        vector->get(vector, i, &tuple);
+        CU_ASSERT_EQUAL(((Tuple*)tuple)->first, i);
+    }
+    VectorDeinit(vector);
+
+    vector = VectorInit(DEFAULT_CAPACITY);
+    CU_ASSERT(VectorSortParallel(vector, SortElement, 1) == true);
+    VectorDeinit(vector);
+}
+
+/* The running order check folded by the parallel reduction. */
+typedef struct Order_ {
+    unsigned count;
+    intptr_t first;
+    intptr_t last;
+    bool sorted;
+} Order;
+
+void AccumulateOrder(void* acc, void* item, void* ctx)
+{
+    Order* order = (Order*)acc;
+    intptr_t num = (intptr_t)item;
+    if (order->count == 0)
+        order->first = num;
+    else if (order->last >= num)
+        order->sorted = false;
+    order->last = num;
+    ++(order->count);
+}
+
+void CombineOrder(void* dst, const void* src, void* ctx)
+{
+    Order* lhs = (Order*)dst;
+    const Order* rhs = (const Order*)src;
+    if (rhs->count == 0)
+        return;
+    if (lhs->count == 0) {
+        *lhs = *rhs;
+        return;
+    }
+    lhs->sorted = lhs->sorted && rhs->sorted && lhs->last < rhs->first;
+    lhs->last = rhs->last;
+    lhs->count += rhs->count;
+}
+
+void VisitSum(void* element, void* arg)
+{
+    __atomic_fetch_add((uint64_t*)arg, (uint64_t)(intptr_t)element,
+                       __ATOMIC_RELAXED);
+}
+
+void TestTraverseParallel()
+{
+    Vector* vector = VectorInit(DEFAULT_CAPACITY);
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i)
+        vector->push_back(vector, (void*)(intptr_t)i);
+
+    uint64_t expect = (uint64_t)SIZE_BIG_TEST * (SIZE_BIG_TEST - 1) / 2;
+    unsigned num_thread;
+    for (num_thread = 1 ; num_thread <= 8 ; num_thread <<= 1) {
+        uint64_t sum = 0;
+        VectorForEachParallel(vector, VisitSum, &sum, num_thread);
+        CU_ASSERT_EQUAL(sum, expect);
+
+        /* The partial results are combined in the index order. */
+        Reducer reducer = {sizeof(Order), AccumulateOrder, CombineOrder, NULL};
+        Order order = {0, 0, 0, true};
+        VectorReduceParallel(vector, &reducer, &order, num_thread);
+        CU_ASSERT_EQUAL(order.count, SIZE_BIG_TEST);
+        CU_ASSERT(order.sorted == true);
+        CU_ASSERT_EQUAL(order.first, 0);
+        CU_ASSERT_EQUAL(order.last, SIZE_BIG_TEST - 1);
+    }
+    VectorDeinit(vector);
+
+    /* The empty vector leaves the identity result. */
+    vector = VectorInit(DEFAULT_CAPACITY);
+    Reducer reducer = {sizeof(Order), AccumulateOrder, CombineOrder, NULL};
+    Order order = {0, 0, 0, true};
+    VectorReduceParallel(vector, &reducer, &order, 4);
+    CU_ASSERT_EQUAL(order.count, 0);
+    VectorDeinit(vector);
+}
+
+void TestSortRadix()
+{
+    srand(time(NULL));
+
+    Vector* vector = NewShuffledVector(SIZE_BIG_TEST, 4);
+    CU_ASSERT(VectorSortRadix(vector, ExtractKey) == true);
+
+    int i;
+    void* tuple;
+    void* pred;
+    vector->get(vector, 0, &pred);
+    for (i = 1 ; i < SIZE_BIG_TEST ; ++i) {
+        vector->get(vector, i, &tuple);
+        CU_ASSERT_EQUAL(((Tuple*)tuple)->first, i / 4);
+        if (((Tuple*)tuple)->first == ((Tuple*)pred)->first)
+            CU_ASSERT(((Tuple*)tuple)->second > ((Tuple*)pred)->second);
+        pred = tuple;
+    }
+    VectorDeinit(vector);
+
+    /* All the keys are equal, so the order is intact. */
+    vector = NewShuffledVector(SIZE_TNY_TEST, SIZE_TNY_TEST);
+    CU_ASSERT(VectorSortRadix(vector, ExtractKey) == true);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        vector->get(vector, i, &tuple);
+        CU_ASSERT_EQUAL(((Tuple*)tuple)->second, i);
+    }
+    VectorDeinit(vector);
+
+    vector = VectorInit(DEFAULT_CAPACITY);
+    CU_ASSERT(VectorSortRadix(vector, ExtractKey) == true);
+    VectorDeinit(vector);
+}
+
+void TestGrowth()
+{
+    Vector* vector = VectorInit(0);
+
+    /* The policies without hysteresis are rejected. */
+    GrowthPolicy invalid_grow = {100, 0, 1};
+    GrowthPolicy invalid_shrink = {200, 50, 1};
+    CU_ASSERT(vector->set_growth(vector, &invalid_grow) == false);
+    CU_ASSERT(vector->set_growth(vector, &invalid_shrink) == false);
+
+    /* The vector starting with zero capacity should still grow. */
+    GrowthPolicy policy = {150, 25, 8};
+    CU_ASSERT(vector->set_growth(vector, &policy) == true);
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(vector->push_back(vector, (void*)(intptr_t)i) == true);
+    unsigned peak = vector->capacity(vector);
+    CU_ASSERT(peak >= (unsigned)SIZE_MID_TEST);
+
+    /* Drain the burst from both ends and the array follows. */
+    for (i = 0 ; i < SIZE_MID_TEST / 2 - 2 ; ++i) {
+        CU_ASSERT(vector->remove(vector, 0) == true);
+        CU_ASSERT(vector->pop_back(vector) == true);
+    }
+    CU_ASSERT(vector->capacity(vector) < peak);
+    CU_ASSERT(vector->capacity(vector) >= policy.min_capacity);
+    CU_ASSERT_EQUAL(vector->size(vector), 4);
+
+    /* Reserve never removes the elements. */
+    CU_ASSERT(vector->reserve(vector, SIZE_MID_TEST) == true);
+    CU_ASSERT_EQUAL(vector->capacity(vector), SIZE_MID_TEST);
+    CU_ASSERT(vector->reserve(vector, 1) == true);
+    CU_ASSERT_EQUAL(vector->capacity(vector), SIZE_MID_TEST);
+    CU_ASSERT_EQUAL(vector->size(vector), 4);
+
+    CU_ASSERT(vector->shrink_to_fit(vector) == true);
+    CU_ASSERT_EQUAL(vector->capacity(vector), 4);
+    for (i = 0 ; i < 4 ; ++i) {
+        void* element;
+        CU_ASSERT(vector->get(vector, i, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, SIZE_MID_TEST / 2 - 2 + i);
+    }
+
+    VectorDeinit(vector);
+}
+
+void TestRangeOperation()
+{
+    void* elements[SIZE_SML_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        elements[i] = (void*)(intptr_t)i;
+
+    Vector* vector = VectorInit(1);
+    CU_ASSERT(vector->append_array(vector, elements, SIZE_SML_TEST) == true);
+    CU_ASSERT_EQUAL(vector->size(vector), SIZE_SML_TEST);
+
+    /* Insert the same array to the middle, the head, and the tail. */
+    unsigned mid = SIZE_SML_TEST / 2;
+    CU_ASSERT(vector->insert_range(vector, mid, elements, SIZE_SML_TEST) == true);
+    CU_ASSERT(vector->insert_range(vector, 0, elements, 2) == true);
+    CU_ASSERT(vector->insert_range(vector, vector->size(vector), elements, 2) == true);
+    CU_ASSERT(vector->insert_range(vector, vector->size(vector) + 1, elements, 1) == false);
+    CU_ASSERT(vector->insert_range(vector, 0, elements, 0) == true);
+    CU_ASSERT(vector->insert_range(vector, 0, elements, UINT_MAX) == false);
+
+    unsigned size = vector->size(vector);
+    CU_ASSERT_EQUAL(size, 2 * SIZE_SML_TEST + 4);
+    void* element;
+    unsigned idx;
+    for (idx = 0 ; idx < size ; ++idx) {
+        int expect;
+        if (idx < 2)
+            expect = idx;
+        else if (idx < 2 + mid)
+            expect = idx - 2;
+        else if (idx < 2 + mid + SIZE_SML_TEST)
+            expect = idx - 2 - mid;
+        else if (idx < 2 + (unsigned)SIZE_SML_TEST * 2)
+            expect = idx - 2 - SIZE_SML_TEST;
+        else
+            expect = idx - 2 - 2 * SIZE_SML_TEST;
+        CU_ASSERT(vector->get(vector, idx, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, expect);
+    }
+
+    /* Erase the inserted ranges back. */
+    CU_ASSERT(vector->erase_range(vector, size - 2, 3) == false);
+    CU_ASSERT(vector->erase_range(vector, size + 1, 0) == false);
+    CU_ASSERT(vector->erase_range(vector, size - 2, 2) == true);
+    CU_ASSERT(vector->erase_range(vector, 2 + mid, SIZE_SML_TEST) == true);
+    CU_ASSERT(vector->erase_range(vector, 0, 2) == true);
+    CU_ASSERT(vector->erase_range(vector, 0, 0) == true);
+    CU_ASSERT_EQUAL(vector->size(vector), SIZE_SML_TEST);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        CU_ASSERT(vector->get(vector, i, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, i);
+    }
+    VectorDeinit(vector);
+
+    /* Move the objects between the vectors with cleanup functions. */
+    Vector* lhs = VectorInit(DEFAULT_CAPACITY);
+    Vector* rhs = VectorInit(DEFAULT_CAPACITY);
+    lhs->set_clean(lhs, CleanElement);
+    rhs->set_clean(rhs, CleanElement);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        Tuple* tuple = (Tuple*)malloc(sizeof(Tuple));
+        tuple->first = i;
+        tuple->second = -i;
+        Vector* tge = (i < SIZE_SML_TEST / 2)? lhs : rhs;
+        tge->push_back(tge, tuple);
+    }
+    CU_ASSERT(lhs->extend(lhs, lhs) == false);
+    CU_ASSERT(lhs->extend(lhs, rhs) == true);
+    CU_ASSERT_EQUAL(rhs->size(rhs), 0);
+    CU_ASSERT_EQUAL(lhs->size(lhs), SIZE_SML_TEST);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        CU_ASSERT(lhs->get(lhs, i, &element) == true);
+        CU_ASSERT_EQUAL(((Tuple*)element)->first, i);
+    }
+    CU_ASSERT(lhs->erase_range(lhs, SIZE_TNY_TEST, SIZE_TNY_TEST) == true);
+    CU_ASSERT_EQUAL(lhs->size(lhs), SIZE_SML_TEST - SIZE_TNY_TEST);
+
+    VectorDeinit(rhs);
+    VectorDeinit(lhs);
+}
+
+void TestSnapshot()
+{
+    Vector* vector = VectorInit(DEFAULT_CAPACITY);
+    vector->set_clean(vector, CleanElement);
+    int i;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        Tuple* tuple = (Tuple*)malloc(sizeof(Tuple));
+        tuple->first = i;
+        tuple->second = -i;
+        vector->push_back(vector, tuple);
+    }
+
+    SnapshotCodec codec = {EncodeTuple, DecodeTuple, NULL};
+    FILE* file = tmpfile();
+    CU_ASSERT(file != NULL);
+    SnapshotWriter writer = {CdsWriteFile, file};
+    CU_ASSERT(VectorSnapshot(vector, &writer, &codec) == true);
+    VectorDeinit(vector);
+
+    /* The restored elements are appended after the existing ones, and the
+       capacity is extended once. */
+    vector = VectorInit(DEFAULT_CAPACITY);
+    vector->set_clean(vector, CleanElement);
+    Tuple* tuple = (Tuple*)malloc(sizeof(Tuple));
+    tuple->first = -1;
+    vector->push_back(vector, tuple);
+    rewind(file);
+    SnapshotReader reader = {CdsReadFile, file};
+    CU_ASSERT(VectorRestore(vector, &reader, &codec) == true);
+    CU_ASSERT_EQUAL(vector->size(vector), SIZE_BIG_TEST + 1);
+    CU_ASSERT_EQUAL(vector->capacity(vector), SIZE_BIG_TEST + 1);
+
+    void* element;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i) {
+        CU_ASSERT(vector->get(vector, i + 1, &element) == true);
+        CU_ASSERT_EQUAL(((Tuple*)element)->first, i);
+        CU_ASSERT_EQUAL(((Tuple*)element)->second, -i);
+    }
+
+    /* The stream is exhausted after the snapshot. */
+    CU_ASSERT(VectorRestore(vector, &reader, &codec) == false);
+    CU_ASSERT_EQUAL(vector->size(vector), SIZE_BIG_TEST + 1);
+    VectorDeinit(vector);
+    fclose(file);
+
+    /* The fields wider than a chunk are written on their own. */
+    vector = VectorInit(DEFAULT_CAPACITY);
+    for (i = 0 ; i < SIZE_TNY_TEST / 16 ; ++i)
+        vector->push_back(vector, (void*)(intptr_t)i);
+    file = tmpfile();
+    writer.ctx = file;
+    codec.encode = EncodeWide;
+    codec.decode = DecodeWide;
+    CU_ASSERT(VectorSnapshot(vector, &writer, &codec) == true);
+    VectorDeinit(vector);
+
+    vector = VectorInit(DEFAULT_CAPACITY);
+    rewind(file);
+    reader.ctx = file;
+    CU_ASSERT(VectorRestore(vector, &reader, &codec) == true);
+    CU_ASSERT_EQUAL(vector->size(vector), SIZE_TNY_TEST / 16);
+    for (i = 0 ; i < SIZE_TNY_TEST / 16 ; ++i) {
+        CU_ASSERT(vector->get(vector, i, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, i);
+    }
+    VectorDeinit(vector);
+    fclose(file);
+}
+
 /*-----------------------------------------------------------------------------*
  *                      The driver for Vector unit test                        *
  *-----------------------------------------------------------------------------*/
@@ -309,6 +756,10 @@ bool AddSuite()
     if (!unit)
         return false;
 
+    unit = CU_add_test(suite, "Capacity Growth and Shrink", TestGrowth);
+    if (!unit)
+        return false;
+
     unit = CU_add_test(suite, "Element Push and Insert", TestPushAndInsert);
     if (!unit)
         return false;
@@ -321,14 +772,38 @@ bool AddSuite()
     if (!unit)
         return false;
 
+    unit = CU_add_test(suite, "Range Insert and Erase", TestRangeOperation);
+    if (!unit)
+        return false;
+
     unit = CU_add_test(suite, "Iterator", TestIterator);
     if (!unit)
         return false;
 
+    unit = CU_add_test(suite, "External Iterator", TestExternalIterator);
+    if (!unit)
+        return false;
+
     unit = CU_add_test(suite, "Sort", TestSort);
     if (!unit)
         return false;
 
+    unit = CU_add_test(suite, "Parallel Sort", TestSortParallel);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Radix Sort", TestSortRadix);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Parallel Traversal", TestTraverseParallel);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Snapshot and Restore", TestSnapshot);
+    if (!unit)
+        return false;
+
     return true;
 }
 
@@ -0,0 +1,237 @@
+#include <pthread.h>
+#include <sched.h>
+#include "container/work_stealing_deque.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_SML_TEST = 32;
+static const int SIZE_MID_TEST = 2048;
+static const int SIZE_BIG_TEST = 65536;
+#define NUM_THIEF       (4)
+
+
+/*-----------------------------------------------------------------------------*
+ *                  The utilities for element resource clean                   *
+ *-----------------------------------------------------------------------------*/
+void CleanObject(void* element)
+{
+    free(element);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    WorkStealingDeque* deque;
+    CU_ASSERT((deque = WorkStealingDequeInit(0)) != NULL);
+    CU_ASSERT_EQUAL(deque->capacity(deque), 64);
+    WorkStealingDequeDeinit(deque);
+
+    /* The remaining elements are cleaned after the array extension. */
+    CU_ASSERT((deque = WorkStealingDequeInit(3)) != NULL);
+    CU_ASSERT_EQUAL(deque->capacity(deque), 4);
+    deque->set_clean(deque, CleanObject);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(deque->push(deque, malloc(sizeof(int))) == true);
+    CU_ASSERT_EQUAL(deque->capacity(deque), SIZE_SML_TEST);
+
+    void* element;
+    CU_ASSERT(deque->steal(deque, &element) == true);
+    free(element);
+    CU_ASSERT(deque->pop(deque, &element) == true);
+    free(element);
+    WorkStealingDequeDeinit(deque);
+
+    /* Test the boundary case. */
+    WorkStealingDequeDeinit(NULL);
+}
+
+void TestPushPopSteal()
+{
+    WorkStealingDeque* deque = WorkStealingDequeInit(4);
+    void* element;
+    CU_ASSERT(deque->pop(deque, &element) == false);
+    CU_ASSERT(deque->steal(deque, &element) == false);
+
+    /* The owner pops the most recent element, and the thief steals the least
+       recent one. */
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(deque->push(deque, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(deque->size(deque), SIZE_MID_TEST);
+
+    int top = 0, bottom = SIZE_MID_TEST - 1;
+    while (top <= bottom) {
+        CU_ASSERT(deque->pop(deque, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, bottom);
+        --bottom;
+        if (top > bottom)
+            break;
+        CU_ASSERT(deque->steal(deque, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, top);
+        ++top;
+    }
+    CU_ASSERT_EQUAL(deque->size(deque), 0);
+    CU_ASSERT(deque->pop(deque, &element) == false);
+    CU_ASSERT(deque->steal(deque, &element) == false);
+
+    /* The indexes keep moving after the deque is drained. */
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        CU_ASSERT(deque->push(deque, (void*)(intptr_t)i) == true);
+        CU_ASSERT(deque->steal(deque, &element) == true);
+        CU_ASSERT_EQUAL((int)(intptr_t)element, i);
+    }
+    CU_ASSERT_EQUAL(deque->capacity(deque), SIZE_MID_TEST);
+
+    WorkStealingDequeDeinit(deque);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *              Unit tests relevant to concurrent data exchange                *
+ *-----------------------------------------------------------------------------*/
+typedef struct Task_ {
+    WorkStealingDeque* deque;
+    int* done;
+    int* seen;
+    int num_steal;
+} Task;
+
+void* Steal(void* arg)
+{
+    Task* task = (Task*)arg;
+    WorkStealingDeque* deque = task->deque;
+
+    while (true) {
+        void* element;
+        if (deque->steal(deque, &element)) {
+            __atomic_add_fetch(&(task->seen[(intptr_t)element]), 1,
+                               __ATOMIC_RELAXED);
+            ++task->num_steal;
+        } else if (__atomic_load_n(task->done, __ATOMIC_ACQUIRE))
+            break;
+        else
+            sched_yield();
+    }
+    return NULL;
+}
+
+void TestConcurrentSteal()
+{
+    WorkStealingDeque* deque = WorkStealingDequeInit(4);
+    int* seen = (int*)calloc(SIZE_BIG_TEST, sizeof(int));
+    int done = 0;
+
+    pthread_t threads[NUM_THIEF];
+    Task tasks[NUM_THIEF];
+    int i;
+    for (i = 0 ; i < NUM_THIEF ; ++i) {
+        tasks[i].deque = deque;
+        tasks[i].done = &done;
+        tasks[i].seen = seen;
+        tasks[i].num_steal = 0;
+        CU_ASSERT(pthread_create(&threads[i], NULL, Steal, &tasks[i]) == 0);
+    }
+
+    /* The owner pushes the elements in bursts and pops part of them back. */
+    int num_pop = 0;
+    i = 0;
+    while (i < SIZE_BIG_TEST) {
+        int burst = (i % 7) + 1;
+        while (burst-- && i < SIZE_BIG_TEST) {
+            CU_ASSERT(deque->push(deque, (void*)(intptr_t)i) == true);
+            ++i;
+        }
+        void* element;
+        if (deque->pop(deque, &element)) {
+            __atomic_add_fetch(&(seen[(intptr_t)element]), 1, __ATOMIC_RELAXED);
+            ++num_pop;
+        }
+    }
+
+    /* Drain the rest together with the thieves. */
+    void* element;
+    while (deque->pop(deque, &element)) {
+        __atomic_add_fetch(&(seen[(intptr_t)element]), 1, __ATOMIC_RELAXED);
+        ++num_pop;
+    }
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+
+    int total = num_pop;
+    for (i = 0 ; i < NUM_THIEF ; ++i) {
+        pthread_join(threads[i], NULL);
+        total += tasks[i].num_steal;
+    }
+    CU_ASSERT_EQUAL(total, SIZE_BIG_TEST);
+
+    int num_fail = 0;
+    for (i = 0 ; i < SIZE_BIG_TEST ; ++i)
+        num_fail += (seen[i] != 1);
+    CU_ASSERT_EQUAL(num_fail, 0);
+    CU_ASSERT_EQUAL(deque->size(deque), 0);
+
+    free(seen);
+    WorkStealingDequeDeinit(deque);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                The driver for WorkStealingDeque unit test                   *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "WorkStealingDeque New and Delete",
+                                    TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Push, Pop, and Steal", TestPushPopSteal);
+        if (!unit)
+            return false;
+    }
+    {
+        CU_pSuite suite = CU_add_suite("Concurrent Data Exchange", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Owner Pop against Thief Steal",
+                                    TestConcurrentSteal);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for WorkStealingDeque structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}